@@ -6,6 +6,7 @@
 #include <GLFW/glfw3.h>
 
 #include "toast_assert.h"
+#include "memory/scratch_arena.hpp"
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
@@ -54,6 +55,11 @@ namespace toaster::gpu
 
 	GPUContext::~GPUContext()
 	{
+		// The buffers need the logical device to be destroyed
+		m_vertexBuffers.clear();
+		m_indexBuffers.clear();
+		m_stagingRing.reset();
+
 		m_nvrhiDevice = nullptr;
 
 		m_logicalDevice.destroy();
@@ -68,6 +74,8 @@ namespace toaster::gpu
 		_pickPhysicalDevice(p_window_surface);
 		_createLogicalDevice();
 		_createNVRHIObjects();
+
+		m_stagingRing = std::make_unique<StagingRing>(this, c_stagingRingSize);
 	}
 
 	vk::Instance GPUContext::getInstance() const
@@ -80,54 +88,54 @@ namespace toaster::gpu
 		return m_enableValidationLayers;
 	}
 
-	bool GPUContext::isValidationLayerSupported(const std::string &p_layer_name) const
+	bool GPUContext::isValidationLayerSupported(const StringId p_layer_name) const
 	{
 		auto available_layers = vk::enumerateInstanceLayerProperties();
 		return std::ranges::any_of(available_layers, [p_layer_name](const auto &layer)
 		{
-			return layer.layerName == p_layer_name;
+			return StringId(std::string_view(layer.layerName.data())) == p_layer_name;
 		});
 	}
 
-	const std::unordered_set<std::string> &GPUContext::getEnabledValidationLayers() const
+	const StringIdSet &GPUContext::getEnabledValidationLayers() const
 	{
 		return m_enabledValidationLayers;
 	}
 
-	bool GPUContext::isInstanceExtensionEnabled(const std::string &p_extension_name) const
+	bool GPUContext::isInstanceExtensionEnabled(const StringId p_extension_name) const
 	{
 		return m_enabledInstanceExtensions.contains(p_extension_name);
 	}
 
-	bool GPUContext::isInstanceExtensionSupported(const std::string &p_extension_name) const
+	bool GPUContext::isInstanceExtensionSupported(const StringId p_extension_name) const
 	{
 		auto available_extensions = vk::enumerateInstanceExtensionProperties();
 		return std::ranges::any_of(available_extensions, [p_extension_name](const auto &extension)
 		{
-			return extension.extensionName == p_extension_name;
+			return StringId(std::string_view(extension.extensionName.data())) == p_extension_name;
 		});
 	}
 
-	const std::unordered_set<std::string> &GPUContext::getEnabledInstanceExtensions() const
+	const StringIdSet &GPUContext::getEnabledInstanceExtensions() const
 	{
 		return m_enabledInstanceExtensions;
 	}
 
-	bool GPUContext::isDeviceExtensionEnabled(const std::string &p_extension_name) const
+	bool GPUContext::isDeviceExtensionEnabled(const StringId p_extension_name) const
 	{
 		return m_enabledDeviceExtensions.contains(p_extension_name);
 	}
 
-	bool GPUContext::isDeviceExtensionSupported(const std::string &p_extension_name) const
+	bool GPUContext::isDeviceExtensionSupported(const StringId p_extension_name) const
 	{
 		auto available_extensions = m_physicalDevice.enumerateDeviceExtensionProperties(nullptr);
 		return std::ranges::any_of(available_extensions, [p_extension_name](const auto &extension)
 		{
-			return extension.extensionName == p_extension_name;
+			return StringId(std::string_view(extension.extensionName.data())) == p_extension_name;
 		});
 	}
 
-	const std::unordered_set<std::string> &GPUContext::getEnabledDeviceExtensions() const
+	const StringIdSet &GPUContext::getEnabledDeviceExtensions() const
 	{
 		return m_enabledDeviceExtensions;
 	}
@@ -234,10 +242,10 @@ namespace toaster::gpu
 
 	bool GPUContext::checkDeviceExtensionSupport(vk::PhysicalDevice p_physical_device) const
 	{
-		std::unordered_set<std::string> requiredExtensions = m_enabledDeviceExtensions;
+		StringIdSet requiredExtensions = m_enabledDeviceExtensions;
 		for (const auto deviceExtensions = p_physical_device.enumerateDeviceExtensionProperties(); const auto &extension: deviceExtensions)
 		{
-			requiredExtensions.erase(std::string(extension.extensionName.data()));
+			requiredExtensions.erase(StringId(std::string_view(extension.extensionName.data())));
 		}
 
 		// the device is missing one or more required extensions
@@ -365,20 +373,20 @@ namespace toaster::gpu
 		LOG_INFO("GLFW required instance extensions:\n[");
 		for (uint32 i = 0; i < glfw_extension_count; i++)
 		{
-			m_enabledInstanceExtensions.insert(std::string(glfw_instance_extensions[i]));
+			m_enabledInstanceExtensions.insert(StringId::intern(glfw_instance_extensions[i]));
 
 			LOG_INFO("\t{}", glfw_instance_extensions[i]);
 		}
 		LOG_INFO("]\n");
 
-		std::unordered_set<std::string> requiredExtensions = m_enabledInstanceExtensions;
+		StringIdSet requiredExtensions = m_enabledInstanceExtensions;
 
 		auto available_instance_extensions = vk::enumerateInstanceExtensionProperties();
 
 		LOG_INFO("Available instance extensions:\n[");
 		for (const auto &instanceExt: available_instance_extensions)
 		{
-			const std::string name = instanceExt.extensionName;
+			const StringId name = StringId::intern(instanceExt.extensionName.data());
 
 			LOG_INFO("\t{}", name);
 			if (m_optionalInstanceExtensions.contains(name))
@@ -395,7 +403,7 @@ namespace toaster::gpu
 			std::ostringstream ss;
 			ss << "Cannot create a Vulkan instance because the following required extension(s) are not supported:";
 			for (const auto &ext: requiredExtensions)
-				ss << std::endl << "  - " << ext;
+				ss << std::endl << "  - " << ext.getString();
 
 			LOG_ERROR("{}", ss.str());
 			throw std::runtime_error(ss.str().c_str());
@@ -404,12 +412,14 @@ namespace toaster::gpu
 		LOG_INFO("Enabled Vulkan instance extensions:\n[");
 		for (const auto &ext: m_enabledInstanceExtensions)
 		{
-			LOG_INFO("\t{}", ext.c_str());
+			LOG_INFO("\t{}", ext);
 		}
 		LOG_INFO("]\n");
 
-		auto required_extensions       = stringSetToVector(m_enabledInstanceExtensions);
-		auto enabled_validation_layers = stringSetToVector(m_enabledValidationLayers);
+		memory::ScratchScope scratch;
+
+		auto required_extensions       = stringSetToVector(m_enabledInstanceExtensions, scratch.getResource());
+		auto enabled_validation_layers = stringSetToVector(m_enabledValidationLayers, scratch.getResource());
 
 		instance_create_info.enabledExtensionCount   = required_extensions.size();
 		instance_create_info.ppEnabledExtensionNames = required_extensions.data();
@@ -477,7 +487,7 @@ namespace toaster::gpu
 		LOG_INFO("Available device extensions:\n[");
 		for (const auto &extension: available_extensions)
 		{
-			const std::string name = extension.extensionName;
+			const StringId name = StringId::intern(extension.extensionName.data());
 			LOG_INFO("\t{}", name);
 			if (m_optionalDeviceExtensions.contains(name))
 			{
@@ -494,9 +504,9 @@ namespace toaster::gpu
 		{
 			LOG_INFO("\t{}", extension);
 
-			if (extension == VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)
+			if (extension == StringId(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
 				timeline_semaphore_supported = true;
-			else if (extension == VK_KHR_SWAPCHAIN_MUTABLE_FORMAT_EXTENSION_NAME)
+			else if (extension == StringId(VK_KHR_SWAPCHAIN_MUTABLE_FORMAT_EXTENSION_NAME))
 				mutable_format_supported = true;
 		}
 		LOG_INFO("]\n");
@@ -532,7 +542,8 @@ namespace toaster::gpu
 		device_features.wideLines                 = true;
 		device_features.fillModeNonSolid          = true;
 
-		auto                 enabled_extensions = stringSetToVector(m_enabledDeviceExtensions);
+		memory::ScratchScope scratch;
+		auto                 enabled_extensions = stringSetToVector(m_enabledDeviceExtensions, scratch.getResource());
 		vk::DeviceCreateInfo device_create_info{};
 		device_create_info.pQueueCreateInfos       = queue_create_infos.data();
 		device_create_info.queueCreateInfoCount    = queue_create_infos.size();
@@ -550,9 +561,11 @@ namespace toaster::gpu
 
 	void GPUContext::_createNVRHIObjects()
 	{
-		auto vec_instance_ext = stringSetToVector(m_enabledInstanceExtensions);
-		auto vec_layers       = stringSetToVector(m_enabledValidationLayers);
-		auto vec_device_ext   = stringSetToVector(m_enabledDeviceExtensions);
+		memory::ScratchScope scratch;
+
+		auto vec_instance_ext = stringSetToVector(m_enabledInstanceExtensions, scratch.getResource());
+		auto vec_layers       = stringSetToVector(m_enabledValidationLayers, scratch.getResource());
+		auto vec_device_ext   = stringSetToVector(m_enabledDeviceExtensions, scratch.getResource());
 
 		nvrhi::vulkan::DeviceDesc device_desc{};
 
@@ -589,7 +602,7 @@ namespace toaster::gpu
 
 			for (const auto &layer_properties: available_layers)
 			{
-				if (std::strcmp(layer_properties.layerName.data(), layer_name.c_str()) == 0)
+				if (StringId(std::string_view(layer_properties.layerName.data())) == layer_name)
 				{
 					layer_found = true;
 					break;
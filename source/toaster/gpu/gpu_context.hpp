@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <unordered_set>
 
 #ifndef VULKAN_HPP_DISPATCH_LOADER_DYNAMIC
@@ -8,20 +10,34 @@
 #include <vulkan/vulkan.hpp>
 
 #include "system_types.h"
+#include "string_id.hpp"
+#include "toast_assert.h"
 
 #include <nvrhi/nvrhi.h>
 #include <nvrhi/vulkan.h>
 
+#include "index_buffer.hpp"
+#include "staging_ring.hpp"
+#include "vertex_buffer.hpp"
+#include "memory/handle_pool.hpp"
+
 struct GLFWwindow;
 
 namespace toaster
 {
-	inline std::vector<const char *> stringSetToVector(const std::unordered_set<std::string> &set)
+	using StringIdSet = std::unordered_set<StringId>;
+
+	// The ids must have been interned, the returned pointers reference the interner's strings.
+	// Pass a scratch/frame arena resource to keep the temporary off the heap
+	inline std::pmr::vector<const char *> stringSetToVector(const StringIdSet &        set,
+															std::pmr::memory_resource *p_resource = std::pmr::get_default_resource())
 	{
-		std::vector<const char *> ret;
-		for (const auto &s: set)
+		std::pmr::vector<const char *> ret{p_resource};
+		ret.reserve(set.size());
+		for (const StringId &id: set)
 		{
-			ret.push_back(s.c_str());
+			TST_ASSERT_MSG(id.c_str() != nullptr, "String id was not interned");
+			ret.push_back(id.c_str());
 		}
 
 		return ret;
@@ -34,6 +50,8 @@ namespace toaster::gpu
 	{
 	public:
 		static constexpr uint32 c_maxFramesInFlight{3};
+		// Split between the frames, what one frame can upload is a quarter of it
+		static constexpr vk::DeviceSize c_stagingRingSize{64ull << 20u};
 
 		// Only creates the Vulkan instance and debug messenger, so any operations (such as the window surface creation)
 		// should be called after this and before init()
@@ -46,17 +64,17 @@ namespace toaster::gpu
 
 		[[nodiscard]] vk::Instance getInstance() const;
 
-		[[nodiscard]] bool                                   isValidationEnabled() const;
-		[[nodiscard]] bool                                   isValidationLayerSupported(const std::string &p_layer_name) const;
-		[[nodiscard]] const std::unordered_set<std::string> &getEnabledValidationLayers() const;
+		[[nodiscard]] bool               isValidationEnabled() const;
+		[[nodiscard]] bool               isValidationLayerSupported(StringId p_layer_name) const;
+		[[nodiscard]] const StringIdSet &getEnabledValidationLayers() const;
 
-		[[nodiscard]] bool                                   isInstanceExtensionEnabled(const std::string &p_extension_name) const;
-		[[nodiscard]] bool                                   isInstanceExtensionSupported(const std::string &p_extension_name) const;
-		[[nodiscard]] const std::unordered_set<std::string> &getEnabledInstanceExtensions() const;
+		[[nodiscard]] bool               isInstanceExtensionEnabled(StringId p_extension_name) const;
+		[[nodiscard]] bool               isInstanceExtensionSupported(StringId p_extension_name) const;
+		[[nodiscard]] const StringIdSet &getEnabledInstanceExtensions() const;
 
-		[[nodiscard]] bool                                   isDeviceExtensionEnabled(const std::string &p_extension_name) const;
-		[[nodiscard]] bool                                   isDeviceExtensionSupported(const std::string &p_extension_name) const;
-		[[nodiscard]] const std::unordered_set<std::string> &getEnabledDeviceExtensions() const;
+		[[nodiscard]] bool               isDeviceExtensionEnabled(StringId p_extension_name) const;
+		[[nodiscard]] bool               isDeviceExtensionSupported(StringId p_extension_name) const;
+		[[nodiscard]] const StringIdSet &getEnabledDeviceExtensions() const;
 
 		struct QueueFamilyIndices
 		{
@@ -102,6 +120,13 @@ namespace toaster::gpu
 		[[nodiscard]] nvrhi::IDevice *getNVRHIDevice() const;
 		[[nodiscard]] nvrhi::Format   getSwapchainFormat() const;
 
+		// All GPU buffers are owned by the context and referenced through handles
+		[[nodiscard]] memory::HandlePool<VertexBuffer> &getVertexBufferPool() { return m_vertexBuffers; }
+		[[nodiscard]] memory::HandlePool<IndexBuffer> & getIndexBufferPool() { return m_indexBuffers; }
+
+		// Shared by every buffer write(), created by init()
+		[[nodiscard]] StagingRing &getStagingRing() { return *m_stagingRing; }
+
 	private:
 		void _createInstance();
 		void _setupDebug();
@@ -113,20 +138,20 @@ namespace toaster::gpu
 
 		vk::Instance m_vulkanInstance{nullptr};
 
-		[[nodiscard]] bool              _checkValidationLayerSupport() const;
-		std::unordered_set<std::string> m_enabledValidationLayers{"VK_LAYER_KHRONOS_validation"};
+		[[nodiscard]] bool _checkValidationLayerSupport() const;
+		StringIdSet        m_enabledValidationLayers{StringId::intern("VK_LAYER_KHRONOS_validation")};
 		#ifdef NDEBUG
 		bool m_enableValidationLayers = false;
 		#else
 		bool m_enableValidationLayers = true;
 		#endif
 
-		std::unordered_set<std::string> m_enabledInstanceExtensions{
+		StringIdSet m_enabledInstanceExtensions{
 			#ifndef NDEBUG
-			VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+			StringId::intern(VK_EXT_DEBUG_UTILS_EXTENSION_NAME),
 			#endif
 		};
-		std::unordered_set<std::string> m_optionalInstanceExtensions{};
+		StringIdSet m_optionalInstanceExtensions{};
 
 		static VkBool32 _debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT      messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType,
 									   const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData, void *                            pUserData);
@@ -137,14 +162,14 @@ namespace toaster::gpu
 
 		[[nodiscard]] bool _isDeviceSuitable(vk::PhysicalDevice p_physical_device, vk::SurfaceKHR p_window_surface /* Needed to query present support*/) const;
 
-		vk::Device                      m_logicalDevice;
-		std::unordered_set<std::string> m_enabledDeviceExtensions{
-			VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-			VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
-			VK_KHR_SWAPCHAIN_MUTABLE_FORMAT_EXTENSION_NAME,
-			VK_KHR_MAINTENANCE1_EXTENSION_NAME,
+		vk::Device  m_logicalDevice;
+		StringIdSet m_enabledDeviceExtensions{
+			StringId::intern(VK_KHR_SWAPCHAIN_EXTENSION_NAME),
+			StringId::intern(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME),
+			StringId::intern(VK_KHR_SWAPCHAIN_MUTABLE_FORMAT_EXTENSION_NAME),
+			StringId::intern(VK_KHR_MAINTENANCE1_EXTENSION_NAME),
 		};
-		std::unordered_set<std::string> m_optionalDeviceExtensions{VK_NV_FILL_RECTANGLE_EXTENSION_NAME};
+		StringIdSet m_optionalDeviceExtensions{StringId::intern(VK_NV_FILL_RECTANGLE_EXTENSION_NAME)};
 
 		vk::Queue m_graphicsQueue{nullptr};
 		vk::Queue m_presentQueue{nullptr};
@@ -152,5 +177,10 @@ namespace toaster::gpu
 		nvrhi::vulkan::DeviceHandle m_nvrhiDevice;
 
 		nvrhi::Format m_swapchainFormat{nvrhi::Format::SBGRA8_UNORM};
+
+		memory::HandlePool<VertexBuffer> m_vertexBuffers;
+		memory::HandlePool<IndexBuffer>  m_indexBuffers;
+
+		std::unique_ptr<StagingRing> m_stagingRing;
 	};
 }
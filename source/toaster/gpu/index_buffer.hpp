@@ -1,6 +1,9 @@
 #pragma once
 
-#include <vulkan/vulkan.hpp>
+#include <nvrhi/nvrhi.h>
+
+#include "system_types.h"
+#include "memory/handle_pool.hpp"
 
 namespace toaster::gpu
 {
@@ -9,17 +12,33 @@ namespace toaster::gpu
 	class IndexBuffer
 	{
 	public:
-		IndexBuffer(GPUContext *p_ctx, void *p_data, vk::DeviceSize p_size_bytes);
-		~IndexBuffer();
+		// Uploaded with the frame's other copies, see write(nvrhi::ICommandList *, ...)
+		IndexBuffer(GPUContext *p_ctx, const void *p_data, uint64 p_size_bytes);
+		// Allocates p_size_bytes of device local memory and leaves it to write(), for uploads spread over several frames
+		IndexBuffer(GPUContext *p_ctx, uint64 p_size_bytes);
+
+		// Movable so it can live in a HandlePool, the moved-from buffer no longer owns anything
+		IndexBuffer(IndexBuffer &&p_other) noexcept            = default;
+		IndexBuffer &operator=(IndexBuffer &&p_other) noexcept = default;
+
+		IndexBuffer(const IndexBuffer &)            = delete;
+		IndexBuffer &operator=(const IndexBuffer &) = delete;
 
-		[[nodiscard]] const vk::Buffer *getBuffer() const { return &m_buffer; }
-		vk::DeviceSize                  getSize() const { return m_size; }
+		[[nodiscard]] nvrhi::IBuffer *getHandle() const { return m_buffer; }
+		[[nodiscard]] uint64          getSize() const { return m_size; }
+
+		// Copies p_size_bytes to p_offset through this frame's part of the context's StagingRing, false if they don't fit
+		// in what is left of it. Larger uploads are spread over frames, see MeshStreamer
+		[[nodiscard]] bool write(uint64 p_offset, const void *p_data, uint64 p_size_bytes);
+		// Any size, staged in memory nvrhi allocates for p_command_list, for loads that can't be spread over frames
+		void write(nvrhi::ICommandList *p_command_list, uint64 p_offset, const void *p_data, uint64 p_size_bytes);
 
 	private:
-		GPUContext *m_gpuContext;
+		GPUContext *m_gpuContext{nullptr};
 
-		vk::DeviceSize   m_size{0u};
-		vk::Buffer       m_buffer{nullptr};
-		vk::DeviceMemory m_bufferMemory{nullptr};
+		uint64              m_size{0u};
+		nvrhi::BufferHandle m_buffer;
 	};
+
+	using IndexBufferHandle = memory::Handle<IndexBuffer>;
 }
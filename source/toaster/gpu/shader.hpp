@@ -6,6 +6,8 @@
 #include "shader_common.hpp"
 #include "shader_reflection.hpp"
 
+#include "memory/tracked_allocator.hpp"
+
 namespace toaster::gpu
 {
 	class GPUContext;
@@ -13,12 +15,19 @@ namespace toaster::gpu
 	class Shader
 	{
 	public:
+		TST_DECLARE_TAGGED_NEW(memory::EMemoryTag::eShader)
+
 		Shader(GPUContext *p_ctx, const std::map<nvrhi::ShaderType, ShaderBlob> &p_shader_bytecode_map);
 		~Shader();
 
+		Shader(Shader &&) noexcept            = default;
+		Shader &operator=(Shader &&) noexcept = default;
+
 		nvrhi::ShaderHandle getHandle() const;
 		nvrhi::ShaderHandle getHandle(nvrhi::ShaderType p_shader_stage) const;
 
+		[[nodiscard]] const reflection::ReflectionData &getReflectionData() const { return m_reflectionData; }
+
 	private:
 		GPUContext *m_gpuContext{nullptr};
 
@@ -28,4 +37,6 @@ namespace toaster::gpu
 
 		reflection::ReflectionData m_reflectionData;
 	};
+
+	using ShaderHandle = memory::Handle<Shader>;
 }
@@ -4,6 +4,8 @@
 #include <vector>
 #include "system_types.h"
 
+#include "memory/tracked_allocator.hpp"
+
 namespace toaster::gpu
 {
 	// class ShaderBlob
@@ -22,4 +24,7 @@ namespace toaster::gpu
 	// };
 
 	using ShaderBlob = std::span<const uint32>;
+
+	// Owning SPIR-V storage (e.g. the output of the runtime shader compiler)
+	using ShaderBinary = memory::TrackedVector<uint32, memory::EMemoryTag::eShader>;
 }
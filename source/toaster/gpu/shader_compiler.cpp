@@ -25,7 +25,7 @@ namespace toaster::gpu::shader_compiler
 		return shaderc_vertex_shader;
 	}
 
-	bool compileShaderSource(const io::filesystem::Path &p_shader_path, const nvrhi::ShaderType p_shader_stage, std::vector<uint32> &p_out_binary)
+	bool compileShaderSource(const io::filesystem::Path &p_shader_path, const nvrhi::ShaderType p_shader_stage, ShaderBinary &p_out_binary)
 	{
 		static shaderc::Compiler s_compiler;
 
@@ -9,5 +9,5 @@
 
 namespace toaster::gpu::shader_compiler
 {
-	bool compileShaderSource(const io::filesystem::Path &p_shader_path, nvrhi::ShaderType p_shader_stage, std::vector<uint32> &p_out_binary);
+	bool compileShaderSource(const io::filesystem::Path &p_shader_path, nvrhi::ShaderType p_shader_stage, ShaderBinary &p_out_binary);
 }
@@ -7,50 +7,44 @@
 
 namespace toaster::gpu::reflection
 {
-	void reflectShaderStage(nvrhi::ShaderType p_stage, ShaderBlob p_shader_binary, ReflectionData &p_out_reflection_data)
+	static DescriptorSet &getDescriptorSet(ReflectionData &p_reflection_data, uint32 p_set)
 	{
-		spirv_cross::CompilerReflection compiler(p_shader_binary.data(), p_shader_binary.size());
-
-		auto resources = compiler.get_shader_resources();
-
-		for (const auto &ubo: resources.uniform_buffers)
+		if (p_set >= p_reflection_data.descriptorSets.size())
 		{
-			auto active_buffers = compiler.get_active_buffer_ranges(ubo.id);
-
-			if (!active_buffers.empty())
-			{
-				const auto &ubo_name              = ubo.name;
-				auto &      ubo_type              = compiler.get_type(ubo.base_type_id);
-				int32       member_count          = ubo_type.member_types.size();
-				uint32      binding_index         = compiler.get_decoration(ubo.id, spv::DecorationBinding);
-				uint32      parent_descriptor_set = compiler.get_decoration(ubo.id, spv::DecorationDescriptorSet);
-				uint32      size                  = compiler.get_declared_struct_size(ubo_type);
-
-				if (parent_descriptor_set >= p_out_reflection_data.descriptorSets.size())
-				{
-					p_out_reflection_data.descriptorSets.resize(parent_descriptor_set + 1);
-				}
-
-				DescriptorSet &descriptor_set = p_out_reflection_data.descriptorSets[parent_descriptor_set];
+			p_reflection_data.descriptorSets.resize(p_set + 1);
+		}
+		return p_reflection_data.descriptorSets[p_set];
+	}
 
-				UniformBuffer uniform_buffer{};
-				uniform_buffer.binding     = binding_index;
-				uniform_buffer.size        = size;
-				uniform_buffer.name        = ubo_name;
-				uniform_buffer.shaderStage = nvrhi::ShaderType::All;
+	static EShaderInputType getImageSamplerType(spv::Dim p_dim)
+	{
+		switch (p_dim)
+		{
+			case spv::Dim1D:
+				return EShaderInputType::eImageSampler1D;
+			case spv::Dim2D:
+			case spv::DimCube:
+				return EShaderInputType::eImageSampler2D;
+			case spv::Dim3D:
+				return EShaderInputType::eImageSampler3D;
+			default:
+				return EShaderInputType::eUnknown;
+		}
+	}
 
-				descriptor_set.uniformBuffers[binding_index] = uniform_buffer;
+	void reflectShaderStage(nvrhi::ShaderType p_stage, ShaderBlob p_shader_binary, ReflectionData &p_out_reflection_data)
+	{
+		reflectShaderStage(p_stage, p_shader_binary.data(), p_shader_binary.size(), p_out_reflection_data);
+	}
 
-				LOG_INFO("{}, ({} : {})", ubo_name, parent_descriptor_set, binding_index);
-				LOG_INFO("{}", member_count);
-				LOG_INFO("{}", size);
-			}
-		}
+	void reflectShaderStage(nvrhi::ShaderType p_stage, const ShaderBinary &p_shader_binary, ReflectionData &p_out_reflection_data)
+	{
+		reflectShaderStage(p_stage, p_shader_binary.data(), p_shader_binary.size(), p_out_reflection_data);
 	}
 
-	void reflectShaderStage(nvrhi::ShaderType p_stage, const std::vector<uint32> &p_shader_binary, ReflectionData &p_out_reflection_data)
+	void reflectShaderStage(nvrhi::ShaderType p_stage, const uint32 *p_blob_data, uint64 p_blob_size, ReflectionData &p_out_reflection_data)
 	{
-		spirv_cross::Compiler compiler(p_shader_binary);
+		spirv_cross::Compiler compiler(p_blob_data, p_blob_size);
 
 		auto resources = compiler.get_shader_resources();
 
@@ -60,19 +54,14 @@ namespace toaster::gpu::reflection
 
 			if (!active_buffers.empty())
 			{
-				const auto &ubo_name              = ubo.name;
-				auto &      ubo_type              = compiler.get_type(ubo.base_type_id);
-				int32       member_count          = ubo_type.member_types.size();
-				uint32      binding_index         = compiler.get_decoration(ubo.id, spv::DecorationBinding);
-				uint32      parent_descriptor_set = compiler.get_decoration(ubo.id, spv::DecorationDescriptorSet);
-				uint32      size                  = compiler.get_declared_struct_size(ubo_type);
-
-				if (parent_descriptor_set >= p_out_reflection_data.descriptorSets.size())
-				{
-					p_out_reflection_data.descriptorSets.resize(parent_descriptor_set + 1);
-				}
+				const StringId ubo_name              = StringId::intern(ubo.name);
+				auto &         ubo_type              = compiler.get_type(ubo.base_type_id);
+				int32          member_count          = ubo_type.member_types.size();
+				uint32         binding_index         = compiler.get_decoration(ubo.id, spv::DecorationBinding);
+				uint32         parent_descriptor_set = compiler.get_decoration(ubo.id, spv::DecorationDescriptorSet);
+				uint32         size                  = compiler.get_declared_struct_size(ubo_type);
 
-				DescriptorSet &descriptor_set = p_out_reflection_data.descriptorSets[parent_descriptor_set];
+				DescriptorSet &descriptor_set = getDescriptorSet(p_out_reflection_data, parent_descriptor_set);
 
 				UniformBuffer uniform_buffer{};
 				uniform_buffer.binding     = binding_index;
@@ -82,51 +71,58 @@ namespace toaster::gpu::reflection
 
 				descriptor_set.uniformBuffers[binding_index] = uniform_buffer;
 
+				ShaderInputDeclaration &declaration = descriptor_set.inputDeclarations[ubo_name];
+				declaration.name                    = ubo_name;
+				declaration.type                    = EShaderInputType::eUniformBuffer;
+				declaration.set                     = parent_descriptor_set;
+				declaration.binding                 = binding_index;
+				declaration.count                   = 1u;
+
 				LOG_INFO("{}, ({} : {})", ubo_name, parent_descriptor_set, binding_index);
 				LOG_INFO("{}", member_count);
 				LOG_INFO("{}", size);
 			}
 		}
+
+		for (const auto &image: resources.sampled_images)
+		{
+			const StringId image_name            = StringId::intern(image.name);
+			auto &         image_type            = compiler.get_type(image.type_id);
+			uint32         binding_index         = compiler.get_decoration(image.id, spv::DecorationBinding);
+			uint32         parent_descriptor_set = compiler.get_decoration(image.id, spv::DecorationDescriptorSet);
+			uint32         array_size            = image_type.array.empty() ? 1u : image_type.array[0];
+
+			DescriptorSet &descriptor_set = getDescriptorSet(p_out_reflection_data, parent_descriptor_set);
+
+			ImageSampler image_sampler{};
+			image_sampler.binding     = binding_index;
+			image_sampler.dimension   = image_type.image.dim;
+			image_sampler.arraySize   = array_size;
+			image_sampler.name        = image_name;
+			image_sampler.shaderStage = p_stage;
+
+			descriptor_set.imageSamplers[binding_index] = image_sampler;
+
+			ShaderInputDeclaration &declaration = descriptor_set.inputDeclarations[image_name];
+			declaration.name                    = image_name;
+			declaration.type                    = getImageSamplerType(image_type.image.dim);
+			declaration.set                     = parent_descriptor_set;
+			declaration.binding                 = binding_index;
+			declaration.count                   = array_size;
+
+			LOG_INFO("{}, ({} : {})", image_name, parent_descriptor_set, binding_index);
+		}
 	}
 
-	void reflectShaderStage(nvrhi::ShaderType p_stage, const uint32 *p_blob_data, uint64 p_blob_size, ReflectionData &p_out_reflection_data)
+	const ShaderInputDeclaration *findInputDeclaration(const ReflectionData &p_reflection_data, StringId p_name)
 	{
-		spirv_cross::Compiler compiler(p_blob_data, p_blob_size);
-
-		auto resources = compiler.get_shader_resources();
-
-		for (const auto &ubo: resources.uniform_buffers)
+		for (const DescriptorSet &descriptor_set: p_reflection_data.descriptorSets)
 		{
-			auto active_buffers = compiler.get_active_buffer_ranges(ubo.id);
-
-			if (!active_buffers.empty())
+			if (const auto it = descriptor_set.inputDeclarations.find(p_name); it != descriptor_set.inputDeclarations.end())
 			{
-				const auto &ubo_name              = ubo.name;
-				auto &      ubo_type              = compiler.get_type(ubo.base_type_id);
-				int32       member_count          = ubo_type.member_types.size();
-				uint32      binding_index         = compiler.get_decoration(ubo.id, spv::DecorationBinding);
-				uint32      parent_descriptor_set = compiler.get_decoration(ubo.id, spv::DecorationDescriptorSet);
-				uint32      size                  = compiler.get_declared_struct_size(ubo_type);
-
-				if (parent_descriptor_set >= p_out_reflection_data.descriptorSets.size())
-				{
-					p_out_reflection_data.descriptorSets.resize(parent_descriptor_set + 1);
-				}
-
-				DescriptorSet &descriptor_set = p_out_reflection_data.descriptorSets[parent_descriptor_set];
-
-				UniformBuffer uniform_buffer{};
-				uniform_buffer.binding     = binding_index;
-				uniform_buffer.size        = size;
-				uniform_buffer.name        = ubo_name;
-				uniform_buffer.shaderStage = nvrhi::ShaderType::All;
-
-				descriptor_set.uniformBuffers[binding_index] = uniform_buffer;
-
-				LOG_INFO("{}, ({} : {})", ubo_name, parent_descriptor_set, binding_index);
-				LOG_INFO("{}", member_count);
-				LOG_INFO("{}", size);
+				return &it->second;
 			}
 		}
+		return nullptr;
 	}
 }
@@ -4,6 +4,7 @@
 #include <nvrhi/nvrhi.h>
 #include <vulkan/vulkan.hpp>
 #include "shader_common.hpp"
+#include "string_id.hpp"
 
 namespace toaster::gpu::reflection
 {
@@ -22,7 +23,7 @@ namespace toaster::gpu::reflection
 
 	struct ShaderInputDeclaration
 	{
-		std::string      name;
+		StringId         name;
 		EShaderInputType type{EShaderInputType::eUnknown};
 		uint32           set{0u};
 		uint32           binding{0u};
@@ -34,7 +35,7 @@ namespace toaster::gpu::reflection
 		vk::DescriptorBufferInfo descriptor;
 		uint32                   size{0u};
 		uint32                   binding{0u};
-		std::string              name;
+		StringId                 name;
 		nvrhi::ShaderType        shaderStage{nvrhi::ShaderType::None};
 	};
 
@@ -43,7 +44,7 @@ namespace toaster::gpu::reflection
 		uint32            binding{0u};
 		uint32            dimension{0u};
 		uint32            arraySize{0u};
-		std::string       name;
+		StringId          name;
 		nvrhi::ShaderType shaderStage{nvrhi::ShaderType::None};
 	};
 
@@ -52,7 +53,8 @@ namespace toaster::gpu::reflection
 		std::unordered_map<uint32, UniformBuffer> uniformBuffers;
 		std::unordered_map<uint32, ImageSampler>  imageSamplers;
 
-		std::unordered_map<std::string, ShaderInputDeclaration> inputDeclarations;
+		// Keyed by the resource name, the names are interned so they can still be printed
+		std::unordered_map<StringId, ShaderInputDeclaration> inputDeclarations;
 	};
 
 	struct ReflectionData
@@ -61,6 +63,9 @@ namespace toaster::gpu::reflection
 	};
 
 	void reflectShaderStage(nvrhi::ShaderType p_stage, ShaderBlob p_shader_binary, ReflectionData &p_out_reflection_data);
-	void reflectShaderStage(nvrhi::ShaderType p_stage, const std::vector<uint32> &p_shader_binary, ReflectionData &p_out_reflection_data);
+	void reflectShaderStage(nvrhi::ShaderType p_stage, const ShaderBinary &p_shader_binary, ReflectionData &p_out_reflection_data);
 	void reflectShaderStage(nvrhi::ShaderType p_stage, const uint32 *p_blob_data, uint64 p_blob_size, ReflectionData &p_out_reflection_data);
+
+	// Searches every descriptor set, nullptr if no resource has that name
+	[[nodiscard]] const ShaderInputDeclaration *findInputDeclaration(const ReflectionData &p_reflection_data, StringId p_name);
 }
@@ -0,0 +1,80 @@
+#include "staging_ring.hpp"
+#include "gpu_context.hpp"
+
+namespace toaster::gpu
+{
+	// The part being written plus one for every frame present() may still have queued
+	static_assert(StagingRing::c_partCount == GPUContext::c_maxFramesInFlight + 1u);
+
+	StagingRing::StagingRing(GPUContext *p_ctx, const uint64 p_capacity) : m_gpuContext(p_ctx), m_partSize(p_capacity / c_partCount)
+	{
+		TST_ASSERT_MSG(m_partSize > 0u, "Staging ring too small to split between the frames");
+
+		nvrhi::IDevice *device = m_gpuContext->getNVRHIDevice();
+
+		nvrhi::BufferDesc buffer_desc{};
+		buffer_desc.byteSize         = m_partSize * c_partCount;
+		buffer_desc.debugName        = "Staging ring";
+		buffer_desc.cpuAccess        = nvrhi::CpuAccessMode::Write;
+		buffer_desc.initialState     = nvrhi::ResourceStates::CopySource;
+		buffer_desc.keepInitialState = true;
+		m_buffer                     = device->createBuffer(buffer_desc);
+		TST_ASSERT_MSG(m_buffer, "Failed to create the staging ring buffer");
+
+		// Host coherent, so it stays mapped and writes need no flush. Mapped before any use, nothing to wait for
+		m_mapped = static_cast<uint8 *>(device->mapBuffer(m_buffer, nvrhi::CpuAccessMode::Write));
+		TST_ASSERT_MSG(m_mapped != nullptr, "Failed to map the staging ring buffer");
+
+		m_commandList = device->createCommandList();
+	}
+
+	StagingRing::~StagingRing()
+	{
+		// Anything recorded still runs, the buffer only goes once the GPU is done with it
+		submit();
+		m_gpuContext->getNVRHIDevice()->waitForIdle();
+		m_gpuContext->getNVRHIDevice()->unmapBuffer(m_buffer);
+	}
+
+	void StagingRing::beginFrame()
+	{
+		TST_ASSERT_MSG(!m_recording, "Staging ring copies were never submitted");
+
+		m_partIndex  = (m_partIndex + 1u) % c_partCount;
+		m_partOffset = 0u;
+	}
+
+	bool StagingRing::allocate(const uint64 p_size_bytes, Allocation &p_out)
+	{
+		if (p_size_bytes > getFreeBytes())
+			return false;
+
+		const uint64 offset = m_partIndex * m_partSize + m_partOffset;
+		m_partOffset += p_size_bytes;
+
+		p_out.buffer = m_buffer;
+		p_out.offset = offset;
+		p_out.data   = m_mapped + offset;
+		return true;
+	}
+
+	nvrhi::ICommandList *StagingRing::getCommandList()
+	{
+		if (!m_recording)
+		{
+			m_commandList->open();
+			m_recording = true;
+		}
+		return m_commandList;
+	}
+
+	void StagingRing::submit()
+	{
+		if (!m_recording)
+			return;
+
+		m_commandList->close();
+		m_gpuContext->getNVRHIDevice()->executeCommandList(m_commandList);
+		m_recording = false;
+	}
+}
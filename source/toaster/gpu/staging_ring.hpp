@@ -0,0 +1,64 @@
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include "system_types.h"
+
+namespace toaster::gpu
+{
+	class GPUContext;
+
+	// The staging memory every streamed buffer upload goes through: one host visible buffer, mapped for its whole life
+	// and split into a part per frame. A frame's writes are carved from its part and their copies recorded into the
+	// ring's command list, which submit() hands to the GPU ahead of the frame's own commands. beginFrame() moves on to
+	// the part of the oldest frame, whose copies the GPU is done with by then. Nothing is allocated per upload, and what
+	// a frame can stage is bounded by getFreeBytes(). Only meant to be used from the thread that drives the frame loop
+	class StagingRing
+	{
+	public:
+		// present() lets c_maxFramesInFlight frames sit on the GPU while the next one is recorded
+		static constexpr uint32 c_partCount{4u};
+
+		struct Allocation
+		{
+			nvrhi::IBuffer *buffer{nullptr};
+			uint64          offset{0u}; // Into buffer, for the copy's source offset
+			void *          data{nullptr};
+		};
+
+		// p_capacity is split evenly between the parts
+		StagingRing(GPUContext *p_ctx, uint64 p_capacity);
+		~StagingRing();
+
+		StagingRing(const StagingRing &)            = delete;
+		StagingRing &operator=(const StagingRing &) = delete;
+
+		// After the previous frame's submit()
+		void beginFrame();
+
+		// False if the frame's part has less than p_size_bytes left. Byte granular, copyBuffer() needs no alignment, so
+		// any split of getFreeBytes() fits
+		[[nodiscard]] bool allocate(uint64 p_size_bytes, Allocation &p_out);
+
+		// Where the frame's copies go, opened on first use
+		[[nodiscard]] nvrhi::ICommandList *getCommandList();
+		// Executes what was recorded since the last call, if anything. Once per frame before its draws, the blocking
+		// loads call it too
+		void submit();
+
+		[[nodiscard]] uint64 getFreeBytes() const { return m_partSize - m_partOffset; }
+		[[nodiscard]] uint64 getPartSize() const { return m_partSize; }
+
+	private:
+		GPUContext *m_gpuContext{nullptr};
+
+		nvrhi::BufferHandle      m_buffer;
+		uint8 *                  m_mapped{nullptr};
+		nvrhi::CommandListHandle m_commandList;
+		bool                     m_recording{false};
+
+		uint64 m_partSize{0u};
+		uint32 m_partIndex{0u};
+		uint64 m_partOffset{0u}; // Bytes handed out from the current part
+	};
+}
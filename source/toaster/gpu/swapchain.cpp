@@ -2,6 +2,7 @@
 
 #include "gpu_context.hpp"
 #include "toast_assert.h"
+#include "memory/scratch_arena.hpp"
 
 namespace toaster::gpu
 {
@@ -24,11 +25,18 @@ namespace toaster::gpu
 
 		vk::PresentModeKHR present_mode = m_gpuContext->choosePresentMode(swapchain_support_details.presentModes);
 
-		std::unordered_set<uint32> unique_queues = {
-			static_cast<uint32>(m_gpuContext->getQueueFamilyIndices().graphics),
-			static_cast<uint32>(m_gpuContext->getQueueFamilyIndices().present)
-		};
-		std::vector<uint32> queues = {unique_queues.begin(), unique_queues.end()};
+		// The temporaries below only live until the swapchain is created, keep them off the heap since this runs on every resize
+		memory::ScratchScope scratch;
+
+		const auto graphics_queue = static_cast<uint32>(m_gpuContext->getQueueFamilyIndices().graphics);
+		const auto present_queue  = static_cast<uint32>(m_gpuContext->getQueueFamilyIndices().present);
+
+		std::pmr::vector<uint32> queues{scratch.getResource()};
+		queues.push_back(graphics_queue);
+		if (present_queue != graphics_queue)
+		{
+			queues.push_back(present_queue);
+		}
 
 		const bool enable_swapchain_sharing = queues.size() > 1;
 
@@ -57,11 +65,11 @@ namespace toaster::gpu
 		swapchain_create_info.clipped        = vk::True;
 		swapchain_create_info.oldSwapchain   = nullptr;
 
-		bool mutable_format_supported = m_gpuContext->isDeviceExtensionEnabled(VK_KHR_SWAPCHAIN_MUTABLE_FORMAT_EXTENSION_NAME);
+		bool mutable_format_supported = m_gpuContext->isDeviceExtensionEnabled(StringId(VK_KHR_SWAPCHAIN_MUTABLE_FORMAT_EXTENSION_NAME));
 
 		swapchain_create_info.flags = mutable_format_supported ? vk::SwapchainCreateFlagBitsKHR::eMutableFormat : static_cast<vk::SwapchainCreateFlagBitsKHR>(0);
 
-		std::vector<vk::Format> image_formats = {m_swapchainFormat.format};
+		std::pmr::vector<vk::Format> image_formats{{m_swapchainFormat.format}, scratch.getResource()};
 		switch (m_swapchainFormat.format)
 		{
 			case vk::Format::eR8G8B8A8Unorm:
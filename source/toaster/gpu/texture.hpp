@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.hpp>
 
 #include "system_types.h"
+#include "memory/tracked_allocator.hpp"
 
 namespace toaster::gpu
 {
@@ -11,6 +12,8 @@ namespace toaster::gpu
 	class Texture
 	{
 	public:
+		TST_DECLARE_TAGGED_NEW(memory::EMemoryTag::eTexture)
+
 		Texture(GPUContext *p_ctx, const std::string &p_path);
 		~Texture();
 
@@ -1,42 +1,44 @@
 #include "vertex_buffer.hpp"
 #include "gpu_context.hpp"
 
+#include <cstring>
+
 namespace toaster::gpu
 {
-	VertexBuffer::VertexBuffer(GPUContext *p_ctx, void *p_data, vk::DeviceSize p_size_bytes) : m_gpuContext(p_ctx)
+	VertexBuffer::VertexBuffer(GPUContext *p_ctx, const void *p_data, const uint64 p_size_bytes) : VertexBuffer(p_ctx, p_size_bytes)
 	{
-		const vk::Device device = m_gpuContext->getLogicalDevice();
-
-		// Create staging buffer
-		vk::Buffer       stagingBuffer;
-		vk::DeviceMemory stagingMemory;
-		// m_gpuContext->createBuffer(p_size_bytes, vk::BufferUsageFlagBits::eTransferSrc,
-								   // vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, stagingBuffer, stagingMemory);
-
-		// Copy vertex data to staging buffer
-		void *data = nullptr;
-		vk::detail::resultCheck(device.mapMemory(stagingMemory, 0, p_size_bytes, static_cast<vk::MemoryMapFlagBits>(0), &data),
-								"Failed to map vertex staging buffer memory");
-		std::memcpy(data, p_data, p_size_bytes);
-		device.unmapMemory(stagingMemory);
-
-		// Create device-local vertex buffer
-		// m_gpuContext->createBuffer(p_size_bytes, vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal,
-								   // m_buffer, m_bufferMemory);
-
-		// Copy from staging to device-local buffer
-		// m_gpuContext->copyBuffer(stagingBuffer, m_buffer, p_size_bytes);
-
-		// Clean up staging buffer
-		device.destroyBuffer(stagingBuffer);
-		device.freeMemory(stagingMemory);
+		write(m_gpuContext->getStagingRing().getCommandList(), 0u, p_data, p_size_bytes);
+	}
+
+	VertexBuffer::VertexBuffer(GPUContext *p_ctx, const uint64 p_size_bytes) : m_gpuContext(p_ctx), m_size(p_size_bytes)
+	{
+		nvrhi::BufferDesc buffer_desc{};
+		buffer_desc.byteSize       = p_size_bytes;
+		buffer_desc.debugName      = "Vertex buffer";
+		buffer_desc.isVertexBuffer = true;
+		buffer_desc.enableAutomaticStateTracking(nvrhi::ResourceStates::VertexBuffer);
+		m_buffer = m_gpuContext->getNVRHIDevice()->createBuffer(buffer_desc);
+		TST_ASSERT_MSG(m_buffer, "Failed to create vertex buffer");
+	}
+
+	bool VertexBuffer::write(const uint64 p_offset, const void *p_data, const uint64 p_size_bytes)
+	{
+		TST_ASSERT_MSG(p_offset <= m_size && p_size_bytes <= m_size - p_offset, "Vertex buffer write out of range");
+
+		StagingRing &           ring = m_gpuContext->getStagingRing();
+		StagingRing::Allocation staging;
+		if (!ring.allocate(p_size_bytes, staging))
+			return false;
+
+		std::memcpy(staging.data, p_data, p_size_bytes);
+		ring.getCommandList()->copyBuffer(m_buffer, p_offset, staging.buffer, staging.offset, p_size_bytes);
+		return true;
 	}
 
-	VertexBuffer::~VertexBuffer()
+	void VertexBuffer::write(nvrhi::ICommandList *p_command_list, const uint64 p_offset, const void *p_data, const uint64 p_size_bytes)
 	{
-		const vk::Device device = m_gpuContext->getLogicalDevice();
+		TST_ASSERT_MSG(p_offset <= m_size && p_size_bytes <= m_size - p_offset, "Vertex buffer write out of range");
 
-		device.destroyBuffer(m_buffer);
-		device.freeMemory(m_bufferMemory);
+		p_command_list->writeBuffer(m_buffer, p_data, p_size_bytes, p_offset);
 	}
 }
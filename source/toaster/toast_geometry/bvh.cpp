@@ -0,0 +1,520 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <numeric>
+#include <vector>
+
+#include "logging.hpp"
+#include "toast_assert.h"
+#include "jobs/job_system.hpp"
+#include "math/math_simd_wide.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		// Subtrees smaller than this are finished by the job that reached them
+		constexpr uint32 c_parallelSubtreeTriangles{8192u};
+
+		// Cost of visiting a node relative to one triangle test
+		constexpr float c_traversalCost{1.0f};
+
+		constexpr float c_miss{FLT_MAX};
+
+		struct Aabb
+		{
+			glm::vec3 min{FLT_MAX};
+			glm::vec3 max{-FLT_MAX};
+
+			void grow(const glm::vec3 &p_point)
+			{
+				min = glm::min(min, p_point);
+				max = glm::max(max, p_point);
+			}
+
+			void grow(const Aabb &p_other)
+			{
+				min = glm::min(min, p_other.min);
+				max = glm::max(max, p_other.max);
+			}
+
+			[[nodiscard]] float getHalfArea() const
+			{
+				if (min.x > max.x)
+					return 0.0f;
+
+				const glm::vec3 size = max - min;
+				return size.x * size.y + size.y * size.z + size.z * size.x;
+			}
+		};
+
+		struct BuildPrimitive
+		{
+			Aabb      bounds;
+			glm::vec3 centroid;
+		};
+
+		struct Bin
+		{
+			Aabb   bounds;
+			uint32 count{0u};
+		};
+
+		struct BuildContext
+		{
+			const std::vector<BuildPrimitive> &primitives;
+			std::span<uint32>                  ids;
+			std::span<BvhNode>                 nodes;
+			uint32                             maxLeafTriangles;
+			uint32                             binCount;
+			bool                               parallel;
+			std::atomic<uint32>                nodeCount{1u};
+		};
+
+		struct SplitCandidate
+		{
+			float  cost{FLT_MAX};
+			int32  axis{-1};
+			uint32 bin{0u};
+		};
+
+		uint32 getBin(float p_centroid, float p_min, float p_scale, uint32 p_bin_count)
+		{
+			return std::min(p_bin_count - 1u, static_cast<uint32>((p_centroid - p_min) * p_scale));
+		}
+
+		SplitCandidate findBestSplit(const BuildContext &p_context, uint32 p_first, uint32 p_count, const Aabb &p_centroid_bounds)
+		{
+			const uint32 bin_count = p_context.binCount;
+
+			SplitCandidate best;
+			for (int32 axis = 0; axis < 3; axis++)
+			{
+				const float extent = p_centroid_bounds.max[axis] - p_centroid_bounds.min[axis];
+				if (extent <= 0.0f)
+					continue;
+
+				const float scale = static_cast<float>(bin_count) / extent;
+
+				Bin bins[Bvh::c_maxBinCount];
+				for (uint32 i = p_first; i < p_first + p_count; i++)
+				{
+					const BuildPrimitive &primitive = p_context.primitives[p_context.ids[i]];
+					Bin &                 bin       = bins[getBin(primitive.centroid[axis], p_centroid_bounds.min[axis], scale, bin_count)];
+					bin.bounds.grow(primitive.bounds);
+					bin.count++;
+				}
+
+				// Sweep from the left storing the prefix areas, then from the right evaluating every plane
+				float  left_area[Bvh::c_maxBinCount];
+				uint32 left_count[Bvh::c_maxBinCount];
+
+				Aabb   accumulated;
+				uint32 count = 0u;
+				for (uint32 bin = 0u; bin < bin_count - 1u; bin++)
+				{
+					accumulated.grow(bins[bin].bounds);
+					count += bins[bin].count;
+					left_area[bin]  = accumulated.getHalfArea();
+					left_count[bin] = count;
+				}
+
+				accumulated = {};
+				count       = 0u;
+				for (uint32 bin = bin_count - 1u; bin > 0u; bin--)
+				{
+					accumulated.grow(bins[bin].bounds);
+					count += bins[bin].count;
+
+					if (count == 0u || left_count[bin - 1u] == 0u)
+						continue;
+
+					const float cost = static_cast<float>(left_count[bin - 1u]) * left_area[bin - 1u] + static_cast<float>(count) * accumulated.getHalfArea();
+					if (cost < best.cost)
+					{
+						best.cost = cost;
+						best.axis = axis;
+						best.bin  = bin;
+					}
+				}
+			}
+			return best;
+		}
+
+		void buildNode(BuildContext &p_context, uint32 p_node, uint32 p_first, uint32 p_count, uint32 p_depth)
+		{
+			Aabb bounds;
+			Aabb centroid_bounds;
+			for (uint32 i = p_first; i < p_first + p_count; i++)
+			{
+				const BuildPrimitive &primitive = p_context.primitives[p_context.ids[i]];
+				bounds.grow(primitive.bounds);
+				centroid_bounds.grow(primitive.centroid);
+			}
+
+			BvhNode &node      = p_context.nodes[p_node];
+			node.boundsMin     = bounds.min;
+			node.boundsMax     = bounds.max;
+			node.leftFirst     = p_first;
+			node.triangleCount = p_count;
+
+			// The traversal stacks are c_maxDepth deep
+			if (p_count <= 1u || p_depth + 1u >= Bvh::c_maxDepth)
+				return;
+
+			const SplitCandidate split = findBestSplit(p_context, p_first, p_count, centroid_bounds);
+
+			// No split when every centroid is in the same place
+			if (split.axis < 0)
+				return;
+
+			const float split_cost = c_traversalCost + split.cost / bounds.getHalfArea();
+			if (p_count <= p_context.maxLeafTriangles && split_cost >= static_cast<float>(p_count))
+				return;
+
+			const int32  axis  = split.axis;
+			const float  min   = centroid_bounds.min[axis];
+			const float  scale = static_cast<float>(p_context.binCount) / (centroid_bounds.max[axis] - min);
+			uint32 *     begin = p_context.ids.data() + p_first;
+			uint32 *     end   = begin + p_count;
+			const uint32 *middle = std::partition(begin, end, [&](uint32 p_id)
+			{
+				return getBin(p_context.primitives[p_id].centroid[axis], min, scale, p_context.binCount) < split.bin;
+			});
+
+			const uint32 left_count = static_cast<uint32>(middle - begin);
+			TST_ASSERT_MSG(left_count > 0u && left_count < p_count, "SAH split produced an empty child");
+
+			const uint32 left  = p_context.nodeCount.fetch_add(2u, std::memory_order_relaxed);
+			node.leftFirst     = left;
+			node.triangleCount = 0u;
+
+			if (p_context.parallel && p_count >= c_parallelSubtreeTriangles)
+			{
+				// The left subtree is up for grabs by any idle worker, this thread builds the right one and then
+				// helps with queued jobs until the left one is done
+				jobs::JobCounter left_done;
+				jobs::run([&p_context, left, p_first, left_count, p_depth]
+				{
+					buildNode(p_context, left, p_first, left_count, p_depth + 1u);
+				}, &left_done);
+				buildNode(p_context, left + 1u, p_first + left_count, p_count - left_count, p_depth + 1u);
+				jobs::waitFor(left_done);
+			}
+			else
+			{
+				buildNode(p_context, left, p_first, left_count, p_depth + 1u);
+				buildNode(p_context, left + 1u, p_first + left_count, p_count - left_count, p_depth + 1u);
+			}
+		}
+
+		// Entry distance of the ray into the node's bounds, c_miss when it misses or enters beyond p_t_max
+		float intersectBounds(const BvhNode &p_node, const glm::vec3 &p_origin, const glm::vec3 &p_inv_direction, float p_t_min, float p_t_max)
+		{
+			const glm::vec3 t0 = (p_node.boundsMin - p_origin) * p_inv_direction;
+			const glm::vec3 t1 = (p_node.boundsMax - p_origin) * p_inv_direction;
+
+			const glm::vec3 t_near = glm::min(t0, t1);
+			const glm::vec3 t_far  = glm::max(t0, t1);
+
+			const float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, p_t_min));
+			const float exit  = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, p_t_max)) * c_slabExitScale;
+			return enter <= exit ? enter : c_miss;
+		}
+
+		struct PacketSetup
+		{
+			alignas(32) float inverseX[RayPacket8::c_size];
+			alignas(32) float inverseY[RayPacket8::c_size];
+			alignas(32) float inverseZ[RayPacket8::c_size];
+			alignas(32) float tFar[RayPacket8::c_size];
+		};
+
+		#if TSM_SIMD_AVX2
+		using PacketOps = tsm::simd::Avx2Ops;
+		#elif TSM_SIMD_SSE4
+		using PacketOps = tsm::simd::Sse4Ops;
+		#else
+		using PacketOps = tsm::simd::ScalarOps;
+		#endif
+
+		// Bit per ray of the packet that enters the node's bounds before its current closest hit
+		uint32 intersectBounds(const BvhNode &p_node, const RayPacket8 &p_packet, const PacketSetup &p_setup)
+		{
+			using Ops = PacketOps;
+			using V   = Ops::type;
+
+			constexpr uint32 c_chunkLanes = static_cast<uint32>((1ull << Ops::c_width) - 1u);
+
+			const V min_x = Ops::set1(p_node.boundsMin.x), min_y = Ops::set1(p_node.boundsMin.y), min_z = Ops::set1(p_node.boundsMin.z);
+			const V max_x = Ops::set1(p_node.boundsMax.x), max_y = Ops::set1(p_node.boundsMax.y), max_z = Ops::set1(p_node.boundsMax.z);
+
+			const V exit_scale = Ops::set1(c_slabExitScale);
+
+			uint32 mask = 0u;
+			for (uint32 lane = 0u; lane < RayPacket8::c_size; lane += Ops::c_width)
+			{
+				const V origin_x = Ops::load(p_packet.originX + lane);
+				const V origin_y = Ops::load(p_packet.originY + lane);
+				const V origin_z = Ops::load(p_packet.originZ + lane);
+				const V inv_x    = Ops::load(p_setup.inverseX + lane);
+				const V inv_y    = Ops::load(p_setup.inverseY + lane);
+				const V inv_z    = Ops::load(p_setup.inverseZ + lane);
+
+				const V t0_x = Ops::mul(Ops::sub(min_x, origin_x), inv_x);
+				const V t1_x = Ops::mul(Ops::sub(max_x, origin_x), inv_x);
+				const V t0_y = Ops::mul(Ops::sub(min_y, origin_y), inv_y);
+				const V t1_y = Ops::mul(Ops::sub(max_y, origin_y), inv_y);
+				const V t0_z = Ops::mul(Ops::sub(min_z, origin_z), inv_z);
+				const V t1_z = Ops::mul(Ops::sub(max_z, origin_z), inv_z);
+
+				const V enter = Ops::max(Ops::max(Ops::min(t0_x, t1_x), Ops::min(t0_y, t1_y)), Ops::max(Ops::min(t0_z, t1_z), Ops::load(p_packet.tMin + lane)));
+				const V exit  = Ops::mul(Ops::min(Ops::min(Ops::max(t0_x, t1_x), Ops::max(t0_y, t1_y)), Ops::min(Ops::max(t0_z, t1_z), Ops::load(p_setup.tFar + lane))), exit_scale);
+
+				mask |= (~Ops::lessMask(exit, enter) & c_chunkLanes) << lane;
+			}
+			return mask;
+		}
+	}
+
+	bool Bvh::build(const TriangleMeshView &p_mesh, const BvhBuildSettings &p_settings)
+	{
+		clear();
+
+		const uint32 triangle_count = p_mesh.getTriangleCount();
+		if (triangle_count == 0u)
+		{
+			LOG_WARN("Bvh::build: the mesh has no triangles");
+			return false;
+		}
+
+		const auto get_vertex = [&](uint32 p_triangle, uint32 p_corner) -> const glm::vec3 &
+		{
+			const uint32 index = p_mesh.indices[p_triangle * 3u + p_corner];
+			TST_ASSERT_MSG(index < p_mesh.vertexCount, "Triangle index out of range");
+			return p_mesh.getPosition(index);
+		};
+
+		std::vector<BuildPrimitive> primitives(triangle_count);
+		for (uint32 triangle = 0u; triangle < triangle_count; triangle++)
+		{
+			BuildPrimitive &primitive = primitives[triangle];
+			primitive.bounds.grow(get_vertex(triangle, 0u));
+			primitive.bounds.grow(get_vertex(triangle, 1u));
+			primitive.bounds.grow(get_vertex(triangle, 2u));
+			primitive.centroid = (primitive.bounds.min + primitive.bounds.max) * 0.5f;
+		}
+
+		m_triangleIds.resize(triangle_count);
+		std::iota(m_triangleIds.begin(), m_triangleIds.end(), 0u);
+
+		// A binary tree with one triangle per leaf has 2n - 1 nodes, the most the build can produce
+		m_nodes.resize(triangle_count * 2u - 1u);
+
+		BuildContext context{
+			.primitives       = primitives,
+			.ids              = m_triangleIds,
+			.nodes            = m_nodes,
+			.maxLeafTriangles = std::max(p_settings.maxLeafTriangles, 1u),
+			.binCount         = std::clamp(p_settings.binCount, 2u, c_maxBinCount),
+			.parallel         = p_settings.parallel && jobs::isInitialized() && jobs::getWorkerCount() > 1u,
+		};
+		buildNode(context, 0u, 0u, triangle_count, 0u);
+
+		m_nodes.resize(context.nodeCount.load());
+		m_nodes.shrink_to_fit();
+
+		m_triangles.resize(triangle_count);
+		for (uint32 i = 0u; i < triangle_count; i++)
+		{
+			const uint32 triangle = m_triangleIds[i];
+			m_triangles[i]        = {get_vertex(triangle, 0u), get_vertex(triangle, 1u), get_vertex(triangle, 2u)};
+		}
+		return true;
+	}
+
+	void Bvh::clear()
+	{
+		m_nodes.clear();
+		m_triangles.clear();
+		m_triangleIds.clear();
+	}
+
+	bool Bvh::intersect(const Ray &p_ray, RayHit &p_hit) const
+	{
+		if (m_nodes.empty())
+			return false;
+
+		const WatertightRay ray(p_ray);
+		const glm::vec3     inv_direction = getSafeInverse(p_ray.direction);
+
+		RayHit hit;
+		hit.t = std::min(p_ray.tMax, p_hit.t);
+
+		struct StackEntry
+		{
+			uint32 node;
+			float  distance;
+		};
+
+		StackEntry stack[c_maxDepth];
+		uint32     stack_size = 0u;
+
+		if (intersectBounds(m_nodes[0], p_ray.origin, inv_direction, p_ray.tMin, hit.t) != c_miss)
+			stack[stack_size++] = {0u, p_ray.tMin};
+
+		while (stack_size)
+		{
+			const StackEntry entry = stack[--stack_size];
+			if (entry.distance >= hit.t)
+				continue;
+
+			uint32 node_index = entry.node;
+			while (true)
+			{
+				const BvhNode &node = m_nodes[node_index];
+				if (node.isLeaf())
+				{
+					for (uint32 i = node.leftFirst; i < node.leftFirst + node.triangleCount; i++)
+					{
+						intersectTriangle(ray, m_triangles[i].v0, m_triangles[i].v1, m_triangles[i].v2, p_ray.tMin, i, hit);
+					}
+					break;
+				}
+
+				// Visit the nearer child first and come back for the other one
+				uint32 near     = node.leftFirst;
+				uint32 far      = near + 1u;
+				float  near_hit = intersectBounds(m_nodes[near], p_ray.origin, inv_direction, p_ray.tMin, hit.t);
+				float  far_hit  = intersectBounds(m_nodes[far], p_ray.origin, inv_direction, p_ray.tMin, hit.t);
+				if (far_hit < near_hit)
+				{
+					std::swap(near, far);
+					std::swap(near_hit, far_hit);
+				}
+
+				if (near_hit == c_miss)
+					break;
+
+				if (far_hit != c_miss)
+					stack[stack_size++] = {far, far_hit};
+
+				node_index = near;
+			}
+		}
+
+		if (!hit.isHit())
+			return false;
+
+		hit.triangle = m_triangleIds[hit.triangle];
+		p_hit        = hit;
+		return true;
+	}
+
+	bool Bvh::intersectAny(const Ray &p_ray) const
+	{
+		if (m_nodes.empty())
+			return false;
+
+		const WatertightRay ray(p_ray);
+		const glm::vec3     inv_direction = getSafeInverse(p_ray.direction);
+
+		RayHit hit;
+		hit.t = p_ray.tMax;
+
+		uint32 stack[c_maxDepth];
+		uint32 stack_size = 0u;
+		stack[stack_size++] = 0u;
+
+		while (stack_size)
+		{
+			const BvhNode &node = m_nodes[stack[--stack_size]];
+			if (intersectBounds(node, p_ray.origin, inv_direction, p_ray.tMin, p_ray.tMax) == c_miss)
+				continue;
+
+			if (node.isLeaf())
+			{
+				for (uint32 i = node.leftFirst; i < node.leftFirst + node.triangleCount; i++)
+				{
+					if (intersectTriangle(ray, m_triangles[i].v0, m_triangles[i].v1, m_triangles[i].v2, p_ray.tMin, i, hit))
+						return true;
+				}
+				continue;
+			}
+
+			stack[stack_size++] = node.leftFirst + 1u;
+			stack[stack_size++] = node.leftFirst;
+		}
+		return false;
+	}
+
+	void Bvh::intersect(const RayPacket8 &p_packet, RayHit *p_hits) const
+	{
+		if (m_nodes.empty())
+			return;
+
+		PacketSetup   setup;
+		WatertightRay rays[RayPacket8::c_size];
+		RayHit        hits[RayPacket8::c_size];
+		for (uint32 lane = 0u; lane < RayPacket8::c_size; lane++)
+		{
+			const Ray ray = p_packet.getRay(lane);
+
+			const glm::vec3 inv_direction = getSafeInverse(ray.direction);
+
+			rays[lane]           = WatertightRay(ray);
+			setup.inverseX[lane] = inv_direction.x;
+			setup.inverseY[lane] = inv_direction.y;
+			setup.inverseZ[lane] = inv_direction.z;
+			setup.tFar[lane]     = std::min(ray.tMax, p_hits[lane].t);
+			hits[lane].t         = setup.tFar[lane];
+		}
+
+		uint32 stack[c_maxDepth];
+		uint32 stack_size = 0u;
+		stack[stack_size++] = 0u;
+
+		while (stack_size)
+		{
+			const BvhNode &node   = m_nodes[stack[--stack_size]];
+			const uint32   active = intersectBounds(node, p_packet, setup);
+			if (!active)
+				continue;
+
+			if (node.isLeaf())
+			{
+				for (uint32 lanes = active; lanes; lanes &= lanes - 1u)
+				{
+					const uint32 lane = static_cast<uint32>(std::countr_zero(lanes));
+					for (uint32 i = node.leftFirst; i < node.leftFirst + node.triangleCount; i++)
+					{
+						if (intersectTriangle(rays[lane], m_triangles[i].v0, m_triangles[i].v1, m_triangles[i].v2, p_packet.tMin[lane], i, hits[lane]))
+							setup.tFar[lane] = hits[lane].t;
+					}
+				}
+				continue;
+			}
+
+			// Order the children along the first active ray, the packet is assumed to be roughly coherent
+			const uint32    first     = static_cast<uint32>(std::countr_zero(active));
+			const glm::vec3 direction = {p_packet.directionX[first], p_packet.directionY[first], p_packet.directionZ[first]};
+			const BvhNode & left      = m_nodes[node.leftFirst];
+			const BvhNode & right     = m_nodes[node.leftFirst + 1u];
+			const bool      left_near = glm::dot(left.boundsMin + left.boundsMax - right.boundsMin - right.boundsMax, direction) <= 0.0f;
+
+			stack[stack_size++] = left_near ? node.leftFirst + 1u : node.leftFirst;
+			stack[stack_size++] = left_near ? node.leftFirst : node.leftFirst + 1u;
+		}
+
+		for (uint32 lane = 0u; lane < RayPacket8::c_size; lane++)
+		{
+			if (!hits[lane].isHit())
+				continue;
+
+			hits[lane].triangle = m_triangleIds[hits[lane].triangle];
+			p_hits[lane]        = hits[lane];
+		}
+	}
+}
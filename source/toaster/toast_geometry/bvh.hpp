@@ -0,0 +1,95 @@
+#pragma once
+
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+#include "memory/tracked_allocator.hpp"
+
+#include "ray.hpp"
+
+namespace toaster::geometry
+{
+	// Indexed triangle list with positions inside interleaved vertices, e.g. {&vertices[0].position, sizeof(Vertex)}
+	struct TriangleMeshView
+	{
+		const void *positions{nullptr};
+		uint64      positionStride{sizeof(glm::vec3)};
+		uint32      vertexCount{0u};
+
+		std::span<const uint32> indices;
+
+		[[nodiscard]] uint32 getTriangleCount() const { return static_cast<uint32>(indices.size() / 3u); }
+
+		[[nodiscard]] const glm::vec3 &getPosition(uint32 p_vertex) const
+		{
+			return *reinterpret_cast<const glm::vec3 *>(static_cast<const uint8 *>(positions) + p_vertex * positionStride);
+		}
+	};
+
+	// 32 bytes, two nodes per cache line. Children of an interior node are always allocated as a pair, the right
+	// child is leftFirst + 1
+	struct BvhNode
+	{
+		glm::vec3 boundsMin;
+		uint32    leftFirst; // Left child for interior nodes, first triangle for leaves
+		glm::vec3 boundsMax;
+		uint32    triangleCount; // 0 for interior nodes
+
+		[[nodiscard]] bool isLeaf() const { return triangleCount != 0u; }
+	};
+
+	static_assert(sizeof(BvhNode) == 32);
+
+	// Triangle positions copied in leaf order so leaves read them sequentially
+	struct BvhTriangle
+	{
+		glm::vec3 v0;
+		glm::vec3 v1;
+		glm::vec3 v2;
+	};
+
+	struct BvhBuildSettings
+	{
+		uint32 maxLeafTriangles{4u};
+		uint32 binCount{16u}; // Candidate SAH split planes per axis, at most c_maxBinCount
+		bool   parallel{true}; // Big subtrees become jobs while the job system is running
+	};
+
+	// Binary BVH over the triangles of one mesh, built with binned SAH. Subtrees are built as jobs once they are
+	// big enough
+	class Bvh
+	{
+	public:
+		static constexpr uint32 c_maxBinCount{32u};
+		static constexpr uint32 c_maxDepth{64u};
+
+		// Returns false if the mesh has no triangles
+		bool build(const TriangleMeshView &p_mesh, const BvhBuildSettings &p_settings = {});
+		void clear();
+
+		// Closest hit along the ray, p_hit is only written when something closer than p_hit.t is found
+		bool intersect(const Ray &p_ray, RayHit &p_hit) const;
+
+		// Any hit in (tMin, tMax), stops at the first one. For shadow and line of sight queries
+		[[nodiscard]] bool intersectAny(const Ray &p_ray) const;
+
+		// Closest hit for each ray of the packet, p_hits must point at RayPacket8::c_size hits
+		void intersect(const RayPacket8 &p_packet, RayHit *p_hits) const;
+
+		[[nodiscard]] bool                         isBuilt() const { return !m_nodes.empty(); }
+		[[nodiscard]] std::span<const BvhNode>     getNodes() const { return m_nodes; }
+		[[nodiscard]] std::span<const BvhTriangle> getTriangles() const { return m_triangles; }
+		// Source triangle index of every entry in getTriangles()
+		[[nodiscard]] std::span<const uint32> getTriangleIds() const { return m_triangleIds; }
+
+		[[nodiscard]] glm::vec3 getBoundsMin() const { return m_nodes.empty() ? glm::vec3(0.0f) : m_nodes[0].boundsMin; }
+		[[nodiscard]] glm::vec3 getBoundsMax() const { return m_nodes.empty() ? glm::vec3(0.0f) : m_nodes[0].boundsMax; }
+
+	private:
+		memory::TrackedVector<BvhNode, memory::EMemoryTag::eMesh>     m_nodes;
+		memory::TrackedVector<BvhTriangle, memory::EMemoryTag::eMesh> m_triangles;
+		memory::TrackedVector<uint32, memory::EMemoryTag::eMesh>      m_triangleIds;
+	};
+}
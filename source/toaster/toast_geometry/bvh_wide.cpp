@@ -0,0 +1,236 @@
+#include "bvh_wide.hpp"
+
+#include <bit>
+
+#include "math/math_simd_wide.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		#if TSM_SIMD_SSE4
+		using NodeOps = tsm::simd::Sse4Ops;
+		#else
+		using NodeOps = tsm::simd::ScalarOps;
+		#endif
+
+		float getHalfArea(const BvhNode &p_node)
+		{
+			const glm::vec3 size = p_node.boundsMax - p_node.boundsMin;
+			return size.x * size.y + size.y * size.z + size.z * size.x;
+		}
+
+		// Tests the ray against all four boxes, returns a bit per child it enters and writes the entry distances
+		uint32 intersectChildren(const BvhNode4 &p_node, const glm::vec3 &p_origin, const glm::vec3 &p_inv_direction, float p_t_min, float p_t_max, float *p_out_enter)
+		{
+			using Ops = NodeOps;
+			using V   = Ops::type;
+
+			constexpr uint32 c_chunkLanes = static_cast<uint32>((1ull << Ops::c_width) - 1u);
+
+			const V origin_x = Ops::set1(p_origin.x), origin_y = Ops::set1(p_origin.y), origin_z = Ops::set1(p_origin.z);
+			const V inv_x = Ops::set1(p_inv_direction.x), inv_y = Ops::set1(p_inv_direction.y), inv_z = Ops::set1(p_inv_direction.z);
+			const V t_min = Ops::set1(p_t_min);
+			const V t_max = Ops::set1(p_t_max);
+
+			const V exit_scale = Ops::set1(c_slabExitScale);
+
+			uint32 mask = 0u;
+			for (uint32 lane = 0u; lane < BvhNode4::c_width; lane += Ops::c_width)
+			{
+				const V t0_x = Ops::mul(Ops::sub(Ops::load(p_node.boundsMinX + lane), origin_x), inv_x);
+				const V t1_x = Ops::mul(Ops::sub(Ops::load(p_node.boundsMaxX + lane), origin_x), inv_x);
+				const V t0_y = Ops::mul(Ops::sub(Ops::load(p_node.boundsMinY + lane), origin_y), inv_y);
+				const V t1_y = Ops::mul(Ops::sub(Ops::load(p_node.boundsMaxY + lane), origin_y), inv_y);
+				const V t0_z = Ops::mul(Ops::sub(Ops::load(p_node.boundsMinZ + lane), origin_z), inv_z);
+				const V t1_z = Ops::mul(Ops::sub(Ops::load(p_node.boundsMaxZ + lane), origin_z), inv_z);
+
+				const V enter = Ops::max(Ops::max(Ops::min(t0_x, t1_x), Ops::min(t0_y, t1_y)), Ops::max(Ops::min(t0_z, t1_z), t_min));
+				const V exit  = Ops::mul(Ops::min(Ops::min(Ops::max(t0_x, t1_x), Ops::max(t0_y, t1_y)), Ops::min(Ops::max(t0_z, t1_z), t_max)), exit_scale);
+
+				Ops::store(p_out_enter + lane, enter);
+				mask |= (~Ops::lessMask(exit, enter) & c_chunkLanes) << lane;
+			}
+			return mask;
+		}
+	}
+
+	void Bvh4::build(const Bvh &p_source)
+	{
+		clear();
+		if (!p_source.isBuilt())
+			return;
+
+		// Leaves keep the binary tree's triangle ranges, so the triangles are copied in the same order
+		m_triangles.assign(p_source.getTriangles().begin(), p_source.getTriangles().end());
+		m_triangleIds.assign(p_source.getTriangleIds().begin(), p_source.getTriangleIds().end());
+
+		m_nodes.reserve(p_source.getNodes().size() / 2u + 1u);
+		_collapse(p_source.getNodes(), 0u);
+	}
+
+	void Bvh4::clear()
+	{
+		m_nodes.clear();
+		m_triangles.clear();
+		m_triangleIds.clear();
+	}
+
+	uint32 Bvh4::_collapse(const std::span<const BvhNode> p_binary, const uint32 p_binary_node)
+	{
+		const std::span<const BvhNode> binary = p_binary;
+
+		// Open up the largest interior child until there are four
+		uint32 children[BvhNode4::c_width];
+		uint32 child_count = 0u;
+
+		if (binary[p_binary_node].isLeaf())
+		{
+			children[child_count++] = p_binary_node;
+		}
+		else
+		{
+			children[child_count++] = binary[p_binary_node].leftFirst;
+			children[child_count++] = binary[p_binary_node].leftFirst + 1u;
+		}
+
+		while (child_count < BvhNode4::c_width)
+		{
+			int32 largest      = -1;
+			float largest_area = -1.0f;
+			for (uint32 i = 0u; i < child_count; i++)
+			{
+				if (!binary[children[i]].isLeaf() && getHalfArea(binary[children[i]]) > largest_area)
+				{
+					largest      = static_cast<int32>(i);
+					largest_area = getHalfArea(binary[children[i]]);
+				}
+			}
+
+			if (largest < 0)
+				break;
+
+			const uint32 opened     = children[largest];
+			children[largest]       = binary[opened].leftFirst;
+			children[child_count++] = binary[opened].leftFirst + 1u;
+		}
+
+		const uint32 node_index = static_cast<uint32>(m_nodes.size());
+		m_nodes.emplace_back();
+
+		for (uint32 slot = 0u; slot < BvhNode4::c_width; slot++)
+		{
+			// Filled through the index, the recursion below grows m_nodes
+			if (slot >= child_count)
+			{
+				BvhNode4 &node           = m_nodes[node_index];
+				node.boundsMinX[slot]    = 0.0f;
+				node.boundsMinY[slot]    = 0.0f;
+				node.boundsMinZ[slot]    = 0.0f;
+				node.boundsMaxX[slot]    = 0.0f;
+				node.boundsMaxY[slot]    = 0.0f;
+				node.boundsMaxZ[slot]    = 0.0f;
+				node.child[slot]         = BvhNode4::c_emptyChild;
+				node.triangleCount[slot] = 0u;
+				continue;
+			}
+
+			const BvhNode &child = binary[children[slot]];
+			const uint32   index = child.isLeaf() ? child.leftFirst : _collapse(p_binary, children[slot]);
+
+			BvhNode4 &node           = m_nodes[node_index];
+			node.boundsMinX[slot]    = child.boundsMin.x;
+			node.boundsMinY[slot]    = child.boundsMin.y;
+			node.boundsMinZ[slot]    = child.boundsMin.z;
+			node.boundsMaxX[slot]    = child.boundsMax.x;
+			node.boundsMaxY[slot]    = child.boundsMax.y;
+			node.boundsMaxZ[slot]    = child.boundsMax.z;
+			node.child[slot]         = index;
+			node.triangleCount[slot] = child.triangleCount;
+		}
+		return node_index;
+	}
+
+	bool Bvh4::intersect(const Ray &p_ray, RayHit &p_hit) const
+	{
+		if (m_nodes.empty())
+			return false;
+
+		const WatertightRay ray(p_ray);
+		const glm::vec3     inv_direction = getSafeInverse(p_ray.direction);
+
+		const std::span<const BvhTriangle> triangles = m_triangles;
+
+		RayHit hit;
+		hit.t = std::min(p_ray.tMax, p_hit.t);
+
+		struct StackEntry
+		{
+			uint32 node;
+			float  distance;
+		};
+
+		// Up to three children are deferred per level
+		StackEntry stack[Bvh::c_maxDepth * 3u];
+		uint32     stack_size = 0u;
+		stack[stack_size++]   = {0u, p_ray.tMin};
+
+		while (stack_size)
+		{
+			const StackEntry entry = stack[--stack_size];
+			if (entry.distance >= hit.t)
+				continue;
+
+			const BvhNode4 &node = m_nodes[entry.node];
+
+			alignas(16) float enter[BvhNode4::c_width];
+			uint32            mask = intersectChildren(node, p_ray.origin, inv_direction, p_ray.tMin, hit.t, enter);
+
+			// Leaves are intersected right away, interior children are pushed far to near
+			StackEntry interior[BvhNode4::c_width];
+			uint32     interior_count = 0u;
+			for (; mask; mask &= mask - 1u)
+			{
+				const uint32 slot = static_cast<uint32>(std::countr_zero(mask));
+				if (node.child[slot] == BvhNode4::c_emptyChild)
+					continue;
+
+				if (node.triangleCount[slot] == 0u)
+				{
+					interior[interior_count++] = {node.child[slot], enter[slot]};
+					continue;
+				}
+
+				for (uint32 i = node.child[slot]; i < node.child[slot] + node.triangleCount[slot]; i++)
+				{
+					intersectTriangle(ray, triangles[i].v0, triangles[i].v1, triangles[i].v2, p_ray.tMin, i, hit);
+				}
+			}
+
+			// Insertion sort, at most four entries
+			for (uint32 i = 1u; i < interior_count; i++)
+			{
+				const StackEntry entry_to_insert = interior[i];
+
+				uint32 j = i;
+				for (; j > 0u && interior[j - 1u].distance < entry_to_insert.distance; j--)
+				{
+					interior[j] = interior[j - 1u];
+				}
+				interior[j] = entry_to_insert;
+			}
+
+			for (uint32 i = 0u; i < interior_count; i++)
+			{
+				stack[stack_size++] = interior[i];
+			}
+		}
+
+		if (!hit.isHit())
+			return false;
+
+		hit.triangle = m_triangleIds[hit.triangle];
+		p_hit        = hit;
+		return true;
+	}
+}
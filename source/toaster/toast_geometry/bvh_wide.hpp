@@ -0,0 +1,48 @@
+#pragma once
+
+#include "bvh.hpp"
+
+namespace toaster::geometry
+{
+	// Four children in structure of arrays layout so one ray tests all four boxes with a single SIMD pass.
+	// 128 bytes, two cache lines
+	struct alignas(64) BvhNode4
+	{
+		static constexpr uint32 c_width{4u};
+		static constexpr uint32 c_emptyChild{UINT32_MAX};
+
+		float  boundsMinX[c_width];
+		float  boundsMinY[c_width];
+		float  boundsMinZ[c_width];
+		float  boundsMaxX[c_width];
+		float  boundsMaxY[c_width];
+		float  boundsMaxZ[c_width];
+		uint32 child[c_width];         // Node index for interior children, first triangle for leaves, c_emptyChild for unused slots
+		uint32 triangleCount[c_width]; // 0 for interior children
+	};
+
+	static_assert(sizeof(BvhNode4) == 128);
+
+	// 4-wide BVH made by collapsing a binary Bvh, each node pulls up the grandchildren with the largest surface area
+	// until it has four children. Half the depth of the binary tree, so fewer, wider node visits for single rays
+	class Bvh4
+	{
+	public:
+		// Copies what it needs, p_source can be changed or destroyed afterwards
+		void build(const Bvh &p_source);
+		void clear();
+
+		// Same contract as Bvh::intersect()
+		bool intersect(const Ray &p_ray, RayHit &p_hit) const;
+
+		[[nodiscard]] bool                      isBuilt() const { return !m_nodes.empty(); }
+		[[nodiscard]] std::span<const BvhNode4> getNodes() const { return m_nodes; }
+
+	private:
+		uint32 _collapse(std::span<const BvhNode> p_binary, uint32 p_binary_node);
+
+		memory::TrackedVector<BvhNode4, memory::EMemoryTag::eMesh>    m_nodes;
+		memory::TrackedVector<BvhTriangle, memory::EMemoryTag::eMesh> m_triangles;
+		memory::TrackedVector<uint32, memory::EMemoryTag::eMesh>      m_triangleIds;
+	};
+}
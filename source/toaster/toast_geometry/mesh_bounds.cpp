@@ -0,0 +1,182 @@
+#include "mesh_bounds.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "toast_assert.h"
+#include "math/math_simd.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		const glm::vec3 &getPosition(const uint8 *p_positions, const uint64 p_stride, const uint64 p_vertex)
+		{
+			return *reinterpret_cast<const glm::vec3 *>(p_positions + p_vertex * p_stride);
+		}
+	}
+
+	void computeAabb(const void *p_positions, const uint64 p_position_stride, const uint64 p_count, glm::vec3 &p_out_min, glm::vec3 &p_out_max)
+	{
+		const uint8 *positions = static_cast<const uint8 *>(p_positions);
+		glm::vec3    bounds_min(FLT_MAX);
+		glm::vec3    bounds_max(-FLT_MAX);
+		uint64       i = 0u;
+
+		#if TSM_SIMD_SSE4
+		// One unaligned load per position, the fourth lane is whatever follows it and is dropped at the end. The last
+		// position is left to the scalar loop, its load could read past the array. Two accumulators hide the min/max
+		// latency. The position goes first so a NaN in it keeps the accumulator, as glm::min() does
+		const uint64 simd_count = p_count - std::min<uint64>(p_count, 1u);
+		__m128       min0       = _mm_set1_ps(FLT_MAX);
+		__m128       max0       = _mm_set1_ps(-FLT_MAX);
+		__m128       min1       = min0;
+		__m128       max1       = max0;
+		for (; i + 2u <= simd_count; i += 2u)
+		{
+			const __m128 position0 = _mm_loadu_ps(reinterpret_cast<const float *>(positions + i * p_position_stride));
+			const __m128 position1 = _mm_loadu_ps(reinterpret_cast<const float *>(positions + (i + 1u) * p_position_stride));
+			min0                   = _mm_min_ps(position0, min0);
+			max0                   = _mm_max_ps(position0, max0);
+			min1                   = _mm_min_ps(position1, min1);
+			max1                   = _mm_max_ps(position1, max1);
+		}
+		if (i < simd_count)
+		{
+			const __m128 position = _mm_loadu_ps(reinterpret_cast<const float *>(positions + i * p_position_stride));
+			min0                  = _mm_min_ps(position, min0);
+			max0                  = _mm_max_ps(position, max0);
+			++i;
+		}
+
+		alignas(16) float lanes_min[4];
+		alignas(16) float lanes_max[4];
+		_mm_store_ps(lanes_min, _mm_min_ps(min0, min1));
+		_mm_store_ps(lanes_max, _mm_max_ps(max0, max1));
+		bounds_min = glm::vec3(lanes_min[0], lanes_min[1], lanes_min[2]);
+		bounds_max = glm::vec3(lanes_max[0], lanes_max[1], lanes_max[2]);
+		#endif
+
+		for (; i < p_count; i++)
+		{
+			const glm::vec3 &position = getPosition(positions, p_position_stride, i);
+			bounds_min                = glm::min(bounds_min, position);
+			bounds_max                = glm::max(bounds_max, position);
+		}
+
+		p_out_min = bounds_min;
+		p_out_max = bounds_max;
+	}
+
+	BoundingSphere computeBoundingSphere(const void *p_positions, const uint64 p_position_stride, const uint64 p_count)
+	{
+		if (p_count == 0u)
+			return {glm::vec3(0.0f), 0.0f};
+
+		const uint8 *positions = static_cast<const uint8 *>(p_positions);
+
+		// Pass one: the extreme points along each axis, which also give the box
+		uint64 min_vertex[3]{};
+		uint64 max_vertex[3]{};
+		for (uint64 i = 1u; i < p_count; i++)
+		{
+			const glm::vec3 &position = getPosition(positions, p_position_stride, i);
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (position[axis] < getPosition(positions, p_position_stride, min_vertex[axis])[axis])
+					min_vertex[axis] = i;
+				if (position[axis] > getPosition(positions, p_position_stride, max_vertex[axis])[axis])
+					max_vertex[axis] = i;
+			}
+		}
+
+		// Ritter starts from the pair of extremes furthest apart
+		int   start_axis     = 0;
+		float start_distance = -1.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const glm::vec3 span     = getPosition(positions, p_position_stride, max_vertex[axis]) - getPosition(positions, p_position_stride, min_vertex[axis]);
+			const float     distance = glm::dot(span, span);
+			if (distance > start_distance)
+			{
+				start_axis     = axis;
+				start_distance = distance;
+			}
+		}
+
+		const glm::vec3 &start_min = getPosition(positions, p_position_stride, min_vertex[start_axis]);
+		const glm::vec3 &start_max = getPosition(positions, p_position_stride, max_vertex[start_axis]);
+		glm::vec3        center    = (start_min + start_max) * 0.5f;
+		float            radius    = std::sqrt(start_distance) * 0.5f;
+
+		// Pass two: every point outside moves the sphere towards it just far enough to take it in
+		for (uint64 i = 0u; i < p_count; i++)
+		{
+			const glm::vec3 offset           = getPosition(positions, p_position_stride, i) - center;
+			const float     distance_squared = glm::dot(offset, offset);
+			if (distance_squared > radius * radius)
+			{
+				const float distance   = std::sqrt(distance_squared);
+				const float new_radius = (radius + distance) * 0.5f;
+				center += offset * ((new_radius - radius) / distance);
+				radius = new_radius;
+			}
+		}
+
+		// Pass three: the exact radius around Ritter's centre and around the box centre, the growth steps round and
+		// may leave a point a hair outside
+		const glm::vec3 box_min(getPosition(positions, p_position_stride, min_vertex[0]).x, getPosition(positions, p_position_stride, min_vertex[1]).y,
+								getPosition(positions, p_position_stride, min_vertex[2]).z);
+		const glm::vec3 box_max(getPosition(positions, p_position_stride, max_vertex[0]).x, getPosition(positions, p_position_stride, max_vertex[1]).y,
+								getPosition(positions, p_position_stride, max_vertex[2]).z);
+		const glm::vec3 box_center = (box_min + box_max) * 0.5f;
+
+		float ritter_squared = 0.0f;
+		float box_squared    = 0.0f;
+		for (uint64 i = 0u; i < p_count; i++)
+		{
+			const glm::vec3 &position      = getPosition(positions, p_position_stride, i);
+			const glm::vec3  ritter_offset = position - center;
+			const glm::vec3  box_offset    = position - box_center;
+			ritter_squared                 = std::max(ritter_squared, glm::dot(ritter_offset, ritter_offset));
+			box_squared                    = std::max(box_squared, glm::dot(box_offset, box_offset));
+		}
+
+		if (box_squared < ritter_squared)
+			return {box_center, std::sqrt(box_squared)};
+		return {center, std::sqrt(ritter_squared)};
+	}
+
+	SurfaceStats computeSurfaceStats(const std::span<const uint32> p_indices, const void *p_positions, const uint64 p_position_stride, const void *p_uvs,
+									 const uint64 p_uv_stride)
+	{
+		TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+		const uint8 *positions = static_cast<const uint8 *>(p_positions);
+		const uint8 *uvs       = static_cast<const uint8 *>(p_uvs);
+
+		// Summed in double, large meshes add millions of tiny areas
+		double surface_area = 0.0;
+		double uv_area      = 0.0;
+		for (uint64 i = 0u; i < p_indices.size(); i += 3u)
+		{
+			const glm::vec3 &p0 = getPosition(positions, p_position_stride, p_indices[i]);
+			const glm::vec3 &p1 = getPosition(positions, p_position_stride, p_indices[i + 1u]);
+			const glm::vec3 &p2 = getPosition(positions, p_position_stride, p_indices[i + 2u]);
+			surface_area += glm::length(glm::cross(p1 - p0, p2 - p0)) * 0.5;
+
+			if (uvs)
+			{
+				const glm::vec2 &uv0   = *reinterpret_cast<const glm::vec2 *>(uvs + p_indices[i] * p_uv_stride);
+				const glm::vec2 &uv1   = *reinterpret_cast<const glm::vec2 *>(uvs + p_indices[i + 1u] * p_uv_stride);
+				const glm::vec2 &uv2   = *reinterpret_cast<const glm::vec2 *>(uvs + p_indices[i + 2u] * p_uv_stride);
+				const glm::vec2  edge1 = uv1 - uv0;
+				const glm::vec2  edge2 = uv2 - uv0;
+				uv_area += std::abs(edge1.x * edge2.y - edge1.y * edge2.x) * 0.5;
+			}
+		}
+
+		return {static_cast<uint32>(p_indices.size() / 3u), static_cast<float>(surface_area), static_cast<float>(uv_area)};
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+
+namespace toaster::geometry
+{
+	struct BoundingSphere
+	{
+		glm::vec3 center;
+		float     radius;
+	};
+
+	// Triangle area sums for the LOD and texture streaming heuristics
+	struct SurfaceStats
+	{
+		uint32 triangleCount{0u};
+		float  surfaceArea{0.0f};
+		float  uvArea{0.0f};
+
+		// UV area per unit of surface area. Times a texture's texel count that is its texels per square unit, 0 for
+		// surfaces without any area or UVs
+		[[nodiscard]] float getUvDensity() const { return surfaceArea > 0.0f ? uvArea / surfaceArea : 0.0f; }
+	};
+
+	// Positions are read as three floats every p_position_stride bytes. Empty ranges give an inverted box and a zero
+	// sphere at the origin
+
+	// Min/max over all positions, four lanes at a time with SSE4 when it is enabled
+	void computeAabb(const void *p_positions, uint64 p_position_stride, uint64 p_count, glm::vec3 &p_out_min, glm::vec3 &p_out_max);
+
+	// Ritter's sphere (1990) grown from the most distant pair of axis extremes, or the sphere around the box centre
+	// if that one is tighter. Within a few percent of the minimal sphere for scanned and modelled meshes alike, three
+	// passes over the positions
+	BoundingSphere computeBoundingSphere(const void *p_positions, uint64 p_position_stride, uint64 p_count);
+
+	// Sums over a triangle list. p_uvs may be null, the UV area is 0 then
+	SurfaceStats computeSurfaceStats(std::span<const uint32> p_indices, const void *p_positions, uint64 p_position_stride, const void *p_uvs,
+									 uint64 p_uv_stride);
+}
@@ -0,0 +1,1001 @@
+#include "mesh_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "toast_assert.h"
+#include "math/math_simd.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		// First byte of every encoded buffer, the high nibble names the codec and the low one its version
+		constexpr uint8 c_vertexCodecHeader{0xA0u};
+		constexpr uint8 c_indexCodecHeader{0xE0u};
+		constexpr uint8 c_sequenceCodecHeader{0xD0u};
+
+		constexpr uint64 c_vertexBlockMaxBytes{8192u};
+		constexpr uint64 c_vertexBlockMaxSize{256u};
+		constexpr uint64 c_byteGroupSize{16u};
+		// A group decode loads at most 8 bytes of 4 bit deltas and then 16 escapes at once, the tail after the last
+		// block makes sure they are always there to load
+		constexpr uint64 c_byteGroupDecodeLimit{24u};
+		constexpr uint64 c_vertexTailMinSize{32u};
+
+		// Bits per delta of a byte group, indexed by its 2 bit code
+		constexpr uint32 c_groupBits[4]{0u, 2u, 4u, 8u};
+
+		uint64 getVertexBlockSize(const uint64 p_vertex_size)
+		{
+			return std::min((c_vertexBlockMaxBytes / p_vertex_size) & ~(c_byteGroupSize - 1u), c_vertexBlockMaxSize);
+		}
+
+		uint64 getVertexTailSize(const uint64 p_vertex_size)
+		{
+			return std::max(p_vertex_size, c_vertexTailMinSize);
+		}
+
+		uint64 roundToGroup(const uint64 p_count)
+		{
+			return (p_count + c_byteGroupSize - 1u) & ~(c_byteGroupSize - 1u);
+		}
+
+		// Small deltas either way become small bytes
+		uint8 zigzag8(const uint8 p_value)
+		{
+			return static_cast<uint8>((p_value << 1u) ^ static_cast<uint8>(static_cast<int8>(p_value) >> 7));
+		}
+
+		uint32 zigzag32(const uint32 p_value)
+		{
+			return (p_value << 1u) ^ static_cast<uint32>(static_cast<int32>(p_value) >> 31);
+		}
+
+		uint32 unzigzag32(const uint32 p_value)
+		{
+			return (p_value >> 1u) ^ (0u - (p_value & 1u));
+		}
+
+		void writeVarint(std::vector<uint8> &p_out, uint32 p_value)
+		{
+			while (p_value >= 0x80u)
+			{
+				p_out.push_back(static_cast<uint8>(p_value | 0x80u));
+				p_value >>= 7u;
+			}
+			p_out.push_back(static_cast<uint8>(p_value));
+		}
+
+		bool readVarint(const uint8 *&p_data, const uint8 *p_data_end, uint32 &p_out_value)
+		{
+			uint32 value = 0u;
+			for (uint32 shift = 0u; shift < 35u; shift += 7u)
+			{
+				if (p_data == p_data_end)
+					return false;
+
+				const uint8 byte = *p_data++;
+				value |= static_cast<uint32>(byte & 0x7Fu) << shift;
+				if (byte < 0x80u)
+				{
+					p_out_value = value;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Vertex codec, encoding
+
+		uint64 getGroupEncodedSize(const uint8 *p_group, const uint32 p_bits)
+		{
+			if (p_bits == 0u)
+				return std::all_of(p_group, p_group + c_byteGroupSize, [](const uint8 p_delta) { return p_delta == 0u; }) ? 0u : UINT64_MAX;
+			if (p_bits == 8u)
+				return c_byteGroupSize;
+
+			// The largest value is the escape, the real byte follows the packed ones
+			const uint32 sentinel = (1u << p_bits) - 1u;
+			const uint64 escapes  = std::count_if(p_group, p_group + c_byteGroupSize, [sentinel](const uint8 p_delta) { return p_delta >= sentinel; });
+			return c_byteGroupSize * p_bits / 8u + escapes;
+		}
+
+		uint8 *encodeGroup(uint8 *p_out, const uint8 *p_group, const uint32 p_bits)
+		{
+			if (p_bits == 0u)
+				return p_out;
+			if (p_bits == 8u)
+			{
+				std::memcpy(p_out, p_group, c_byteGroupSize);
+				return p_out + c_byteGroupSize;
+			}
+
+			// Packed from the high bits down, so the first delta of a byte is in its top bits
+			const uint32 sentinel = (1u << p_bits) - 1u;
+			const uint32 per_byte = 8u / p_bits;
+			for (uint64 i = 0u; i < c_byteGroupSize; i += per_byte)
+			{
+				uint32 byte = 0u;
+				for (uint32 j = 0u; j < per_byte; j++)
+				{
+					byte = (byte << p_bits) | std::min<uint32>(p_group[i + j], sentinel);
+				}
+				*p_out++ = static_cast<uint8>(byte);
+			}
+			for (uint64 i = 0u; i < c_byteGroupSize; i++)
+			{
+				if (p_group[i] >= sentinel)
+					*p_out++ = p_group[i];
+			}
+			return p_out;
+		}
+
+		// One byte column of a block: the groups' 2 bit codes, four to a byte, then the groups in order
+		void encodeBytes(std::vector<uint8> &p_out, const uint8 *p_bytes, const uint64 p_size)
+		{
+			const uint64 group_count   = p_size / c_byteGroupSize;
+			const uint64 header_offset = p_out.size();
+			p_out.resize(header_offset + (group_count + 3u) / 4u, 0u);
+
+			for (uint64 group = 0u; group < group_count; group++)
+			{
+				const uint8 *bytes = p_bytes + group * c_byteGroupSize;
+
+				uint32 best_code = 3u;
+				uint64 best_size = c_byteGroupSize;
+				for (uint32 code = 0u; code < 3u; code++)
+				{
+					const uint64 size = getGroupEncodedSize(bytes, c_groupBits[code]);
+					if (size < best_size)
+					{
+						best_code = code;
+						best_size = size;
+					}
+				}
+
+				p_out[header_offset + group / 4u] |= static_cast<uint8>(best_code << (group % 4u * 2u));
+
+				uint8  encoded[c_byteGroupSize * 2u];
+				uint8 *encoded_end = encodeGroup(encoded, bytes, c_groupBits[best_code]);
+				p_out.insert(p_out.end(), encoded, encoded_end);
+			}
+		}
+
+		void encodeVertexBlock(std::vector<uint8> &p_out, const uint8 *p_vertices, const uint64 p_count, const uint64 p_vertex_size, uint8 *p_last_vertex)
+		{
+			std::array<uint8, c_vertexBlockMaxSize> deltas{};
+			const uint64                             padded_count = roundToGroup(p_count);
+
+			for (uint64 k = 0u; k < p_vertex_size; k++)
+			{
+				uint8 previous = p_last_vertex[k];
+				for (uint64 i = 0u; i < p_count; i++)
+				{
+					const uint8 value = p_vertices[i * p_vertex_size + k];
+					deltas[i]         = zigzag8(static_cast<uint8>(value - previous));
+					previous          = value;
+				}
+				encodeBytes(p_out, deltas.data(), padded_count);
+			}
+
+			std::memcpy(p_last_vertex, p_vertices + (p_count - 1u) * p_vertex_size, p_vertex_size);
+		}
+
+		// Vertex codec, decoding
+
+		#if TSM_SIMD_SSE4
+		// For every 8 bit mask of escaped lanes: where each lane takes its escape from, 0x80 for none, and how many
+		// escapes the lanes use
+		struct EscapeShuffles
+		{
+			alignas(16) uint8 shuffles[256][8];
+			uint8 counts[256];
+		};
+
+		constexpr EscapeShuffles buildEscapeShuffles()
+		{
+			EscapeShuffles tables{};
+			for (uint32 mask = 0u; mask < 256u; mask++)
+			{
+				uint8 count = 0u;
+				for (uint32 lane = 0u; lane < 8u; lane++)
+				{
+					tables.shuffles[mask][lane] = (mask >> lane) & 1u ? count++ : 0x80u;
+				}
+				tables.counts[mask] = count;
+			}
+			return tables;
+		}
+
+		constexpr EscapeShuffles c_escapeShuffles = buildEscapeShuffles();
+
+		// Unpacks the deltas, then shuffles the escapes that follow them into the lanes holding the sentinel
+		TSM_INLINE const uint8 *decodeGroupPacked(const uint8 *p_data, uint8 *p_out, const __m128i p_deltas, const uint32 p_packed_size, const uint8 p_sentinel)
+		{
+			const __m128i escaped = _mm_cmpeq_epi8(p_deltas, _mm_set1_epi8(static_cast<char>(p_sentinel)));
+			const uint32  mask    = static_cast<uint32>(_mm_movemask_epi8(escaped));
+			const uint32  mask0   = mask & 0xFFu;
+			const uint32  mask1   = mask >> 8u;
+
+			// The high half's escapes come after the low half's, 0x80 plus the offset still reads as zero
+			const __m128i shuffle0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(c_escapeShuffles.shuffles[mask0]));
+			const __m128i shuffle1 = _mm_add_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(c_escapeShuffles.shuffles[mask1])),
+												  _mm_set1_epi8(static_cast<char>(c_escapeShuffles.counts[mask0])));
+			const __m128i escapes  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data + p_packed_size));
+			const __m128i result   = _mm_or_si128(_mm_shuffle_epi8(escapes, _mm_unpacklo_epi64(shuffle0, shuffle1)), _mm_andnot_si128(escaped, p_deltas));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(p_out), result);
+			return p_data + p_packed_size + c_escapeShuffles.counts[mask0] + c_escapeShuffles.counts[mask1];
+		}
+
+		TSM_INLINE const uint8 *decodeGroup(const uint8 *p_data, uint8 *p_out, const uint32 p_code)
+		{
+			switch (p_code)
+			{
+				case 0u:
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(p_out), _mm_setzero_si128());
+					return p_data;
+				case 1u:
+				{
+					// Spread each byte's four 2 bit deltas over four bytes: nibbles first, then the pairs in them
+					int32 packed;
+					std::memcpy(&packed, p_data, sizeof(packed));
+					const __m128i bytes   = _mm_cvtsi32_si128(packed);
+					const __m128i nibbles = _mm_unpacklo_epi8(_mm_srli_epi16(bytes, 4), bytes);
+					const __m128i pairs   = _mm_unpacklo_epi8(_mm_srli_epi16(nibbles, 2), nibbles);
+					return decodeGroupPacked(p_data, p_out, _mm_and_si128(pairs, _mm_set1_epi8(3)), 4u, 3u);
+				}
+				case 2u:
+				{
+					const __m128i bytes   = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p_data));
+					const __m128i nibbles = _mm_unpacklo_epi8(_mm_srli_epi16(bytes, 4), bytes);
+					return decodeGroupPacked(p_data, p_out, _mm_and_si128(nibbles, _mm_set1_epi8(15)), 8u, 15u);
+				}
+				default:
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(p_out), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_data)));
+					return p_data + c_byteGroupSize;
+			}
+		}
+
+		TSM_INLINE __m128i unzigzag8(const __m128i p_values)
+		{
+			const __m128i shifted = _mm_and_si128(_mm_srli_epi16(p_values, 1), _mm_set1_epi8(0x7F));
+			const __m128i sign    = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(p_values, _mm_set1_epi8(1)));
+			return _mm_xor_si128(shifted, sign);
+		}
+
+		// Running sum of four vertices' 4 byte slices on top of the previous vertex's, in p_carry's every lane
+		TSM_INLINE __m128i accumulate(__m128i p_deltas, __m128i &p_carry)
+		{
+			p_deltas = _mm_add_epi8(p_deltas, _mm_slli_si128(p_deltas, 4));
+			p_deltas = _mm_add_epi8(p_deltas, _mm_slli_si128(p_deltas, 8));
+			p_deltas = _mm_add_epi8(p_deltas, p_carry);
+			p_carry  = _mm_shuffle_epi32(p_deltas, TSM_SHUFFLE_MASK(3, 3, 3, 3));
+			return p_deltas;
+		}
+
+		TSM_INLINE void storeVertexSlices(uint8 *p_out, const uint64 p_vertex_size, const __m128i p_slices)
+		{
+			const int32 slices[4]{_mm_cvtsi128_si32(p_slices), _mm_extract_epi32(p_slices, 1), _mm_extract_epi32(p_slices, 2), _mm_extract_epi32(p_slices, 3)};
+			for (uint64 i = 0u; i < 4u; i++)
+			{
+				std::memcpy(p_out + i * p_vertex_size, &slices[i], sizeof(int32));
+			}
+		}
+		#if TSM_SIMD_AVX2
+		// The same for two slices side by side, slice k in the low lane and slice k + 4 in the high one. The byte
+		// shifts stay within a lane, so each lane sums and carries on its own
+		TSM_INLINE __m256i unzigzag8(const __m256i p_values)
+		{
+			const __m256i shifted = _mm256_and_si256(_mm256_srli_epi16(p_values, 1), _mm256_set1_epi8(0x7F));
+			const __m256i sign    = _mm256_sub_epi8(_mm256_setzero_si256(), _mm256_and_si256(p_values, _mm256_set1_epi8(1)));
+			return _mm256_xor_si256(shifted, sign);
+		}
+
+		TSM_INLINE __m256i accumulate(__m256i p_deltas, __m256i &p_carry)
+		{
+			p_deltas = _mm256_add_epi8(p_deltas, _mm256_slli_si256(p_deltas, 4));
+			p_deltas = _mm256_add_epi8(p_deltas, _mm256_slli_si256(p_deltas, 8));
+			p_deltas = _mm256_add_epi8(p_deltas, p_carry);
+			p_carry  = _mm256_shuffle_epi32(p_deltas, TSM_SHUFFLE_MASK(3, 3, 3, 3));
+			return p_deltas;
+		}
+
+		// Two slices of the same vertex are 8 bytes next to each other, one store per vertex
+		TSM_INLINE void storeVertexSlicePairs(uint8 *p_out, const uint64 p_vertex_size, const __m256i p_slices)
+		{
+			const __m128i low     = _mm256_castsi256_si128(p_slices);
+			const __m128i high    = _mm256_extracti128_si256(p_slices, 1);
+			const __m128i pairs01 = _mm_unpacklo_epi32(low, high);
+			const __m128i pairs23 = _mm_unpackhi_epi32(low, high);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(p_out), pairs01);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(p_out + p_vertex_size), _mm_unpackhi_epi64(pairs01, pairs01));
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(p_out + 2u * p_vertex_size), pairs23);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(p_out + 3u * p_vertex_size), _mm_unpackhi_epi64(pairs23, pairs23));
+		}
+
+		TSM_INLINE __m256i loadColumnPair(const uint8 *p_column, const uint64 p_slice_stride)
+		{
+			return unzigzag8(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_column))),
+													 _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_column + p_slice_stride)), 1));
+		}
+		#endif
+		#else
+		uint8 unzigzag8(const uint8 p_value)
+		{
+			return static_cast<uint8>((p_value >> 1u) ^ -(p_value & 1));
+		}
+
+		const uint8 *decodeGroup(const uint8 *p_data, uint8 *p_out, const uint32 p_code)
+		{
+			const uint32 bits = c_groupBits[p_code];
+			if (bits == 0u)
+			{
+				std::memset(p_out, 0, c_byteGroupSize);
+				return p_data;
+			}
+			if (bits == 8u)
+			{
+				std::memcpy(p_out, p_data, c_byteGroupSize);
+				return p_data + c_byteGroupSize;
+			}
+
+			const uint32 sentinel = (1u << bits) - 1u;
+			const uint32 per_byte = 8u / bits;
+			const uint8 *escapes  = p_data + c_byteGroupSize * bits / 8u;
+			for (uint32 i = 0u; i < c_byteGroupSize; i++)
+			{
+				const uint32 shift = 8u - bits * (i % per_byte + 1u);
+				const uint32 delta = (p_data[i / per_byte] >> shift) & sentinel;
+				p_out[i]           = delta == sentinel ? *escapes++ : static_cast<uint8>(delta);
+			}
+			return escapes;
+		}
+		#endif
+
+		const uint8 *decodeBytes(const uint8 *p_data, const uint8 *p_data_end, uint8 *p_out, const uint64 p_size)
+		{
+			const uint64 group_count = p_size / c_byteGroupSize;
+			const uint64 header_size = (group_count + 3u) / 4u;
+			if (static_cast<uint64>(p_data_end - p_data) < header_size)
+				return nullptr;
+
+			const uint8 *header = p_data;
+			p_data += header_size;
+			for (uint64 group = 0u; group < group_count; group++)
+			{
+				if (static_cast<uint64>(p_data_end - p_data) < c_byteGroupDecodeLimit)
+					return nullptr;
+
+				const uint32 code = (header[group / 4u] >> (group % 4u * 2u)) & 3u;
+				p_data            = decodeGroup(p_data, p_out + group * c_byteGroupSize, code);
+			}
+			return p_data;
+		}
+
+		// Turns four byte columns of zigzagged deltas, p_count apart, back into those bytes of p_count vertices
+		void decodeDeltas(const uint8 *p_deltas, const uint64 p_count, uint8 *p_out, const uint64 p_vertex_size, uint8 *p_last_slice)
+		{
+			#if TSM_SIMD_SSE4
+			int32 last;
+			std::memcpy(&last, p_last_slice, sizeof(last));
+			__m128i carry = _mm_set1_epi32(last);
+
+			// Transposes 16 vertices at a time, p_count is always whole groups
+			for (uint64 i = 0u; i < p_count; i += c_byteGroupSize)
+			{
+				const __m128i column0 = unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_deltas + i)));
+				const __m128i column1 = unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_deltas + p_count + i)));
+				const __m128i column2 = unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_deltas + p_count * 2u + i)));
+				const __m128i column3 = unzigzag8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_deltas + p_count * 3u + i)));
+
+				const __m128i pairs01_low  = _mm_unpacklo_epi8(column0, column1);
+				const __m128i pairs01_high = _mm_unpackhi_epi8(column0, column1);
+				const __m128i pairs23_low  = _mm_unpacklo_epi8(column2, column3);
+				const __m128i pairs23_high = _mm_unpackhi_epi8(column2, column3);
+
+				uint8 *out = p_out + i * p_vertex_size;
+				storeVertexSlices(out, p_vertex_size, accumulate(_mm_unpacklo_epi16(pairs01_low, pairs23_low), carry));
+				storeVertexSlices(out + 4u * p_vertex_size, p_vertex_size, accumulate(_mm_unpackhi_epi16(pairs01_low, pairs23_low), carry));
+				storeVertexSlices(out + 8u * p_vertex_size, p_vertex_size, accumulate(_mm_unpacklo_epi16(pairs01_high, pairs23_high), carry));
+				storeVertexSlices(out + 12u * p_vertex_size, p_vertex_size, accumulate(_mm_unpackhi_epi16(pairs01_high, pairs23_high), carry));
+			}
+
+			last = _mm_cvtsi128_si32(carry);
+			std::memcpy(p_last_slice, &last, sizeof(last));
+			#else
+			for (uint64 k = 0u; k < 4u; k++)
+			{
+				uint8 value = p_last_slice[k];
+				for (uint64 i = 0u; i < p_count; i++)
+				{
+					value += unzigzag8(p_deltas[k * p_count + i]);
+					p_out[i * p_vertex_size + k] = value;
+				}
+				p_last_slice[k] = value;
+			}
+			#endif
+		}
+
+		#if TSM_SIMD_AVX2
+		// decodeDeltas() for eight byte columns, two slices of p_count vertices at once
+		void decodeDeltasPair(const uint8 *p_deltas, const uint64 p_count, uint8 *p_out, const uint64 p_vertex_size, uint8 *p_last_slices)
+		{
+			int32 last[2];
+			std::memcpy(last, p_last_slices, sizeof(last));
+			__m256i carry = _mm256_setr_epi32(last[0], last[0], last[0], last[0], last[1], last[1], last[1], last[1]);
+
+			const uint64 slice_stride = p_count * 4u;
+			for (uint64 i = 0u; i < p_count; i += c_byteGroupSize)
+			{
+				const __m256i column0 = loadColumnPair(p_deltas + i, slice_stride);
+				const __m256i column1 = loadColumnPair(p_deltas + p_count + i, slice_stride);
+				const __m256i column2 = loadColumnPair(p_deltas + p_count * 2u + i, slice_stride);
+				const __m256i column3 = loadColumnPair(p_deltas + p_count * 3u + i, slice_stride);
+
+				const __m256i pairs01_low  = _mm256_unpacklo_epi8(column0, column1);
+				const __m256i pairs01_high = _mm256_unpackhi_epi8(column0, column1);
+				const __m256i pairs23_low  = _mm256_unpacklo_epi8(column2, column3);
+				const __m256i pairs23_high = _mm256_unpackhi_epi8(column2, column3);
+
+				uint8 *out = p_out + i * p_vertex_size;
+				storeVertexSlicePairs(out, p_vertex_size, accumulate(_mm256_unpacklo_epi16(pairs01_low, pairs23_low), carry));
+				storeVertexSlicePairs(out + 4u * p_vertex_size, p_vertex_size, accumulate(_mm256_unpackhi_epi16(pairs01_low, pairs23_low), carry));
+				storeVertexSlicePairs(out + 8u * p_vertex_size, p_vertex_size, accumulate(_mm256_unpacklo_epi16(pairs01_high, pairs23_high), carry));
+				storeVertexSlicePairs(out + 12u * p_vertex_size, p_vertex_size, accumulate(_mm256_unpackhi_epi16(pairs01_high, pairs23_high), carry));
+			}
+
+			last[0] = _mm256_cvtsi256_si32(carry);
+			last[1] = _mm256_extract_epi32(carry, 4);
+			std::memcpy(p_last_slices, last, sizeof(last));
+		}
+		#endif
+
+		const uint8 *decodeVertexBlock(const uint8 *p_data, const uint8 *p_data_end, uint8 *p_out, const uint64 p_count, const uint64 p_vertex_size,
+									   uint8 *p_last_vertex)
+		{
+			alignas(16) uint8 deltas[c_vertexBlockMaxSize * 8u];
+			alignas(16) uint8 vertices[c_vertexBlockMaxBytes];
+
+			// Decoded for the padded count, the padding's zero deltas repeat the last real vertex. Only a block that
+			// doesn't end on a whole group needs the copy, the others go straight to p_out
+			const uint64 padded_count = roundToGroup(p_count);
+			uint8 *      out          = padded_count == p_count ? p_out : vertices;
+			uint64       k            = 0u;
+			#if TSM_SIMD_AVX2
+			for (; k + 8u <= p_vertex_size; k += 8u)
+			{
+				for (uint64 column = 0u; column < 8u; column++)
+				{
+					p_data = decodeBytes(p_data, p_data_end, deltas + column * padded_count, padded_count);
+					if (!p_data)
+						return nullptr;
+				}
+				decodeDeltasPair(deltas, padded_count, out + k, p_vertex_size, p_last_vertex + k);
+			}
+			#endif
+			for (; k < p_vertex_size; k += 4u)
+			{
+				for (uint64 column = 0u; column < 4u; column++)
+				{
+					p_data = decodeBytes(p_data, p_data_end, deltas + column * padded_count, padded_count);
+					if (!p_data)
+						return nullptr;
+				}
+				decodeDeltas(deltas, padded_count, out + k, p_vertex_size, p_last_vertex + k);
+			}
+
+			if (out != p_out)
+				std::memcpy(p_out, vertices, p_count * p_vertex_size);
+			return p_data;
+		}
+
+		// Index codec. Edges are remembered the way the next triangle over would walk them, so a match can be used as
+		// it is. Code nibbles for a vertex: 0 the next new one, 1 to 14 the vertex FIFO's entries from the newest, 15 a
+		// varint delta in the data section. An edge nibble of 15 means no edge, the triangle's vertices follow instead
+
+		constexpr uint32 c_codecFifoSize{16u};
+		constexpr uint32 c_noEdge{15u};
+		constexpr uint32 c_nextVertex{0u};
+		constexpr uint32 c_explicitVertex{15u};
+
+		struct IndexCodecState
+		{
+			uint32 edges[c_codecFifoSize][2]{};
+			uint32 vertices[c_codecFifoSize]{};
+			uint32 edgeOffset{0u};
+			uint32 vertexOffset{0u};
+			uint32 next{0u}; // The vertex first use order expects next
+			uint32 last{0u}; // The last explicit vertex, deltas are against it
+
+			void pushEdge(const uint32 p_a, const uint32 p_b)
+			{
+				edges[edgeOffset % c_codecFifoSize][0] = p_a;
+				edges[edgeOffset % c_codecFifoSize][1] = p_b;
+				edgeOffset++;
+			}
+
+			void pushVertex(const uint32 p_vertex)
+			{
+				vertices[vertexOffset % c_codecFifoSize] = p_vertex;
+				vertexOffset++;
+			}
+
+			[[nodiscard]] const uint32 *getEdge(const uint32 p_age) const { return edges[(edgeOffset - 1u - p_age) % c_codecFifoSize]; }
+			[[nodiscard]] uint32        getVertex(const uint32 p_age) const { return vertices[(vertexOffset - 1u - p_age) % c_codecFifoSize]; }
+
+			// A vertex coded explicitly at or past next is where first use order carries on, e.g. when a range restarts
+			void setExplicit(const uint32 p_vertex)
+			{
+				last = p_vertex;
+				if (p_vertex >= next)
+					next = p_vertex + 1u;
+			}
+		};
+
+		// Picks the code for p_vertex and updates the state the way decoding it will
+		uint32 encodeVertex(IndexCodecState &p_state, const uint32 p_vertex, std::vector<uint8> &p_data)
+		{
+			if (p_vertex == p_state.next)
+			{
+				p_state.next++;
+				p_state.pushVertex(p_vertex);
+				return c_nextVertex;
+			}
+
+			for (uint32 age = 0u; age < c_explicitVertex - 1u; age++)
+			{
+				if (age < p_state.vertexOffset && p_state.getVertex(age) == p_vertex)
+					return age + 1u;
+			}
+
+			writeVarint(p_data, zigzag32(p_vertex - p_state.last));
+			p_state.setExplicit(p_vertex);
+			p_state.pushVertex(p_vertex);
+			return c_explicitVertex;
+		}
+
+		bool decodeVertex(IndexCodecState &p_state, const uint32 p_code, const uint8 *&p_data, const uint8 *p_data_end, uint32 &p_out_vertex)
+		{
+			if (p_code == c_nextVertex)
+			{
+				p_out_vertex = p_state.next++;
+				p_state.pushVertex(p_out_vertex);
+				return true;
+			}
+			if (p_code != c_explicitVertex)
+			{
+				p_out_vertex = p_state.getVertex(p_code - 1u);
+				return true;
+			}
+
+			uint32 delta;
+			if (!readVarint(p_data, p_data_end, delta))
+				return false;
+
+			p_out_vertex = p_state.last + unzigzag32(delta);
+			p_state.setExplicit(p_out_vertex);
+			p_state.pushVertex(p_out_vertex);
+			return true;
+		}
+	}
+
+	uint64 encodeVertexBuffer(const void *p_vertices, const uint64 p_vertex_count, const uint64 p_vertex_size, std::vector<uint8> &p_out)
+	{
+		TST_ASSERT_MSG(p_vertex_size > 0u && p_vertex_size % 4u == 0u && p_vertex_size <= c_maxCodecVertexSize, "Unsupported vertex size");
+
+		const uint64 start    = p_out.size();
+		const auto * vertices = static_cast<const uint8 *>(p_vertices);
+		p_out.push_back(c_vertexCodecHeader);
+
+		// The first vertex is the base of the first deltas, so every block decodes the same way
+		std::array<uint8, c_maxCodecVertexSize> last_vertex{};
+		if (p_vertex_count > 0u)
+			std::memcpy(last_vertex.data(), vertices, p_vertex_size);
+
+		const uint64 block_size = getVertexBlockSize(p_vertex_size);
+		for (uint64 i = 0u; i < p_vertex_count; i += block_size)
+		{
+			encodeVertexBlock(p_out, vertices + i * p_vertex_size, std::min(block_size, p_vertex_count - i), p_vertex_size, last_vertex.data());
+		}
+
+		// The tail holds the first vertex at its end, its padding is what the group decoding reads ahead into
+		const uint64 tail_size = getVertexTailSize(p_vertex_size);
+		p_out.resize(p_out.size() + tail_size, 0u);
+		if (p_vertex_count > 0u)
+			std::memcpy(p_out.data() + p_out.size() - p_vertex_size, vertices, p_vertex_size);
+		return p_out.size() - start;
+	}
+
+	bool decodeVertexBuffer(void *p_out_vertices, const uint64 p_vertex_count, const uint64 p_vertex_size, const std::span<const uint8> p_encoded)
+	{
+		TST_ASSERT_MSG(p_vertex_size > 0u && p_vertex_size % 4u == 0u && p_vertex_size <= c_maxCodecVertexSize, "Unsupported vertex size");
+
+		const uint64 tail_size = getVertexTailSize(p_vertex_size);
+		if (p_encoded.size() < 1u + tail_size || p_encoded[0] != c_vertexCodecHeader)
+			return false;
+
+		const uint8 *data     = p_encoded.data() + 1u;
+		const uint8 *data_end = p_encoded.data() + p_encoded.size();
+		auto *       out      = static_cast<uint8 *>(p_out_vertices);
+
+		std::array<uint8, c_maxCodecVertexSize> last_vertex;
+		std::memcpy(last_vertex.data(), data_end - p_vertex_size, p_vertex_size);
+
+		const uint64 block_size = getVertexBlockSize(p_vertex_size);
+		for (uint64 i = 0u; i < p_vertex_count; i += block_size)
+		{
+			data = decodeVertexBlock(data, data_end, out + i * p_vertex_size, std::min(block_size, p_vertex_count - i), p_vertex_size, last_vertex.data());
+			if (!data)
+				return false;
+		}
+		return static_cast<uint64>(data_end - data) == tail_size;
+	}
+
+	uint64 encodeIndexBuffer(const std::span<const uint32> p_indices, std::vector<uint8> &p_out)
+	{
+		TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+		const uint64 start          = p_out.size();
+		const uint64 triangle_count = p_indices.size() / 3u;
+		p_out.push_back(c_indexCodecHeader);
+
+		// One code byte per triangle up front, the data section they read from behind them
+		const uint64 code_offset = p_out.size();
+		p_out.resize(code_offset + triangle_count);
+
+		IndexCodecState    state;
+		std::vector<uint8> data;
+		for (uint64 triangle = 0u; triangle < triangle_count; triangle++)
+		{
+			const uint32 *corners = &p_indices[triangle * 3u];
+
+			// The newest edge any rotation of the triangle starts with
+			uint32 edge     = c_noEdge;
+			uint32 rotation = 0u;
+			for (uint32 age = 0u; age < c_noEdge && age < state.edgeOffset && edge == c_noEdge; age++)
+			{
+				const uint32 *fifo_edge = state.getEdge(age);
+				for (uint32 r = 0u; r < 3u; r++)
+				{
+					if (fifo_edge[0] == corners[r] && fifo_edge[1] == corners[(r + 1u) % 3u])
+					{
+						edge     = age;
+						rotation = r;
+						break;
+					}
+				}
+			}
+
+			const uint32 a = corners[rotation];
+			const uint32 b = corners[(rotation + 1u) % 3u];
+			const uint32 c = corners[(rotation + 2u) % 3u];
+
+			if (edge != c_noEdge)
+			{
+				// Only the third vertex is new to the edge
+				const uint32 code             = encodeVertex(state, c, data);
+				p_out[code_offset + triangle] = static_cast<uint8>(edge << 4u | code);
+			}
+			else
+			{
+				// The code byte takes the first vertex, one data byte the other two, then any explicit ones in order
+				const uint64 codes_offset = data.size();
+				data.push_back(0u);
+
+				const uint32 code_a           = encodeVertex(state, a, data);
+				const uint32 code_b           = encodeVertex(state, b, data);
+				const uint32 code_c           = encodeVertex(state, c, data);
+				data[codes_offset]            = static_cast<uint8>(code_b << 4u | code_c);
+				p_out[code_offset + triangle] = static_cast<uint8>(c_noEdge << 4u | code_a);
+				state.pushEdge(b, a);
+			}
+
+			state.pushEdge(c, b);
+			state.pushEdge(a, c);
+		}
+
+		p_out.insert(p_out.end(), data.begin(), data.end());
+		return p_out.size() - start;
+	}
+
+	bool decodeIndexBuffer(uint32 *p_out_indices, const uint64 p_index_count, const std::span<const uint8> p_encoded)
+	{
+		const uint64 triangle_count = p_index_count / 3u;
+		if (p_index_count % 3u != 0u || p_encoded.size() < 1u + triangle_count || p_encoded[0] != c_indexCodecHeader)
+			return false;
+
+		const uint8 *codes    = p_encoded.data() + 1u;
+		const uint8 *data     = codes + triangle_count;
+		const uint8 *data_end = p_encoded.data() + p_encoded.size();
+
+		IndexCodecState state;
+		for (uint64 triangle = 0u; triangle < triangle_count; triangle++)
+		{
+			const uint32 edge = codes[triangle] >> 4u;
+			const uint32 code = codes[triangle] & 15u;
+
+			uint32 a, b, c;
+			if (edge != c_noEdge)
+			{
+				a = state.getEdge(edge)[0];
+				b = state.getEdge(edge)[1];
+				if (!decodeVertex(state, code, data, data_end, c))
+					return false;
+			}
+			else
+			{
+				if (data == data_end)
+					return false;
+
+				const uint32 codes_bc = *data++;
+				if (!decodeVertex(state, code, data, data_end, a) || !decodeVertex(state, codes_bc >> 4u, data, data_end, b) ||
+					!decodeVertex(state, codes_bc & 15u, data, data_end, c))
+					return false;
+				state.pushEdge(b, a);
+			}
+
+			state.pushEdge(c, b);
+			state.pushEdge(a, c);
+
+			p_out_indices[triangle * 3u + 0u] = a;
+			p_out_indices[triangle * 3u + 1u] = b;
+			p_out_indices[triangle * 3u + 2u] = c;
+		}
+		return data == data_end;
+	}
+
+	uint64 encodeIndexSequence(const std::span<const uint32> p_indices, std::vector<uint8> &p_out)
+	{
+		const uint64 start = p_out.size();
+		p_out.push_back(c_sequenceCodecHeader);
+
+		uint32 last = 0u;
+		for (const uint32 index: p_indices)
+		{
+			writeVarint(p_out, zigzag32(index - last));
+			last = index;
+		}
+		return p_out.size() - start;
+	}
+
+	bool decodeIndexSequence(uint32 *p_out_indices, const uint64 p_index_count, const std::span<const uint8> p_encoded)
+	{
+		if (p_encoded.empty() || p_encoded[0] != c_sequenceCodecHeader)
+			return false;
+
+		const uint8 *data     = p_encoded.data() + 1u;
+		const uint8 *data_end = p_encoded.data() + p_encoded.size();
+
+		uint32 last = 0u;
+		for (uint64 i = 0u; i < p_index_count; i++)
+		{
+			uint32 delta;
+			if (!readVarint(data, data_end, delta))
+				return false;
+
+			last += unzigzag32(delta);
+			p_out_indices[i] = last;
+		}
+		return data == data_end;
+	}
+
+	namespace
+	{
+		uint32 getElementSize(const EGeometryCodec p_codec, const uint32 p_vertex_size)
+		{
+			switch (p_codec)
+			{
+				case EGeometryCodec::eVertices:
+					TST_ASSERT_MSG(p_vertex_size > 0u && p_vertex_size % 4u == 0u && p_vertex_size <= c_maxCodecVertexSize, "Unsupported vertex size");
+					return p_vertex_size;
+				case EGeometryCodec::eTriangles:
+					return 3u * sizeof(uint32);
+				default:
+					return sizeof(uint32);
+			}
+		}
+
+		// Worst cases are about 17 encoded bytes per 12 byte triangle and 5 per 4 byte index, anything past twice the
+		// decoded size is corrupt
+		uint64 getMaxEncodedChunkSize(const uint64 p_chunk_size)
+		{
+			return p_chunk_size * 2u + c_maxCodecVertexSize;
+		}
+	}
+
+	GeometryCodecWriter::GeometryCodecWriter(io::StreamWriter *p_inner, const EGeometryCodec p_codec, const uint32 p_vertex_size)
+		: m_inner(p_inner), m_elementSize(getElementSize(p_codec, p_vertex_size)), m_codec(p_codec)
+	{
+		m_chunkSize = c_geometryCodecChunkSize / m_elementSize * m_elementSize;
+	}
+
+	GeometryCodecWriter::~GeometryCodecWriter()
+	{
+		flush();
+	}
+
+	void GeometryCodecWriter::setStreamPos(const uint64 p_stream_pos)
+	{
+		if (p_stream_pos != m_position)
+			m_isGood = false;
+	}
+
+	bool GeometryCodecWriter::writeData(const uint8 *p_data, uint64 p_size)
+	{
+		if (!isGood())
+			return false;
+
+		m_position += p_size;
+
+		// Top up the pending chunk first, then encode whole chunks straight from p_data
+		if (!m_pending.empty())
+		{
+			const uint64 size = std::min(p_size, m_chunkSize - m_pending.size());
+			m_pending.insert(m_pending.end(), p_data, p_data + size);
+			p_data += size;
+			p_size -= size;
+
+			if (m_pending.size() == m_chunkSize)
+			{
+				writeChunk(m_pending.data(), m_pending.size());
+				m_pending.clear();
+			}
+		}
+
+		for (; p_size >= m_chunkSize; p_data += m_chunkSize, p_size -= m_chunkSize)
+		{
+			writeChunk(p_data, m_chunkSize);
+		}
+
+		if (p_size)
+			m_pending.insert(m_pending.end(), p_data, p_data + p_size);
+		return isGood();
+	}
+
+	bool GeometryCodecWriter::flush()
+	{
+		if (m_pending.size() % m_elementSize != 0u)
+			m_isGood = false;
+		if (!isGood())
+			return false;
+
+		writeChunk(m_pending.data(), m_pending.size());
+		m_pending.clear();
+		return isGood();
+	}
+
+	bool GeometryCodecWriter::writeChunk(const uint8 *p_data, const uint64 p_size)
+	{
+		if (p_size == 0u || !isGood())
+			return isGood();
+
+		const uint64 element_count = p_size / m_elementSize;
+		m_encoded.clear();
+		switch (m_codec)
+		{
+			case EGeometryCodec::eVertices:
+				encodeVertexBuffer(p_data, element_count, m_elementSize, m_encoded);
+				break;
+			case EGeometryCodec::eTriangles:
+				encodeIndexBuffer(std::span(reinterpret_cast<const uint32 *>(p_data), element_count * 3u), m_encoded);
+				break;
+			case EGeometryCodec::eIndexSequence:
+				encodeIndexSequence(std::span(reinterpret_cast<const uint32 *>(p_data), element_count), m_encoded);
+				break;
+		}
+
+		const uint32 header[2]{static_cast<uint32>(element_count), static_cast<uint32>(m_encoded.size())};
+		m_isGood = m_inner->writeData(reinterpret_cast<const uint8 *>(header), sizeof(header)) && m_inner->writeData(m_encoded.data(), m_encoded.size());
+		return m_isGood;
+	}
+
+	GeometryCodecReader::GeometryCodecReader(io::StreamReader *p_inner, const EGeometryCodec p_codec, const uint32 p_vertex_size)
+		: m_inner(p_inner), m_elementSize(getElementSize(p_codec, p_vertex_size)), m_codec(p_codec)
+	{
+		m_chunkSize = c_geometryCodecChunkSize / m_elementSize * m_elementSize;
+	}
+
+	void GeometryCodecReader::setStreamPos(const uint64 p_stream_pos)
+	{
+		if (p_stream_pos <= m_position)
+		{
+			const uint64 back = m_position - p_stream_pos;
+			if (back > m_decodedOffset)
+			{
+				m_isGood = false;
+				return;
+			}
+			m_decodedOffset -= back;
+			m_position = p_stream_pos;
+			return;
+		}
+
+		uint8 skipped[4096];
+		while (m_isGood && m_position < p_stream_pos)
+		{
+			readData(skipped, std::min<uint64>(sizeof(skipped), p_stream_pos - m_position));
+		}
+	}
+
+	bool GeometryCodecReader::readData(uint8 *p_dst, uint64 p_size)
+	{
+		while (m_isGood && p_size > 0u)
+		{
+			if (m_decodedOffset == m_decoded.size())
+			{
+				const uint64 chunk_size = readChunk();
+				if (chunk_size == 0u)
+					break;
+
+				// Whole chunks skip the intermediate copy
+				if (p_size >= chunk_size)
+				{
+					m_isGood = decodeChunk(p_dst, chunk_size);
+					m_decoded.clear();
+					m_decodedOffset = 0u;
+					p_dst += chunk_size;
+					p_size -= chunk_size;
+					m_position += chunk_size;
+					continue;
+				}
+
+				m_decoded.resize(chunk_size);
+				m_decodedOffset = 0u;
+				m_isGood        = decodeChunk(m_decoded.data(), chunk_size);
+				if (!m_isGood)
+					break;
+			}
+
+			const uint64 size = std::min(p_size, m_decoded.size() - m_decodedOffset);
+			std::memcpy(p_dst, m_decoded.data() + m_decodedOffset, size);
+			m_decodedOffset += size;
+			p_dst += size;
+			p_size -= size;
+			m_position += size;
+		}
+		return m_isGood;
+	}
+
+	uint64 GeometryCodecReader::readChunk()
+	{
+		uint32 header[2];
+		if (!m_inner->readData(reinterpret_cast<uint8 *>(header), sizeof(header)))
+		{
+			m_isGood = false;
+			return 0u;
+		}
+
+		const uint64 chunk_size = static_cast<uint64>(header[0]) * m_elementSize;
+		if (chunk_size == 0u || chunk_size > m_chunkSize || header[1] > getMaxEncodedChunkSize(chunk_size))
+		{
+			m_isGood = false;
+			return 0u;
+		}
+
+		m_encoded.resize(header[1]);
+		if (!m_inner->readData(m_encoded.data(), m_encoded.size()))
+		{
+			m_isGood = false;
+			return 0u;
+		}
+		return chunk_size;
+	}
+
+	bool GeometryCodecReader::decodeChunk(uint8 *p_dst, const uint64 p_size) const
+	{
+		const uint64 element_count = p_size / m_elementSize;
+		switch (m_codec)
+		{
+			case EGeometryCodec::eVertices:
+				return decodeVertexBuffer(p_dst, element_count, m_elementSize, m_encoded);
+			case EGeometryCodec::eTriangles:
+				return decodeIndexBuffer(reinterpret_cast<uint32 *>(p_dst), element_count * 3u, m_encoded);
+			case EGeometryCodec::eIndexSequence:
+				return decodeIndexSequence(reinterpret_cast<uint32 *>(p_dst), element_count, m_encoded);
+		}
+		return false;
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "system_types.h"
+#include "io/stream_reader.hpp"
+#include "io/stream_writer.hpp"
+
+namespace toaster::geometry
+{
+	// Lossless codecs for vertex and index buffers after the ones in meshoptimizer. Both lean on the order the mesh
+	// optimizer leaves behind: consecutive vertices are alike, and triangles reuse recently seen edges and vertices.
+	// The encoders append to p_out and return how many bytes they added. The decoders take exactly those bytes, check
+	// every read against them and return false on anything malformed instead of reading or writing out of range.
+	// zlib and Draco compress smaller, Draco only when it quantizes, but decode 5-15x slower. The meshCodec benchmark
+	// prints the numbers
+
+	// Vertices are delta encoded byte by byte against the previous vertex in blocks of up to 256. Each byte column of
+	// a block is stored in groups of 16 deltas at 0, 2, 4 or 8 bits, with the few that don't fit escaped. Decoding
+	// unpacks a whole group and transposes 16 vertices at a time with SSE4 when it is enabled, two 4 byte slices of
+	// them at once with AVX2
+	constexpr uint64 c_maxCodecVertexSize{256u};
+
+	// p_vertex_size must be a multiple of 4 and at most c_maxCodecVertexSize
+	uint64 encodeVertexBuffer(const void *p_vertices, uint64 p_vertex_count, uint64 p_vertex_size, std::vector<uint8> &p_out);
+	[[nodiscard]] bool decodeVertexBuffer(void *p_out_vertices, uint64 p_vertex_count, uint64 p_vertex_size, std::span<const uint8> p_encoded);
+
+	// Triangles are rotated to start on an edge a recent triangle ended with, then stored as one code byte naming that
+	// edge and the third vertex: the next vertex not seen yet, one of the last few new ones, or a varint delta. Only
+	// the first vertex of a triangle can change, the winding is kept. Works best in first use order, see
+	// optimizeVertexFetchRemap()
+	uint64 encodeIndexBuffer(std::span<const uint32> p_indices, std::vector<uint8> &p_out);
+	[[nodiscard]] bool decodeIndexBuffer(uint32 *p_out_indices, uint64 p_index_count, std::span<const uint8> p_encoded);
+
+	// For indices that are not a triangle list: varint deltas between consecutive indices, the order is kept as it is
+	uint64 encodeIndexSequence(std::span<const uint32> p_indices, std::vector<uint8> &p_out);
+	[[nodiscard]] bool decodeIndexSequence(uint32 *p_out_indices, uint64 p_index_count, std::span<const uint8> p_encoded);
+
+	enum class EGeometryCodec : uint8
+	{
+		eVertices,      // encodeVertexBuffer(), an element is one vertex
+		eTriangles,     // encodeIndexBuffer(), an element is three uint32 indices
+		eIndexSequence, // encodeIndexSequence(), an element is one uint32 index
+	};
+
+	// Decoded bytes per chunk the stream codecs write, rounded down to whole elements. Small enough to buffer, large
+	// enough that the chunk headers and the codecs starting over don't show in the size
+	constexpr uint64 c_geometryCodecChunkSize{1u << 20u};
+
+	// Encodes what is written to it with p_codec and passes it on to p_inner as chunks of whole elements: uint32 element
+	// count, uint32 encoded size, the encoded bytes. The stream position counts decoded bytes and only moves forward.
+	// flush() writes what is buffered as a chunk of its own, and has to come before anything else is written to
+	// p_inner. The destructor flushes too, but can't report a failure
+	class GeometryCodecWriter final : public io::StreamWriter
+	{
+	public:
+		// p_vertex_size is only used by EGeometryCodec::eVertices
+		GeometryCodecWriter(io::StreamWriter *p_inner, EGeometryCodec p_codec, uint32 p_vertex_size = 0u);
+		~GeometryCodecWriter() override;
+
+		GeometryCodecWriter(const GeometryCodecWriter &)            = delete;
+		GeometryCodecWriter &operator=(const GeometryCodecWriter &) = delete;
+
+		[[nodiscard]] bool isGood() const override { return m_isGood && m_inner->isGood(); }
+
+		[[nodiscard]] uint64 getStreamPos() const override { return m_position; }
+		// Only the current position is accepted, everything before it may already be encoded
+		void setStreamPos(uint64 p_stream_pos) override;
+
+		bool writeData(const uint8 *p_data, uint64 p_size) override;
+
+		// Fails if the data written since the last chunk doesn't end on a whole element
+		bool flush() override;
+
+	private:
+		bool writeChunk(const uint8 *p_data, uint64 p_size);
+
+		io::StreamWriter * m_inner;
+		std::vector<uint8> m_pending; // Less than a chunk, waiting for more
+		std::vector<uint8> m_encoded;
+		uint64             m_position{0u};
+		uint64             m_chunkSize;
+		uint32             m_elementSize;
+		EGeometryCodec     m_codec;
+		bool               m_isGood{true};
+	};
+
+	// Reads what a GeometryCodecWriter wrote, decoding one chunk at a time. Reads that cover a whole chunk are decoded
+	// straight into the destination. Seeking works forwards, by decoding and dropping, and backwards within the last
+	// chunk. Chunks are only read from p_inner as the data is asked for
+	class GeometryCodecReader final : public io::StreamReader
+	{
+	public:
+		GeometryCodecReader(io::StreamReader *p_inner, EGeometryCodec p_codec, uint32 p_vertex_size = 0u);
+
+		GeometryCodecReader(const GeometryCodecReader &)            = delete;
+		GeometryCodecReader &operator=(const GeometryCodecReader &) = delete;
+
+		// False once a read failed or a chunk was corrupt
+		[[nodiscard]] bool isGood() const override { return m_isGood; }
+
+		[[nodiscard]] uint64 getStreamPos() const override { return m_position; }
+		void                 setStreamPos(uint64 p_stream_pos) override;
+
+		bool readData(uint8 *p_dst, uint64 p_size) override;
+
+	private:
+		// Reads the next chunk's header and encoded bytes, returns its decoded size or 0 on failure
+		uint64 readChunk();
+		bool   decodeChunk(uint8 *p_dst, uint64 p_size) const;
+
+		io::StreamReader * m_inner;
+		std::vector<uint8> m_encoded;
+		std::vector<uint8> m_decoded;
+		uint64             m_decodedOffset{0u}; // Into m_decoded, the rest has not been read yet
+		uint64             m_position{0u};
+		uint64             m_chunkSize;
+		uint32             m_elementSize;
+		EGeometryCodec     m_codec;
+		bool               m_isGood{true};
+	};
+}
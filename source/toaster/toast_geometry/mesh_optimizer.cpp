@@ -0,0 +1,306 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "toast_assert.h"
+#include "vertex_adjacency.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		constexpr uint32 c_noVertex{UINT32_MAX};
+
+		// FIFO cache simulated with insertion timestamps: a vertex is cached while fewer than cacheSize vertices were
+		// inserted after it. Bumping time by cacheSize + 1 empties the cache without touching the timestamps
+		struct FifoCache
+		{
+			std::vector<uint32> insertedAt;
+			uint32              time;
+			uint32              cacheSize;
+
+			FifoCache(const uint32 p_vertex_count, const uint32 p_cache_size) : insertedAt(p_vertex_count, 0u), time(p_cache_size + 1u), cacheSize(p_cache_size) {}
+
+			[[nodiscard]] bool isCached(const uint32 p_vertex) const { return time - insertedAt[p_vertex] <= cacheSize; }
+
+			// Returns 1 on a miss
+			uint32 access(const uint32 p_vertex)
+			{
+				if (isCached(p_vertex))
+					return 0u;
+
+				insertedAt[p_vertex] = time++;
+				return 1u;
+			}
+
+			void flush() { time += cacheSize + 1u; }
+		};
+
+		const glm::vec3 &getPosition(const void *p_positions, const uint64 p_stride, const uint32 p_vertex)
+		{
+			return *reinterpret_cast<const glm::vec3 *>(static_cast<const uint8 *>(p_positions) + p_vertex * p_stride);
+		}
+	}
+
+	VertexCacheStats analyzeVertexCache(const std::span<const uint32> p_indices, const uint32 p_vertex_count, const uint32 p_cache_size)
+	{
+		TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+		VertexCacheStats stats;
+		stats.triangleCount = static_cast<uint32>(p_indices.size() / 3u);
+
+		FifoCache cache(p_vertex_count, p_cache_size);
+		for (const uint32 index: p_indices)
+		{
+			// Timestamps start above 0, so 0 means never referenced
+			stats.vertexCount += cache.insertedAt[index] == 0u ? 1u : 0u;
+			stats.transformCount += cache.access(index);
+		}
+		return stats;
+	}
+
+	void optimizeVertexCache(const std::span<uint32> p_indices, const uint32 p_vertex_count, const uint32 p_cache_size)
+	{
+		TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+		const uint32 triangle_count = static_cast<uint32>(p_indices.size() / 3u);
+		if (triangle_count == 0u)
+			return;
+
+		const VertexTriangles adjacency(p_indices, p_vertex_count);
+
+		// Triangles not yet emitted per vertex
+		std::vector<uint32> live_count(p_vertex_count);
+		for (uint32 i = 0u; i < p_vertex_count; i++)
+		{
+			live_count[i] = adjacency.getCount(i);
+		}
+
+		std::vector<uint32> cache_time(p_vertex_count, 0u);
+		std::vector<uint8>  emitted(triangle_count, 0u);
+		std::vector<uint32> output(p_indices.size());
+		std::vector<uint32> dead_end_stack;
+		std::vector<uint32> candidates;
+		dead_end_stack.reserve(p_indices.size());
+
+		uint32 time        = p_cache_size + 1u;
+		uint32 next_vertex = 0u; // Fallback scan position once the dead end stack runs dry
+		uint32 output_size = 0u;
+
+		uint32 fan_vertex = 0u;
+		while (fan_vertex != c_noVertex)
+		{
+			// Emit every remaining triangle around the fanning vertex
+			candidates.clear();
+			for (uint32 i = adjacency.offsets[fan_vertex]; i < adjacency.offsets[fan_vertex + 1u]; i++)
+			{
+				const uint32 triangle = adjacency.triangles[i];
+				if (emitted[triangle])
+					continue;
+				emitted[triangle] = 1u;
+
+				for (uint32 corner = 0u; corner < 3u; corner++)
+				{
+					const uint32 vertex   = p_indices[triangle * 3u + corner];
+					output[output_size++] = vertex;
+					dead_end_stack.push_back(vertex);
+					candidates.push_back(vertex);
+					live_count[vertex]--;
+
+					if (time - cache_time[vertex] > p_cache_size)
+						cache_time[vertex] = time++;
+				}
+			}
+
+			// Next fan: the candidate that has been in the cache longest but will still be there after emitting
+			// all of its triangles
+			fan_vertex          = c_noVertex;
+			int64 best_priority = -1;
+			for (const uint32 vertex: candidates)
+			{
+				if (live_count[vertex] == 0u)
+					continue;
+
+				int64 priority = 0;
+				if (time - cache_time[vertex] + 2u * live_count[vertex] <= p_cache_size)
+					priority = time - cache_time[vertex];
+
+				if (priority > best_priority)
+				{
+					best_priority = priority;
+					fan_vertex    = vertex;
+				}
+			}
+
+			if (fan_vertex != c_noVertex)
+				continue;
+
+			// Dead end: back up to a recently used vertex with triangles left, else the next one in index order
+			while (!dead_end_stack.empty() && fan_vertex == c_noVertex)
+			{
+				const uint32 vertex = dead_end_stack.back();
+				dead_end_stack.pop_back();
+				if (live_count[vertex] > 0u)
+					fan_vertex = vertex;
+			}
+
+			while (fan_vertex == c_noVertex && next_vertex < p_vertex_count)
+			{
+				if (live_count[next_vertex] > 0u)
+					fan_vertex = next_vertex;
+				next_vertex++;
+			}
+		}
+
+		TST_ASSERT_MSG(output_size == p_indices.size(), "Tipsify lost triangles");
+		std::copy(output.begin(), output.end(), p_indices.begin());
+	}
+
+	void optimizeOverdraw(const std::span<uint32> p_indices, const void *p_positions, const uint64 p_position_stride, const uint32 p_vertex_count, const float p_threshold,
+						  const uint32 p_cache_size)
+	{
+		TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+		const uint32 triangle_count = static_cast<uint32>(p_indices.size() / 3u);
+		if (triangle_count < 2u)
+			return;
+
+		// Hard boundaries, where the cache order restarts: all three vertices of the triangle miss
+		std::vector<uint32> hard_clusters;
+		{
+			FifoCache cache(p_vertex_count, p_cache_size);
+			for (uint32 triangle = 0u; triangle < triangle_count; triangle++)
+			{
+				const uint32 *corners = &p_indices[triangle * 3u];
+				const uint32  misses  = cache.access(corners[0]) + cache.access(corners[1]) + cache.access(corners[2]);
+				if (triangle == 0u || misses == 3u)
+					hard_clusters.push_back(triangle);
+			}
+		}
+		hard_clusters.push_back(triangle_count);
+
+		// Soft boundaries, inside each hard cluster, as soon as the triangles so far are nearly as cache efficient as
+		// the whole cluster. Every cluster starts with an empty cache, as it may end up drawn after any other
+		std::vector<uint32> clusters;
+		{
+			FifoCache cache(p_vertex_count, p_cache_size);
+			for (uint32 i = 0u; i + 1u < hard_clusters.size(); i++)
+			{
+				const uint32 begin = hard_clusters[i];
+				const uint32 end   = hard_clusters[i + 1u];
+
+				cache.flush();
+				uint32 cluster_misses = 0u;
+				for (uint32 triangle = begin; triangle < end; triangle++)
+				{
+					const uint32 *corners = &p_indices[triangle * 3u];
+					cluster_misses += cache.access(corners[0]) + cache.access(corners[1]) + cache.access(corners[2]);
+				}
+				const float limit = p_threshold * static_cast<float>(cluster_misses) / static_cast<float>(end - begin);
+
+				clusters.push_back(begin);
+				cache.flush();
+				uint32 misses = 0u;
+				uint32 count  = 0u;
+				for (uint32 triangle = begin; triangle < end; triangle++)
+				{
+					const uint32 *corners = &p_indices[triangle * 3u];
+					misses += cache.access(corners[0]) + cache.access(corners[1]) + cache.access(corners[2]);
+					count++;
+
+					if (triangle + 1u < end && static_cast<float>(misses) <= limit * static_cast<float>(count))
+					{
+						clusters.push_back(triangle + 1u);
+						cache.flush();
+						misses = 0u;
+						count  = 0u;
+					}
+				}
+			}
+		}
+		clusters.push_back(triangle_count);
+
+		const uint32 cluster_count = static_cast<uint32>(clusters.size() - 1u);
+		if (cluster_count < 2u)
+			return;
+
+		// Area weighted centroid and normal per cluster, and the centroid of the whole mesh
+		std::vector<glm::vec3> cluster_centroids(cluster_count, glm::vec3(0.0f));
+		std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3(0.0f));
+		std::vector<float>     cluster_areas(cluster_count, 0.0f);
+		glm::vec3              mesh_centroid(0.0f);
+		float                  mesh_area = 0.0f;
+
+		for (uint32 cluster = 0u; cluster < cluster_count; cluster++)
+		{
+			for (uint32 triangle = clusters[cluster]; triangle < clusters[cluster + 1u]; triangle++)
+			{
+				const glm::vec3 &p0 = getPosition(p_positions, p_position_stride, p_indices[triangle * 3u]);
+				const glm::vec3 &p1 = getPosition(p_positions, p_position_stride, p_indices[triangle * 3u + 1u]);
+				const glm::vec3 &p2 = getPosition(p_positions, p_position_stride, p_indices[triangle * 3u + 2u]);
+
+				const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0); // Length is twice the area
+				const float     area   = glm::length(normal);
+
+				cluster_centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+				cluster_normals[cluster] += normal;
+				cluster_areas[cluster] += area;
+			}
+
+			mesh_centroid += cluster_centroids[cluster];
+			mesh_area += cluster_areas[cluster];
+		}
+
+		if (mesh_area > 0.0f)
+			mesh_centroid /= mesh_area;
+
+		// Clusters facing out from the centre are drawn first
+		std::vector<float> sort_keys(cluster_count, 0.0f);
+		for (uint32 cluster = 0u; cluster < cluster_count; cluster++)
+		{
+			const float normal_length = glm::length(cluster_normals[cluster]);
+			if (cluster_areas[cluster] <= 0.0f || normal_length <= 0.0f)
+				continue;
+
+			const glm::vec3 centroid = cluster_centroids[cluster] / cluster_areas[cluster];
+			sort_keys[cluster]       = glm::dot(centroid - mesh_centroid, cluster_normals[cluster] / normal_length);
+		}
+
+		std::vector<uint32> order(cluster_count);
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&sort_keys](const uint32 p_a, const uint32 p_b) { return sort_keys[p_a] > sort_keys[p_b]; });
+
+		std::vector<uint32> output;
+		output.reserve(p_indices.size());
+		for (const uint32 cluster: order)
+		{
+			output.insert(output.end(), p_indices.begin() + clusters[cluster] * 3u, p_indices.begin() + clusters[cluster + 1u] * 3u);
+		}
+		std::copy(output.begin(), output.end(), p_indices.begin());
+	}
+
+	uint32 optimizeVertexFetchRemap(const std::span<uint32> p_indices, const std::span<uint32> p_out_remap)
+	{
+		std::fill(p_out_remap.begin(), p_out_remap.end(), c_noVertex);
+
+		uint32 next = 0u;
+		for (uint32 &index: p_indices)
+		{
+			if (p_out_remap[index] == c_noVertex)
+				p_out_remap[index] = next++;
+			index = p_out_remap[index];
+		}
+
+		const uint32 referenced_count = next;
+		for (uint32 &target: p_out_remap)
+		{
+			if (target == c_noVertex)
+				target = next++;
+		}
+		return referenced_count;
+	}
+}
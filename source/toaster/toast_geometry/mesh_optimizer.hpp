@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+
+#include "system_types.h"
+
+namespace toaster::geometry
+{
+	// FIFO post-transform cache size the optimizer targets and the stats are measured with. Real hardware batches
+	// vertices differently per vendor, but an order that is good for a 16 entry FIFO is good on all of them
+	constexpr uint32 c_vertexCacheSize{16u};
+
+	struct VertexCacheStats
+	{
+		uint32 triangleCount{0u};
+		uint32 vertexCount{0u}; // Distinct vertices referenced
+		uint32 transformCount{0u}; // Cache misses, i.e. vertex shader invocations
+
+		// Average cache miss ratio, transformed vertices per triangle. 0.5 is the best a regular grid can do, 3 the worst
+		[[nodiscard]] float getAcmr() const { return triangleCount ? static_cast<float>(transformCount) / triangleCount : 0.0f; }
+		// Average transform to vertex ratio, 1 means every vertex was shaded exactly once
+		[[nodiscard]] float getAtvr() const { return vertexCount ? static_cast<float>(transformCount) / vertexCount : 0.0f; }
+	};
+
+	// All functions below work on triangle lists with indices in [0, p_vertex_count), and are deterministic: the same
+	// input always gives the same order, so cooked output built from it is stable
+
+	// Simulates a FIFO cache of p_cache_size entries over the triangle list
+	VertexCacheStats analyzeVertexCache(std::span<const uint32> p_indices, uint32 p_vertex_count, uint32 p_cache_size = c_vertexCacheSize);
+
+	// Reorders triangles for the post-transform cache with Tipsify (Sander, Nehab and Barczak 2007). Linear time,
+	// fans around one vertex at a time and picks the next one still in the cache with the most triangles left
+	void optimizeVertexCache(std::span<uint32> p_indices, uint32 p_vertex_count, uint32 p_cache_size = c_vertexCacheSize);
+
+	// Reorders clusters of triangles so the ones facing away from the mesh centre, which tend to occlude the rest,
+	// are drawn first. Run after optimizeVertexCache(), whose order is kept inside each cluster. Clusters are cut
+	// wherever the cache order already restarts, and inside those wherever the cluster's ACMR is within p_threshold
+	// of what the whole run achieves, so 1.05 gives up at most about 5% of the cache efficiency for less overdraw
+	void optimizeOverdraw(std::span<uint32> p_indices, const void *p_positions, uint64 p_position_stride, uint32 p_vertex_count, float p_threshold = 1.05f,
+						  uint32 p_cache_size = c_vertexCacheSize);
+
+	// Renumbers the vertices in the order the triangles first use them, so vertex fetch walks the vertex buffer
+	// front to back. Rewrites p_indices and fills p_out_remap[old vertex] = new vertex. Unreferenced vertices are
+	// moved to the end. Returns the number of referenced vertices
+	uint32 optimizeVertexFetchRemap(std::span<uint32> p_indices, std::span<uint32> p_out_remap);
+}
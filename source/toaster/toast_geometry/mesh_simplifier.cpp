@@ -0,0 +1,525 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+#include <glm/glm.hpp>
+
+#include "toast_assert.h"
+#include "vertex_adjacency.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		constexpr uint32 c_noVertex{UINT32_MAX};
+		constexpr uint32 c_manyVertices{UINT32_MAX - 1u}; // More than one open edge in the same direction
+
+		// Seam edges weigh more than the faces around them, moving a seam sideways shows up in the texture mapping
+		constexpr double c_seamWeight{4.0};
+		// Each pass only takes collapses up to the cost at this fraction of its candidates, the rest are costed again
+		// in the next pass with the quadrics the cheap ones left behind
+		constexpr uint64 c_passFraction{4u};
+
+		enum class EVertexKind : uint8
+		{
+			eManifold, // Interior with a single set of attributes, can move onto any neighbour
+			eSeam,     // On an attribute seam with one twin, both move along the seam together
+			eLocked,   // Border, seam corner or non-manifold, stays where it is
+		};
+
+		// Symmetric 4x4 error matrix of a set of planes, plus the total weight it was built from
+		struct Quadric
+		{
+			double a00, a11, a22, a01, a02, a12;
+			double b0, b1, b2;
+			double c;
+			double weight;
+
+			static Quadric fromPlane(const glm::dvec3 &p_normal, const double p_distance, const double p_weight)
+			{
+				const glm::dvec3 normal = p_normal * p_weight;
+				return {normal.x * p_normal.x, normal.y * p_normal.y, normal.z * p_normal.z, normal.x * p_normal.y, normal.x * p_normal.z, normal.y * p_normal.z,
+						normal.x * p_distance, normal.y * p_distance, normal.z * p_distance, p_distance * p_distance * p_weight, p_weight};
+			}
+
+			Quadric &operator+=(const Quadric &p_other)
+			{
+				a00 += p_other.a00;
+				a11 += p_other.a11;
+				a22 += p_other.a22;
+				a01 += p_other.a01;
+				a02 += p_other.a02;
+				a12 += p_other.a12;
+				b0 += p_other.b0;
+				b1 += p_other.b1;
+				b2 += p_other.b2;
+				c += p_other.c;
+				weight += p_other.weight;
+				return *this;
+			}
+
+			// Weighted sum of squared distances to the planes
+			[[nodiscard]] double evaluate(const glm::dvec3 &p) const
+			{
+				return a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+					   2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+			}
+		};
+
+		struct Collapse
+		{
+			uint32 from;
+			uint32 to;
+			uint32 twinFrom; // Seam collapses move the twin too, c_noVertex otherwise
+			uint32 twinTo;
+			double cost; // Mean squared distance
+		};
+
+		class Simplifier
+		{
+		public:
+			Simplifier(const std::span<const uint32> p_indices, const void *p_positions, const uint64 p_stride, const uint32 p_vertex_count)
+				: m_positions(static_cast<const uint8 *>(p_positions)), m_stride(p_stride), m_vertexCount(p_vertex_count)
+			{
+				TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+				// Degenerate triangles have no facing and no area, they are left out from the start
+				m_indices.reserve(p_indices.size());
+				for (uint64 i = 0u; i < p_indices.size(); i += 3u)
+				{
+					if (p_indices[i] != p_indices[i + 1u] && p_indices[i] != p_indices[i + 2u] && p_indices[i + 1u] != p_indices[i + 2u])
+						m_indices.insert(m_indices.end(), p_indices.begin() + i, p_indices.begin() + i + 3u);
+				}
+
+				buildWedges();
+
+				const VertexTriangles adjacency(m_indices, m_vertexCount);
+				findOpenEdges(adjacency);
+				classifyVertices();
+
+				// Triangle soups and flat shaded meshes have every vertex locked, there is nothing to collapse
+				m_canMove = std::ranges::any_of(m_kinds, [](const EVertexKind p_kind) { return p_kind != EVertexKind::eLocked; });
+				if (m_canMove)
+					buildQuadrics();
+			}
+
+			// Diagonal of the referenced positions' bounding box
+			[[nodiscard]] float getExtent() const
+			{
+				glm::vec3 boundsMin(FLT_MAX);
+				glm::vec3 boundsMax(-FLT_MAX);
+				for (const uint32 index: m_indices)
+				{
+					boundsMin = glm::min(boundsMin, getPosition(index));
+					boundsMax = glm::max(boundsMax, getPosition(index));
+				}
+				return m_indices.empty() ? 0.0f : glm::length(boundsMax - boundsMin);
+			}
+
+			[[nodiscard]] const std::vector<uint32> &getIndices() const { return m_indices; }
+
+			// Continues from wherever the last call stopped. Returns the largest error of any collapse so far
+			float run(uint32 p_target_index_count, float p_max_error);
+
+		private:
+			[[nodiscard]] const glm::vec3 &getPosition(const uint32 p_vertex) const
+			{
+				return *reinterpret_cast<const glm::vec3 *>(m_positions + p_vertex * m_stride);
+			}
+
+			void buildWedges();
+			void findOpenEdges(const VertexTriangles &p_adjacency);
+			void classifyVertices();
+			void buildQuadrics();
+
+			[[nodiscard]] bool canCollapse(uint32 p_from, uint32 p_to, Collapse &p_out_collapse) const;
+			[[nodiscard]] double getCost(uint32 p_from, uint32 p_to) const;
+			[[nodiscard]] bool   hasFlips(const VertexTriangles &p_adjacency, uint32 p_from, uint32 p_to, const std::vector<uint32> &p_collapse_remap) const;
+
+			const uint8 *m_positions;
+			uint64       m_stride;
+			uint32       m_vertexCount;
+
+			std::vector<uint32>      m_indices;
+			std::vector<uint32>      m_remap; // Lowest vertex at the same position, positions are tracked through it
+			std::vector<uint32>      m_wedges; // Next vertex at the same position, a ring back to the vertex itself
+			std::vector<uint32>      m_openOut; // Target of the vertex's outgoing edge without an opposite edge
+			std::vector<uint32>      m_openIn;
+			std::vector<EVertexKind> m_kinds;
+			std::vector<Quadric>     m_quadrics; // Per position
+			float                    m_error{0.0f};
+			bool                     m_canMove{false};
+		};
+
+		void Simplifier::buildWedges()
+		{
+			// Bit patterns give a strict ordering even for NaNs, adding 0 folds -0 into 0 first. The vertex comes last so
+			// each group is ordered by vertex. Keys are built up front, sorting through the positions is several times slower
+			std::vector<std::array<uint32, 4>> keys(m_vertexCount);
+			for (uint32 vertex = 0u; vertex < m_vertexCount; vertex++)
+			{
+				const glm::vec3 &position = getPosition(vertex);
+				keys[vertex] = {std::bit_cast<uint32>(position.x + 0.0f), std::bit_cast<uint32>(position.y + 0.0f), std::bit_cast<uint32>(position.z + 0.0f), vertex};
+			}
+			std::sort(keys.begin(), keys.end());
+
+			const auto isSamePosition = [](const std::array<uint32, 4> &p_a, const std::array<uint32, 4> &p_b)
+			{
+				return p_a[0] == p_b[0] && p_a[1] == p_b[1] && p_a[2] == p_b[2];
+			};
+
+			m_remap.resize(m_vertexCount);
+			m_wedges.resize(m_vertexCount);
+			for (uint32 begin = 0u; begin < m_vertexCount;)
+			{
+				uint32 end = begin + 1u;
+				while (end < m_vertexCount && isSamePosition(keys[end], keys[begin]))
+				{
+					end++;
+				}
+
+				for (uint32 i = begin; i < end; i++)
+				{
+					m_remap[keys[i][3]]  = keys[begin][3];
+					m_wedges[keys[i][3]] = keys[i + 1u < end ? i + 1u : begin][3];
+				}
+				begin = end;
+			}
+		}
+
+		void Simplifier::findOpenEdges(const VertexTriangles &p_adjacency)
+		{
+			m_openOut.assign(m_vertexCount, c_noVertex);
+			m_openIn.assign(m_vertexCount, c_noVertex);
+
+			// Per vertex, an outgoing edge is open when no triangle around the vertex has the edge coming back in, and
+			// the other way around. Sorted so matching is linear in the valence. An edge used twice in the same
+			// direction is non-manifold and counts as open too. Once classified, only seams and locked vertices have
+			// open edges that matter
+			std::vector<uint32> outgoing;
+			std::vector<uint32> incoming;
+			const auto findOpen = [](const std::vector<uint32> &p_edges, const std::vector<uint32> &p_opposite)
+			{
+				uint32 open = c_noVertex;
+				auto   opposite = p_opposite.begin();
+				for (uint64 i = 0u; i < p_edges.size(); i++)
+				{
+					const uint32 vertex = p_edges[i];
+					opposite            = std::lower_bound(opposite, p_opposite.end(), vertex);
+
+					const bool duplicate = (i > 0u && p_edges[i - 1u] == vertex) || (i + 1u < p_edges.size() && p_edges[i + 1u] == vertex);
+					if (duplicate || opposite == p_opposite.end() || *opposite != vertex)
+						open = open == c_noVertex ? vertex : c_manyVertices;
+				}
+				return open;
+			};
+
+			for (uint32 vertex = 0u; vertex < m_vertexCount; vertex++)
+			{
+				if (!m_kinds.empty() && m_kinds[vertex] == EVertexKind::eManifold)
+					continue;
+
+				outgoing.clear();
+				incoming.clear();
+				for (const uint32 triangle: p_adjacency.get(vertex))
+				{
+					const uint32 *corners = &m_indices[triangle * 3u];
+					const uint32  corner  = corners[0] == vertex ? 0u : corners[1] == vertex ? 1u : 2u;
+					outgoing.push_back(corners[(corner + 1u) % 3u]);
+					incoming.push_back(corners[(corner + 2u) % 3u]);
+				}
+				std::sort(outgoing.begin(), outgoing.end());
+				std::sort(incoming.begin(), incoming.end());
+
+				m_openOut[vertex] = findOpen(outgoing, incoming);
+				m_openIn[vertex]  = findOpen(incoming, outgoing);
+			}
+		}
+
+		void Simplifier::classifyVertices()
+		{
+			const auto isSingle = [](const uint32 p_vertex) { return p_vertex != c_noVertex && p_vertex != c_manyVertices; };
+
+			m_kinds.assign(m_vertexCount, EVertexKind::eLocked);
+			for (uint32 vertex = 0u; vertex < m_vertexCount; vertex++)
+			{
+				const uint32 twin = m_wedges[vertex];
+				if (twin == vertex)
+				{
+					if (m_openOut[vertex] == c_noVertex && m_openIn[vertex] == c_noVertex)
+						m_kinds[vertex] = EVertexKind::eManifold;
+					continue;
+				}
+
+				// Exactly two attribute sets, each side has one open edge along the seam, and the two sides' open
+				// edges run between the same positions in opposite directions
+				if (m_wedges[twin] == vertex && isSingle(m_openOut[vertex]) && isSingle(m_openIn[vertex]) && isSingle(m_openOut[twin]) && isSingle(m_openIn[twin]) &&
+					m_remap[m_openOut[vertex]] == m_remap[m_openIn[twin]] && m_remap[m_openIn[vertex]] == m_remap[m_openOut[twin]])
+					m_kinds[vertex] = EVertexKind::eSeam;
+			}
+		}
+
+		void Simplifier::buildQuadrics()
+		{
+			m_quadrics.assign(m_vertexCount, Quadric{});
+			for (uint64 i = 0u; i < m_indices.size(); i += 3u)
+			{
+				const glm::dvec3 p0     = getPosition(m_indices[i]);
+				const glm::dvec3 p1     = getPosition(m_indices[i + 1u]);
+				const glm::dvec3 p2     = getPosition(m_indices[i + 2u]);
+				const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const double     length = glm::length(normal);
+				if (length <= 0.0)
+					continue;
+
+				const glm::dvec3 unit_normal = normal / length;
+				const Quadric    plane       = Quadric::fromPlane(unit_normal, -glm::dot(unit_normal, p0), length * 0.5);
+				for (uint32 corner = 0u; corner < 3u; corner++)
+				{
+					m_quadrics[m_remap[m_indices[i + corner]]] += plane;
+				}
+
+				// Seam edges also get the plane through them at right angles to the face, which keeps the seam line
+				// itself from moving sideways
+				for (uint32 corner = 0u; corner < 3u; corner++)
+				{
+					const uint32 from = m_indices[i + corner];
+					const uint32 to   = m_indices[i + (corner + 1u) % 3u];
+					if (m_openOut[from] != to || (m_kinds[from] != EVertexKind::eSeam && m_kinds[to] != EVertexKind::eSeam))
+						continue;
+
+					const glm::dvec3 a           = getPosition(from);
+					const glm::dvec3 edge        = glm::dvec3(getPosition(to)) - a;
+					const double     edge_length = glm::length(edge);
+					if (edge_length <= 0.0)
+						continue;
+
+					const glm::dvec3 edge_normal = glm::normalize(glm::cross(edge, unit_normal));
+					const Quadric    edge_plane  = Quadric::fromPlane(edge_normal, -glm::dot(edge_normal, a), edge_length * edge_length * c_seamWeight);
+					m_quadrics[m_remap[from]] += edge_plane;
+					m_quadrics[m_remap[to]] += edge_plane;
+				}
+			}
+		}
+
+		bool Simplifier::canCollapse(const uint32 p_from, const uint32 p_to, Collapse &p_out_collapse) const
+		{
+			p_out_collapse = {p_from, p_to, c_noVertex, c_noVertex, 0.0};
+
+			if (m_kinds[p_from] == EVertexKind::eManifold)
+				return true;
+			if (m_kinds[p_from] != EVertexKind::eSeam)
+				return false;
+
+			// Along the seam only, and the twin has to go the same way on the other side. Seam edges run in opposite
+			// directions on the two sides
+			const uint32 twin = m_wedges[p_from];
+			uint32       twin_to;
+			if (m_openOut[p_from] == p_to)
+				twin_to = m_openIn[twin];
+			else if (m_openIn[p_from] == p_to)
+				twin_to = m_openOut[twin];
+			else
+				return false;
+
+			// A seam edge between the two twins themselves has no length, collapsing it would only swap them
+			if (twin_to == c_noVertex || twin_to == c_manyVertices || m_remap[twin_to] != m_remap[p_to] || m_remap[p_to] == m_remap[p_from])
+				return false;
+
+			p_out_collapse.twinFrom = twin;
+			p_out_collapse.twinTo   = twin_to;
+			return true;
+		}
+
+		double Simplifier::getCost(const uint32 p_from, const uint32 p_to) const
+		{
+			Quadric quadric = m_quadrics[m_remap[p_from]];
+			quadric += m_quadrics[m_remap[p_to]];
+			return quadric.weight > 0.0 ? std::max(quadric.evaluate(getPosition(p_to)), 0.0) / quadric.weight : 0.0;
+		}
+
+		bool Simplifier::hasFlips(const VertexTriangles &p_adjacency, const uint32 p_from, const uint32 p_to, const std::vector<uint32> &p_collapse_remap) const
+		{
+			const glm::vec3 &from = getPosition(p_from);
+			const glm::vec3 &to   = getPosition(p_to);
+
+			for (const uint32 triangle: p_adjacency.get(p_from))
+			{
+				const uint32 *corners = &m_indices[triangle * 3u];
+				const uint32  corner  = corners[0] == p_from ? 0u : corners[1] == p_from ? 1u : 2u;
+
+				// Neighbours may have moved earlier in this pass already
+				const uint32 b = p_collapse_remap[corners[(corner + 1u) % 3u]];
+				const uint32 c = p_collapse_remap[corners[(corner + 2u) % 3u]];
+				if (b == c || m_remap[b] == m_remap[p_to] || m_remap[c] == m_remap[p_to])
+					continue; // Collapses away
+
+				const glm::vec3 &pb     = getPosition(b);
+				const glm::vec3 &pc     = getPosition(c);
+				const glm::vec3  before = glm::cross(pb - from, pc - from);
+				const glm::vec3  after  = glm::cross(pb - to, pc - to);
+				if (glm::dot(before, after) <= 0.0f && glm::dot(before, before) > 0.0f)
+					return true;
+			}
+			return false;
+		}
+
+		float Simplifier::run(const uint32 p_target_index_count, const float p_max_error)
+		{
+			const double max_cost = static_cast<double>(p_max_error) * p_max_error;
+
+			std::vector<Collapse> collapses;
+			std::vector<uint64>   order;
+			std::vector<uint32>   collapse_remap(m_vertexCount);
+			std::vector<uint8>    moved(m_vertexCount); // Per position, one collapse per position and pass
+
+			while (m_canMove && m_indices.size() > p_target_index_count)
+			{
+				const VertexTriangles adjacency(m_indices, m_vertexCount);
+				findOpenEdges(adjacency);
+
+				// Every edge in its cheaper allowed direction, inner edges only from the side where they go up in index
+				collapses.clear();
+				for (uint64 i = 0u; i < m_indices.size(); i++)
+				{
+					const uint32 a = m_indices[i];
+					const uint32 b = m_indices[i - i % 3u + (i + 1u) % 3u];
+					if (a > b && m_openOut[a] != b && m_openOut[a] != c_manyVertices)
+						continue;
+
+					Collapse forward;
+					Collapse backward;
+					const bool can_forward  = canCollapse(a, b, forward);
+					const bool can_backward = canCollapse(b, a, backward);
+					if (can_forward)
+						forward.cost = getCost(a, b);
+					if (can_backward)
+						backward.cost = getCost(b, a);
+
+					if (can_forward && (!can_backward || forward.cost <= backward.cost))
+						collapses.push_back(forward);
+					else if (can_backward)
+						collapses.push_back(backward);
+				}
+
+				if (collapses.empty())
+					break;
+
+				// Costs are not negative, so their float bits sort like the costs. The candidate index breaks ties.
+				// Only the cheapest part is ever used, so only that is sorted
+				order.resize(collapses.size());
+				for (uint64 i = 0u; i < collapses.size(); i++)
+				{
+					order[i] = static_cast<uint64>(std::bit_cast<uint32>(static_cast<float>(collapses[i].cost))) << 32u | i;
+				}
+				const auto pass_end = order.begin() + (order.size() - 1u) / c_passFraction + 1u;
+				std::nth_element(order.begin(), pass_end - 1, order.end());
+				std::sort(order.begin(), pass_end);
+				order.erase(pass_end, order.end());
+
+				if (collapses[order.front() & UINT32_MAX].cost > max_cost)
+					break;
+
+				const double pass_limit = std::min(max_cost, collapses[order.back() & UINT32_MAX].cost);
+
+				std::iota(collapse_remap.begin(), collapse_remap.end(), 0u);
+				std::fill(moved.begin(), moved.end(), 0u);
+
+				// Each collapse takes out the two triangles on its edge, one on each side for a seam
+				uint64 triangle_count = m_indices.size() / 3u;
+				uint32 applied        = 0u;
+				for (const uint64 key: order)
+				{
+					const Collapse &collapse = collapses[key & UINT32_MAX];
+					if (collapse.cost > pass_limit || triangle_count * 3u <= p_target_index_count)
+						break;
+					if (moved[m_remap[collapse.from]] || moved[m_remap[collapse.to]])
+						continue;
+					if (hasFlips(adjacency, collapse.from, collapse.to, collapse_remap) ||
+						(collapse.twinFrom != c_noVertex && hasFlips(adjacency, collapse.twinFrom, collapse.twinTo, collapse_remap)))
+						continue;
+
+					collapse_remap[collapse.from] = collapse.to;
+					if (collapse.twinFrom != c_noVertex)
+						collapse_remap[collapse.twinFrom] = collapse.twinTo;
+
+					moved[m_remap[collapse.from]] = 1u;
+					moved[m_remap[collapse.to]]   = 1u;
+					m_quadrics[m_remap[collapse.to]] += m_quadrics[m_remap[collapse.from]];
+					m_error = std::max(m_error, static_cast<float>(std::sqrt(collapse.cost)));
+
+					triangle_count -= std::min<uint64>(triangle_count, 2u);
+					applied++;
+				}
+
+				if (applied == 0u)
+					break;
+
+				// Apply the pass and drop the triangles that collapsed
+				uint64 kept = 0u;
+				for (uint64 i = 0u; i < m_indices.size(); i += 3u)
+				{
+					const uint32 a = collapse_remap[m_indices[i]];
+					const uint32 b = collapse_remap[m_indices[i + 1u]];
+					const uint32 c = collapse_remap[m_indices[i + 2u]];
+					if (a == b || a == c || b == c)
+						continue;
+
+					m_indices[kept++] = a;
+					m_indices[kept++] = b;
+					m_indices[kept++] = c;
+				}
+				if (kept == m_indices.size())
+					break; // Nothing collapsed away, another pass would find the same candidates
+
+				m_indices.resize(kept);
+			}
+
+			return m_error;
+		}
+	}
+
+	float simplifyMesh(const std::span<const uint32> p_indices, const void *p_positions, const uint64 p_position_stride, const uint32 p_vertex_count,
+					   const uint32 p_target_index_count, const float p_max_error, std::vector<uint32> &p_out_indices)
+	{
+		Simplifier   simplifier(p_indices, p_positions, p_position_stride, p_vertex_count);
+		const float error = simplifier.run(p_target_index_count, p_max_error);
+		p_out_indices     = simplifier.getIndices();
+		return error;
+	}
+
+	void buildLodChain(const std::span<const uint32> p_indices, const void *p_positions, const uint64 p_position_stride, const uint32 p_vertex_count,
+					   const LodSettings &p_settings, std::vector<LodLevel> &p_out_levels)
+	{
+		p_out_levels.clear();
+
+		const uint32 level_count = std::min(p_settings.levelCount, c_maxLodLevels);
+		if (level_count == 0u || p_indices.size() < 3u)
+			return;
+
+		Simplifier  simplifier(p_indices, p_positions, p_position_stride, p_vertex_count);
+		const float max_error = p_settings.maxError * simplifier.getExtent();
+
+		uint64 previous_count = p_indices.size();
+		double target         = static_cast<double>(p_indices.size());
+		for (uint32 level = 0u; level < level_count; level++)
+		{
+			target *= p_settings.reduction;
+			const uint32 target_count = static_cast<uint32>(target) / 3u * 3u;
+			const float  error        = simplifier.run(target_count, max_error);
+
+			// Stuck on the error limit or on locked vertices, the level and any after it are not worth their memory
+			const uint64 count = simplifier.getIndices().size();
+			if (count > previous_count - (previous_count - std::min<uint64>(target_count, previous_count)) / 2u)
+				break;
+
+			p_out_levels.push_back({simplifier.getIndices(), error});
+			previous_count = count;
+		}
+	}
+}
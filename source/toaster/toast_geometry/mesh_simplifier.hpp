@@ -0,0 +1,41 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "system_types.h"
+
+namespace toaster::geometry
+{
+	constexpr uint32 c_maxLodLevels{8u};
+
+	struct LodSettings
+	{
+		uint32 levelCount{3u}; // Levels below the full detail one, at most c_maxLodLevels
+		float  reduction{0.5f}; // Triangle count of each level relative to the one above
+		float  maxError{0.02f}; // Relative to the mesh's extent, the chain ends early once a level needs more
+
+		bool operator==(const LodSettings &) const = default;
+	};
+
+	struct LodLevel
+	{
+		std::vector<uint32> indices;
+		float               error{0.0f}; // Object space distance the level may be off the full detail surface
+	};
+
+	// Edge collapse simplification with quadric error metrics (Garland and Heckbert 1997). Only the index buffer
+	// changes: each collapse moves a vertex onto a neighbour that already exists, so every level draws from the
+	// original vertices. Borders and vertices where more than two attribute sets meet never move, vertices on an
+	// attribute seam only move along it together with their twin on the other side, so UVs and hard normals stay
+	// intact. Deterministic, like the rest of the mesh processing.
+	// Simplifies down to at most p_target_index_count indices, or as far as it gets without an error above
+	// p_max_error, in object space. Returns the error reached
+	float simplifyMesh(std::span<const uint32> p_indices, const void *p_positions, uint64 p_position_stride, uint32 p_vertex_count, uint32 p_target_index_count,
+					   float p_max_error, std::vector<uint32> &p_out_indices);
+
+	// Builds the levels one after the other in a single simplification run, so the errors only grow. The chain ends
+	// at the first level that gets less than half of its reduction
+	void buildLodChain(std::span<const uint32> p_indices, const void *p_positions, uint64 p_position_stride, uint32 p_vertex_count, const LodSettings &p_settings,
+					   std::vector<LodLevel> &p_out_levels);
+}
@@ -0,0 +1,409 @@
+#include "meshlet.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "toast_assert.h"
+#include "vertex_adjacency.hpp"
+#include "io/stream_reader.hpp"
+#include "io/stream_writer.hpp"
+
+namespace toaster::geometry
+{
+	namespace
+	{
+		constexpr uint8 c_notInMeshlet{0xFFu};
+		// Triangles after the next seed that are looked at when nothing connected to a meshlet fits
+		constexpr uint32 c_meshletSearchWindow{64u};
+
+		// Spreads the low 10 bits of p_value out to every third bit
+		uint32 spreadBits(uint32 p_value)
+		{
+			p_value = (p_value | (p_value << 16u)) & 0x030000FFu;
+			p_value = (p_value | (p_value << 8u)) & 0x0300F00Fu;
+			p_value = (p_value | (p_value << 4u)) & 0x030C30C3u;
+			p_value = (p_value | (p_value << 2u)) & 0x09249249u;
+			return p_value;
+		}
+
+		// 30 bit Z-order curve index of a point normalized to [0, 1]
+		uint32 getMortonCode(const glm::vec3 &p_point)
+		{
+			const glm::uvec3 cell = glm::uvec3(glm::clamp(p_point, 0.0f, 1.0f) * 1023.0f);
+			return spreadBits(cell.x) | (spreadBits(cell.y) << 1u) | (spreadBits(cell.z) << 2u);
+		}
+
+		const glm::vec3 &getPosition(const void *p_positions, const uint64 p_stride, const uint32 p_vertex)
+		{
+			return *reinterpret_cast<const glm::vec3 *>(static_cast<const uint8 *>(p_positions) + p_vertex * p_stride);
+		}
+
+		// Grows p_out as the data arrives rather than resizing to p_count up front, so a corrupt count fails on the
+		// first missing chunk instead of allocating whatever it claims
+		template<typename TVector>
+		bool readArray(io::StreamReader *p_reader, TVector &p_out, const uint64 p_count)
+		{
+			using Element = typename TVector::value_type;
+			constexpr uint64 c_chunkSize{65536u / sizeof(Element)};
+
+			p_out.clear();
+			while (p_out.size() < p_count)
+			{
+				const uint64 first = p_out.size();
+				const uint64 count = std::min(p_count - first, c_chunkSize);
+				p_out.resize(first + count);
+				if (!p_reader->readData(reinterpret_cast<uint8 *>(p_out.data() + first), count * sizeof(Element)))
+					return false;
+			}
+			return true;
+		}
+
+		MeshletBounds computeBounds(const MeshletData &p_data, const Meshlet &p_meshlet, const void *p_positions, const uint64 p_stride)
+		{
+			const uint32 *vertices  = p_data.vertices.data() + p_meshlet.vertexOffset;
+			const uint8 * triangles = p_data.triangles.data() + p_meshlet.triangleOffset;
+
+			MeshletBounds bounds{};
+
+			// Sphere around the box centre, a little looser than the minimal one but cheap and stable
+			glm::vec3 boundsMin(FLT_MAX);
+			glm::vec3 boundsMax(-FLT_MAX);
+			for (uint32 i = 0u; i < p_meshlet.vertexCount; i++)
+			{
+				const glm::vec3 &position = getPosition(p_positions, p_stride, vertices[i]);
+				boundsMin                 = glm::min(boundsMin, position);
+				boundsMax                 = glm::max(boundsMax, position);
+			}
+			bounds.center = (boundsMin + boundsMax) * 0.5f;
+
+			float radius_squared = 0.0f;
+			for (uint32 i = 0u; i < p_meshlet.vertexCount; i++)
+			{
+				const glm::vec3 offset = getPosition(p_positions, p_stride, vertices[i]) - bounds.center;
+				radius_squared         = std::max(radius_squared, glm::dot(offset, offset));
+			}
+			bounds.radius = std::sqrt(radius_squared);
+
+			// Cone axis is the area weighted average normal, the cutoff comes from the normal furthest from it.
+			// Degenerate triangles have no facing and are left out
+			glm::vec3 normals[c_meshletMaxTriangles];
+			uint32    normal_count = 0u;
+			glm::vec3 axis(0.0f);
+			for (uint32 i = 0u; i < p_meshlet.triangleCount; i++)
+			{
+				const glm::vec3 &p0 = getPosition(p_positions, p_stride, vertices[triangles[i * 3u]]);
+				const glm::vec3 &p1 = getPosition(p_positions, p_stride, vertices[triangles[i * 3u + 1u]]);
+				const glm::vec3 &p2 = getPosition(p_positions, p_stride, vertices[triangles[i * 3u + 2u]]);
+
+				const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const float     length = glm::length(normal);
+				if (length <= 0.0f)
+					continue;
+
+				axis += normal;
+				normals[normal_count++] = normal / length;
+			}
+
+			const float axis_length = glm::length(axis);
+			bounds.coneCutoff       = 1.0f;
+			if (normal_count == 0u || axis_length <= 0.0f)
+				return bounds;
+
+			bounds.coneAxis = axis / axis_length;
+
+			float min_dot = 1.0f;
+			for (uint32 i = 0u; i < normal_count; i++)
+			{
+				min_dot = std::min(min_dot, glm::dot(normals[i], bounds.coneAxis));
+			}
+
+			// Normals more than 90 degrees apart from the axis can face the viewer from any side
+			if (min_dot > 0.0f)
+				bounds.coneCutoff = std::sqrt(1.0f - min_dot * min_dot);
+			return bounds;
+		}
+	}
+
+	void MeshletData::clear()
+	{
+		meshlets.clear();
+		bounds.clear();
+		vertices.clear();
+		triangles.clear();
+	}
+
+	void MeshletData::append(const MeshletData &p_other)
+	{
+		const uint32 vertex_base   = static_cast<uint32>(vertices.size());
+		const uint32 triangle_base = static_cast<uint32>(triangles.size());
+
+		for (Meshlet meshlet: p_other.meshlets)
+		{
+			meshlet.vertexOffset += vertex_base;
+			meshlet.triangleOffset += triangle_base;
+			meshlets.push_back(meshlet);
+		}
+		bounds.insert(bounds.end(), p_other.bounds.begin(), p_other.bounds.end());
+		vertices.insert(vertices.end(), p_other.vertices.begin(), p_other.vertices.end());
+		triangles.insert(triangles.end(), p_other.triangles.begin(), p_other.triangles.end());
+	}
+
+	void MeshletData::serialize(io::StreamWriter *writer) const
+	{
+		// Counts first, then the arrays as they are in memory. Stops at the first failed write, the caller checks the
+		// writer afterwards
+		(void)(writer->tryWriteRaw(static_cast<uint64>(meshlets.size())) && writer->tryWriteRaw(static_cast<uint64>(vertices.size())) &&
+			   writer->tryWriteRaw(static_cast<uint64>(triangles.size())) &&
+			   writer->writeData(reinterpret_cast<const uint8 *>(meshlets.data()), meshlets.size() * sizeof(Meshlet)) &&
+			   writer->writeData(reinterpret_cast<const uint8 *>(bounds.data()), bounds.size() * sizeof(MeshletBounds)) &&
+			   writer->writeData(reinterpret_cast<const uint8 *>(vertices.data()), vertices.size() * sizeof(uint32)) &&
+			   writer->writeData(triangles.data(), triangles.size()));
+	}
+
+	void MeshletData::deserialize(io::StreamReader *reader)
+	{
+		uint64 meshlet_count  = 0u;
+		uint64 vertex_count   = 0u;
+		uint64 triangle_bytes = 0u;
+
+		const bool read = reader->readData(reinterpret_cast<uint8 *>(&meshlet_count), sizeof(uint64)) &&
+						  reader->readData(reinterpret_cast<uint8 *>(&vertex_count), sizeof(uint64)) &&
+						  reader->readData(reinterpret_cast<uint8 *>(&triangle_bytes), sizeof(uint64)) &&
+						  readArray(reader, meshlets, meshlet_count) && readArray(reader, bounds, meshlet_count) &&
+						  readArray(reader, vertices, vertex_count) && readArray(reader, triangles, triangle_bytes);
+
+		// Meshlets index straight into the arrays, don't keep any that would read past them
+		const bool in_range = std::ranges::all_of(meshlets, [&](const Meshlet &p_meshlet)
+		{
+			return p_meshlet.vertexCount <= c_meshletMaxVertices && p_meshlet.triangleCount <= c_meshletMaxTriangles &&
+				   static_cast<uint64>(p_meshlet.vertexOffset) + p_meshlet.vertexCount <= vertex_count &&
+				   static_cast<uint64>(p_meshlet.triangleOffset) + p_meshlet.triangleCount * 3u <= triangle_bytes;
+		});
+
+		if (!read || !in_range)
+			clear();
+	}
+
+	void buildMeshlets(const std::span<const uint32> p_indices, const void *p_positions, const uint64 p_position_stride, const uint32 p_vertex_count, MeshletData &p_out)
+	{
+		TST_ASSERT_MSG(p_indices.size() % 3u == 0u, "Expected a triangle list");
+
+		const uint32 triangle_count = static_cast<uint32>(p_indices.size() / 3u);
+		if (triangle_count == 0u)
+			return;
+
+		const VertexTriangles adjacency(p_indices, p_vertex_count);
+
+		std::vector<glm::vec3> triangle_normals(triangle_count);
+		std::vector<glm::vec3> triangle_centroids(triangle_count);
+		for (uint32 triangle = 0u; triangle < triangle_count; triangle++)
+		{
+			const glm::vec3 &p0     = getPosition(p_positions, p_position_stride, p_indices[triangle * 3u]);
+			const glm::vec3 &p1     = getPosition(p_positions, p_position_stride, p_indices[triangle * 3u + 1u]);
+			const glm::vec3 &p2     = getPosition(p_positions, p_position_stride, p_indices[triangle * 3u + 2u]);
+			const glm::vec3  normal = glm::cross(p1 - p0, p2 - p0);
+			const float      length = glm::length(normal);
+			triangle_normals[triangle]   = length > 0.0f ? normal / length : glm::vec3(0.0f);
+			triangle_centroids[triangle] = (p0 + p1 + p2) / 3.0f;
+		}
+
+		// New meshlets are seeded in Z-order, so the next seed is close to the last meshlet whatever order the
+		// triangles come in. Ties keep the index order
+		std::vector<uint32> seed_order(triangle_count);
+		{
+			glm::vec3 centroids_min(FLT_MAX);
+			glm::vec3 centroids_max(-FLT_MAX);
+			for (const glm::vec3 &centroid: triangle_centroids)
+			{
+				centroids_min = glm::min(centroids_min, centroid);
+				centroids_max = glm::max(centroids_max, centroid);
+			}
+			// One scale for all axes, a thin axis stretched to the full range would scramble the order
+			const glm::vec3 extent = centroids_max - centroids_min;
+			const float     scale  = 1.0f / std::max({extent.x, extent.y, extent.z, FLT_MIN});
+
+			std::vector<std::pair<uint32, uint32>> keys(triangle_count);
+			for (uint32 triangle = 0u; triangle < triangle_count; triangle++)
+			{
+				keys[triangle] = {getMortonCode((triangle_centroids[triangle] - centroids_min) * scale), triangle};
+			}
+			std::sort(keys.begin(), keys.end());
+
+			for (uint32 i = 0u; i < triangle_count; i++)
+			{
+				seed_order[i] = keys[i].second;
+			}
+		}
+
+		std::vector<uint8>  emitted(triangle_count, 0u);
+		std::vector<uint8>  local_index(p_vertex_count, c_notInMeshlet); // Vertex slot in the meshlet being built
+		std::vector<uint32> candidates; // Unemitted triangles touching the meshlet, may hold stale entries
+		uint32              next_seed = 0u;
+
+		Meshlet   meshlet{static_cast<uint32>(p_out.vertices.size()), static_cast<uint32>(p_out.triangles.size()), 0u, 0u};
+		glm::vec3 normal_sum(0.0f);
+		glm::vec3 meshlet_min(FLT_MAX);
+		glm::vec3 meshlet_max(-FLT_MAX);
+
+		const auto countNewVertices = [&](const uint32 p_triangle)
+		{
+			uint32 count = 0u;
+			for (uint32 corner = 0u; corner < 3u; corner++)
+			{
+				count += local_index[p_indices[p_triangle * 3u + corner]] == c_notInMeshlet ? 1u : 0u;
+			}
+			return count;
+		};
+
+		const auto finishMeshlet = [&]
+		{
+			if (meshlet.triangleCount == 0u)
+				return;
+
+			p_out.meshlets.push_back(meshlet);
+			p_out.bounds.push_back(computeBounds(p_out, meshlet, p_positions, p_position_stride));
+
+			for (uint32 i = 0u; i < meshlet.vertexCount; i++)
+			{
+				local_index[p_out.vertices[meshlet.vertexOffset + i]] = c_notInMeshlet;
+			}
+			meshlet     = {static_cast<uint32>(p_out.vertices.size()), static_cast<uint32>(p_out.triangles.size()), 0u, 0u};
+			normal_sum  = glm::vec3(0.0f);
+			meshlet_min = glm::vec3(FLT_MAX);
+			meshlet_max = glm::vec3(-FLT_MAX);
+			candidates.clear();
+		};
+
+		// Unconnected triangle close to the meshlet, for meshes whose triangles share few or no vertices. Only the
+		// next few seeds are looked at, and only ones within the meshlet's extent from its centre
+		const auto findNearby = [&]
+		{
+			const glm::vec3 center        = (meshlet_min + meshlet_max) * 0.5f;
+			float           best_distance = glm::dot(meshlet_max - meshlet_min, meshlet_max - meshlet_min);
+			uint32          best_triangle = UINT32_MAX;
+
+			const uint32 end = std::min(triangle_count, next_seed + c_meshletSearchWindow);
+			for (uint32 i = next_seed; i < end; i++)
+			{
+				const uint32 triangle = seed_order[i];
+				if (emitted[triangle])
+					continue;
+
+				const glm::vec3 offset   = triangle_centroids[triangle] - center;
+				const float     distance = glm::dot(offset, offset);
+				if (distance <= best_distance && glm::dot(triangle_normals[triangle], normal_sum) >= 0.0f)
+				{
+					best_distance = distance;
+					best_triangle = triangle;
+				}
+			}
+			return best_triangle;
+		};
+
+		for (uint32 emitted_count = 0u; emitted_count < triangle_count; emitted_count++)
+		{
+			// Neighbour adding the fewest vertices, then the one best aligned with the meshlet's facing, then the
+			// lowest index so the result does not depend on the candidate order
+			uint32 best           = UINT32_MAX;
+			uint32 best_new       = UINT32_MAX;
+			float  best_alignment = -FLT_MAX;
+
+			uint32 kept = 0u;
+			for (const uint32 triangle: candidates)
+			{
+				if (emitted[triangle])
+					continue;
+				candidates[kept++] = triangle;
+
+				const uint32 new_vertices = countNewVertices(triangle);
+				if (meshlet.vertexCount + new_vertices > c_meshletMaxVertices)
+					continue;
+
+				const float alignment = glm::dot(triangle_normals[triangle], normal_sum);
+				if (new_vertices < best_new || (new_vertices == best_new && (alignment > best_alignment || (alignment == best_alignment && triangle < best))))
+				{
+					best           = triangle;
+					best_new       = new_vertices;
+					best_alignment = alignment;
+				}
+			}
+			candidates.resize(kept);
+
+			// Nothing connected fits: take an unconnected one nearby while there is room, else start over from the
+			// next seed
+			while (emitted[seed_order[next_seed]])
+			{
+				next_seed++;
+			}
+
+			if (best == UINT32_MAX && meshlet.triangleCount > 0u && meshlet.vertexCount + 3u <= c_meshletMaxVertices)
+				best = findNearby();
+
+			if (best == UINT32_MAX)
+			{
+				finishMeshlet();
+				best = seed_order[next_seed];
+			}
+
+			emitted[best] = 1u;
+			normal_sum += triangle_normals[best];
+
+			for (uint32 corner = 0u; corner < 3u; corner++)
+			{
+				const uint32 vertex = p_indices[best * 3u + corner];
+				if (local_index[vertex] == c_notInMeshlet)
+				{
+					const glm::vec3 &position = getPosition(p_positions, p_position_stride, vertex);
+					meshlet_min               = glm::min(meshlet_min, position);
+					meshlet_max               = glm::max(meshlet_max, position);
+
+					local_index[vertex] = static_cast<uint8>(meshlet.vertexCount++);
+					p_out.vertices.push_back(vertex);
+
+					for (const uint32 triangle: adjacency.get(vertex))
+					{
+						if (!emitted[triangle])
+							candidates.push_back(triangle);
+					}
+				}
+				p_out.triangles.push_back(local_index[vertex]);
+			}
+
+			if (++meshlet.triangleCount == c_meshletMaxTriangles)
+				finishMeshlet();
+		}
+
+		finishMeshlet();
+	}
+
+	uint32 cullMeshlets(const tsm::Frustum &p_frustum, const glm::vec3 &p_eye, const std::span<const MeshletBounds> p_bounds, std::vector<uint32> &p_out_visible,
+						MeshletCullStats *p_out_stats)
+	{
+		p_out_visible.clear();
+
+		MeshletCullStats stats;
+		for (uint32 i = 0u; i < p_bounds.size(); i++)
+		{
+			const MeshletBounds &bounds = p_bounds[i];
+			if (!p_frustum.isSphereVisible(bounds.center, bounds.radius))
+			{
+				stats.frustumCulled++;
+				continue;
+			}
+
+			// Written without normalizing so an eye inside the sphere is never culled
+			const glm::vec3 to_center = bounds.center - p_eye;
+			if (glm::dot(to_center, bounds.coneAxis) >= bounds.coneCutoff * glm::length(to_center) + bounds.radius)
+			{
+				stats.backfaceCulled++;
+				continue;
+			}
+
+			p_out_visible.push_back(i);
+		}
+
+		if (p_out_stats)
+			*p_out_stats = stats;
+		return static_cast<uint32>(p_out_visible.size());
+	}
+}
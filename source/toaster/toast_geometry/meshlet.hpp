@@ -0,0 +1,74 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+#include "io/serializable.hpp"
+#include "math/math_frustum.hpp"
+#include "memory/tracked_allocator.hpp"
+
+namespace toaster::geometry
+{
+	// Limits that fit mesh shader workgroups on every vendor: 64 vertices and 124 triangles keep the micro-index
+	// buffer of one meshlet within 372 bytes and its output within NVIDIA's 256 vertex / 512 primitive limits
+	constexpr uint32 c_meshletMaxVertices{64u};
+	constexpr uint32 c_meshletMaxTriangles{124u};
+
+	// A small cluster of triangles. Its vertices are vertexCount entries of MeshletData::vertices starting at
+	// vertexOffset, its triangles triangleCount * 3 micro-indices into those, starting at triangleOffset
+	struct Meshlet
+	{
+		uint32 vertexOffset;
+		uint32 triangleOffset;
+		uint32 vertexCount;
+		uint32 triangleCount;
+	};
+
+	// Bounding sphere plus the cone around all the triangle normals. The meshlet is backfacing as a whole when seen
+	// from anywhere that dot(normalize(center - eye), coneAxis) >= coneCutoff + radius / distance. coneCutoff is the
+	// sine of the cone's half angle, 1 when the normals spread too far to ever cull
+	struct MeshletBounds
+	{
+		glm::vec3 center;
+		float     radius;
+		glm::vec3 coneAxis;
+		float     coneCutoff;
+	};
+
+	static_assert(sizeof(Meshlet) == 16u && sizeof(MeshletBounds) == 32u);
+
+	struct MeshletData final : io::Serializable
+	{
+		memory::TrackedVector<Meshlet, memory::EMemoryTag::eMesh>       meshlets;
+		memory::TrackedVector<MeshletBounds, memory::EMemoryTag::eMesh> bounds;    // One per meshlet
+		memory::TrackedVector<uint32, memory::EMemoryTag::eMesh>        vertices;  // Indices into the mesh's vertex buffer
+		memory::TrackedVector<uint8, memory::EMemoryTag::eMesh>         triangles; // Micro-indices, three per triangle
+
+		void clear();
+		// Copies p_other's meshlets to the end, their offsets are rebased onto this data
+		void append(const MeshletData &p_other);
+
+		void serialize(io::StreamWriter *writer) const override;
+		void deserialize(io::StreamReader *reader) override;
+	};
+
+	// Splits an indexed triangle list into meshlets, appended to p_out. Grows each meshlet with the neighbouring
+	// triangle that adds the fewest new vertices, so meshlets stay compact and their normal cones narrow. New meshlets
+	// are seeded in Z-order of the triangle centroids, so triangle soups that share no vertices still cluster well
+	void buildMeshlets(std::span<const uint32> p_indices, const void *p_positions, uint64 p_position_stride, uint32 p_vertex_count, MeshletData &p_out);
+
+	struct MeshletCullStats
+	{
+		uint32 frustumCulled{0u};
+		uint32 backfaceCulled{0u};
+	};
+
+	// CPU reference for the GPU cluster culling: keeps the meshlets whose bounding sphere is in the frustum and
+	// whose cone is not facing away from p_eye. Everything is in mesh space, transform the frustum and the eye
+	// with the inverse of the model matrix first. p_out_visible is replaced with the indices of the visible meshlets
+	uint32 cullMeshlets(const tsm::Frustum &p_frustum, const glm::vec3 &p_eye, std::span<const MeshletBounds> p_bounds, std::vector<uint32> &p_out_visible,
+						MeshletCullStats *p_out_stats = nullptr);
+}
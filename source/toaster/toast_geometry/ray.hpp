@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+
+namespace toaster::geometry
+{
+	inline constexpr uint32 c_invalidTriangle{UINT32_MAX};
+
+	// Slab tests scale the exit distance by this so rounding can not make a ray grazing a box corner or edge miss it
+	// (1 + 2 * gamma(3), Ize 2013)
+	inline constexpr float c_slabExitScale{1.0f + 2.0f * (3.0f * FLT_EPSILON * 0.5f) / (1.0f - 3.0f * FLT_EPSILON * 0.5f)};
+
+	struct Ray
+	{
+		glm::vec3 origin{0.0f};
+		float     tMin{0.0f};
+		glm::vec3 direction{0.0f, 0.0f, -1.0f}; // Does not need to be normalized, t is in units of its length
+		float     tMax{FLT_MAX};
+	};
+
+	// Hit point = (1 - u - v) * v0 + u * v1 + v * v2
+	struct RayHit
+	{
+		float  t{FLT_MAX};
+		float  u{0.0f};
+		float  v{0.0f};
+		uint32 triangle{c_invalidTriangle}; // Triangle index in the source index buffer, i.e. first index / 3
+
+		[[nodiscard]] bool isHit() const { return triangle != c_invalidTriangle; }
+	};
+
+	// Eight rays in structure of arrays layout for packet traversal. Works best for coherent rays (primary rays,
+	// picking around the cursor), incoherent rays end up visiting the union of their paths
+	struct alignas(32) RayPacket8
+	{
+		static constexpr uint32 c_size{8u};
+
+		float originX[c_size];
+		float originY[c_size];
+		float originZ[c_size];
+		float directionX[c_size];
+		float directionY[c_size];
+		float directionZ[c_size];
+		float tMin[c_size];
+		float tMax[c_size];
+
+		void setRay(uint32 p_lane, const Ray &p_ray)
+		{
+			originX[p_lane]    = p_ray.origin.x;
+			originY[p_lane]    = p_ray.origin.y;
+			originZ[p_lane]    = p_ray.origin.z;
+			directionX[p_lane] = p_ray.direction.x;
+			directionY[p_lane] = p_ray.direction.y;
+			directionZ[p_lane] = p_ray.direction.z;
+			tMin[p_lane]       = p_ray.tMin;
+			tMax[p_lane]       = p_ray.tMax;
+		}
+
+		[[nodiscard]] Ray getRay(uint32 p_lane) const
+		{
+			return {{originX[p_lane], originY[p_lane], originZ[p_lane]}, tMin[p_lane], {directionX[p_lane], directionY[p_lane], directionZ[p_lane]}, tMax[p_lane]};
+		}
+	};
+
+	// 1 / direction for the slab tests. Zero components become a huge finite value instead of infinity, a ray lying
+	// exactly in a box face plane would otherwise produce 0 * inf = NaN and miss the box depending on operand order
+	inline glm::vec3 getSafeInverse(const glm::vec3 &p_direction)
+	{
+		constexpr float c_minComponent{1e-30f};
+
+		glm::vec3 result;
+		for (int i = 0; i < 3; i++)
+		{
+			const float component = std::abs(p_direction[i]) < c_minComponent ? std::copysign(c_minComponent, p_direction[i]) : p_direction[i];
+			result[i]             = 1.0f / component;
+		}
+		return result;
+	}
+
+	// Per ray setup of the watertight ray / triangle test (Woop, Benthin, Wald 2013). Rays hitting a shared edge or
+	// vertex always hit at least one of the triangles, so there are no cracks between neighbours
+	struct WatertightRay
+	{
+		glm::vec3 origin;
+		int       kx;
+		int       ky;
+		int       kz;
+		float     shearX;
+		float     shearY;
+		float     shearZ;
+
+		WatertightRay() = default;
+
+		explicit WatertightRay(const Ray &p_ray) : origin(p_ray.origin)
+		{
+			// The dominant direction axis becomes z, the winding is kept by swapping x and y for negative directions
+			const glm::vec3 abs_direction = glm::abs(p_ray.direction);
+			kz = abs_direction.x > abs_direction.y ? (abs_direction.x > abs_direction.z ? 0 : 2) : (abs_direction.y > abs_direction.z ? 1 : 2);
+			kx = (kz + 1) % 3;
+			ky = (kx + 1) % 3;
+			if (p_ray.direction[kz] < 0.0f)
+				std::swap(kx, ky);
+
+			shearX = p_ray.direction[kx] / p_ray.direction[kz];
+			shearY = p_ray.direction[ky] / p_ray.direction[kz];
+			shearZ = 1.0f / p_ray.direction[kz];
+		}
+	};
+
+	// Updates p_hit when the triangle is hit inside (p_t_min, p_hit.t). Both windings count
+	inline bool intersectTriangle(const WatertightRay &p_ray, const glm::vec3 &p_v0, const glm::vec3 &p_v1, const glm::vec3 &p_v2, float p_t_min, uint32 p_triangle, RayHit &p_hit)
+	{
+		const glm::vec3 a = p_v0 - p_ray.origin;
+		const glm::vec3 b = p_v1 - p_ray.origin;
+		const glm::vec3 c = p_v2 - p_ray.origin;
+
+		// Shear and scale into ray space, the ray becomes the +z axis through the origin
+		const float ax = a[p_ray.kx] - p_ray.shearX * a[p_ray.kz];
+		const float ay = a[p_ray.ky] - p_ray.shearY * a[p_ray.kz];
+		const float bx = b[p_ray.kx] - p_ray.shearX * b[p_ray.kz];
+		const float by = b[p_ray.ky] - p_ray.shearY * b[p_ray.kz];
+		const float cx = c[p_ray.kx] - p_ray.shearX * c[p_ray.kz];
+		const float cy = c[p_ray.ky] - p_ray.shearY * c[p_ray.kz];
+
+		// Scaled barycentrics as 2D edge functions. Products of two floats are exact in double, so every edge gives
+		// bit identical (negated) values in both triangles sharing it no matter how the compiler contracts the
+		// expressions into FMAs. That is what makes the test watertight
+		const double du = static_cast<double>(cx) * by - static_cast<double>(cy) * bx;
+		const double dv = static_cast<double>(ax) * cy - static_cast<double>(ay) * cx;
+		const double dw = static_cast<double>(bx) * ay - static_cast<double>(by) * ax;
+
+		if ((du < 0.0 || dv < 0.0 || dw < 0.0) && (du > 0.0 || dv > 0.0 || dw > 0.0))
+			return false;
+
+		const float u = static_cast<float>(du);
+		const float v = static_cast<float>(dv);
+		const float w = static_cast<float>(dw);
+
+		const float det = u + v + w;
+		if (det == 0.0f)
+			return false;
+
+		const float az = p_ray.shearZ * a[p_ray.kz];
+		const float bz = p_ray.shearZ * b[p_ray.kz];
+		const float cz = p_ray.shearZ * c[p_ray.kz];
+
+		const float rcp_det = 1.0f / det;
+		const float t       = (u * az + v * bz + w * cz) * rcp_det;
+		if (!(t > p_t_min && t < p_hit.t))
+			return false;
+
+		p_hit.t        = t;
+		p_hit.u        = v * rcp_det;
+		p_hit.v        = w * rcp_det;
+		p_hit.triangle = p_triangle;
+		return true;
+	}
+}
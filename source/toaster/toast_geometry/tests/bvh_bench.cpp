@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "test_meshes.hpp"
+#include "bvh.hpp"
+#include "bvh_wide.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+// Binned SAH build of a 1M triangle mesh, serial and with subtrees as jobs (every hardware thread)
+TST_BENCHMARK(bvhBuild)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(512u, 1024u);
+	const double         items = static_cast<double>(mesh.indices.size() / 3u);
+
+	std::printf("%llu triangles, %u hardware threads\n", static_cast<unsigned long long>(mesh.indices.size() / 3u), std::thread::hardware_concurrency());
+
+	geometry::Bvh bvh;
+	test::report("build, serial", test::measureNs([&]
+	{
+		bvh.build(mesh.getView(), {.parallel = false});
+	}, 3), items);
+
+	jobs::initialize({});
+	test::report("build, jobs", test::measureNs([&]
+	{
+		bvh.build(mesh.getView());
+	}, 3), items);
+	jobs::shutdown();
+}
+
+// Closest hit against a 1M triangle mesh: 1M coherent camera rays and 1M random rays through the binary BVH one by
+// one, as packets of 8, and through the 4 wide BVH
+TST_BENCHMARK(bvhTraversal)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(512u, 1024u);
+
+	geometry::Bvh bvh;
+	bvh.build(mesh.getView(), {.parallel = false});
+
+	geometry::Bvh4 bvh4;
+	bvh4.build(bvh);
+
+	struct RaySet
+	{
+		const char                *name;
+		std::vector<geometry::Ray> rays;
+	};
+	const RaySet ray_sets[] = {
+		{"camera rays", test::makeCameraRays(1024u, 1024u)},
+		{"random rays", test::makeRandomRays(1u << 20u, 12345u)},
+	};
+
+	for (const RaySet &ray_set: ray_sets)
+	{
+		const std::vector<geometry::Ray> &rays  = ray_set.rays;
+		const double                      items = static_cast<double>(rays.size());
+		std::vector<geometry::RayHit>     hits(rays.size());
+
+		std::printf("%s:\n", ray_set.name);
+
+		test::report("Bvh, single rays", test::measureNs([&]
+		{
+			for (uint64 i = 0u; i < rays.size(); i++)
+			{
+				hits[i] = {};
+				bvh.intersect(rays[i], hits[i]);
+			}
+			test::doNotOptimize(hits);
+		}, 3), items);
+
+		test::report("Bvh, packets of 8", test::measureNs([&]
+		{
+			for (uint64 first = 0u; first < rays.size(); first += geometry::RayPacket8::c_size)
+			{
+				geometry::RayPacket8 packet;
+				for (uint32 lane = 0u; lane < geometry::RayPacket8::c_size; lane++)
+				{
+					packet.setRay(lane, rays[first + lane]);
+				}
+				bvh.intersect(packet, hits.data() + first);
+			}
+			test::doNotOptimize(hits);
+		}, 3), items);
+
+		test::report("Bvh4, single rays", test::measureNs([&]
+		{
+			for (uint64 i = 0u; i < rays.size(); i++)
+			{
+				hits[i] = {};
+				bvh4.intersect(rays[i], hits[i]);
+			}
+			test::doNotOptimize(hits);
+		}, 3), items);
+
+		test::report("Bvh, any hit", test::measureNs([&]
+		{
+			uint64 occluded = 0u;
+			for (const geometry::Ray &ray: rays)
+			{
+				occluded += bvh.intersectAny(ray) ? 1u : 0u;
+			}
+			test::doNotOptimize(occluded);
+		}, 3), items);
+	}
+}
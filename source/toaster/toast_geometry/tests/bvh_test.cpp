@@ -0,0 +1,146 @@
+#include <utility>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "test_meshes.hpp"
+#include "bvh.hpp"
+#include "bvh_wide.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	geometry::RayHit intersectBruteForce(const test::TestMesh &p_mesh, const geometry::Ray &p_ray)
+	{
+		const geometry::WatertightRay ray(p_ray);
+
+		geometry::RayHit hit;
+		hit.t = p_ray.tMax;
+		for (uint32 triangle = 0u; triangle < p_mesh.indices.size() / 3u; triangle++)
+		{
+			geometry::intersectTriangle(ray, p_mesh.positions[p_mesh.indices[triangle * 3u]], p_mesh.positions[p_mesh.indices[triangle * 3u + 1u]],
+										p_mesh.positions[p_mesh.indices[triangle * 3u + 2u]], p_ray.tMin, triangle, hit);
+		}
+		return hit;
+	}
+
+	// Same distance is enough, a ray through a shared edge may report either triangle
+	bool sameHit(const geometry::RayHit &p_a, const geometry::RayHit &p_b)
+	{
+		return p_a.isHit() == p_b.isHit() && (!p_a.isHit() || p_a.t == p_b.t);
+	}
+
+	struct JobSystemScope
+	{
+		explicit JobSystemScope(const uint32 p_workers) { jobs::initialize({p_workers}); }
+		~JobSystemScope() { jobs::shutdown(); }
+	};
+}
+
+TST_TEST(bvhMatchesBruteForce)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(64u, 128u);
+
+	geometry::Bvh bvh;
+	TST_CHECK(bvh.build(mesh.getView()));
+
+	geometry::Bvh4 bvh4;
+	bvh4.build(bvh);
+
+	std::vector<geometry::Ray> rays = test::makeRandomRays(1'000u, 99u);
+	const std::vector<geometry::Ray> camera_rays = test::makeCameraRays(32u, 32u);
+	rays.insert(rays.end(), camera_rays.begin(), camera_rays.end());
+
+	uint32 hits = 0u;
+	for (const geometry::Ray &ray: rays)
+	{
+		const geometry::RayHit expected = intersectBruteForce(mesh, ray);
+		hits += expected.isHit() ? 1u : 0u;
+
+		geometry::RayHit hit;
+		bvh.intersect(ray, hit);
+		TST_CHECK(sameHit(hit, expected));
+
+		geometry::RayHit hit4;
+		bvh4.intersect(ray, hit4);
+		TST_CHECK(sameHit(hit4, expected));
+
+		TST_CHECK(bvh.intersectAny(ray) == expected.isHit());
+	}
+	// Guards against a test that passes because nothing is hit
+	TST_CHECK(hits > rays.size() / 4u);
+
+	for (uint64 first = 0u; first + geometry::RayPacket8::c_size <= rays.size(); first += geometry::RayPacket8::c_size)
+	{
+		geometry::RayPacket8 packet;
+		for (uint32 lane = 0u; lane < geometry::RayPacket8::c_size; lane++)
+		{
+			packet.setRay(lane, rays[first + lane]);
+		}
+
+		geometry::RayHit packet_hits[geometry::RayPacket8::c_size];
+		bvh.intersect(packet, packet_hits);
+		for (uint32 lane = 0u; lane < geometry::RayPacket8::c_size; lane++)
+		{
+			geometry::RayHit hit;
+			bvh.intersect(rays[first + lane], hit);
+			TST_CHECK(sameHit(packet_hits[lane], hit));
+		}
+	}
+}
+
+// Built as jobs the tree is laid out differently in memory, but has the same nodes
+TST_TEST(bvhParallelBuildMatchesSerial)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(128u, 256u);
+
+	geometry::Bvh serial;
+	serial.build(mesh.getView(), {.parallel = false});
+
+	JobSystemScope job_system(3u);
+	geometry::Bvh  parallel;
+	parallel.build(mesh.getView());
+
+	TST_CHECK(parallel.getNodes().size() == serial.getNodes().size());
+	TST_CHECK(parallel.getTriangleIds().size() == serial.getTriangleIds().size());
+	TST_CHECK(parallel.getBoundsMin() == serial.getBoundsMin() && parallel.getBoundsMax() == serial.getBoundsMax());
+
+	for (const geometry::Ray &ray: test::makeRandomRays(2'000u, 7u))
+	{
+		geometry::RayHit serial_hit, parallel_hit;
+		serial.intersect(ray, serial_hit);
+		parallel.intersect(ray, parallel_hit);
+		TST_CHECK(sameHit(serial_hit, parallel_hit) && serial_hit.triangle == parallel_hit.triangle);
+	}
+}
+
+// The wide BVH keeps working after its source is moved from and destroyed
+TST_TEST(bvh4OutlivesSource)
+{
+	const test::TestMesh             mesh = test::makeBumpySphere(32u, 64u);
+	const std::vector<geometry::Ray> rays = test::makeRandomRays(500u, 3u);
+
+	geometry::Bvh4                bvh4;
+	std::vector<geometry::RayHit> expected;
+	{
+		geometry::Bvh bvh;
+		bvh.build(mesh.getView());
+		bvh4.build(bvh);
+
+		for (const geometry::Ray &ray: rays)
+		{
+			bvh.intersect(ray, expected.emplace_back());
+		}
+
+		geometry::Bvh moved = std::move(bvh);
+		moved.clear();
+	}
+
+	for (uint64 i = 0u; i < rays.size(); i++)
+	{
+		geometry::RayHit hit;
+		bvh4.intersect(rays[i], hit);
+		TST_CHECK(sameHit(hit, expected[i]) && hit.triangle == expected[i].triangle);
+	}
+}
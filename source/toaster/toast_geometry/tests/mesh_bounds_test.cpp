@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "test_meshes.hpp"
+#include "mesh_bounds.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	uint32 nextRandom(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return p_state;
+	}
+
+	float randomFloat(uint32 &p_state, const float p_min, const float p_max)
+	{
+		return p_min + (p_max - p_min) * static_cast<float>(nextRandom(p_state) >> 8u) / static_cast<float>(1u << 24u);
+	}
+
+	// A position followed by other attributes, the layout the importer hands in
+	struct Vertex
+	{
+		glm::vec3 position;
+		float     extra[5];
+	};
+
+	bool containsAll(const geometry::BoundingSphere &p_sphere, const std::vector<glm::vec3> &p_positions)
+	{
+		return std::ranges::all_of(p_positions, [&p_sphere](const glm::vec3 &p_position)
+		{
+			return glm::length(p_position - p_sphere.center) <= p_sphere.radius * 1.00001f + 1e-6f;
+		});
+	}
+}
+
+// Every count around the SIMD loop's pairs and its scalar tail, tightly packed and interleaved, against a plain loop
+TST_TEST(computeAabbMatchesScalar)
+{
+	uint32 state = 17u;
+	for (const uint32 count: {1u, 2u, 3u, 4u, 5u, 6u, 7u, 1'001u})
+	{
+		// Sized exactly, a load past the last position would read outside the allocation
+		std::vector<glm::vec3> packed(count);
+		std::vector<Vertex>    interleaved(count);
+		glm::vec3              expected_min(FLT_MAX);
+		glm::vec3              expected_max(-FLT_MAX);
+		for (uint32 i = 0u; i < count; i++)
+		{
+			packed[i]               = glm::vec3(randomFloat(state, -100.0f, 100.0f), randomFloat(state, -1.0f, 1.0f), randomFloat(state, 5.0f, 6.0f));
+			interleaved[i].position = packed[i];
+			std::fill(std::begin(interleaved[i].extra), std::end(interleaved[i].extra), i % 2u ? -1e9f : 1e9f);
+			expected_min = glm::min(expected_min, packed[i]);
+			expected_max = glm::max(expected_max, packed[i]);
+		}
+
+		glm::vec3 bounds_min;
+		glm::vec3 bounds_max;
+		geometry::computeAabb(packed.data(), sizeof(glm::vec3), count, bounds_min, bounds_max);
+		TST_CHECK(bounds_min == expected_min && bounds_max == expected_max);
+
+		geometry::computeAabb(&interleaved[0].position, sizeof(Vertex), count, bounds_min, bounds_max);
+		TST_CHECK(bounds_min == expected_min && bounds_max == expected_max);
+	}
+
+	// Nothing gives an inverted box
+	glm::vec3 bounds_min;
+	glm::vec3 bounds_max;
+	geometry::computeAabb(nullptr, sizeof(glm::vec3), 0u, bounds_min, bounds_max);
+	TST_CHECK(bounds_min == glm::vec3(FLT_MAX) && bounds_max == glm::vec3(-FLT_MAX));
+
+	// A NaN coordinate is skipped on both paths instead of poisoning the box
+	std::vector<glm::vec3> with_nan = {{1.0f, 2.0f, 3.0f}, {std::numeric_limits<float>::quiet_NaN(), -1.0f, 0.0f}, {-1.0f, 0.0f, 4.0f}, {0.0f, 1.0f, 2.0f}};
+	geometry::computeAabb(with_nan.data(), sizeof(glm::vec3), with_nan.size(), bounds_min, bounds_max);
+	TST_CHECK(bounds_min == glm::vec3(-1.0f, -1.0f, 0.0f) && bounds_max == glm::vec3(1.0f, 2.0f, 4.0f));
+}
+
+// The sphere holds every position and is close to the minimal one where that is known
+TST_TEST(boundingSphereIsConservativeAndTight)
+{
+	uint32 state = 23u;
+
+	// Points on a sphere away from the origin, the minimal sphere is that sphere
+	const glm::vec3        center(3.0f, -2.0f, 10.0f);
+	std::vector<glm::vec3> shell;
+	while (shell.size() < 2'000u)
+	{
+		const glm::vec3 direction(randomFloat(state, -1.0f, 1.0f), randomFloat(state, -1.0f, 1.0f), randomFloat(state, -1.0f, 1.0f));
+		const float     length = glm::length(direction);
+		if (length > 0.1f && length <= 1.0f)
+			shell.push_back(center + direction / length * 2.0f);
+	}
+	const geometry::BoundingSphere shell_sphere = geometry::computeBoundingSphere(shell.data(), sizeof(glm::vec3), shell.size());
+	std::printf("  shell: radius %.4f for a minimal 2\n", shell_sphere.radius);
+	TST_CHECK(containsAll(shell_sphere, shell));
+	TST_CHECK(shell_sphere.radius <= 2.0f * 1.05f && glm::length(shell_sphere.center - center) < 0.1f);
+
+	// A long thin cloud, rotated so no axis extreme lies on the long axis ends
+	std::vector<glm::vec3> rod;
+	for (uint32 i = 0u; i < 2'000u; i++)
+	{
+		const float along = randomFloat(state, -10.0f, 10.0f);
+		rod.emplace_back(along * 0.6f + randomFloat(state, -0.5f, 0.5f), along * 0.8f + randomFloat(state, -0.5f, 0.5f), randomFloat(state, -0.5f, 0.5f));
+	}
+	const geometry::BoundingSphere rod_sphere = geometry::computeBoundingSphere(rod.data(), sizeof(glm::vec3), rod.size());
+
+	float rod_half_length = 0.0f;
+	for (const glm::vec3 &position: rod)
+	{
+		rod_half_length = std::max(rod_half_length, glm::length(position));
+	}
+	std::printf("  rod: radius %.4f, furthest point %.4f from the middle\n", rod_sphere.radius, rod_half_length);
+	TST_CHECK(containsAll(rod_sphere, rod));
+	TST_CHECK(rod_sphere.radius <= rod_half_length * 1.05f);
+
+	// A mesh handed in with its other attributes
+	const test::TestMesh mesh = test::makeBumpySphere(32u, 64u);
+	std::vector<Vertex>  vertices(mesh.positions.size());
+	for (uint64 i = 0u; i < vertices.size(); i++)
+	{
+		vertices[i].position = mesh.positions[i];
+	}
+	const geometry::BoundingSphere mesh_sphere = geometry::computeBoundingSphere(&vertices[0].position, sizeof(Vertex), vertices.size());
+	TST_CHECK(containsAll(mesh_sphere, mesh.positions) && mesh_sphere.radius <= 1.05f * 1.05f);
+
+	// Degenerate inputs
+	const glm::vec3                point(1.0f, 2.0f, 3.0f);
+	const geometry::BoundingSphere single = geometry::computeBoundingSphere(&point, sizeof(glm::vec3), 1u);
+	TST_CHECK(single.center == point && single.radius == 0.0f);
+
+	const glm::vec3                pair[] = {{-1.0f, 0.0f, 0.0f}, {3.0f, 0.0f, 0.0f}};
+	const geometry::BoundingSphere two    = geometry::computeBoundingSphere(pair, sizeof(glm::vec3), 2u);
+	TST_CHECK(two.center == glm::vec3(1.0f, 0.0f, 0.0f) && two.radius == 2.0f);
+
+	const geometry::BoundingSphere empty = geometry::computeBoundingSphere(nullptr, sizeof(glm::vec3), 0u);
+	TST_CHECK(empty.center == glm::vec3(0.0f) && empty.radius == 0.0f);
+}
+
+TST_TEST(surfaceStatsSumAreas)
+{
+	// Two triangles over the unit square, UVs spanning twice the size in each direction
+	const glm::vec3           positions[] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}};
+	const glm::vec2           uvs[]       = {{0.0f, 0.0f}, {2.0f, 0.0f}, {0.0f, 2.0f}, {2.0f, 2.0f}};
+	const std::vector<uint32> indices     = {0u, 1u, 2u, 2u, 1u, 3u};
+
+	const geometry::SurfaceStats stats = geometry::computeSurfaceStats(indices, positions, sizeof(glm::vec3), uvs, sizeof(glm::vec2));
+	TST_CHECK(stats.triangleCount == 2u && stats.surfaceArea == 1.0f && stats.uvArea == 4.0f && stats.getUvDensity() == 4.0f);
+
+	// Mirrored UVs count their area the same
+	const glm::vec2              mirrored[] = {{2.0f, 0.0f}, {0.0f, 0.0f}, {2.0f, 2.0f}, {0.0f, 2.0f}};
+	const geometry::SurfaceStats flipped    = geometry::computeSurfaceStats(indices, positions, sizeof(glm::vec3), mirrored, sizeof(glm::vec2));
+	TST_CHECK(flipped.uvArea == 4.0f);
+
+	const geometry::SurfaceStats no_uvs = geometry::computeSurfaceStats(indices, positions, sizeof(glm::vec3), nullptr, 0u);
+	TST_CHECK(no_uvs.uvArea == 0.0f && no_uvs.getUvDensity() == 0.0f && no_uvs.surfaceArea == 1.0f);
+	TST_CHECK(geometry::computeSurfaceStats({}, positions, sizeof(glm::vec3), uvs, sizeof(glm::vec2)).getUvDensity() == 0.0f);
+
+	// The bumps add a little to the unit sphere's 4 pi
+	const test::TestMesh sphere = test::makeBumpySphere(64u, 128u);
+	const float          area   = geometry::computeSurfaceStats(sphere.indices, sphere.positions.data(), sizeof(glm::vec3), nullptr, 0u).surfaceArea;
+	std::printf("  sphere area %.3f\n", area);
+	TST_CHECK(area > 4.0f * 3.14159265f && area < 4.0f * 3.14159265f * 1.15f);
+}
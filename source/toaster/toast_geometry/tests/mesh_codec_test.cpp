@@ -0,0 +1,187 @@
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "test_meshes.hpp"
+#include "mesh_codec.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	uint32 nextRandom(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return p_state;
+	}
+
+	// Vertices that change a little from one to the next with some noise on top, so every group width and escapes
+	// show up. Counts that are not whole groups or blocks run the padded last block too
+	std::vector<uint8> makeVertices(const uint64 p_count, const uint64 p_vertex_size, uint32 p_seed)
+	{
+		std::vector<uint8> vertices(p_count * p_vertex_size);
+		for (uint64 i = 0u; i < vertices.size(); i++)
+		{
+			const uint64 vertex = i / p_vertex_size;
+			const uint64 byte   = i % p_vertex_size;
+			const uint32 noise  = nextRandom(p_seed);
+			vertices[i]         = static_cast<uint8>(vertex * (byte % 3u) + ((noise & 31u) == 0u ? noise >> 24u : noise & 1u));
+		}
+		return vertices;
+	}
+
+	bool sameTriangles(const std::span<const uint32> p_expected, const std::span<const uint32> p_decoded)
+	{
+		// The index codec may rotate a triangle, never change its winding
+		for (uint64 i = 0u; i < p_expected.size(); i += 3u)
+		{
+			const uint32 *a = &p_expected[i];
+			const uint32 *b = &p_decoded[i];
+			if (!(a[0] == b[0] && a[1] == b[1] && a[2] == b[2]) && !(a[0] == b[1] && a[1] == b[2] && a[2] == b[0]) &&
+				!(a[0] == b[2] && a[1] == b[0] && a[2] == b[1]))
+				return false;
+		}
+		return true;
+	}
+}
+
+TST_TEST(vertexCodecRoundTrip)
+{
+	for (const uint64 vertex_size: {4u, 12u, 32u, 48u, 60u, 256u})
+	{
+		for (const uint64 count: {0u, 1u, 15u, 16u, 17u, 1'000u, 10'007u})
+		{
+			const std::vector<uint8> vertices = makeVertices(count, vertex_size, static_cast<uint32>(vertex_size * 31u + count + 1u));
+
+			std::vector<uint8> encoded{0xFFu};
+			const uint64       size = geometry::encodeVertexBuffer(vertices.data(), count, vertex_size, encoded);
+			TST_CHECK(size == encoded.size() - 1u);
+
+			// Appends after what is already there, and decodes from exactly those bytes
+			std::vector<uint8> decoded(vertices.size() + 1u, 0xCDu);
+			TST_CHECK(geometry::decodeVertexBuffer(decoded.data(), count, vertex_size, std::span<const uint8>(encoded).subspan(1u)));
+			TST_CHECK(std::memcmp(decoded.data(), vertices.data(), vertices.size()) == 0);
+			TST_CHECK(decoded.back() == 0xCDu);
+		}
+	}
+}
+
+TST_TEST(indexCodecRoundTrip)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(64u, 128u);
+
+	std::vector<uint8> encoded;
+	geometry::encodeIndexBuffer(mesh.indices, encoded);
+	// A regular grid reuses nearly every edge, it has to come out well below the raw indices
+	TST_CHECK(encoded.size() < mesh.indices.size() * sizeof(uint32) / 4u);
+
+	std::vector<uint32> decoded(mesh.indices.size());
+	TST_CHECK(geometry::decodeIndexBuffer(decoded.data(), decoded.size(), encoded));
+	TST_CHECK(sameTriangles(mesh.indices, decoded));
+
+	// Any order and far apart indices work too, they only compress worse
+	uint32              state = 77u;
+	std::vector<uint32> shuffled(3'000u);
+	for (uint32 &index: shuffled)
+	{
+		index = (nextRandom(state) & 1u) != 0u ? nextRandom(state) : nextRandom(state) & 63u;
+	}
+	encoded.clear();
+	geometry::encodeIndexBuffer(shuffled, encoded);
+	decoded.assign(shuffled.size(), 0u);
+	TST_CHECK(geometry::decodeIndexBuffer(decoded.data(), decoded.size(), encoded));
+	TST_CHECK(sameTriangles(shuffled, decoded));
+
+	encoded.clear();
+	geometry::encodeIndexSequence(shuffled, encoded);
+	TST_CHECK(geometry::decodeIndexSequence(decoded.data(), decoded.size(), encoded));
+	TST_CHECK(decoded == shuffled);
+}
+
+// Every decoder reads exactly the bytes its encoder wrote: a shorter or longer buffer, or a wrong header, fails
+TST_TEST(codecRejectsTruncatedInput)
+{
+	constexpr uint64         c_vertexSize{32u};
+	const std::vector<uint8> vertices = makeVertices(300u, c_vertexSize, 5u);
+	const test::TestMesh     mesh     = test::makeBumpySphere(8u, 16u);
+
+	std::vector<uint8> encoded_vertices, encoded_triangles, encoded_sequence;
+	geometry::encodeVertexBuffer(vertices.data(), 300u, c_vertexSize, encoded_vertices);
+	geometry::encodeIndexBuffer(mesh.indices, encoded_triangles);
+	geometry::encodeIndexSequence(mesh.indices, encoded_sequence);
+
+	std::vector<uint8>  decoded_vertices(vertices.size());
+	std::vector<uint32> decoded_indices(mesh.indices.size());
+	const auto          decodeVertices = [&](const std::span<const uint8> p_encoded)
+	{
+		return geometry::decodeVertexBuffer(decoded_vertices.data(), 300u, c_vertexSize, p_encoded);
+	};
+	const auto decodeTriangles = [&](const std::span<const uint8> p_encoded)
+	{
+		return geometry::decodeIndexBuffer(decoded_indices.data(), decoded_indices.size(), p_encoded);
+	};
+	const auto decodeSequence = [&](const std::span<const uint8> p_encoded)
+	{
+		return geometry::decodeIndexSequence(decoded_indices.data(), decoded_indices.size(), p_encoded);
+	};
+
+	const auto checkTruncations = [](std::vector<uint8> p_encoded, const auto &p_decode)
+	{
+		TST_CHECK(p_decode(p_encoded));
+		for (uint64 size = 0u; size < p_encoded.size(); size++)
+		{
+			TST_CHECK(!p_decode(std::span<const uint8>(p_encoded).first(size)));
+		}
+
+		p_encoded.push_back(0u);
+		TST_CHECK(!p_decode(p_encoded));
+		p_encoded.pop_back();
+
+		p_encoded[0] ^= 0x01u;
+		TST_CHECK(!p_decode(p_encoded));
+	};
+	checkTruncations(encoded_vertices, decodeVertices);
+	checkTruncations(encoded_triangles, decodeTriangles);
+	checkTruncations(encoded_sequence, decodeSequence);
+
+	// Each codec's bytes are no other codec's
+	TST_CHECK(!decodeTriangles(encoded_vertices) && !decodeSequence(encoded_vertices));
+	TST_CHECK(!decodeVertices(encoded_triangles) && !decodeSequence(encoded_triangles));
+	TST_CHECK(!decodeVertices(encoded_sequence) && !decodeTriangles(encoded_sequence));
+}
+
+// Corrupted bytes past the header may still decode, into garbage, but never read or write out of range. Run under
+// AddressSanitizer to see that, here it only has to finish
+TST_TEST(codecSurvivesCorruptedInput)
+{
+	constexpr uint64         c_vertexSize{48u};
+	const std::vector<uint8> vertices = makeVertices(700u, c_vertexSize, 9u);
+	const test::TestMesh     mesh     = test::makeBumpySphere(16u, 32u);
+
+	std::vector<uint8> encoded_vertices, encoded_triangles, encoded_sequence;
+	geometry::encodeVertexBuffer(vertices.data(), 700u, c_vertexSize, encoded_vertices);
+	geometry::encodeIndexBuffer(mesh.indices, encoded_triangles);
+	geometry::encodeIndexSequence(mesh.indices, encoded_sequence);
+
+	std::vector<uint8>  decoded_vertices(vertices.size());
+	std::vector<uint32> decoded_indices(mesh.indices.size());
+
+	uint32 state = 2024u;
+	for (uint32 round = 0u; round < 2'000u; round++)
+	{
+		std::vector<uint8> corrupted = encoded_vertices;
+		corrupted[1u + nextRandom(state) % (corrupted.size() - 1u)] ^= static_cast<uint8>(1u + nextRandom(state) % 255u);
+		(void)geometry::decodeVertexBuffer(decoded_vertices.data(), 700u, c_vertexSize, corrupted);
+
+		corrupted = encoded_triangles;
+		corrupted[1u + nextRandom(state) % (corrupted.size() - 1u)] ^= static_cast<uint8>(1u + nextRandom(state) % 255u);
+		(void)geometry::decodeIndexBuffer(decoded_indices.data(), decoded_indices.size(), corrupted);
+
+		corrupted = encoded_sequence;
+		corrupted[1u + nextRandom(state) % (corrupted.size() - 1u)] ^= static_cast<uint8>(1u + nextRandom(state) % 255u);
+		(void)geometry::decodeIndexSequence(decoded_indices.data(), decoded_indices.size(), corrupted);
+	}
+}
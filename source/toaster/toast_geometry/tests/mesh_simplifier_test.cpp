@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "test_meshes.hpp"
+#include "mesh_simplifier.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	float simplify(const test::TestMesh &p_mesh, const uint32 p_target_index_count, const float p_max_error, std::vector<uint32> &p_out_indices)
+	{
+		return geometry::simplifyMesh(p_mesh.indices, p_mesh.positions.data(), sizeof(glm::vec3), static_cast<uint32>(p_mesh.positions.size()),
+									  p_target_index_count, p_max_error, p_out_indices);
+	}
+
+	// Ericson, Real-Time Collision Detection 5.1.5
+	glm::vec3 closestPointOnTriangle(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+	{
+		const glm::vec3 ab = b - a;
+		const glm::vec3 ac = c - a;
+		const glm::vec3 ap = p - a;
+		const float     d1 = glm::dot(ab, ap);
+		const float     d2 = glm::dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return a;
+
+		const glm::vec3 bp = p - b;
+		const float     d3 = glm::dot(ab, bp);
+		const float     d4 = glm::dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+			return b;
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return a + ab * (d1 / (d1 - d3));
+
+		const glm::vec3 cp = p - c;
+		const float     d5 = glm::dot(ab, cp);
+		const float     d6 = glm::dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+			return c;
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return a + ac * (d2 / (d2 - d6));
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const float denominator = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+
+	// Largest distance from an original vertex to the simplified surface. The simplified vertices are original ones,
+	// so this is the one sided distance that can grow
+	float measureDeviation(const test::TestMesh &p_mesh, const std::vector<uint32> &p_indices)
+	{
+		float deviation = 0.0f;
+		for (const glm::vec3 &position: p_mesh.positions)
+		{
+			float closest = FLT_MAX;
+			for (uint64 i = 0u; i < p_indices.size(); i += 3u)
+			{
+				const glm::vec3 point = closestPointOnTriangle(position, p_mesh.positions[p_indices[i]], p_mesh.positions[p_indices[i + 1u]],
+															   p_mesh.positions[p_indices[i + 2u]]);
+				closest = std::min(closest, glm::length(point - position));
+			}
+			deviation = std::max(deviation, closest);
+		}
+		return deviation;
+	}
+
+	float measureArea(const test::TestMesh &p_mesh, const std::vector<uint32> &p_indices)
+	{
+		double area = 0.0;
+		for (uint64 i = 0u; i < p_indices.size(); i += 3u)
+		{
+			const glm::vec3 &p0 = p_mesh.positions[p_indices[i]];
+			area += 0.5 * glm::length(glm::cross(p_mesh.positions[p_indices[i + 1u]] - p0, p_mesh.positions[p_indices[i + 2u]] - p0));
+		}
+		return static_cast<float>(area);
+	}
+
+	// Edges by position, each one without an opposite edge in the other direction is an open edge
+	std::vector<std::array<glm::vec3, 2>> findOpenEdges(const test::TestMesh &p_mesh, const std::vector<uint32> &p_indices)
+	{
+		const auto key = [&p_mesh](const uint32 p_vertex)
+		{
+			const glm::vec3 &position = p_mesh.positions[p_vertex];
+			return std::array<float, 3>{position.x, position.y, position.z};
+		};
+
+		std::map<std::array<std::array<float, 3>, 2>, int32> edges;
+		for (uint64 i = 0u; i < p_indices.size(); i++)
+		{
+			const uint32 from = p_indices[i];
+			const uint32 to   = p_indices[i - i % 3u + (i + 1u) % 3u];
+			edges[{key(from), key(to)}]++;
+			edges[{key(to), key(from)}]--;
+		}
+
+		std::vector<std::array<glm::vec3, 2>> open;
+		for (const auto &[edge, balance]: edges)
+		{
+			if (balance > 0)
+				open.push_back({glm::vec3(edge[0][0], edge[0][1], edge[0][2]), glm::vec3(edge[1][0], edge[1][1], edge[1][2])});
+		}
+		return open;
+	}
+
+	// A flat p_size x p_size grid in the xy plane over [0, 1]. With p_seam the cells right of the middle column use
+	// their own copies of its vertices, the way a UV seam splits them
+	test::TestMesh makeGrid(const uint32 p_size, const bool p_seam)
+	{
+		test::TestMesh mesh;
+		for (uint32 y = 0u; y <= p_size; y++)
+		{
+			for (uint32 x = 0u; x <= p_size; x++)
+			{
+				mesh.positions.emplace_back(static_cast<float>(x) / static_cast<float>(p_size), static_cast<float>(y) / static_cast<float>(p_size), 0.0f);
+			}
+		}
+
+		const uint32 middle      = p_size / 2u;
+		const uint32 seam_offset = static_cast<uint32>(mesh.positions.size());
+		if (p_seam)
+		{
+			for (uint32 y = 0u; y <= p_size; y++)
+			{
+				mesh.positions.push_back(mesh.positions[y * (p_size + 1u) + middle]);
+			}
+		}
+
+		const auto vertex = [&](const uint32 p_x, const uint32 p_y, const uint32 p_cell_x)
+		{
+			return p_seam && p_x == middle && p_cell_x >= middle ? seam_offset + p_y : p_y * (p_size + 1u) + p_x;
+		};
+		for (uint32 y = 0u; y < p_size; y++)
+		{
+			for (uint32 x = 0u; x < p_size; x++)
+			{
+				const uint32 a = vertex(x, y, x);
+				const uint32 b = vertex(x + 1u, y, x);
+				const uint32 c = vertex(x, y + 1u, x);
+				const uint32 d = vertex(x + 1u, y + 1u, x);
+				mesh.indices.insert(mesh.indices.end(), {a, b, c, c, b, d});
+			}
+		}
+		return mesh;
+	}
+}
+
+// The error returned stays within the limit and grows with the reduction. It is the root mean square distance to the
+// planes merged into a vertex, so the largest distance from an original vertex to the simplified surface can be a
+// little above it, but not by more than a small factor
+TST_TEST(simplifyMeshStaysWithinMaxError)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(16u, 32u);
+
+	uint64 previous_count = mesh.indices.size();
+	float  previous_error = 0.0f;
+	for (const float max_error: {0.005f, 0.01f, 0.05f})
+	{
+		std::vector<uint32> indices;
+		const float         error     = simplify(mesh, 0u, max_error, indices);
+		const float         deviation = measureDeviation(mesh, indices);
+		std::printf("  max error %.3f: %zu -> %zu indices, error %.4f, deviation %.4f\n", max_error, mesh.indices.size(), indices.size(), error, deviation);
+
+		TST_CHECK(error <= max_error && error >= previous_error);
+		TST_CHECK(indices.size() < previous_count && indices.size() % 3u == 0u);
+		TST_CHECK(deviation <= 3.0f * max_error);
+		previous_count = indices.size();
+		previous_error = error;
+	}
+
+	// Without an error limit it stops at the target, and the same input gives the same output
+	const uint32        target = static_cast<uint32>(mesh.indices.size() / 4u);
+	std::vector<uint32> quarter;
+	const float         error = simplify(mesh, target, FLT_MAX, quarter);
+	TST_CHECK(quarter.size() <= target && quarter.size() > target - 12u && error > 0.0f);
+
+	std::vector<uint32> again;
+	TST_CHECK(simplify(mesh, target, FLT_MAX, again) == error && again == quarter);
+
+	// Nothing to do when already at the target or without any error allowed on a curved surface
+	std::vector<uint32> unchanged;
+	TST_CHECK(simplify(mesh, static_cast<uint32>(mesh.indices.size()), FLT_MAX, unchanged) == 0.0f && unchanged == mesh.indices);
+	TST_CHECK(simplify(mesh, 0u, 0.0f, unchanged) == 0.0f && unchanged == mesh.indices);
+}
+
+// A flat grid collapses at no error down to what its locked border allows, keeping the exact outline and area
+TST_TEST(simplifyMeshKeepsBordersAndSeams)
+{
+	for (const bool seam: {false, true})
+	{
+		const test::TestMesh mesh = makeGrid(16u, seam);
+
+		std::vector<uint32> indices;
+		const float         error = simplify(mesh, 0u, 1e-4f, indices);
+		std::printf("  %s: %zu -> %zu indices, error %g\n", seam ? "seam" : "no seam", mesh.indices.size(), indices.size(), error);
+
+		TST_CHECK(error <= 1e-4f);
+		TST_CHECK(indices.size() < mesh.indices.size() / 4u);
+		TST_CHECK(std::abs(measureArea(mesh, indices) - 1.0f) < 1e-4f);
+
+		// Only the outline stays open, so no crack opened along the seam, and every border vertex is still there
+		const std::vector<std::array<glm::vec3, 2>> open = findOpenEdges(mesh, indices);
+		TST_CHECK(open.size() == 16u * 4u);
+		for (const std::array<glm::vec3, 2> &edge: open)
+		{
+			const glm::vec3 direction = edge[1] - edge[0];
+			TST_CHECK(std::abs(glm::length(direction) - 1.0f / 16.0f) < 1e-6f);
+			TST_CHECK((direction.x == 0.0f && (edge[0].x == 0.0f || edge[0].x == 1.0f)) || (direction.y == 0.0f && (edge[0].y == 0.0f || edge[0].y == 1.0f)));
+		}
+
+		// Triangles keep to their side of the seam: the right side's copies never end up in a triangle reaching left
+		// of it, the left side's originals never in one reaching right
+		if (seam)
+		{
+			for (uint64 i = 0u; i < indices.size(); i += 3u)
+			{
+				bool  uses_copy     = false;
+				bool  uses_original = false;
+				float min_x         = 1.0f;
+				float max_x         = 0.0f;
+				for (uint32 corner = 0u; corner < 3u; corner++)
+				{
+					const uint32 index = indices[i + corner];
+					uses_copy |= index >= 17u * 17u;
+					uses_original |= index < 17u * 17u && mesh.positions[index].x == 0.5f;
+					min_x = std::min(min_x, mesh.positions[index].x);
+					max_x = std::max(max_x, mesh.positions[index].x);
+				}
+				TST_CHECK(!uses_copy || min_x >= 0.5f);
+				TST_CHECK(!uses_original || max_x <= 0.5f);
+			}
+		}
+	}
+}
+
+// Every level has fewer triangles and at least the error of the one before, all of them within the relative limit
+TST_TEST(buildLodChainReducesEveryLevel)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(32u, 64u);
+
+	geometry::LodSettings settings;
+	settings.levelCount = 4u;
+	settings.maxError   = 0.05f;
+
+	std::vector<geometry::LodLevel> levels;
+	geometry::buildLodChain(mesh.indices, mesh.positions.data(), sizeof(glm::vec3), static_cast<uint32>(mesh.positions.size()), settings, levels);
+	TST_CHECK(!levels.empty() && levels.size() <= settings.levelCount);
+
+	// Diagonal of the box around the sphere, its bumps stay within radius 1.05
+	const float max_error = settings.maxError * std::sqrt(3.0f) * 2.1f;
+
+	uint64 previous_count = mesh.indices.size();
+	float  previous_error = 0.0f;
+	for (const geometry::LodLevel &level: levels)
+	{
+		std::printf("  %zu indices, error %.4f\n", level.indices.size(), level.error);
+		TST_CHECK(level.indices.size() <= previous_count * 3u / 4u && level.error >= previous_error && level.error <= max_error);
+		previous_count = level.indices.size();
+		previous_error = level.error;
+	}
+
+	// The first level reaches the reduction, nothing else is allowed to stop it
+	TST_CHECK(levels[0].indices.size() <= static_cast<uint64>(mesh.indices.size() * settings.reduction));
+
+	// Triangle soups have every vertex locked, no level is worth keeping
+	test::TestMesh soup;
+	for (const uint32 index: test::makeBumpySphere(4u, 8u).indices)
+	{
+		soup.indices.push_back(static_cast<uint32>(soup.positions.size()));
+		soup.positions.push_back(mesh.positions[index]);
+	}
+	geometry::buildLodChain(soup.indices, soup.positions.data(), sizeof(glm::vec3), static_cast<uint32>(soup.positions.size()), settings, levels);
+	TST_CHECK(levels.empty());
+}
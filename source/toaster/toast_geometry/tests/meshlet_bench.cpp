@@ -0,0 +1,69 @@
+#include <cstdio>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_bench.hpp"
+#include "test_meshes.hpp"
+#include "meshlet.hpp"
+
+using namespace toaster;
+
+// Meshlet build of a 1M triangle mesh
+TST_BENCHMARK(meshletBuild)
+{
+	const test::TestMesh mesh  = test::makeBumpySphere(512u, 1024u);
+	const double         items = static_cast<double>(mesh.indices.size() / 3u);
+
+	geometry::MeshletData meshlets;
+	test::report("build", test::measureNs([&]
+	{
+		meshlets.clear();
+		geometry::buildMeshlets(mesh.indices, mesh.positions.data(), sizeof(glm::vec3), static_cast<uint32>(mesh.positions.size()), meshlets);
+	}, 3), items);
+
+	std::printf("  %llu meshlets, %.1f triangles and %.1f vertices each\n", static_cast<unsigned long long>(meshlets.meshlets.size()),
+				items / static_cast<double>(meshlets.meshlets.size()),
+				static_cast<double>(meshlets.vertices.size()) / static_cast<double>(meshlets.meshlets.size()));
+}
+
+// Frustum and cone culling of the meshlets of a 1M triangle sphere, seen whole from a distance, where only the cones
+// cull, and from close up, where the frustum takes most of them
+TST_BENCHMARK(meshletCulling)
+{
+	const test::TestMesh mesh = test::makeBumpySphere(512u, 1024u);
+
+	geometry::MeshletData meshlets;
+	geometry::buildMeshlets(mesh.indices, mesh.positions.data(), sizeof(glm::vec3), static_cast<uint32>(mesh.positions.size()), meshlets);
+
+	struct View
+	{
+		const char *name;
+		glm::vec3   eye;
+		glm::vec3   target;
+	};
+	constexpr View c_views[] = {
+		{"whole sphere", glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f)},
+		{"close up", glm::vec3(0.0f, 0.0f, 1.3f), glm::vec3(0.2f, 0.1f, 1.0f)},
+	};
+
+	const glm::mat4     projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.01f, 100.0f);
+	const double        items      = static_cast<double>(meshlets.meshlets.size());
+	std::vector<uint32> visible;
+	for (const View &view: c_views)
+	{
+		const tsm::Frustum frustum = tsm::Frustum::fromMatrix(projection * glm::lookAt(view.eye, view.target, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+		geometry::MeshletCullStats stats;
+		const double               ns = test::measureNs([&]
+		{
+			stats = {};
+			geometry::cullMeshlets(frustum, view.eye, meshlets.bounds, visible, &stats);
+			test::doNotOptimize(visible.data());
+		}, 20);
+		test::report(view.name, ns, items);
+
+		std::printf("  %.1f%% visible, %.1f%% outside the frustum, %.1f%% backfacing\n", 100.0 * static_cast<double>(visible.size()) / items,
+					100.0 * stats.frustumCulled / items, 100.0 * stats.backfaceCulled / items);
+	}
+}
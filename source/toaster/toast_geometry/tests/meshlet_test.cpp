@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_test.hpp"
+#include "test_meshes.hpp"
+#include "meshlet.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	uint32 nextRandom(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return p_state;
+	}
+
+	float randomFloat(uint32 &p_state, const float p_min, const float p_max)
+	{
+		return p_min + (p_max - p_min) * static_cast<float>(nextRandom(p_state) >> 8u) / static_cast<float>(1u << 24u);
+	}
+
+	geometry::MeshletData buildMeshlets(const test::TestMesh &p_mesh)
+	{
+		geometry::MeshletData meshlets;
+		geometry::buildMeshlets(p_mesh.indices, p_mesh.positions.data(), sizeof(glm::vec3), static_cast<uint32>(p_mesh.positions.size()), meshlets);
+		return meshlets;
+	}
+
+	std::array<uint32, 3> getTriangle(const geometry::MeshletData &p_data, const geometry::Meshlet &p_meshlet, const uint32 p_triangle)
+	{
+		const uint8 *corners = &p_data.triangles[p_meshlet.triangleOffset + p_triangle * 3u];
+		return {p_data.vertices[p_meshlet.vertexOffset + corners[0]], p_data.vertices[p_meshlet.vertexOffset + corners[1]],
+				p_data.vertices[p_meshlet.vertexOffset + corners[2]]};
+	}
+
+	// Every triangle exactly once and within the limits, micro-indices in range, offsets packed back to back
+	bool checkMeshlets(const geometry::MeshletData &p_data, const std::vector<uint32> &p_indices)
+	{
+		if (p_data.bounds.size() != p_data.meshlets.size())
+			return false;
+
+		std::vector<std::array<uint32, 3>> expected, built;
+		for (uint64 i = 0u; i < p_indices.size(); i += 3u)
+		{
+			expected.push_back({p_indices[i], p_indices[i + 1u], p_indices[i + 2u]});
+		}
+
+		uint32 vertex_offset   = 0u;
+		uint32 triangle_offset = 0u;
+		for (const geometry::Meshlet &meshlet: p_data.meshlets)
+		{
+			if (meshlet.vertexOffset != vertex_offset || meshlet.triangleOffset != triangle_offset || meshlet.vertexCount == 0u ||
+				meshlet.vertexCount > geometry::c_meshletMaxVertices || meshlet.triangleCount == 0u || meshlet.triangleCount > geometry::c_meshletMaxTriangles)
+				return false;
+
+			for (uint32 i = 0u; i < meshlet.triangleCount * 3u; i++)
+			{
+				if (p_data.triangles[meshlet.triangleOffset + i] >= meshlet.vertexCount)
+					return false;
+			}
+			for (uint32 triangle = 0u; triangle < meshlet.triangleCount; triangle++)
+			{
+				built.push_back(getTriangle(p_data, meshlet, triangle));
+			}
+			vertex_offset += meshlet.vertexCount;
+			triangle_offset += meshlet.triangleCount * 3u;
+		}
+
+		std::sort(expected.begin(), expected.end());
+		std::sort(built.begin(), built.end());
+		return vertex_offset == p_data.vertices.size() && triangle_offset == p_data.triangles.size() && built == expected;
+	}
+}
+
+TST_TEST(buildMeshletsCoversEveryTriangle)
+{
+	const test::TestMesh        mesh     = test::makeBumpySphere(64u, 128u);
+	const geometry::MeshletData meshlets = buildMeshlets(mesh);
+	TST_CHECK(checkMeshlets(meshlets, mesh.indices));
+
+	// A grid shares most vertices, so meshlets hold well over one triangle per vertex
+	const float triangles_per_meshlet = static_cast<float>(mesh.indices.size() / 3u) / static_cast<float>(meshlets.meshlets.size());
+	const float vertices_per_meshlet  = static_cast<float>(meshlets.vertices.size()) / static_cast<float>(meshlets.meshlets.size());
+	std::printf("  %.1f triangles and %.1f vertices per meshlet\n", triangles_per_meshlet, vertices_per_meshlet);
+	TST_CHECK(triangles_per_meshlet > 64.0f && vertices_per_meshlet > 48.0f);
+
+	// The same surface unwelded, every triangle with its own three vertices and in random order, still makes meshlets
+	// of nearly as many triangles as the vertex limit allows
+	const test::TestMesh welded = test::makeBumpySphere(16u, 32u);
+	test::TestMesh       soup;
+	uint32               state = 11u;
+	std::vector<uint32>  triangle_order(welded.indices.size() / 3u);
+	for (uint32 i = 0u; i < triangle_order.size(); i++)
+	{
+		triangle_order[i] = i;
+	}
+	for (uint32 i = static_cast<uint32>(triangle_order.size()); i > 1u; i--)
+	{
+		std::swap(triangle_order[i - 1u], triangle_order[nextRandom(state) % i]);
+	}
+	for (const uint32 triangle: triangle_order)
+	{
+		for (uint32 corner = 0u; corner < 3u; corner++)
+		{
+			soup.indices.push_back(static_cast<uint32>(soup.positions.size()));
+			soup.positions.push_back(welded.positions[welded.indices[triangle * 3u + corner]]);
+		}
+	}
+	const geometry::MeshletData soup_meshlets = buildMeshlets(soup);
+	TST_CHECK(checkMeshlets(soup_meshlets, soup.indices));
+
+	constexpr uint32 c_soupTrianglesPerMeshlet{geometry::c_meshletMaxVertices / 3u};
+	const uint64     min_soup_meshlets = (triangle_order.size() + c_soupTrianglesPerMeshlet - 1u) / c_soupTrianglesPerMeshlet;
+	std::printf("  unwelded: %zu meshlets, at least %llu\n", soup_meshlets.meshlets.size(), static_cast<unsigned long long>(min_soup_meshlets));
+	TST_CHECK(soup_meshlets.meshlets.size() <= min_soup_meshlets * 5u / 4u);
+
+	// Appended data is rebased and still describes the same triangles
+	geometry::MeshletData combined = meshlets;
+	combined.append(soup_meshlets);
+	TST_CHECK(combined.meshlets.size() == meshlets.meshlets.size() + soup_meshlets.meshlets.size());
+	const geometry::Meshlet &first_appended = combined.meshlets[meshlets.meshlets.size()];
+	TST_CHECK(getTriangle(combined, first_appended, 0u) == getTriangle(soup_meshlets, soup_meshlets.meshlets[0], 0u));
+
+	geometry::MeshletData empty;
+	geometry::buildMeshlets({}, mesh.positions.data(), sizeof(glm::vec3), 0u, empty);
+	TST_CHECK(empty.meshlets.empty() && empty.vertices.empty());
+}
+
+// Every vertex is inside the bounding sphere, and a meshlet the cone test calls backfacing has every triangle facing
+// away from that eye
+TST_TEST(meshletBoundsAreConservative)
+{
+	const test::TestMesh        mesh     = test::makeBumpySphere(32u, 64u);
+	const geometry::MeshletData meshlets = buildMeshlets(mesh);
+
+	for (uint64 i = 0u; i < meshlets.meshlets.size(); i++)
+	{
+		const geometry::Meshlet &      meshlet = meshlets.meshlets[i];
+		const geometry::MeshletBounds &bounds  = meshlets.bounds[i];
+		for (uint32 vertex = 0u; vertex < meshlet.vertexCount; vertex++)
+		{
+			TST_CHECK(glm::length(mesh.positions[meshlets.vertices[meshlet.vertexOffset + vertex]] - bounds.center) <= bounds.radius * 1.0001f);
+		}
+		TST_CHECK(bounds.coneCutoff >= 0.0f && bounds.coneCutoff <= 1.0f);
+	}
+
+	const tsm::Frustum everything = tsm::Frustum::fromMatrix(glm::ortho(-100.0f, 100.0f, -100.0f, 100.0f, -100.0f, 100.0f));
+	std::vector<uint32> visible;
+	uint32              state          = 5u;
+	uint32              backface_culls = 0u;
+	uint32              wrong_culls    = 0u;
+	for (uint32 view = 0u; view < 200u; view++)
+	{
+		// Eyes around the sphere at different distances, a few of them inside it
+		const glm::vec3 eye(randomFloat(state, -4.0f, 4.0f), randomFloat(state, -4.0f, 4.0f), randomFloat(state, -4.0f, 4.0f));
+
+		geometry::MeshletCullStats stats;
+		geometry::cullMeshlets(everything, eye, meshlets.bounds, visible, &stats);
+		TST_CHECK(stats.frustumCulled == 0u && visible.size() + stats.backfaceCulled == meshlets.meshlets.size());
+		backface_culls += stats.backfaceCulled;
+
+		uint32 next_visible = 0u;
+		for (uint32 i = 0u; i < meshlets.meshlets.size(); i++)
+		{
+			if (next_visible < visible.size() && visible[next_visible] == i)
+			{
+				next_visible++;
+				continue;
+			}
+
+			const geometry::Meshlet &meshlet = meshlets.meshlets[i];
+			for (uint32 triangle = 0u; triangle < meshlet.triangleCount; triangle++)
+			{
+				const std::array<uint32, 3> corners = getTriangle(meshlets, meshlet, triangle);
+				const glm::vec3 &           p0      = mesh.positions[corners[0]];
+				const glm::vec3             normal  = glm::cross(mesh.positions[corners[1]] - p0, mesh.positions[corners[2]] - p0);
+				if (glm::dot(normal, p0 - eye) < 0.0f)
+					wrong_culls++;
+			}
+		}
+	}
+	std::printf("  %.1f%% of the meshlets backface culled on average\n", 100.0 * backface_culls / (200.0 * static_cast<double>(meshlets.meshlets.size())));
+	TST_CHECK(wrong_culls == 0u);
+	TST_CHECK(backface_culls > 0u);
+}
+
+// Meshlets in view are kept, the frustum test only drops the ones whose sphere is entirely outside
+TST_TEST(cullMeshletsKeepsWhatIsInView)
+{
+	const test::TestMesh        mesh     = test::makeBumpySphere(32u, 64u);
+	const geometry::MeshletData meshlets = buildMeshlets(mesh);
+
+	const glm::vec3    eye(0.0f, 0.0f, 1.3f);
+	const glm::mat4    view_projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.01f, 100.0f) *
+									  glm::lookAt(eye, glm::vec3(0.2f, 0.1f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const tsm::Frustum frustum = tsm::Frustum::fromMatrix(view_projection);
+
+	std::vector<uint32>        visible;
+	geometry::MeshletCullStats stats;
+	const uint32               visible_count = geometry::cullMeshlets(frustum, eye, meshlets.bounds, visible, &stats);
+	TST_CHECK(visible_count == visible.size() && std::is_sorted(visible.begin(), visible.end()));
+	TST_CHECK(visible.size() + stats.frustumCulled + stats.backfaceCulled == meshlets.meshlets.size());
+	TST_CHECK(stats.frustumCulled > 0u && !visible.empty());
+
+	// A meshlet with a front facing triangle that has a corner on screen has to be visible
+	for (uint32 i = 0u; i < meshlets.meshlets.size(); i++)
+	{
+		const geometry::Meshlet &meshlet = meshlets.meshlets[i];
+		bool                     on_screen = false;
+		for (uint32 triangle = 0u; triangle < meshlet.triangleCount && !on_screen; triangle++)
+		{
+			const std::array<uint32, 3> corners = getTriangle(meshlets, meshlet, triangle);
+			const glm::vec3 &           p0      = mesh.positions[corners[0]];
+			const glm::vec3             normal  = glm::cross(mesh.positions[corners[1]] - p0, mesh.positions[corners[2]] - p0);
+			if (glm::dot(normal, p0 - eye) >= 0.0f)
+				continue;
+
+			for (const uint32 corner: corners)
+			{
+				const glm::vec4 clip = view_projection * glm::vec4(mesh.positions[corner], 1.0f);
+				on_screen |= clip.w > 0.0f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && clip.z >= -clip.w && clip.z <= clip.w;
+			}
+		}
+		if (on_screen)
+			TST_CHECK(std::binary_search(visible.begin(), visible.end(), i));
+	}
+
+	// The stats are optional
+	std::vector<uint32> again;
+	TST_CHECK(geometry::cullMeshlets(frustum, eye, meshlets.bounds, again) == visible_count && again == visible);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+#include "bvh.hpp"
+
+// Procedural meshes for the geometry tests and benchmarks
+namespace toaster::test
+{
+	struct TestMesh
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<uint32>    indices;
+
+		[[nodiscard]] geometry::TriangleMeshView getView() const
+		{
+			return {positions.data(), sizeof(glm::vec3), static_cast<uint32>(positions.size()), indices};
+		}
+	};
+
+	// Unit sphere with a bumpy surface, p_rings * p_segments * 2 triangles. The bumps give the BVH overlapping
+	// boxes of different sizes instead of a perfectly regular grid
+	inline TestMesh makeBumpySphere(const uint32 p_rings, const uint32 p_segments)
+	{
+		constexpr float c_pi{3.14159265358979f};
+
+		TestMesh mesh;
+		mesh.positions.reserve(static_cast<uint64>(p_rings + 1u) * (p_segments + 1u));
+		for (uint32 ring = 0u; ring <= p_rings; ring++)
+		{
+			const float theta = c_pi * static_cast<float>(ring) / static_cast<float>(p_rings);
+			for (uint32 segment = 0u; segment <= p_segments; segment++)
+			{
+				const float phi    = 2.0f * c_pi * static_cast<float>(segment) / static_cast<float>(p_segments);
+				const float radius = 1.0f + 0.05f * std::sin(theta * 13.0f) * std::cos(phi * 7.0f);
+				mesh.positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+			}
+		}
+
+		mesh.indices.reserve(static_cast<uint64>(p_rings) * p_segments * 6u);
+		for (uint32 ring = 0u; ring < p_rings; ring++)
+		{
+			for (uint32 segment = 0u; segment < p_segments; segment++)
+			{
+				const uint32 a = ring * (p_segments + 1u) + segment;
+				const uint32 b = a + p_segments + 1u;
+				mesh.indices.insert(mesh.indices.end(), {a, b, a + 1u, a + 1u, b, b + 1u});
+			}
+		}
+		return mesh;
+	}
+
+	// Rays from a camera in front of the sphere through a p_width x p_height grid, neighbouring rays are coherent
+	inline std::vector<geometry::Ray> makeCameraRays(const uint32 p_width, const uint32 p_height)
+	{
+		std::vector<geometry::Ray> rays;
+		rays.reserve(static_cast<uint64>(p_width) * p_height);
+		for (uint32 y = 0u; y < p_height; y++)
+		{
+			for (uint32 x = 0u; x < p_width; x++)
+			{
+				const float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(p_width) * 2.0f - 1.0f;
+				const float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(p_height) * 2.0f - 1.0f;
+
+				geometry::Ray ray;
+				ray.origin    = glm::vec3(0.0f, 0.0f, 3.0f);
+				ray.direction = glm::normalize(glm::vec3(u * 0.6f, v * 0.6f, -1.0f));
+				rays.push_back(ray);
+			}
+		}
+		return rays;
+	}
+
+	// Rays between random points around the sphere, every ray takes a different path through the tree
+	inline std::vector<geometry::Ray> makeRandomRays(const uint32 p_count, uint32 p_seed)
+	{
+		const auto next = [&p_seed]
+		{
+			p_seed ^= p_seed << 13u;
+			p_seed ^= p_seed >> 17u;
+			p_seed ^= p_seed << 5u;
+			return static_cast<float>(p_seed >> 8u) / static_cast<float>(1u << 24u) * 2.0f - 1.0f;
+		};
+
+		std::vector<geometry::Ray> rays(p_count);
+		for (geometry::Ray &ray: rays)
+		{
+			ray.origin    = glm::vec3(next(), next(), next()) * 2.0f;
+			ray.direction = glm::vec3(next(), next(), next()) * 2.0f - ray.origin;
+		}
+		return rays;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "system_types.h"
+
+namespace toaster::geometry
+{
+	// Triangles using each vertex of a triangle list, in compressed rows: the triangles of vertex v are
+	// triangles[offsets[v]..offsets[v + 1]), in ascending order
+	struct VertexTriangles
+	{
+		std::vector<uint32> offsets;
+		std::vector<uint32> triangles;
+
+		VertexTriangles(const std::span<const uint32> p_indices, const uint32 p_vertex_count) : offsets(p_vertex_count + 1u, 0u), triangles(p_indices.size())
+		{
+			for (const uint32 index: p_indices)
+			{
+				offsets[index + 1u]++;
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			std::vector<uint32> cursor(offsets.begin(), offsets.end() - 1);
+			for (uint32 i = 0u; i < p_indices.size(); i++)
+			{
+				triangles[cursor[p_indices[i]]++] = i / 3u;
+			}
+		}
+
+		[[nodiscard]] uint32 getCount(const uint32 p_vertex) const { return offsets[p_vertex + 1u] - offsets[p_vertex]; }
+		[[nodiscard]] std::span<const uint32> get(const uint32 p_vertex) const
+		{
+			return {triangles.data() + offsets[p_vertex], getCount(p_vertex)};
+		}
+	};
+}
@@ -1,5 +1,7 @@
 #include "application.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <set>
 #include <glm/gtx/transform.hpp>
 #include <nvrhi/utils.h>
@@ -10,6 +12,10 @@
 
 #include "input.hpp"
 #include "logging.hpp"
+#include "jobs/job_system.hpp"
+#include "memory/memory_tracker.hpp"
+#include "memory/scratch_arena.hpp"
+#include "memory/small_object_allocator.hpp"
 #include "shader_compiler.hpp"
 
 #define SHADER_REFLECTION_TEST 0
@@ -19,19 +25,75 @@ namespace shaders::vulkan
 {
 	#include "test.vert.glsl.spv.inl"
 	#include "test.pixel.glsl.spv.inl"
-	#include "mesh.vert.glsl.spv.inl"
+	#include "mesh_standard.vert.glsl.spv.inl"
 	#include "mesh.pixel.glsl.spv.inl"
 	#include "mandlebrot.pixel.glsl.spv.inl"
 }
 
 namespace toaster
 {
+	namespace
+	{
+		// A warning is logged the first time a subsystem goes over, see memory::setBudget()
+		constexpr std::pair<memory::EMemoryTag, uint64> c_memoryBudgets[]{
+			{memory::EMemoryTag::eMesh, 1024ull << 20u},
+			{memory::EMemoryTag::eShader, 64ull << 20u},
+			{memory::EMemoryTag::eTexture, 1024ull << 20u},
+			{memory::EMemoryTag::eLogging, 4ull << 20u},
+			{memory::EMemoryTag::eArena, 64ull << 20u},
+		};
+
+		// The scene is a grid of objects on a slowly turning platform
+		constexpr uint32 c_sceneGridSize{8u};
+		constexpr float  c_sceneGridSpacing{3.0f};
+		constexpr float  c_sceneTurnSpeed{0.2f}; // Radians per second
+
+		// At most this many submeshes are drawn per frame, each one writes its own version of the mesh constants
+		constexpr uint32 c_maxMeshDrawsPerFrame{4'096u};
+
+		// mesh_standard.vert.glsl's uniform buffer
+		struct MeshConstants
+		{
+			glm::mat4 model;
+			glm::mat4 view;
+			glm::mat4 proj;
+		};
+
+		// mesh.pixel.glsl's push constants, then mesh_vertex.glsl's at offset 48
+		struct MeshPushConstants
+		{
+			float32   time;
+			float32   padding0;
+			glm::vec2 resolution;
+			glm::vec2 mouse;
+			glm::vec2 padding1;
+			glm::vec3 cameraPosition;
+			float32   padding2;
+			glm::vec4 gridOrigin;
+			glm::vec4 gridExtent;
+		};
+		static_assert(offsetof(MeshPushConstants, cameraPosition) == 32u && offsetof(MeshPushConstants, gridOrigin) == 48u &&
+					  sizeof(MeshPushConstants) <= nvrhi::c_MaxPushConstantSize);
+
+		// All objects share one streamed mesh, loaded for whichever of them is nearest to the camera
+		constexpr const char *c_sceneMeshPath{"assets/meshes/orbo.glb"};
+		constexpr float       c_sceneMeshRadius{1.0f};
+	}
+
 	Application::Application()
-		: m_camera(glm::vec3(0.0f, 2.0f, 5.0f))
+		: m_frameArena(gpu::GPUContext::c_maxFramesInFlight), m_camera(glm::vec3(0.0f, 2.0f, 5.0f))
 	{
+		for (const auto &[tag, budget]: c_memoryBudgets)
+		{
+			memory::setBudget(tag, budget);
+		}
+
+		// The constructing thread becomes the job system's main thread, the one GLFW is initialized on
+		jobs::initialize();
+
 		Window::initWindowingAPI();
 
-		m_window = new Window(1280, 720, "Toaster: v0.314");
+		m_window = std::make_unique<Window>(1280, 720, "Toaster: v0.314");
 
 		input::setCurrentWindowContext(m_window->getNativeWindow());
 
@@ -40,12 +102,51 @@ namespace toaster
 
 		m_commandList = nv_device->createCommandList();
 
+		m_meshStreamer = std::make_unique<MeshStreamer>(&m_meshes, gpu_context);
+
 		std::map<nvrhi::ShaderType, gpu::ShaderBlob> shader_bytecode_map{
 			{nvrhi::ShaderType::Vertex, {shaders::vulkan::g_vs_test}},
 			{nvrhi::ShaderType::Pixel, {shaders::vulkan::g_ps_test}}
 		};
 
-		m_testShader = new gpu::Shader(gpu_context, shader_bytecode_map);
+		m_testShader = m_shaders.create(gpu_context, shader_bytecode_map);
+
+		m_meshShader = m_shaders.create(gpu_context, std::map<nvrhi::ShaderType, gpu::ShaderBlob>{
+			{nvrhi::ShaderType::Vertex, {shaders::vulkan::g_vs_mesh_standard}},
+			{nvrhi::ShaderType::Pixel, {shaders::vulkan::g_ps_mesh}}
+		});
+
+		const std::vector<nvrhi::VertexAttributeDesc> mesh_attributes = getVertexAttributeDescs(EVertexFormat::eStandard);
+		m_meshInputLayout = nv_device->createInputLayout(mesh_attributes.data(), static_cast<uint32>(mesh_attributes.size()),
+														 m_shaders[m_meshShader].getHandle(nvrhi::ShaderType::Vertex));
+
+		// The GLSL bindings are the Vulkan ones, no per type offsets
+		nvrhi::BindingLayoutDesc mesh_layout_desc{};
+		mesh_layout_desc.visibility     = nvrhi::ShaderType::AllGraphics;
+		mesh_layout_desc.bindingOffsets = nvrhi::VulkanBindingOffsets().setShaderResourceOffset(0u).setSamplerOffset(0u).setConstantBufferOffset(0u)
+																		.setUnorderedAccessViewOffset(0u);
+		mesh_layout_desc.bindings       = {
+			nvrhi::BindingLayoutItem::VolatileConstantBuffer(0u),
+			nvrhi::BindingLayoutItem::PushConstants(0u, sizeof(MeshPushConstants)),
+		};
+		m_meshBindingLayout = nv_device->createBindingLayout(mesh_layout_desc);
+
+		nvrhi::BufferDesc constants_desc{};
+		constants_desc.byteSize         = sizeof(MeshConstants);
+		constants_desc.debugName        = "Mesh constants";
+		constants_desc.isConstantBuffer = true;
+		constants_desc.isVolatile       = true;
+		constants_desc.maxVersions      = c_maxMeshDrawsPerFrame * (gpu::GPUContext::c_maxFramesInFlight + 1u);
+		m_meshConstants                 = nv_device->createBuffer(constants_desc);
+
+		nvrhi::BindingSetDesc mesh_set_desc{};
+		mesh_set_desc.bindings = {
+			nvrhi::BindingSetItem::ConstantBuffer(0u, m_meshConstants),
+			nvrhi::BindingSetItem::PushConstants(0u, sizeof(MeshPushConstants)),
+		};
+		m_meshBindingSet = nv_device->createBindingSet(mesh_set_desc, m_meshBindingLayout);
+
+		_buildScene();
 
 		#if FILE_STREAM_TEST
 		{
@@ -63,11 +164,35 @@ namespace toaster
 
 	Application::~Application() noexcept
 	{
-		delete m_testShader;
+		// Waits for the loads still running on workers, which needs the job system
+		m_meshStreamer.reset();
 
-		delete m_window;
+		// Queued jobs may still reference anything below
+		jobs::shutdown();
+
+		// Everything that holds GPU objects has to go before the window takes the GPU context down with it. Assigning
+		// empty pools frees their storage too
+		m_meshPipeline      = nullptr;
+		m_meshBindingSet    = nullptr;
+		m_meshConstants     = nullptr;
+		m_meshBindingLayout = nullptr;
+		m_meshInputLayout   = nullptr;
+		m_meshes            = {};
+		m_shaders           = {};
+
+		m_window.reset();
 
 		Window::shutdownWindowingAPI();
+
+		// What is still tracked after this point is a leak
+		m_frameArena.release();
+		memory::getThreadScratchArena().release();
+
+		memory::logMemoryReport();
+		#if TST_TOAST_ALLOCATOR
+		memory::logSmallAllocatorStats();
+		#endif
+		memory::reportLeaks();
 	}
 
 	void Application::run()
@@ -79,10 +204,20 @@ namespace toaster
 		{
 			const auto startTime = static_cast<float32>(glfwGetTime());
 
+			m_frameArena.beginFrame();
+			gpu_context->getStagingRing().beginFrame();
+
 			m_window->processEvents();
+			jobs::runMainThreadJobs();
+
 			m_window->beginFrame();
 
 			_processInput();
+			_updateScene();
+			m_meshStreamer->update(m_camera.getPosition());
+			// The frame's uploads run ahead of its draws
+			gpu_context->getStagingRing().submit();
+			_cullScene();
 			_drawFrame();
 
 			m_window->endFrame();
@@ -94,6 +229,26 @@ namespace toaster
 		gpu_context->getLogicalDevice().waitIdle();
 	}
 
+	void Application::_buildScene()
+	{
+		m_sceneRoot = m_transforms.create();
+
+		const bool hasMesh = io::filesystem::exists(c_sceneMeshPath);
+		if (!hasMesh)
+			LOG_WARN("Scene mesh '{}' not found, the objects have none", c_sceneMeshPath);
+
+		const float offset = static_cast<float>(c_sceneGridSize - 1u) * c_sceneGridSpacing * 0.5f;
+		for (uint32 z = 0u; z < c_sceneGridSize; z++)
+		{
+			for (uint32 x = 0u; x < c_sceneGridSize; x++)
+			{
+				const glm::vec3 position(static_cast<float>(x) * c_sceneGridSpacing - offset, 0.0f, static_cast<float>(z) * c_sceneGridSpacing - offset);
+				m_objectTransforms.push_back(m_transforms.create(m_sceneRoot, position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f)));
+				m_objectMeshes.push_back(hasMesh ? m_meshStreamer->request(c_sceneMeshPath, position, c_sceneMeshRadius) : MeshHandle{});
+			}
+		}
+	}
+
 	void Application::_processInput()
 	{
 		if (m_cursorCaptured)
@@ -128,15 +283,136 @@ namespace toaster
 		}
 	}
 
+	void Application::_updateScene()
+	{
+		const glm::quat turn = glm::angleAxis(c_sceneTurnSpeed * m_deltaTime, glm::vec3(0.0f, 1.0f, 0.0f));
+		m_transforms.setLocalRotation(m_sceneRoot, turn * m_transforms.getLocalRotation(m_sceneRoot));
+
+		m_transforms.update();
+
+		// The platform carries the objects around, the ones still streaming keep their load order up to date
+		for (uint64 i = 0u; i < m_objectTransforms.size(); i++)
+		{
+			const tsm::float4 &origin = m_transforms.getWorldMatrix(m_objectTransforms[i])[3];
+			m_meshStreamer->setPlacement(m_objectMeshes[i], glm::vec3(origin.x(), origin.y(), origin.z()), c_sceneMeshRadius);
+		}
+	}
+
+	void Application::_cullScene()
+	{
+		const float        aspectRatio = m_window->getHeight() > 0u ? static_cast<float>(m_window->getWidth()) / static_cast<float>(m_window->getHeight()) : 1.0f;
+		const tsm::Frustum frustum     = m_camera.getFrustum(aspectRatio);
+
+		// Sized for the worst case, what is left over costs nothing, the arena is reset with the frame's buffer
+		uint32 *visible      = m_frameArena.allocateArray<uint32>(m_objectTransforms.size());
+		uint32  visibleCount = 0u;
+		uint64  drawCount    = 0u;
+		for (uint32 i = 0u; i < m_objectTransforms.size(); i++)
+		{
+			const Mesh *mesh = m_meshes.get(m_objectMeshes[i]);
+			if (mesh == nullptr || !mesh->isLoaded())
+				continue;
+
+			// The objects are not scaled, so the bounding sphere keeps its radius
+			const tsm::float4x4 &          world  = m_transforms.getWorldMatrix(m_objectTransforms[i]);
+			const geometry::BoundingSphere sphere = mesh->getBoundingSphere();
+			const tsm::float4              center = world[0] * sphere.center.x + world[1] * sphere.center.y + world[2] * sphere.center.z + world[3];
+			if (!frustum.isSphereVisible(glm::vec3(center.x(), center.y(), center.z()), sphere.radius))
+				continue;
+
+			visible[visibleCount++] = i;
+			drawCount += mesh->getSubMeshes().size();
+		}
+
+		DrawItem *draws     = m_frameArena.allocateArray<DrawItem>(drawCount);
+		uint64    drawIndex = 0u;
+		for (uint32 i = 0u; i < visibleCount; i++)
+		{
+			const uint32 object = visible[i];
+			const Mesh & mesh   = m_meshes[m_objectMeshes[object]];
+			for (uint32 subMesh = 0u; subMesh < mesh.getSubMeshes().size(); subMesh++)
+			{
+				draws[drawIndex++] = {&m_transforms.getWorldMatrix(m_objectTransforms[object]), &mesh, &mesh.getSubMeshDraw(subMesh),
+									  &mesh.getQuantizationGrids()[subMesh]};
+			}
+		}
+
+		m_drawList = {draws, drawCount};
+	}
+
+	void Application::_createMeshPipeline(const nvrhi::FramebufferInfo &framebufferInfo)
+	{
+		nvrhi::GraphicsPipelineDesc pipeline_desc{};
+		pipeline_desc.inputLayout    = m_meshInputLayout;
+		pipeline_desc.VS             = m_shaders[m_meshShader].getHandle(nvrhi::ShaderType::Vertex);
+		pipeline_desc.PS             = m_shaders[m_meshShader].getHandle(nvrhi::ShaderType::Pixel);
+		pipeline_desc.bindingLayouts = {m_meshBindingLayout};
+		// Counter clockwise stays front facing, the projection flips Y for Vulkan. No depth buffer yet
+		pipeline_desc.renderState.rasterState.setCullBack().setFrontCounterClockwise(true);
+		pipeline_desc.renderState.depthStencilState.disableDepthTest().disableDepthWrite();
+
+		m_meshPipeline = m_window->getGPUContext()->getNVRHIDevice()->createGraphicsPipeline(pipeline_desc, framebufferInfo);
+	}
+
 	void Application::_drawFrame()
 	{
 		auto            gpu_context = m_window->getGPUContext();
 		nvrhi::IDevice *nv_device   = gpu_context->getNVRHIDevice();
-		vk::Device      vk_device   = gpu_context->getLogicalDevice();
+
+		nvrhi::IFramebuffer *framebuffer = m_window->getSwapchain()->getCurrentFramebuffer();
 
 		m_commandList->open();
 
-		nvrhi::utils::ClearColorAttachment(m_commandList, m_window->getSwapchain()->getCurrentFramebuffer(), 0, {1.0f, 0.0f, 1.0f, 1.0f});
+		nvrhi::utils::ClearColorAttachment(m_commandList, framebuffer, 0, {1.0f, 0.0f, 1.0f, 1.0f});
+
+		if (!m_drawList.empty())
+		{
+			const nvrhi::FramebufferInfoEx &framebuffer_info = framebuffer->getFramebufferInfo();
+			if (!m_meshPipeline)
+				_createMeshPipeline(framebuffer_info);
+
+			const float aspect_ratio = static_cast<float>(framebuffer_info.width) / static_cast<float>(std::max(framebuffer_info.height, 1u));
+			const auto [mouse_x, mouse_y] = input::getMousePos();
+
+			MeshConstants constants{};
+			constants.view = m_camera.getViewMatrix();
+			constants.proj = m_camera.getProjectionMatrix(aspect_ratio);
+
+			MeshPushConstants push_constants{};
+			push_constants.time           = static_cast<float32>(glfwGetTime());
+			push_constants.resolution     = glm::vec2(framebuffer_info.width, framebuffer_info.height);
+			push_constants.mouse          = glm::vec2(mouse_x, mouse_y);
+			push_constants.cameraPosition = m_camera.getPosition();
+
+			nvrhi::GraphicsState state{};
+			state.setPipeline(m_meshPipeline)
+				 .setFramebuffer(framebuffer)
+				 .setViewport(nvrhi::ViewportState().addViewportAndScissorRect(framebuffer_info.getViewport()))
+				 .addBindingSet(m_meshBindingSet);
+
+			const std::span<const DrawItem> draws = m_drawList.first(std::min<uint64>(m_drawList.size(), c_maxMeshDrawsPerFrame));
+			for (const DrawItem &item: draws)
+			{
+				const SubMeshDraw &draw = *item.draw;
+
+				constants.model = item.worldMatrix->toGlm();
+				m_commandList->writeBuffer(m_meshConstants, &constants, sizeof(constants));
+
+				// The whole index buffer is bound, the draw picks its range and adds the submesh's first vertex
+				state.vertexBuffers = {nvrhi::VertexBufferBinding{gpu_context->getVertexBufferPool()[item.mesh->getVertexBuffer()].getHandle(), 0u, 0u}};
+				state.indexBuffer   = nvrhi::IndexBufferBinding{gpu_context->getIndexBufferPool()[item.mesh->getIndexBuffer()].getHandle(), draw.indexType, 0u};
+				m_commandList->setGraphicsState(state);
+
+				push_constants.gridOrigin = glm::vec4(item.grid->origin, 0.0f);
+				push_constants.gridExtent = glm::vec4(item.grid->extent, 0.0f);
+				m_commandList->setPushConstants(&push_constants, sizeof(push_constants));
+
+				m_commandList->drawIndexed(nvrhi::DrawArguments()
+										   .setVertexCount(draw.indexCount)
+										   .setStartIndexLocation(draw.firstIndex)
+										   .setStartVertexLocation(static_cast<uint32>(draw.vertexOffset)));
+			}
+		}
 
 		m_commandList->close();
 		nv_device->executeCommandList(m_commandList);
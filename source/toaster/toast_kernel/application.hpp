@@ -6,24 +6,39 @@
 #include "system_types.h"
 
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_set>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 
 #include <glm/glm.hpp>
 
 #include "gpu_context.hpp"
 #include "mesh.hpp"
+#include "mesh_streamer.hpp"
 #include "camera.hpp"
 #include "texture.hpp"
 #include "shader.hpp"
 #include "swapchain.hpp"
+#include "transform_hierarchy.hpp"
 #include "window.hpp"
 
+#include "memory/frame_arena.hpp"
+
 #define RAY_TRACING_ENABLED 0
 
 namespace toaster
 {
+	// One submesh of a visible object, what the mesh pass binds and draws
+	struct DrawItem
+	{
+		const tsm::float4x4 *        worldMatrix;
+		const Mesh *                 mesh;
+		const SubMeshDraw *          draw;
+		const tsm::QuantizationGrid *grid; // The submesh's, for decoding its positions
+	};
+
 	class Application
 	{
 	public:
@@ -33,14 +48,42 @@ namespace toaster
 		void run();
 
 	private:
+		void _buildScene();
 		void _processInput();
+		void _updateScene();
+		void _cullScene();
+		void _createMeshPipeline(const nvrhi::FramebufferInfo &framebufferInfo);
 		void _drawFrame();
 
-		Window *m_window{nullptr};
+		std::unique_ptr<Window> m_window;
+
+		// Per-frame temporaries, N-buffered so nothing is reused while a frame referencing it is still in flight
+		memory::FrameArena m_frameArena;
 
 		nvrhi::CommandListHandle m_commandList{nullptr};
 
-		gpu::Shader *m_testShader{nullptr};
+		memory::HandlePool<gpu::Shader, memory::EMemoryTag::eShader> m_shaders;
+		memory::HandlePool<Mesh, memory::EMemoryTag::eMesh>          m_meshes;
+		std::unique_ptr<MeshStreamer>                                m_meshStreamer; // Needs the GPU context, so created with the window
+
+		gpu::ShaderHandle m_testShader;
+		gpu::ShaderHandle m_meshShader;
+
+		nvrhi::InputLayoutHandle      m_meshInputLayout{nullptr}; // EVertexFormat::eStandard, the layout mesh_standard.vert.glsl reads
+		nvrhi::BindingLayoutHandle    m_meshBindingLayout{nullptr};
+		nvrhi::BufferHandle           m_meshConstants{nullptr}; // Volatile, rewritten for every draw
+		nvrhi::BindingSetHandle       m_meshBindingSet{nullptr};
+		nvrhi::GraphicsPipelineHandle m_meshPipeline{nullptr}; // Created with the first frame's framebuffer
+
+		// Every object in the scene hangs off m_sceneRoot, the world matrices are recomputed once per frame
+		TransformHierarchy       m_transforms;
+		TransformId              m_sceneRoot{c_invalidTransform};
+		std::vector<TransformId> m_objectTransforms;
+		std::vector<MeshHandle>  m_objectMeshes; // Streamed by m_meshStreamer, parallel to m_objectTransforms
+
+		// Rebuilt by _cullScene() every frame on m_frameArena, so valid for as long as the frame is in flight. Drawn by
+		// _drawFrame()
+		std::span<const DrawItem> m_drawList;
 
 		Camera    m_camera;
 		glm::vec2 m_lastMousePos{0.0f, 0.0f};
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 
+#include "math/math_transcendental.hpp"
+
 namespace toaster
 {
 	Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
@@ -23,6 +25,11 @@ namespace toaster
 		return proj;
 	}
 
+	tsm::Frustum Camera::getFrustum(float aspectRatio) const
+	{
+		return tsm::Frustum::fromMatrix(getProjectionMatrix(aspectRatio) * getViewMatrix());
+	}
+
 	void Camera::processKeyboard(EMovement direction, float deltaTime)
 	{
 		const float velocity = m_movementSpeed * deltaTime;
@@ -74,10 +81,14 @@ namespace toaster
 
 	void Camera::updateCameraVectors()
 	{
+		// Yaw and pitch in one sincos
+		tsm::float4 sin_angles, cos_angles;
+		tsm::sincos(tsm::float4(glm::radians(m_yaw), glm::radians(m_pitch), 0.0f, 0.0f), sin_angles, cos_angles);
+
 		glm::vec3 front;
-		front.x = cos(glm::radians(m_yaw)) * cos(glm::radians(m_pitch));
-		front.y = sin(glm::radians(m_pitch));
-		front.z = sin(glm::radians(m_yaw)) * cos(glm::radians(m_pitch));
+		front.x = cos_angles.x() * cos_angles.y();
+		front.y = sin_angles.y();
+		front.z = sin_angles.x() * cos_angles.y();
 		m_front = glm::normalize(front);
 
 		m_right = glm::normalize(glm::cross(m_front, m_worldUp));
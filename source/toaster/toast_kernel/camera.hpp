@@ -3,6 +3,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "math/math_frustum.hpp"
+
 namespace toaster
 {
 	class Camera
@@ -22,6 +24,7 @@ namespace toaster
 
 		[[nodiscard]] glm::mat4 getViewMatrix() const;
 		[[nodiscard]] glm::mat4 getProjectionMatrix(float aspectRatio) const;
+		[[nodiscard]] tsm::Frustum getFrustum(float aspectRatio) const;
 
 		void processKeyboard(EMovement direction, float deltaTime);
 		void processMouseMovement(float xOffset, float yOffset, bool constrainPitch = true);
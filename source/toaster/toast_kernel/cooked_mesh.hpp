@@ -0,0 +1,59 @@
+#pragma once
+
+#include <type_traits>
+
+#include "system_types.h"
+
+namespace toaster
+{
+	// Layout of a cooked .tmesh file, the engine's own mesh format. A cooked file is written after every Assimp import
+	// and loaded instead of the source for as long as the source's content, the import flags and the LOD settings stay
+	// the same:
+	//	TMeshHeader
+	//	Vertex[vertexCount]   at vertexDataOffset, vertexDataSize bytes through geometry::GeometryCodecWriter
+	//	uint32[indexCount]    at indexDataOffset, indexDataSize bytes through a GeometryCodecWriter with indexCodec.
+	//	                      The full detail ranges come first and the LOD ranges from lodIndexOffset, each range
+	//	                      relative to its submesh's vertexOffset and encoded as chunks of its own
+	//	SubMesh[subMeshCount] at subMeshDataOffset
+	//	SubMeshLod[lodCount]  at lodDataOffset
+	//	geometry::MeshletData at meshletDataOffset, meshletDataSize bytes as written by its serialize()
+	// Sections start on c_tmeshSectionAlignment. The vertices and indices are decoded straight out of the mapped file,
+	// the rest can be used in place. Everything is little endian, as written by the machine that cooked it
+	constexpr uint32 c_tmeshMagic{0x48534D54u}; // "TMSH"
+	// Bump whenever the layout, Vertex, SubMesh or the import processing changes, older files are then re-cooked
+	constexpr uint32 c_tmeshVersion{8u};
+	constexpr uint64 c_tmeshSectionAlignment{16u};
+
+	struct TMeshHeader
+	{
+		uint32 magic;
+		uint32 version;
+		uint64 sourceHash;  // hashBytes64() of the source file's content
+		uint64 sourceSize;  // In bytes
+		uint32 importFlags; // aiPostProcessSteps the source was imported with
+		uint32 vertexStride; // sizeof(Vertex) when cooked
+		uint32 vertexCount;
+		uint32 indexCount;
+		uint32 subMeshCount;
+		uint32 lodCount;
+		float  boundsMin[3];
+		float  boundsMax[3];
+		uint32 lodIndexOffset;
+		uint32 lodLevelCount; // geometry::LodSettings the LODs were built with
+		float  lodReduction;
+		float  lodMaxError;
+		uint64 vertexDataOffset;
+		uint64 indexDataOffset;
+		uint64 subMeshDataOffset;
+		uint64 lodDataOffset;
+		uint64 meshletDataOffset;
+		uint64 meshletDataSize;
+		uint64 vertexDataSize;
+		uint64 indexDataSize;
+		uint32 indexCodec; // geometry::EGeometryCodec, eIndexSequence when some submesh is not a triangle list
+		uint32 padding;
+		float  boundingSphere[4]; // Center and radius
+	};
+
+	static_assert(sizeof(TMeshHeader) == 176u && std::is_trivial_v<TMeshHeader>);
+}
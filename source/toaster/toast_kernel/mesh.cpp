@@ -1,10 +1,26 @@
 #include "mesh.hpp"
+#include "cooked_mesh.hpp"
 #include "gpu_context.hpp"
+#include "hash.hpp"
 #include "logging.hpp"
+#include "mesh_codec.hpp"
+#include "mesh_optimizer.hpp"
+#include "toast_assert.h"
+#include "io/file_stream.hpp"
+#include "io/mapped_file.hpp"
+#include "io/memory_stream.hpp"
+#include "jobs/job_system.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
 #include <assimp/postprocess.h>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 namespace toaster
 {
@@ -13,22 +29,138 @@ namespace toaster
 		destroy();
 	}
 
-	bool Mesh::loadFromFile(const std::string &filePath, gpu::GPUContext *gpuContext)
+	Mesh::Mesh(Mesh &&p_other) noexcept
+		: m_path(std::move(p_other.m_path)), m_directory(std::move(p_other.m_directory)), m_gpuContext(std::exchange(p_other.m_gpuContext, nullptr)),
+		  m_vertices(std::move(p_other.m_vertices)), m_indices(std::move(p_other.m_indices)), m_subMeshes(std::move(p_other.m_subMeshes)),
+		  m_lods(std::move(p_other.m_lods)), m_quantizationGrids(std::move(p_other.m_quantizationGrids)), m_draws(std::move(p_other.m_draws)),
+		  m_meshlets(std::move(p_other.m_meshlets)), m_lodIndexOffset(std::exchange(p_other.m_lodIndexOffset, 0u)), m_boundsMin(p_other.m_boundsMin),
+		  m_boundsMax(p_other.m_boundsMax), m_boundingSphere(p_other.m_boundingSphere), m_vertexFormat(p_other.m_vertexFormat), m_vertexBuffer(std::exchange(p_other.m_vertexBuffer, {})),
+		  m_positionBuffer(std::exchange(p_other.m_positionBuffer, {})), m_indexBuffer(std::exchange(p_other.m_indexBuffer, {})),
+		  m_state(std::exchange(p_other.m_state, EMeshState::eUnloaded)), m_materialsLoaded(std::exchange(p_other.m_materialsLoaded, false))
 	{
-		m_path = filePath;
+	}
 
-		m_gpuContext = gpuContext;
+	Mesh &Mesh::operator=(Mesh &&p_other) noexcept
+	{
+		if (this != &p_other)
+		{
+			destroy();
 
-		Assimp::Importer importer;
+			m_path              = std::move(p_other.m_path);
+			m_directory         = std::move(p_other.m_directory);
+			m_gpuContext        = std::exchange(p_other.m_gpuContext, nullptr);
+			m_vertices          = std::move(p_other.m_vertices);
+			m_indices           = std::move(p_other.m_indices);
+			m_subMeshes         = std::move(p_other.m_subMeshes);
+			m_lods              = std::move(p_other.m_lods);
+			m_quantizationGrids = std::move(p_other.m_quantizationGrids);
+			m_draws             = std::move(p_other.m_draws);
+			m_meshlets          = std::move(p_other.m_meshlets);
+			m_lodIndexOffset    = std::exchange(p_other.m_lodIndexOffset, 0u);
+			m_boundsMin         = p_other.m_boundsMin;
+			m_boundsMax         = p_other.m_boundsMax;
+			m_boundingSphere    = p_other.m_boundingSphere;
+			m_vertexFormat      = p_other.m_vertexFormat;
+			m_vertexBuffer      = std::exchange(p_other.m_vertexBuffer, {});
+			m_positionBuffer    = std::exchange(p_other.m_positionBuffer, {});
+			m_indexBuffer       = std::exchange(p_other.m_indexBuffer, {});
+			m_state             = std::exchange(p_other.m_state, EMeshState::eUnloaded);
+			m_materialsLoaded   = std::exchange(p_other.m_materialsLoaded, false);
+		}
+		return *this;
+	}
+
+	bool Mesh::loadFromFile(const std::string &filePath, gpu::GPUContext *gpuContext, const EVertexFormat vertexFormat, const geometry::LodSettings &lodSettings)
+	{
+		m_path         = filePath;
+		m_gpuContext   = gpuContext;
+		m_vertexFormat = vertexFormat;
+		m_state        = EMeshState::eLoading;
+
+		if (!loadMeshData(filePath, lodSettings))
+		{
+			m_state = EMeshState::eFailed;
+			return false;
+		}
+
+		// Create GPU buffers
+		const EncodedBuffers encoded = encodeBuffers();
+		uploadAllBuffers(encoded);
+
+		m_state = EMeshState::eResident;
+		return true;
+	}
+
+	namespace
+	{
+		// Part of the cooked file's key, changing them re-cooks every mesh
+		constexpr uint32 c_importFlags = aiProcess_Triangulate |           // Convert polygons to triangles
+										 aiProcess_GenNormals |            // Generate normals if not present
+										 aiProcess_FlipUVs |               // Flip UVs for Vulkan coordinate system
+										 aiProcess_CalcTangentSpace |      // Calculate tangents and bitangents
+										 aiProcess_JoinIdenticalVertices | // Optimize vertex count
+										 aiProcess_OptimizeMeshes;         // Reduce draw call count
+
+		uint64 alignSection(const uint64 offset)
+		{
+			return (offset + c_tmeshSectionAlignment - 1u) & ~(c_tmeshSectionAlignment - 1u);
+		}
+
+		static_assert(sizeof(Vertex) % 4u == 0u && sizeof(Vertex) <= geometry::c_maxCodecVertexSize);
+
+		// Decodes a cooked vertex or index section straight into dst
+		bool decodeSection(const std::span<const uint8> section, const geometry::EGeometryCodec codec, void *dst, const uint64 size)
+		{
+			io::MemoryStreamReader        sectionReader(section);
+			geometry::GeometryCodecReader reader(&sectionReader, codec, sizeof(Vertex));
+			return reader.readData(static_cast<uint8 *>(dst), size);
+		}
+	}
+
+	bool Mesh::loadMeshData(const std::string &filePath, const geometry::LodSettings &lodSettings)
+	{
+		const std::filesystem::path path = filePath;
+		if (path.extension() == ".tmesh")
+			return loadCooked(path, nullptr, nullptr);
 
-		constexpr uint32 importFlags = aiProcess_Triangulate |           // Convert polygons to triangles
-									   aiProcess_GenNormals |            // Generate normals if not present
-									   aiProcess_FlipUVs |               // Flip UVs for Vulkan coordinate system
-									   aiProcess_CalcTangentSpace |      // Calculate tangents and bitangents
-									   aiProcess_JoinIdenticalVertices | // Optimize vertex count
-									   aiProcess_OptimizeMeshes;         // Reduce draw call count
+		std::filesystem::path cookedPath = path;
+		cookedPath += ".tmesh";
 
-		const aiScene *scene = importer.ReadFile(filePath, importFlags);
+		// Hashing the source is a few ms even for large files, far cheaper than importing it
+		io::MappedFile source(path);
+		if (!source.isOpen())
+		{
+			// Shipped without sources, the cooked file is all there is
+			if (io::filesystem::exists(cookedPath))
+				return loadCooked(cookedPath, nullptr, nullptr);
+
+			LOG_ERROR("Could not open mesh '{}'", filePath);
+			return false;
+		}
+
+		const uint64 sourceHash = hashBytes64(source.getData());
+		const uint64 sourceSize = source.getSize();
+		source.close();
+
+		if (loadCooked(cookedPath, &sourceHash, &lodSettings))
+			return true;
+
+		if (!importFile(filePath, lodSettings))
+			return false;
+
+		computeBounds();
+
+		// The cooked file is only a cache, failing to write it costs the next load time but nothing else
+		if (!writeCooked(cookedPath, sourceHash, sourceSize, lodSettings))
+			LOG_WARN("Could not write cooked mesh '{}'", cookedPath.string());
+		return true;
+	}
+
+	bool Mesh::importFile(const std::string &filePath, const geometry::LodSettings &lodSettings)
+	{
+		Assimp::Importer importer;
+
+		const aiScene *scene = importer.ReadFile(filePath, c_importFlags);
 
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 		{
@@ -44,9 +176,10 @@ namespace toaster
 		m_vertices.clear();
 		m_indices.clear();
 		m_subMeshes.clear();
+		m_lods.clear();
+		m_meshlets.clear();
 
-		// Process all nodes recursively
-		processNode(scene->mRootNode, scene);
+		convertScene(scene, lodSettings);
 
 		if (m_vertices.empty() || m_indices.empty())
 		{
@@ -57,110 +190,796 @@ namespace toaster
 		LOG_INFO("  Total vertices: {}", m_vertices.size());
 		LOG_INFO("  Total indices: {}", m_indices.size());
 		LOG_INFO("  SubMeshes: {}", m_subMeshes.size());
+		return true;
+	}
 
-		// Create GPU buffers
-		createVertexBuffer();
-		createIndexBuffer();
+	bool Mesh::loadCooked(const std::filesystem::path &cookedPath, const uint64 *sourceHash, const geometry::LodSettings *lodSettings)
+	{
+		io::MappedFile file(cookedPath);
+		if (!file.isOpen() || file.getSize() < sizeof(TMeshHeader))
+			return false;
+
+		TMeshHeader header;
+		std::memcpy(&header, file.getData().data(), sizeof(TMeshHeader));
+
+		if (header.magic != c_tmeshMagic || header.version != c_tmeshVersion || header.vertexStride != sizeof(Vertex))
+		{
+			LOG_INFO("Cooked mesh '{}' is from an older version, re-cooking", cookedPath.string());
+			return false;
+		}
 
-		m_isLoaded = true;
+		const geometry::LodSettings cookedLodSettings{header.lodLevelCount, header.lodReduction, header.lodMaxError};
+		if (header.importFlags != c_importFlags || (sourceHash && header.sourceHash != *sourceHash) || (lodSettings && cookedLodSettings != *lodSettings))
+		{
+			LOG_INFO("Cooked mesh '{}' is out of date, re-cooking", cookedPath.string());
+			return false;
+		}
+
+		// Sizes come from the file, so check them before trusting any offset
+		const uint64 fileSize    = file.getSize();
+		const auto   sectionFits = [fileSize](const uint64 offset, const uint64 size)
+		{
+			return offset % c_tmeshSectionAlignment == 0u && offset <= fileSize && size <= fileSize - offset;
+		};
+		const auto indexCodec = static_cast<geometry::EGeometryCodec>(header.indexCodec);
+		if (header.vertexCount == 0u || header.indexCount == 0u || header.lodIndexOffset > header.indexCount ||
+			(indexCodec != geometry::EGeometryCodec::eTriangles && indexCodec != geometry::EGeometryCodec::eIndexSequence) ||
+			!sectionFits(header.vertexDataOffset, header.vertexDataSize) || !sectionFits(header.indexDataOffset, header.indexDataSize) ||
+			!sectionFits(header.subMeshDataOffset, static_cast<uint64>(header.subMeshCount) * sizeof(SubMesh)) ||
+			!sectionFits(header.lodDataOffset, static_cast<uint64>(header.lodCount) * sizeof(SubMeshLod)) ||
+			!sectionFits(header.meshletDataOffset, header.meshletDataSize))
+		{
+			LOG_ERROR("Cooked mesh '{}' is corrupt", cookedPath.string());
+			return false;
+		}
+
+		io::MemoryStreamReader meshletReader(file.getData().subspan(header.meshletDataOffset, header.meshletDataSize));
+		m_meshlets.deserialize(&meshletReader);
+		if (!meshletReader)
+		{
+			LOG_ERROR("Cooked mesh '{}' has corrupt meshlets", cookedPath.string());
+			return false;
+		}
+
+		// Vertices and indices are decoded out of the page cache into their arrays, the rest is one copy
+		m_vertices.resize(header.vertexCount);
+		m_indices.resize(header.indexCount);
+		if (!decodeSection(file.getData().subspan(header.vertexDataOffset, header.vertexDataSize), geometry::EGeometryCodec::eVertices, m_vertices.data(),
+						   m_vertices.size() * sizeof(Vertex)) ||
+			!decodeSection(file.getData().subspan(header.indexDataOffset, header.indexDataSize), indexCodec, m_indices.data(), m_indices.size() * sizeof(uint32)))
+		{
+			LOG_ERROR("Cooked mesh '{}' has corrupt vertices or indices", cookedPath.string());
+			m_vertices.clear();
+			m_indices.clear();
+			m_meshlets.clear();
+			return false;
+		}
+
+		const uint8 *data      = file.getData().data();
+		const auto * subMeshes = reinterpret_cast<const SubMesh *>(data + header.subMeshDataOffset);
+		const auto * lods      = reinterpret_cast<const SubMeshLod *>(data + header.lodDataOffset);
+		m_subMeshes.assign(subMeshes, subMeshes + header.subMeshCount);
+		m_lods.assign(lods, lods + header.lodCount);
+		m_lodIndexOffset = header.lodIndexOffset;
+
+		// Indices are relative to their submesh, each one must stay inside its submesh's vertex slice
+		const auto indicesValid = [this](const SubMesh &subMesh, const uint32 indexOffset, const uint32 indexCount)
+		{
+			return static_cast<uint64>(indexOffset) + indexCount <= m_indices.size() &&
+				   std::ranges::all_of(std::span(m_indices).subspan(indexOffset, indexCount), [&](const uint32 index) { return index < subMesh.vertexCount; });
+		};
+		const bool rangesValid = std::ranges::all_of(m_subMeshes, [&](const SubMesh &subMesh)
+		{
+			if (static_cast<uint64>(subMesh.meshletOffset) + subMesh.meshletCount > m_meshlets.meshlets.size() ||
+				static_cast<uint64>(subMesh.lodOffset) + subMesh.lodCount > m_lods.size() ||
+				static_cast<uint64>(subMesh.vertexOffset) + subMesh.vertexCount > m_vertices.size() ||
+				static_cast<uint64>(subMesh.indexOffset) + subMesh.indexCount > m_lodIndexOffset)
+				return false;
+
+			return indicesValid(subMesh, subMesh.indexOffset, subMesh.indexCount) &&
+				   std::ranges::all_of(std::span(m_lods).subspan(subMesh.lodOffset, subMesh.lodCount), [&](const SubMeshLod &lod)
+				   {
+					   return lod.indexOffset >= m_lodIndexOffset && indicesValid(subMesh, lod.indexOffset, lod.indexCount);
+				   });
+		});
+		if (!rangesValid)
+		{
+			LOG_ERROR("Cooked mesh '{}' is corrupt", cookedPath.string());
+			m_lods.clear();
+			m_meshlets.clear();
+			m_lodIndexOffset = 0u;
+			return false;
+		}
+
+		m_boundsMin      = {header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]};
+		m_boundsMax      = {header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]};
+		m_boundingSphere = {{header.boundingSphere[0], header.boundingSphere[1], header.boundingSphere[2]}, header.boundingSphere[3]};
+
+		LOG_INFO("Loaded cooked mesh: {} ({} vertices, {} indices, {} submeshes, {} LODs)", cookedPath.string(), m_vertices.size(), m_indices.size(),
+				 m_subMeshes.size(), m_lods.size());
+		return true;
+	}
+
+	bool Mesh::writeCooked(const std::filesystem::path &cookedPath, const uint64 sourceHash, const uint64 sourceSize, const geometry::LodSettings &lodSettings) const
+	{
+		TMeshHeader header{};
+		header.magic             = c_tmeshMagic;
+		header.version           = c_tmeshVersion;
+		header.sourceHash        = sourceHash;
+		header.sourceSize        = sourceSize;
+		header.importFlags       = c_importFlags;
+		header.vertexStride      = sizeof(Vertex);
+		header.vertexCount       = static_cast<uint32>(m_vertices.size());
+		header.indexCount        = static_cast<uint32>(m_indices.size());
+		header.subMeshCount      = static_cast<uint32>(m_subMeshes.size());
+		header.lodCount          = static_cast<uint32>(m_lods.size());
+		header.lodIndexOffset    = m_lodIndexOffset;
+		header.lodLevelCount     = lodSettings.levelCount;
+		header.lodReduction      = lodSettings.reduction;
+		header.lodMaxError       = lodSettings.maxError;
+		std::memcpy(header.boundsMin, &m_boundsMin, sizeof(header.boundsMin));
+		std::memcpy(header.boundsMax, &m_boundsMax, sizeof(header.boundsMax));
+		std::memcpy(header.boundingSphere, &m_boundingSphere, sizeof(header.boundingSphere));
+
+		// Written next to the real file and renamed over it, so a crash mid-write never leaves a truncated cooked file.
+		// The thread's own temp file, two threads cooking the same source must not write into one
+		std::filesystem::path tempPath = cookedPath;
+		tempPath += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+		bool written;
+		{
+			io::FileStreamWriter writer(tempPath);
+
+			// Encoded sizes are only known once written, sections start wherever the previous one ended and the header is
+			// rewritten after them
+			const auto beginSection = [&writer](uint64 &offset)
+			{
+				constexpr uint8 padding[c_tmeshSectionAlignment]{};
+				offset = alignSection(writer.getStreamPos());
+				return writer.writeData(padding, offset - writer.getStreamPos());
+			};
+
+			// Every write is checked and the first failure skips the rest, a full disk must not trip StreamWriter's asserts
+			written = writer && writer.tryWriteRaw(header) && beginSection(header.vertexDataOffset);
+			if (written)
+			{
+				geometry::GeometryCodecWriter vertexWriter(&writer, geometry::EGeometryCodec::eVertices, sizeof(Vertex));
+				written = written && vertexWriter.writeData(reinterpret_cast<const uint8 *>(m_vertices.data()), m_vertices.size() * sizeof(Vertex)) &&
+						  vertexWriter.flush();
+			}
+			header.vertexDataSize = writer.getStreamPos() - header.vertexDataOffset;
+
+			// Every submesh and LOD range is a chunk of its own, so the triangle codec starts over with each range's
+			// vertices. Submeshes that are not triangle lists have no meshlets and need the plain index sequence
+			const bool trianglesOnly = std::ranges::all_of(m_subMeshes, [](const SubMesh &subMesh) { return subMesh.indexCount == 0u || subMesh.meshletCount > 0u; });
+			const auto indexCodec    = trianglesOnly ? geometry::EGeometryCodec::eTriangles : geometry::EGeometryCodec::eIndexSequence;
+			header.indexCodec        = static_cast<uint32>(indexCodec);
+
+			std::vector<uint32> rangeStarts{0u, static_cast<uint32>(m_indices.size())};
+			for (const SubMesh &subMesh: m_subMeshes)
+				rangeStarts.push_back(subMesh.indexOffset);
+			for (const SubMeshLod &lod: m_lods)
+				rangeStarts.push_back(lod.indexOffset);
+			std::ranges::sort(rangeStarts);
+			rangeStarts.erase(std::unique(rangeStarts.begin(), rangeStarts.end()), rangeStarts.end());
+
+			written = written && beginSection(header.indexDataOffset);
+			if (written)
+			{
+				geometry::GeometryCodecWriter indexWriter(&writer, indexCodec);
+				for (size_t rangeIndex = 1u; written && rangeIndex < rangeStarts.size(); ++rangeIndex)
+				{
+					const uint32 rangeStart = rangeStarts[rangeIndex - 1u];
+					const uint32 rangeSize  = rangeStarts[rangeIndex] - rangeStart;
+					written = indexWriter.writeData(reinterpret_cast<const uint8 *>(m_indices.data() + rangeStart), rangeSize * sizeof(uint32)) && indexWriter.flush();
+				}
+			}
+			header.indexDataSize = writer.getStreamPos() - header.indexDataOffset;
+
+			written = written && beginSection(header.subMeshDataOffset) &&
+					  writer.writeData(reinterpret_cast<const uint8 *>(m_subMeshes.data()), m_subMeshes.size() * sizeof(SubMesh)) &&
+					  beginSection(header.lodDataOffset) && writer.writeData(reinterpret_cast<const uint8 *>(m_lods.data()), m_lods.size() * sizeof(SubMeshLod)) &&
+					  beginSection(header.meshletDataOffset);
+			if (written)
+			{
+				m_meshlets.serialize(&writer);
+				header.meshletDataSize = writer.getStreamPos() - header.meshletDataOffset;
+
+				writer.setStreamPos(0u);
+				written = writer && writer.tryWriteRaw(header) && writer.flush();
+			}
+		}
+
+		std::error_code error;
+		if (written)
+			std::filesystem::rename(tempPath, cookedPath, error);
+
+		if (!written || error)
+		{
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
 		return true;
 	}
 
+	void Mesh::computeBounds()
+	{
+		if (m_vertices.empty())
+		{
+			m_boundsMin      = glm::vec3(0.0f);
+			m_boundsMax      = glm::vec3(0.0f);
+			m_boundingSphere = {glm::vec3(0.0f), 0.0f};
+			return;
+		}
+
+		geometry::computeAabb(&m_vertices[0].position, sizeof(Vertex), m_vertices.size(), m_boundsMin, m_boundsMax);
+		m_boundingSphere = geometry::computeBoundingSphere(&m_vertices[0].position, sizeof(Vertex), m_vertices.size());
+	}
+
 	void Mesh::destroy()
 	{
 		if (!m_gpuContext)
 			return;
 
+		m_gpuContext->getVertexBufferPool().destroy(m_vertexBuffer);
+		m_gpuContext->getVertexBufferPool().destroy(m_positionBuffer);
+		m_gpuContext->getIndexBufferPool().destroy(m_indexBuffer);
+		m_vertexBuffer   = {};
+		m_positionBuffer = {};
+		m_indexBuffer    = {};
+
 		m_vertices.clear();
 		m_indices.clear();
 		m_subMeshes.clear();
-		m_isLoaded = false;
+		m_lods.clear();
+		m_quantizationGrids.clear();
+		m_draws.clear();
+		m_meshlets.clear();
+		m_lodIndexOffset = 0u;
+		m_boundsMin      = glm::vec3(0.0f);
+		m_boundsMax      = glm::vec3(0.0f);
+		m_boundingSphere = {glm::vec3(0.0f), 0.0f};
+		m_state          = EMeshState::eUnloaded;
 	}
 
-	void Mesh::processNode(aiNode *node, const aiScene *scene)
+	namespace
 	{
-		// Process all meshes in this node
-		for (uint32 i = 0; i < node->mNumMeshes; i++)
+		// Where one aiMesh instance lands in the merged vertex and index arrays
+		struct MeshInstance
+		{
+			const aiMesh *mesh;
+			glm::mat4     transform;
+			glm::mat3     normalMatrix;
+			glm::mat3     tangentMatrix; // Tangents are directions along the surface, they transform like positions
+			uint32        vertexOffset;
+			uint32        indexOffset;
+			uint32        indexCount;
+			bool          flipWinding;
+			bool          trianglesOnly;
+		};
+
+		enum class EConversion : uint8
+		{
+			eVertices,
+			eTriangles,
+			eFaces, // Meshes with points or lines left, converted in one piece
+		};
+
+		struct ConversionRange
+		{
+			uint32      instance;
+			uint32      begin; // Vertex or face
+			uint32      end;
+			EConversion conversion;
+		};
+
+		// Vertices or faces per conversion range
+		constexpr uint32 c_conversionRangeSize{16'384u};
+
+		void collectMeshInstances(const aiNode *node, const aiScene *scene, const glm::mat4 &parentTransform, std::vector<MeshInstance> &instances)
+		{
+			// aiMatrix4x4 is row major
+			const glm::mat4 transform = parentTransform * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
+
+			for (uint32 i = 0; i < node->mNumMeshes; i++)
+			{
+				const aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
+
+				MeshInstance instance{};
+				instance.mesh      = mesh;
+				instance.transform = transform;
+
+				// The node transforms are baked into the vertices, the mesh is drawn with a single model matrix
+				instance.normalMatrix  = glm::inverseTranspose(glm::mat3(transform));
+				instance.tangentMatrix = glm::mat3(transform);
+
+				// Mirroring transforms flip the winding
+				instance.flipWinding = glm::determinant(glm::mat3(transform)) < 0.0f;
+
+				// Triangulated meshes are the common case, with points or lines left over the faces have to be counted
+				instance.trianglesOnly = (mesh->mPrimitiveTypes & ~aiPrimitiveType_NGONEncodingFlag) == aiPrimitiveType_TRIANGLE;
+				if (instance.trianglesOnly)
+				{
+					instance.indexCount = mesh->mNumFaces * 3;
+				}
+				else
+				{
+					for (uint32 face = 0; face < mesh->mNumFaces; face++)
+					{
+						instance.indexCount += mesh->mFaces[face].mNumIndices;
+					}
+				}
+
+				instances.push_back(instance);
+			}
+
+			for (uint32 i = 0; i < node->mNumChildren; i++)
+			{
+				collectMeshInstances(node->mChildren[i], scene, transform, instances);
+			}
+		}
+
+		// Any unit vector at right angles to the normal, for vertices without a usable tangent
+		glm::vec3 getAnyTangent(const glm::vec3 &normal)
 		{
-			aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-			processMesh(mesh, scene);
+			const glm::vec3 axis = std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			return glm::normalize(glm::cross(axis, normal));
+		}
+
+		// One loop per attribute combination, so the per vertex loop has no branches. Assimp only computes tangents
+		// for meshes with normals and UVs
+		template<bool HasNormals, bool HasTexCoords, bool HasTangents>
+		void convertVertices(const MeshInstance &instance, const uint32 begin, const uint32 end, Vertex *vertices)
+		{
+			const aiMesh *mesh = instance.mesh;
+			Vertex *      out  = vertices + instance.vertexOffset;
+
+			for (uint32 i = begin; i < end; i++)
+			{
+				Vertex &vertex = out[i];
+
+				vertex.position = glm::vec3(instance.transform * glm::vec4(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f));
+
+				// Assimp leaves NaNs where it could not compute a normal, the packed formats need a direction
+				vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+				if constexpr (HasNormals)
+				{
+					const glm::vec3 normal       = instance.normalMatrix * glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+					const float     normalLength = glm::length(normal);
+					if (normalLength > 0.0f)
+						vertex.normal = normal / normalLength;
+				}
+
+				// First UV channel only
+				if constexpr (HasTexCoords)
+					vertex.texCoord = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+				else
+					vertex.texCoord = glm::vec2(0.0f, 0.0f);
+
+				// Made orthogonal to the normal. The bitangent sign is taken after the transform, which accounts for
+				// mirroring ones. Degenerate UVs leave no usable tangent
+				glm::vec3 tangent(0.0f);
+				float     bitangentSign = 1.0f;
+				if constexpr (HasTangents)
+				{
+					const glm::vec3 meshTangent   = instance.tangentMatrix * glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+					const glm::vec3 meshBitangent = instance.tangentMatrix * glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+					tangent                       = meshTangent - vertex.normal * glm::dot(vertex.normal, meshTangent);
+					bitangentSign                 = glm::dot(glm::cross(vertex.normal, tangent), meshBitangent) < 0.0f ? -1.0f : 1.0f;
+				}
+
+				const float tangentLength = glm::length(tangent);
+				vertex.tangent            = glm::vec4(tangentLength > 1e-6f ? tangent / tangentLength : getAnyTangent(vertex.normal), bitangentSign);
+			}
 		}
 
-		// Recursively process child nodes
-		for (uint32 i = 0; i < node->mNumChildren; i++)
+		template<bool FlipWinding>
+		void convertTriangles(const MeshInstance &instance, const uint32 begin, const uint32 end, uint32 *indices)
 		{
-			processNode(node->mChildren[i], scene);
+			const aiFace *faces = instance.mesh->mFaces;
+			uint32 *      out   = indices + instance.indexOffset + begin * 3;
+
+			for (uint32 i = begin; i < end; i++)
+			{
+				const uint32 *face = faces[i].mIndices;
+				if constexpr (FlipWinding)
+				{
+					out[0] = face[2];
+					out[1] = face[1];
+					out[2] = face[0];
+				}
+				else
+				{
+					out[0] = face[0];
+					out[1] = face[1];
+					out[2] = face[2];
+				}
+				out += 3;
+			}
+		}
+
+		// Points and lines mixed in, the index offsets are only known by walking the faces in order
+		void convertFaces(const MeshInstance &instance, uint32 *indices)
+		{
+			const aiMesh *mesh = instance.mesh;
+			uint32 *      out  = indices + instance.indexOffset;
+
+			for (uint32 i = 0; i < mesh->mNumFaces; i++)
+			{
+				const aiFace &face = mesh->mFaces[i];
+				for (uint32 j = 0; j < face.mNumIndices; j++)
+				{
+					const uint32 corner = instance.flipWinding ? face.mNumIndices - 1 - j : j;
+					*out++              = face.mIndices[corner];
+				}
+			}
+		}
+
+		void convertRange(const MeshInstance &instance, const ConversionRange &range, Vertex *vertices, uint32 *indices)
+		{
+			switch (range.conversion)
+			{
+				case EConversion::eVertices:
+				{
+					const bool hasNormals   = instance.mesh->HasNormals();
+					const bool hasTexCoords = instance.mesh->mTextureCoords[0] != nullptr;
+					if (hasNormals && hasTexCoords && instance.mesh->HasTangentsAndBitangents())
+						convertVertices<true, true, true>(instance, range.begin, range.end, vertices);
+					else if (hasNormals && hasTexCoords)
+						convertVertices<true, true, false>(instance, range.begin, range.end, vertices);
+					else if (hasNormals)
+						convertVertices<true, false, false>(instance, range.begin, range.end, vertices);
+					else if (hasTexCoords)
+						convertVertices<false, true, false>(instance, range.begin, range.end, vertices);
+					else
+						convertVertices<false, false, false>(instance, range.begin, range.end, vertices);
+					break;
+				}
+				case EConversion::eTriangles:
+				{
+					if (instance.flipWinding)
+						convertTriangles<true>(instance, range.begin, range.end, indices);
+					else
+						convertTriangles<false>(instance, range.begin, range.end, indices);
+					break;
+				}
+				case EConversion::eFaces:
+				{
+					convertFaces(instance, indices);
+					break;
+				}
+			}
+		}
+
+		struct OptimizationStats
+		{
+			geometry::VertexCacheStats before;
+			geometry::VertexCacheStats after;
+		};
+
+		// Reorders one triangle submesh's indices for the vertex cache, then for overdraw, renumbers its vertex slice
+		// into first use order, splits it into meshlets and simplifies it into LODs
+		OptimizationStats optimizeSubMesh(const SubMesh &subMesh, Vertex *vertices, uint32 *indices, const geometry::LodSettings &lodSettings,
+										  geometry::MeshletData &meshlets, std::vector<geometry::LodLevel> &lods)
+		{
+			const uint32            vertexCount = subMesh.vertexCount;
+			Vertex *                subVertices = vertices + subMesh.vertexOffset;
+			const std::span<uint32> subIndices(indices + subMesh.indexOffset, subMesh.indexCount);
+
+			OptimizationStats stats;
+			stats.before = geometry::analyzeVertexCache(subIndices, vertexCount);
+
+			geometry::optimizeVertexCache(subIndices, vertexCount);
+			geometry::optimizeOverdraw(subIndices, &subVertices[0].position, sizeof(Vertex), vertexCount);
+
+			std::vector<uint32> remap(vertexCount);
+			geometry::optimizeVertexFetchRemap(subIndices, remap);
+
+			const std::vector<Vertex> original(subVertices, subVertices + vertexCount);
+			for (uint32 i = 0; i < vertexCount; i++)
+			{
+				subVertices[remap[i]] = original[i];
+			}
+
+			stats.after = geometry::analyzeVertexCache(subIndices, vertexCount);
+
+			geometry::buildMeshlets(subIndices, &subVertices[0].position, sizeof(Vertex), vertexCount, meshlets);
+			for (uint32 &vertex: meshlets.vertices)
+			{
+				vertex += subMesh.vertexOffset;
+			}
+
+			// The levels draw from the same vertices, only their triangle order needs redoing
+			geometry::buildLodChain(subIndices, &subVertices[0].position, sizeof(Vertex), vertexCount, lodSettings, lods);
+			for (geometry::LodLevel &lod: lods)
+			{
+				geometry::optimizeVertexCache(lod.indices, vertexCount);
+			}
+			return stats;
+		}
+
+		// Bounds of the submesh's vertex slice, and the surface of its full detail triangles for triangle lists
+		void computeSubMeshStats(SubMesh &subMesh, const Vertex *vertices, const uint32 *indices, const bool trianglesOnly)
+		{
+			const Vertex *subVertices = vertices + subMesh.vertexOffset;
+			geometry::computeAabb(&subVertices[0].position, sizeof(Vertex), subMesh.vertexCount, subMesh.boundsMin, subMesh.boundsMax);
+			subMesh.boundingSphere = geometry::computeBoundingSphere(&subVertices[0].position, sizeof(Vertex), subMesh.vertexCount);
+
+			geometry::SurfaceStats surface;
+			if (trianglesOnly)
+			{
+				surface = geometry::computeSurfaceStats(std::span(indices + subMesh.indexOffset, subMesh.indexCount), &subVertices[0].position, sizeof(Vertex),
+														&subVertices[0].texCoord, sizeof(Vertex));
+			}
+			subMesh.triangleCount = surface.triangleCount;
+			subMesh.surfaceArea   = surface.surfaceArea;
+			subMesh.uvDensity     = surface.getUvDensity();
 		}
 	}
 
-	void Mesh::processMesh(aiMesh *mesh, const aiScene *scene)
+	void Mesh::convertScene(const aiScene *scene, const geometry::LodSettings &lodSettings)
 	{
-		SubMesh subMesh{};
-		subMesh.vertexOffset = static_cast<uint32>(m_vertices.size());
-		subMesh.indexOffset  = static_cast<uint32>(m_indices.size());
+		// Phase one: every mesh instance gets its slice of the merged arrays, which are sized once
+		std::vector<MeshInstance> instances;
+		collectMeshInstances(scene->mRootNode, scene, glm::mat4(1.0f), instances);
 
-		// Process vertices
-		for (uint32 i = 0; i < mesh->mNumVertices; i++)
+		uint32 vertexCount = 0;
+		uint32 indexCount  = 0;
+		for (MeshInstance &instance: instances)
 		{
-			Vertex vertex{};
+			instance.vertexOffset = vertexCount;
+			instance.indexOffset  = indexCount;
+			vertexCount += instance.mesh->mNumVertices;
+			indexCount += instance.indexCount;
+		}
 
-			// Position
-			vertex.position.x = mesh->mVertices[i].x;
-			vertex.position.y = mesh->mVertices[i].y;
-			vertex.position.z = mesh->mVertices[i].z;
+		m_vertices.resize(vertexCount);
+		m_indices.resize(indexCount);
+		m_subMeshes.resize(instances.size());
 
-			// Normal
-			if (mesh->HasNormals())
+		// Large meshes are cut into several ranges so a single big mesh does not end up on one worker
+		std::vector<ConversionRange> ranges;
+		for (uint32 i = 0; i < instances.size(); i++)
+		{
+			const MeshInstance &instance = instances[i];
+			m_subMeshes[i]               = {instance.indexOffset, instance.indexCount, instance.vertexOffset, instance.mesh->mNumVertices};
+
+			for (uint32 begin = 0; begin < instance.mesh->mNumVertices; begin += c_conversionRangeSize)
 			{
-				vertex.normal.x = mesh->mNormals[i].x;
-				vertex.normal.y = mesh->mNormals[i].y;
-				vertex.normal.z = mesh->mNormals[i].z;
+				ranges.push_back({i, begin, std::min(begin + c_conversionRangeSize, instance.mesh->mNumVertices), EConversion::eVertices});
 			}
-			else
+
+			if (!instance.trianglesOnly)
 			{
-				vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+				ranges.push_back({i, 0, instance.mesh->mNumFaces, EConversion::eFaces});
+				continue;
 			}
 
-			// Texture coordinates (use first UV channel if available)
-			if (mesh->mTextureCoords[0])
+			for (uint32 begin = 0; begin < instance.mesh->mNumFaces; begin += c_conversionRangeSize)
 			{
-				vertex.texCoord.x = mesh->mTextureCoords[0][i].x;
-				vertex.texCoord.y = mesh->mTextureCoords[0][i].y;
+				ranges.push_back({i, begin, std::min(begin + c_conversionRangeSize, instance.mesh->mNumFaces), EConversion::eTriangles});
 			}
-			else
+		}
+
+		// Phase two: the ranges write disjoint slices, so they convert in parallel straight into place
+		Vertex *vertices = m_vertices.data();
+		uint32 *indices  = m_indices.data();
+		jobs::parallelFor(0u, ranges.size(), [&](const uint64 begin, const uint64 end)
+		{
+			for (uint64 i = begin; i < end; i++)
+			{
+				convertRange(instances[ranges[i].instance], ranges[i], vertices, indices);
+			}
+		}, 1u);
+
+		// Phase three: submeshes are optimized independently, each writes only its own slices. Meshes still holding
+		// points or lines are left in their original order and get no meshlets, LODs or surface stats
+		std::vector<OptimizationStats>               stats(instances.size());
+		std::vector<geometry::MeshletData>           meshlets(instances.size());
+		std::vector<std::vector<geometry::LodLevel>> lods(instances.size());
+		jobs::parallelFor(0u, instances.size(), [&](const uint64 begin, const uint64 end)
+		{
+			for (uint64 i = begin; i < end; i++)
 			{
-				vertex.texCoord = glm::vec2(0.0f, 0.0f);
+				if (instances[i].trianglesOnly)
+					stats[i] = optimizeSubMesh(m_subMeshes[i], vertices, indices, lodSettings, meshlets[i], lods[i]);
+				computeSubMeshStats(m_subMeshes[i], vertices, indices, instances[i].trianglesOnly);
 			}
+		}, 1u);
+
+		m_meshlets.clear();
+		for (uint32 i = 0; i < instances.size(); i++)
+		{
+			m_subMeshes[i].meshletOffset = static_cast<uint32>(m_meshlets.meshlets.size());
+			m_subMeshes[i].meshletCount  = static_cast<uint32>(meshlets[i].meshlets.size());
+			m_meshlets.append(meshlets[i]);
+		}
+
+		// The LODs' index ranges go after all of the full detail ones
+		m_lods.clear();
+		m_lodIndexOffset = static_cast<uint32>(m_indices.size());
+		std::vector<uint64> lodTriangles(geometry::c_maxLodLevels, 0u);
+		std::vector<float>  lodErrors(geometry::c_maxLodLevels, 0.0f);
+		for (uint32 i = 0; i < instances.size(); i++)
+		{
+			m_subMeshes[i].lodOffset = static_cast<uint32>(m_lods.size());
+			m_subMeshes[i].lodCount  = static_cast<uint32>(lods[i].size());
+			for (uint32 level = 0; level < lods[i].size(); level++)
+			{
+				const geometry::LodLevel &lod = lods[i][level];
+				m_lods.push_back({static_cast<uint32>(m_indices.size()), static_cast<uint32>(lod.indices.size()), lod.error});
+				m_indices.insert(m_indices.end(), lod.indices.begin(), lod.indices.end());
+
+				lodTriangles[level] += lod.indices.size() / 3u;
+				lodErrors[level] = std::max(lodErrors[level], lod.error);
+			}
+		}
+
+		const auto accumulate = [](geometry::VertexCacheStats &sum, const geometry::VertexCacheStats &add)
+		{
+			sum.triangleCount += add.triangleCount;
+			sum.vertexCount += add.vertexCount;
+			sum.transformCount += add.transformCount;
+		};
+
+		OptimizationStats total;
+		for (const OptimizationStats &subMeshStats: stats)
+		{
+			accumulate(total.before, subMeshStats.before);
+			accumulate(total.after, subMeshStats.after);
+		}
+
+		uint64 triangleCount = 0u;
+		double surfaceArea   = 0.0;
+		for (const SubMesh &subMesh: m_subMeshes)
+		{
+			triangleCount += subMesh.triangleCount;
+			surfaceArea += subMesh.surfaceArea;
+		}
+
+		LOG_INFO("  Vertex cache ({} entries): ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", geometry::c_vertexCacheSize, total.before.getAcmr(), total.after.getAcmr(),
+				 total.before.getAtvr(), total.after.getAtvr());
+		LOG_INFO("  Surface: {} triangles, area {:.3f}", triangleCount, surfaceArea);
+		LOG_INFO("  Meshlets: {}", m_meshlets.meshlets.size());
+		for (uint32 level = 0; level < geometry::c_maxLodLevels && lodTriangles[level] > 0u; level++)
+		{
+			LOG_INFO("  LOD {}: {} triangles, error up to {:.5f}", level + 1u, lodTriangles[level], lodErrors[level]);
+		}
+	}
+
+	const SubMeshDraw &Mesh::getSubMeshDraw(const uint32 subMeshIndex, const uint32 lod) const
+	{
+		TST_ASSERT_MSG(subMeshIndex < m_subMeshes.size() && lod <= m_subMeshes[subMeshIndex].lodCount, "Submesh or LOD out of range");
+		TST_ASSERT_MSG(m_draws.size() == m_subMeshes.size() + m_lods.size(), "The mesh has no GPU buffers");
+
+		if (lod == 0u)
+			return m_draws[subMeshIndex];
+		return m_draws[m_subMeshes.size() + m_subMeshes[subMeshIndex].lodOffset + lod - 1u];
+	}
+
+	Mesh::EncodedBuffers Mesh::encodeBuffers()
+	{
+		const uint64 vertexStride   = getVertexFormatDesc(m_vertexFormat).stride;
+		const uint64 positionStride = getVertexFormatDesc(EVertexFormat::ePosition).stride;
+
+		EncodedBuffers encoded;
+		encoded.vertices.resize(m_vertices.size() * vertexStride);
+		encoded.positions.resize(m_vertices.size() * positionStride);
+
+		// A grid around each submesh's vertex slice keeps the precision of small parts when they share a mesh with
+		// large ones
+		m_quantizationGrids.clear();
+		m_quantizationGrids.reserve(m_subMeshes.size());
+		for (uint64 i = 0; i < m_subMeshes.size(); i++)
+		{
+			const uint32                  vertexOffset = m_subMeshes[i].vertexOffset;
+			const std::span<const Vertex> vertices     = std::span<const Vertex>(m_vertices).subspan(vertexOffset, m_subMeshes[i].vertexCount);
 
-			m_vertices.push_back(vertex);
+			const tsm::QuantizationGrid grid =
+				vertices.empty() ? tsm::QuantizationGrid{} : tsm::QuantizationGrid::fromBounds(m_subMeshes[i].boundsMin, m_subMeshes[i].boundsMax);
+			m_quantizationGrids.push_back(grid);
+
+			encodeVertices(m_vertexFormat, vertices, grid, encoded.vertices.data() + vertexOffset * vertexStride);
+			encodeVertices(EVertexFormat::ePosition, vertices, grid, encoded.positions.data() + vertexOffset * positionStride);
 		}
 
-		// Process indices
-		for (uint32 i = 0; i < mesh->mNumFaces; i++)
+		// One draw per index range, in the same order as m_draws: full detail levels, then every LOD. A submesh's
+		// ranges are 16 bit whenever its local indices fit, 32 bit ones start 4 byte aligned
+		m_draws.clear();
+		m_draws.reserve(m_subMeshes.size() + m_lods.size());
+		const auto encodeRange = [&](const SubMesh &subMesh, const uint32 indexOffset, const uint32 indexCount)
 		{
-			const aiFace &face = mesh->mFaces[i];
-			for (uint32 j = 0; j < face.mNumIndices; j++)
+			const std::span<const uint32> indices = std::span<const uint32>(m_indices).subspan(indexOffset, indexCount);
+			const bool                    is16Bit = subMesh.vertexCount < c_maxVerticesFor16BitIndices;
+			const uint64                  size    = is16Bit ? sizeof(uint16) : sizeof(uint32);
+
+			const uint64 start = (encoded.indices.size() + size - 1u) / size * size;
+			encoded.indices.resize(start + indices.size() * size);
+			if (is16Bit)
 			{
-				// Add vertex offset for multi-mesh support
-				m_indices.push_back(face.mIndices[j] + subMesh.vertexOffset);
+				auto *out = reinterpret_cast<uint16 *>(encoded.indices.data() + start);
+				for (uint64 i = 0; i < indices.size(); i++)
+				{
+					out[i] = static_cast<uint16>(indices[i]);
+				}
+			}
+			else
+			{
+				std::memcpy(encoded.indices.data() + start, indices.data(), indices.size_bytes());
+			}
+
+			m_draws.push_back({is16Bit ? nvrhi::Format::R16_UINT : nvrhi::Format::R32_UINT, static_cast<uint32>(start / size), indexCount,
+							   static_cast<int32>(subMesh.vertexOffset)});
+		};
+		for (const SubMesh &subMesh: m_subMeshes)
+		{
+			encodeRange(subMesh, subMesh.indexOffset, subMesh.indexCount);
+		}
+		for (const SubMesh &subMesh: m_subMeshes)
+		{
+			for (uint32 lod = subMesh.lodOffset; lod < subMesh.lodOffset + subMesh.lodCount; lod++)
+			{
+				encodeRange(subMesh, m_lods[lod].indexOffset, m_lods[lod].indexCount);
 			}
 		}
+		return encoded;
+	}
 
-		subMesh.indexCount = static_cast<uint32>(m_indices.size()) - subMesh.indexOffset;
-		m_subMeshes.push_back(subMesh);
+	void Mesh::createBuffers(const EncodedBuffers &encoded)
+	{
+		m_gpuContext->getVertexBufferPool().destroy(m_vertexBuffer);
+		m_gpuContext->getVertexBufferPool().destroy(m_positionBuffer);
+		m_vertexBuffer   = m_gpuContext->getVertexBufferPool().create(m_gpuContext, static_cast<uint64>(encoded.vertices.size()));
+		m_positionBuffer = m_gpuContext->getVertexBufferPool().create(m_gpuContext, static_cast<uint64>(encoded.positions.size()));
+
+		LOG_INFO("  Vertex buffer: {}, {} bytes per vertex, {} KiB plus {} KiB of positions", getVertexFormatDesc(m_vertexFormat).name,
+				 getVertexFormatDesc(m_vertexFormat).stride, encoded.vertices.size() / 1024u, encoded.positions.size() / 1024u);
+
+		m_gpuContext->getIndexBufferPool().destroy(m_indexBuffer);
+		m_indexBuffer = m_gpuContext->getIndexBufferPool().create(m_gpuContext, static_cast<uint64>(encoded.indices.size()));
+
+		const uint64 sixteenBitDraws = std::ranges::count(m_draws, nvrhi::Format::R16_UINT, &SubMeshDraw::indexType);
+		LOG_INFO("  Index buffer: {} of {} ranges 16 bit, {} KiB instead of {} KiB", sixteenBitDraws, m_draws.size(), encoded.indices.size() / 1024u,
+				 m_indices.size() * sizeof(uint32) / 1024u);
 	}
 
-	void Mesh::createVertexBuffer()
+	void Mesh::uploadAllBuffers(const EncodedBuffers &encoded)
 	{
-		const vk::DeviceSize bufferSize = m_vertices.size() * sizeof(Vertex);
+		createBuffers(encoded);
 
-		m_vertexBuffer = std::make_shared<gpu::VertexBuffer>(m_gpuContext, m_vertices.data(), bufferSize);
+		// Not through the ring's part, which only holds what one frame can stream. nvrhi stages the whole mesh for the
+		// command list, the copies are submitted right away
+		gpu::StagingRing &   ring         = m_gpuContext->getStagingRing();
+		nvrhi::ICommandList *command_list = ring.getCommandList();
+		m_gpuContext->getVertexBufferPool()[m_vertexBuffer].write(command_list, 0u, encoded.vertices.data(), encoded.vertices.size());
+		m_gpuContext->getVertexBufferPool()[m_positionBuffer].write(command_list, 0u, encoded.positions.data(), encoded.positions.size());
+		m_gpuContext->getIndexBufferPool()[m_indexBuffer].write(command_list, 0u, encoded.indices.data(), encoded.indices.size());
+		ring.submit();
 	}
 
-	void Mesh::createIndexBuffer()
+	uint64 Mesh::uploadBuffers(const EncodedBuffers &encoded, const uint64 uploadOffset, const uint64 maxBytes)
 	{
-		const vk::DeviceSize bufferSize = m_indices.size() * sizeof(uint32);
+		uint64     written     = 0u;
+		uint64     bufferStart = 0u;
+		bool       ringFull    = false;
+		const auto uploadRange = [&](auto &buffer, const std::span<const uint8> data)
+		{
+			const uint64 offset = uploadOffset + written;
+			if (!ringFull && written < maxBytes && offset >= bufferStart && offset < bufferStart + data.size())
+			{
+				const uint64 begin = offset - bufferStart;
+				const uint64 size  = std::min(data.size() - begin, maxBytes - written);
+				// The ring running out early leaves the rest to the next frame
+				ringFull = !buffer.write(begin, data.data() + begin, size);
+				if (!ringFull)
+					written += size;
+			}
+			bufferStart += data.size();
+		};
 
-		m_indexBuffer = std::make_shared<gpu::IndexBuffer>(m_gpuContext, m_indices.data(), bufferSize);
+		uploadRange(m_gpuContext->getVertexBufferPool()[m_vertexBuffer], encoded.vertices);
+		uploadRange(m_gpuContext->getVertexBufferPool()[m_positionBuffer], encoded.positions);
+		uploadRange(m_gpuContext->getIndexBufferPool()[m_indexBuffer], encoded.indices);
+		return written;
 	}
 }
@@ -6,110 +6,214 @@
 
 #include <glm/glm.hpp>
 
+#include <span>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "system_types.h"
+#include "memory/tracked_allocator.hpp"
 
+#include "bvh.hpp"
+#include "mesh_bounds.hpp"
+#include "mesh_simplifier.hpp"
+#include "meshlet.hpp"
 #include "index_buffer.hpp"
 #include "texture.hpp"
 #include "vertex_buffer.hpp"
+#include "vertex_format.hpp"
 
 namespace toaster
 {
-	struct Vertex
+	// The indices of a submesh and of its LODs are relative to its vertexOffset, the draws add it back. Trivial, so it
+	// goes through io::StreamWriter::writeRaw() and StreamReader::read() as it is and sits in cooked files in place
+	struct SubMesh
 	{
-		glm::vec3 position;
-		glm::vec3 normal;
-		glm::vec2 texCoord;
-		glm::vec3 tangent;
-
-		static vk::VertexInputBindingDescription getBindingDescription()
-		{
-			vk::VertexInputBindingDescription binding{};
-			binding.binding   = 0;
-			binding.stride    = sizeof(Vertex);
-			binding.inputRate = vk::VertexInputRate::eVertex;
-			return binding;
-		}
-
-		static std::array<vk::VertexInputAttributeDescription, 4> getAttributeDescriptions()
-		{
-			std::array<vk::VertexInputAttributeDescription, 4> attributeDescriptions{};
-			
-			// Position
-			attributeDescriptions[0].binding  = 0;
-			attributeDescriptions[0].location = 0;
-			attributeDescriptions[0].offset   = offsetof(Vertex, position);
-			attributeDescriptions[0].format   = vk::Format::eR32G32B32Sfloat;
-
-			// Normal
-			attributeDescriptions[1].binding  = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].offset   = offsetof(Vertex, normal);
-			attributeDescriptions[1].format   = vk::Format::eR32G32B32Sfloat;
-
-			// TexCoord
-			attributeDescriptions[2].binding  = 0;
-			attributeDescriptions[2].location = 2;
-			attributeDescriptions[2].offset   = offsetof(Vertex, texCoord);
-			attributeDescriptions[2].format   = vk::Format::eR32G32Sfloat;
-
-			// Tangent
-			attributeDescriptions[3].binding  = 0;
-			attributeDescriptions[3].location = 3;
-			attributeDescriptions[3].offset   = offsetof(Vertex, tangent);
-			attributeDescriptions[3].format   = vk::Format::eR32G32B32Sfloat;
-
-			return attributeDescriptions;
-		}
+		uint32 indexOffset;
+		uint32 indexCount;
+		uint32 vertexOffset;
+		uint32 vertexCount;
+		uint32 meshletOffset; // Into Mesh::getMeshlets(), none for submeshes that are not triangle lists
+		uint32 meshletCount;
+		uint32 lodOffset; // Into Mesh::getLods(), coarser levels follow finer ones
+		uint32 lodCount;
+
+		// Mesh space bounds of the submesh's vertices, for culling and sorting by distance
+		glm::vec3                boundsMin;
+		glm::vec3                boundsMax;
+		geometry::BoundingSphere boundingSphere;
+
+		// Of the full detail triangles, none for submeshes that are not triangle lists. For the LOD and texture
+		// streaming heuristics, see geometry::SurfaceStats
+		uint32 triangleCount;
+		float  surfaceArea;
+		float  uvDensity;
 	};
 
-	struct SubMesh
+	static_assert(std::is_trivial_v<SubMesh>);
+
+	// A simplified level of a submesh: another range of the index buffer over the same vertices
+	struct SubMeshLod
 	{
 		uint32 indexOffset;
 		uint32 indexCount;
-		uint32 vertexOffset;
+		float  error; // Object space distance from the full detail surface, pick the level by its projected size
+	};
+
+	// Submeshes with fewer than this many vertices get 16 bit indices on the GPU. 0xFFFF stays unused, it is the
+	// primitive restart index
+	constexpr uint32 c_maxVerticesFor16BitIndices{65'536u};
+
+	// What the index buffer binding and drawIndexed() need for one level of a submesh. The index buffer is bound at
+	// offset 0 with indexType, either R16_UINT or R32_UINT, vertexOffset is the draw's base vertex
+	struct SubMeshDraw
+	{
+		nvrhi::Format indexType;
+		uint32        firstIndex; // In indexType units
+		uint32        indexCount;
+		int32         vertexOffset;
+	};
+
+	// Where a mesh is on its way to being drawable. Only eResident meshes have GPU buffers to draw from, MeshStreamer
+	// moves its meshes through every state in order, loadFromFile() goes straight from eLoading to eResident
+	enum class EMeshState : uint8
+	{
+		eUnloaded,
+		eQueued,    // Waiting for a free loading slot, closest to the camera first
+		eLoading,   // Cooked load or import, conversion and encoding on a worker thread
+		eCPUReady,  // Encoded, waiting for upload budget
+		eUploading, // Buffers created, written a slice per frame
+		eResident,
+		eFailed,
 	};
 
+	class MeshStreamer;
+
 	class Mesh
 	{
 	public:
+		TST_DECLARE_TAGGED_NEW(memory::EMemoryTag::eMesh)
+
 		Mesh() = default;
 		~Mesh();
 
-		bool loadFromFile(const std::string &filePath, gpu::GPUContext *gpuContext);
-		
+		// Meshes live in a HandlePool, so they need to be movable. The moved-from mesh releases nothing
+		Mesh(Mesh &&p_other) noexcept;
+		Mesh &operator=(Mesh &&p_other) noexcept;
+
+		Mesh(const Mesh &)            = delete;
+		Mesh &operator=(const Mesh &) = delete;
+
+		// Loads the cooked <filePath>.tmesh next to the source if it is still up to date, otherwise imports the source
+		// with Assimp and cooks it for next time. A .tmesh path is loaded as it is, without a source to check against.
+		// Cooked files built with other LOD settings are re-cooked. The vertex buffer is encoded in vertexFormat, the
+		// position buffer always in EVertexFormat::ePosition. It uploads the whole mesh at once, whatever it costs the
+		// frame, MeshStreamer spreads the upload over frames instead
+		bool loadFromFile(const std::string &filePath, gpu::GPUContext *gpuContext, EVertexFormat vertexFormat = EVertexFormat::eStandard,
+						  const geometry::LodSettings &lodSettings = {});
+		// CPU side only, fills the vertices, indices, submeshes and bounds from the cooked file or the source the same
+		// way loadFromFile() does, without creating any buffers. Safe on any thread, for tools and benchmarks
+		bool loadMeshData(const std::string &filePath, const geometry::LodSettings &lodSettings = {});
+
 		void destroy();
 
-		[[nodiscard]] std::shared_ptr<gpu::VertexBuffer> getVertexBuffer() const { return m_vertexBuffer; }
-		[[nodiscard]] std::shared_ptr<gpu::IndexBuffer>  getIndexBuffer() const { return m_indexBuffer; }
-		[[nodiscard]] uint32                             getIndexCount() const { return static_cast<uint32>(m_indices.size()); }
-		[[nodiscard]] uint32                             getVertexCount() const { return static_cast<uint32>(m_vertices.size()); }
-		[[nodiscard]] const std::vector<SubMesh> &       getSubMeshes() const { return m_subMeshes; }
-		[[nodiscard]] bool                               isLoaded() const { return m_isLoaded; }
+		// Resolve through GPUContext::getVertexBufferPool() / getIndexBufferPool()
+		[[nodiscard]] gpu::VertexBufferHandle      getVertexBuffer() const { return m_vertexBuffer; }
+		[[nodiscard]] gpu::VertexBufferHandle      getPositionBuffer() const { return m_positionBuffer; }
+		[[nodiscard]] gpu::IndexBufferHandle       getIndexBuffer() const { return m_indexBuffer; }
+		[[nodiscard]] EVertexFormat                getVertexFormat() const { return m_vertexFormat; }
+		[[nodiscard]] uint32                       getIndexCount() const { return static_cast<uint32>(m_indices.size()); }
+		[[nodiscard]] uint32                       getVertexCount() const { return static_cast<uint32>(m_vertices.size()); }
+		[[nodiscard]] std::span<const SubMesh>     getSubMeshes() const { return m_subMeshes; }
+		[[nodiscard]] std::span<const SubMeshLod>  getLods() const { return m_lods; }
+		[[nodiscard]] std::span<const Vertex>      getVertices() const { return m_vertices; }
+		[[nodiscard]] std::span<const uint32>      getIndices() const { return m_indices; }
+		[[nodiscard]] const geometry::MeshletData &getMeshlets() const { return m_meshlets; }
+		[[nodiscard]] const glm::vec3 &            getBoundsMin() const { return m_boundsMin; }
+		[[nodiscard]] const glm::vec3 &            getBoundsMax() const { return m_boundsMax; }
+		[[nodiscard]] geometry::BoundingSphere     getBoundingSphere() const { return m_boundingSphere; }
+		[[nodiscard]] EMeshState                   getState() const { return m_state; }
+		[[nodiscard]] bool                         isLoaded() const { return m_state == EMeshState::eResident; }
+
+		// One per submesh, the quantized positions of a submesh decode with its grid
+		[[nodiscard]] std::span<const tsm::QuantizationGrid> getQuantizationGrids() const { return m_quantizationGrids; }
+
+		// lod 0 is the full detail level, lod n the submesh's getLods()[lodOffset + n - 1]. Valid once the buffers exist
+		[[nodiscard]] const SubMeshDraw &getSubMeshDraw(uint32 subMeshIndex, uint32 lod = 0u) const;
+
+		// CPU side positions and full detail indices of one submesh for geometry::Bvh::build(), valid while the mesh
+		// is loaded. Triangle ids and vertex indices are the submesh's own
+		[[nodiscard]] geometry::TriangleMeshView getTriangleView(const uint32 subMeshIndex) const
+		{
+			const SubMesh &subMesh = m_subMeshes[subMeshIndex];
+			return {&(m_vertices.data() + subMesh.vertexOffset)->position, sizeof(Vertex), subMesh.vertexCount, std::span(m_indices).subspan(subMesh.indexOffset, subMesh.indexCount)};
+		}
 
 
 	private:
-		void processNode(aiNode *node, const aiScene *scene);
-		void processMesh(aiMesh *mesh, const aiScene *scene);
-
-		void createVertexBuffer();
-		void createIndexBuffer();
+		friend class MeshStreamer;
+
+		// Reads the file with Assimp into m_vertices, m_indices and m_subMeshes
+		bool importFile(const std::string &filePath, const geometry::LodSettings &lodSettings);
+		// sourceHash and lodSettings are null when there is no source to check the cooked file against
+		bool loadCooked(const std::filesystem::path &cookedPath, const uint64 *sourceHash, const geometry::LodSettings *lodSettings);
+		bool writeCooked(const std::filesystem::path &cookedPath, uint64 sourceHash, uint64 sourceSize, const geometry::LodSettings &lodSettings) const;
+		// The whole mesh's box and sphere, the submeshes get theirs in convertScene()
+		void computeBounds();
+		// Merges the scene's meshes with the node transforms baked in. Sizes the arrays up front, converts the meshes
+		// in parallel straight into their slices, then reorders each one for the vertex cache, overdraw and fetch,
+		// splits it into meshlets and simplifies it into LODs
+		void convertScene(const aiScene *scene, const geometry::LodSettings &lodSettings);
+
+		// The GPU buffers' contents: m_vertices in m_vertexFormat and as positions only, each submesh quantized on its
+		// own grid, and m_indices in 16 bits for every submesh small enough
+		struct EncodedBuffers
+		{
+			memory::TrackedVector<uint8, memory::EMemoryTag::eMesh> vertices;
+			memory::TrackedVector<uint8, memory::EMemoryTag::eMesh> positions;
+			memory::TrackedVector<uint8, memory::EMemoryTag::eMesh> indices;
+
+			// Bytes to upload, the buffers back to back in the order above
+			[[nodiscard]] uint64 getSize() const { return vertices.size() + positions.size() + indices.size(); }
+		};
+
+		// CPU side only, also fills m_quantizationGrids and m_draws. Runs on the loading thread
+		EncodedBuffers encodeBuffers();
+		// Creates the buffers empty, uploadBuffers() fills them. Main thread only, like the buffer pools
+		void createBuffers(const EncodedBuffers &encoded);
+		// Writes up to maxBytes of encoded from uploadOffset on, counted over EncodedBuffers::getSize(), and returns how
+		// many it wrote
+		uint64 uploadBuffers(const EncodedBuffers &encoded, uint64 uploadOffset, uint64 maxBytes);
+		// Both at once for the blocking and coroutine loads, whatever the size
+		void uploadAllBuffers(const EncodedBuffers &encoded);
 
 		std::filesystem::path m_path;
 		std::filesystem::path m_directory; // Directory containing the mesh file
 
 		gpu::GPUContext *m_gpuContext{nullptr};
 
-		std::vector<Vertex>       m_vertices;
-		std::vector<uint32>       m_indices;
-		std::vector<SubMesh>      m_subMeshes;
+		memory::TrackedVector<Vertex, memory::EMemoryTag::eMesh>                m_vertices;
+		memory::TrackedVector<uint32, memory::EMemoryTag::eMesh>                m_indices;
+		memory::TrackedVector<SubMesh, memory::EMemoryTag::eMesh>               m_subMeshes;
+		memory::TrackedVector<SubMeshLod, memory::EMemoryTag::eMesh>            m_lods;
+		memory::TrackedVector<tsm::QuantizationGrid, memory::EMemoryTag::eMesh> m_quantizationGrids;
+		memory::TrackedVector<SubMeshDraw, memory::EMemoryTag::eMesh>           m_draws; // Every submesh's full detail level, then one per LOD
+		geometry::MeshletData                                                   m_meshlets;
+
+		uint32 m_lodIndexOffset{0u}; // The LODs' indices follow every submesh's full detail ones
 
-		std::shared_ptr<gpu::VertexBuffer> m_vertexBuffer{nullptr};
-		std::shared_ptr<gpu::IndexBuffer>  m_indexBuffer{nullptr};
+		glm::vec3                m_boundsMin{0.0f};
+		glm::vec3                m_boundsMax{0.0f};
+		geometry::BoundingSphere m_boundingSphere{glm::vec3(0.0f), 0.0f};
 
-		bool m_isLoaded{false};
-		bool m_materialsLoaded{false};
+		EVertexFormat           m_vertexFormat{EVertexFormat::eStandard};
+		gpu::VertexBufferHandle m_vertexBuffer;
+		gpu::VertexBufferHandle m_positionBuffer;
+		gpu::IndexBufferHandle  m_indexBuffer;
+
+		EMeshState m_state{EMeshState::eUnloaded};
+		bool       m_materialsLoaded{false};
 	};
+
+	using MeshHandle = memory::Handle<Mesh>;
 }
@@ -0,0 +1,232 @@
+#include "mesh_streamer.hpp"
+#include "gpu_context.hpp"
+#include "logging.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace toaster
+{
+	MeshStreamer::MeshStreamer(memory::HandlePool<Mesh, memory::EMemoryTag::eMesh> *meshes, gpu::GPUContext *gpuContext, const MeshStreamerSettings &settings)
+		: m_meshes(meshes), m_gpuContext(gpuContext), m_settings(settings)
+	{
+		TST_ASSERT_MSG(m_settings.uploadBytesPerFrame > 0u && m_settings.maxLoadsInFlight > 0u, "Mesh streamer would never finish a mesh");
+	}
+
+	MeshStreamer::~MeshStreamer()
+	{
+		cancelAll();
+		jobs::waitFor(m_loadJobs);
+		m_requests.clear();
+	}
+
+	MeshHandle MeshStreamer::request(std::string filePath, const glm::vec3 &position, const float radius, const EVertexFormat vertexFormat,
+									 const geometry::LodSettings &lodSettings)
+	{
+		const auto [first, last] = m_streamed.equal_range(filePath);
+		for (auto it = first; it != last; ++it)
+		{
+			const StreamedMesh &streamed = it->second;
+			if (streamed.vertexFormat != vertexFormat || streamed.lodSettings != lodSettings)
+				continue;
+
+			// A destroyed or cancelled one is requested anew
+			const Mesh *mesh = m_meshes->get(streamed.handle);
+			if (mesh == nullptr || mesh->m_state == EMeshState::eUnloaded)
+			{
+				m_streamed.erase(it);
+				break;
+			}
+
+			for (const std::unique_ptr<Request> &pending: m_requests)
+			{
+				if (pending->handle == streamed.handle && !pending->cancelled.load(std::memory_order_relaxed))
+					place(*pending, position, radius);
+			}
+			return streamed.handle;
+		}
+
+		const MeshHandle handle     = m_meshes->create();
+		(*m_meshes)[handle].m_state = EMeshState::eQueued;
+		m_streamed.emplace(filePath, StreamedMesh{vertexFormat, lodSettings, handle});
+
+		auto pending          = std::make_unique<Request>();
+		pending->handle       = handle;
+		pending->filePath     = std::move(filePath);
+		pending->vertexFormat = vertexFormat;
+		pending->lodSettings  = lodSettings;
+		place(*pending, position, radius);
+		m_requests.push_back(std::move(pending));
+		return handle;
+	}
+
+	void MeshStreamer::setPlacement(const MeshHandle mesh, const glm::vec3 &position, const float radius)
+	{
+		for (const std::unique_ptr<Request> &request: m_requests)
+		{
+			if (request->handle == mesh && !request->cancelled.load(std::memory_order_relaxed))
+				place(*request, position, radius);
+		}
+	}
+
+	bool MeshStreamer::cancel(const MeshHandle mesh)
+	{
+		bool cancelled = false;
+		for (const std::unique_ptr<Request> &request: m_requests)
+		{
+			if (request->handle == mesh && !request->cancelled.exchange(true, std::memory_order_relaxed))
+			{
+				setMeshState(*request, EMeshState::eUnloaded);
+				cancelled = true;
+			}
+		}
+
+		// Whatever a worker isn't busy with goes now, partially uploaded buffers included
+		std::erase_if(m_requests, [](const std::unique_ptr<Request> &request)
+		{
+			return request->cancelled.load(std::memory_order_relaxed) && request->state.load(std::memory_order_acquire) != EMeshState::eLoading;
+		});
+		return cancelled;
+	}
+
+	void MeshStreamer::cancelAll()
+	{
+		for (const std::unique_ptr<Request> &request: m_requests)
+		{
+			if (!request->cancelled.exchange(true, std::memory_order_relaxed))
+				setMeshState(*request, EMeshState::eUnloaded);
+		}
+		std::erase_if(m_requests, [](const std::unique_ptr<Request> &request) { return request->state.load(std::memory_order_acquire) != EMeshState::eLoading; });
+	}
+
+	void MeshStreamer::update(const glm::vec3 &cameraPosition)
+	{
+		m_cameraPosition     = cameraPosition;
+		uint32 loadsInFlight = 0u;
+		for (const std::unique_ptr<Request> &request: m_requests)
+		{
+			// Destroying the mesh in its pool is as good as cancelling it
+			if (!m_meshes->isAlive(request->handle))
+				request->cancelled.store(true, std::memory_order_relaxed);
+
+			const EMeshState state = request->state.load(std::memory_order_relaxed);
+			loadsInFlight += state == EMeshState::eLoading || state == EMeshState::eCPUReady || state == EMeshState::eUploading;
+			request->distance = std::max(glm::distance(request->position, cameraPosition) - request->radius, 0.0f);
+			request->placed   = false;
+		}
+
+		// Closest first for both the loading slots and the upload budget
+		std::ranges::sort(m_requests, {}, [](const std::unique_ptr<Request> &request) { return request->distance; });
+
+		// Whatever else the frame staged comes off the budget too
+		const uint64 frameBudget = std::min(m_settings.uploadBytesPerFrame, m_gpuContext->getStagingRing().getFreeBytes());
+		uint64       budget      = frameBudget;
+		for (const std::unique_ptr<Request> &request: m_requests)
+		{
+			if (request->cancelled.load(std::memory_order_relaxed))
+				continue;
+
+			switch (request->state.load(std::memory_order_acquire))
+			{
+				case EMeshState::eQueued:
+				{
+					if (loadsInFlight < m_settings.maxLoadsInFlight)
+					{
+						startLoad(*request);
+						++loadsInFlight;
+					}
+					break;
+				}
+				case EMeshState::eCPUReady:
+				case EMeshState::eUploading:
+				{
+					if (budget > 0u && upload(*request, budget))
+						continue;
+					break;
+				}
+				case EMeshState::eFailed:
+				{
+					LOG_ERROR("Failed to stream mesh '{}'", request->filePath);
+					break;
+				}
+				default:
+					break;
+			}
+			setMeshState(*request, request->state.load(std::memory_order_relaxed));
+		}
+
+		m_lastFrameUploadBytes = frameBudget - budget;
+
+		std::erase_if(m_requests, [](const std::unique_ptr<Request> &request)
+		{
+			const EMeshState state = request->state.load(std::memory_order_acquire);
+			return state == EMeshState::eResident || state == EMeshState::eFailed || (request->cancelled.load(std::memory_order_relaxed) && state != EMeshState::eLoading);
+		});
+	}
+
+	uint32 MeshStreamer::getPendingCount() const
+	{
+		return static_cast<uint32>(std::ranges::count_if(m_requests, [](const std::unique_ptr<Request> &request)
+		{
+			return !request->cancelled.load(std::memory_order_relaxed);
+		}));
+	}
+
+	void MeshStreamer::startLoad(Request &request)
+	{
+		request.mesh.m_path         = request.filePath;
+		request.mesh.m_gpuContext   = m_gpuContext;
+		request.mesh.m_vertexFormat = request.vertexFormat;
+		request.state.store(EMeshState::eLoading, std::memory_order_relaxed);
+
+		// Never on the main thread, an import can take longer than a frame. The request outlives the job, cancelled or not
+		jobs::run([&request]
+		{
+			bool loaded = !request.cancelled.load(std::memory_order_relaxed) && request.mesh.loadMeshData(request.filePath, request.lodSettings);
+			if (loaded && !request.cancelled.load(std::memory_order_relaxed))
+				request.encoded = request.mesh.encodeBuffers();
+			else
+				loaded = false;
+
+			request.state.store(loaded ? EMeshState::eCPUReady : EMeshState::eFailed, std::memory_order_release);
+		}, &m_loadJobs, jobs::EJobAffinity::eWorkerThread);
+	}
+
+	bool MeshStreamer::upload(Request &request, uint64 &budget)
+	{
+		if (request.state.load(std::memory_order_relaxed) == EMeshState::eCPUReady)
+		{
+			request.mesh.createBuffers(request.encoded);
+			request.state.store(EMeshState::eUploading, std::memory_order_relaxed);
+		}
+
+		const uint64 written = request.mesh.uploadBuffers(request.encoded, request.uploadOffset, budget);
+		request.uploadOffset += written;
+		budget -= written;
+		if (request.uploadOffset < request.encoded.getSize())
+			return false;
+
+		// Complete, the mesh takes over its slot in the pool and the encoded copies go with the request
+		request.mesh.m_state        = EMeshState::eResident;
+		(*m_meshes)[request.handle] = std::move(request.mesh);
+		request.state.store(EMeshState::eResident, std::memory_order_relaxed);
+		return true;
+	}
+
+	void MeshStreamer::setMeshState(const Request &request, const EMeshState state)
+	{
+		if (Mesh *mesh = m_meshes->get(request.handle))
+			mesh->m_state = state;
+	}
+
+	void MeshStreamer::place(Request &request, const glm::vec3 &position, const float radius) const
+	{
+		// Measured from where the camera was at the last update(), the next one measures the kept sphere again
+		if (request.placed && glm::distance(position, m_cameraPosition) - radius >= glm::distance(request.position, m_cameraPosition) - request.radius)
+			return;
+
+		request.position = position;
+		request.radius   = radius;
+		request.placed   = true;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+#include "jobs/job_system.hpp"
+#include "memory/handle_pool.hpp"
+
+#include "mesh.hpp"
+
+namespace toaster
+{
+	struct MeshStreamerSettings
+	{
+		uint64 uploadBytesPerFrame{16u << 20u}; // Staging writes per update() at most, the StagingRing may have less left
+		uint32 maxLoadsInFlight{4u};            // Meshes between eLoading and eUploading at once, bounds the CPU copies held
+	};
+
+	// Streams meshes into a HandlePool<Mesh> without the frame ever waiting on one. request() only queues the mesh,
+	// update() starts the closest queued ones on worker threads and uploads the loaded ones within a per-frame budget
+	// of the GPU context's StagingRing, closest first. A streamed mesh sits empty in its pool until it turns eResident, see EMeshState.
+	// Every file is streamed once per vertex format and LOD settings, requests for one already streamed or on its way
+	// share its handle. Main thread only
+	class MeshStreamer
+	{
+	public:
+		MeshStreamer(memory::HandlePool<Mesh, memory::EMemoryTag::eMesh> *meshes, gpu::GPUContext *gpuContext, const MeshStreamerSettings &settings = {});
+		// Cancels everything and waits for the loads running on workers, so it has to go before the job system does
+		~MeshStreamer();
+
+		MeshStreamer(const MeshStreamer &)            = delete;
+		MeshStreamer &operator=(const MeshStreamer &) = delete;
+
+		// Creates an empty mesh in the pool and queues it, or returns the mesh an earlier request for the same file, format
+		// and LOD settings made if it is still alive and not cancelled. position and radius are the world space sphere it
+		// will be drawn in, loads are ordered by that sphere's distance to the camera, a shared mesh by its closest one
+		MeshHandle request(std::string filePath, const glm::vec3 &position, float radius = 0.0f, EVertexFormat vertexFormat = EVertexFormat::eStandard,
+						   const geometry::LodSettings &lodSettings = {});
+		// For meshes that move before they are resident, ignored for any other. A mesh requested more than once keeps the
+		// closest of the spheres it is given between two update() calls
+		void setPlacement(MeshHandle mesh, const glm::vec3 &position, float radius);
+
+		// Drops a queued, loading or uploading mesh and returns it to EMeshState::eUnloaded, false if it had nothing
+		// pending, for everything sharing it. An import already running on a worker can't be interrupted, it finishes there and is thrown away.
+		// Destroying a mesh in its pool cancels it too, on the next update()
+		bool cancel(MeshHandle mesh);
+		void cancelAll();
+
+		// Once per frame
+		void update(const glm::vec3 &cameraPosition);
+
+		// Requests not yet resident or failed
+		[[nodiscard]] uint32 getPendingCount() const;
+		[[nodiscard]] uint64 getLastFrameUploadBytes() const { return m_lastFrameUploadBytes; }
+
+	private:
+		struct Request
+		{
+			MeshHandle            handle;
+			std::string           filePath;
+			EVertexFormat         vertexFormat;
+			geometry::LodSettings lodSettings;
+			glm::vec3             position;
+			float                 radius;
+			float                 distance{0.0f}; // From the camera at the last update(), minus the radius
+			bool                  placed{false};  // Since the last update(), later placements only move it closer
+
+			// Loaded here off the pool, pool pointers don't survive its growth. Moved in once uploaded
+			Mesh                 mesh;
+			Mesh::EncodedBuffers encoded;
+			uint64               uploadOffset{0u};
+
+			// The worker only ever moves eLoading on to eCPUReady or eFailed, everything else happens on the main thread
+			std::atomic<EMeshState> state{EMeshState::eQueued};
+			std::atomic<bool>       cancelled{false};
+		};
+
+		void startLoad(Request &request);
+		// False if the budget ran out before the upload finished
+		bool upload(Request &request, uint64 &budget);
+		void setMeshState(const Request &request, EMeshState state);
+		void place(Request &request, const glm::vec3 &position, float radius) const;
+
+		struct StreamedMesh
+		{
+			EVertexFormat         vertexFormat;
+			geometry::LodSettings lodSettings;
+			MeshHandle            handle;
+		};
+
+		memory::HandlePool<Mesh, memory::EMemoryTag::eMesh> *m_meshes;
+		gpu::GPUContext *                                    m_gpuContext;
+		MeshStreamerSettings                                 m_settings;
+
+		// Stable addresses, the load jobs hold on to theirs. Cancelled ones stay until their job is done with them
+		std::vector<std::unique_ptr<Request>> m_requests;
+		jobs::JobCounter                      m_loadJobs;
+		// Everything requested by file path, resident or not, for sharing
+		std::unordered_multimap<std::string, StreamedMesh> m_streamed;
+
+		glm::vec3 m_cameraPosition{0.0f};
+
+		uint64 m_lastFrameUploadBytes{0u};
+	};
+}
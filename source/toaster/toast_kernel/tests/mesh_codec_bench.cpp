@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "test_models.hpp"
+#include "mesh.hpp"
+#include "mesh_codec.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	struct ReferenceCodec
+	{
+		const char *model;
+		const char *codec;
+		double      ratio;    // Percent of the raw size
+		double      decodeMs; // Best of 5, 0 where it wasn't timed
+	};
+
+	// zlib and Draco are not linked into the tree, these were measured out of tree on the same data: one core, GCC -O2.
+	// zlib compressed the raw vertex and index bytes. Draco got LOD 0 only, quantized at 14/10/12/10 bits for
+	// position/normal/uv/tangent, which is lossy
+	constexpr ReferenceCodec c_referenceCodecs[] = {
+		{"2CylinderEngine.glb", "zlib level 1", 30.4, 33.0},
+		{"2CylinderEngine.glb", "zlib level 6", 26.6, 26.0},
+		{"2CylinderEngine.glb", "zlib level 9", 26.5, 29.0},
+		{"2CylinderEngine.glb", "codec, then zlib level 6", 22.1, 0.0},
+		{"2CylinderEngine.glb", "Draco lossless", 74.3, 41.0},
+		{"2CylinderEngine.glb", "Draco quantized", 7.9, 59.0},
+		{"Wuson.ply", "zlib level 6", 39.5, 2.9},
+		{"Wuson.ply", "Draco lossless", 92.6, 0.0},
+		{"Wuson.ply", "Draco quantized", 19.5, 0.0},
+	};
+}
+
+// Size and decode speed of the geometry codecs on the imported and optimized test models, the data cooked files
+// store. Vertices are the full Vertex, indices every level of detail
+TST_BENCHMARK(meshCodec)
+{
+	jobs::initialize({});
+
+	for (const char *model: test::c_testModels)
+	{
+		const std::filesystem::path path = test::copyTestModel(model);
+		Mesh                        mesh;
+		if (path.empty() || !mesh.loadMeshData(path.string()))
+		{
+			std::printf("  %s is missing\n", model);
+			continue;
+		}
+
+		const std::span<const Vertex> vertices = mesh.getVertices();
+		const std::span<const uint32> indices  = mesh.getIndices();
+
+		std::vector<uint8> encoded_vertices, encoded_indices;
+		const double encode_ns = test::measureNs([&]
+		{
+			encoded_vertices.clear();
+			encoded_indices.clear();
+			geometry::encodeVertexBuffer(vertices.data(), vertices.size(), sizeof(Vertex), encoded_vertices);
+			geometry::encodeIndexBuffer(indices, encoded_indices);
+		}, 3u);
+
+		std::vector<Vertex> decoded_vertices(vertices.size());
+		std::vector<uint32> decoded_indices(indices.size());
+		bool                decoded = true;
+		const double        vertex_ns = test::measureNs([&]
+		{
+			decoded &= geometry::decodeVertexBuffer(decoded_vertices.data(), vertices.size(), sizeof(Vertex), encoded_vertices);
+		}, 10u);
+		const double index_ns = test::measureNs([&]
+		{
+			decoded &= geometry::decodeIndexBuffer(decoded_indices.data(), indices.size(), encoded_indices);
+		}, 10u);
+		TST_CHECK(decoded);
+		TST_CHECK(std::equal(vertices.begin(), vertices.end(), decoded_vertices.begin(), [](const Vertex &p_a, const Vertex &p_b)
+		{
+			return std::memcmp(&p_a, &p_b, sizeof(Vertex)) == 0;
+		}));
+
+		// The index codec may rotate a triangle, never change its winding
+		bool same_triangles = true;
+		for (uint64 i = 0u; i < indices.size(); i += 3u)
+		{
+			const uint32 *a = &indices[i];
+			const uint32 *b = &decoded_indices[i];
+			same_triangles &= (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]) || (a[0] == b[1] && a[1] == b[2] && a[2] == b[0]) ||
+							  (a[0] == b[2] && a[1] == b[0] && a[2] == b[1]);
+		}
+		TST_CHECK(same_triangles);
+
+		const double vertex_bytes = static_cast<double>(vertices.size_bytes());
+		const double index_bytes  = static_cast<double>(indices.size_bytes());
+		std::printf("  %s: vertices %.1f%% of %.0f KiB, indices %.1f%% of %.0f KiB\n", path.filename().string().c_str(),
+					100.0 * static_cast<double>(encoded_vertices.size()) / vertex_bytes, vertex_bytes / 1024.0,
+					100.0 * static_cast<double>(encoded_indices.size()) / index_bytes, index_bytes / 1024.0);
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s, encode", path.filename().string().c_str());
+		test::report(name, encode_ns, vertex_bytes + index_bytes);
+		std::snprintf(name, sizeof(name), "%s, decode vertices (%.2f GB/s)", path.filename().string().c_str(), vertex_bytes / vertex_ns);
+		test::report(name, vertex_ns, vertex_bytes);
+		std::snprintf(name, sizeof(name), "%s, decode indices (%.2f GB/s)", path.filename().string().c_str(), index_bytes / index_ns);
+		test::report(name, index_ns, index_bytes);
+	}
+
+	std::printf("  For comparison, measured out of tree:\n");
+	for (const ReferenceCodec &reference: c_referenceCodecs)
+	{
+		if (reference.decodeMs > 0.0)
+			std::printf("    %s, %s: %.1f%%, decode %.1f ms\n", reference.model, reference.codec, reference.ratio, reference.decodeMs);
+		else
+			std::printf("    %s, %s: %.1f%%\n", reference.model, reference.codec, reference.ratio);
+	}
+
+	jobs::shutdown();
+}
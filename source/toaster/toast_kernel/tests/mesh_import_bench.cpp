@@ -0,0 +1,134 @@
+#include <cstdio>
+
+#include "toast_bench.hpp"
+#include "test_models.hpp"
+#include "mesh.hpp"
+#include "jobs/job_system.hpp"
+#include "memory/small_object_allocator.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	struct JobSystemScope
+	{
+		explicit JobSystemScope(const uint32 p_worker_threads = jobs::JobSystemSettings::c_autoWorkerThreads) { jobs::initialize({.workerThreads = p_worker_threads}); }
+		~JobSystemScope() { jobs::shutdown(); }
+	};
+
+	double measureColdImport(const std::filesystem::path &p_path)
+	{
+		return test::measureNs([&]
+		{
+			test::removeCookedModel(p_path);
+
+			Mesh mesh;
+			TST_CHECK(mesh.loadMeshData(p_path.string()));
+			test::doNotOptimize(mesh);
+		}, 3u);
+	}
+}
+
+// Full import of each test model (Assimp, conversion, optimization, LODs, cooking). The allocation heavy part of
+// the engine, run it from builds with and without WITH_TOAST_ALLOCATOR to compare the two
+TST_BENCHMARK(meshImport)
+{
+	JobSystemScope job_system;
+
+	#if TST_TOAST_ALLOCATOR
+	std::printf("Mesh import, operator new through the small object allocator:\n");
+	#else
+	std::printf("Mesh import, operator new through the system allocator:\n");
+	#endif
+
+	for (const char *model: test::c_testModels)
+	{
+		const std::filesystem::path path = test::copyTestModel(model);
+		if (path.empty())
+		{
+			std::printf("  %s is missing\n", model);
+			continue;
+		}
+
+		test::report(path.filename().string().c_str(), measureColdImport(path));
+	}
+
+	#if TST_TOAST_ALLOCATOR
+	memory::logSmallAllocatorStats();
+	#endif
+}
+
+// The same cold import on the main thread alone and with a worker per core. The submeshes are converted from Assimp,
+// optimized and simplified as parallel jobs, Assimp's own import stays on one thread
+TST_BENCHMARK(meshImportScaling)
+{
+	for (const char *model: test::c_testModels)
+	{
+		const std::filesystem::path path = test::copyTestModel(model);
+		if (path.empty())
+		{
+			std::printf("  %s is missing\n", model);
+			continue;
+		}
+
+		double serial_ns = 0.0, parallel_ns = 0.0;
+		uint32 threads = 0u;
+		{
+			JobSystemScope job_system(0u);
+			serial_ns = measureColdImport(path);
+		}
+		{
+			JobSystemScope job_system;
+			threads     = jobs::getWorkerCount();
+			parallel_ns = measureColdImport(path);
+		}
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s, main thread only", path.filename().string().c_str());
+		test::report(name, serial_ns);
+		std::snprintf(name, sizeof(name), "%s, %u threads (%.2fx)", path.filename().string().c_str(), threads, serial_ns / parallel_ns);
+		test::report(name, parallel_ns);
+	}
+}
+
+// What the cooked .tmesh saves: the cold load imports with Assimp and cooks, the warm one hashes the source and
+// loads the up to date .tmesh next to it, the direct one loads the .tmesh without a source to check
+TST_BENCHMARK(meshCookedLoad)
+{
+	JobSystemScope job_system;
+
+	for (const char *model: test::c_testModels)
+	{
+		const std::filesystem::path path = test::copyTestModel(model);
+		if (path.empty())
+		{
+			std::printf("  %s is missing\n", model);
+			continue;
+		}
+		std::filesystem::path cooked = path;
+		cooked += ".tmesh";
+
+		const double cold_ns = measureColdImport(path);
+
+		// The last cold run left a cooked file behind
+		const auto load = [](const std::filesystem::path &p_path)
+		{
+			return test::measureNs([&]
+			{
+				Mesh mesh;
+				TST_CHECK(mesh.loadMeshData(p_path.string()));
+				test::doNotOptimize(mesh);
+			}, 5u);
+		};
+		const double warm_ns   = load(path);
+		const double direct_ns = load(cooked);
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s, import and cook", path.filename().string().c_str());
+		test::report(name, cold_ns);
+		std::snprintf(name, sizeof(name), "%s, cooked (%.0fx)", path.filename().string().c_str(), cold_ns / warm_ns);
+		test::report(name, warm_ns);
+		std::snprintf(name, sizeof(name), "%s, .tmesh only (%.0fx)", path.filename().string().c_str(), cold_ns / direct_ns);
+		test::report(name, direct_ns);
+	}
+}
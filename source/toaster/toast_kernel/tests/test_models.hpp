@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+// Models from Assimp's test set, copied into a scratch directory so the cooked .tmesh files land there and not
+// next to the originals. TST_TEST_MODELS_DIR is set by CMake
+namespace toaster::test
+{
+	// Small to large: an OBJ, a PLY and a glTF with many submeshes
+	inline constexpr const char *c_testModels[]{
+		"OBJ/spider.obj",
+		"PLY/Wuson.ply",
+		"glTF2/2CylinderEngine-glTF-Binary/2CylinderEngine.glb",
+	};
+
+	// Returns the copy's path, or an empty path if the model is missing
+	inline std::filesystem::path copyTestModel(const char *p_model)
+	{
+		const std::filesystem::path source      = std::filesystem::path(TST_TEST_MODELS_DIR) / p_model;
+		const std::filesystem::path scratch_dir = std::filesystem::temp_directory_path() / "toaster_tests";
+
+		std::error_code error;
+		std::filesystem::create_directories(scratch_dir, error);
+
+		const std::filesystem::path copy = scratch_dir / source.filename();
+		if (!std::filesystem::copy_file(source, copy, std::filesystem::copy_options::overwrite_existing, error))
+			return {};
+
+		// Whatever an earlier run cooked would turn the next import into a cooked load
+		std::filesystem::path cooked = copy;
+		cooked += ".tmesh";
+		std::filesystem::remove(cooked, error);
+		return copy;
+	}
+
+	inline void removeCookedModel(const std::filesystem::path &p_model)
+	{
+		std::filesystem::path cooked = p_model;
+		cooked += ".tmesh";
+
+		std::error_code error;
+		std::filesystem::remove(cooked, error);
+	}
+}
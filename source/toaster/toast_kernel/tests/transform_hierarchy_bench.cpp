@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "transform_hierarchy.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+// 1M transforms in 4096 trees of 256: everything dirty, and 1000 scattered edits whose subtrees are recomputed.
+// Serial and as jobs on every hardware thread
+TST_BENCHMARK(transformHierarchyUpdate)
+{
+	constexpr uint32 c_count{1u << 20u};
+	constexpr uint32 c_treeSize{256u};
+
+	TransformHierarchy       hierarchy;
+	std::vector<TransformId> ids;
+	ids.reserve(c_count);
+
+	uint32 state = 2463534242u;
+	const auto next = [&state]
+	{
+		state ^= state << 13u;
+		state ^= state >> 17u;
+		state ^= state << 5u;
+		return state;
+	};
+	for (uint32 i = 0u; i < c_count; i++)
+	{
+		// Parent somewhere earlier in the same tree, trees end up a few levels deep and bushy
+		const uint32      tree_index = i % c_treeSize;
+		const TransformId parent     = tree_index == 0u ? c_invalidTransform : ids[i - 1u - next() % tree_index];
+		ids.push_back(hierarchy.create(parent, glm::vec3(1.0f, 0.0f, 0.0f), glm::angleAxis(0.1f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(1.0f)));
+	}
+	hierarchy.update(false);
+
+	std::printf("%u transforms, %u hardware threads\n", c_count, std::thread::hardware_concurrency());
+
+	const auto dirty_all = [&]
+	{
+		for (uint32 i = 0u; i < c_count; i += c_treeSize)
+		{
+			hierarchy.setLocalPosition(ids[i], glm::vec3(static_cast<float>(next() % 100u)));
+		}
+	};
+	const auto dirty_some = [&]
+	{
+		for (uint32 i = 0u; i < 1'000u; i++)
+		{
+			hierarchy.setLocalPosition(ids[next() % c_count], glm::vec3(static_cast<float>(next() % 100u)));
+		}
+	};
+
+	jobs::initialize({});
+	for (const bool parallel: {false, true})
+	{
+		test::report(parallel ? "all dirty, jobs" : "all dirty, serial", test::measureNs([&]
+		{
+			dirty_all();
+			hierarchy.update(parallel);
+		}), c_count);
+
+		test::report(parallel ? "1000 edits, jobs" : "1000 edits, serial", test::measureNs([&]
+		{
+			dirty_some();
+			hierarchy.update(parallel);
+		}));
+	}
+	jobs::shutdown();
+}
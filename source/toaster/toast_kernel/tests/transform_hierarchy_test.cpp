@@ -0,0 +1,171 @@
+#include <cmath>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_test.hpp"
+#include "transform_hierarchy.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	struct Random
+	{
+		uint32 state;
+
+		uint32 nextUint() { state ^= state << 13u; state ^= state >> 17u; state ^= state << 5u; return state; }
+		float  nextFloat(const float p_min, const float p_max) { return p_min + (p_max - p_min) * static_cast<float>(nextUint() >> 8u) / static_cast<float>(1u << 24u); }
+
+		glm::quat nextRotation() { return glm::angleAxis(nextFloat(-3.0f, 3.0f), glm::normalize(glm::vec3(nextFloat(-1.0f, 1.0f), nextFloat(-1.0f, 1.0f), 1.0f))); }
+	};
+
+	// Random forest, every transform picks an earlier one as its parent or becomes a root
+	std::vector<TransformId> createRandomHierarchy(TransformHierarchy &p_hierarchy, const uint32 p_count, Random &p_random)
+	{
+		std::vector<TransformId> ids;
+		ids.reserve(p_count);
+		for (uint32 i = 0u; i < p_count; i++)
+		{
+			const TransformId parent = ids.empty() || p_random.nextUint() % 16u == 0u ? c_invalidTransform : ids[p_random.nextUint() % ids.size()];
+			ids.push_back(p_hierarchy.create(parent, glm::vec3(p_random.nextFloat(-2.0f, 2.0f), p_random.nextFloat(-2.0f, 2.0f), p_random.nextFloat(-2.0f, 2.0f)),
+											 p_random.nextRotation(), glm::vec3(p_random.nextFloat(0.8f, 1.2f))));
+		}
+		return ids;
+	}
+
+	glm::mat4 computeReference(const TransformHierarchy &p_hierarchy, const TransformId p_id)
+	{
+		const glm::mat4 local = glm::translate(glm::mat4(1.0f), p_hierarchy.getLocalPosition(p_id)) * glm::mat4_cast(p_hierarchy.getLocalRotation(p_id))
+							  * glm::scale(glm::mat4(1.0f), p_hierarchy.getLocalScale(p_id));
+
+		const TransformId parent = p_hierarchy.getParent(p_id);
+		return parent == c_invalidTransform ? local : computeReference(p_hierarchy, parent) * local;
+	}
+
+	// Relative to the largest element, deep chains of scaled transforms grow the translation
+	bool matchesReference(const TransformHierarchy &p_hierarchy, const std::vector<TransformId> &p_ids)
+	{
+		for (const TransformId id: p_ids)
+		{
+			if (!p_hierarchy.isValid(id))
+				continue;
+
+			const glm::mat4      expected = computeReference(p_hierarchy, id);
+			const tsm::float4x4 &world    = p_hierarchy.getWorldMatrix(id);
+
+			float largest = 1.0f;
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					largest = std::max(largest, std::abs(expected[column][row]));
+				}
+			}
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					if (std::abs(world[column][row] - expected[column][row]) > largest * 1e-5f)
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+TST_TEST(transformHierarchyMatchesReference)
+{
+	Random                   random{1234u};
+	TransformHierarchy       hierarchy;
+	std::vector<TransformId> ids = createRandomHierarchy(hierarchy, 5'000u, random);
+
+	hierarchy.update();
+	TST_CHECK(matchesReference(hierarchy, ids));
+
+	// A few local changes, only their subtrees are recomputed
+	for (uint32 i = 0u; i < 50u; i++)
+	{
+		hierarchy.setLocalRotation(ids[random.nextUint() % ids.size()], random.nextRotation());
+		hierarchy.setLocalPosition(ids[random.nextUint() % ids.size()], glm::vec3(random.nextFloat(-5.0f, 5.0f)));
+	}
+	hierarchy.update();
+	TST_CHECK(matchesReference(hierarchy, ids));
+
+	// Reparenting breaks the depth first order, local changes made before the next update() have to survive it
+	for (uint32 i = 0u; i < 50u; i++)
+	{
+		const TransformId id     = ids[random.nextUint() % ids.size()];
+		const TransformId parent = ids[random.nextUint() % ids.size()];
+
+		bool is_ancestor = false;
+		for (TransformId ancestor = parent; ancestor != c_invalidTransform; ancestor = hierarchy.getParent(ancestor))
+		{
+			is_ancestor |= ancestor == id;
+		}
+		if (!is_ancestor)
+			hierarchy.setParent(id, parent);
+
+		hierarchy.setLocalScale(ids[random.nextUint() % ids.size()], glm::vec3(random.nextFloat(0.5f, 1.5f)));
+	}
+	hierarchy.update();
+	TST_CHECK(matchesReference(hierarchy, ids));
+
+	// Destroyed subtrees free their ids, the rest keep theirs
+	for (uint32 i = 0u; i < 20u; i++)
+	{
+		const TransformId id = ids[random.nextUint() % ids.size()];
+		if (hierarchy.isValid(id))
+			hierarchy.destroy(id);
+	}
+	const uint32 alive = hierarchy.size();
+	hierarchy.update();
+	TST_CHECK(hierarchy.size() == alive && alive < ids.size());
+	TST_CHECK(matchesReference(hierarchy, ids));
+
+	const TransformId reused = hierarchy.create(c_invalidTransform, glm::vec3(1.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(2.0f));
+	hierarchy.update();
+	TST_CHECK(hierarchy.getWorldMatrix(reused)[3] == tsm::float4(1.0f, 1.0f, 1.0f, 1.0f));
+	TST_CHECK(hierarchy.getWorldMatrix(reused)[0] == tsm::float4(2.0f, 0.0f, 0.0f, 0.0f));
+}
+
+// Jobs split the work along subtrees, every transform still runs through the same math
+TST_TEST(transformHierarchyParallelMatchesSerial)
+{
+	Random             random{77u};
+	TransformHierarchy serial;
+	TransformHierarchy parallel;
+
+	const uint32                   count = TransformHierarchy::c_parallelUpdateThreshold * 2u;
+	const std::vector<TransformId> ids   = createRandomHierarchy(serial, count, random);
+	random.state                         = 77u;
+	createRandomHierarchy(parallel, count, random);
+
+	jobs::initialize({3u});
+	for (uint32 pass = 0u; pass < 3u; pass++)
+	{
+		serial.update(false);
+		parallel.update();
+
+		bool identical = true;
+		for (const TransformId id: ids)
+		{
+			identical &= serial.getWorldMatrix(id) == parallel.getWorldMatrix(id);
+		}
+		TST_CHECK(identical);
+
+		for (uint32 i = 0u; i < 100u; i++)
+		{
+			const TransformId id       = ids[random.nextUint() % count];
+			const glm::quat   rotation = random.nextRotation();
+			serial.setLocalRotation(id, rotation);
+			parallel.setLocalRotation(id, rotation);
+		}
+	}
+	parallel.update();
+	jobs::shutdown();
+
+	TST_CHECK(matchesReference(parallel, std::vector<TransformId>(ids.begin(), ids.begin() + 2'000)));
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "vertex_format.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	constexpr EVertexFormat c_formats[]{EVertexFormat::eFloat, EVertexFormat::eStandard, EVertexFormat::ePosition};
+
+	struct Random
+	{
+		uint32 state;
+
+		uint32 nextUint() { state ^= state << 13u; state ^= state >> 17u; state ^= state << 5u; return state; }
+		float  nextFloat(const float p_min, const float p_max) { return p_min + (p_max - p_min) * static_cast<float>(nextUint() >> 8u) / static_cast<float>(1u << 24u); }
+
+		glm::vec3 nextDirection() { return glm::normalize(glm::vec3(nextFloat(-1.0f, 1.0f), nextFloat(-1.0f, 1.0f), nextFloat(-1.0f, 1.0f)) + glm::vec3(1e-3f)); }
+	};
+
+	// Normals at right angles to their tangents, like the importer produces them
+	std::vector<Vertex> makeVertices(const uint32 p_count, Random &p_random)
+	{
+		std::vector<Vertex> vertices(p_count);
+		for (Vertex &vertex: vertices)
+		{
+			vertex.position = {p_random.nextFloat(-40.0f, 25.0f), p_random.nextFloat(0.0f, 3.0f), p_random.nextFloat(-1.0f, 1.0f)};
+			vertex.normal   = p_random.nextDirection();
+			vertex.texCoord = {p_random.nextFloat(-2.0f, 2.0f), p_random.nextFloat(0.0f, 1.0f)};
+
+			const glm::vec3 tangent = glm::normalize(glm::cross(vertex.normal, p_random.nextDirection()));
+			vertex.tangent          = glm::vec4(tangent, p_random.nextUint() & 1u ? 1.0f : -1.0f);
+		}
+		return vertices;
+	}
+
+	// In double, float acos can not resolve angles this small
+	float angleDegrees(const glm::vec3 &p_a, const glm::vec3 &p_b)
+	{
+		const glm::dvec3 a = glm::normalize(glm::dvec3(p_a));
+		const glm::dvec3 b = glm::normalize(glm::dvec3(p_b));
+		return static_cast<float>(glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b))));
+	}
+}
+
+// The nvrhi layout of every format matches its table: names and locations in EVertexAttribute order, the buffer and
+// stride asked for, and attributes that neither overlap nor reach past the stride
+TST_TEST(vertexAttributeDescsMatchTheFormat)
+{
+	constexpr std::string_view c_names[]{"POSITION", "NORMAL", "TEXCOORD", "TANGENT"};
+
+	for (const EVertexFormat format: c_formats)
+	{
+		const VertexFormatDesc &                      desc  = getVertexFormatDesc(format);
+		const std::vector<nvrhi::VertexAttributeDesc> descs = getVertexAttributeDescs(format, 2u);
+		TST_CHECK(descs.size() == desc.attributes.size());
+
+		// Which attribute covers each byte of the vertex, the offsets are not in location order
+		std::vector<int32> owners(desc.stride, -1);
+		bool               fits = true;
+		for (uint64 i = 0u; i < descs.size(); i++)
+		{
+			const nvrhi::VertexAttributeDesc &attribute = descs[i];
+			TST_CHECK(attribute.name == c_names[i]);
+			TST_CHECK(attribute.format == desc.attributes[i].format);
+			TST_CHECK(attribute.bufferIndex == 2u && attribute.elementStride == desc.stride);
+
+			const uint32 end = attribute.offset + nvrhi::getFormatInfo(attribute.format).bytesPerBlock;
+			for (uint32 byte = attribute.offset; byte < end; byte++)
+			{
+				fits &= byte < desc.stride && owners[byte] == -1;
+				if (byte < desc.stride)
+					owners[byte] = static_cast<int32>(i);
+			}
+		}
+		TST_CHECK(fits);
+	}
+}
+
+// Decoding eStandard the way a vertex shader would gives back the vertices within the documented precision, and
+// ePosition holds the same position bits
+TST_TEST(encodeVerticesRoundTrip)
+{
+	Random                    random{0x9E3779B9u};
+	const std::vector<Vertex> vertices = makeVertices(1000u, random);
+
+	glm::vec3 min(INFINITY), max(-INFINITY);
+	for (const Vertex &vertex: vertices)
+	{
+		min = glm::min(min, vertex.position);
+		max = glm::max(max, vertex.position);
+	}
+	const tsm::QuantizationGrid grid = tsm::QuantizationGrid::fromBounds(min, max);
+
+	std::vector<Vertex> as_float(vertices.size());
+	encodeVertices(EVertexFormat::eFloat, vertices, grid, as_float.data());
+	TST_CHECK(std::memcmp(as_float.data(), vertices.data(), vertices.size() * sizeof(Vertex)) == 0);
+
+	std::vector<StandardVertex> standard(vertices.size());
+	std::vector<PositionVertex> positions(vertices.size());
+	encodeVertices(EVertexFormat::eStandard, vertices, grid, standard.data());
+	encodeVertices(EVertexFormat::ePosition, vertices, grid, positions.data());
+
+	const glm::vec3 max_position_error = grid.getMaxError() * 1.01f + glm::vec3(1e-6f);
+
+	bool  positions_ok = true, signs_ok = true, position_bits_ok = true;
+	float max_normal_degrees = 0.0f, max_tangent_degrees = 0.0f, max_uv_error = 0.0f;
+	for (uint64 i = 0u; i < vertices.size(); i++)
+	{
+		const Vertex &        vertex  = vertices[i];
+		const StandardVertex &encoded = standard[i];
+
+		const glm::vec3 position = grid.dequantize(glm::u16vec3(encoded.position));
+		positions_ok &= glm::all(glm::lessThanEqual(glm::abs(position - vertex.position), max_position_error));
+		position_bits_ok &= positions[i].position == encoded.position;
+
+		max_normal_degrees = std::max(max_normal_degrees, angleDegrees(tsm::unpackOctahedral16(encoded.normal), vertex.normal));
+
+		const glm::vec4 tangent = tsm::unpackOctahedralTangent(encoded.tangent);
+		max_tangent_degrees     = std::max(max_tangent_degrees, angleDegrees(glm::vec3(tangent), glm::vec3(vertex.tangent)));
+		signs_ok &= tangent.w == vertex.tangent.w;
+
+		const glm::vec2 uv = {tsm::unpackHalf(encoded.texCoord.x), tsm::unpackHalf(encoded.texCoord.y)};
+		max_uv_error       = std::max(max_uv_error, glm::length(uv - vertex.texCoord));
+	}
+
+	TST_CHECK(positions_ok);
+	TST_CHECK(position_bits_ok);
+	TST_CHECK(max_normal_degrees < 0.01f);
+	TST_CHECK(max_tangent_degrees < 0.02f);
+	TST_CHECK(signs_ok);
+	TST_CHECK(max_uv_error < 2e-3f); // Half precision at |uv| < 2
+}
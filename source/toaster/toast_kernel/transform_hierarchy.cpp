@@ -0,0 +1,567 @@
+#include "transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "toast_assert.h"
+#include "jobs/job_system.hpp"
+#include "math/math_simd_wide.hpp"
+
+namespace toaster
+{
+	namespace
+	{
+		struct UpdateStreams
+		{
+			const float *positionX;
+			const float *positionY;
+			const float *positionZ;
+			const float *rotationX;
+			const float *rotationY;
+			const float *rotationZ;
+			const float *rotationW;
+			const float *scaleX;
+			const float *scaleY;
+			const float *scaleZ;
+
+			const uint32 * parents;
+			uint8 *        dirty;
+			tsm::float4x4 *worldMatrices;
+		};
+
+		constexpr uint32 c_noParentIndex{UINT32_MAX};
+
+		uint64 loadFlags(const uint8 *p_flags)
+		{
+			uint64 flags;
+			std::memcpy(&flags, p_flags, sizeof(flags));
+			return flags;
+		}
+
+		// Builds the local matrices of a whole block at once (T * R * S, same as glm::translate * mat4_cast * scale),
+		// then multiplies the dirty ones onto their parent's world matrix in order, a parent may sit earlier in the
+		// same block. With Propagate the dirty flags are pushed down to the children on the way, otherwise they
+		// already cover whole subtrees and are cleared as each block is done.
+		// Returns the index it stopped at, the remainder is finished by the ScalarOps instantiation
+		template<typename Ops, bool Propagate>
+		uint32 updateKernel(const UpdateStreams &p_streams, uint32 p_begin, uint32 p_end)
+		{
+			using V = typename Ops::type;
+
+			constexpr uint32 c_width = static_cast<uint32>(Ops::c_width);
+
+			const V one = Ops::set1(1.0f);
+			const V two = Ops::set1(2.0f);
+
+			// Upper 3x4 of the local matrices, m[column * 3 + row][lane]
+			alignas(64) float local[12][c_width];
+
+			uint32 i = p_begin;
+			for (; i + c_width <= p_end; i += c_width)
+			{
+				if constexpr (!Propagate)
+				{
+					// Most updates only touch a few subtrees, clean flags are skipped eight at a time
+					while (i + sizeof(uint64) <= p_end && loadFlags(p_streams.dirty + i) == 0u)
+					{
+						i += sizeof(uint64);
+					}
+					if (i + c_width > p_end)
+						break;
+				}
+
+				uint8 any_dirty = 0u;
+				for (uint32 lane = 0u; lane < c_width; lane++)
+				{
+					// Dirty state flows down from the parents, which always come first
+					if constexpr (Propagate)
+					{
+						const uint32 parent = p_streams.parents[i + lane];
+						if (parent != c_noParentIndex)
+							p_streams.dirty[i + lane] |= p_streams.dirty[parent];
+					}
+
+					any_dirty |= p_streams.dirty[i + lane];
+				}
+
+				if (!any_dirty)
+					continue;
+
+				const V x = Ops::load(p_streams.rotationX + i);
+				const V y = Ops::load(p_streams.rotationY + i);
+				const V z = Ops::load(p_streams.rotationZ + i);
+				const V w = Ops::load(p_streams.rotationW + i);
+
+				const V x2 = Ops::mul(x, two), y2 = Ops::mul(y, two), z2 = Ops::mul(z, two);
+				const V xx = Ops::mul(x, x2), yy = Ops::mul(y, y2), zz = Ops::mul(z, z2);
+				const V xy = Ops::mul(x, y2), xz = Ops::mul(x, z2), yz = Ops::mul(y, z2);
+				const V wx = Ops::mul(w, x2), wy = Ops::mul(w, y2), wz = Ops::mul(w, z2);
+
+				const V scale_x = Ops::load(p_streams.scaleX + i);
+				const V scale_y = Ops::load(p_streams.scaleY + i);
+				const V scale_z = Ops::load(p_streams.scaleZ + i);
+
+				Ops::store(local[0], Ops::mul(Ops::sub(one, Ops::add(yy, zz)), scale_x));
+				Ops::store(local[1], Ops::mul(Ops::add(xy, wz), scale_x));
+				Ops::store(local[2], Ops::mul(Ops::sub(xz, wy), scale_x));
+
+				Ops::store(local[3], Ops::mul(Ops::sub(xy, wz), scale_y));
+				Ops::store(local[4], Ops::mul(Ops::sub(one, Ops::add(xx, zz)), scale_y));
+				Ops::store(local[5], Ops::mul(Ops::add(yz, wx), scale_y));
+
+				Ops::store(local[6], Ops::mul(Ops::add(xz, wy), scale_z));
+				Ops::store(local[7], Ops::mul(Ops::sub(yz, wx), scale_z));
+				Ops::store(local[8], Ops::mul(Ops::sub(one, Ops::add(xx, yy)), scale_z));
+
+				Ops::store(local[9], Ops::load(p_streams.positionX + i));
+				Ops::store(local[10], Ops::load(p_streams.positionY + i));
+				Ops::store(local[11], Ops::load(p_streams.positionZ + i));
+
+				for (uint32 lane = 0u; lane < c_width; lane++)
+				{
+					if (!p_streams.dirty[i + lane])
+						continue;
+
+					tsm::float4x4 &world  = p_streams.worldMatrices[i + lane];
+					const uint32   parent = p_streams.parents[i + lane];
+					if (parent == c_noParentIndex)
+					{
+						world = tsm::float4x4(
+							tsm::float4(local[0][lane], local[1][lane], local[2][lane], 0.0f),
+							tsm::float4(local[3][lane], local[4][lane], local[5][lane], 0.0f),
+							tsm::float4(local[6][lane], local[7][lane], local[8][lane], 0.0f),
+							tsm::float4(local[9][lane], local[10][lane], local[11][lane], 1.0f));
+						continue;
+					}
+
+					// parent * local with the zero row of the local matrix skipped. The parent is read up front, the compiler
+					// can't tell it apart from the matrix being written
+					const tsm::float4x4 &parent_world = p_streams.worldMatrices[parent];
+					const tsm::float4    parent_x     = parent_world[0];
+					const tsm::float4    parent_y     = parent_world[1];
+					const tsm::float4    parent_z     = parent_world[2];
+					const tsm::float4    parent_w     = parent_world[3];
+					for (int column = 0; column < 3; column++)
+					{
+						const float *l = &local[column * 3][lane];
+						world[column]  = tsm::madd(parent_x, tsm::float4(l[0]), tsm::madd(parent_y, tsm::float4(l[c_width]), parent_z * l[c_width * 2u]));
+					}
+					world[3] = tsm::madd(parent_x, tsm::float4(local[9][lane]), tsm::madd(parent_y, tsm::float4(local[10][lane]), tsm::madd(parent_z, tsm::float4(local[11][lane]), parent_w)));
+				}
+
+				if constexpr (!Propagate)
+					std::memset(p_streams.dirty + i, 0, c_width);
+			}
+			return i;
+		}
+	}
+
+	TransformId TransformHierarchy::create(const TransformId p_parent)
+	{
+		return create(p_parent, glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+	}
+
+	TransformId TransformHierarchy::create(const TransformId p_parent, const glm::vec3 &p_position, const glm::quat &p_rotation, const glm::vec3 &p_scale)
+	{
+		const uint32 parent_index = p_parent == c_invalidTransform ? c_noParent : _getIndex(p_parent);
+		const uint32 index        = _append(parent_index);
+
+		TransformId id;
+		if (!m_freeIds.empty())
+		{
+			id = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<TransformId>(m_idToIndex.size());
+			m_idToIndex.push_back(0u);
+		}
+
+		m_idToIndex[id]    = index;
+		m_indexToId[index] = id;
+		m_aliveCount++;
+
+		// New transforms have no children yet, the dirty flag set by _append() is enough
+		_writeLocal(index, p_position, p_rotation, p_scale);
+		return id;
+	}
+
+	uint32 TransformHierarchy::_append(const uint32 p_parent_index)
+	{
+		const uint32 index = static_cast<uint32>(m_parents.size());
+		TST_ASSERT_MSG(index != c_noParent, "Transform hierarchy is full");
+
+		for (auto &channel : m_channels)
+		{
+			channel.push_back(0.0f);
+		}
+		m_worldMatrices.emplace_back();
+		m_parents.push_back(p_parent_index);
+		m_subtreeEnds.push_back(index + 1u);
+		m_dirty.push_back(1u);
+		m_indexToId.push_back(c_invalidTransform);
+
+		// A root at the end keeps every subtree contiguous, a child lands outside its parent's range
+		if (p_parent_index != c_noParent)
+			m_orderDirty = true;
+
+		return index;
+	}
+
+	void TransformHierarchy::destroy(const TransformId p_id)
+	{
+		// The subtree is only one contiguous range while the order is intact
+		if (m_orderDirty)
+			_rebuildOrder();
+
+		const uint32 index = _getIndex(p_id);
+		for (uint32 i = index; i < m_subtreeEnds[index]; i++)
+		{
+			if (m_indexToId[i] == c_invalidTransform)
+				continue;
+
+			m_freeIds.push_back(m_indexToId[i]);
+			m_idToIndex[m_indexToId[i]] = c_invalidIndex;
+			m_indexToId[i]              = c_invalidTransform;
+			m_aliveCount--;
+		}
+
+		// Dead transforms keep their slots, the ranges around them stay valid until the next update compacts them
+		m_deadCount++;
+	}
+
+	void TransformHierarchy::clear()
+	{
+		for (auto &channel : m_channels)
+		{
+			channel.clear();
+		}
+		m_worldMatrices.clear();
+		m_parents.clear();
+		m_subtreeEnds.clear();
+		m_dirty.clear();
+		m_indexToId.clear();
+		m_idToIndex.clear();
+		m_freeIds.clear();
+		m_ranges.clear();
+		m_sharedAncestors.clear();
+
+		m_aliveCount = 0u;
+		m_deadCount      = 0u;
+		m_orderDirty     = false;
+		m_propagateDirty = false;
+	}
+
+	void TransformHierarchy::setParent(const TransformId p_id, const TransformId p_parent)
+	{
+		const uint32 index        = _getIndex(p_id);
+		const uint32 parent_index = p_parent == c_invalidTransform ? c_noParent : _getIndex(p_parent);
+
+		for (uint32 ancestor = parent_index; ancestor != c_noParent; ancestor = m_parents[ancestor])
+		{
+			TST_ASSERT_MSG(ancestor != index, "A transform can not be parented to itself or its own descendant");
+		}
+
+		if (m_parents[index] == parent_index)
+			return;
+
+		m_parents[index] = parent_index;
+		m_dirty[index]   = 1u;
+		m_orderDirty     = true;
+		m_propagateDirty = true;
+	}
+
+	TransformId TransformHierarchy::getParent(const TransformId p_id) const
+	{
+		const uint32 parent = m_parents[_getIndex(p_id)];
+		return parent == c_noParent ? c_invalidTransform : m_indexToId[parent];
+	}
+
+	void TransformHierarchy::setLocalPosition(const TransformId p_id, const glm::vec3 &p_position)
+	{
+		const uint32 index = _getIndex(p_id);
+
+		m_channels[ePositionX][index] = p_position.x;
+		m_channels[ePositionY][index] = p_position.y;
+		m_channels[ePositionZ][index] = p_position.z;
+		_markDirty(index);
+	}
+
+	void TransformHierarchy::setLocalRotation(const TransformId p_id, const glm::quat &p_rotation)
+	{
+		const uint32    index    = _getIndex(p_id);
+		const glm::quat rotation = glm::normalize(p_rotation);
+
+		m_channels[eRotationX][index] = rotation.x;
+		m_channels[eRotationY][index] = rotation.y;
+		m_channels[eRotationZ][index] = rotation.z;
+		m_channels[eRotationW][index] = rotation.w;
+		_markDirty(index);
+	}
+
+	void TransformHierarchy::setLocalScale(const TransformId p_id, const glm::vec3 &p_scale)
+	{
+		const uint32 index = _getIndex(p_id);
+
+		m_channels[eScaleX][index] = p_scale.x;
+		m_channels[eScaleY][index] = p_scale.y;
+		m_channels[eScaleZ][index] = p_scale.z;
+		_markDirty(index);
+	}
+
+	void TransformHierarchy::setLocal(const TransformId p_id, const glm::vec3 &p_position, const glm::quat &p_rotation, const glm::vec3 &p_scale)
+	{
+		const uint32 index = _getIndex(p_id);
+
+		_writeLocal(index, p_position, p_rotation, p_scale);
+		_markDirty(index);
+	}
+
+	void TransformHierarchy::_writeLocal(const uint32 p_index, const glm::vec3 &p_position, const glm::quat &p_rotation, const glm::vec3 &p_scale)
+	{
+		const glm::quat rotation = glm::normalize(p_rotation);
+
+		m_channels[ePositionX][p_index] = p_position.x;
+		m_channels[ePositionY][p_index] = p_position.y;
+		m_channels[ePositionZ][p_index] = p_position.z;
+		m_channels[eRotationX][p_index] = rotation.x;
+		m_channels[eRotationY][p_index] = rotation.y;
+		m_channels[eRotationZ][p_index] = rotation.z;
+		m_channels[eRotationW][p_index] = rotation.w;
+		m_channels[eScaleX][p_index]    = p_scale.x;
+		m_channels[eScaleY][p_index]    = p_scale.y;
+		m_channels[eScaleZ][p_index]    = p_scale.z;
+	}
+
+	void TransformHierarchy::_markDirty(const uint32 p_index)
+	{
+		if (m_orderDirty)
+		{
+			// The subtree is scattered until the next _rebuildOrder(), update() pushes the flag down instead
+			m_dirty[p_index] = 1u;
+			m_propagateDirty = true;
+			return;
+		}
+		std::memset(m_dirty.data() + p_index, 1, m_subtreeEnds[p_index] - p_index);
+	}
+
+	glm::vec3 TransformHierarchy::getLocalPosition(const TransformId p_id) const
+	{
+		const uint32 index = _getIndex(p_id);
+		return {m_channels[ePositionX][index], m_channels[ePositionY][index], m_channels[ePositionZ][index]};
+	}
+
+	glm::quat TransformHierarchy::getLocalRotation(const TransformId p_id) const
+	{
+		const uint32 index = _getIndex(p_id);
+		return {m_channels[eRotationW][index], m_channels[eRotationX][index], m_channels[eRotationY][index], m_channels[eRotationZ][index]};
+	}
+
+	glm::vec3 TransformHierarchy::getLocalScale(const TransformId p_id) const
+	{
+		const uint32 index = _getIndex(p_id);
+		return {m_channels[eScaleX][index], m_channels[eScaleY][index], m_channels[eScaleZ][index]};
+	}
+
+	const tsm::float4x4 &TransformHierarchy::getWorldMatrix(const TransformId p_id) const
+	{
+		return m_worldMatrices[_getIndex(p_id)];
+	}
+
+	bool TransformHierarchy::isValid(const TransformId p_id) const
+	{
+		return p_id < m_idToIndex.size() && m_idToIndex[p_id] != c_invalidIndex;
+	}
+
+	uint32 TransformHierarchy::_getIndex(const TransformId p_id) const
+	{
+		TST_ASSERT_MSG(isValid(p_id), "Invalid TransformId");
+		return m_idToIndex[p_id];
+	}
+
+	void TransformHierarchy::update(const bool p_parallel)
+	{
+		if (m_orderDirty || m_deadCount)
+			_rebuildOrder();
+
+		const uint32 count = static_cast<uint32>(m_parents.size());
+		if (count == 0u)
+			return;
+
+		const uint32 worker_count = jobs::isInitialized() ? jobs::getWorkerCount() : 1u;
+		if (!p_parallel || count < c_parallelUpdateThreshold || worker_count == 1u)
+		{
+			_updateRange(0u, count);
+		}
+		else
+		{
+			// A few ranges per worker so one deep subtree does not hold up the rest
+			_splitRanges(std::max(count / (worker_count * 4u), 1u));
+
+			for (const uint32 ancestor : m_sharedAncestors)
+			{
+				_updateRange(ancestor, ancestor + 1u);
+			}
+
+			jobs::parallelFor(0u, m_ranges.size(), [this](const uint64 p_begin, const uint64 p_end)
+			{
+				for (uint64 range = p_begin; range < p_end; range++)
+				{
+					_updateRange(m_ranges[range].begin, m_ranges[range].end);
+				}
+			}, 1u);
+		}
+
+		if (m_propagateDirty)
+		{
+			std::memset(m_dirty.data(), 0, m_dirty.size());
+			m_propagateDirty = false;
+		}
+	}
+
+	void TransformHierarchy::_updateRange(const uint32 p_begin, const uint32 p_end)
+	{
+		const UpdateStreams streams{
+			m_channels[ePositionX].data(), m_channels[ePositionY].data(), m_channels[ePositionZ].data(),
+			m_channels[eRotationX].data(), m_channels[eRotationY].data(), m_channels[eRotationZ].data(), m_channels[eRotationW].data(),
+			m_channels[eScaleX].data(), m_channels[eScaleY].data(), m_channels[eScaleZ].data(),
+			m_parents.data(), m_dirty.data(), m_worldMatrices.data(),
+		};
+
+		if (m_propagateDirty)
+		{
+			const uint32 i = updateKernel<tsm::simd::WideOps, true>(streams, p_begin, p_end);
+			updateKernel<tsm::simd::ScalarOps, true>(streams, i, p_end);
+		}
+		else
+		{
+			const uint32 i = updateKernel<tsm::simd::WideOps, false>(streams, p_begin, p_end);
+			updateKernel<tsm::simd::ScalarOps, false>(streams, i, p_end);
+		}
+	}
+
+	void TransformHierarchy::_splitRanges(const uint32 p_max_range)
+	{
+		m_ranges.clear();
+		m_sharedAncestors.clear();
+
+		const uint32 count = static_cast<uint32>(m_parents.size());
+		for (uint32 i = 0u; i < count;)
+		{
+			const uint32 end = m_subtreeEnds[i];
+			if (end - i > p_max_range)
+			{
+				// Too big for one range, update it up front and split its children instead
+				m_sharedAncestors.push_back(i);
+				i++;
+				continue;
+			}
+
+			// Neighbouring small subtrees share a range
+			if (!m_ranges.empty() && m_ranges.back().end == i && end - m_ranges.back().begin <= p_max_range)
+				m_ranges.back().end = end;
+			else
+				m_ranges.push_back({i, end});
+
+			i = end;
+		}
+	}
+
+	void TransformHierarchy::_rebuildOrder()
+	{
+		const uint32 old_count = static_cast<uint32>(m_parents.size());
+
+		// Children of every transform in creation order, as offsets into one array
+		std::vector<uint32> child_begin(old_count + 1u, 0u);
+		for (uint32 i = 0u; i < old_count; i++)
+		{
+			if (m_indexToId[i] != c_invalidTransform && m_parents[i] != c_noParent)
+				child_begin[m_parents[i] + 1u]++;
+		}
+		for (uint32 i = 0u; i < old_count; i++)
+		{
+			child_begin[i + 1u] += child_begin[i];
+		}
+
+		std::vector<uint32> children(child_begin[old_count]);
+		std::vector<uint32> cursor(child_begin.begin(), child_begin.end() - 1);
+		for (uint32 i = 0u; i < old_count; i++)
+		{
+			if (m_indexToId[i] != c_invalidTransform && m_parents[i] != c_noParent)
+				children[cursor[m_parents[i]]++] = i;
+		}
+
+		// Depth first from every root, destroyed transforms are left out
+		std::vector<uint32> order;
+		order.reserve(m_aliveCount);
+
+		std::vector<uint32> stack;
+		for (uint32 root = 0u; root < old_count; root++)
+		{
+			if (m_indexToId[root] == c_invalidTransform || m_parents[root] != c_noParent)
+				continue;
+
+			stack.push_back(root);
+			while (!stack.empty())
+			{
+				const uint32 index = stack.back();
+				stack.pop_back();
+				order.push_back(index);
+
+				for (uint32 child = child_begin[index + 1u]; child > child_begin[index]; child--)
+				{
+					stack.push_back(children[child - 1u]);
+				}
+			}
+		}
+
+		const uint32 new_count = static_cast<uint32>(order.size());
+
+		std::vector<uint32> old_to_new(old_count, c_invalidIndex);
+		for (uint32 i = 0u; i < new_count; i++)
+		{
+			old_to_new[order[i]] = i;
+		}
+
+		const auto permute = [&](auto &p_vector)
+		{
+			std::remove_reference_t<decltype(p_vector)> permuted(new_count);
+			for (uint32 i = 0u; i < new_count; i++)
+			{
+				permuted[i] = p_vector[order[i]];
+			}
+			p_vector = std::move(permuted);
+		};
+
+		for (auto &channel : m_channels)
+		{
+			permute(channel);
+		}
+		permute(m_worldMatrices);
+		permute(m_dirty);
+		permute(m_indexToId);
+		permute(m_parents);
+
+		m_subtreeEnds.assign(new_count, 1u);
+		for (uint32 i = new_count; i-- > 0u;)
+		{
+			if (m_parents[i] != c_noParent)
+			{
+				m_parents[i] = old_to_new[m_parents[i]];
+				m_subtreeEnds[m_parents[i]] += m_subtreeEnds[i];
+			}
+			m_idToIndex[m_indexToId[i]] = i;
+		}
+
+		// Subtree sizes to end indices, sizes only ever flow into lower indices so this runs forwards
+		for (uint32 i = 0u; i < new_count; i++)
+		{
+			m_subtreeEnds[i] += i;
+		}
+
+		m_deadCount  = 0u;
+		m_orderDirty = false;
+	}
+}
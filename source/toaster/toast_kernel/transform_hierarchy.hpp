@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "system_types.h"
+#include "math/math_matrix.hpp"
+#include "memory/tracked_allocator.hpp"
+
+namespace toaster
+{
+	using TransformId = uint32;
+
+	inline constexpr TransformId c_invalidTransform{UINT32_MAX};
+
+	// Flat scene graph of translation / rotation / scale transforms.
+	//
+	// Local transforms live in structure of arrays channels, ordered depth first so every parent comes before its
+	// children and every subtree is one contiguous range. update() recomputes the world matrices of dirty transforms
+	// and everything below them, several transforms per SIMD iteration, and hands independent subtrees to the job
+	// system. TransformIds stay valid across the reordering, the dense order is an implementation detail
+	class TransformHierarchy
+	{
+	public:
+		// Below this many transforms update() does not bother with jobs
+		static constexpr uint32 c_parallelUpdateThreshold{65'536u};
+
+		TransformHierarchy() = default;
+
+		// Identity local transform. p_parent must be valid or c_invalidTransform for a root
+		TransformId create(TransformId p_parent = c_invalidTransform);
+		TransformId create(TransformId p_parent, const glm::vec3 &p_position, const glm::quat &p_rotation, const glm::vec3 &p_scale);
+
+		// Destroys the transform and its whole subtree
+		void destroy(TransformId p_id);
+		void clear();
+
+		// Keeps the local transform, so the world transform jumps with the new parent. Making a transform its own
+		// ancestor is not allowed
+		void        setParent(TransformId p_id, TransformId p_parent);
+		TransformId getParent(TransformId p_id) const;
+
+		void setLocalPosition(TransformId p_id, const glm::vec3 &p_position);
+		void setLocalRotation(TransformId p_id, const glm::quat &p_rotation); // Normalized on the way in
+		void setLocalScale(TransformId p_id, const glm::vec3 &p_scale);
+		void setLocal(TransformId p_id, const glm::vec3 &p_position, const glm::quat &p_rotation, const glm::vec3 &p_scale);
+
+		[[nodiscard]] glm::vec3 getLocalPosition(TransformId p_id) const;
+		[[nodiscard]] glm::quat getLocalRotation(TransformId p_id) const;
+		[[nodiscard]] glm::vec3 getLocalScale(TransformId p_id) const;
+
+		// As of the last update()
+		[[nodiscard]] const tsm::float4x4 &getWorldMatrix(TransformId p_id) const;
+
+		// Recomputes the world matrices of every transform whose local transform or parent changed since the last
+		// update. Runs as jobs while the job system is running, unless p_parallel is false
+		void update(bool p_parallel = true);
+
+		[[nodiscard]] bool   isValid(TransformId p_id) const;
+		[[nodiscard]] uint32 size() const { return m_aliveCount; }
+
+	private:
+		enum EChannel : uint8
+		{
+			ePositionX,
+			ePositionY,
+			ePositionZ,
+			eRotationX,
+			eRotationY,
+			eRotationZ,
+			eRotationW,
+			eScaleX,
+			eScaleY,
+			eScaleZ,
+
+			eChannelCount
+		};
+
+		// [begin, end) of dense indices
+		struct Range
+		{
+			uint32 begin;
+			uint32 end;
+		};
+
+		static constexpr uint32 c_noParent{UINT32_MAX};
+		static constexpr uint32 c_invalidIndex{UINT32_MAX};
+
+		uint32 _getIndex(TransformId p_id) const;
+		uint32 _append(uint32 p_parent_index);
+		void   _writeLocal(uint32 p_index, const glm::vec3 &p_position, const glm::quat &p_rotation, const glm::vec3 &p_scale);
+
+		// Flags the transform and its subtree for the next update()
+		void _markDirty(uint32 p_index);
+
+		// Restores the depth first order, drops destroyed transforms and recomputes the subtree ranges
+		void _rebuildOrder();
+
+		// Splits the hierarchy into independent subtree ranges of at most p_max_range transforms. Transforms with
+		// a bigger subtree end up in m_sharedAncestors, they are updated before the ranges
+		void _splitRanges(uint32 p_max_range);
+
+		void _updateRange(uint32 p_begin, uint32 p_end);
+
+		memory::TrackedVector<float, memory::EMemoryTag::eGeneral> m_channels[eChannelCount];
+
+		memory::TrackedVector<tsm::float4x4, memory::EMemoryTag::eGeneral> m_worldMatrices;
+
+		memory::TrackedVector<uint32, memory::EMemoryTag::eGeneral> m_parents; // Dense parent index or c_noParent
+		memory::TrackedVector<uint32, memory::EMemoryTag::eGeneral> m_subtreeEnds; // One past the last descendant
+		memory::TrackedVector<uint8, memory::EMemoryTag::eGeneral>  m_dirty;
+
+		memory::TrackedVector<TransformId, memory::EMemoryTag::eGeneral> m_indexToId; // c_invalidTransform once destroyed
+		memory::TrackedVector<uint32, memory::EMemoryTag::eGeneral>      m_idToIndex; // c_invalidIndex for free ids
+		std::vector<TransformId>                                         m_freeIds;
+
+		std::vector<Range>  m_ranges;
+		std::vector<uint32> m_sharedAncestors;
+
+		uint32 m_aliveCount{0u};
+		uint32 m_deadCount{0u}; // Destroyed subtrees still taking up slots
+		bool   m_orderDirty{false};
+		bool   m_propagateDirty{false}; // Some dirty flags have not reached the children yet
+	};
+}
@@ -0,0 +1,121 @@
+#include "vertex_format.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+#include "toast_assert.h"
+#include "math/math_stream.hpp"
+
+namespace toaster
+{
+	namespace
+	{
+		constexpr VertexAttributeLayout c_floatAttributes[]{
+			{EVertexAttribute::ePosition, nvrhi::Format::RGB32_FLOAT, offsetof(Vertex, position)},
+			{EVertexAttribute::eNormal, nvrhi::Format::RGB32_FLOAT, offsetof(Vertex, normal)},
+			{EVertexAttribute::eTexCoord, nvrhi::Format::RG32_FLOAT, offsetof(Vertex, texCoord)},
+			{EVertexAttribute::eTangent, nvrhi::Format::RGBA32_FLOAT, offsetof(Vertex, tangent)},
+		};
+
+		constexpr VertexAttributeLayout c_standardAttributes[]{
+			{EVertexAttribute::ePosition, nvrhi::Format::RGBA16_UNORM, offsetof(StandardVertex, position)},
+			{EVertexAttribute::eNormal, nvrhi::Format::RG16_SNORM, offsetof(StandardVertex, normal)},
+			{EVertexAttribute::eTexCoord, nvrhi::Format::RG16_FLOAT, offsetof(StandardVertex, texCoord)},
+			{EVertexAttribute::eTangent, nvrhi::Format::R32_UINT, offsetof(StandardVertex, tangent)},
+		};
+
+		constexpr VertexAttributeLayout c_positionAttributes[]{
+			{EVertexAttribute::ePosition, nvrhi::Format::RGBA16_UNORM, offsetof(PositionVertex, position)},
+		};
+
+		// Indexed by EVertexFormat
+		constexpr VertexFormatDesc c_vertexFormats[]{
+			{"Float", sizeof(Vertex), c_floatAttributes},
+			{"Standard", sizeof(StandardVertex), c_standardAttributes},
+			{"Position", sizeof(PositionVertex), c_positionAttributes},
+		};
+
+		// Indexed by EVertexAttribute
+		constexpr const char *c_attributeNames[]{"POSITION", "NORMAL", "TEXCOORD", "TANGENT"};
+
+		constexpr bool isInLocationOrder(const std::span<const VertexAttributeLayout> p_attributes)
+		{
+			for (uint64 i = 0; i < p_attributes.size(); i++)
+			{
+				if (static_cast<uint64>(p_attributes[i].attribute) != i)
+					return false;
+			}
+			return true;
+		}
+
+		static_assert(isInLocationOrder(c_floatAttributes) && isInLocationOrder(c_standardAttributes) && isInLocationOrder(c_positionAttributes));
+	}
+
+	const VertexFormatDesc &getVertexFormatDesc(const EVertexFormat p_format)
+	{
+		TST_ASSERT_MSG(static_cast<uint64>(p_format) < std::size(c_vertexFormats), "Unknown vertex format");
+		return c_vertexFormats[static_cast<uint64>(p_format)];
+	}
+
+	std::vector<nvrhi::VertexAttributeDesc> getVertexAttributeDescs(const EVertexFormat p_format, const uint32 p_buffer_index)
+	{
+		const VertexFormatDesc &desc = getVertexFormatDesc(p_format);
+
+		std::vector<nvrhi::VertexAttributeDesc> attributes;
+		attributes.reserve(desc.attributes.size());
+		for (const VertexAttributeLayout &layout: desc.attributes)
+		{
+			attributes.push_back(nvrhi::VertexAttributeDesc()
+								 .setName(c_attributeNames[static_cast<uint64>(layout.attribute)])
+								 .setFormat(layout.format)
+								 .setBufferIndex(p_buffer_index)
+								 .setOffset(layout.offset)
+								 .setElementStride(desc.stride));
+		}
+		return attributes;
+	}
+
+	void encodeVertices(const EVertexFormat p_format, const std::span<const Vertex> p_vertices, const tsm::QuantizationGrid &p_grid, void *p_out)
+	{
+		if (p_format == EVertexFormat::eFloat)
+		{
+			std::memcpy(p_out, p_vertices.data(), p_vertices.size_bytes());
+			return;
+		}
+
+		const uint64 stride = getVertexFormatDesc(p_format).stride;
+		auto *       bytes  = static_cast<uint8 *>(p_out);
+
+		// The encoders leave the padding alone, w of the position included
+		std::memset(p_out, 0, p_vertices.size() * stride);
+
+		// Structure of arrays for the batch encoders, which write straight into the interleaved vertices
+		tsm::Float3Stream positions(p_vertices.size(), memory::EMemoryTag::eMesh);
+		for (uint64 i = 0; i < p_vertices.size(); i++)
+		{
+			positions.set(i, p_vertices[i].position);
+		}
+		tsm::quantizePositions(positions, p_grid, bytes, stride);
+
+		if (p_format == EVertexFormat::ePosition)
+			return;
+
+		tsm::Float3Stream  normals(p_vertices.size(), memory::EMemoryTag::eMesh);
+		tsm::Float3Stream  tangents(p_vertices.size(), memory::EMemoryTag::eMesh);
+		std::vector<float> bitangent_signs(p_vertices.size());
+		for (uint64 i = 0; i < p_vertices.size(); i++)
+		{
+			normals.set(i, p_vertices[i].normal);
+			tangents.set(i, glm::vec3(p_vertices[i].tangent));
+			bitangent_signs[i] = p_vertices[i].tangent.w;
+		}
+		tsm::encodeOctahedral16(normals, bytes + offsetof(StandardVertex, normal), stride);
+		tsm::encodeOctahedralTangents(tangents, bitangent_signs.data(), bytes + offsetof(StandardVertex, tangent), stride);
+
+		auto *standard_vertices = static_cast<StandardVertex *>(p_out);
+		for (uint64 i = 0; i < p_vertices.size(); i++)
+		{
+			standard_vertices[i].texCoord = {tsm::packHalf(p_vertices[i].texCoord.x), tsm::packHalf(p_vertices[i].texCoord.y)};
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <nvrhi/nvrhi.h>
+
+#include "system_types.h"
+#include "math/math_packing.hpp"
+
+namespace toaster
+{
+	// The CPU side vertex every mesh is imported, processed and cooked in. The GPU gets one of the EVertexFormat
+	// encodings of it
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texCoord;
+		glm::vec4 tangent; // xyz at right angles to the normal, w the bitangent sign, 1 or -1
+	};
+
+	// Vertex layouts a mesh can be uploaded in. getVertexAttributeDescs() describes each one to nvrhi, the shaders read
+	// eFloat in mesh.vert.glsl, eStandard in mesh_standard.vert.glsl and ePosition in mesh_depth.vert.glsl. The last two
+	// decode the positions with the submesh's grid, see Mesh::getQuantizationGrids() and toast_shaders/mesh_vertex.glsl
+	enum class EVertexFormat : uint8
+	{
+		eFloat,    // Vertex as it is, 48 bytes
+		eStandard, // Quantized position, octahedral normal and tangent, half UVs, 20 bytes
+		ePosition, // eStandard's position alone, 8 bytes, for depth and shadow passes
+	};
+
+	// nvrhi numbers the locations in the order the attributes are listed, so every format lists its attributes in
+	// this order and the shaders declare them at these locations
+	enum class EVertexAttribute : uint8
+	{
+		ePosition,
+		eNormal,
+		eTexCoord,
+		eTangent,
+	};
+
+	struct VertexAttributeLayout
+	{
+		EVertexAttribute attribute;
+		nvrhi::Format    format;
+		uint32           offset;
+	};
+
+	struct VertexFormatDesc
+	{
+		const char *                           name;
+		uint32                                 stride;
+		std::span<const VertexAttributeLayout> attributes;
+	};
+
+	// Positions are RGBA16_UNORM on the submesh's tsm::QuantizationGrid, w is unused
+	struct StandardVertex
+	{
+		glm::u16vec4 position;
+		uint32       normal;   // tsm::packOctahedral16()
+		uint32       tangent;  // tsm::packOctahedralTangent()
+		glm::u16vec2 texCoord; // Half floats
+	};
+
+	struct PositionVertex
+	{
+		glm::u16vec4 position;
+	};
+
+	static_assert(sizeof(Vertex) == 48u && sizeof(StandardVertex) == 20u && sizeof(PositionVertex) == 8u);
+
+	[[nodiscard]] const VertexFormatDesc &getVertexFormatDesc(EVertexFormat p_format);
+
+	// The format's attributes for nvrhi::IDevice::createInputLayout(), named after the attributes and read from
+	// vertex buffer p_buffer_index
+	[[nodiscard]] std::vector<nvrhi::VertexAttributeDesc> getVertexAttributeDescs(EVertexFormat p_format, uint32 p_buffer_index = 0u);
+
+	// Writes p_vertices into p_out in p_format, its stride apart. The quantized formats place the positions on p_grid,
+	// which must contain all of them
+	void encodeVertices(EVertexFormat p_format, std::span<const Vertex> p_vertices, const tsm::QuantizationGrid &p_grid, void *p_out);
+}
@@ -0,0 +1,110 @@
+#include "hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace toaster
+{
+	namespace
+	{
+		constexpr uint64 c_prime1{0x9E3779B185EBCA87ull};
+		constexpr uint64 c_prime2{0xC2B2AE3D27D4EB4Full};
+		constexpr uint64 c_prime3{0x165667B19E3779F9ull};
+		constexpr uint64 c_prime4{0x85EBCA77C2B2AE63ull};
+		constexpr uint64 c_prime5{0x27D4EB2F165667C5ull};
+
+		// Unaligned little endian loads, compiles down to a plain mov
+		uint64 load64(const uint8 *p_ptr)
+		{
+			uint64 value;
+			std::memcpy(&value, p_ptr, sizeof(value));
+			return value;
+		}
+
+		uint32 load32(const uint8 *p_ptr)
+		{
+			uint32 value;
+			std::memcpy(&value, p_ptr, sizeof(value));
+			return value;
+		}
+
+		uint64 round(uint64 p_acc, const uint64 p_input)
+		{
+			p_acc += p_input * c_prime2;
+			p_acc = std::rotl(p_acc, 31);
+			return p_acc * c_prime1;
+		}
+
+		uint64 mergeRound(uint64 p_acc, const uint64 p_lane)
+		{
+			p_acc ^= round(0u, p_lane);
+			return p_acc * c_prime1 + c_prime4;
+		}
+	}
+
+	uint64 hashBytes64(const std::span<const uint8> p_data, const uint64 p_seed)
+	{
+		const uint8 *ptr  = p_data.data();
+		const uint8 *end  = ptr + p_data.size();
+		uint64       hash = 0u;
+
+		if (p_data.size() >= 32u)
+		{
+			// Four independent lanes of 8 bytes each, so the multiplies of one 32 byte stripe overlap
+			uint64 lane0 = p_seed + c_prime1 + c_prime2;
+			uint64 lane1 = p_seed + c_prime2;
+			uint64 lane2 = p_seed;
+			uint64 lane3 = p_seed - c_prime1;
+
+			const uint8 *last_stripe = end - 32u;
+			do
+			{
+				lane0 = round(lane0, load64(ptr));
+				lane1 = round(lane1, load64(ptr + 8u));
+				lane2 = round(lane2, load64(ptr + 16u));
+				lane3 = round(lane3, load64(ptr + 24u));
+				ptr += 32u;
+			}
+			while (ptr <= last_stripe);
+
+			hash = std::rotl(lane0, 1) + std::rotl(lane1, 7) + std::rotl(lane2, 12) + std::rotl(lane3, 18);
+			hash = mergeRound(hash, lane0);
+			hash = mergeRound(hash, lane1);
+			hash = mergeRound(hash, lane2);
+			hash = mergeRound(hash, lane3);
+		}
+		else
+		{
+			hash = p_seed + c_prime5;
+		}
+
+		hash += static_cast<uint64>(p_data.size());
+
+		for (; ptr + 8u <= end; ptr += 8u)
+		{
+			hash ^= round(0u, load64(ptr));
+			hash = std::rotl(hash, 27) * c_prime1 + c_prime4;
+		}
+
+		if (ptr + 4u <= end)
+		{
+			hash ^= static_cast<uint64>(load32(ptr)) * c_prime1;
+			hash = std::rotl(hash, 23) * c_prime2 + c_prime3;
+			ptr += 4u;
+		}
+
+		for (; ptr < end; ptr++)
+		{
+			hash ^= static_cast<uint64>(*ptr) * c_prime5;
+			hash = std::rotl(hash, 11) * c_prime1;
+		}
+
+		// Avalanche
+		hash ^= hash >> 33u;
+		hash *= c_prime2;
+		hash ^= hash >> 29u;
+		hash *= c_prime3;
+		hash ^= hash >> 32u;
+		return hash;
+	}
+}
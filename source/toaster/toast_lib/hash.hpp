@@ -0,0 +1,12 @@
+#pragma once
+
+#include <span>
+
+#include "system_types.h"
+
+namespace toaster
+{
+	// 64-bit XXH64 of a block of bytes, for checksums and content hashes of whole files. Runs at several GB/s, use
+	// hashString64() for names and anything that has to be hashed at compile time
+	uint64 hashBytes64(std::span<const uint8> p_data, uint64 p_seed = 0u);
+}
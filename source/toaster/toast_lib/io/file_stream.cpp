@@ -32,7 +32,7 @@ namespace toaster::io
 	bool FileStreamReader::readData(uint8 *p_dst, uint64 p_size)
 	{
 		m_fileStream.read(reinterpret_cast<char *>(p_dst), static_cast<std::streamsize>(p_size));
-		return true;
+		return m_fileStream.good();
 	}
 
 	FileStreamWriter::FileStreamWriter(filesystem::Path p_path) : m_path(std::move(p_path))
@@ -63,6 +63,12 @@ namespace toaster::io
 	bool FileStreamWriter::writeData(const uint8 *p_data, const uint64 p_size)
 	{
 		m_fileStream.write(reinterpret_cast<const char *>(p_data), static_cast<std::streamsize>(p_size));
-		return true;
+		return m_fileStream.good();
+	}
+
+	bool FileStreamWriter::flush()
+	{
+		m_fileStream.flush();
+		return m_fileStream.good();
 	}
 }
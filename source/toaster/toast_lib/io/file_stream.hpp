@@ -40,6 +40,8 @@ namespace toaster::io
 
 		bool writeData(const uint8 *p_data, uint64 p_size) override;
 
+		bool flush() override;
+
 	private:
 		mutable std::ofstream m_fileStream;
 		filesystem::Path      m_path;
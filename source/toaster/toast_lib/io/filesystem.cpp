@@ -1,5 +1,6 @@
 #include "filesystem.hpp"
 
+#include <cstring>
 #include <fstream>
 
 namespace toaster::io::filesystem
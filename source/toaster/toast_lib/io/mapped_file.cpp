@@ -0,0 +1,116 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace toaster::io
+{
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile &&p_other) noexcept
+		: m_data(std::exchange(p_other.m_data, nullptr)), m_size(std::exchange(p_other.m_size, 0u)), m_mapping(std::exchange(p_other.m_mapping, nullptr))
+	{
+	}
+
+	MappedFile &MappedFile::operator=(MappedFile &&p_other) noexcept
+	{
+		if (this != &p_other)
+		{
+			close();
+			m_data    = std::exchange(p_other.m_data, nullptr);
+			m_size    = std::exchange(p_other.m_size, 0u);
+			m_mapping = std::exchange(p_other.m_mapping, nullptr);
+		}
+		return *this;
+	}
+
+	bool MappedFile::open(const filesystem::Path &p_path)
+	{
+		close();
+
+		#ifdef _WIN32
+		const HANDLE file = CreateFileW(p_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// The mapping keeps the file open, the handle itself is no longer needed
+		const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!mapping)
+			return false;
+
+		const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view)
+		{
+			CloseHandle(mapping);
+			return false;
+		}
+
+		m_mapping = mapping;
+		m_data    = static_cast<const uint8 *>(view);
+		m_size    = static_cast<uint64>(file_size.QuadPart);
+		#else
+		const int file = ::open(p_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (file < 0)
+			return false;
+
+		struct stat file_stat{};
+		if (fstat(file, &file_stat) != 0 || file_stat.st_size <= 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		void *view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (view == MAP_FAILED)
+			return false;
+
+		m_data = static_cast<const uint8 *>(view);
+		m_size = static_cast<uint64>(file_stat.st_size);
+		#endif
+
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (!m_data)
+			return;
+
+		#ifdef _WIN32
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+		#else
+		munmap(const_cast<uint8 *>(m_data), static_cast<size_t>(m_size));
+		#endif
+
+		m_data    = nullptr;
+		m_size    = 0u;
+		m_mapping = nullptr;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <span>
+
+#include "system_types.h"
+
+#include "filesystem.hpp"
+
+namespace toaster::io
+{
+	// Read only view of a whole file mapped into memory. Pages are read in by the OS on first touch, so only the
+	// parts that are looked at cost anything, and nothing is copied into a buffer of our own
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const filesystem::Path &p_path) { open(p_path); }
+		~MappedFile();
+
+		MappedFile(MappedFile &&p_other) noexcept;
+		MappedFile &operator=(MappedFile &&p_other) noexcept;
+
+		MappedFile(const MappedFile &)            = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		// False if the file doesn't exist, is empty or could not be mapped
+		bool open(const filesystem::Path &p_path);
+		void close();
+
+		[[nodiscard]] bool                    isOpen() const { return m_data != nullptr; }
+		[[nodiscard]] std::span<const uint8> getData() const { return {m_data, m_size}; }
+		[[nodiscard]] uint64                  getSize() const { return m_size; }
+
+	private:
+		const uint8 *m_data{nullptr};
+		uint64       m_size{0u};
+		void *       m_mapping{nullptr}; // Windows only, the file mapping object
+	};
+}
@@ -0,0 +1,26 @@
+#include "memory_stream.hpp"
+
+#include <cstring>
+
+namespace toaster::io
+{
+	void MemoryStreamReader::setStreamPos(const uint64 p_stream_pos)
+	{
+		m_position = p_stream_pos;
+		m_isGood   = p_stream_pos <= m_data.size();
+	}
+
+	bool MemoryStreamReader::readData(uint8 *p_dst, const uint64 p_size)
+	{
+		if (!m_isGood || p_size > m_data.size() - m_position)
+		{
+			m_isGood = false;
+			return false;
+		}
+
+		if (p_size)
+			std::memcpy(p_dst, m_data.data() + m_position, p_size);
+		m_position += p_size;
+		return true;
+	}
+}
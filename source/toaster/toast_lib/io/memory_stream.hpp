@@ -0,0 +1,28 @@
+#pragma once
+
+#include <span>
+
+#include "stream_reader.hpp"
+
+namespace toaster::io
+{
+	// Reads from a block of memory that outlives the reader, e.g. a section of a MappedFile
+	class MemoryStreamReader : public StreamReader
+	{
+	public:
+		explicit MemoryStreamReader(std::span<const uint8> p_data) : m_data(p_data) {}
+
+		// False once a read ran past the end
+		[[nodiscard]] bool isGood() const override { return m_isGood; }
+
+		[[nodiscard]] uint64 getStreamPos() const override { return m_position; }
+		void                 setStreamPos(uint64 p_stream_pos) override;
+
+		bool readData(uint8 *p_dst, uint64 p_size) override;
+
+	private:
+		std::span<const uint8> m_data;
+		uint64                 m_position{0u};
+		bool                   m_isGood{true};
+	};
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <concepts>
 #include <string>
+#include <type_traits>
 
 #include "system_types.h"
 #include "toast_assert.h"
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <concepts>
 #include <string>
+#include <type_traits>
 
 #include "system_types.h"
 #include "toast_assert.h"
@@ -24,17 +26,28 @@ namespace toaster::io
 		// Sets the current position in the stream
 		virtual void setStreamPos(uint64 p_stream_pos) = 0;
 
-		// Reads data from the current stream position into the destination buffer
+		// Writes the buffer at the current stream position
 		virtual bool writeData(const uint8 *p_data, uint64 p_size) = 0;
 
+		// Pushes buffered data to where the stream goes, the last chance to see a failed write before the writer is
+		// destroyed
+		virtual bool flush() { return isGood(); }
+
 		// writes to the current stream into the destination type by the size of that type
 		template<typename Type> requires std::is_trivial_v<Type>
 		void writeRaw(const Type &p_type)
 		{
-			const bool success = writeData(reinterpret_cast<int8 *>(&p_type), sizeof(Type));
+			const bool success = writeData(reinterpret_cast<const uint8 *>(&p_type), sizeof(Type));
 			TST_ASSERT_MSG(success, "Failed to write type");
 		}
 
+		// Same as writeRaw(), for writes that may fail, e.g. on a full disk. Returns false instead of asserting
+		template<typename Type> requires std::is_trivial_v<Type>
+		[[nodiscard]] bool tryWriteRaw(const Type &p_type)
+		{
+			return writeData(reinterpret_cast<const uint8 *>(&p_type), sizeof(Type));
+		}
+
 		// writes to the current stream into the destination object
 		// This requires that the object derives from the Serializable interface and implements the serialize
 		// and deserialize methods
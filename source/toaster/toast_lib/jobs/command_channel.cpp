@@ -0,0 +1,70 @@
+#include "command_channel.hpp"
+
+#include <algorithm>
+
+namespace toaster::jobs
+{
+	void CommandBuffer::execute(void *p_context)
+	{
+		TST_ASSERT_MSG(p_context, "Command buffers execute against a context");
+		_consume(p_context);
+	}
+
+	void CommandBuffer::reset()
+	{
+		_consume(nullptr);
+	}
+
+	CommandBuffer::Header *CommandBuffer::_allocate(const uint64 p_size)
+	{
+		// Chunks skipped here stay empty, execution walks over them
+		while (m_currentChunk < m_chunks.size() && m_chunks[m_currentChunk].capacity - m_chunks[m_currentChunk].used < p_size)
+		{
+			m_currentChunk++;
+		}
+
+		if (m_currentChunk == m_chunks.size())
+		{
+			// Commands larger than a chunk get one of their own
+			const uint32 capacity = static_cast<uint32>(std::max<uint64>(p_size, c_chunkSize));
+			m_chunks.push_back({std::make_unique_for_overwrite<std::byte[]>(capacity), capacity, 0u});
+		}
+
+		Chunk & chunk  = m_chunks[m_currentChunk];
+		Header *header = reinterpret_cast<Header *>(chunk.data.get() + chunk.used);
+		header->size   = static_cast<uint32>(p_size);
+		chunk.used += static_cast<uint32>(p_size);
+		m_commandCount++;
+		return header;
+	}
+
+	void CommandBuffer::_rollback(Header *p_header)
+	{
+		Chunk &chunk = m_chunks[m_currentChunk];
+		TST_ASSERT_MSG(reinterpret_cast<std::byte *>(p_header) + p_header->size == chunk.data.get() + chunk.used, "Only the last command can be rolled back");
+
+		chunk.used -= p_header->size;
+		m_commandCount--;
+	}
+
+	void CommandBuffer::_consume(void *p_context)
+	{
+		if (m_commandCount == 0u)
+			return;
+
+		for (uint32 chunk_index = 0u; chunk_index <= m_currentChunk && chunk_index < m_chunks.size(); chunk_index++)
+		{
+			Chunk &chunk = m_chunks[chunk_index];
+			for (uint32 offset = 0u; offset < chunk.used;)
+			{
+				Header *header = reinterpret_cast<Header *>(chunk.data.get() + offset);
+				offset += header->size;
+				header->invoke(header, p_context);
+			}
+			chunk.used = 0u;
+		}
+
+		m_currentChunk = 0u;
+		m_commandCount = 0u;
+	}
+}
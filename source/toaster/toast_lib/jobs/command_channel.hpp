@@ -0,0 +1,210 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "system_types.h"
+#include "toast_assert.h"
+#include "mpmc_queue.hpp"
+#include "mpsc_queue.hpp"
+
+namespace toaster::jobs
+{
+	// Commands recorded by one thread, packed back to back into fixed size chunks. Chunks never move, so commands
+	// need not be trivially copyable, and they are kept when the buffer is reset, so a buffer reused every frame stops
+	// allocating once it has seen its largest frame
+	class CommandBuffer : public MpscNode
+	{
+	public:
+		static constexpr uint32 c_chunkSize{16u * 1024u};
+		static constexpr uint32 c_commandAlignment{16u};
+
+		CommandBuffer() = default;
+		~CommandBuffer() { reset(); }
+
+		CommandBuffer(const CommandBuffer &)            = delete;
+		CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+		// p_command is called with a TContext & by execute()
+		template<typename TContext, typename F>
+		void record(F &&p_command)
+		{
+			using Command = std::decay_t<F>;
+			static_assert(alignof(Command) <= c_commandAlignment, "Over aligned commands are not supported");
+			static_assert(std::is_invocable_v<Command &, TContext &>, "Commands have to be callable with the channel's context");
+
+			Header *header = _allocate(sizeof(Header) + _alignSize(sizeof(Command)));
+			try
+			{
+				new (header + 1) Command(std::forward<F>(p_command));
+			}
+			catch (...)
+			{
+				// Nothing may be left behind for execute() to run
+				_rollback(header);
+				throw;
+			}
+			header->invoke = [](Header *p_header, void *p_context)
+			{
+				Command *command = std::launder(reinterpret_cast<Command *>(p_header + 1));
+				if (p_context)
+					(*command)(*static_cast<TContext *>(p_context));
+				command->~Command();
+			};
+		}
+
+		// Runs and destroys the commands in recording order, leaving the buffer empty
+		void execute(void *p_context);
+		// Destroys the commands without running them
+		void reset();
+
+		[[nodiscard]] bool   isEmpty() const { return m_commandCount == 0u; }
+		[[nodiscard]] uint32 getCommandCount() const { return m_commandCount; }
+
+	private:
+		struct alignas(c_commandAlignment) Header
+		{
+			void (*invoke)(Header *p_header, void *p_context); // nullptr context only destroys the command
+			uint32 size;                                         // Header included, to the next command
+		};
+
+		struct Chunk
+		{
+			std::unique_ptr<std::byte[]> data;
+			uint32                       capacity;
+			uint32                       used;
+		};
+
+		static constexpr uint64 _alignSize(const uint64 p_size)
+		{
+			return (p_size + c_commandAlignment - 1u) & ~static_cast<uint64>(c_commandAlignment - 1u);
+		}
+
+		Header *_allocate(uint64 p_size);
+		// Takes back the last _allocate()
+		void    _rollback(Header *p_header);
+		void    _consume(void *p_context);
+
+		std::vector<Chunk> m_chunks;
+		uint32             m_currentChunk{0u};
+		uint32             m_commandCount{0u};
+	};
+
+	// Hands batches of commands from any number of threads to one consuming thread, e.g. the render thread, which
+	// runs them against its TContext. Producers record a whole frame's worth of small commands into a batch of their
+	// own without touching shared state, and only the finished batch crosses threads, with one atomic exchange:
+	//	{
+	//		auto batch = channel.beginBatch();
+	//		batch.record([mesh](RenderContext &p_context) { p_context.upload(mesh); });
+	//	} // Submitted here
+	//	channel.execute(render_context); // On the consumer
+	//
+	// Batches are executed in the order they were submitted, the commands of one batch in the order they were recorded
+	template<typename TContext>
+	class CommandChannel
+	{
+	public:
+		class Batch
+		{
+		public:
+			Batch(Batch &&p_other) noexcept
+				: m_channel(std::exchange(p_other.m_channel, nullptr)), m_buffer(std::exchange(p_other.m_buffer, nullptr))
+			{
+			}
+
+			~Batch() { submit(); }
+
+			Batch(const Batch &)            = delete;
+			Batch &operator=(const Batch &) = delete;
+			Batch &operator=(Batch &&)      = delete;
+
+			template<typename F>
+			void record(F &&p_command)
+			{
+				TST_ASSERT_MSG(m_buffer, "Recording into a submitted batch");
+				m_buffer->record<TContext>(std::forward<F>(p_command));
+			}
+
+			// Hands the batch to the consumer, done by the destructor if not called before
+			void submit()
+			{
+				if (!m_buffer)
+					return;
+
+				m_channel->_submit(m_buffer);
+				m_buffer = nullptr;
+			}
+
+		private:
+			friend class CommandChannel;
+
+			Batch(CommandChannel *p_channel, CommandBuffer *p_buffer) : m_channel(p_channel), m_buffer(p_buffer) {}
+
+			CommandChannel *m_channel;
+			CommandBuffer * m_buffer;
+		};
+
+		// p_pooled_buffers executed buffers are kept for reuse, extra ones are freed
+		explicit CommandChannel(const uint64 p_pooled_buffers = 64u) : m_freeBuffers(p_pooled_buffers) {}
+
+		~CommandChannel()
+		{
+			// Unexecuted batches are dropped, but their commands still get destroyed
+			while (CommandBuffer *buffer = m_submitted.tryPop())
+			{
+				delete buffer;
+			}
+
+			CommandBuffer *buffer;
+			while (m_freeBuffers.tryPop(buffer))
+			{
+				delete buffer;
+			}
+		}
+
+		CommandChannel(const CommandChannel &)            = delete;
+		CommandChannel &operator=(const CommandChannel &) = delete;
+
+		// Any thread
+		[[nodiscard]] Batch beginBatch()
+		{
+			CommandBuffer *buffer;
+			if (!m_freeBuffers.tryPop(buffer))
+				buffer = new CommandBuffer();
+			return Batch(this, buffer);
+		}
+
+		// Consumer only. Runs every batch submitted so far and returns the number of commands run
+		uint32 execute(TContext &p_context)
+		{
+			uint32 executed = 0u;
+			while (CommandBuffer *buffer = m_submitted.tryPop())
+			{
+				executed += buffer->getCommandCount();
+				buffer->execute(&p_context);
+
+				if (!m_freeBuffers.tryPush(buffer))
+					delete buffer;
+			}
+			return executed;
+		}
+
+	private:
+		void _submit(CommandBuffer *p_buffer)
+		{
+			if (p_buffer->isEmpty())
+			{
+				if (!m_freeBuffers.tryPush(p_buffer))
+					delete p_buffer;
+				return;
+			}
+			m_submitted.push(p_buffer);
+		}
+
+		MpscQueue<CommandBuffer>  m_submitted;
+		MpmcQueue<CommandBuffer *> m_freeBuffers;
+	};
+}
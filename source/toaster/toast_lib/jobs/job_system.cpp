@@ -0,0 +1,490 @@
+#include "job_system.hpp"
+#include "work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "logging.hpp"
+#include "memory/small_object_allocator.hpp"
+
+namespace toaster::jobs
+{
+	namespace
+	{
+		using detail::Job;
+
+		// Failed job searches before an idle worker goes to sleep
+		constexpr uint32 c_idleSpinCount{64u};
+
+		// parallelFor() with an automatic grain aims for this many pieces per worker
+		constexpr uint64 c_autoGrainPiecesPerWorker{64u};
+
+		// GlobalState::outstandingJobs counts queued and running jobs in the low half and parked ones in the high half,
+		// so one load tells whether anything is left that could still release the parked ones
+		constexpr uint64 c_parkedJob{1ull << 32u};
+		constexpr uint64 c_activeJobMask{c_parkedJob - 1u};
+
+		// FIFO for the jobs that don't go through the deques, the count lets empty checks skip the lock
+		struct LockedQueue
+		{
+			void push(Job *p_job)
+			{
+				std::lock_guard lock(mutex);
+				jobs.push_back(p_job);
+				count.fetch_add(1u, std::memory_order_relaxed);
+			}
+
+			Job *pop()
+			{
+				if (!count.load(std::memory_order_relaxed))
+					return nullptr;
+
+				std::lock_guard lock(mutex);
+				if (jobs.empty())
+					return nullptr;
+
+				Job *job = jobs.front();
+				jobs.pop_front();
+				count.fetch_sub(1u, std::memory_order_relaxed);
+				return job;
+			}
+
+			std::mutex          mutex;
+			std::deque<Job *>   jobs;
+			std::atomic<uint32> count{0u};
+		};
+
+		struct GlobalState
+		{
+			std::vector<std::unique_ptr<WorkStealingDeque<Job>>> deques; // One per worker, [0] is the main thread's
+			std::vector<std::jthread>                            threads;
+
+			LockedQueue sharedJobs;       // Jobs from threads without a deque and overflow of full deques
+			LockedQueue workerThreadJobs; // EJobAffinity::eWorkerThread
+			LockedQueue mainThreadJobs;   // EJobAffinity::eMainThread
+
+			// Bumped whenever work is queued, sleeping workers wait for it to change
+			alignas(64) std::atomic<uint32> workEpoch{0u};
+			std::atomic<uint32> sleepingWorkers{0u};
+
+			// Submitted but not finished, parked dependents included, see c_parkedJob
+			alignas(64) std::atomic<uint64> outstandingJobs{0u};
+
+			std::atomic<bool> running{false};
+			uint32            workerCount{0u};
+		};
+
+		GlobalState s_state;
+
+		constinit thread_local uint32 tl_workerIndex = c_notAWorker;
+		constinit thread_local uint32 tl_randomState = 0u;
+
+		void cpuRelax()
+		{
+			#if defined(_M_X64) || defined(__x86_64__)
+			_mm_pause();
+			#else
+			std::this_thread::yield();
+			#endif
+		}
+
+		uint32 nextRandom()
+		{
+			// xorshift32, seeded per thread on first use
+			uint32 state = tl_randomState ? tl_randomState : static_cast<uint32>(reinterpret_cast<uintptr_t>(&tl_randomState)) | 1u;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			tl_randomState = state;
+			return state;
+		}
+
+		void wakeWorker()
+		{
+			s_state.workEpoch.fetch_add(1u, std::memory_order_seq_cst);
+			if (s_state.sleepingWorkers.load(std::memory_order_seq_cst))
+				s_state.workEpoch.notify_one();
+		}
+
+		// Own deque first, then the other workers' starting at a random one, then the shared queues
+		Job *findJob(const uint32 p_worker)
+		{
+			if (p_worker == 0u)
+			{
+				if (Job *job = s_state.mainThreadJobs.pop())
+					return job;
+			}
+
+			if (p_worker != c_notAWorker)
+			{
+				if (Job *job = s_state.deques[p_worker]->pop())
+					return job;
+			}
+
+			const uint32 worker_count = s_state.workerCount;
+			const uint32 start        = nextRandom() % worker_count;
+			for (uint32 i = 0u; i < worker_count; i++)
+			{
+				const uint32 victim = (start + i) % worker_count;
+				if (victim == p_worker)
+					continue;
+
+				if (Job *job = s_state.deques[victim]->steal())
+					return job;
+			}
+			if (p_worker != 0u)
+			{
+				if (Job *job = s_state.workerThreadJobs.pop())
+					return job;
+			}
+			return s_state.sharedJobs.pop();
+		}
+	}
+
+	namespace detail
+	{
+		class Scheduler
+		{
+		public:
+			static void schedule(Job *p_job)
+			{
+				if (p_job->affinity == EJobAffinity::eMainThread)
+				{
+					s_state.mainThreadJobs.push(p_job);
+					return;
+				}
+
+				// Without worker threads the main thread has to run them after all
+				if (p_job->affinity == EJobAffinity::eWorkerThread && s_state.workerCount > 1u)
+				{
+					s_state.workerThreadJobs.push(p_job);
+					wakeWorker();
+					return;
+				}
+
+				const uint32 worker = tl_workerIndex;
+				if (worker == c_notAWorker || !s_state.deques[worker]->push(p_job))
+					s_state.sharedJobs.push(p_job);
+				wakeWorker();
+			}
+
+			static void execute(Job *p_job)
+			{
+				JobCounter *counter = p_job->counter;
+
+				p_job->invoke(p_job);
+				memory::smallFree(p_job);
+
+				if (counter)
+					finish(*counter);
+
+				s_state.outstandingJobs.fetch_sub(1u, std::memory_order_release);
+			}
+
+			static void submit(Job *p_job, JobCounter *p_counter, JobCounter *p_dependency)
+			{
+				TST_ASSERT_MSG(s_state.running.load(std::memory_order_relaxed), "Job submitted while the job system is not running");
+
+				p_job->counter = p_counter;
+				if (p_counter)
+					p_counter->m_pending.fetch_add(1u, std::memory_order_relaxed);
+
+				s_state.outstandingJobs.fetch_add(1u, std::memory_order_relaxed);
+
+				if (p_dependency)
+				{
+					lock(*p_dependency);
+					if (p_dependency->m_pending.load(std::memory_order_acquire))
+					{
+						p_job->nextDependent        = p_dependency->m_dependents;
+						p_dependency->m_dependents = p_job;
+						s_state.outstandingJobs.fetch_add(c_parkedJob - 1u, std::memory_order_relaxed);
+						unlock(*p_dependency);
+						return;
+					}
+					unlock(*p_dependency);
+				}
+				schedule(p_job);
+			}
+
+		private:
+			static void lock(JobCounter &p_counter)
+			{
+				while (p_counter.m_locked.exchange(true, std::memory_order_acquire))
+				{
+					while (p_counter.m_locked.load(std::memory_order_relaxed))
+					{
+						cpuRelax();
+					}
+				}
+			}
+
+			static void unlock(JobCounter &p_counter) { p_counter.m_locked.store(false, std::memory_order_release); }
+
+			// The decrement happens under the lock so a waiter can not see zero and destroy the counter while the
+			// dependents are still being taken off it
+			static void finish(JobCounter &p_counter)
+			{
+				lock(p_counter);
+				Job *dependents = nullptr;
+				if (p_counter.m_pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+				{
+					dependents               = p_counter.m_dependents;
+					p_counter.m_dependents = nullptr;
+				}
+				unlock(p_counter);
+
+				// Active again before the finishing job stops counting as active, so shutdown() never sees them stranded
+				while (dependents)
+				{
+					s_state.outstandingJobs.fetch_sub(c_parkedJob - 1u, std::memory_order_relaxed);
+					Job *next = dependents->nextDependent;
+					dependents->nextDependent = nullptr;
+					schedule(dependents);
+					dependents = next;
+				}
+			}
+		};
+
+		void submit(Job *p_job, JobCounter *p_counter, JobCounter *p_dependency)
+		{
+			Scheduler::submit(p_job, p_counter, p_dependency);
+		}
+
+		namespace
+		{
+			struct ParallelForContext
+			{
+				RangeFunction function;
+				void *        context;
+				uint64        grain;
+				JobCounter    counter;
+			};
+
+			// Lazy binary splitting: the range is handed out in halves only while the worker's own deque is empty,
+			// i.e. while everything it spawned so far has been stolen. Busy workers just work through their range
+			bool hasIdleWorkers()
+			{
+				const uint32 worker = tl_workerIndex;
+				if (worker == c_notAWorker)
+					return s_state.sleepingWorkers.load(std::memory_order_relaxed) != 0u;
+				return s_state.deques[worker]->isEmpty();
+			}
+
+			void processRange(ParallelForContext &p_context, uint64 p_begin, uint64 p_end)
+			{
+				while (p_end - p_begin > p_context.grain)
+				{
+					if (p_end - p_begin >= p_context.grain * 2u && hasIdleWorkers())
+					{
+						const uint64 middle = p_begin + (p_end - p_begin) / 2u;
+						jobs::run([&p_context, middle, p_end] { processRange(p_context, middle, p_end); }, &p_context.counter);
+						p_end = middle;
+						continue;
+					}
+
+					p_context.function(p_context.context, p_begin, p_begin + p_context.grain);
+					p_begin += p_context.grain;
+				}
+
+				if (p_begin < p_end)
+					p_context.function(p_context.context, p_begin, p_end);
+			}
+		}
+
+		void parallelFor(const uint64 p_begin, const uint64 p_end, const uint64 p_min_grain, const RangeFunction p_function, void *p_context)
+		{
+			if (p_begin >= p_end)
+				return;
+
+			const uint64 count = p_end - p_begin;
+			if (!isInitialized() || s_state.workerCount == 1u)
+			{
+				p_function(p_context, p_begin, p_end);
+				return;
+			}
+
+			const uint64 grain = p_min_grain ? p_min_grain : std::max<uint64>(count / (s_state.workerCount * c_autoGrainPiecesPerWorker), 1u);
+
+			ParallelForContext context{p_function, p_context, grain, {}};
+			processRange(context, p_begin, p_end);
+			waitFor(context.counter);
+		}
+	}
+
+	namespace
+	{
+		void workerMain(const uint32 p_worker)
+		{
+			tl_workerIndex = p_worker;
+
+			uint32 idle_spins = 0u;
+			while (s_state.running.load(std::memory_order_acquire))
+			{
+				if (Job *job = findJob(p_worker))
+				{
+					detail::Scheduler::execute(job);
+					idle_spins = 0u;
+					continue;
+				}
+
+				if (++idle_spins < c_idleSpinCount)
+				{
+					cpuRelax();
+					continue;
+				}
+
+				// Anything queued after this load changes the epoch, so the wait below can not miss it
+				const uint32 epoch = s_state.workEpoch.load(std::memory_order_seq_cst);
+				if (Job *job = findJob(p_worker))
+				{
+					detail::Scheduler::execute(job);
+					idle_spins = 0u;
+					continue;
+				}
+
+				// Blocks this worker allocated and others freed would otherwise stay parked in its pages while it sleeps
+				memory::smallAllocTrim();
+
+				s_state.sleepingWorkers.fetch_add(1u, std::memory_order_seq_cst);
+				if (s_state.running.load(std::memory_order_acquire))
+					s_state.workEpoch.wait(epoch, std::memory_order_seq_cst);
+				s_state.sleepingWorkers.fetch_sub(1u, std::memory_order_seq_cst);
+				idle_spins = 0u;
+			}
+			tl_workerIndex = c_notAWorker;
+		}
+	}
+
+	void initialize(const JobSystemSettings &p_settings)
+	{
+		TST_ASSERT_MSG(!isInitialized(), "Job system initialized twice");
+
+		const uint32 hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		const uint32 worker_threads   = p_settings.workerThreads == JobSystemSettings::c_autoWorkerThreads ? hardware_threads - 1u : p_settings.workerThreads;
+
+		s_state.workerCount = worker_threads + 1u;
+		s_state.deques.reserve(s_state.workerCount);
+		for (uint32 worker = 0u; worker < s_state.workerCount; worker++)
+		{
+			s_state.deques.push_back(std::make_unique<WorkStealingDeque<Job>>(p_settings.dequeCapacity));
+		}
+
+		tl_workerIndex = 0u;
+		s_state.running.store(true, std::memory_order_release);
+
+		s_state.threads.reserve(worker_threads);
+		for (uint32 worker = 1u; worker < s_state.workerCount; worker++)
+		{
+			s_state.threads.emplace_back(workerMain, worker);
+		}
+
+		LOG_INFO("Job system running on {} worker threads plus the main thread", worker_threads);
+	}
+
+	void shutdown()
+	{
+		TST_ASSERT_MSG(isMainThread(), "The job system has to be shut down from the main thread");
+
+		while (const uint64 outstanding = s_state.outstandingJobs.load(std::memory_order_acquire))
+		{
+			if (Job *job = findJob(0u))
+			{
+				detail::Scheduler::execute(job);
+				continue;
+			}
+
+			// Only jobs parked on counters are left and nothing is running that could release them. Waiting would
+			// never end, so they are leaked instead, their counters may be gone already
+			if ((outstanding & c_activeJobMask) == 0u)
+			{
+				LOG_ERROR("Job system shut down with {} jobs parked on counters that never reached zero", outstanding >> 32u);
+				TST_ASSERT_MSG(false, "Jobs left parked at shutdown");
+				s_state.outstandingJobs.store(0u, std::memory_order_relaxed);
+				break;
+			}
+			std::this_thread::yield();
+		}
+
+		s_state.running.store(false, std::memory_order_release);
+		s_state.workEpoch.fetch_add(1u, std::memory_order_seq_cst);
+		s_state.workEpoch.notify_all();
+		s_state.threads.clear();
+
+		s_state.deques.clear();
+		s_state.workerCount = 0u;
+		tl_workerIndex      = c_notAWorker;
+	}
+
+	bool isInitialized()
+	{
+		return s_state.workerCount != 0u;
+	}
+
+	uint32 getWorkerCount()
+	{
+		return s_state.workerCount;
+	}
+
+	uint32 getCurrentWorkerIndex()
+	{
+		return tl_workerIndex;
+	}
+
+	bool isMainThread()
+	{
+		return tl_workerIndex == 0u;
+	}
+
+	void waitFor(const JobCounter &p_counter)
+	{
+		while (!p_counter.isDone())
+		{
+			if (!tryRunPendingJob())
+				cpuRelax();
+		}
+	}
+
+	bool tryRunPendingJob()
+	{
+		if (!isInitialized())
+			return false;
+
+		Job *job = findJob(tl_workerIndex);
+		if (!job)
+			return false;
+
+		detail::Scheduler::execute(job);
+		return true;
+	}
+
+	void runMainThreadJobs()
+	{
+		TST_ASSERT_MSG(isMainThread(), "Main thread jobs run on the main thread");
+
+		LockedQueue &main_thread_jobs = s_state.mainThreadJobs;
+		if (!main_thread_jobs.count.load(std::memory_order_relaxed))
+			return;
+
+		// Jobs queued by the ones running now wait for the next call
+		std::deque<Job *> queued;
+		{
+			std::lock_guard lock(main_thread_jobs.mutex);
+			queued.swap(main_thread_jobs.jobs);
+			main_thread_jobs.count.store(0u, std::memory_order_relaxed);
+		}
+
+		for (Job *job : queued)
+		{
+			detail::Scheduler::execute(job);
+		}
+	}
+}
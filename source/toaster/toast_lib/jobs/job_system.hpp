@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "system_types.h"
+#include "toast_assert.h"
+#include "memory/small_object_allocator.hpp"
+
+// Work stealing job system. Every worker thread owns a Chase-Lev deque: jobs it spawns go to the bottom of its own
+// deque, it runs them newest first, and workers that run dry steal the oldest job of a random other worker. The
+// main thread is worker 0 and only runs jobs while it waits, so it stays free for the frame loop.
+//
+// Jobs report completion through a JobCounter. Waiting on a counter runs other jobs in the meantime instead of
+// blocking, and runAfter() defers a job until a counter drops to zero without any thread waiting for it:
+//	jobs::JobCounter loaded;
+//	jobs::run([&] { readFile(); }, &loaded);
+//	jobs::runAfter(loaded, [&] { uploadTextures(); }, nullptr, jobs::EJobAffinity::eMainThread);
+//	jobs::waitFor(loaded);
+namespace toaster::jobs
+{
+	enum class EJobAffinity : uint8
+	{
+		eAny,
+		eMainThread,   // GLFW and anything else that has to stay on the main thread, see runMainThreadJobs()
+		eWorkerThread, // Never picked up by the main thread while it waits, for work that must not stall the frame
+	};
+
+	class JobCounter;
+
+	namespace detail
+	{
+		struct Job
+		{
+			void (*invoke)(Job *p_job); // Runs and destroys the callable, the memory is freed by the scheduler
+			JobCounter * counter{nullptr};
+			Job *        nextDependent{nullptr};
+			EJobAffinity affinity{EJobAffinity::eAny};
+		};
+
+		template<typename F>
+		struct CallableJob : Job
+		{
+			F function;
+		};
+
+		class Scheduler;
+
+		// Counts the job against p_counter and queues it, or parks it on p_dependency until that reaches zero
+		void submit(Job *p_job, JobCounter *p_counter, JobCounter *p_dependency);
+
+		using RangeFunction = void (*)(void *p_context, uint64 p_begin, uint64 p_end);
+		void parallelFor(uint64 p_begin, uint64 p_end, uint64 p_min_grain, RangeFunction p_function, void *p_context);
+
+		template<typename F>
+		Job *createJob(F &&p_function, const EJobAffinity p_affinity)
+		{
+			using Callable = CallableJob<std::decay_t<F>>;
+			static_assert(alignof(Callable) <= memory::c_smallAllocAlignment, "Over aligned job captures are not supported");
+
+			Callable *job = new (memory::smallAlloc(sizeof(Callable))) Callable{{}, std::forward<F>(p_function)};
+			job->invoke   = [](Job *p_job)
+			{
+				Callable *callable = static_cast<Callable *>(p_job);
+				callable->function();
+				callable->~Callable();
+			};
+			job->affinity = p_affinity;
+			return job;
+		}
+	}
+
+	// Number of jobs still to finish. Has to outlive the jobs counted on it, and must not be destroyed while jobs
+	// are parked on it with runAfter()
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		~JobCounter() { TST_ASSERT_MSG(isDone(), "Job counter destroyed while jobs are still counted on it"); }
+
+		JobCounter(const JobCounter &)            = delete;
+		JobCounter &operator=(const JobCounter &) = delete;
+
+		// The finishing thread is done with the counter too, so a waiter may destroy it right after
+		[[nodiscard]] bool isDone() const
+		{
+			return m_pending.load(std::memory_order_acquire) == 0u && !m_locked.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] uint32 getPending() const { return m_pending.load(std::memory_order_relaxed); }
+
+	private:
+		friend class detail::Scheduler;
+
+		std::atomic<uint32> m_pending{0u};
+		std::atomic<bool>   m_locked{false}; // Guards m_dependents and the release of them
+		detail::Job *       m_dependents{nullptr};
+	};
+
+	struct JobSystemSettings
+	{
+		static constexpr uint32 c_autoWorkerThreads{UINT32_MAX};
+
+		uint32 workerThreads{c_autoWorkerThreads}; // Besides the main thread, c_autoWorkerThreads for one per core
+		uint32 dequeCapacity{4096u};               // Jobs per worker deque, a power of two. Overflow spills into a shared queue
+	};
+
+	inline constexpr uint32 c_notAWorker{UINT32_MAX};
+
+	// Called from the thread that becomes the main thread
+	void initialize(const JobSystemSettings &p_settings = {});
+	// Runs everything still queued, then joins the workers. Main thread only. Jobs parked with runAfter() on a counter
+	// that can no longer reach zero are reported, asserted on and leaked instead of waited for
+	void shutdown();
+
+	[[nodiscard]] bool isInitialized();
+
+	// Worker threads plus the main thread
+	[[nodiscard]] uint32 getWorkerCount();
+	// 0 on the main thread, c_notAWorker on threads the job system does not own
+	[[nodiscard]] uint32 getCurrentWorkerIndex();
+	[[nodiscard]] bool   isMainThread();
+
+	// Queues p_function. p_counter, if given, is incremented now and decremented once the job has run
+	template<typename F>
+	void run(F &&p_function, JobCounter *p_counter = nullptr, const EJobAffinity p_affinity = EJobAffinity::eAny)
+	{
+		detail::submit(detail::createJob(std::forward<F>(p_function), p_affinity), p_counter, nullptr);
+	}
+
+	// Like run(), but the job is only queued once p_dependency reaches zero. Nothing blocks in the meantime
+	template<typename F>
+	void runAfter(JobCounter &p_dependency, F &&p_function, JobCounter *p_counter = nullptr, const EJobAffinity p_affinity = EJobAffinity::eAny)
+	{
+		detail::submit(detail::createJob(std::forward<F>(p_function), p_affinity), p_counter, &p_dependency);
+	}
+
+	// Runs other jobs on the calling thread until p_counter reaches zero. On the main thread that includes main
+	// thread jobs, so coroutines waiting in switchToMainThread() or pollUntil() can resume inside this call, on top
+	// of the caller's stack. Don't wait on the main thread while holding a lock or halfway through changing state
+	// those jobs may touch, the frame loop should not wait at all and leave them to runMainThreadJobs()
+	void waitFor(const JobCounter &p_counter);
+
+	// Runs one queued job on the calling thread, false if there was none. For wait loops on something other than a
+	// JobCounter, with the same caveat as waitFor() on the main thread
+	bool tryRunPendingJob();
+
+	// Runs the main thread jobs queued so far. Called once per frame by the frame loop
+	void runMainThreadJobs();
+
+	// Calls p_function(begin, end) over disjoint sub-ranges covering [p_begin, p_end) and returns once all of them
+	// are done. Ranges are split in half lazily, only while other workers are out of work, so the grain adapts to
+	// the load instead of being fixed up front. p_min_grain is the smallest range handed out, 0 picks one from the
+	// range size and worker count
+	template<typename F>
+	void parallelFor(const uint64 p_begin, const uint64 p_end, F &&p_function, const uint64 p_min_grain = 0u)
+	{
+		using Function = std::remove_reference_t<F>;
+		detail::parallelFor(p_begin, p_end, p_min_grain, [](void *p_context, const uint64 p_range_begin, const uint64 p_range_end)
+		{
+			(*static_cast<Function *>(p_context))(p_range_begin, p_range_end);
+		}, const_cast<void *>(static_cast<const void *>(&p_function)));
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "system_types.h"
+#include "toast_assert.h"
+
+namespace toaster::jobs
+{
+	// Bounded multi producer, multi consumer ring after Dmitry Vyukov's. A slot's sequence number is its index when
+	// free for the lap in progress and index + 1 once filled, so producers and consumers claim a slot with one
+	// compare and swap on their index and never wait on each other unless the ring is full or empty
+	template<typename T>
+	class MpmcQueue
+	{
+	public:
+		explicit MpmcQueue(const uint64 p_capacity)
+			: m_slots(std::make_unique<Slot[]>(p_capacity)), m_mask(p_capacity - 1u)
+		{
+			TST_ASSERT_MSG(p_capacity && (p_capacity & (p_capacity - 1u)) == 0u, "Queue capacity has to be a power of two");
+
+			for (uint64 i = 0u; i < p_capacity; i++)
+			{
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		~MpmcQueue()
+		{
+			for (uint64 head = m_head.load(std::memory_order_relaxed);; head++)
+			{
+				Slot &slot = m_slots[head & m_mask];
+				if (slot.sequence.load(std::memory_order_relaxed) != head + 1u)
+					break;
+				std::launder(reinterpret_cast<T *>(slot.storage))->~T();
+			}
+		}
+
+		MpmcQueue(const MpmcQueue &)            = delete;
+		MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+		// Any thread. False when full
+		template<typename... Args>
+		bool tryPush(Args &&... p_args)
+		{
+			uint64 tail = m_tail.load(std::memory_order_relaxed);
+			Slot * slot;
+			while (true)
+			{
+				slot                  = &m_slots[tail & m_mask];
+				const int64 sequence  = static_cast<int64>(slot->sequence.load(std::memory_order_acquire));
+				const int64 lap_delta = sequence - static_cast<int64>(tail);
+
+				if (lap_delta == 0)
+				{
+					if (m_tail.compare_exchange_weak(tail, tail + 1u, std::memory_order_relaxed))
+						break;
+				}
+				else if (lap_delta < 0)
+				{
+					return false;
+				}
+				else
+				{
+					tail = m_tail.load(std::memory_order_relaxed);
+				}
+			}
+
+			new (slot->storage) T(std::forward<Args>(p_args)...);
+			slot->sequence.store(tail + 1u, std::memory_order_release);
+			return true;
+		}
+
+		// Any thread. False when empty
+		bool tryPop(T &p_value)
+		{
+			uint64 head = m_head.load(std::memory_order_relaxed);
+			Slot * slot;
+			while (true)
+			{
+				slot                  = &m_slots[head & m_mask];
+				const int64 sequence  = static_cast<int64>(slot->sequence.load(std::memory_order_acquire));
+				const int64 lap_delta = sequence - static_cast<int64>(head + 1u);
+
+				if (lap_delta == 0)
+				{
+					if (m_head.compare_exchange_weak(head, head + 1u, std::memory_order_relaxed))
+						break;
+				}
+				else if (lap_delta < 0)
+				{
+					return false;
+				}
+				else
+				{
+					head = m_head.load(std::memory_order_relaxed);
+				}
+			}
+
+			T *value = std::launder(reinterpret_cast<T *>(slot->storage));
+			p_value  = std::move(*value);
+			value->~T();
+
+			slot->sequence.store(head + m_mask + 1u, std::memory_order_release);
+			return true;
+		}
+
+		[[nodiscard]] uint64 getCapacity() const { return m_mask + 1u; }
+
+	private:
+		// One slot per cache line, neighbouring slots are usually being written and read by different threads
+		struct alignas(64) Slot
+		{
+			std::atomic<uint64> sequence;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		std::unique_ptr<Slot[]> m_slots;
+		uint64                  m_mask;
+
+		// Producers and consumers hammer these independently, keep them off each other's cache line
+		alignas(64) std::atomic<uint64> m_tail{0u};
+		alignas(64) std::atomic<uint64> m_head{0u};
+	};
+}
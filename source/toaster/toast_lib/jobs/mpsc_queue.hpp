@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+#include "system_types.h"
+
+namespace toaster::jobs
+{
+	struct MpscNode
+	{
+		std::atomic<MpscNode *> next{nullptr};
+	};
+
+	// Unbounded intrusive multi producer, single consumer queue after Dmitry Vyukov's. Items derive from MpscNode
+	// and are linked in place, so pushing never allocates and is a single atomic exchange. The queue does not own
+	// its items.
+	//
+	// A producer preempted between its exchange and its link briefly hides everything pushed after it: tryPop()
+	// returns nullptr until that producer continues, even though the queue is not empty
+	template<typename T>
+	class MpscQueue
+	{
+		static_assert(std::is_base_of_v<MpscNode, T>, "MpscQueue items have to derive from MpscNode");
+
+	public:
+		MpscQueue() = default;
+
+		MpscQueue(const MpscQueue &)            = delete;
+		MpscQueue &operator=(const MpscQueue &) = delete;
+
+		// Any thread
+		void push(T *p_item) { _push(p_item); }
+
+		// Consumer only, oldest first
+		T *tryPop()
+		{
+			MpscNode *tail = m_tail;
+			MpscNode *next = tail->next.load(std::memory_order_acquire);
+
+			// The stub only keeps the list from running empty, step over it
+			if (tail == &m_stub)
+			{
+				if (!next)
+					return nullptr;
+
+				m_tail = next;
+				tail   = next;
+				next   = next->next.load(std::memory_order_acquire);
+			}
+
+			if (next)
+			{
+				m_tail = next;
+				return static_cast<T *>(tail);
+			}
+
+			// tail is the last linked node. Unless a push is half done, put the stub behind it so it can go
+			if (tail != m_head.load(std::memory_order_acquire))
+				return nullptr;
+
+			_push(&m_stub);
+
+			next = tail->next.load(std::memory_order_acquire);
+			if (next)
+			{
+				m_tail = next;
+				return static_cast<T *>(tail);
+			}
+			return nullptr;
+		}
+
+		// A snapshot, only meaningful on the consumer
+		[[nodiscard]] bool isEmpty() const
+		{
+			return m_tail == &m_stub && m_stub.next.load(std::memory_order_acquire) == nullptr;
+		}
+
+	private:
+		void _push(MpscNode *p_node)
+		{
+			p_node->next.store(nullptr, std::memory_order_relaxed);
+			MpscNode *previous = m_head.exchange(p_node, std::memory_order_acq_rel);
+			previous->next.store(p_node, std::memory_order_release);
+		}
+
+		MpscNode m_stub;
+
+		alignas(64) std::atomic<MpscNode *> m_head{&m_stub}; // Producers'
+		alignas(64) MpscNode *              m_tail{&m_stub}; // Consumer's
+	};
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "system_types.h"
+#include "toast_assert.h"
+
+namespace toaster::jobs
+{
+	// Bounded single producer, single consumer ring. Every slot carries a sequence number telling whose turn it is,
+	// so each side only ever touches its own index and the slot it is on, never the other side's index. A full or
+	// empty ring is detected from the slot alone
+	template<typename T>
+	class SpscQueue
+	{
+	public:
+		explicit SpscQueue(const uint64 p_capacity)
+			: m_slots(std::make_unique<Slot[]>(p_capacity)), m_mask(p_capacity - 1u)
+		{
+			TST_ASSERT_MSG(p_capacity && (p_capacity & (p_capacity - 1u)) == 0u, "Queue capacity has to be a power of two");
+
+			for (uint64 i = 0u; i < p_capacity; i++)
+			{
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		~SpscQueue()
+		{
+			for (uint64 head = m_head;; head++)
+			{
+				Slot &slot = m_slots[head & m_mask];
+				if (slot.sequence.load(std::memory_order_relaxed) != head + 1u)
+					break;
+				std::launder(reinterpret_cast<T *>(slot.storage))->~T();
+			}
+		}
+
+		SpscQueue(const SpscQueue &)            = delete;
+		SpscQueue &operator=(const SpscQueue &) = delete;
+
+		// Producer only. False when full
+		template<typename... Args>
+		bool tryPush(Args &&... p_args)
+		{
+			Slot &slot = m_slots[m_tail & m_mask];
+			if (slot.sequence.load(std::memory_order_acquire) != m_tail)
+				return false;
+
+			new (slot.storage) T(std::forward<Args>(p_args)...);
+			slot.sequence.store(m_tail + 1u, std::memory_order_release);
+			m_tail++;
+			return true;
+		}
+
+		// Consumer only. False when empty
+		bool tryPop(T &p_value)
+		{
+			Slot &slot = m_slots[m_head & m_mask];
+			if (slot.sequence.load(std::memory_order_acquire) != m_head + 1u)
+				return false;
+
+			T *value = std::launder(reinterpret_cast<T *>(slot.storage));
+			p_value  = std::move(*value);
+			value->~T();
+
+			// Hands the slot back to the producer for its next lap
+			slot.sequence.store(m_head + m_mask + 1u, std::memory_order_release);
+			m_head++;
+			return true;
+		}
+
+		[[nodiscard]] uint64 getCapacity() const { return m_mask + 1u; }
+
+	private:
+		struct Slot
+		{
+			std::atomic<uint64> sequence;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		std::unique_ptr<Slot[]> m_slots;
+		uint64                  m_mask;
+
+		alignas(64) uint64 m_tail{0u}; // Producer's
+		alignas(64) uint64 m_head{0u}; // Consumer's
+	};
+}
@@ -0,0 +1,48 @@
+#include "task.hpp"
+
+#include "logging.hpp"
+
+namespace toaster::jobs
+{
+	namespace
+	{
+		// Starts right away and frees its own frame when done, nobody holds on to it
+		struct DetachedTask
+		{
+			struct promise_type : detail::PooledFrame
+			{
+				DetachedTask       get_return_object() { return {}; }
+				std::suspend_never initial_suspend() noexcept { return {}; }
+				std::suspend_never final_suspend() noexcept { return {}; }
+				void               return_void() {}
+
+				void unhandled_exception()
+				{
+					try
+					{
+						throw;
+					}
+					catch (const std::exception &e)
+					{
+						LOG_ERROR("Unhandled exception in a spawned task: {}", e.what());
+					}
+					catch (...)
+					{
+						LOG_ERROR("Unhandled exception in a spawned task");
+					}
+				}
+			};
+		};
+
+		DetachedTask runDetached(Task<void> p_task)
+		{
+			co_await p_task;
+		}
+	}
+
+	void spawn(Task<void> p_task)
+	{
+		TST_ASSERT_MSG(p_task.isValid(), "Spawning an empty task");
+		runDetached(std::move(p_task));
+	}
+}
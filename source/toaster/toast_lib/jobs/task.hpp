@@ -0,0 +1,439 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <span>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "system_types.h"
+#include "toast_assert.h"
+#include "job_system.hpp"
+#include "memory/small_object_allocator.hpp"
+
+// Coroutine tasks on top of the job system, so a chain of read, import, convert and upload reads as straight line
+// code while every step runs on the thread it belongs on:
+//	jobs::Task<bool> loadMesh(Mesh &p_mesh, std::string p_path)
+//	{
+//		co_await jobs::switchToWorker();
+//		const bool imported = import(p_mesh, p_path);
+//		co_await jobs::switchToMainThread();
+//		upload(p_mesh);
+//		co_await jobs::pollUntil([&] { return device->pollEventQuery(upload_query); }); // Rechecked once a frame
+//		co_return imported;
+//	}
+//	jobs::spawn(loadMesh(mesh, path));
+//
+// Tasks are lazy: nothing runs until the task is awaited, spawned or passed to syncWait(). A task resumes on
+// whichever thread finished what it awaited, switchTo*() moves it explicitly
+namespace toaster::jobs
+{
+	template<typename T = void>
+	class Task;
+
+	namespace detail
+	{
+		// Frames are sized per coroutine and often freed on another thread than the one that allocated them, the small
+		// object allocator handles both
+		struct PooledFrame
+		{
+			static void *operator new(const std::size_t p_size) { return memory::smallAlloc(p_size); }
+			static void  operator delete(void *p_ptr) noexcept { memory::smallFree(p_ptr); }
+		};
+
+		struct TaskPromiseBase : PooledFrame
+		{
+			// Resumes the awaiting coroutine straight from the final suspend point, no stack growth on long chains
+			struct FinalAwaitable
+			{
+				bool await_ready() noexcept { return false; }
+
+				template<typename P>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<P> p_handle) noexcept
+				{
+					return p_handle.promise().continuation;
+				}
+
+				void await_resume() noexcept {}
+			};
+
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			FinalAwaitable      final_suspend() noexcept { return {}; }
+			void                unhandled_exception() { exception = std::current_exception(); }
+
+			std::coroutine_handle<> continuation;
+			std::exception_ptr      exception;
+		};
+
+		template<typename T>
+		struct TaskPromise : TaskPromiseBase
+		{
+			Task<T> get_return_object();
+
+			template<typename U>
+			void return_value(U &&p_value) { value.emplace(std::forward<U>(p_value)); }
+
+			T takeResult()
+			{
+				if (exception)
+					std::rethrow_exception(exception);
+				return std::move(*value);
+			}
+
+			std::optional<T> value;
+		};
+
+		template<>
+		struct TaskPromise<void> : TaskPromiseBase
+		{
+			Task<void> get_return_object();
+
+			void return_void() {}
+
+			void takeResult()
+			{
+				if (exception)
+					std::rethrow_exception(exception);
+			}
+		};
+	}
+
+	template<typename T>
+	class [[nodiscard]] Task
+	{
+	public:
+		using promise_type = detail::TaskPromise<T>;
+
+		Task() = default;
+		explicit Task(std::coroutine_handle<promise_type> p_handle) : m_handle(p_handle) {}
+
+		~Task()
+		{
+			if (m_handle)
+				m_handle.destroy();
+		}
+
+		Task(Task &&p_other) noexcept : m_handle(std::exchange(p_other.m_handle, nullptr)) {}
+
+		Task &operator=(Task &&p_other) noexcept
+		{
+			std::swap(m_handle, p_other.m_handle);
+			return *this;
+		}
+
+		Task(const Task &)            = delete;
+		Task &operator=(const Task &) = delete;
+
+		[[nodiscard]] bool isValid() const { return static_cast<bool>(m_handle); }
+
+		// Starts the task, the awaiting coroutine continues once it has returned. Awaiting twice is not supported
+		auto operator co_await() const noexcept
+		{
+			struct Awaiter
+			{
+				std::coroutine_handle<promise_type> handle;
+
+				bool await_ready() const noexcept { return false; }
+
+				std::coroutine_handle<> await_suspend(const std::coroutine_handle<> p_awaiting) noexcept
+				{
+					handle.promise().continuation = p_awaiting;
+					return handle;
+				}
+
+				T await_resume() { return handle.promise().takeResult(); }
+			};
+
+			TST_ASSERT_MSG(m_handle && !m_handle.done(), "Awaiting an empty or finished task");
+			return Awaiter{m_handle};
+		}
+
+	private:
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+	template<typename T>
+	Task<T> detail::TaskPromise<T>::get_return_object()
+	{
+		return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+	}
+
+	inline Task<void> detail::TaskPromise<void>::get_return_object()
+	{
+		return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+	}
+
+	namespace detail
+	{
+		struct SwitchAwaitable
+		{
+			EJobAffinity affinity;
+
+			bool await_ready() const noexcept
+			{
+				if (affinity == EJobAffinity::eMainThread)
+					return isMainThread();
+
+				// Without worker threads there is nowhere to switch to
+				const uint32 worker = getCurrentWorkerIndex();
+				return getWorkerCount() <= 1u || (worker != c_notAWorker && worker != 0u);
+			}
+
+			void await_suspend(const std::coroutine_handle<> p_handle) const
+			{
+				run([p_handle] { p_handle.resume(); }, nullptr, affinity);
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		template<typename F>
+		struct PollAwaitable
+		{
+			F predicate;
+
+			bool await_ready() { return predicate(); }
+			void await_suspend(const std::coroutine_handle<> p_handle) { _schedule(p_handle); }
+			void await_resume() noexcept {}
+
+			// Main thread jobs queued while runMainThreadJobs() runs wait for its next call, so this checks once a frame
+			void _schedule(const std::coroutine_handle<> p_handle)
+			{
+				run([this, p_handle]
+				{
+					if (predicate())
+						p_handle.resume();
+					else
+						_schedule(p_handle);
+				}, nullptr, EJobAffinity::eMainThread);
+			}
+		};
+	}
+
+	// Continues on a worker thread. Does nothing if already on one, or if the job system has no worker threads
+	[[nodiscard]] inline detail::SwitchAwaitable switchToWorker()
+	{
+		return {EJobAffinity::eWorkerThread};
+	}
+
+	// Continues on the main thread, the next time it runs main thread jobs. Does nothing if already on it
+	[[nodiscard]] inline detail::SwitchAwaitable switchToMainThread()
+	{
+		return {EJobAffinity::eMainThread};
+	}
+
+	// Continues on the main thread once p_predicate() returns true. It is checked right away and then once per
+	// runMainThreadJobs() call, for completion that can only be polled such as GPU fences and event queries
+	template<typename F>
+	[[nodiscard]] detail::PollAwaitable<std::decay_t<F>> pollUntil(F &&p_predicate)
+	{
+		return {std::forward<F>(p_predicate)};
+	}
+
+	namespace detail
+	{
+		struct WhenAllLatch
+		{
+			std::atomic<uint32>     remaining{0u};
+			std::coroutine_handle<> continuation;
+		};
+
+		// Awaits one task of a whenAll() and counts the latch down when done, the last one resumes the continuation
+		class WhenAllItem
+		{
+		public:
+			struct promise_type : PooledFrame
+			{
+				struct FinalAwaitable
+				{
+					bool await_ready() noexcept { return false; }
+
+					std::coroutine_handle<> await_suspend(const std::coroutine_handle<promise_type> p_handle) noexcept
+					{
+						// Once counted down the latch and this frame may be gone, nothing of either is touched after
+						WhenAllLatch *          latch        = p_handle.promise().latch;
+						std::coroutine_handle<> continuation = latch->continuation;
+						if (latch->remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+							return continuation;
+						return std::noop_coroutine();
+					}
+
+					void await_resume() noexcept {}
+				};
+
+				WhenAllItem         get_return_object() { return WhenAllItem(std::coroutine_handle<promise_type>::from_promise(*this)); }
+				std::suspend_always initial_suspend() noexcept { return {}; }
+				FinalAwaitable      final_suspend() noexcept { return {}; }
+				void                return_void() {}
+				void                unhandled_exception() { exception = std::current_exception(); }
+
+				WhenAllLatch *     latch{nullptr};
+				std::exception_ptr exception;
+			};
+
+			explicit WhenAllItem(const std::coroutine_handle<promise_type> p_handle) : m_handle(p_handle) {}
+
+			~WhenAllItem()
+			{
+				if (m_handle)
+					m_handle.destroy();
+			}
+
+			WhenAllItem(WhenAllItem &&p_other) noexcept : m_handle(std::exchange(p_other.m_handle, nullptr)) {}
+			WhenAllItem(const WhenAllItem &)            = delete;
+			WhenAllItem &operator=(const WhenAllItem &) = delete;
+			WhenAllItem &operator=(WhenAllItem &&)      = delete;
+
+			void start(WhenAllLatch &p_latch)
+			{
+				m_handle.promise().latch = &p_latch;
+				m_handle.resume();
+			}
+
+			void rethrow() const
+			{
+				if (m_handle.promise().exception)
+					std::rethrow_exception(m_handle.promise().exception);
+			}
+
+		private:
+			std::coroutine_handle<promise_type> m_handle;
+		};
+
+		// Where a whenAll() item puts its result, std::monostate stands in for void
+		template<typename T>
+		using WhenAllSlot = std::conditional_t<std::is_void_v<T>, std::monostate, std::optional<T>>;
+
+		template<typename T>
+		using WhenAllValue = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+		template<typename T>
+		WhenAllItem makeWhenAllItem(Task<T> &p_task, WhenAllSlot<T> &p_slot)
+		{
+			if constexpr (std::is_void_v<T>)
+				co_await p_task;
+			else
+				p_slot.emplace(co_await p_task);
+		}
+
+		template<typename T>
+		WhenAllValue<T> takeWhenAllValue(WhenAllSlot<T> &p_slot)
+		{
+			if constexpr (std::is_void_v<T>)
+				return {};
+			else
+				return std::move(*p_slot);
+		}
+
+		struct WhenAllAwaitable
+		{
+			explicit WhenAllAwaitable(const std::span<WhenAllItem> p_items) : items(p_items) {}
+
+			std::span<WhenAllItem> items;
+			WhenAllLatch           latch;
+
+			bool await_ready() const noexcept { return items.empty(); }
+
+			// The extra count keeps the items that finish while others are still being started from resuming us early
+			bool await_suspend(const std::coroutine_handle<> p_handle)
+			{
+				latch.continuation = p_handle;
+				latch.remaining.store(static_cast<uint32>(items.size()) + 1u, std::memory_order_relaxed);
+				for (WhenAllItem &item : items)
+				{
+					item.start(latch);
+				}
+				return latch.remaining.fetch_sub(1u, std::memory_order_acq_rel) != 1u;
+			}
+
+			// The first exception wins, the others are dropped
+			void await_resume() const
+			{
+				for (const WhenAllItem &item : items)
+				{
+					item.rethrow();
+				}
+			}
+		};
+	}
+
+	// Starts every task and continues once all of them are done, on the thread that finished last. The tasks are
+	// started one after the other on the calling thread and run in parallel from their first thread switch on
+	template<typename T>
+	Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> whenAll(std::vector<Task<T>> p_tasks)
+	{
+		std::vector<detail::WhenAllSlot<T>> slots(p_tasks.size());
+		std::vector<detail::WhenAllItem>    items;
+		items.reserve(p_tasks.size());
+		for (uint64 i = 0u; i < p_tasks.size(); i++)
+		{
+			items.push_back(detail::makeWhenAllItem(p_tasks[i], slots[i]));
+		}
+
+		co_await detail::WhenAllAwaitable(items);
+
+		if constexpr (!std::is_void_v<T>)
+		{
+			std::vector<T> results;
+			results.reserve(slots.size());
+			for (detail::WhenAllSlot<T> &slot : slots)
+			{
+				results.push_back(std::move(*slot));
+			}
+			co_return results;
+		}
+	}
+
+	// Tasks of different types, void results come back as std::monostate
+	template<typename... Ts>
+	Task<std::tuple<detail::WhenAllValue<Ts>...>> whenAll(Task<Ts>... p_tasks)
+	{
+		std::tuple<detail::WhenAllSlot<Ts>...> slots;
+
+		std::array<detail::WhenAllItem, sizeof...(Ts)> items = [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return std::array<detail::WhenAllItem, sizeof...(Ts)>{detail::makeWhenAllItem(p_tasks, std::get<I>(slots))...};
+		}(std::index_sequence_for<Ts...>{});
+
+		co_await detail::WhenAllAwaitable(items);
+
+		co_return [&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			return std::tuple<detail::WhenAllValue<Ts>...>{detail::takeWhenAllValue<Ts>(std::get<I>(slots))...};
+		}(std::index_sequence_for<Ts...>{});
+	}
+
+	// Starts p_task without anyone awaiting it, its frame is freed once it is done. Exceptions are logged
+	void spawn(Task<void> p_task);
+
+	// Runs p_task to completion on the calling thread, running other jobs while it waits. On the main thread other
+	// tasks may resume inside it, see waitFor(). For tools and shutdown paths, the frame loop should spawn() instead
+	template<typename T>
+	T syncWait(Task<T> p_task)
+	{
+		detail::WhenAllLatch latch;
+		latch.continuation = std::noop_coroutine();
+		latch.remaining.store(1u, std::memory_order_relaxed);
+
+		detail::WhenAllSlot<T> slot;
+		detail::WhenAllItem    item = detail::makeWhenAllItem(p_task, slot);
+		item.start(latch);
+
+		while (latch.remaining.load(std::memory_order_acquire) != 0u)
+		{
+			if (!tryRunPendingJob())
+				std::this_thread::yield();
+		}
+
+		item.rethrow();
+		if constexpr (!std::is_void_v<T>)
+			return std::move(*slot);
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "system_types.h"
+#include "toast_assert.h"
+
+namespace toaster::jobs
+{
+	// Fixed capacity Chase-Lev deque of pointers, following Le et al., "Correct and Efficient Work-Stealing for Weak
+	// Memory Models" (PPoPP 2013). The owning thread pushes and pops at the bottom without contention, any other
+	// thread steals from the top with one compare and swap. The capacity does not grow: push() fails on a full deque
+	// and leaves the decision to the caller
+	template<typename T>
+	class WorkStealingDeque
+	{
+	public:
+		explicit WorkStealingDeque(uint64 p_capacity)
+			: m_buffer(std::make_unique<std::atomic<T *>[]>(p_capacity)), m_mask(static_cast<int64>(p_capacity) - 1)
+		{
+			TST_ASSERT_MSG(p_capacity && (p_capacity & (p_capacity - 1u)) == 0u, "Deque capacity has to be a power of two");
+		}
+
+		WorkStealingDeque(const WorkStealingDeque &)            = delete;
+		WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+		// Owner only
+		bool push(T *p_item)
+		{
+			const int64 bottom = m_bottom.load(std::memory_order_relaxed);
+			const int64 top    = m_top.load(std::memory_order_acquire);
+			if (bottom - top > m_mask)
+				return false;
+
+			// A release store rather than the paper's fence and relaxed store, same code on x86 and visible to TSan
+			m_buffer[bottom & m_mask].store(p_item, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Owner only, newest first. nullptr when empty
+		T *pop()
+		{
+			const int64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64 top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			T *item = m_buffer[bottom & m_mask].load(std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				// Last item, race the thieves for it
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return item;
+		}
+
+		// Any thread, oldest first. nullptr when empty or when another thread won the race
+		T *steal()
+		{
+			int64 top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64 bottom = m_bottom.load(std::memory_order_acquire);
+			if (top >= bottom)
+				return nullptr;
+
+			T *item = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return item;
+		}
+
+		// A snapshot, only exact on the owning thread
+		[[nodiscard]] bool isEmpty() const
+		{
+			return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::unique_ptr<std::atomic<T *>[]> m_buffer;
+		int64                               m_mask;
+
+		// Apart, so thieves hammering the top don't keep invalidating the owner's bottom
+		alignas(64) std::atomic<int64> m_top{0};
+		alignas(64) std::atomic<int64> m_bottom{0};
+	};
+}
@@ -3,6 +3,8 @@
 #include <fmt/color.h>
 #include <fmt/format.h>
 
+#include "memory/tracked_allocator.hpp"
+
 namespace toaster::log
 {
 	enum class ELogLevel
@@ -14,10 +16,15 @@ namespace toaster::log
 		eFatal
 	};
 
+	// Messages that don't fit in the inline storage spill onto the heap under the logging memory tag
+	using LogBuffer = fmt::basic_memory_buffer<char, 256, memory::TrackedAllocator<char, memory::EMemoryTag::eLogging>>;
+
 	template<ELogLevel log_level, typename... Args>
 	void printMessage(fmt::format_string<Args...> format, Args &&... args)
 	{
-		std::string formatted = fmt::format(format, std::forward<Args>(args)...);
+		LogBuffer buffer;
+		fmt::format_to(fmt::appender(buffer), format, std::forward<Args>(args)...);
+		const fmt::string_view formatted{buffer.data(), buffer.size()};
 		if constexpr (log_level == ELogLevel::eTrace)
 		{
 			fmt::print(fmt::fg(fmt::terminal_color::cyan), "{}\n", formatted);
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "math_simd.hpp"
+
+namespace tsm
+{
+	// 4 floats kept in a single SSE register (or a 16 byte aligned array in the scalar build).
+	// Conversion to and from glm is exact, use glm for storage in interfaces and this for the math in hot loops
+	class alignas(16) float4
+	{
+	public:
+		TSM_INLINE float4()
+		{
+			#if TSM_SIMD_SSE4
+			m_value = _mm_setzero_ps();
+			#else
+			m_value[0] = m_value[1] = m_value[2] = m_value[3] = 0.0f;
+			#endif
+		}
+
+		TSM_INLINE explicit float4(float p_scalar)
+		{
+			#if TSM_SIMD_SSE4
+			m_value = _mm_set1_ps(p_scalar);
+			#else
+			m_value[0] = m_value[1] = m_value[2] = m_value[3] = p_scalar;
+			#endif
+		}
+
+		TSM_INLINE float4(float p_x, float p_y, float p_z, float p_w)
+		{
+			#if TSM_SIMD_SSE4
+			m_value = _mm_setr_ps(p_x, p_y, p_z, p_w);
+			#else
+			m_value[0] = p_x;
+			m_value[1] = p_y;
+			m_value[2] = p_z;
+			m_value[3] = p_w;
+			#endif
+		}
+
+		TSM_INLINE explicit float4(const glm::vec4 &p_vec) : float4(loadUnaligned(&p_vec.x))
+		{
+		}
+
+		TSM_INLINE float4(const glm::vec3 &p_vec, float p_w) : float4(p_vec.x, p_vec.y, p_vec.z, p_w)
+		{
+		}
+
+		#if TSM_SIMD_SSE4
+		TSM_INLINE explicit float4(__m128 p_value) : m_value(p_value)
+		{
+		}
+
+		[[nodiscard]] TSM_INLINE __m128 getNative() const { return m_value; }
+		#endif
+
+		// p_ptr must be 16 byte aligned
+		[[nodiscard]] static TSM_INLINE float4 load(const float *p_ptr)
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_load_ps(p_ptr));
+			#else
+			return float4(p_ptr[0], p_ptr[1], p_ptr[2], p_ptr[3]);
+			#endif
+		}
+
+		[[nodiscard]] static TSM_INLINE float4 loadUnaligned(const float *p_ptr)
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_loadu_ps(p_ptr));
+			#else
+			return float4(p_ptr[0], p_ptr[1], p_ptr[2], p_ptr[3]);
+			#endif
+		}
+
+		// p_ptr must be 16 byte aligned
+		TSM_INLINE void store(float *p_ptr) const
+		{
+			#if TSM_SIMD_SSE4
+			_mm_store_ps(p_ptr, m_value);
+			#else
+			storeUnaligned(p_ptr);
+			#endif
+		}
+
+		TSM_INLINE void storeUnaligned(float *p_ptr) const
+		{
+			#if TSM_SIMD_SSE4
+			_mm_storeu_ps(p_ptr, m_value);
+			#else
+			p_ptr[0] = m_value[0];
+			p_ptr[1] = m_value[1];
+			p_ptr[2] = m_value[2];
+			p_ptr[3] = m_value[3];
+			#endif
+		}
+
+		[[nodiscard]] TSM_INLINE float x() const
+		{
+			#if TSM_SIMD_SSE4
+			return _mm_cvtss_f32(m_value);
+			#else
+			return m_value[0];
+			#endif
+		}
+
+		[[nodiscard]] TSM_INLINE float y() const
+		{
+			#if TSM_SIMD_SSE4
+			return _mm_cvtss_f32(simd::splat<1>(m_value));
+			#else
+			return m_value[1];
+			#endif
+		}
+
+		[[nodiscard]] TSM_INLINE float z() const
+		{
+			#if TSM_SIMD_SSE4
+			return _mm_cvtss_f32(simd::splat<2>(m_value));
+			#else
+			return m_value[2];
+			#endif
+		}
+
+		[[nodiscard]] TSM_INLINE float w() const
+		{
+			#if TSM_SIMD_SSE4
+			return _mm_cvtss_f32(simd::splat<3>(m_value));
+			#else
+			return m_value[3];
+			#endif
+		}
+
+		// Goes through memory, prefer x() / y() / z() / w() with a constant index
+		[[nodiscard]] TSM_INLINE float operator[](int p_index) const
+		{
+			alignas(16) float values[4];
+			store(values);
+			return values[p_index];
+		}
+
+		[[nodiscard]] TSM_INLINE glm::vec4 toGlm() const
+		{
+			glm::vec4 result;
+			storeUnaligned(&result.x);
+			return result;
+		}
+
+		[[nodiscard]] TSM_INLINE glm::vec3 toGlm3() const
+		{
+			const glm::vec4 result = toGlm();
+			return {result.x, result.y, result.z};
+		}
+
+		TSM_INLINE float4 operator+(const float4 &p_other) const
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_add_ps(m_value, p_other.m_value));
+			#else
+			return {m_value[0] + p_other.m_value[0], m_value[1] + p_other.m_value[1], m_value[2] + p_other.m_value[2], m_value[3] + p_other.m_value[3]};
+			#endif
+		}
+
+		TSM_INLINE float4 operator-(const float4 &p_other) const
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_sub_ps(m_value, p_other.m_value));
+			#else
+			return {m_value[0] - p_other.m_value[0], m_value[1] - p_other.m_value[1], m_value[2] - p_other.m_value[2], m_value[3] - p_other.m_value[3]};
+			#endif
+		}
+
+		TSM_INLINE float4 operator*(const float4 &p_other) const
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_mul_ps(m_value, p_other.m_value));
+			#else
+			return {m_value[0] * p_other.m_value[0], m_value[1] * p_other.m_value[1], m_value[2] * p_other.m_value[2], m_value[3] * p_other.m_value[3]};
+			#endif
+		}
+
+		TSM_INLINE float4 operator/(const float4 &p_other) const
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_div_ps(m_value, p_other.m_value));
+			#else
+			return {m_value[0] / p_other.m_value[0], m_value[1] / p_other.m_value[1], m_value[2] / p_other.m_value[2], m_value[3] / p_other.m_value[3]};
+			#endif
+		}
+
+		TSM_INLINE float4 operator*(float p_scalar) const { return *this * float4(p_scalar); }
+		TSM_INLINE float4 operator/(float p_scalar) const { return *this / float4(p_scalar); }
+
+		TSM_INLINE float4 operator-() const
+		{
+			#if TSM_SIMD_SSE4
+			return float4(_mm_xor_ps(m_value, simd::signMask()));
+			#else
+			return {-m_value[0], -m_value[1], -m_value[2], -m_value[3]};
+			#endif
+		}
+
+		TSM_INLINE float4 &operator+=(const float4 &p_other) { return *this = *this + p_other; }
+		TSM_INLINE float4 &operator-=(const float4 &p_other) { return *this = *this - p_other; }
+		TSM_INLINE float4 &operator*=(const float4 &p_other) { return *this = *this * p_other; }
+		TSM_INLINE float4 &operator/=(const float4 &p_other) { return *this = *this / p_other; }
+		TSM_INLINE float4 &operator*=(float p_scalar) { return *this = *this * p_scalar; }
+		TSM_INLINE float4 &operator/=(float p_scalar) { return *this = *this / p_scalar; }
+
+		// Exact, component wise
+		[[nodiscard]] TSM_INLINE bool operator==(const float4 &p_other) const
+		{
+			#if TSM_SIMD_SSE4
+			return _mm_movemask_ps(_mm_cmpeq_ps(m_value, p_other.m_value)) == 0xF;
+			#else
+			return m_value[0] == p_other.m_value[0] && m_value[1] == p_other.m_value[1] && m_value[2] == p_other.m_value[2] && m_value[3] == p_other.m_value[3];
+			#endif
+		}
+
+	private:
+		#if TSM_SIMD_SSE4
+		__m128 m_value;
+		#else
+		float m_value[4];
+		#endif
+	};
+
+	static_assert(sizeof(float4) == 16);
+
+	TSM_INLINE float4 operator*(float p_scalar, const float4 &p_vec)
+	{
+		return p_vec * p_scalar;
+	}
+
+	// a * b + c
+	TSM_INLINE float4 madd(const float4 &p_a, const float4 &p_b, const float4 &p_c)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(simd::madd(p_a.getNative(), p_b.getNative(), p_c.getNative()));
+		#else
+		return p_a * p_b + p_c;
+		#endif
+	}
+
+	TSM_INLINE float4 min(const float4 &p_a, const float4 &p_b)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_min_ps(p_a.getNative(), p_b.getNative()));
+		#else
+		return {std::fmin(p_a.x(), p_b.x()), std::fmin(p_a.y(), p_b.y()), std::fmin(p_a.z(), p_b.z()), std::fmin(p_a.w(), p_b.w())};
+		#endif
+	}
+
+	TSM_INLINE float4 max(const float4 &p_a, const float4 &p_b)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_max_ps(p_a.getNative(), p_b.getNative()));
+		#else
+		return {std::fmax(p_a.x(), p_b.x()), std::fmax(p_a.y(), p_b.y()), std::fmax(p_a.z(), p_b.z()), std::fmax(p_a.w(), p_b.w())};
+		#endif
+	}
+
+	TSM_INLINE float4 abs(const float4 &p_vec)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_andnot_ps(simd::signMask(), p_vec.getNative()));
+		#else
+		return {std::fabs(p_vec.x()), std::fabs(p_vec.y()), std::fabs(p_vec.z()), std::fabs(p_vec.w())};
+		#endif
+	}
+
+	TSM_INLINE float4 sqrt(const float4 &p_vec)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_sqrt_ps(p_vec.getNative()));
+		#else
+		return {std::sqrt(p_vec.x()), std::sqrt(p_vec.y()), std::sqrt(p_vec.z()), std::sqrt(p_vec.w())};
+		#endif
+	}
+
+	TSM_INLINE float4 floor(const float4 &p_vec)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_floor_ps(p_vec.getNative()));
+		#else
+		return {std::floor(p_vec.x()), std::floor(p_vec.y()), std::floor(p_vec.z()), std::floor(p_vec.w())};
+		#endif
+	}
+
+	TSM_INLINE float4 lerp(const float4 &p_a, const float4 &p_b, float p_t)
+	{
+		return madd(p_b - p_a, float4(p_t), p_a);
+	}
+
+	// All four lanes hold the result
+	TSM_INLINE float4 dotSplat(const float4 &p_a, const float4 &p_b)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_dp_ps(p_a.getNative(), p_b.getNative(), 0xFF));
+		#else
+		return float4(p_a.x() * p_b.x() + p_a.y() * p_b.y() + p_a.z() * p_b.z() + p_a.w() * p_b.w());
+		#endif
+	}
+
+	// Ignores w, all four lanes hold the result
+	TSM_INLINE float4 dot3Splat(const float4 &p_a, const float4 &p_b)
+	{
+		#if TSM_SIMD_SSE4
+		return float4(_mm_dp_ps(p_a.getNative(), p_b.getNative(), 0x7F));
+		#else
+		return float4(p_a.x() * p_b.x() + p_a.y() * p_b.y() + p_a.z() * p_b.z());
+		#endif
+	}
+
+	TSM_INLINE float dot(const float4 &p_a, const float4 &p_b) { return dotSplat(p_a, p_b).x(); }
+	TSM_INLINE float dot3(const float4 &p_a, const float4 &p_b) { return dot3Splat(p_a, p_b).x(); }
+
+	// Cross product of the xyz parts, w of the result is 0
+	TSM_INLINE float4 cross3(const float4 &p_a, const float4 &p_b)
+	{
+		#if TSM_SIMD_SSE4
+		const __m128 a   = p_a.getNative();
+		const __m128 b   = p_b.getNative();
+		const __m128 zxy = simd::nmadd(simd::swizzle<1, 2, 0, 3>(a), b, _mm_mul_ps(a, simd::swizzle<1, 2, 0, 3>(b)));
+		return float4(simd::swizzle<1, 2, 0, 3>(zxy));
+		#else
+		return {p_a.y() * p_b.z() - p_a.z() * p_b.y(), p_a.z() * p_b.x() - p_a.x() * p_b.z(), p_a.x() * p_b.y() - p_a.y() * p_b.x(), 0.0f};
+		#endif
+	}
+
+	TSM_INLINE float length(const float4 &p_vec) { return sqrt(dotSplat(p_vec, p_vec)).x(); }
+	TSM_INLINE float length3(const float4 &p_vec) { return sqrt(dot3Splat(p_vec, p_vec)).x(); }
+
+	TSM_INLINE float4 normalize(const float4 &p_vec) { return p_vec / sqrt(dotSplat(p_vec, p_vec)); }
+	// Normalizes xyz, w is scaled along with them
+	TSM_INLINE float4 normalize3(const float4 &p_vec) { return p_vec / sqrt(dot3Splat(p_vec, p_vec)); }
+}
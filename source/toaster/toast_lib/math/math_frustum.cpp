@@ -0,0 +1,232 @@
+#include "math_frustum.hpp"
+#include "math_simd_wide.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "toast_assert.h"
+#include "jobs/job_system.hpp"
+
+namespace tsm
+{
+	namespace
+	{
+		// Plane components split out so the kernels can broadcast them
+		struct CullPlanes
+		{
+			float normal[Frustum::ePlaneCount][3];
+			float absNormal[Frustum::ePlaneCount][3];
+			float distance[Frustum::ePlaneCount];
+
+			explicit CullPlanes(const Frustum &p_frustum)
+			{
+				for (uint32 plane = 0u; plane < Frustum::ePlaneCount; plane++)
+				{
+					for (uint32 axis = 0u; axis < 3u; axis++)
+					{
+						normal[plane][axis]    = p_frustum.planes[plane][axis];
+						absNormal[plane][axis] = std::abs(p_frustum.planes[plane][axis]);
+					}
+					distance[plane] = p_frustum.planes[plane].w;
+				}
+			}
+		};
+
+		// Either extents (AABBs) or radii (spheres, extentY and extentZ unused)
+		struct CullInput
+		{
+			const float *centerX;
+			const float *centerY;
+			const float *centerZ;
+			const float *extentX;
+			const float *extentY;
+			const float *extentZ;
+		};
+
+		// Writes the visible indices in [p_begin, p_end) to p_out and returns the index it stopped at, the remainder
+		// is finished by the ScalarOps instantiation
+		template<typename Ops, bool IsSphere>
+		uint64 cullKernel(const CullPlanes &p_planes, const CullInput &p_input, uint64 p_begin, uint64 p_end, uint32 *&p_out)
+		{
+			using V = typename Ops::type;
+
+			constexpr uint32 c_allLanes = static_cast<uint32>((1ull << Ops::c_width) - 1u);
+
+			const V zero = Ops::set1(0.0f);
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const V x = Ops::load(p_input.centerX + i);
+				const V y = Ops::load(p_input.centerY + i);
+				const V z = Ops::load(p_input.centerZ + i);
+
+				const V ex = Ops::load(p_input.extentX + i);
+				V       ey{}, ez{};
+				if constexpr (!IsSphere)
+				{
+					ey = Ops::load(p_input.extentY + i);
+					ez = Ops::load(p_input.extentZ + i);
+				}
+
+				uint32 outside = 0u;
+				for (uint32 plane = 0u; plane < Frustum::ePlaneCount; plane++)
+				{
+					const float *n = p_planes.normal[plane];
+
+					const V distance = Ops::madd(Ops::set1(n[0]), x, Ops::madd(Ops::set1(n[1]), y, Ops::madd(Ops::set1(n[2]), z, Ops::set1(p_planes.distance[plane]))));
+
+					// Projected radius of the box onto the plane normal
+					V radius;
+					if constexpr (IsSphere)
+					{
+						radius = ex;
+					}
+					else
+					{
+						const float *a = p_planes.absNormal[plane];
+						radius         = Ops::madd(Ops::set1(a[0]), ex, Ops::madd(Ops::set1(a[1]), ey, Ops::mul(Ops::set1(a[2]), ez)));
+					}
+
+					outside |= Ops::lessMask(Ops::add(distance, radius), zero);
+					if (outside == c_allLanes)
+						break;
+				}
+
+				for (uint32 visible = ~outside & c_allLanes; visible; visible &= visible - 1u)
+				{
+					*p_out++ = static_cast<uint32>(i + std::countr_zero(visible));
+				}
+			}
+			return i;
+		}
+
+		// Returns how many indices were written to p_out
+		template<bool IsSphere>
+		uint32 cullRange(const CullPlanes &p_planes, const CullInput &p_input, uint64 p_begin, uint64 p_end, uint32 *p_out)
+		{
+			uint32 *     out  = p_out;
+			const uint64 tail = cullKernel<simd::WideOps, IsSphere>(p_planes, p_input, p_begin, p_end, out);
+			cullKernel<simd::ScalarOps, IsSphere>(p_planes, p_input, tail, p_end, out);
+			return static_cast<uint32>(out - p_out);
+		}
+
+		// Objects per parallel chunk, a multiple of 64 so neighbouring chunks do not share cache lines of the output.
+		// About 10us of work, well above the cost of handing out a job
+		constexpr uint64 c_cullChunkSize{16'384u};
+
+		template<bool IsSphere>
+		uint32 cull(const Frustum &p_frustum, const CullInput &p_input, uint64 p_count, std::vector<uint32> &p_out_visible, bool p_parallel)
+		{
+			TST_ASSERT_MSG(p_count <= UINT32_MAX, "Culling is limited to 2^32 objects");
+
+			const CullPlanes planes(p_frustum);
+			p_out_visible.resize(p_count);
+
+			if (!p_parallel || p_count < c_parallelCullThreshold)
+			{
+				const uint32 visible = cullRange<IsSphere>(planes, p_input, 0u, p_count, p_out_visible.data());
+				p_out_visible.resize(visible);
+				return visible;
+			}
+
+			// Each chunk writes its indices at its own offset, then the chunks are packed together in order
+			const uint32 chunks = static_cast<uint32>((p_count + c_cullChunkSize - 1u) / c_cullChunkSize);
+
+			std::vector<uint32> chunk_visible(chunks, 0u);
+			toaster::jobs::parallelFor(0u, chunks, [&](const uint64 p_chunk_begin, const uint64 p_chunk_end)
+			{
+				for (uint64 chunk = p_chunk_begin; chunk < p_chunk_end; chunk++)
+				{
+					const uint64 begin   = chunk * c_cullChunkSize;
+					const uint64 end     = std::min(begin + c_cullChunkSize, p_count);
+					chunk_visible[chunk] = cullRange<IsSphere>(planes, p_input, begin, end, p_out_visible.data() + begin);
+				}
+			}, 1u);
+
+			uint32 visible = chunk_visible[0];
+			for (uint32 chunk = 1u; chunk < chunks; chunk++)
+			{
+				std::memmove(p_out_visible.data() + visible, p_out_visible.data() + chunk * c_cullChunkSize, chunk_visible[chunk] * sizeof(uint32));
+				visible += chunk_visible[chunk];
+			}
+
+			p_out_visible.resize(visible);
+			return visible;
+		}
+
+		CullInput aabbInput(const Float3Stream &p_centers, const Float3Stream &p_extents)
+		{
+			TST_ASSERT_MSG(p_centers.size() == p_extents.size(), "Every AABB center needs extents");
+			return {p_centers.x(), p_centers.y(), p_centers.z(), p_extents.x(), p_extents.y(), p_extents.z()};
+		}
+
+		CullInput sphereInput(const Float3Stream &p_centers, std::span<const float> p_radii)
+		{
+			TST_ASSERT_MSG(p_centers.size() == p_radii.size(), "Every sphere center needs a radius");
+			return {p_centers.x(), p_centers.y(), p_centers.z(), p_radii.data(), nullptr, nullptr};
+		}
+	}
+
+	Frustum Frustum::fromMatrix(const glm::mat4 &p_view_projection)
+	{
+		// Gribb / Hartmann: each plane is the last row of the matrix plus or minus one of the others
+		const glm::mat4 m = glm::transpose(p_view_projection);
+
+		Frustum frustum;
+		frustum.planes[eLeft]   = m[3] + m[0];
+		frustum.planes[eRight]  = m[3] - m[0];
+		frustum.planes[eBottom] = m[3] + m[1];
+		frustum.planes[eTop]    = m[3] - m[1];
+		frustum.planes[eNear]   = m[3] + m[2];
+		frustum.planes[eFar]    = m[3] - m[2];
+
+		for (glm::vec4 &plane : frustum.planes)
+		{
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	bool Frustum::isSphereVisible(const glm::vec3 &p_center, const float p_radius) const
+	{
+		for (const glm::vec4 &plane : planes)
+		{
+			if (glm::dot(glm::vec3(plane), p_center) + plane.w < -p_radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::isAabbVisible(const glm::vec3 &p_center, const glm::vec3 &p_extents) const
+	{
+		for (const glm::vec4 &plane : planes)
+		{
+			const glm::vec3 normal = glm::vec3(plane);
+			if (glm::dot(normal, p_center) + plane.w < -glm::dot(glm::abs(normal), p_extents))
+				return false;
+		}
+		return true;
+	}
+
+	uint32 cullAabbs(const Frustum &p_frustum, const Float3Stream &p_centers, const Float3Stream &p_extents, std::vector<uint32> &p_out_visible)
+	{
+		return cull<false>(p_frustum, aabbInput(p_centers, p_extents), p_centers.size(), p_out_visible, false);
+	}
+
+	uint32 cullSpheres(const Frustum &p_frustum, const Float3Stream &p_centers, std::span<const float> p_radii, std::vector<uint32> &p_out_visible)
+	{
+		return cull<true>(p_frustum, sphereInput(p_centers, p_radii), p_centers.size(), p_out_visible, false);
+	}
+
+	uint32 cullAabbsParallel(const Frustum &p_frustum, const Float3Stream &p_centers, const Float3Stream &p_extents, std::vector<uint32> &p_out_visible)
+	{
+		return cull<false>(p_frustum, aabbInput(p_centers, p_extents), p_centers.size(), p_out_visible, true);
+	}
+
+	uint32 cullSpheresParallel(const Frustum &p_frustum, const Float3Stream &p_centers, std::span<const float> p_radii, std::vector<uint32> &p_out_visible)
+	{
+		return cull<true>(p_frustum, sphereInput(p_centers, p_radii), p_centers.size(), p_out_visible, true);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+#include "math_stream.hpp"
+
+namespace tsm
+{
+	// Six planes stored as (normal, d), a point p is inside a plane when dot(normal, p) + d >= 0
+	struct Frustum
+	{
+		enum EPlane : uint32
+		{
+			eLeft,
+			eRight,
+			eBottom,
+			eTop,
+			eNear,
+			eFar,
+
+			ePlaneCount
+		};
+
+		glm::vec4 planes[ePlaneCount]{};
+
+		// Extracts normalized planes from projection * view. Expects the -1..1 clip depth glm::perspective produces
+		// by default, the Vulkan Y flip in the projection does not matter
+		[[nodiscard]] static Frustum fromMatrix(const glm::mat4 &p_view_projection);
+
+		[[nodiscard]] bool isSphereVisible(const glm::vec3 &p_center, float p_radius) const;
+		[[nodiscard]] bool isAabbVisible(const glm::vec3 &p_center, const glm::vec3 &p_extents) const;
+	};
+
+	// Below this many objects the parallel variants just run on the calling thread
+	inline constexpr uint64 c_parallelCullThreshold{32'768u};
+
+	// Batch culling over structure of arrays bounds. p_out_visible is replaced with the indices of the visible
+	// objects in ascending order, the return value is their count. The test is conservative: a volume next to a
+	// frustum corner can be outside without being fully behind any single plane, it is reported as visible
+
+	// AABBs as center and half extents
+	uint32 cullAabbs(const Frustum &p_frustum, const Float3Stream &p_centers, const Float3Stream &p_extents, std::vector<uint32> &p_out_visible);
+	uint32 cullSpheres(const Frustum &p_frustum, const Float3Stream &p_centers, std::span<const float> p_radii, std::vector<uint32> &p_out_visible);
+
+	// Split into chunks run with jobs::parallelFor() once there are at least c_parallelCullThreshold objects, on the
+	// calling thread alone when the job system is not running. Same output as the single threaded versions
+	uint32 cullAabbsParallel(const Frustum &p_frustum, const Float3Stream &p_centers, const Float3Stream &p_extents, std::vector<uint32> &p_out_visible);
+	uint32 cullSpheresParallel(const Frustum &p_frustum, const Float3Stream &p_centers, std::span<const float> p_radii, std::vector<uint32> &p_out_visible);
+}
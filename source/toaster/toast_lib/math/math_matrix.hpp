@@ -0,0 +1,233 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include "math_float4.hpp"
+
+namespace tsm
+{
+	// Column major 4x4 matrix with the same memory layout as glm::mat4, so conversions are plain loads and stores.
+	// Multiplication order matches glm and GLSL: (proj * view * model) * point
+	class alignas(16) float4x4
+	{
+	public:
+		// Identity
+		TSM_INLINE float4x4() : m_columns{float4(1.0f, 0.0f, 0.0f, 0.0f), float4(0.0f, 1.0f, 0.0f, 0.0f), float4(0.0f, 0.0f, 1.0f, 0.0f), float4(0.0f, 0.0f, 0.0f, 1.0f)}
+		{
+		}
+
+		TSM_INLINE float4x4(const float4 &p_c0, const float4 &p_c1, const float4 &p_c2, const float4 &p_c3) : m_columns{p_c0, p_c1, p_c2, p_c3}
+		{
+		}
+
+		TSM_INLINE explicit float4x4(const glm::mat4 &p_mat)
+			: m_columns{float4(p_mat[0]), float4(p_mat[1]), float4(p_mat[2]), float4(p_mat[3])}
+		{
+		}
+
+		[[nodiscard]] static TSM_INLINE float4x4 identity() { return {}; }
+
+		[[nodiscard]] TSM_INLINE glm::mat4 toGlm() const
+		{
+			glm::mat4 result;
+			for (int i = 0; i < 4; i++)
+			{
+				m_columns[i].storeUnaligned(&result[i].x);
+			}
+			return result;
+		}
+
+		[[nodiscard]] TSM_INLINE const float4 &operator[](int p_column) const { return m_columns[p_column]; }
+		[[nodiscard]] TSM_INLINE float4 &      operator[](int p_column) { return m_columns[p_column]; }
+
+		TSM_INLINE float4 operator*(const float4 &p_vec) const
+		{
+			#if TSM_SIMD_SSE4
+			const __m128 v      = p_vec.getNative();
+			__m128       result = _mm_mul_ps(m_columns[0].getNative(), simd::splat<0>(v));
+			result              = simd::madd(m_columns[1].getNative(), simd::splat<1>(v), result);
+			result              = simd::madd(m_columns[2].getNative(), simd::splat<2>(v), result);
+			result              = simd::madd(m_columns[3].getNative(), simd::splat<3>(v), result);
+			return float4(result);
+			#else
+			return m_columns[0] * p_vec.x() + m_columns[1] * p_vec.y() + m_columns[2] * p_vec.z() + m_columns[3] * p_vec.w();
+			#endif
+		}
+
+		TSM_INLINE float4x4 operator*(const float4x4 &p_other) const
+		{
+			#if TSM_SIMD_AVX2
+			// Two result columns at a time, each 128 bit half works on its own column
+			const auto duplicate = [](const float4 &p_column)
+			{
+				const __m128 column = p_column.getNative();
+				return _mm256_insertf128_ps(_mm256_castps128_ps256(column), column, 1);
+			};
+
+			const __m256 a0 = duplicate(m_columns[0]);
+			const __m256 a1 = duplicate(m_columns[1]);
+			const __m256 a2 = duplicate(m_columns[2]);
+			const __m256 a3 = duplicate(m_columns[3]);
+
+			const auto multiply_pair = [&](const float4 *p_columns)
+			{
+				const __m256 b = _mm256_loadu_ps(reinterpret_cast<const float *>(p_columns));
+
+				__m256 columns = _mm256_mul_ps(a0, _mm256_shuffle_ps(b, b, 0x00));
+				columns        = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b, b, 0x55), columns);
+				columns        = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b, b, 0xAA), columns);
+				return _mm256_fmadd_ps(a3, _mm256_shuffle_ps(b, b, 0xFF), columns);
+			};
+
+			const __m256 c01 = multiply_pair(&p_other.m_columns[0]);
+			const __m256 c23 = multiply_pair(&p_other.m_columns[2]);
+
+			return {
+				float4(_mm256_castps256_ps128(c01)), float4(_mm256_extractf128_ps(c01, 1)),
+				float4(_mm256_castps256_ps128(c23)), float4(_mm256_extractf128_ps(c23, 1)),
+			};
+			#else
+			return {*this * p_other.m_columns[0], *this * p_other.m_columns[1], *this * p_other.m_columns[2], *this * p_other.m_columns[3]};
+			#endif
+		}
+
+		TSM_INLINE float4x4 &operator*=(const float4x4 &p_other) { return *this = *this * p_other; }
+
+		[[nodiscard]] TSM_INLINE bool operator==(const float4x4 &p_other) const
+		{
+			return m_columns[0] == p_other.m_columns[0] && m_columns[1] == p_other.m_columns[1] && m_columns[2] == p_other.m_columns[2] && m_columns[3] == p_other.m_columns[3];
+		}
+
+	private:
+		float4 m_columns[4];
+	};
+
+	static_assert(sizeof(float4x4) == sizeof(glm::mat4));
+
+	TSM_INLINE float4x4 transpose(const float4x4 &p_mat)
+	{
+		#if TSM_SIMD_SSE4
+		__m128 c0 = p_mat[0].getNative();
+		__m128 c1 = p_mat[1].getNative();
+		__m128 c2 = p_mat[2].getNative();
+		__m128 c3 = p_mat[3].getNative();
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		return {float4(c0), float4(c1), float4(c2), float4(c3)};
+		#else
+		return {
+			float4(p_mat[0].x(), p_mat[1].x(), p_mat[2].x(), p_mat[3].x()),
+			float4(p_mat[0].y(), p_mat[1].y(), p_mat[2].y(), p_mat[3].y()),
+			float4(p_mat[0].z(), p_mat[1].z(), p_mat[2].z(), p_mat[3].z()),
+			float4(p_mat[0].w(), p_mat[1].w(), p_mat[2].w(), p_mat[3].w()),
+		};
+		#endif
+	}
+
+	#if TSM_SIMD_SSE4
+	namespace simd
+	{
+		// The 2x2 helpers for inverse() below. A 2x2 matrix is packed as (m00, m01, m10, m11)
+
+		// A * B
+		TSM_INLINE __m128 mat2Mul(__m128 p_a, __m128 p_b)
+		{
+			return madd(p_a, swizzle<0, 3, 0, 3>(p_b), _mm_mul_ps(swizzle<1, 0, 3, 2>(p_a), swizzle<2, 1, 2, 1>(p_b)));
+		}
+
+		// adj(A) * B
+		TSM_INLINE __m128 mat2AdjMul(__m128 p_a, __m128 p_b)
+		{
+			return nmadd(swizzle<1, 1, 2, 2>(p_a), swizzle<2, 3, 0, 1>(p_b), _mm_mul_ps(swizzle<3, 3, 0, 0>(p_a), p_b));
+		}
+
+		// A * adj(B)
+		TSM_INLINE __m128 mat2MulAdj(__m128 p_a, __m128 p_b)
+		{
+			return nmadd(swizzle<1, 0, 3, 2>(p_a), swizzle<2, 1, 2, 1>(p_b), _mm_mul_ps(p_a, swizzle<3, 0, 3, 0>(p_b)));
+		}
+	}
+	#endif
+
+	// General inverse through 2x2 block matrices. The result is undefined for singular matrices
+	TSM_INLINE float4x4 inverse(const float4x4 &p_mat)
+	{
+		#if TSM_SIMD_SSE4
+		// The block formulas are written for rows, running them on columns gives inverse(M^T)^T = inverse(M)
+		const __m128 c0 = p_mat[0].getNative();
+		const __m128 c1 = p_mat[1].getNative();
+		const __m128 c2 = p_mat[2].getNative();
+		const __m128 c3 = p_mat[3].getNative();
+
+		// M = | A B |
+		//     | C D |
+		const __m128 a = _mm_movelh_ps(c0, c1);
+		const __m128 b = _mm_movehl_ps(c1, c0);
+		const __m128 c = _mm_movelh_ps(c2, c3);
+		const __m128 d = _mm_movehl_ps(c3, c2);
+
+		// (|A|, |B|, |C|, |D|)
+		const __m128 det_sub = _mm_sub_ps(_mm_mul_ps(simd::shuffle<0, 2, 0, 2>(c0, c2), simd::shuffle<1, 3, 1, 3>(c1, c3)),
+										  _mm_mul_ps(simd::shuffle<1, 3, 1, 3>(c0, c2), simd::shuffle<0, 2, 0, 2>(c1, c3)));
+		const __m128 det_a = simd::splat<0>(det_sub);
+		const __m128 det_b = simd::splat<1>(det_sub);
+		const __m128 det_c = simd::splat<2>(det_sub);
+		const __m128 det_d = simd::splat<3>(det_sub);
+
+		const __m128 d_c = simd::mat2AdjMul(d, c);
+		const __m128 a_b = simd::mat2AdjMul(a, b);
+
+		__m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), simd::mat2Mul(b, d_c));
+		__m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), simd::mat2Mul(c, a_b));
+		__m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), simd::mat2MulAdj(d, a_b));
+		__m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), simd::mat2MulAdj(a, d_c));
+
+		// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		__m128 det_m = simd::madd(det_b, det_c, _mm_mul_ps(det_a, det_d));
+		__m128 trace = _mm_mul_ps(a_b, simd::swizzle<0, 2, 1, 3>(d_c));
+		trace        = _mm_hadd_ps(trace, trace);
+		trace        = _mm_hadd_ps(trace, trace);
+		det_m        = _mm_sub_ps(det_m, trace);
+
+		const __m128 rcp_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+
+		x = _mm_mul_ps(x, rcp_det);
+		y = _mm_mul_ps(y, rcp_det);
+		z = _mm_mul_ps(z, rcp_det);
+		w = _mm_mul_ps(w, rcp_det);
+
+		// Applies the final adjugate and puts the blocks back together in one shuffle
+		return {
+			float4(simd::shuffle<3, 1, 3, 1>(x, y)),
+			float4(simd::shuffle<2, 0, 2, 0>(x, y)),
+			float4(simd::shuffle<3, 1, 3, 1>(z, w)),
+			float4(simd::shuffle<2, 0, 2, 0>(z, w)),
+		};
+		#else
+		return float4x4(glm::inverse(p_mat.toGlm()));
+		#endif
+	}
+
+	// Inverse of a matrix made of rotation, scale and translation only (no projection), cheaper than inverse()
+	TSM_INLINE float4x4 inverseAffine(const float4x4 &p_mat)
+	{
+		// Inverse of the upper 3x3 is its adjugate over the determinant, the columns of the adjugate's transpose are
+		// the cross products of the original columns
+		const float4 c0 = p_mat[0];
+		const float4 c1 = p_mat[1];
+		const float4 c2 = p_mat[2];
+
+		const float4 r0 = cross3(c1, c2);
+		const float4 r1 = cross3(c2, c0);
+		const float4 r2 = cross3(c0, c1);
+
+		const float4 rcp_det = float4(1.0f) / dot3Splat(c0, r0);
+
+		// Rows of the inverse 3x3, w is 0 thanks to cross3
+		float4x4 result = transpose(float4x4(r0 * rcp_det, r1 * rcp_det, r2 * rcp_det, float4(0.0f, 0.0f, 0.0f, 1.0f)));
+
+		const float4 translation = p_mat[3];
+		result[3]                = -(result * float4(translation.x(), translation.y(), translation.z(), 0.0f)) + float4(0.0f, 0.0f, 0.0f, 1.0f);
+		return result;
+	}
+}
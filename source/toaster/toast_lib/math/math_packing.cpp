@@ -0,0 +1,363 @@
+#include "math_packing.hpp"
+#include "math_simd_wide.hpp"
+#include "math_transcendental.hpp"
+
+#include <climits>
+#include <cstring>
+
+namespace tsm
+{
+	namespace
+	{
+		// The scalar functions run the same lane code with ScalarOps, which keeps them bit identical to the batch encoders
+
+		template<typename Ops>
+		TSM_INLINE typename Ops::itype toSnorm(const typename Ops::type p_value, const float p_scale)
+		{
+			const typename Ops::type clamped = Ops::min(Ops::max(p_value, Ops::set1(-1.0f)), Ops::set1(1.0f));
+			return Ops::toInt(Ops::round(Ops::mul(clamped, Ops::set1(p_scale))));
+		}
+
+		template<typename Ops>
+		TSM_INLINE void encodeOctahedralLanes(const typename Ops::type p_x, const typename Ops::type p_y, const typename Ops::type p_z, typename Ops::type &p_out_x, typename Ops::type &p_out_y)
+		{
+			using V = typename Ops::type;
+
+			const V one       = Ops::set1(1.0f);
+			const V sign_mask = Ops::set1(-0.0f);
+
+			const V inv_l1 = Ops::div(one, Ops::add(Ops::add(simd::abs<Ops>(p_x), simd::abs<Ops>(p_y)), simd::abs<Ops>(p_z)));
+			const V x      = Ops::mul(p_x, inv_l1);
+			const V y      = Ops::mul(p_y, inv_l1);
+
+			// The lower half folds over the diagonals, 0 counts as positive
+			const V sign_x   = Ops::bitOr(Ops::bitAnd(x, sign_mask), one);
+			const V sign_y   = Ops::bitOr(Ops::bitAnd(y, sign_mask), one);
+			const V folded_x = Ops::mul(Ops::sub(one, simd::abs<Ops>(y)), sign_x);
+			const V folded_y = Ops::mul(Ops::sub(one, simd::abs<Ops>(x)), sign_y);
+
+			const typename Ops::mask lower = Ops::less(p_z, Ops::set1(0.0f));
+			p_out_x                        = Ops::select(lower, folded_x, x);
+			p_out_y                        = Ops::select(lower, folded_y, y);
+		}
+
+		template<typename Ops>
+		TSM_INLINE typename Ops::itype packOctahedral16Lanes(const typename Ops::type p_x, const typename Ops::type p_y, const typename Ops::type p_z)
+		{
+			typename Ops::type x, y;
+			encodeOctahedralLanes<Ops>(p_x, p_y, p_z, x, y);
+			return Ops::orInt(Ops::andInt(toSnorm<Ops>(x, 32767.0f), Ops::set1Int(0xffff)), Ops::template shiftLeftInt<16>(toSnorm<Ops>(y, 32767.0f)));
+		}
+
+		template<typename Ops>
+		TSM_INLINE typename Ops::itype packOctahedralTangentLanes(const typename Ops::type p_x, const typename Ops::type p_y, const typename Ops::type p_z, const typename Ops::type p_sign)
+		{
+			typename Ops::type x, y;
+			encodeOctahedralLanes<Ops>(p_x, p_y, p_z, x, y);
+
+			const typename Ops::itype packed_x = Ops::andInt(toSnorm<Ops>(x, 32767.0f), Ops::set1Int(0xffff));
+			const typename Ops::itype packed_y = Ops::template shiftLeftInt<16>(Ops::andInt(toSnorm<Ops>(y, 16383.0f), Ops::set1Int(0x7fff)));
+			const typename Ops::itype sign     = Ops::andInt(Ops::asInt(p_sign), Ops::set1Int(INT32_MIN));
+			return Ops::orInt(Ops::orInt(packed_x, packed_y), sign);
+		}
+
+		template<typename Ops>
+		TSM_INLINE typename Ops::itype quantizeLanes(const typename Ops::type p_value, const typename Ops::type p_origin, const typename Ops::type p_scale)
+		{
+			const typename Ops::type grid = Ops::mul(Ops::sub(p_value, p_origin), p_scale);
+			return Ops::toInt(Ops::round(Ops::min(Ops::max(grid, Ops::set1(0.0f)), Ops::set1(65535.0f))));
+		}
+
+		// Grid units per world unit, 0 for flat axes so everything lands on the origin
+		glm::vec3 getQuantizationScale(const QuantizationGrid &p_grid)
+		{
+			return {
+				p_grid.extent.x > 0.0f ? 65535.0f / p_grid.extent.x : 0.0f,
+				p_grid.extent.y > 0.0f ? 65535.0f / p_grid.extent.y : 0.0f,
+				p_grid.extent.z > 0.0f ? 65535.0f / p_grid.extent.z : 0.0f,
+			};
+		}
+
+		template<typename Ops>
+		TSM_INLINE void storeStrided(const typename Ops::itype p_value, uint8 *p_out, const uint64 p_stride)
+		{
+			alignas(64) int32 lanes[Ops::c_width];
+			Ops::storeInt(lanes, p_value);
+			for (uint64 lane = 0u; lane < Ops::c_width; lane++)
+			{
+				std::memcpy(p_out + lane * p_stride, &lanes[lane], sizeof(int32));
+			}
+		}
+
+		// Each kernel returns the index it stopped at, the remainder is finished by the ScalarOps instantiation
+
+		template<typename Ops>
+		uint64 encodeOctahedral16Kernel(const Float3Stream &p_in, uint8 *p_out, const uint64 p_stride, const uint64 p_begin, const uint64 p_end)
+		{
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const typename Ops::itype packed = packOctahedral16Lanes<Ops>(Ops::load(p_in.x() + i), Ops::load(p_in.y() + i), Ops::load(p_in.z() + i));
+				storeStrided<Ops>(packed, p_out + i * p_stride, p_stride);
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 encodeOctahedralTangentsKernel(const Float3Stream &p_in, const float *p_signs, uint8 *p_out, const uint64 p_stride, const uint64 p_begin, const uint64 p_end)
+		{
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const typename Ops::itype packed = packOctahedralTangentLanes<Ops>(Ops::load(p_in.x() + i), Ops::load(p_in.y() + i), Ops::load(p_in.z() + i), Ops::load(p_signs + i));
+				storeStrided<Ops>(packed, p_out + i * p_stride, p_stride);
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 quantizePositionsKernel(const Float3Stream &p_in, const glm::vec3 &p_origin, const glm::vec3 &p_scale, uint8 *p_out, const uint64 p_stride, const uint64 p_begin, const uint64 p_end)
+		{
+			using V = typename Ops::type;
+
+			const V origin_x = Ops::set1(p_origin.x), origin_y = Ops::set1(p_origin.y), origin_z = Ops::set1(p_origin.z);
+			const V scale_x = Ops::set1(p_scale.x), scale_y = Ops::set1(p_scale.y), scale_z = Ops::set1(p_scale.z);
+
+			alignas(64) int32 lanes[3][Ops::c_width];
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				Ops::storeInt(lanes[0], quantizeLanes<Ops>(Ops::load(p_in.x() + i), origin_x, scale_x));
+				Ops::storeInt(lanes[1], quantizeLanes<Ops>(Ops::load(p_in.y() + i), origin_y, scale_y));
+				Ops::storeInt(lanes[2], quantizeLanes<Ops>(Ops::load(p_in.z() + i), origin_z, scale_z));
+
+				// One store per component, gathering the three into a local first stalls store forwarding
+				for (uint64 lane = 0u; lane < Ops::c_width; lane++)
+				{
+					uint8 *out = p_out + (i + lane) * p_stride;
+					for (uint64 component = 0u; component < 3u; component++)
+					{
+						const uint16 value = static_cast<uint16>(lanes[component][lane]);
+						std::memcpy(out + component * sizeof(uint16), &value, sizeof(uint16));
+					}
+				}
+			}
+			return i;
+		}
+
+		// Angle between two unit vectors, accurate for tiny angles unlike acos(dot)
+		double getAngle(const glm::vec3 &p_a, const glm::vec3 &p_b)
+		{
+			const glm::dvec3 a(p_a);
+			const glm::dvec3 b(p_b);
+			return std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b));
+		}
+
+		template<typename Decoded>
+		PackingError measureError(const uint64 p_count, Decoded &&p_error_of)
+		{
+			PackingError error;
+			if (p_count == 0u)
+				return error;
+
+			double sum = 0.0;
+			for (uint64 i = 0u; i < p_count; i++)
+			{
+				const double element_error = p_error_of(i);
+				error.max                  = std::max(error.max, static_cast<float>(element_error));
+				sum += element_error;
+			}
+			error.mean = static_cast<float>(sum / static_cast<double>(p_count));
+			return error;
+		}
+	}
+
+	uint32 packUnorm1010102(const glm::vec4 &p_value)
+	{
+		const auto pack = [](const float p_component, const float p_scale) {
+			return static_cast<uint32>(std::nearbyint(std::clamp(p_component, 0.0f, 1.0f) * p_scale));
+		};
+		return pack(p_value.x, 1023.0f) | (pack(p_value.y, 1023.0f) << 10) | (pack(p_value.z, 1023.0f) << 20) | (pack(p_value.w, 3.0f) << 30);
+	}
+
+	uint32 packSnorm1010102(const glm::vec4 &p_value)
+	{
+		const auto pack = [](const float p_component, const float p_scale, const uint32 p_mask) {
+			return static_cast<uint32>(static_cast<int32>(std::nearbyint(std::clamp(p_component, -1.0f, 1.0f) * p_scale))) & p_mask;
+		};
+		return pack(p_value.x, 511.0f, 0x3ffu) | (pack(p_value.y, 511.0f, 0x3ffu) << 10) | (pack(p_value.z, 511.0f, 0x3ffu) << 20) | (pack(p_value.w, 1.0f, 0x3u) << 30);
+	}
+
+	glm::vec4 unpackUnorm1010102(const uint32 p_value)
+	{
+		return {
+			static_cast<float>(p_value & 0x3ffu) / 1023.0f,
+			static_cast<float>((p_value >> 10) & 0x3ffu) / 1023.0f,
+			static_cast<float>((p_value >> 20) & 0x3ffu) / 1023.0f,
+			static_cast<float>(p_value >> 30) / 3.0f,
+		};
+	}
+
+	glm::vec4 unpackSnorm1010102(const uint32 p_value)
+	{
+		// Shifting the field to the top and back sign extends it
+		const auto unpack = [p_value](const uint32 p_shift, const uint32 p_bits, const float p_scale) {
+			const int32 field = static_cast<int32>(p_value << (32u - p_shift - p_bits)) >> (32u - p_bits);
+			return std::max(static_cast<float>(field) / p_scale, -1.0f);
+		};
+		return {unpack(0u, 10u, 511.0f), unpack(10u, 10u, 511.0f), unpack(20u, 10u, 511.0f), unpack(30u, 2u, 1.0f)};
+	}
+
+	glm::vec2 encodeOctahedral(const glm::vec3 &p_direction)
+	{
+		glm::vec2 encoded;
+		encodeOctahedralLanes<simd::ScalarOps>(p_direction.x, p_direction.y, p_direction.z, encoded.x, encoded.y);
+		return encoded;
+	}
+
+	glm::vec3 decodeOctahedral(const glm::vec2 &p_encoded)
+	{
+		glm::vec3 direction(p_encoded.x, p_encoded.y, 1.0f - std::abs(p_encoded.x) - std::abs(p_encoded.y));
+
+		const float fold = std::max(-direction.z, 0.0f);
+		direction.x += direction.x >= 0.0f ? -fold : fold;
+		direction.y += direction.y >= 0.0f ? -fold : fold;
+		return glm::normalize(direction);
+	}
+
+	uint32 packOctahedral16(const glm::vec3 &p_direction)
+	{
+		return static_cast<uint32>(packOctahedral16Lanes<simd::ScalarOps>(p_direction.x, p_direction.y, p_direction.z));
+	}
+
+	glm::vec3 unpackOctahedral16(const uint32 p_value)
+	{
+		return decodeOctahedral({unpackSnorm16(static_cast<int16>(p_value & 0xffffu)), unpackSnorm16(static_cast<int16>(p_value >> 16))});
+	}
+
+	uint16 packOctahedral8(const glm::vec3 &p_direction)
+	{
+		const glm::vec2 encoded = encodeOctahedral(p_direction);
+		return static_cast<uint16>(static_cast<uint8>(packSnorm8(encoded.x)) | (static_cast<uint8>(packSnorm8(encoded.y)) << 8));
+	}
+
+	glm::vec3 unpackOctahedral8(const uint16 p_value)
+	{
+		return decodeOctahedral({unpackSnorm8(static_cast<int8>(p_value & 0xffu)), unpackSnorm8(static_cast<int8>(p_value >> 8))});
+	}
+
+	uint32 packOctahedralTangent(const glm::vec3 &p_tangent, const float p_bitangent_sign)
+	{
+		return static_cast<uint32>(packOctahedralTangentLanes<simd::ScalarOps>(p_tangent.x, p_tangent.y, p_tangent.z, p_bitangent_sign));
+	}
+
+	glm::vec4 unpackOctahedralTangent(const uint32 p_value)
+	{
+		const float x = unpackSnorm16(static_cast<int16>(p_value & 0xffffu));
+		const float y = std::max(static_cast<float>(static_cast<int32>(p_value << 1) >> 17) / 16383.0f, -1.0f);
+		return {decodeOctahedral({x, y}), (p_value & 0x80000000u) ? -1.0f : 1.0f};
+	}
+
+	QuantizationGrid QuantizationGrid::fromBounds(const glm::vec3 &p_min, const glm::vec3 &p_max)
+	{
+		return {p_min, glm::max(p_max - p_min, glm::vec3(0.0f))};
+	}
+
+	glm::u16vec3 QuantizationGrid::quantize(const glm::vec3 &p_position) const
+	{
+		const glm::vec3 scale = getQuantizationScale(*this);
+		return {
+			static_cast<uint16>(quantizeLanes<simd::ScalarOps>(p_position.x, origin.x, scale.x)),
+			static_cast<uint16>(quantizeLanes<simd::ScalarOps>(p_position.y, origin.y, scale.y)),
+			static_cast<uint16>(quantizeLanes<simd::ScalarOps>(p_position.z, origin.z, scale.z)),
+		};
+	}
+
+	glm::vec3 QuantizationGrid::dequantize(const glm::u16vec3 &p_quantized) const
+	{
+		return origin + glm::vec3(p_quantized) / 65535.0f * extent; // The unorm conversion the vertex fetch does
+	}
+
+	void packHalf(const float *p_in, const uint64 p_count, uint16 *p_out)
+	{
+		uint64 i = 0u;
+		#if TSM_SIMD_F16C
+		for (; i + 8u <= p_count; i += 8u)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(p_out + i), _mm256_cvtps_ph(_mm256_loadu_ps(p_in + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+		#endif
+		for (; i < p_count; i++)
+		{
+			p_out[i] = packHalf(p_in[i]);
+		}
+	}
+
+	void unpackHalf(const uint16 *p_in, const uint64 p_count, float *p_out)
+	{
+		uint64 i = 0u;
+		#if TSM_SIMD_F16C
+		for (; i + 8u <= p_count; i += 8u)
+		{
+			_mm256_storeu_ps(p_out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_in + i))));
+		}
+		#endif
+		for (; i < p_count; i++)
+		{
+			p_out[i] = unpackHalf(p_in[i]);
+		}
+	}
+
+	void encodeOctahedral16(const Float3Stream &p_directions, void *p_out, const uint64 p_stride)
+	{
+		uint8 *     out   = static_cast<uint8 *>(p_out);
+		const uint64 count = p_directions.size();
+
+		const uint64 i = encodeOctahedral16Kernel<simd::WideOps>(p_directions, out, p_stride, 0u, count);
+		encodeOctahedral16Kernel<simd::ScalarOps>(p_directions, out, p_stride, i, count);
+	}
+
+	void encodeOctahedralTangents(const Float3Stream &p_tangents, const float *p_bitangent_signs, void *p_out, const uint64 p_stride)
+	{
+		uint8 *     out   = static_cast<uint8 *>(p_out);
+		const uint64 count = p_tangents.size();
+
+		const uint64 i = encodeOctahedralTangentsKernel<simd::WideOps>(p_tangents, p_bitangent_signs, out, p_stride, 0u, count);
+		encodeOctahedralTangentsKernel<simd::ScalarOps>(p_tangents, p_bitangent_signs, out, p_stride, i, count);
+	}
+
+	void quantizePositions(const Float3Stream &p_positions, const QuantizationGrid &p_grid, void *p_out, const uint64 p_stride)
+	{
+		uint8 *         out   = static_cast<uint8 *>(p_out);
+		const uint64    count = p_positions.size();
+		const glm::vec3 scale = getQuantizationScale(p_grid);
+
+		const uint64 i = quantizePositionsKernel<simd::WideOps>(p_positions, p_grid.origin, scale, out, p_stride, 0u, count);
+		quantizePositionsKernel<simd::ScalarOps>(p_positions, p_grid.origin, scale, out, p_stride, i, count);
+	}
+
+	PackingError measureOctahedral16Error(const Float3Stream &p_directions)
+	{
+		return measureError(p_directions.size(), [&](const uint64 p_index) {
+			const glm::vec3 direction = glm::normalize(p_directions.get(p_index));
+			return getAngle(direction, unpackOctahedral16(packOctahedral16(direction)));
+		});
+	}
+
+	PackingError measureOctahedral8Error(const Float3Stream &p_directions)
+	{
+		return measureError(p_directions.size(), [&](const uint64 p_index) {
+			const glm::vec3 direction = glm::normalize(p_directions.get(p_index));
+			return getAngle(direction, unpackOctahedral8(packOctahedral8(direction)));
+		});
+	}
+
+	PackingError measureQuantizationError(const Float3Stream &p_positions, const QuantizationGrid &p_grid)
+	{
+		return measureError(p_positions.size(), [&](const uint64 p_index) {
+			const glm::vec3 position = p_positions.get(p_index);
+			return static_cast<double>(glm::distance(position, p_grid.dequantize(p_grid.quantize(position))));
+		});
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include "system_types.h"
+#include "math_stream.hpp"
+
+// Quantized vertex attribute encodings. The decode side of everything here is mirrored in
+// toast_shaders/vertex_packing.glsl, keep the two in sync.
+//
+// Worst case round trip errors, in the units of the decoded value:
+//	half               half an ULP of half (2^-11 relative) for |x| <= 65504, larger values become infinity
+//	snorm / unorm 8    half a step, 0.5 / 127 resp. 0.5 / 255
+//	snorm / unorm 16   half a step, 0.5 / 32767 resp. 0.5 / 65535
+//	10:10:10:2         half a step of xyz, 0.5 / 1023 (unorm) resp. 0.5 / 511 (snorm). w is 0.5 / 3 (unorm) or
+//	                   exactly -1, 0 or 1 (snorm)
+//	octahedral 16      0.0037 degrees (0.0013 mean) over 1M random unit vectors
+//	octahedral 8       0.94 degrees (0.34 mean), too coarse for lit normals
+//	tangent            0.0056 degrees, the sign bit costs y one bit
+//	QuantizationGrid   half a grid step per axis plus the float rounding of the decode, see getMaxError()
+
+namespace tsm
+{
+	// IEEE binary16, rounded to nearest even. Overflow becomes infinity, NaN stays NaN
+	inline uint16 packHalf(const float p_value)
+	{
+		constexpr uint32 c_floatInfinity{255u << 23};
+		constexpr uint32 c_halfOverflow{(127u + 16u) << 23}; // Smallest float that rounds to half infinity
+		constexpr uint32 c_halfNormalMin{113u << 23};
+		constexpr uint32 c_denormMagic{((127u - 15u) + (23u - 10u) + 1u) << 23};
+
+		uint32       bits = std::bit_cast<uint32>(p_value);
+		const uint32 sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint32 half;
+		if (bits >= c_halfOverflow)
+		{
+			half = bits > c_floatInfinity ? 0x7e00u : 0x7c00u;
+		}
+		else if (bits < c_halfNormalMin)
+		{
+			// Subnormal half, the float addition does the rounding
+			const float shifted = std::bit_cast<float>(bits) + std::bit_cast<float>(c_denormMagic);
+			half                = std::bit_cast<uint32>(shifted) - c_denormMagic;
+		}
+		else
+		{
+			const uint32 mantissa_odd = (bits >> 13) & 1u;
+			bits += (static_cast<uint32>(15 - 127) << 23) + 0xfffu + mantissa_odd;
+			half = bits >> 13;
+		}
+		return static_cast<uint16>(half | (sign >> 16));
+	}
+
+	inline float unpackHalf(const uint16 p_value)
+	{
+		constexpr uint32 c_shiftedExponent{0x7c00u << 13};
+		constexpr uint32 c_magic{113u << 23};
+
+		uint32       bits     = (p_value & 0x7fffu) << 13;
+		const uint32 exponent = bits & c_shiftedExponent;
+		bits += (127u - 15u) << 23;
+
+		if (exponent == c_shiftedExponent)
+		{
+			bits += (128u - 16u) << 23; // Infinity or NaN
+		}
+		else if (exponent == 0u)
+		{
+			bits += 1u << 23; // Zero or subnormal, renormalized by the subtraction
+			bits = std::bit_cast<uint32>(std::bit_cast<float>(bits) - std::bit_cast<float>(c_magic));
+		}
+		return std::bit_cast<float>(bits | (static_cast<uint32>(p_value & 0x8000u) << 16));
+	}
+
+	// Normalized integers, following the Vulkan conversion rules: clamped, scaled and rounded to nearest (ties to
+	// even, like the batch encoders). The most negative snorm value decodes to -1 like its neighbour
+	inline int8   packSnorm8(const float p_value) { return static_cast<int8>(std::nearbyint(std::clamp(p_value, -1.0f, 1.0f) * 127.0f)); }
+	inline int16  packSnorm16(const float p_value) { return static_cast<int16>(std::nearbyint(std::clamp(p_value, -1.0f, 1.0f) * 32767.0f)); }
+	inline uint8  packUnorm8(const float p_value) { return static_cast<uint8>(std::nearbyint(std::clamp(p_value, 0.0f, 1.0f) * 255.0f)); }
+	inline uint16 packUnorm16(const float p_value) { return static_cast<uint16>(std::nearbyint(std::clamp(p_value, 0.0f, 1.0f) * 65535.0f)); }
+
+	inline float unpackSnorm8(const int8 p_value) { return std::max(static_cast<float>(p_value) / 127.0f, -1.0f); }
+	inline float unpackSnorm16(const int16 p_value) { return std::max(static_cast<float>(p_value) / 32767.0f, -1.0f); }
+	inline float unpackUnorm8(const uint8 p_value) { return static_cast<float>(p_value) / 255.0f; }
+	inline float unpackUnorm16(const uint16 p_value) { return static_cast<float>(p_value) / 65535.0f; }
+
+	// x in bits 0-9, y in 10-19, z in 20-29 and w in 30-31, the layout of eA2B10G10R10UnormPack32 /
+	// eA2B10G10R10SnormPack32
+	uint32    packUnorm1010102(const glm::vec4 &p_value);
+	uint32    packSnorm1010102(const glm::vec4 &p_value);
+	glm::vec4 unpackUnorm1010102(uint32 p_value);
+	glm::vec4 unpackSnorm1010102(uint32 p_value);
+
+	// Maps a unit vector onto the [-1, 1] square: the octahedron |x| + |y| + |z| = 1 with the lower half folded
+	// over the upper one. p_direction does not have to be normalized but must not be zero
+	glm::vec2 encodeOctahedral(const glm::vec3 &p_direction);
+	glm::vec3 decodeOctahedral(const glm::vec2 &p_encoded); // Normalized
+
+	// Octahedral in two snorm16 values, x in the low half. Matches eR16G16Snorm
+	uint32    packOctahedral16(const glm::vec3 &p_direction);
+	glm::vec3 unpackOctahedral16(uint32 p_value);
+
+	// Octahedral in two snorm8 values, x in the low byte. Matches eR8G8Snorm
+	uint16    packOctahedral8(const glm::vec3 &p_direction);
+	glm::vec3 unpackOctahedral8(uint16 p_value);
+
+	// Tangent plus bitangent sign in 32 bits: octahedral x as snorm16 in bits 0-15, octahedral y as a 15 bit snorm in
+	// bits 16-30 and the sign in bit 31, set for negative. Read as a uint in the shader
+	uint32    packOctahedralTangent(const glm::vec3 &p_tangent, float p_bitangent_sign);
+	glm::vec4 unpackOctahedralTangent(uint32 p_value); // w is the bitangent sign, 1 or -1
+
+	// Maps positions inside a box onto 16 bit unorm coordinates. Built from the bounds of the submesh the positions
+	// belong to, so the precision follows the submesh size instead of the float exponent
+	struct QuantizationGrid
+	{
+		glm::vec3 origin{0.0f};
+		glm::vec3 extent{0.0f}; // Decoded position = origin + unorm * extent
+
+		static QuantizationGrid fromBounds(const glm::vec3 &p_min, const glm::vec3 &p_max);
+
+		[[nodiscard]] glm::u16vec3 quantize(const glm::vec3 &p_position) const; // Clamped to the grid
+		[[nodiscard]] glm::vec3    dequantize(const glm::u16vec3 &p_quantized) const;
+
+		// Half a grid step per axis
+		[[nodiscard]] glm::vec3 getMaxError() const { return extent * (0.5f / 65535.0f); }
+	};
+
+	// Batch encoders, 16 (AVX-512), 8 (AVX2) or 4 (SSE4) elements per iteration and the remainder with the scalar
+	// functions above, which they match bit for bit (NaN payloads aside). The outputs are written p_stride bytes
+	// apart so the encoders can fill an interleaved vertex buffer in place, pass the packed size for a tight array
+
+	// 8 per iteration with F16C, scalar in SSE4 builds
+	void packHalf(const float *p_in, uint64 p_count, uint16 *p_out);
+	void unpackHalf(const uint16 *p_in, uint64 p_count, float *p_out);
+
+	// One packOctahedral16() uint32 per direction
+	void encodeOctahedral16(const Float3Stream &p_directions, void *p_out, uint64 p_stride);
+
+	// One packOctahedralTangent() uint32 per tangent. p_bitangent_signs holds p_tangents.size() floats, only the sign
+	// bit is read
+	void encodeOctahedralTangents(const Float3Stream &p_tangents, const float *p_bitangent_signs, void *p_out, uint64 p_stride);
+
+	// Three uint16 per position
+	void quantizePositions(const Float3Stream &p_positions, const QuantizationGrid &p_grid, void *p_out, uint64 p_stride);
+
+	// Error of an encoding over a data set, for import logs and for picking a format
+	struct PackingError
+	{
+		float max{0.0f};
+		float mean{0.0f};
+	};
+
+	// Angle in radians between each direction and its packOctahedral16() / packOctahedral8() round trip
+	PackingError measureOctahedral16Error(const Float3Stream &p_directions);
+	PackingError measureOctahedral8Error(const Float3Stream &p_directions);
+
+	// Distance between each position and its quantized round trip
+	PackingError measureQuantizationError(const Float3Stream &p_positions, const QuantizationGrid &p_grid);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "math_matrix.hpp"
+#include "math_transcendental.hpp"
+
+namespace tsm
+{
+	// Rotation quaternion stored as (x, y, z, w) in one register. Same conventions as glm::quat
+	class alignas(16) quat
+	{
+	public:
+		// Identity
+		TSM_INLINE quat() : m_value(0.0f, 0.0f, 0.0f, 1.0f)
+		{
+		}
+
+		TSM_INLINE quat(float p_x, float p_y, float p_z, float p_w) : m_value(p_x, p_y, p_z, p_w)
+		{
+		}
+
+		TSM_INLINE explicit quat(const float4 &p_xyzw) : m_value(p_xyzw)
+		{
+		}
+
+		TSM_INLINE explicit quat(const glm::quat &p_quat) : m_value(p_quat.x, p_quat.y, p_quat.z, p_quat.w)
+		{
+		}
+
+		// p_axis must be normalized
+		[[nodiscard]] static TSM_INLINE quat fromAxisAngle(const glm::vec3 &p_axis, float p_radians)
+		{
+			float s, c;
+			sincos(p_radians * 0.5f, s, c);
+			return {p_axis.x * s, p_axis.y * s, p_axis.z * s, c};
+		}
+
+		[[nodiscard]] TSM_INLINE glm::quat toGlm() const
+		{
+			return glm::quat(m_value.w(), m_value.x(), m_value.y(), m_value.z());
+		}
+
+		[[nodiscard]] TSM_INLINE const float4 &getXYZW() const { return m_value; }
+
+		[[nodiscard]] TSM_INLINE float x() const { return m_value.x(); }
+		[[nodiscard]] TSM_INLINE float y() const { return m_value.y(); }
+		[[nodiscard]] TSM_INLINE float z() const { return m_value.z(); }
+		[[nodiscard]] TSM_INLINE float w() const { return m_value.w(); }
+
+		// Hamilton product, applies p_other first and then this
+		TSM_INLINE quat operator*(const quat &p_other) const
+		{
+			#if TSM_SIMD_SSE4
+			const __m128 q1 = m_value.getNative();
+			const __m128 q2 = p_other.m_value.getNative();
+
+			__m128 result = _mm_mul_ps(simd::splat<3>(q1), q2);
+			result        = simd::madd(simd::splat<0>(q1), _mm_mul_ps(simd::swizzle<3, 2, 1, 0>(q2), _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f)), result);
+			result        = simd::madd(simd::splat<1>(q1), _mm_mul_ps(simd::swizzle<2, 3, 0, 1>(q2), _mm_setr_ps(1.0f, 1.0f, -1.0f, -1.0f)), result);
+			result        = simd::madd(simd::splat<2>(q1), _mm_mul_ps(simd::swizzle<1, 0, 3, 2>(q2), _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f)), result);
+			return quat(float4(result));
+			#else
+			const float4 &a = m_value;
+			const float4 &b = p_other.m_value;
+			return {
+				a.w() * b.x() + a.x() * b.w() + a.y() * b.z() - a.z() * b.y(),
+				a.w() * b.y() - a.x() * b.z() + a.y() * b.w() + a.z() * b.x(),
+				a.w() * b.z() + a.x() * b.y() - a.y() * b.x() + a.z() * b.w(),
+				a.w() * b.w() - a.x() * b.x() - a.y() * b.y() - a.z() * b.z(),
+			};
+			#endif
+		}
+
+		TSM_INLINE quat &operator*=(const quat &p_other) { return *this = *this * p_other; }
+
+		// Rotates the xyz part of p_vec, w is passed through
+		TSM_INLINE float4 rotate(const float4 &p_vec) const
+		{
+			// v' = v + w * t + q.xyz x t, with t = 2 * (q.xyz x v)
+			const float4 t = cross3(m_value, p_vec) * 2.0f;
+			return madd(float4(m_value.w()), t, p_vec) + cross3(m_value, t);
+		}
+
+		[[nodiscard]] TSM_INLINE float4x4 toMatrix() const
+		{
+			const float x = m_value.x();
+			const float y = m_value.y();
+			const float z = m_value.z();
+			const float w = m_value.w();
+
+			const float xx = x * x, yy = y * y, zz = z * z;
+			const float xy = x * y, xz = x * z, yz = y * z;
+			const float wx = w * x, wy = w * y, wz = w * z;
+
+			return {
+				float4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f),
+				float4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f),
+				float4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f),
+				float4(0.0f, 0.0f, 0.0f, 1.0f),
+			};
+		}
+
+	private:
+		float4 m_value;
+	};
+
+	TSM_INLINE quat conjugate(const quat &p_quat)
+	{
+		#if TSM_SIMD_SSE4
+		return quat(float4(_mm_xor_ps(p_quat.getXYZW().getNative(), _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f))));
+		#else
+		return {-p_quat.x(), -p_quat.y(), -p_quat.z(), p_quat.w()};
+		#endif
+	}
+
+	TSM_INLINE float dot(const quat &p_a, const quat &p_b) { return dot(p_a.getXYZW(), p_b.getXYZW()); }
+	TSM_INLINE float length(const quat &p_quat) { return length(p_quat.getXYZW()); }
+	TSM_INLINE quat  normalize(const quat &p_quat) { return quat(normalize(p_quat.getXYZW())); }
+
+	TSM_INLINE quat inverse(const quat &p_quat)
+	{
+		const quat conj = conjugate(p_quat);
+		return quat(conj.getXYZW() / dotSplat(p_quat.getXYZW(), p_quat.getXYZW()));
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// Compile time selection of the instruction set the tsm types are built on. Set through WITH_CPU_SIMD in CMake:
+//	AVX2   -> TSM_SIMD_AVX2 and TSM_SIMD_SSE4 (AVX2 implies FMA here)
+//	SSE4   -> TSM_SIMD_SSE4
+//	SCALAR -> neither, plain C++
+// Every target has to be built with the same setting, the types have a different layout in the scalar build
+
+#if defined(TSM_FORCE_SCALAR)
+#define TSM_SIMD_SSE4 0
+#define TSM_SIMD_AVX2 0
+#elif defined(__AVX2__)
+#define TSM_SIMD_SSE4 1
+#define TSM_SIMD_AVX2 1
+#elif defined(__SSE4_1__) || defined(__AVX__) || defined(TSM_ENABLE_SSE4)
+#define TSM_SIMD_SSE4 1
+#define TSM_SIMD_AVX2 0
+#else
+#define TSM_SIMD_SSE4 0
+#define TSM_SIMD_AVX2 0
+#endif
+
+// Half float conversion instructions. Every AVX2 CPU has them, MSVC has no separate switch or macro for F16C
+#if TSM_SIMD_AVX2 && (defined(__F16C__) || defined(_MSC_VER))
+#define TSM_SIMD_F16C 1
+#else
+#define TSM_SIMD_F16C 0
+#endif
+
+#if TSM_SIMD_SSE4
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#define TSM_INLINE __forceinline
+#else
+#define TSM_INLINE inline __attribute__((always_inline))
+#endif
+
+#if TSM_SIMD_SSE4
+namespace tsm::simd
+{
+	#define TSM_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+
+	// Lane permutation of a single register
+	template<int X, int Y, int Z, int W>
+	TSM_INLINE __m128 swizzle(__m128 p_v)
+	{
+		return _mm_shuffle_ps(p_v, p_v, TSM_SHUFFLE_MASK(X, Y, Z, W));
+	}
+
+	template<int I>
+	TSM_INLINE __m128 splat(__m128 p_v)
+	{
+		return swizzle<I, I, I, I>(p_v);
+	}
+
+	// (a[X], a[Y], b[Z], b[W])
+	template<int X, int Y, int Z, int W>
+	TSM_INLINE __m128 shuffle(__m128 p_a, __m128 p_b)
+	{
+		return _mm_shuffle_ps(p_a, p_b, TSM_SHUFFLE_MASK(X, Y, Z, W));
+	}
+
+	// a * b + c, fused when the target has FMA
+	TSM_INLINE __m128 madd(__m128 p_a, __m128 p_b, __m128 p_c)
+	{
+		#if TSM_SIMD_AVX2
+		return _mm_fmadd_ps(p_a, p_b, p_c);
+		#else
+		return _mm_add_ps(_mm_mul_ps(p_a, p_b), p_c);
+		#endif
+	}
+
+	// c - a * b
+	TSM_INLINE __m128 nmadd(__m128 p_a, __m128 p_b, __m128 p_c)
+	{
+		#if TSM_SIMD_AVX2
+		return _mm_fnmadd_ps(p_a, p_b, p_c);
+		#else
+		return _mm_sub_ps(p_c, _mm_mul_ps(p_a, p_b));
+		#endif
+	}
+
+	TSM_INLINE __m128 signMask()
+	{
+		return _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+	}
+}
+#endif
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "system_types.h"
+#include "math_simd.hpp"
+
+namespace tsm::simd
+{
+	// Register wide operations for the batch kernels. A kernel is written once as a template over these and
+	// instantiated for WideOps, the widest instruction set in the build, and for ScalarOps to finish the remainder
+	struct ScalarOps
+	{
+		using type = float;
+
+		static constexpr uint64 c_width{1u};
+
+		static float load(const float *p_ptr) { return *p_ptr; }
+		static void  store(float *p_ptr, float p_value) { *p_ptr = p_value; }
+		static float set1(float p_value) { return p_value; }
+		static float add(float p_a, float p_b) { return p_a + p_b; }
+		static float sub(float p_a, float p_b) { return p_a - p_b; }
+		static float mul(float p_a, float p_b) { return p_a * p_b; }
+		static float madd(float p_a, float p_b, float p_c) { return p_a * p_b + p_c; }
+		static float div(float p_a, float p_b) { return p_a / p_b; }
+		// Same as minps / maxps, p_b is returned when either is NaN
+		static float min(float p_a, float p_b) { return p_a < p_b ? p_a : p_b; }
+		static float max(float p_a, float p_b) { return p_a > p_b ? p_a : p_b; }
+		static float sqrt(float p_value) { return std::sqrt(p_value); }
+		static float reduceMin(float p_value) { return p_value; }
+		static float reduceMax(float p_value) { return p_value; }
+
+		// Bit i is set when p_a[i] < p_b[i]
+		static uint32 lessMask(float p_a, float p_b) { return p_a < p_b ? 1u : 0u; }
+
+		static float gather(const float *p_base, int32) { return *p_base; }
+
+		// Masks, bit level and integer operations for math_transcendental.hpp and math_packing.hpp
+		using itype = int32;
+		using mask  = bool;
+
+		static bool  less(float p_a, float p_b) { return p_a < p_b; }
+		static bool  equal(float p_a, float p_b) { return p_a == p_b; }
+		static bool  isNan(float p_value) { return p_value != p_value; }
+		static bool  isNegative(float p_value) { return std::signbit(p_value); } // Sign bit set, -0 included
+		static bool  maskOr(bool p_a, bool p_b) { return p_a || p_b; }
+		static float select(bool p_mask, float p_true, float p_false) { return p_mask ? p_true : p_false; }
+
+		static float bitAnd(float p_a, float p_b) { return asFloat(asInt(p_a) & asInt(p_b)); }
+		static float bitOr(float p_a, float p_b) { return asFloat(asInt(p_a) | asInt(p_b)); }
+		static float bitXor(float p_a, float p_b) { return asFloat(asInt(p_a) ^ asInt(p_b)); }
+
+		// To nearest, ties to even
+		static float round(float p_value) { return std::nearbyint(p_value); }
+		static int32 toInt(float p_value) { return static_cast<int32>(p_value); } // Truncates
+		static float toFloat(int32 p_value) { return static_cast<float>(p_value); }
+		static int32 asInt(float p_value) { return std::bit_cast<int32>(p_value); }
+		static float asFloat(int32 p_value) { return std::bit_cast<float>(p_value); }
+
+		static int32 set1Int(int32 p_value) { return p_value; }
+		static int32 addInt(int32 p_a, int32 p_b) { return static_cast<int32>(static_cast<uint32>(p_a) + static_cast<uint32>(p_b)); }
+		static int32 subInt(int32 p_a, int32 p_b) { return static_cast<int32>(static_cast<uint32>(p_a) - static_cast<uint32>(p_b)); }
+		static int32 andInt(int32 p_a, int32 p_b) { return p_a & p_b; }
+		static int32 orInt(int32 p_a, int32 p_b) { return p_a | p_b; }
+		static void  storeInt(int32 *p_ptr, int32 p_value) { *p_ptr = p_value; }
+
+		template<int Bits>
+		static int32 shiftLeftInt(int32 p_value) { return static_cast<int32>(static_cast<uint32>(p_value) << Bits); }
+
+		// Arithmetic, the sign is shifted in
+		template<int Bits>
+		static int32 shiftRightInt(int32 p_value) { return p_value >> Bits; }
+
+		static float rsqrt(float p_value) { return 1.0f / std::sqrt(p_value); }
+	};
+
+	#if defined(__AVX512F__) && TSM_SIMD_AVX2
+	struct Avx512Ops
+	{
+		using type = __m512;
+
+		static constexpr uint64 c_width{16u};
+
+		static __m512 load(const float *p_ptr) { return _mm512_loadu_ps(p_ptr); }
+		static void   store(float *p_ptr, __m512 p_value) { _mm512_storeu_ps(p_ptr, p_value); }
+		static __m512 set1(float p_value) { return _mm512_set1_ps(p_value); }
+		static __m512 add(__m512 p_a, __m512 p_b) { return _mm512_add_ps(p_a, p_b); }
+		static __m512 sub(__m512 p_a, __m512 p_b) { return _mm512_sub_ps(p_a, p_b); }
+		static __m512 mul(__m512 p_a, __m512 p_b) { return _mm512_mul_ps(p_a, p_b); }
+		static __m512 madd(__m512 p_a, __m512 p_b, __m512 p_c) { return _mm512_fmadd_ps(p_a, p_b, p_c); }
+		static __m512 div(__m512 p_a, __m512 p_b) { return _mm512_div_ps(p_a, p_b); }
+		static __m512 min(__m512 p_a, __m512 p_b) { return _mm512_min_ps(p_a, p_b); }
+		static __m512 max(__m512 p_a, __m512 p_b) { return _mm512_max_ps(p_a, p_b); }
+		static __m512 sqrt(__m512 p_value) { return _mm512_sqrt_ps(p_value); }
+		static float  reduceMin(__m512 p_value) { return _mm512_reduce_min_ps(p_value); }
+		static float  reduceMax(__m512 p_value) { return _mm512_reduce_max_ps(p_value); }
+
+		static uint32 lessMask(__m512 p_a, __m512 p_b) { return _mm512_cmp_ps_mask(p_a, p_b, _CMP_LT_OQ); }
+
+		// p_stride in floats
+		static __m512 gather(const float *p_base, int32 p_stride)
+		{
+			const __m512i indices = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(p_stride));
+			return _mm512_i32gather_ps(indices, p_base, 4);
+		}
+
+		using itype = __m512i;
+		using mask  = __mmask16;
+
+		static __mmask16 less(__m512 p_a, __m512 p_b) { return _mm512_cmp_ps_mask(p_a, p_b, _CMP_LT_OQ); }
+		static __mmask16 equal(__m512 p_a, __m512 p_b) { return _mm512_cmp_ps_mask(p_a, p_b, _CMP_EQ_OQ); }
+		static __mmask16 isNan(__m512 p_value) { return _mm512_cmp_ps_mask(p_value, p_value, _CMP_UNORD_Q); }
+		static __mmask16 isNegative(__m512 p_value) { return _mm512_cmplt_epi32_mask(_mm512_castps_si512(p_value), _mm512_setzero_si512()); }
+		static __mmask16 maskOr(__mmask16 p_a, __mmask16 p_b) { return static_cast<__mmask16>(p_a | p_b); }
+		static __m512    select(__mmask16 p_mask, __m512 p_true, __m512 p_false) { return _mm512_mask_blend_ps(p_mask, p_false, p_true); }
+
+		// AVX-512F has no float logic instructions, those are AVX-512DQ
+		static __m512 bitAnd(__m512 p_a, __m512 p_b) { return asFloat(_mm512_and_si512(asInt(p_a), asInt(p_b))); }
+		static __m512 bitOr(__m512 p_a, __m512 p_b) { return asFloat(_mm512_or_si512(asInt(p_a), asInt(p_b))); }
+		static __m512 bitXor(__m512 p_a, __m512 p_b) { return asFloat(_mm512_xor_si512(asInt(p_a), asInt(p_b))); }
+
+		static __m512  round(__m512 p_value) { return _mm512_roundscale_ps(p_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static __m512i toInt(__m512 p_value) { return _mm512_cvttps_epi32(p_value); }
+		static __m512  toFloat(__m512i p_value) { return _mm512_cvtepi32_ps(p_value); }
+		static __m512i asInt(__m512 p_value) { return _mm512_castps_si512(p_value); }
+		static __m512  asFloat(__m512i p_value) { return _mm512_castsi512_ps(p_value); }
+
+		static __m512i set1Int(int32 p_value) { return _mm512_set1_epi32(p_value); }
+		static __m512i addInt(__m512i p_a, __m512i p_b) { return _mm512_add_epi32(p_a, p_b); }
+		static __m512i subInt(__m512i p_a, __m512i p_b) { return _mm512_sub_epi32(p_a, p_b); }
+		static __m512i andInt(__m512i p_a, __m512i p_b) { return _mm512_and_si512(p_a, p_b); }
+		static __m512i orInt(__m512i p_a, __m512i p_b) { return _mm512_or_si512(p_a, p_b); }
+		static void    storeInt(int32 *p_ptr, __m512i p_value) { _mm512_storeu_si512(p_ptr, p_value); }
+
+		template<int Bits>
+		static __m512i shiftLeftInt(__m512i p_value) { return _mm512_slli_epi32(p_value, Bits); }
+
+		template<int Bits>
+		static __m512i shiftRightInt(__m512i p_value) { return _mm512_srai_epi32(p_value, Bits); }
+
+		// 14 bit estimate and one Newton-Raphson step, x * estimate first so no intermediate leaves the normal range.
+		// Infinite estimates (0, and subnormals where the estimate flushes them) and infinite inputs keep the estimate,
+		// the step would turn them into NaN or -infinity
+		static __m512 rsqrt(__m512 p_value)
+		{
+			const __m512 estimate = _mm512_rsqrt14_ps(p_value);
+			const __m512 half_xe  = _mm512_mul_ps(_mm512_mul_ps(p_value, estimate), _mm512_set1_ps(0.5f));
+			const __m512 refined  = _mm512_mul_ps(estimate, _mm512_fnmadd_ps(half_xe, estimate, _mm512_set1_ps(1.5f)));
+			const auto   keep     = maskOr(equal(bitAnd(estimate, asFloat(set1Int(0x7FFFFFFF))), _mm512_set1_ps(INFINITY)), equal(p_value, _mm512_set1_ps(INFINITY)));
+			return select(keep, estimate, refined);
+		}
+	};
+	#endif
+
+	#if TSM_SIMD_AVX2
+	struct Avx2Ops
+	{
+		using type = __m256;
+
+		static constexpr uint64 c_width{8u};
+
+		static __m256 load(const float *p_ptr) { return _mm256_loadu_ps(p_ptr); }
+		static void   store(float *p_ptr, __m256 p_value) { _mm256_storeu_ps(p_ptr, p_value); }
+		static __m256 set1(float p_value) { return _mm256_set1_ps(p_value); }
+		static __m256 add(__m256 p_a, __m256 p_b) { return _mm256_add_ps(p_a, p_b); }
+		static __m256 sub(__m256 p_a, __m256 p_b) { return _mm256_sub_ps(p_a, p_b); }
+		static __m256 mul(__m256 p_a, __m256 p_b) { return _mm256_mul_ps(p_a, p_b); }
+		static __m256 madd(__m256 p_a, __m256 p_b, __m256 p_c) { return _mm256_fmadd_ps(p_a, p_b, p_c); }
+		static __m256 div(__m256 p_a, __m256 p_b) { return _mm256_div_ps(p_a, p_b); }
+		static __m256 min(__m256 p_a, __m256 p_b) { return _mm256_min_ps(p_a, p_b); }
+		static __m256 max(__m256 p_a, __m256 p_b) { return _mm256_max_ps(p_a, p_b); }
+		static __m256 sqrt(__m256 p_value) { return _mm256_sqrt_ps(p_value); }
+
+		static float reduceMin(__m256 p_value)
+		{
+			__m128 value = _mm_min_ps(_mm256_castps256_ps128(p_value), _mm256_extractf128_ps(p_value, 1));
+			value        = _mm_min_ps(value, _mm_movehl_ps(value, value));
+			return _mm_cvtss_f32(_mm_min_ss(value, simd::splat<1>(value)));
+		}
+
+		static float reduceMax(__m256 p_value)
+		{
+			__m128 value = _mm_max_ps(_mm256_castps256_ps128(p_value), _mm256_extractf128_ps(p_value, 1));
+			value        = _mm_max_ps(value, _mm_movehl_ps(value, value));
+			return _mm_cvtss_f32(_mm_max_ss(value, simd::splat<1>(value)));
+		}
+
+		static uint32 lessMask(__m256 p_a, __m256 p_b) { return static_cast<uint32>(_mm256_movemask_ps(_mm256_cmp_ps(p_a, p_b, _CMP_LT_OQ))); }
+
+		// p_stride in floats
+		static __m256 gather(const float *p_base, int32 p_stride)
+		{
+			const __m256i indices = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(p_stride));
+			return _mm256_i32gather_ps(p_base, indices, 4);
+		}
+
+		using itype = __m256i;
+		using mask  = __m256; // All bits set per true lane
+
+		static __m256 less(__m256 p_a, __m256 p_b) { return _mm256_cmp_ps(p_a, p_b, _CMP_LT_OQ); }
+		static __m256 equal(__m256 p_a, __m256 p_b) { return _mm256_cmp_ps(p_a, p_b, _CMP_EQ_OQ); }
+		static __m256 isNan(__m256 p_value) { return _mm256_cmp_ps(p_value, p_value, _CMP_UNORD_Q); }
+		static __m256 isNegative(__m256 p_value) { return asFloat(_mm256_srai_epi32(asInt(p_value), 31)); }
+		static __m256 maskOr(__m256 p_a, __m256 p_b) { return _mm256_or_ps(p_a, p_b); }
+		static __m256 select(__m256 p_mask, __m256 p_true, __m256 p_false) { return _mm256_blendv_ps(p_false, p_true, p_mask); }
+
+		static __m256 bitAnd(__m256 p_a, __m256 p_b) { return _mm256_and_ps(p_a, p_b); }
+		static __m256 bitOr(__m256 p_a, __m256 p_b) { return _mm256_or_ps(p_a, p_b); }
+		static __m256 bitXor(__m256 p_a, __m256 p_b) { return _mm256_xor_ps(p_a, p_b); }
+
+		static __m256  round(__m256 p_value) { return _mm256_round_ps(p_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static __m256i toInt(__m256 p_value) { return _mm256_cvttps_epi32(p_value); }
+		static __m256  toFloat(__m256i p_value) { return _mm256_cvtepi32_ps(p_value); }
+		static __m256i asInt(__m256 p_value) { return _mm256_castps_si256(p_value); }
+		static __m256  asFloat(__m256i p_value) { return _mm256_castsi256_ps(p_value); }
+
+		static __m256i set1Int(int32 p_value) { return _mm256_set1_epi32(p_value); }
+		static __m256i addInt(__m256i p_a, __m256i p_b) { return _mm256_add_epi32(p_a, p_b); }
+		static __m256i subInt(__m256i p_a, __m256i p_b) { return _mm256_sub_epi32(p_a, p_b); }
+		static __m256i andInt(__m256i p_a, __m256i p_b) { return _mm256_and_si256(p_a, p_b); }
+		static __m256i orInt(__m256i p_a, __m256i p_b) { return _mm256_or_si256(p_a, p_b); }
+		static void    storeInt(int32 *p_ptr, __m256i p_value) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p_ptr), p_value); }
+
+		template<int Bits>
+		static __m256i shiftLeftInt(__m256i p_value) { return _mm256_slli_epi32(p_value, Bits); }
+
+		template<int Bits>
+		static __m256i shiftRightInt(__m256i p_value) { return _mm256_srai_epi32(p_value, Bits); }
+
+		// 12 bit estimate and one Newton-Raphson step, x * estimate first so no intermediate leaves the normal range.
+		// Infinite estimates (0, and subnormals where the estimate flushes them) and infinite inputs keep the estimate,
+		// the step would turn them into NaN or -infinity
+		static __m256 rsqrt(__m256 p_value)
+		{
+			const __m256 estimate = _mm256_rsqrt_ps(p_value);
+			const __m256 half_xe  = _mm256_mul_ps(_mm256_mul_ps(p_value, estimate), _mm256_set1_ps(0.5f));
+			const __m256 refined  = _mm256_mul_ps(estimate, _mm256_fnmadd_ps(half_xe, estimate, _mm256_set1_ps(1.5f)));
+			const auto   keep     = maskOr(equal(bitAnd(estimate, asFloat(set1Int(0x7FFFFFFF))), _mm256_set1_ps(INFINITY)), equal(p_value, _mm256_set1_ps(INFINITY)));
+			return select(keep, estimate, refined);
+		}
+	};
+	#endif
+
+	#if TSM_SIMD_SSE4
+	struct Sse4Ops
+	{
+		using type = __m128;
+
+		static constexpr uint64 c_width{4u};
+
+		static __m128 load(const float *p_ptr) { return _mm_loadu_ps(p_ptr); }
+		static void   store(float *p_ptr, __m128 p_value) { _mm_storeu_ps(p_ptr, p_value); }
+		static __m128 set1(float p_value) { return _mm_set1_ps(p_value); }
+		static __m128 add(__m128 p_a, __m128 p_b) { return _mm_add_ps(p_a, p_b); }
+		static __m128 sub(__m128 p_a, __m128 p_b) { return _mm_sub_ps(p_a, p_b); }
+		static __m128 mul(__m128 p_a, __m128 p_b) { return _mm_mul_ps(p_a, p_b); }
+		static __m128 madd(__m128 p_a, __m128 p_b, __m128 p_c) { return simd::madd(p_a, p_b, p_c); }
+		static __m128 div(__m128 p_a, __m128 p_b) { return _mm_div_ps(p_a, p_b); }
+		static __m128 min(__m128 p_a, __m128 p_b) { return _mm_min_ps(p_a, p_b); }
+		static __m128 max(__m128 p_a, __m128 p_b) { return _mm_max_ps(p_a, p_b); }
+		static __m128 sqrt(__m128 p_value) { return _mm_sqrt_ps(p_value); }
+
+		static float reduceMin(__m128 p_value)
+		{
+			const __m128 value = _mm_min_ps(p_value, _mm_movehl_ps(p_value, p_value));
+			return _mm_cvtss_f32(_mm_min_ss(value, simd::splat<1>(value)));
+		}
+
+		static float reduceMax(__m128 p_value)
+		{
+			const __m128 value = _mm_max_ps(p_value, _mm_movehl_ps(p_value, p_value));
+			return _mm_cvtss_f32(_mm_max_ss(value, simd::splat<1>(value)));
+		}
+
+		static uint32 lessMask(__m128 p_a, __m128 p_b) { return static_cast<uint32>(_mm_movemask_ps(_mm_cmplt_ps(p_a, p_b))); }
+
+		// No gather instruction before AVX2
+		static __m128 gather(const float *p_base, int32 p_stride)
+		{
+			return _mm_setr_ps(p_base[0], p_base[p_stride], p_base[p_stride * 2], p_base[p_stride * 3]);
+		}
+
+		using itype = __m128i;
+		using mask  = __m128; // All bits set per true lane
+
+		static __m128 less(__m128 p_a, __m128 p_b) { return _mm_cmplt_ps(p_a, p_b); }
+		static __m128 equal(__m128 p_a, __m128 p_b) { return _mm_cmpeq_ps(p_a, p_b); }
+		static __m128 isNan(__m128 p_value) { return _mm_cmpunord_ps(p_value, p_value); }
+		static __m128 isNegative(__m128 p_value) { return asFloat(_mm_srai_epi32(asInt(p_value), 31)); }
+		static __m128 maskOr(__m128 p_a, __m128 p_b) { return _mm_or_ps(p_a, p_b); }
+		static __m128 select(__m128 p_mask, __m128 p_true, __m128 p_false) { return _mm_blendv_ps(p_false, p_true, p_mask); }
+
+		static __m128 bitAnd(__m128 p_a, __m128 p_b) { return _mm_and_ps(p_a, p_b); }
+		static __m128 bitOr(__m128 p_a, __m128 p_b) { return _mm_or_ps(p_a, p_b); }
+		static __m128 bitXor(__m128 p_a, __m128 p_b) { return _mm_xor_ps(p_a, p_b); }
+
+		static __m128  round(__m128 p_value) { return _mm_round_ps(p_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static __m128i toInt(__m128 p_value) { return _mm_cvttps_epi32(p_value); }
+		static __m128  toFloat(__m128i p_value) { return _mm_cvtepi32_ps(p_value); }
+		static __m128i asInt(__m128 p_value) { return _mm_castps_si128(p_value); }
+		static __m128  asFloat(__m128i p_value) { return _mm_castsi128_ps(p_value); }
+
+		static __m128i set1Int(int32 p_value) { return _mm_set1_epi32(p_value); }
+		static __m128i addInt(__m128i p_a, __m128i p_b) { return _mm_add_epi32(p_a, p_b); }
+		static __m128i subInt(__m128i p_a, __m128i p_b) { return _mm_sub_epi32(p_a, p_b); }
+		static __m128i andInt(__m128i p_a, __m128i p_b) { return _mm_and_si128(p_a, p_b); }
+		static __m128i orInt(__m128i p_a, __m128i p_b) { return _mm_or_si128(p_a, p_b); }
+		static void    storeInt(int32 *p_ptr, __m128i p_value) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p_ptr), p_value); }
+
+		template<int Bits>
+		static __m128i shiftLeftInt(__m128i p_value) { return _mm_slli_epi32(p_value, Bits); }
+
+		template<int Bits>
+		static __m128i shiftRightInt(__m128i p_value) { return _mm_srai_epi32(p_value, Bits); }
+
+		// 12 bit estimate and one Newton-Raphson step, x * estimate first so no intermediate leaves the normal range.
+		// Infinite estimates (0, and subnormals where the estimate flushes them) and infinite inputs keep the estimate,
+		// the step would turn them into NaN or -infinity
+		static __m128 rsqrt(__m128 p_value)
+		{
+			const __m128 estimate = _mm_rsqrt_ps(p_value);
+			const __m128 half_xe  = _mm_mul_ps(_mm_mul_ps(p_value, estimate), _mm_set1_ps(0.5f));
+			const __m128 refined  = _mm_mul_ps(estimate, simd::nmadd(half_xe, estimate, _mm_set1_ps(1.5f)));
+			const auto   keep     = maskOr(equal(bitAnd(estimate, asFloat(set1Int(0x7FFFFFFF))), _mm_set1_ps(INFINITY)), equal(p_value, _mm_set1_ps(INFINITY)));
+			return select(keep, estimate, refined);
+		}
+	};
+	#endif
+
+	// The widest set the build targets
+	#if defined(__AVX512F__) && TSM_SIMD_AVX2
+	using WideOps = Avx512Ops;
+	#elif TSM_SIMD_AVX2
+	using WideOps = Avx2Ops;
+	#elif TSM_SIMD_SSE4
+	using WideOps = Sse4Ops;
+	#else
+	using WideOps = ScalarOps;
+	#endif
+}
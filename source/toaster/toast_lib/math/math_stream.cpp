@@ -0,0 +1,348 @@
+#include "math_stream.hpp"
+#include "math_simd_wide.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace tsm
+{
+	namespace
+	{
+		// Column major, m[column][row]
+		struct Matrix3x4Elements
+		{
+			float m[4][3];
+
+			explicit Matrix3x4Elements(const float4x4 &p_matrix)
+			{
+				const glm::mat4 matrix = p_matrix.toGlm();
+				for (int column = 0; column < 4; column++)
+				{
+					for (int row = 0; row < 3; row++)
+					{
+						m[column][row] = matrix[column][row];
+					}
+				}
+			}
+		};
+
+		// Each kernel returns the index it stopped at, the remainder is finished by the ScalarOps instantiation
+
+		template<typename Ops>
+		uint64 transformPointsKernel(const Matrix3x4Elements &p_m, const Float3Stream &p_in, Float3Stream &p_out, uint64 p_begin, uint64 p_end)
+		{
+			using V = typename Ops::type;
+
+			V m[4][3];
+			for (int column = 0; column < 4; column++)
+				for (int row = 0; row < 3; row++)
+					m[column][row] = Ops::set1(p_m.m[column][row]);
+
+			const float *in_x  = p_in.x();
+			const float *in_y  = p_in.y();
+			const float *in_z  = p_in.z();
+			float *      out_x = p_out.x();
+			float *      out_y = p_out.y();
+			float *      out_z = p_out.z();
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const V x = Ops::load(in_x + i);
+				const V y = Ops::load(in_y + i);
+				const V z = Ops::load(in_z + i);
+
+				Ops::store(out_x + i, Ops::madd(m[0][0], x, Ops::madd(m[1][0], y, Ops::madd(m[2][0], z, m[3][0]))));
+				Ops::store(out_y + i, Ops::madd(m[0][1], x, Ops::madd(m[1][1], y, Ops::madd(m[2][1], z, m[3][1]))));
+				Ops::store(out_z + i, Ops::madd(m[0][2], x, Ops::madd(m[1][2], y, Ops::madd(m[2][2], z, m[3][2]))));
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 transformNormalsKernel(const Matrix3x4Elements &p_m, const Float3Stream &p_in, Float3Stream &p_out, uint64 p_begin, uint64 p_end)
+		{
+			using V = typename Ops::type;
+
+			V m[3][3];
+			for (int column = 0; column < 3; column++)
+				for (int row = 0; row < 3; row++)
+					m[column][row] = Ops::set1(p_m.m[column][row]);
+
+			// Keeps zero length normals at zero instead of turning them into NaN
+			const V min_length_sq = Ops::set1(FLT_MIN);
+
+			const float *in_x  = p_in.x();
+			const float *in_y  = p_in.y();
+			const float *in_z  = p_in.z();
+			float *      out_x = p_out.x();
+			float *      out_y = p_out.y();
+			float *      out_z = p_out.z();
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const V x = Ops::load(in_x + i);
+				const V y = Ops::load(in_y + i);
+				const V z = Ops::load(in_z + i);
+
+				const V nx = Ops::madd(m[0][0], x, Ops::madd(m[1][0], y, Ops::mul(m[2][0], z)));
+				const V ny = Ops::madd(m[0][1], x, Ops::madd(m[1][1], y, Ops::mul(m[2][1], z)));
+				const V nz = Ops::madd(m[0][2], x, Ops::madd(m[1][2], y, Ops::mul(m[2][2], z)));
+
+				const V length_sq  = Ops::madd(nx, nx, Ops::madd(ny, ny, Ops::mul(nz, nz)));
+				const V rcp_length = Ops::rsqrt(Ops::max(length_sq, min_length_sq));
+
+				Ops::store(out_x + i, Ops::mul(nx, rcp_length));
+				Ops::store(out_y + i, Ops::mul(ny, rcp_length));
+				Ops::store(out_z + i, Ops::mul(nz, rcp_length));
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 boundsKernel(const Float3Stream &p_stream, uint64 p_begin, uint64 p_end, glm::vec3 &p_min, glm::vec3 &p_max)
+		{
+			using V = typename Ops::type;
+
+			V min_x = Ops::set1(p_min.x), min_y = Ops::set1(p_min.y), min_z = Ops::set1(p_min.z);
+			V max_x = Ops::set1(p_max.x), max_y = Ops::set1(p_max.y), max_z = Ops::set1(p_max.z);
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const V x = Ops::load(p_stream.x() + i);
+				const V y = Ops::load(p_stream.y() + i);
+				const V z = Ops::load(p_stream.z() + i);
+
+				min_x = Ops::min(min_x, x);
+				min_y = Ops::min(min_y, y);
+				min_z = Ops::min(min_z, z);
+				max_x = Ops::max(max_x, x);
+				max_y = Ops::max(max_y, y);
+				max_z = Ops::max(max_z, z);
+			}
+
+			p_min = {Ops::reduceMin(min_x), Ops::reduceMin(min_y), Ops::reduceMin(min_z)};
+			p_max = {Ops::reduceMax(max_x), Ops::reduceMax(max_y), Ops::reduceMax(max_z)};
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 dotKernel(const Float3Stream &p_a, const Float3Stream &p_b, float *p_out, uint64 p_begin, uint64 p_end)
+		{
+			using V = typename Ops::type;
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const V x = Ops::mul(Ops::load(p_a.x() + i), Ops::load(p_b.x() + i));
+				const V y = Ops::madd(Ops::load(p_a.y() + i), Ops::load(p_b.y() + i), x);
+				Ops::store(p_out + i, Ops::madd(Ops::load(p_a.z() + i), Ops::load(p_b.z() + i), y));
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 dotDirectionKernel(const Float3Stream &p_stream, const glm::vec3 &p_direction, float *p_out, uint64 p_begin, uint64 p_end)
+		{
+			using V = typename Ops::type;
+
+			const V dx = Ops::set1(p_direction.x);
+			const V dy = Ops::set1(p_direction.y);
+			const V dz = Ops::set1(p_direction.z);
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const V x = Ops::mul(Ops::load(p_stream.x() + i), dx);
+				const V y = Ops::madd(Ops::load(p_stream.y() + i), dy, x);
+				Ops::store(p_out + i, Ops::madd(Ops::load(p_stream.z() + i), dz, y));
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 gatherKernel(const uint8 *p_base, uint64 p_stride, Float3Stream &p_out, uint64 p_begin, uint64 p_end)
+		{
+			const int32 stride_floats = static_cast<int32>(p_stride / sizeof(float));
+
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_end; i += Ops::c_width)
+			{
+				const auto *element = reinterpret_cast<const float *>(p_base + i * p_stride);
+
+				Ops::store(p_out.x() + i, Ops::gather(element, stride_floats));
+				Ops::store(p_out.y() + i, Ops::gather(element + 1, stride_floats));
+				Ops::store(p_out.z() + i, Ops::gather(element + 2, stride_floats));
+			}
+			return i;
+		}
+
+		uint64 roundUpToPadding(uint64 p_count)
+		{
+			return (p_count + Float3Stream::c_streamPadding - 1u) & ~(Float3Stream::c_streamPadding - 1u);
+		}
+	}
+
+	Float3Stream::Float3Stream(const toaster::memory::EMemoryTag p_tag) : m_tag(p_tag)
+	{
+	}
+
+	Float3Stream::Float3Stream(const uint64 p_count, const toaster::memory::EMemoryTag p_tag) : m_tag(p_tag)
+	{
+		resize(p_count);
+	}
+
+	Float3Stream::~Float3Stream()
+	{
+		toaster::memory::trackedFree(m_data, m_capacity * 3u * sizeof(float), 64u, m_tag);
+	}
+
+	Float3Stream::Float3Stream(const Float3Stream &p_other) : m_tag(p_other.m_tag)
+	{
+		*this = p_other;
+	}
+
+	Float3Stream &Float3Stream::operator=(const Float3Stream &p_other)
+	{
+		if (this == &p_other)
+			return *this;
+
+		if (m_capacity < p_other.m_size)
+		{
+			toaster::memory::trackedFree(m_data, m_capacity * 3u * sizeof(float), 64u, m_tag);
+			m_capacity = roundUpToPadding(p_other.m_size);
+			m_data     = static_cast<float *>(toaster::memory::trackedAlloc(m_capacity * 3u * sizeof(float), 64u, m_tag));
+		}
+
+		const uint64 padded_size = roundUpToPadding(p_other.m_size);
+		for (uint32 channel = 0u; channel < 3u; channel++)
+		{
+			float *dst = m_data + channel * m_capacity;
+			if (p_other.m_size)
+				std::memcpy(dst, p_other.m_data + channel * p_other.m_capacity, p_other.m_size * sizeof(float));
+			std::fill(dst + p_other.m_size, dst + padded_size, 0.0f);
+		}
+
+		m_size = p_other.m_size;
+		return *this;
+	}
+
+	Float3Stream::Float3Stream(Float3Stream &&p_other) noexcept
+		: m_data(std::exchange(p_other.m_data, nullptr)), m_size(std::exchange(p_other.m_size, 0u)),
+		  m_capacity(std::exchange(p_other.m_capacity, 0u)), m_tag(p_other.m_tag)
+	{
+	}
+
+	Float3Stream &Float3Stream::operator=(Float3Stream &&p_other) noexcept
+	{
+		std::swap(m_data, p_other.m_data);
+		std::swap(m_size, p_other.m_size);
+		std::swap(m_capacity, p_other.m_capacity);
+		std::swap(m_tag, p_other.m_tag);
+		return *this;
+	}
+
+	void Float3Stream::resize(const uint64 p_count)
+	{
+		if (p_count > m_capacity)
+		{
+			_reallocate(roundUpToPadding(std::max(p_count, m_capacity + m_capacity / 2u)));
+		}
+
+		// Keeps everything between the size and the next padding boundary zeroed
+		const uint64 begin = std::min(m_size, p_count);
+		const uint64 end   = roundUpToPadding(std::max(m_size, p_count));
+		for (uint32 channel = 0u; channel < 3u && m_data; channel++)
+		{
+			float *data = m_data + channel * m_capacity;
+			std::fill(data + begin, data + end, 0.0f);
+		}
+
+		// Growing only zeroed the new elements, shrinking zeroed the removed ones
+		m_size = p_count;
+	}
+
+	void Float3Stream::_reallocate(const uint64 p_capacity)
+	{
+		auto *data = static_cast<float *>(toaster::memory::trackedAlloc(p_capacity * 3u * sizeof(float), 64u, m_tag));
+
+		for (uint32 channel = 0u; channel < 3u; channel++)
+		{
+			float *dst = data + channel * p_capacity;
+			if (m_size)
+				std::memcpy(dst, m_data + channel * m_capacity, m_size * sizeof(float));
+			std::fill(dst + m_size, dst + p_capacity, 0.0f);
+		}
+
+		toaster::memory::trackedFree(m_data, m_capacity * 3u * sizeof(float), 64u, m_tag);
+		m_data     = data;
+		m_capacity = p_capacity;
+	}
+
+	void transformPoints(const float4x4 &p_matrix, const Float3Stream &p_in, Float3Stream &p_out)
+	{
+		p_out.resize(p_in.size());
+
+		const Matrix3x4Elements m(p_matrix);
+		const uint64            tail = transformPointsKernel<simd::WideOps>(m, p_in, p_out, 0u, p_in.size());
+		transformPointsKernel<simd::ScalarOps>(m, p_in, p_out, tail, p_in.size());
+	}
+
+	void transformNormals(const float4x4 &p_normal_matrix, const Float3Stream &p_in, Float3Stream &p_out)
+	{
+		p_out.resize(p_in.size());
+
+		const Matrix3x4Elements m(p_normal_matrix);
+		const uint64            tail = transformNormalsKernel<simd::WideOps>(m, p_in, p_out, 0u, p_in.size());
+		transformNormalsKernel<simd::ScalarOps>(m, p_in, p_out, tail, p_in.size());
+	}
+
+	void computeBounds(const Float3Stream &p_stream, glm::vec3 &p_out_min, glm::vec3 &p_out_max)
+	{
+		p_out_min = glm::vec3(FLT_MAX);
+		p_out_max = glm::vec3(-FLT_MAX);
+
+		const uint64 tail = boundsKernel<simd::WideOps>(p_stream, 0u, p_stream.size(), p_out_min, p_out_max);
+		boundsKernel<simd::ScalarOps>(p_stream, tail, p_stream.size(), p_out_min, p_out_max);
+	}
+
+	void dot(const Float3Stream &p_a, const Float3Stream &p_b, float *p_out)
+	{
+		const uint64 count = std::min(p_a.size(), p_b.size());
+		const uint64 tail  = dotKernel<simd::WideOps>(p_a, p_b, p_out, 0u, count);
+		dotKernel<simd::ScalarOps>(p_a, p_b, p_out, tail, count);
+	}
+
+	void dot(const Float3Stream &p_stream, const glm::vec3 &p_direction, float *p_out)
+	{
+		const uint64 tail = dotDirectionKernel<simd::WideOps>(p_stream, p_direction, p_out, 0u, p_stream.size());
+		dotDirectionKernel<simd::ScalarOps>(p_stream, p_direction, p_out, tail, p_stream.size());
+	}
+
+	void gatherFromAoS(const void *p_base, const uint64 p_stride, const uint64 p_count, Float3Stream &p_out)
+	{
+		p_out.resize(p_count);
+
+		const auto * base = static_cast<const uint8 *>(p_base);
+		const uint64 tail = gatherKernel<simd::WideOps>(base, p_stride, p_out, 0u, p_count);
+		gatherKernel<simd::ScalarOps>(base, p_stride, p_out, tail, p_count);
+	}
+
+	void scatterToAoS(const Float3Stream &p_stream, void *p_base, const uint64 p_stride)
+	{
+		// Nothing to gain from SIMD here before AVX-512 scatters, the loop is bound by the strided stores
+		auto *base = static_cast<uint8 *>(p_base);
+		for (uint64 i = 0u; i < p_stream.size(); i++)
+		{
+			auto *element = reinterpret_cast<float *>(base + i * p_stride);
+			element[0]    = p_stream.x()[i];
+			element[1]    = p_stream.y()[i];
+			element[2]    = p_stream.z()[i];
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "system_types.h"
+#include "math_matrix.hpp"
+#include "memory/memory_tracker.hpp"
+
+namespace tsm
+{
+	// Structure of arrays storage for 3 component vectors: all x, then all y, then all z.
+	// Each channel is 64 byte aligned and padded to a multiple of c_streamPadding with zeros, so the batch kernels
+	// below always load full vectors from aligned memory
+	class Float3Stream
+	{
+	public:
+		static constexpr uint64 c_streamPadding{16u};
+
+		explicit Float3Stream(toaster::memory::EMemoryTag p_tag = toaster::memory::EMemoryTag::eGeneral);
+		explicit Float3Stream(uint64 p_count, toaster::memory::EMemoryTag p_tag = toaster::memory::EMemoryTag::eGeneral);
+		~Float3Stream();
+
+		Float3Stream(const Float3Stream &p_other);
+		Float3Stream &operator=(const Float3Stream &p_other);
+
+		Float3Stream(Float3Stream &&p_other) noexcept;
+		Float3Stream &operator=(Float3Stream &&p_other) noexcept;
+
+		// New elements are zero, existing ones are kept
+		void resize(uint64 p_count);
+		void clear() { resize(0u); }
+
+		[[nodiscard]] uint64 size() const { return m_size; }
+		[[nodiscard]] bool   empty() const { return m_size == 0u; }
+		// Floats per channel, a multiple of c_streamPadding
+		[[nodiscard]] uint64 getCapacity() const { return m_capacity; }
+
+		[[nodiscard]] float *      x() { return m_data; }
+		[[nodiscard]] float *      y() { return m_data + m_capacity; }
+		[[nodiscard]] float *      z() { return m_data + m_capacity * 2u; }
+		[[nodiscard]] const float *x() const { return m_data; }
+		[[nodiscard]] const float *y() const { return m_data + m_capacity; }
+		[[nodiscard]] const float *z() const { return m_data + m_capacity * 2u; }
+
+		[[nodiscard]] glm::vec3 get(uint64 p_index) const { return {x()[p_index], y()[p_index], z()[p_index]}; }
+
+		void set(uint64 p_index, const glm::vec3 &p_value)
+		{
+			x()[p_index] = p_value.x;
+			y()[p_index] = p_value.y;
+			z()[p_index] = p_value.z;
+		}
+
+	private:
+		void _reallocate(uint64 p_capacity);
+
+		float *m_data{nullptr};
+		uint64 m_size{0u};
+		uint64 m_capacity{0u};
+
+		toaster::memory::EMemoryTag m_tag{toaster::memory::EMemoryTag::eGeneral};
+	};
+
+	// Batch kernels. They process 16 (AVX-512), 8 (AVX2) or 4 (SSE4) elements per iteration and finish the remainder
+	// with scalar code. Input and output streams may be the same stream, the output is resized to the input's size.
+	// Against the same math in scalar glm, in ulps of the sum of the terms' magnitudes: transformPoints() and dot()
+	// within 4 and 3, transformNormals() within 8 ulps of 1 (rsqrt with one Newton step). computeBounds() and the
+	// gather / scatter are exact
+
+	// p_matrix * (p, 1), without the perspective divide
+	void transformPoints(const float4x4 &p_matrix, const Float3Stream &p_in, Float3Stream &p_out);
+
+	// Upper 3x3 of p_normal_matrix * n, renormalized. Pass the inverse transpose of the model matrix for
+	// non-uniformly scaled transforms
+	void transformNormals(const float4x4 &p_normal_matrix, const Float3Stream &p_in, Float3Stream &p_out);
+
+	// Component wise min / max over the whole stream. An empty stream gives min = +FLT_MAX, max = -FLT_MAX
+	void computeBounds(const Float3Stream &p_stream, glm::vec3 &p_out_min, glm::vec3 &p_out_max);
+
+	// p_out[i] = dot(a[i], b[i]). p_out needs room for p_a.size() floats, the streams must be the same size
+	void dot(const Float3Stream &p_a, const Float3Stream &p_b, float *p_out);
+
+	// p_out[i] = dot(stream[i], p_direction)
+	void dot(const Float3Stream &p_stream, const glm::vec3 &p_direction, float *p_out);
+
+	// Reads p_count vec3s starting at p_base, p_stride bytes apart (e.g. &vertices[0].position, sizeof(Vertex)).
+	// p_stride must be a multiple of 4
+	void gatherFromAoS(const void *p_base, uint64 p_stride, uint64 p_count, Float3Stream &p_out);
+
+	// The inverse of gatherFromAoS(), writes the stream back into interleaved memory
+	void scatterToAoS(const Float3Stream &p_stream, void *p_base, uint64 p_stride);
+}
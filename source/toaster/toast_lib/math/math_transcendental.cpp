@@ -0,0 +1,99 @@
+#include "math_transcendental.hpp"
+
+namespace tsm
+{
+	namespace
+	{
+		// Each kernel returns the index it stopped at, the remainder is finished by the ScalarOps instantiation
+
+		template<typename Ops, typename Function>
+		uint64 unaryKernel(const float *p_in, float *p_out, uint64 p_begin, uint64 p_count, Function p_function)
+		{
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_count; i += Ops::c_width)
+			{
+				Ops::store(p_out + i, p_function(Ops::load(p_in + i)));
+			}
+			return i;
+		}
+
+		template<typename Ops, typename Function>
+		uint64 binaryKernel(const float *p_a, const float *p_b, float *p_out, uint64 p_begin, uint64 p_count, Function p_function)
+		{
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_count; i += Ops::c_width)
+			{
+				Ops::store(p_out + i, p_function(Ops::load(p_a + i), Ops::load(p_b + i)));
+			}
+			return i;
+		}
+
+		template<typename Ops>
+		uint64 sincosKernel(const float *p_in, float *p_out_sin, float *p_out_cos, uint64 p_begin, uint64 p_count)
+		{
+			uint64 i = p_begin;
+			for (; i + Ops::c_width <= p_count; i += Ops::c_width)
+			{
+				typename Ops::type s, c;
+				simd::sincos<Ops>(Ops::load(p_in + i), s, c);
+				Ops::store(p_out_sin + i, s);
+				Ops::store(p_out_cos + i, c);
+			}
+			return i;
+		}
+
+		// Generic lambdas so one call site instantiates both the wide and the scalar version
+		#define TSM_UNARY_BATCH(p_function)                                                                                             \
+			const uint64 i = unaryKernel<simd::WideOps>(p_in, p_out, 0u, p_count, [](auto p_x) { return p_function<simd::WideOps>(p_x); }); \
+			unaryKernel<simd::ScalarOps>(p_in, p_out, i, p_count, [](float p_x) { return p_function<simd::ScalarOps>(p_x); })
+
+		#define TSM_BINARY_BATCH(p_function, p_a, p_b)                                                                                                    \
+			const uint64 i = binaryKernel<simd::WideOps>(p_a, p_b, p_out, 0u, p_count, [](auto p_l, auto p_r) { return p_function<simd::WideOps>(p_l, p_r); }); \
+			binaryKernel<simd::ScalarOps>(p_a, p_b, p_out, i, p_count, [](float p_l, float p_r) { return p_function<simd::ScalarOps>(p_l, p_r); })
+	}
+
+	void sin(const float *p_in, const uint64 p_count, float *p_out)
+	{
+		TSM_UNARY_BATCH(simd::sin);
+	}
+
+	void cos(const float *p_in, const uint64 p_count, float *p_out)
+	{
+		TSM_UNARY_BATCH(simd::cos);
+	}
+
+	void sincos(const float *p_in, const uint64 p_count, float *p_out_sin, float *p_out_cos)
+	{
+		const uint64 i = sincosKernel<simd::WideOps>(p_in, p_out_sin, p_out_cos, 0u, p_count);
+		sincosKernel<simd::ScalarOps>(p_in, p_out_sin, p_out_cos, i, p_count);
+	}
+
+	void exp(const float *p_in, const uint64 p_count, float *p_out)
+	{
+		TSM_UNARY_BATCH(simd::exp);
+	}
+
+	void log(const float *p_in, const uint64 p_count, float *p_out)
+	{
+		TSM_UNARY_BATCH(simd::log);
+	}
+
+	void pow(const float *p_base, const float *p_exponent, const uint64 p_count, float *p_out)
+	{
+		TSM_BINARY_BATCH(simd::pow, p_base, p_exponent);
+	}
+
+	void atan2(const float *p_y, const float *p_x, const uint64 p_count, float *p_out)
+	{
+		TSM_BINARY_BATCH(simd::atan2, p_y, p_x);
+	}
+
+	void rsqrt(const float *p_in, const uint64 p_count, float *p_out)
+	{
+		const uint64 i = unaryKernel<simd::WideOps>(p_in, p_out, 0u, p_count, [](auto p_x) { return simd::WideOps::rsqrt(p_x); });
+		unaryKernel<simd::ScalarOps>(p_in, p_out, i, p_count, [](float p_x) { return simd::ScalarOps::rsqrt(p_x); });
+	}
+
+	#undef TSM_UNARY_BATCH
+	#undef TSM_BINARY_BATCH
+}
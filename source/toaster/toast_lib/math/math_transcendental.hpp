@@ -0,0 +1,282 @@
+#pragma once
+
+#include "system_types.h"
+#include "math_float4.hpp"
+#include "math_simd_wide.hpp"
+
+// Vectorized sin, cos, exp, log, pow, atan2 and rsqrt.
+//
+// Every function is written once over the register wide operations in math_simd_wide.hpp, so the scalar, float4
+// and batch versions below give the same results for the same build, rsqrt aside. Cephes style range reduction and
+// minimax polynomials, no tables and no branches.
+//
+// Max error against the correctly rounded result, measured over every float in the domain:
+//	sin, cos, sincos  2.5 ULP for |x| <= 8192 (1.6 ULP for |x| <= pi), NaN for infinity and NaN. Accuracy drops
+//	                  beyond 8192, the result stays in [-1, 1]
+//	exp               1.1 ULP, 0 below -103.97, infinity above 88.72. Subnormal results are correct but slow, every
+//	                  lane that produces one takes a microcode assist on x86
+//	log               1 ULP for x > 0, -infinity for 0, NaN below 0
+//	pow               exp(y * log(x)): 2.5 ULP per unit of |y * log(x)|, counted as at least 1, the errors of log(x)
+//	                  and of the product are scaled up with it (200 ULP close to overflow). 1 for y == 0 or x == 1,
+//	                  NaN for x < 0 (also for integer y, unlike std::pow), +infinity for +-0 and y < 0. Results
+//	                  within an ulp of FLT_MAX may already be infinity
+//	atan2             3 ULP, signed zeros and infinities handled like std::atan2
+//	rsqrt             4 ULP, the worst just above FLT_MIN. Subnormal inputs give +-infinity like +-0 does, except with
+//	                  AVX-512, which computes them. 1 / std::sqrt in the scalar build
+
+namespace tsm::simd
+{
+	template<typename Ops>
+	TSM_INLINE typename Ops::type abs(typename Ops::type p_value)
+	{
+		return Ops::bitAnd(p_value, Ops::asFloat(Ops::set1Int(0x7FFFFFFF)));
+	}
+
+	template<typename Ops>
+	TSM_INLINE void sincos(typename Ops::type p_x, typename Ops::type &p_out_sin, typename Ops::type &p_out_cos)
+	{
+		using V = typename Ops::type;
+
+		// x = j * pi/2 + r, |r| <= pi/4. pi/2 is split in four parts, the first three have at most 11 significant bits
+		// so j * part is exact for |j| < 2^13 with or without FMA
+		const V j = Ops::round(Ops::mul(p_x, Ops::set1(0.636619772367581343f)));
+		V       r = Ops::madd(j, Ops::set1(-1.5703125f), p_x);
+		r         = Ops::madd(j, Ops::set1(-4.837512969970703125e-4f), r);
+		r         = Ops::madd(j, Ops::set1(-7.549533620476723e-8f), r);
+		r         = Ops::madd(j, Ops::set1(-2.5633440682570896e-12f), r);
+
+		// Far beyond 8192 the reduction is off by more than pi/4, kept in the polynomials' range so the results stay in
+		// [-1, 1]. NaN passes through, it is the second operand
+		r = Ops::min(Ops::set1(0.8f), Ops::max(Ops::set1(-0.8f), r));
+
+		const V z = Ops::mul(r, r);
+
+		const V sin_r = Ops::madd(Ops::mul(r, z), Ops::madd(Ops::madd(Ops::set1(-1.9515295891e-4f), z, Ops::set1(8.3321608736e-3f)), z, Ops::set1(-1.6666654611e-1f)), r);
+
+		V cos_r = Ops::madd(Ops::madd(Ops::set1(2.443315711809948e-5f), z, Ops::set1(-1.388731625493765e-3f)), z, Ops::set1(4.166664568298827e-2f));
+		cos_r   = Ops::madd(Ops::mul(z, z), cos_r, Ops::madd(z, Ops::set1(-0.5f), Ops::set1(1.0f)));
+
+		// Odd quadrants swap sin and cos, the sign comes from bit 1 of the quadrant (sin) and of quadrant + 1 (cos)
+		const auto quadrant = Ops::toInt(j);
+		const auto one      = Ops::set1Int(1);
+		const auto swap     = Ops::equal(Ops::toFloat(Ops::andInt(quadrant, one)), Ops::set1(1.0f));
+
+		const V sin_sign = Ops::asFloat(Ops::template shiftLeftInt<30>(Ops::andInt(quadrant, Ops::set1Int(2))));
+		const V cos_sign = Ops::asFloat(Ops::template shiftLeftInt<30>(Ops::andInt(Ops::addInt(quadrant, one), Ops::set1Int(2))));
+
+		p_out_sin = Ops::bitXor(Ops::select(swap, cos_r, sin_r), sin_sign);
+		p_out_cos = Ops::bitXor(Ops::select(swap, sin_r, cos_r), cos_sign);
+	}
+
+	template<typename Ops>
+	TSM_INLINE typename Ops::type sin(typename Ops::type p_x)
+	{
+		typename Ops::type s, c;
+		sincos<Ops>(p_x, s, c);
+		return s;
+	}
+
+	template<typename Ops>
+	TSM_INLINE typename Ops::type cos(typename Ops::type p_x)
+	{
+		typename Ops::type s, c;
+		sincos<Ops>(p_x, s, c);
+		return c;
+	}
+
+	template<typename Ops>
+	TSM_INLINE typename Ops::type exp(typename Ops::type p_x)
+	{
+		using V = typename Ops::type;
+
+		constexpr float c_maxInput{88.7228391f};   // log(FLT_MAX)
+		constexpr float c_minInput{-103.972084f}; // log of half the smallest subnormal
+
+		// Clamped so the exponent math below can not overflow, the out of range results are selected at the end. Lanes
+		// below the range compute exp(0) instead, a subnormal intermediate costs a microcode assist on x86
+		const V x = Ops::select(Ops::less(p_x, Ops::set1(c_minInput)), Ops::set1(0.0f), Ops::min(p_x, Ops::set1(c_maxInput + 1.0f)));
+
+		// x = n * ln2 + r, ln2 in two parts
+		const V n = Ops::round(Ops::mul(x, Ops::set1(1.44269504088896341f)));
+		V       r = Ops::madd(n, Ops::set1(-0.693359375f), x);
+		r         = Ops::madd(n, Ops::set1(2.12194440e-4f), r);
+
+		V p = Ops::madd(Ops::set1(1.9875691500e-4f), r, Ops::set1(1.3981999507e-3f));
+		p   = Ops::madd(p, r, Ops::set1(8.3334519073e-3f));
+		p   = Ops::madd(p, r, Ops::set1(4.1665795894e-2f));
+		p   = Ops::madd(p, r, Ops::set1(1.6666665459e-1f));
+		p   = Ops::madd(p, r, Ops::set1(5.0000001201e-1f));
+		p   = Ops::add(Ops::madd(p, Ops::mul(r, r), r), Ops::set1(1.0f));
+
+		// 2^n in two steps, n reaches 128 at the top and -150 at the bottom which a single exponent can not hold.
+		// The second multiply rounds subnormal results only once
+		const auto n_int  = Ops::toInt(n);
+		const auto n_half = Ops::template shiftRightInt<1>(n_int);
+		const auto bias   = Ops::set1Int(127);
+
+		p = Ops::mul(p, Ops::asFloat(Ops::template shiftLeftInt<23>(Ops::addInt(n_half, bias))));
+		p = Ops::mul(p, Ops::asFloat(Ops::template shiftLeftInt<23>(Ops::addInt(Ops::subInt(n_int, n_half), bias))));
+
+		p = Ops::select(Ops::less(Ops::set1(c_maxInput), p_x), Ops::set1(INFINITY), p);
+		p = Ops::select(Ops::less(p_x, Ops::set1(c_minInput)), Ops::set1(0.0f), p);
+		return Ops::select(Ops::isNan(p_x), p_x, p);
+	}
+
+	template<typename Ops>
+	TSM_INLINE typename Ops::type log(typename Ops::type p_x)
+	{
+		using V = typename Ops::type;
+
+		// Subnormals are scaled into the normal range first
+		const auto subnormal = Ops::less(p_x, Ops::set1(1.17549435e-38f));
+		const V    x         = Ops::select(subnormal, Ops::mul(p_x, Ops::set1(8388608.0f)), p_x);
+
+		// x = m * 2^e, m in [0.5, 1)
+		const auto bits = Ops::asInt(x);
+		V          e    = Ops::toFloat(Ops::subInt(Ops::template shiftRightInt<23>(Ops::andInt(bits, Ops::set1Int(0x7F800000))), Ops::set1Int(126)));
+		V          m    = Ops::asFloat(Ops::andInt(bits, Ops::set1Int(0x007FFFFF)));
+		m               = Ops::bitOr(m, Ops::set1(0.5f));
+		e               = Ops::sub(e, Ops::select(subnormal, Ops::set1(23.0f), Ops::set1(0.0f)));
+
+		// m in [sqrt(0.5), sqrt(2)) around 1, log(1 + f) for f = m - 1
+		const auto small = Ops::less(m, Ops::set1(0.707106781186547524f));
+		e                = Ops::sub(e, Ops::select(small, Ops::set1(1.0f), Ops::set1(0.0f)));
+		const V f        = Ops::sub(Ops::add(m, Ops::select(small, m, Ops::set1(0.0f))), Ops::set1(1.0f));
+
+		const V z = Ops::mul(f, f);
+
+		V p = Ops::madd(Ops::set1(7.0376836292e-2f), f, Ops::set1(-1.1514610310e-1f));
+		p   = Ops::madd(p, f, Ops::set1(1.1676998740e-1f));
+		p   = Ops::madd(p, f, Ops::set1(-1.2420140846e-1f));
+		p   = Ops::madd(p, f, Ops::set1(1.4249322787e-1f));
+		p   = Ops::madd(p, f, Ops::set1(-1.6668057665e-1f));
+		p   = Ops::madd(p, f, Ops::set1(2.0000714765e-1f));
+		p   = Ops::madd(p, f, Ops::set1(-2.4999993993e-1f));
+		p   = Ops::madd(p, f, Ops::set1(3.3333331174e-1f));
+		p   = Ops::mul(Ops::mul(p, f), z);
+
+		// + e * ln2, ln2 in two parts
+		p       = Ops::madd(e, Ops::set1(-2.12194440e-4f), p);
+		p       = Ops::madd(z, Ops::set1(-0.5f), p);
+		V value = Ops::madd(e, Ops::set1(0.693359375f), Ops::add(f, p));
+
+		value = Ops::select(Ops::equal(p_x, Ops::set1(INFINITY)), p_x, value);
+		value = Ops::select(Ops::equal(p_x, Ops::set1(0.0f)), Ops::set1(-INFINITY), value);
+		return Ops::select(Ops::maskOr(Ops::less(p_x, Ops::set1(0.0f)), Ops::isNan(p_x)), Ops::set1(NAN), value);
+	}
+
+	template<typename Ops>
+	TSM_INLINE typename Ops::type pow(typename Ops::type p_base, typename Ops::type p_exponent)
+	{
+		using V = typename Ops::type;
+
+		const V value = exp<Ops>(Ops::mul(p_exponent, log<Ops>(p_base)));
+
+		// 0 * infinity would give NaN for pow(0, 0) and pow(infinity, 0)
+		return Ops::select(Ops::maskOr(Ops::equal(p_exponent, Ops::set1(0.0f)), Ops::equal(p_base, Ops::set1(1.0f))), Ops::set1(1.0f), value);
+	}
+
+	template<typename Ops>
+	TSM_INLINE typename Ops::type atan2(typename Ops::type p_y, typename Ops::type p_x)
+	{
+		using V = typename Ops::type;
+
+		const V abs_x = abs<Ops>(p_x);
+		const V abs_y = abs<Ops>(p_y);
+		const V high  = Ops::max(abs_x, abs_y);
+		const V low   = Ops::min(abs_x, abs_y);
+
+		// atan(low / high) in [0, pi/4]. 0 / 0 and infinity / infinity are the diagonal cases
+		V a = Ops::div(low, high);
+		a   = Ops::select(Ops::equal(high, Ops::set1(0.0f)), Ops::set1(0.0f), a);
+		a   = Ops::select(Ops::equal(low, Ops::set1(INFINITY)), Ops::set1(1.0f), a);
+
+		// Above tan(pi/8) use atan(a) = pi/4 + atan((a - 1) / (a + 1))
+		const auto reduce = Ops::less(Ops::set1(0.414213562373095f), a);
+		const V    t      = Ops::select(reduce, Ops::div(Ops::sub(a, Ops::set1(1.0f)), Ops::add(a, Ops::set1(1.0f))), a);
+		const V    z      = Ops::mul(t, t);
+
+		V p = Ops::madd(Ops::set1(8.05374449538e-2f), z, Ops::set1(-1.38776856032e-1f));
+		p   = Ops::madd(p, z, Ops::set1(1.99777106478e-1f));
+		p   = Ops::madd(p, z, Ops::set1(-3.33329491539e-1f));
+
+		// pi/4, pi/2 and pi are each added as the float constant plus the part it rounded off, the results can be half
+		// the size of the constant and would otherwise carry its rounding error as a whole ulp
+		V angle = Ops::madd(Ops::mul(p, z), t, t);
+		angle   = Ops::add(Ops::add(angle, Ops::select(reduce, Ops::set1(-2.18556941e-8f), Ops::set1(0.0f))), Ops::select(reduce, Ops::set1(0.785398185f), Ops::set1(0.0f)));
+
+		// Back to the full circle, the sign of y is applied last so -0 gives -0 and -pi
+		angle = Ops::select(Ops::less(abs_x, abs_y), Ops::add(Ops::sub(Ops::set1(-4.37113883e-8f), angle), Ops::set1(1.57079637f)), angle);
+		angle = Ops::select(Ops::isNegative(p_x), Ops::add(Ops::sub(Ops::set1(-8.74227766e-8f), angle), Ops::set1(3.14159274f)), angle);
+		angle = Ops::bitXor(angle, Ops::bitAnd(p_y, Ops::set1(-0.0f)));
+
+		return Ops::select(Ops::maskOr(Ops::isNan(p_x), Ops::isNan(p_y)), Ops::add(p_x, p_y), angle);
+	}
+}
+
+namespace tsm
+{
+	// Scalar versions, same results as the batch functions for the same input
+
+	TSM_INLINE void sincos(float p_x, float &p_out_sin, float &p_out_cos) { simd::sincos<simd::ScalarOps>(p_x, p_out_sin, p_out_cos); }
+
+	TSM_INLINE float sin(float p_x) { return simd::sin<simd::ScalarOps>(p_x); }
+	TSM_INLINE float cos(float p_x) { return simd::cos<simd::ScalarOps>(p_x); }
+	TSM_INLINE float exp(float p_x) { return simd::exp<simd::ScalarOps>(p_x); }
+	TSM_INLINE float log(float p_x) { return simd::log<simd::ScalarOps>(p_x); }
+	TSM_INLINE float pow(float p_base, float p_exponent) { return simd::pow<simd::ScalarOps>(p_base, p_exponent); }
+	TSM_INLINE float atan2(float p_y, float p_x) { return simd::atan2<simd::ScalarOps>(p_y, p_x); }
+	TSM_INLINE float rsqrt(float p_x) { return simd::ScalarOps::rsqrt(p_x); }
+
+	// Per component float4 versions
+
+	#if TSM_SIMD_SSE4
+	TSM_INLINE void sincos(const float4 &p_x, float4 &p_out_sin, float4 &p_out_cos)
+	{
+		__m128 s, c;
+		simd::sincos<simd::Sse4Ops>(p_x.getNative(), s, c);
+		p_out_sin = float4(s);
+		p_out_cos = float4(c);
+	}
+
+	TSM_INLINE float4 sin(const float4 &p_x) { return float4(simd::sin<simd::Sse4Ops>(p_x.getNative())); }
+	TSM_INLINE float4 cos(const float4 &p_x) { return float4(simd::cos<simd::Sse4Ops>(p_x.getNative())); }
+	TSM_INLINE float4 exp(const float4 &p_x) { return float4(simd::exp<simd::Sse4Ops>(p_x.getNative())); }
+	TSM_INLINE float4 log(const float4 &p_x) { return float4(simd::log<simd::Sse4Ops>(p_x.getNative())); }
+	TSM_INLINE float4 pow(const float4 &p_base, const float4 &p_exponent) { return float4(simd::pow<simd::Sse4Ops>(p_base.getNative(), p_exponent.getNative())); }
+	TSM_INLINE float4 atan2(const float4 &p_y, const float4 &p_x) { return float4(simd::atan2<simd::Sse4Ops>(p_y.getNative(), p_x.getNative())); }
+	TSM_INLINE float4 rsqrt(const float4 &p_x) { return float4(simd::Sse4Ops::rsqrt(p_x.getNative())); }
+	#else
+	TSM_INLINE void sincos(const float4 &p_x, float4 &p_out_sin, float4 &p_out_cos)
+	{
+		float s[4], c[4];
+		for (int i = 0; i < 4; i++)
+		{
+			sincos(p_x[i], s[i], c[i]);
+		}
+		p_out_sin = float4(s[0], s[1], s[2], s[3]);
+		p_out_cos = float4(c[0], c[1], c[2], c[3]);
+	}
+
+	TSM_INLINE float4 sin(const float4 &p_x) { return {sin(p_x.x()), sin(p_x.y()), sin(p_x.z()), sin(p_x.w())}; }
+	TSM_INLINE float4 cos(const float4 &p_x) { return {cos(p_x.x()), cos(p_x.y()), cos(p_x.z()), cos(p_x.w())}; }
+	TSM_INLINE float4 exp(const float4 &p_x) { return {exp(p_x.x()), exp(p_x.y()), exp(p_x.z()), exp(p_x.w())}; }
+	TSM_INLINE float4 log(const float4 &p_x) { return {log(p_x.x()), log(p_x.y()), log(p_x.z()), log(p_x.w())}; }
+	TSM_INLINE float4 pow(const float4 &p_base, const float4 &p_exponent)
+	{
+		return {pow(p_base.x(), p_exponent.x()), pow(p_base.y(), p_exponent.y()), pow(p_base.z(), p_exponent.z()), pow(p_base.w(), p_exponent.w())};
+	}
+	TSM_INLINE float4 atan2(const float4 &p_y, const float4 &p_x) { return {atan2(p_y.x(), p_x.x()), atan2(p_y.y(), p_x.y()), atan2(p_y.z(), p_x.z()), atan2(p_y.w(), p_x.w())}; }
+	TSM_INLINE float4 rsqrt(const float4 &p_x) { return {rsqrt(p_x.x()), rsqrt(p_x.y()), rsqrt(p_x.z()), rsqrt(p_x.w())}; }
+	#endif
+
+	// Batch versions over arrays, 16 (AVX-512), 8 (AVX2) or 4 (SSE4) elements per iteration. Output may alias input
+	void sin(const float *p_in, uint64 p_count, float *p_out);
+	void cos(const float *p_in, uint64 p_count, float *p_out);
+	void sincos(const float *p_in, uint64 p_count, float *p_out_sin, float *p_out_cos);
+	void exp(const float *p_in, uint64 p_count, float *p_out);
+	void log(const float *p_in, uint64 p_count, float *p_out);
+	void pow(const float *p_base, const float *p_exponent, uint64 p_count, float *p_out);
+	void atan2(const float *p_y, const float *p_x, uint64 p_count, float *p_out);
+	void rsqrt(const float *p_in, uint64 p_count, float *p_out);
+}
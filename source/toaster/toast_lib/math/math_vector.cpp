@@ -1 +0,0 @@
-#include "math_vector.hpp"
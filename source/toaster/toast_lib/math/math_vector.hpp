@@ -4,10 +4,13 @@
 #include <glm/gtx/compatibility.hpp>
 // #include <glm/gtc/type_ptr.hpp>
 
+// float4, float4x4 and quat are SIMD types of their own, everything else is still plain glm
+#include "math_float4.hpp"
+#include "math_matrix.hpp"
+#include "math_quat.hpp"
+
 namespace tsm
 {
-	// TODO:
-
 	typedef bool                          bool1; //!< \brief boolean type with 1 component. (From GLM_GTX_compatibility extension)
 	typedef glm::vec<2, bool, glm::highp> bool2; //!< \brief boolean type with 2 components. (From GLM_GTX_compatibility extension)
 	typedef glm::vec<3, bool, glm::highp> bool3; //!< \brief boolean type with 3 components. (From GLM_GTX_compatibility extension)
@@ -43,7 +46,6 @@ namespace tsm
 	typedef float                          float1; //!< \brief single-qualifier floating-point vector with 1 component. (From GLM_GTX_compatibility extension)
 	typedef glm::vec<2, float, glm::highp> float2; //!< \brief single-qualifier floating-point vector with 2 components. (From GLM_GTX_compatibility extension)
 	typedef glm::vec<3, float, glm::highp> float3; //!< \brief single-qualifier floating-point vector with 3 components. (From GLM_GTX_compatibility extension)
-	typedef glm::vec<4, float, glm::highp> float4; //!< \brief single-qualifier floating-point vector with 4 components. (From GLM_GTX_compatibility extension)
 
 	typedef float                             float1x1; //!< \brief single-qualifier floating-point matrix with 1 component. (From GLM_GTX_compatibility extension)
 	typedef glm::mat<2, 2, float, glm::highp> float2x2; //!< \brief single-qualifier floating-point matrix with 2 x 2 components. (From GLM_GTX_compatibility extension)
@@ -54,7 +56,6 @@ namespace tsm
 	typedef glm::mat<3, 4, float, glm::highp> float3x4; //!< \brief single-qualifier floating-point matrix with 3 x 4 components. (From GLM_GTX_compatibility extension)
 	typedef glm::mat<4, 2, float, glm::highp> float4x2; //!< \brief single-qualifier floating-point matrix with 4 x 2 components. (From GLM_GTX_compatibility extension)
 	typedef glm::mat<4, 3, float, glm::highp> float4x3; //!< \brief single-qualifier floating-point matrix with 4 x 3 components. (From GLM_GTX_compatibility extension)
-	typedef glm::mat<4, 4, float, glm::highp> float4x4; //!< \brief single-qualifier floating-point matrix with 4 x 4 components. (From GLM_GTX_compatibility extension)
 
 	typedef double                          double1; //!< \brief double-qualifier floating-point vector with 1 component. (From GLM_GTX_compatibility extension)
 	typedef glm::vec<2, double, glm::highp> double2; //!< \brief double-qualifier floating-point vector with 2 components. (From GLM_GTX_compatibility extension)
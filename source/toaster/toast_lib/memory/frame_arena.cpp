@@ -0,0 +1,38 @@
+#include "frame_arena.hpp"
+
+#include "toast_assert.h"
+
+namespace toaster::memory
+{
+	FrameArena::FrameArena(const uint32 p_buffer_count, const uint64 p_block_size)
+	{
+		TST_ASSERT_MSG(p_buffer_count > 0u, "A frame arena needs at least one buffer");
+
+		m_arenas.reserve(p_buffer_count);
+		m_resources.reserve(p_buffer_count);
+		for (uint32 i = 0u; i < p_buffer_count; i++)
+		{
+			m_arenas.emplace_back(p_block_size);
+		}
+
+		// Created after all the arenas so the vector never reallocates underneath the resources
+		for (LinearArena &arena: m_arenas)
+		{
+			m_resources.emplace_back(arena);
+		}
+	}
+
+	void FrameArena::beginFrame()
+	{
+		m_bufferIndex = (m_bufferIndex + 1u) % static_cast<uint32>(m_arenas.size());
+		m_arenas[m_bufferIndex].reset();
+	}
+
+	void FrameArena::release()
+	{
+		for (LinearArena &arena: m_arenas)
+		{
+			arena.release();
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "linear_arena.hpp"
+
+namespace toaster::memory
+{
+	// N-buffered linear arena for memory that lives for one frame.
+	// beginFrame() moves on to the next buffer and resets it, so memory handed out in frame F stays valid until
+	// frame F + N begins. With N equal to the number of frames in flight, data referenced by in-flight GPU work
+	// is never overwritten. Only meant to be used from the thread that drives the frame loop
+	class FrameArena
+	{
+	public:
+		FrameArena(uint32 p_buffer_count, uint64 p_block_size = LinearArena::c_defaultBlockSize);
+
+		FrameArena(const FrameArena &)            = delete;
+		FrameArena &operator=(const FrameArena &) = delete;
+
+		void beginFrame();
+		// Frees every buffer's blocks, everything handed out before is gone. For shutdown
+		void release();
+
+		[[nodiscard]] void *allocate(uint64 p_size, uint64 p_alignment = alignof(std::max_align_t))
+		{
+			return m_arenas[m_bufferIndex].allocate(p_size, p_alignment);
+		}
+
+		template<typename T>
+		[[nodiscard]] T *allocateArray(uint64 p_count)
+		{
+			return m_arenas[m_bufferIndex].allocateArray<T>(p_count);
+		}
+
+		[[nodiscard]] LinearArena &              getCurrentArena() { return m_arenas[m_bufferIndex]; }
+		[[nodiscard]] std::pmr::memory_resource *getResource() { return &m_resources[m_bufferIndex]; }
+
+		[[nodiscard]] uint32 getBufferIndex() const { return m_bufferIndex; }
+		[[nodiscard]] uint32 getBufferCount() const { return static_cast<uint32>(m_arenas.size()); }
+
+	private:
+		std::vector<LinearArena>         m_arenas;
+		std::vector<ArenaMemoryResource> m_resources;
+
+		uint32 m_bufferIndex{0u};
+	};
+}
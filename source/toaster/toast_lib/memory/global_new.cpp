@@ -0,0 +1,170 @@
+// Replaces the global operator new / delete with the small object allocator.
+// Only compiled with WITH_TOAST_ALLOCATOR, see small_object_allocator.hpp
+
+#include <cstdlib>
+#include <new>
+
+#include "small_object_allocator.hpp"
+
+namespace
+{
+	void *allocateOrThrow(const std::size_t p_size)
+	{
+		for (;;)
+		{
+			if (void *ptr = toaster::memory::smallAlloc(p_size))
+				return ptr;
+
+			const std::new_handler handler = std::get_new_handler();
+			if (!handler)
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+
+	// Over-aligned types are rare, they go straight to the system allocator
+	void *allocateAligned(const std::size_t p_size, const std::align_val_t p_alignment)
+	{
+		const auto alignment = static_cast<std::size_t>(p_alignment);
+		if (alignment <= toaster::memory::c_smallAllocAlignment)
+			return toaster::memory::smallAlloc(p_size);
+
+		#ifdef _WIN32
+		return _aligned_malloc(p_size ? p_size : 1u, alignment);
+		#else
+		// aligned_alloc wants the size to be a multiple of the alignment
+		return std::aligned_alloc(alignment, (p_size + alignment - 1u) & ~(alignment - 1u));
+		#endif
+	}
+
+	void *allocateAlignedOrThrow(const std::size_t p_size, const std::align_val_t p_alignment)
+	{
+		for (;;)
+		{
+			if (void *ptr = allocateAligned(p_size, p_alignment))
+				return ptr;
+
+			const std::new_handler handler = std::get_new_handler();
+			if (!handler)
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+
+	void freeAligned(void *p_ptr, const std::align_val_t p_alignment) noexcept
+	{
+		if (static_cast<std::size_t>(p_alignment) <= toaster::memory::c_smallAllocAlignment)
+		{
+			toaster::memory::smallFree(p_ptr);
+			return;
+		}
+
+		#ifdef _WIN32
+		_aligned_free(p_ptr);
+		#else
+		std::free(p_ptr);
+		#endif
+	}
+}
+
+void *operator new(std::size_t p_size)
+{
+	return allocateOrThrow(p_size);
+}
+
+void *operator new[](std::size_t p_size)
+{
+	return allocateOrThrow(p_size);
+}
+
+void *operator new(std::size_t p_size, const std::nothrow_t &) noexcept
+{
+	return toaster::memory::smallAlloc(p_size);
+}
+
+void *operator new[](std::size_t p_size, const std::nothrow_t &) noexcept
+{
+	return toaster::memory::smallAlloc(p_size);
+}
+
+void *operator new(std::size_t p_size, std::align_val_t p_alignment)
+{
+	return allocateAlignedOrThrow(p_size, p_alignment);
+}
+
+void *operator new[](std::size_t p_size, std::align_val_t p_alignment)
+{
+	return allocateAlignedOrThrow(p_size, p_alignment);
+}
+
+void *operator new(std::size_t p_size, std::align_val_t p_alignment, const std::nothrow_t &) noexcept
+{
+	return allocateAligned(p_size, p_alignment);
+}
+
+void *operator new[](std::size_t p_size, std::align_val_t p_alignment, const std::nothrow_t &) noexcept
+{
+	return allocateAligned(p_size, p_alignment);
+}
+
+void operator delete(void *p_ptr) noexcept
+{
+	toaster::memory::smallFree(p_ptr);
+}
+
+void operator delete[](void *p_ptr) noexcept
+{
+	toaster::memory::smallFree(p_ptr);
+}
+
+void operator delete(void *p_ptr, std::size_t) noexcept
+{
+	toaster::memory::smallFree(p_ptr);
+}
+
+void operator delete[](void *p_ptr, std::size_t) noexcept
+{
+	toaster::memory::smallFree(p_ptr);
+}
+
+void operator delete(void *p_ptr, const std::nothrow_t &) noexcept
+{
+	toaster::memory::smallFree(p_ptr);
+}
+
+void operator delete[](void *p_ptr, const std::nothrow_t &) noexcept
+{
+	toaster::memory::smallFree(p_ptr);
+}
+
+void operator delete(void *p_ptr, std::align_val_t p_alignment) noexcept
+{
+	freeAligned(p_ptr, p_alignment);
+}
+
+void operator delete[](void *p_ptr, std::align_val_t p_alignment) noexcept
+{
+	freeAligned(p_ptr, p_alignment);
+}
+
+void operator delete(void *p_ptr, std::size_t, std::align_val_t p_alignment) noexcept
+{
+	freeAligned(p_ptr, p_alignment);
+}
+
+void operator delete[](void *p_ptr, std::size_t, std::align_val_t p_alignment) noexcept
+{
+	freeAligned(p_ptr, p_alignment);
+}
+
+void operator delete(void *p_ptr, std::align_val_t p_alignment, const std::nothrow_t &) noexcept
+{
+	freeAligned(p_ptr, p_alignment);
+}
+
+void operator delete[](void *p_ptr, std::align_val_t p_alignment, const std::nothrow_t &) noexcept
+{
+	freeAligned(p_ptr, p_alignment);
+}
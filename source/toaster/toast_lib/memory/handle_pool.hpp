@@ -0,0 +1,184 @@
+#pragma once
+
+#include <functional>
+#include <span>
+#include <utility>
+
+#include "system_types.h"
+#include "toast_assert.h"
+#include "tracked_allocator.hpp"
+
+namespace toaster::memory
+{
+	// Weak reference into a HandlePool. The generation is bumped every time a slot is freed, so handles to
+	// destroyed objects are detected instead of silently aliasing whatever reuses the slot
+	template<typename T>
+	struct Handle
+	{
+		static constexpr uint32 c_invalidIndex{UINT32_MAX};
+
+		uint32 index{c_invalidIndex};
+		uint32 generation{0u};
+
+		[[nodiscard]] bool isValid() const { return index != c_invalidIndex; }
+		explicit           operator bool() const { return isValid(); }
+
+		bool operator==(const Handle &) const = default;
+	};
+
+	// Owns objects of type T in one contiguous array. Creation and destruction are O(1): slots are recycled through
+	// a free list and destroying an object moves the last one into its place, so the live objects are always
+	// densely packed and can be iterated without any pointer chasing or liveness checks.
+	// Pointers returned by get() are invalidated by create() and destroy(), hold on to handles instead
+	template<typename T, EMemoryTag Tag = EMemoryTag::eGeneral>
+	class HandlePool
+	{
+	public:
+		using HandleType = Handle<T>;
+
+		HandlePool() = default;
+
+		HandlePool(const HandlePool &)            = delete;
+		HandlePool &operator=(const HandlePool &) = delete;
+
+		HandlePool(HandlePool &&) noexcept            = default;
+		HandlePool &operator=(HandlePool &&) noexcept = default;
+
+		template<typename... Args>
+		HandleType create(Args &&... p_args)
+		{
+			uint32 slot_index;
+			if (m_freeHead != HandleType::c_invalidIndex)
+			{
+				slot_index = m_freeHead;
+				m_freeHead = m_slots[slot_index].next;
+			}
+			else
+			{
+				slot_index = static_cast<uint32>(m_slots.size());
+				m_slots.push_back(Slot{});
+			}
+
+			Slot &slot = m_slots[slot_index];
+			slot.next  = static_cast<uint32>(m_dense.size());
+
+			m_dense.emplace_back(std::forward<Args>(p_args)...);
+			m_denseToSlot.push_back(slot_index);
+
+			return HandleType{slot_index, slot.generation};
+		}
+
+		// Destroying a stale or invalid handle is a no-op
+		void destroy(HandleType p_handle)
+		{
+			if (!isAlive(p_handle))
+				return;
+
+			Slot &       slot        = m_slots[p_handle.index];
+			const uint32 dense_index = slot.next;
+			const uint32 last_index  = static_cast<uint32>(m_dense.size() - 1u);
+
+			if (dense_index != last_index)
+			{
+				// Swapped rather than move-assigned, so the destroyed object's destructor is what runs in pop_back()
+				using std::swap;
+				swap(m_dense[dense_index], m_dense[last_index]);
+				m_denseToSlot[dense_index] = m_denseToSlot[last_index];
+
+				m_slots[m_denseToSlot[dense_index]].next = dense_index;
+			}
+			m_dense.pop_back();
+			m_denseToSlot.pop_back();
+
+			slot.generation++;
+			slot.next  = m_freeHead;
+			m_freeHead = p_handle.index;
+		}
+
+		[[nodiscard]] bool isAlive(HandleType p_handle) const
+		{
+			return p_handle.index < m_slots.size() && m_slots[p_handle.index].generation == p_handle.generation;
+		}
+
+		// Returns nullptr for stale handles
+		[[nodiscard]] T *get(HandleType p_handle)
+		{
+			return isAlive(p_handle) ? &m_dense[m_slots[p_handle.index].next] : nullptr;
+		}
+
+		[[nodiscard]] const T *get(HandleType p_handle) const
+		{
+			return isAlive(p_handle) ? &m_dense[m_slots[p_handle.index].next] : nullptr;
+		}
+
+		// Same as get(), but a stale handle is a programming error
+		[[nodiscard]] T &operator[](HandleType p_handle)
+		{
+			TST_ASSERT_MSG(isAlive(p_handle), "Stale or invalid handle");
+			return m_dense[m_slots[p_handle.index].next];
+		}
+
+		[[nodiscard]] const T &operator[](HandleType p_handle) const
+		{
+			TST_ASSERT_MSG(isAlive(p_handle), "Stale or invalid handle");
+			return m_dense[m_slots[p_handle.index].next];
+		}
+
+		// The handle of the object at p_dense_index in getObjects()
+		[[nodiscard]] HandleType getHandle(uint32 p_dense_index) const
+		{
+			const uint32 slot_index = m_denseToSlot[p_dense_index];
+			return HandleType{slot_index, m_slots[slot_index].generation};
+		}
+
+		[[nodiscard]] std::span<T>       getObjects() { return m_dense; }
+		[[nodiscard]] std::span<const T> getObjects() const { return m_dense; }
+
+		auto begin() { return m_dense.begin(); }
+		auto end() { return m_dense.end(); }
+		auto begin() const { return m_dense.begin(); }
+		auto end() const { return m_dense.end(); }
+
+		[[nodiscard]] uint32 size() const { return static_cast<uint32>(m_dense.size()); }
+		[[nodiscard]] bool   empty() const { return m_dense.empty(); }
+
+		void reserve(uint32 p_capacity)
+		{
+			m_dense.reserve(p_capacity);
+			m_denseToSlot.reserve(p_capacity);
+			m_slots.reserve(p_capacity);
+		}
+
+		// Destroys every object, all outstanding handles become stale
+		void clear()
+		{
+			while (!m_dense.empty())
+			{
+				destroy(getHandle(static_cast<uint32>(m_dense.size() - 1u)));
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			// Index into m_dense while the slot is alive, the next free slot while it is on the free list
+			uint32 next{HandleType::c_invalidIndex};
+			uint32 generation{1u};
+		};
+
+		TrackedVector<T, Tag>      m_dense;
+		TrackedVector<uint32, Tag> m_denseToSlot;
+		TrackedVector<Slot, Tag>   m_slots;
+
+		uint32 m_freeHead{HandleType::c_invalidIndex};
+	};
+}
+
+template<typename T>
+struct std::hash<toaster::memory::Handle<T>>
+{
+	std::size_t operator()(const toaster::memory::Handle<T> &p_handle) const noexcept
+	{
+		return std::hash<uint64>{}(static_cast<uint64>(p_handle.generation) << 32u | p_handle.index);
+	}
+};
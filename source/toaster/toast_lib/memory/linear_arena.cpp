@@ -0,0 +1,133 @@
+#include "linear_arena.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "toast_assert.h"
+
+namespace toaster::memory
+{
+	static constexpr uint64 c_blockAlignment{64u};
+
+	LinearArena::LinearArena(const uint64 p_block_size, const EMemoryTag p_tag) : m_blockSize(p_block_size), m_tag(p_tag)
+	{
+	}
+
+	LinearArena::~LinearArena()
+	{
+		_freeBlocks();
+	}
+
+	LinearArena::LinearArena(LinearArena &&p_other) noexcept
+		: m_blocks(std::move(p_other.m_blocks)), m_currentBlock(std::exchange(p_other.m_currentBlock, 0u)), m_offset(std::exchange(p_other.m_offset, 0u)),
+		  m_blockSize(p_other.m_blockSize), m_tag(p_other.m_tag)
+	{
+		p_other.m_blocks.clear();
+	}
+
+	LinearArena &LinearArena::operator=(LinearArena &&p_other) noexcept
+	{
+		if (this != &p_other)
+		{
+			_freeBlocks();
+
+			m_blocks       = std::move(p_other.m_blocks);
+			m_currentBlock = std::exchange(p_other.m_currentBlock, 0u);
+			m_offset       = std::exchange(p_other.m_offset, 0u);
+			m_blockSize    = p_other.m_blockSize;
+			m_tag          = p_other.m_tag;
+
+			p_other.m_blocks.clear();
+		}
+		return *this;
+	}
+
+	void LinearArena::rewind(const Marker &p_marker)
+	{
+		TST_ASSERT_MSG(p_marker.blockIndex < m_blocks.size() || (m_blocks.empty() && p_marker.blockIndex == 0u), "Arena marker does not belong to this arena");
+		TST_ASSERT_MSG(p_marker.blockIndex < m_currentBlock || (p_marker.blockIndex == m_currentBlock && p_marker.offset <= m_offset),
+					   "Arena rewound to a marker ahead of the current position");
+
+		m_currentBlock = p_marker.blockIndex;
+		m_offset       = p_marker.offset;
+	}
+
+	void LinearArena::reset()
+	{
+		if (m_blocks.size() > 1u)
+		{
+			const uint64 total_size = getCapacity();
+			_freeBlocks();
+
+			Block block{};
+			block.size = total_size;
+			block.data = static_cast<uint8 *>(trackedAlloc(total_size, c_blockAlignment, m_tag));
+			m_blocks.push_back(block);
+		}
+
+		m_currentBlock = 0u;
+		m_offset       = 0u;
+	}
+
+	void LinearArena::release()
+	{
+		_freeBlocks();
+	}
+
+	uint64 LinearArena::getUsedBytes() const
+	{
+		uint64 used = m_offset;
+		for (uint32 i = 0u; i < m_currentBlock; i++)
+		{
+			used += m_blocks[i].size;
+		}
+		return used;
+	}
+
+	uint64 LinearArena::getCapacity() const
+	{
+		uint64 capacity = 0u;
+		for (const Block &block: m_blocks)
+		{
+			capacity += block.size;
+		}
+		return capacity;
+	}
+
+	void *LinearArena::_allocateSlow(const uint64 p_size, const uint64 p_alignment)
+	{
+		// Blocks after the current one are left over from before a rewind, reuse the first one that fits
+		for (uint32 i = m_blocks.empty() ? 0u : m_currentBlock + 1u; i < m_blocks.size(); i++)
+		{
+			if (p_size <= m_blocks[i].size && p_alignment <= c_blockAlignment)
+			{
+				m_currentBlock = i;
+				m_offset       = p_size;
+				return m_blocks[i].data;
+			}
+		}
+
+		Block block{};
+		block.size = std::max(m_blockSize, p_size + p_alignment);
+		block.data = static_cast<uint8 *>(trackedAlloc(block.size, c_blockAlignment, m_tag));
+		m_blocks.push_back(block);
+
+		m_currentBlock = static_cast<uint32>(m_blocks.size() - 1u);
+		m_offset       = 0u;
+
+		void *ptr = allocate(p_size, p_alignment);
+		TST_ASSERT(ptr != nullptr);
+		return ptr;
+	}
+
+	void LinearArena::_freeBlocks()
+	{
+		for (const Block &block: m_blocks)
+		{
+			trackedFree(block.data, block.size, c_blockAlignment, m_tag);
+		}
+		m_blocks.clear();
+		m_currentBlock = 0u;
+		m_offset       = 0u;
+	}
+}
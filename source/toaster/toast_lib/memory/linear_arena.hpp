@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "system_types.h"
+#include "memory_tracker.hpp"
+
+namespace toaster::memory
+{
+	// Bump allocator over a list of blocks. Individual allocations are never freed, instead the arena is rewound to a
+	// marker or reset as a whole. Not thread safe, every thread should use its own arena (see scratch_arena.hpp)
+	class LinearArena
+	{
+	public:
+		static constexpr uint64 c_defaultBlockSize{64u * 1024u};
+
+		// Position in the arena that can be rewound to
+		struct Marker
+		{
+			uint32 blockIndex{0u};
+			uint64 offset{0u};
+		};
+
+		explicit LinearArena(uint64 p_block_size = c_defaultBlockSize, EMemoryTag p_tag = EMemoryTag::eArena);
+		~LinearArena();
+
+		LinearArena(const LinearArena &)            = delete;
+		LinearArena &operator=(const LinearArena &) = delete;
+
+		LinearArena(LinearArena &&p_other) noexcept;
+		LinearArena &operator=(LinearArena &&p_other) noexcept;
+
+		[[nodiscard]] void *allocate(uint64 p_size, uint64 p_alignment = alignof(std::max_align_t))
+		{
+			if (!m_blocks.empty())
+			{
+				const Block &   block   = m_blocks[m_currentBlock];
+				const uintptr_t base    = reinterpret_cast<uintptr_t>(block.data);
+				const uintptr_t aligned = (base + m_offset + p_alignment - 1u) & ~(p_alignment - 1u);
+				const uint64    end     = aligned - base + p_size;
+				if (end <= block.size)
+				{
+					m_offset = end;
+					return reinterpret_cast<void *>(aligned);
+				}
+			}
+			return _allocateSlow(p_size, p_alignment);
+		}
+
+		// Uninitialized storage for p_count objects of type T
+		template<typename T>
+		[[nodiscard]] T *allocateArray(uint64 p_count)
+		{
+			return static_cast<T *>(allocate(sizeof(T) * p_count, alignof(T)));
+		}
+
+		[[nodiscard]] Marker getMarker() const { return {m_currentBlock, m_offset}; }
+
+		// Frees everything allocated after the marker was taken
+		void rewind(const Marker &p_marker);
+
+		// Frees everything. If the arena had to grow past its first block, the blocks are merged into a single one
+		// large enough for the peak usage, so the steady state never chains blocks
+		void reset();
+		// Frees everything, the blocks included. For arenas that live past the point leaks are reported at
+		void release();
+
+		[[nodiscard]] uint64 getUsedBytes() const;
+		[[nodiscard]] uint64 getCapacity() const;
+
+	private:
+		struct Block
+		{
+			uint8 *data{nullptr};
+			uint64 size{0u};
+		};
+
+		void *_allocateSlow(uint64 p_size, uint64 p_alignment);
+		void  _freeBlocks();
+
+		std::vector<Block> m_blocks;
+		uint32             m_currentBlock{0u};
+		uint64             m_offset{0u};
+
+		uint64     m_blockSize{c_defaultBlockSize};
+		EMemoryTag m_tag{EMemoryTag::eArena};
+	};
+
+	// Lets std::pmr containers allocate from an arena. Deallocation is a no-op, the memory comes back when the
+	// arena is rewound or reset, so containers using it must not outlive that point
+	class ArenaMemoryResource : public std::pmr::memory_resource
+	{
+	public:
+		explicit ArenaMemoryResource(LinearArena &p_arena) : m_arena(&p_arena)
+		{
+		}
+
+		[[nodiscard]] LinearArena &getArena() const { return *m_arena; }
+
+	private:
+		void *do_allocate(std::size_t p_bytes, std::size_t p_alignment) override
+		{
+			return m_arena->allocate(p_bytes, p_alignment);
+		}
+
+		void do_deallocate(void *, std::size_t, std::size_t) override
+		{
+		}
+
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &p_other) const noexcept override
+		{
+			return this == &p_other;
+		}
+
+		LinearArena *m_arena{nullptr};
+	};
+}
@@ -0,0 +1,237 @@
+#include "memory_tracker.hpp"
+
+#include <array>
+#include <atomic>
+#include <new>
+
+#if TST_MEMORY_TRACK_CALLSTACKS
+#include <mutex>
+#include <stacktrace>
+#include <unordered_map>
+#include <vector>
+#endif
+
+#include "logging.hpp"
+
+namespace toaster::memory
+{
+	namespace
+	{
+		// Each tag gets its own cache line so subsystems allocating on different threads don't contend
+		struct alignas(64) TagCounters
+		{
+			std::atomic<uint64> currentBytes{0u};
+			std::atomic<uint64> peakBytes{0u};
+			std::atomic<uint64> allocationCount{0u};
+			std::atomic<uint64> liveAllocations{0u};
+			std::atomic<uint64> budgetBytes{0u};
+			std::atomic<uint64> budgetWarnings{0u};
+			std::atomic<bool>   budgetExceeded{false};
+		};
+
+		std::array<TagCounters, static_cast<uint64>(EMemoryTag::eCount)> s_counters{};
+
+		TagCounters &countersFor(EMemoryTag p_tag)
+		{
+			return s_counters[static_cast<uint64>(p_tag)];
+		}
+
+		#if TST_MEMORY_TRACK_CALLSTACKS
+		struct AllocationRecord
+		{
+			uint64          size{0u};
+			EMemoryTag      tag{EMemoryTag::eGeneral};
+			std::stacktrace callstack;
+		};
+
+		// Heap allocated and never freed so the records outlive any static destructors that free tracked memory
+		std::mutex &recordMutex()
+		{
+			static auto *s_mutex = new std::mutex();
+			return *s_mutex;
+		}
+
+		std::unordered_map<void *, AllocationRecord> &liveRecords()
+		{
+			static auto *s_records = new std::unordered_map<void *, AllocationRecord>();
+			return *s_records;
+		}
+		#endif
+
+		void onAllocated(void *p_ptr, uint64 p_size, EMemoryTag p_tag)
+		{
+			TagCounters &counters = countersFor(p_tag);
+
+			const uint64 current = counters.currentBytes.fetch_add(p_size, std::memory_order_relaxed) + p_size;
+			counters.allocationCount.fetch_add(1u, std::memory_order_relaxed);
+			counters.liveAllocations.fetch_add(1u, std::memory_order_relaxed);
+
+			uint64 peak = counters.peakBytes.load(std::memory_order_relaxed);
+			while (current > peak && !counters.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+			{
+			}
+
+			#if TST_MEMORY_TRACK_CALLSTACKS
+			{
+				std::lock_guard lock(recordMutex());
+				liveRecords()[p_ptr] = AllocationRecord{p_size, p_tag, std::stacktrace::current(2)};
+			}
+			#else
+			(void)p_ptr;
+			#endif
+
+			const uint64 budget = counters.budgetBytes.load(std::memory_order_relaxed);
+			if (budget != 0u && current > budget)
+			{
+				// The flag is raised before logging, since logging allocates and may come straight back in here
+				if (!counters.budgetExceeded.exchange(true, std::memory_order_relaxed))
+				{
+					counters.budgetWarnings.fetch_add(1u, std::memory_order_relaxed);
+					LOG_WARN("Memory budget exceeded for [{}]: {} / {} bytes", memoryTagToString(p_tag), current, budget);
+				}
+			}
+		}
+
+		void onFreed(void *p_ptr, uint64 p_size, EMemoryTag p_tag)
+		{
+			TagCounters &counters = countersFor(p_tag);
+
+			const uint64 current = counters.currentBytes.fetch_sub(p_size, std::memory_order_relaxed) - p_size;
+			counters.liveAllocations.fetch_sub(1u, std::memory_order_relaxed);
+
+			#if TST_MEMORY_TRACK_CALLSTACKS
+			{
+				std::lock_guard lock(recordMutex());
+				liveRecords().erase(p_ptr);
+			}
+			#else
+			(void)p_ptr;
+			#endif
+
+			if (current <= counters.budgetBytes.load(std::memory_order_relaxed))
+			{
+				counters.budgetExceeded.store(false, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	const char *memoryTagToString(const EMemoryTag p_tag)
+	{
+		switch (p_tag)
+		{
+			case EMemoryTag::eGeneral: return "General";
+			case EMemoryTag::eMesh: return "Mesh";
+			case EMemoryTag::eShader: return "Shader";
+			case EMemoryTag::eTexture: return "Texture";
+			case EMemoryTag::eLogging: return "Logging";
+			case EMemoryTag::eArena: return "Arena";
+			case EMemoryTag::ePermanent: return "Permanent";
+			case EMemoryTag::eCount: break;
+		}
+		return "Unknown";
+	}
+
+	void *trackedAlloc(const uint64 p_size, const uint64 p_alignment, const EMemoryTag p_tag)
+	{
+		void *ptr = p_alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+						? ::operator new(p_size, static_cast<std::align_val_t>(p_alignment))
+						: ::operator new(p_size);
+
+		onAllocated(ptr, p_size, p_tag);
+		return ptr;
+	}
+
+	void trackedFree(void *p_ptr, const uint64 p_size, const uint64 p_alignment, const EMemoryTag p_tag) noexcept
+	{
+		if (!p_ptr)
+			return;
+
+		onFreed(p_ptr, p_size, p_tag);
+
+		if (p_alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		{
+			::operator delete(p_ptr, static_cast<std::align_val_t>(p_alignment));
+		}
+		else
+		{
+			::operator delete(p_ptr);
+		}
+	}
+
+	void recordAllocation(void *p_ptr, const uint64 p_size, const EMemoryTag p_tag)
+	{
+		if (p_ptr)
+			onAllocated(p_ptr, p_size, p_tag);
+	}
+
+	void recordFree(void *p_ptr, const uint64 p_size, const EMemoryTag p_tag) noexcept
+	{
+		if (p_ptr)
+			onFreed(p_ptr, p_size, p_tag);
+	}
+
+	void setBudget(const EMemoryTag p_tag, const uint64 p_budget_bytes)
+	{
+		TagCounters &counters = countersFor(p_tag);
+		counters.budgetBytes.store(p_budget_bytes, std::memory_order_relaxed);
+		counters.budgetExceeded.store(false, std::memory_order_relaxed);
+	}
+
+	MemoryTagStats getStats(const EMemoryTag p_tag)
+	{
+		const TagCounters &counters = countersFor(p_tag);
+
+		MemoryTagStats stats{};
+		stats.currentBytes    = counters.currentBytes.load(std::memory_order_relaxed);
+		stats.peakBytes       = counters.peakBytes.load(std::memory_order_relaxed);
+		stats.allocationCount = counters.allocationCount.load(std::memory_order_relaxed);
+		stats.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+		stats.budgetBytes     = counters.budgetBytes.load(std::memory_order_relaxed);
+		stats.budgetWarnings  = counters.budgetWarnings.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void logMemoryReport()
+	{
+		LOG_INFO("Memory report:\n[");
+		for (uint64 i = 0u; i < static_cast<uint64>(EMemoryTag::eCount); i++)
+		{
+			const auto           tag   = static_cast<EMemoryTag>(i);
+			const MemoryTagStats stats = getStats(tag);
+
+			LOG_INFO("\t{:<10} current: {:>12} peak: {:>12} allocations: {:>10} budget: {}", memoryTagToString(tag), stats.currentBytes, stats.peakBytes,
+					 stats.allocationCount, stats.budgetBytes != 0u ? fmt::format("{}, exceeded {}x", stats.budgetBytes, stats.budgetWarnings) : std::string("none"));
+		}
+		LOG_INFO("]\n");
+	}
+
+	void reportLeaks()
+	{
+		for (uint64 i = 0u; i < static_cast<uint64>(EMemoryTag::eCount); i++)
+		{
+			const auto           tag   = static_cast<EMemoryTag>(i);
+			const MemoryTagStats stats = getStats(tag);
+
+			if (stats.liveAllocations != 0u && tag != EMemoryTag::ePermanent)
+			{
+				LOG_ERROR("[{}] leaked {} allocation(s), {} bytes", memoryTagToString(tag), stats.liveAllocations, stats.currentBytes);
+			}
+		}
+
+		#if TST_MEMORY_TRACK_CALLSTACKS
+		// Copied out first, logging allocates and would otherwise re-enter the record lock
+		std::vector<std::pair<void *, AllocationRecord>> leaks;
+		{
+			std::lock_guard lock(recordMutex());
+			leaks.assign(liveRecords().begin(), liveRecords().end());
+		}
+
+		for (const auto &[ptr, record]: leaks)
+		{
+			if (record.tag == EMemoryTag::ePermanent)
+				continue;
+			LOG_ERROR("Leaked {} bytes [{}] at {}:\n{}", record.size, memoryTagToString(record.tag), fmt::ptr(ptr), std::to_string(record.callstack));
+		}
+		#endif
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "system_types.h"
+
+// Define TST_MEMORY_TRACK_CALLSTACKS=1 (WITH_MEMORY_CALLSTACKS in CMake) to record a call stack for every live
+// tracked allocation, so reportLeaks() can show where leaked memory came from. This is slow, debugging only.
+#ifndef TST_MEMORY_TRACK_CALLSTACKS
+#define TST_MEMORY_TRACK_CALLSTACKS 0
+#endif
+
+namespace toaster::memory
+{
+	// Every tracked allocation is attributed to exactly one of these subsystems
+	enum class EMemoryTag : uint8
+	{
+		eGeneral,
+		eMesh,
+		eShader,
+		eTexture,
+		eLogging,
+		eArena,
+		ePermanent, // Kept until the process exits by design, such as the string interner. Not reported as leaks
+
+		eCount
+	};
+
+	struct MemoryTagStats
+	{
+		uint64 currentBytes{0u};
+		uint64 peakBytes{0u};
+		uint64 allocationCount{0u}; // Total number of allocations made over the lifetime of the program
+		uint64 liveAllocations{0u};
+		uint64 budgetBytes{0u};    // 0 means no budget
+		uint64 budgetWarnings{0u}; // How often the budget warning was logged, see setBudget()
+	};
+
+	const char *memoryTagToString(EMemoryTag p_tag);
+
+	// Allocates / frees memory and records it against the given tag.
+	// p_size and p_alignment passed to trackedFree must match the ones passed to trackedAlloc
+	[[nodiscard]] void *trackedAlloc(uint64 p_size, uint64 p_alignment, EMemoryTag p_tag);
+	void                trackedFree(void *p_ptr, uint64 p_size, uint64 p_alignment, EMemoryTag p_tag) noexcept;
+
+	// For memory that is allocated elsewhere (e.g. by a third party library) but should still be accounted for
+	void recordAllocation(void *p_ptr, uint64 p_size, EMemoryTag p_tag);
+	void recordFree(void *p_ptr, uint64 p_size, EMemoryTag p_tag) noexcept;
+
+	// A warning is logged the first time the tag's current usage goes above the budget.
+	// It is re-armed once usage falls back below the budget. A budget of 0 disables the check
+	void setBudget(EMemoryTag p_tag, uint64 p_budget_bytes);
+
+	[[nodiscard]] MemoryTagStats getStats(EMemoryTag p_tag);
+
+	// Prints current / peak / count for every tag
+	void logMemoryReport();
+
+	// Prints every allocation that is still alive, except for ePermanent ones. Meant for shutdown, once everything
+	// that owns tracked memory is gone. Call stacks are only available with TST_MEMORY_TRACK_CALLSTACKS
+	void reportLeaks();
+}
@@ -0,0 +1,12 @@
+#include "scratch_arena.hpp"
+
+namespace toaster::memory
+{
+	static constexpr uint64 c_scratchBlockSize{256u * 1024u};
+
+	LinearArena &getThreadScratchArena()
+	{
+		thread_local LinearArena s_scratchArena{c_scratchBlockSize};
+		return s_scratchArena;
+	}
+}
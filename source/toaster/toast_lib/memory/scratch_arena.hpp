@@ -0,0 +1,48 @@
+#pragma once
+
+#include "linear_arena.hpp"
+
+namespace toaster::memory
+{
+	// The calling thread's scratch arena, created on first use
+	LinearArena &getThreadScratchArena();
+
+	// Temporary allocations on the calling thread's scratch arena. Everything allocated through the scope
+	// is released when it is destroyed, so scopes can nest freely:
+	//	ScratchScope scratch;
+	//	std::pmr::vector<const char *> names{scratch.getResource()};
+	class ScratchScope
+	{
+	public:
+		ScratchScope() : m_arena(getThreadScratchArena()), m_marker(m_arena.getMarker()), m_resource(m_arena)
+		{
+		}
+
+		~ScratchScope()
+		{
+			m_arena.rewind(m_marker);
+		}
+
+		ScratchScope(const ScratchScope &)            = delete;
+		ScratchScope &operator=(const ScratchScope &) = delete;
+
+		[[nodiscard]] void *allocate(uint64 p_size, uint64 p_alignment = alignof(std::max_align_t))
+		{
+			return m_arena.allocate(p_size, p_alignment);
+		}
+
+		template<typename T>
+		[[nodiscard]] T *allocateArray(uint64 p_count)
+		{
+			return m_arena.allocateArray<T>(p_count);
+		}
+
+		[[nodiscard]] LinearArena &              getArena() const { return m_arena; }
+		[[nodiscard]] std::pmr::memory_resource *getResource() { return &m_resource; }
+
+	private:
+		LinearArena &       m_arena;
+		LinearArena::Marker m_marker;
+		ArenaMemoryResource m_resource;
+	};
+}
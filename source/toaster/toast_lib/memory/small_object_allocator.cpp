@@ -0,0 +1,770 @@
+#include "small_object_allocator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "logging.hpp"
+
+namespace toaster::memory
+{
+	namespace
+	{
+		constexpr uint64 c_pageSize{64u * 1024u};
+		constexpr uint64 c_pageHeaderSize{128u};
+		// Address space only, pages are committed in batches as they are needed
+		constexpr uint64 c_regionSize{16ull * 1024u * 1024u * 1024u};
+		constexpr uint64 c_commitBatchPages{16u};
+		// Blocks carved out of a page's untouched tail in one go
+		constexpr uint32 c_refillBatch{64u};
+		// Full pages checked for remote frees before a new page is taken
+		constexpr uint32 c_fullPageScanLimit{32u};
+
+		// 16 byte steps up to 128, then four classes per power of two
+		constexpr std::array<uint32, 24> c_sizeClasses{
+			16u, 32u, 48u, 64u, 80u, 96u, 112u, 128u,
+			160u, 192u, 224u, 256u,
+			320u, 384u, 448u, 512u,
+			640u, 768u, 896u, 1024u,
+			1280u, 1536u, 1792u, 2048u,
+		};
+		constexpr uint32 c_sizeClassCount = static_cast<uint32>(c_sizeClasses.size());
+
+		static_assert(c_sizeClasses.back() == c_smallAllocMaxSize);
+
+		// Indexed by (size + 15) / 16
+		constexpr auto c_sizeClassLookup = []
+		{
+			std::array<uint8, c_smallAllocMaxSize / 16u + 1u> table{};
+
+			uint32 size_class = 0u;
+			for (uint32 i = 0u; i < table.size(); i++)
+			{
+				while (c_sizeClasses[size_class] < i * 16u)
+				{
+					size_class++;
+				}
+				table[i] = static_cast<uint8>(size_class);
+			}
+			return table;
+		}();
+
+		// Only guards the slow paths (page hand out, heap creation, abandoned pages), which are rare and short
+		class SpinLock
+		{
+		public:
+			void lock()
+			{
+				while (m_locked.exchange(true, std::memory_order_acquire))
+				{
+					while (m_locked.load(std::memory_order_relaxed))
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+
+			void unlock() { m_locked.store(false, std::memory_order_release); }
+
+		private:
+			std::atomic<bool> m_locked{false};
+		};
+
+		struct FreeBlock
+		{
+			FreeBlock *next;
+		};
+
+		struct ThreadHeap;
+
+		// Lives in the first c_pageHeaderSize bytes of every page
+		struct PageHeader
+		{
+			// Only touched by the owning thread
+			FreeBlock * localFree{nullptr};
+			PageHeader *prev{nullptr};
+			PageHeader *next{nullptr};
+
+			uint32 sizeClass{0u};
+			uint32 blockSize{0u};
+			uint32 capacity{0u};
+			uint32 carved{0u}; // Blocks handed out of the untouched tail so far
+			uint32 used{0u};
+			bool   inFullList{false};
+
+			std::atomic<ThreadHeap *> owner{nullptr};
+
+			// Pushed to by any thread, on its own cache line so remote frees don't keep stealing the owner's fields
+			alignas(64) std::atomic<FreeBlock *> remoteFree{nullptr};
+		};
+
+		static_assert(sizeof(PageHeader) <= c_pageHeaderSize);
+
+		struct PageList
+		{
+			PageHeader *head{nullptr};
+			PageHeader *tail{nullptr};
+
+			void pushFront(PageHeader *p_page)
+			{
+				p_page->prev = nullptr;
+				p_page->next = head;
+				if (head)
+					head->prev = p_page;
+				else
+					tail = p_page;
+				head = p_page;
+			}
+
+			void pushBack(PageHeader *p_page)
+			{
+				p_page->next = nullptr;
+				p_page->prev = tail;
+				if (tail)
+					tail->next = p_page;
+				else
+					head = p_page;
+				tail = p_page;
+			}
+
+			void remove(PageHeader *p_page)
+			{
+				if (p_page->prev)
+					p_page->prev->next = p_page->next;
+				else
+					head = p_page->next;
+
+				if (p_page->next)
+					p_page->next->prev = p_page->prev;
+				else
+					tail = p_page->prev;
+
+				p_page->prev = nullptr;
+				p_page->next = nullptr;
+			}
+		};
+
+		struct ThreadHeap
+		{
+			// Allocations come from the head page, pages further down still have free blocks
+			std::array<PageList, c_sizeClassCount> available{};
+			// Pages with no free blocks left the last time they were looked at
+			std::array<PageList, c_sizeClassCount> full{};
+
+			// Plain counters, flushed into the global stats on the slow path
+			uint64 allocations{0u};
+			uint64 frees{0u};
+
+			ThreadHeap *nextFree{nullptr};
+
+			void *allocateSlow(uint32 p_size_class);
+			void  freeLocal(PageHeader *p_page, FreeBlock *p_block);
+			// Collects remote frees on every page and releases the ones that became empty
+			void  trim();
+			void  flushStats();
+			void  abandon();
+		};
+
+		struct GlobalState
+		{
+			std::atomic<uintptr_t> regionBegin{0u};
+			std::atomic<uintptr_t> regionEnd{0u};
+
+			SpinLock    pageLock;
+			char *      nextPage{nullptr};
+			char *      committedEnd{nullptr};
+			PageHeader *freePages{nullptr};
+			bool        reserveFailed{false};
+
+			SpinLock                                 abandonedLock;
+			std::array<PageHeader *, c_sizeClassCount> abandoned{};
+
+			SpinLock    heapLock;
+			ThreadHeap *freeHeaps{nullptr};
+			char *      heapStorage{nullptr};
+			char *      heapStorageEnd{nullptr};
+
+			std::atomic<uint64> committedBytes{0u};
+			std::atomic<uint64> pagesInUse{0u};
+			std::atomic<uint64> abandonedPages{0u};
+			std::atomic<uint64> liveThreadHeaps{0u};
+			std::atomic<uint64> allocations{0u};
+			std::atomic<uint64> frees{0u};
+			std::atomic<uint64> remoteFrees{0u};
+			std::atomic<uint64> largeAllocations{0u};
+		};
+
+		// constinit, operator new can be called before any dynamic initialisation has run
+		constinit GlobalState s_state{};
+
+		// Stand-ins with no pages, so the allocation fast path never has to check for a missing heap.
+		// Threads start out on s_initialHeap and get a real heap on their first slow path; s_deadHeap is for
+		// threads that have already released theirs (thread_local destructors running after ours)
+		constinit ThreadHeap s_initialHeap{};
+		constinit ThreadHeap s_deadHeap{};
+
+		constinit thread_local ThreadHeap *tl_heap = &s_initialHeap;
+
+		// ---- Virtual memory ------------------------------------------------------------------------------------
+
+		char *reserveAddressSpace(uint64 p_size)
+		{
+			#ifdef _WIN32
+			// Reservations are aligned to the 64KB allocation granularity already
+			return static_cast<char *>(VirtualAlloc(nullptr, p_size, MEM_RESERVE, PAGE_NOACCESS));
+			#else
+			void *ptr = mmap(nullptr, p_size + c_pageSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (ptr == MAP_FAILED)
+				return nullptr;
+
+			const uintptr_t aligned = (reinterpret_cast<uintptr_t>(ptr) + c_pageSize - 1u) & ~(c_pageSize - 1u);
+			return reinterpret_cast<char *>(aligned);
+			#endif
+		}
+
+		bool commitMemory(char *p_begin, uint64 p_size)
+		{
+			#ifdef _WIN32
+			return VirtualAlloc(p_begin, p_size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+			#else
+			return mprotect(p_begin, p_size, PROT_READ | PROT_WRITE) == 0;
+			#endif
+		}
+
+		// ---- Pages ---------------------------------------------------------------------------------------------
+
+		bool isInRegion(const void *p_ptr)
+		{
+			const auto address = reinterpret_cast<uintptr_t>(p_ptr);
+			return address >= s_state.regionBegin.load(std::memory_order_relaxed) && address < s_state.regionEnd.load(std::memory_order_relaxed);
+		}
+
+		PageHeader *pageOf(const void *p_ptr)
+		{
+			return reinterpret_cast<PageHeader *>(reinterpret_cast<uintptr_t>(p_ptr) & ~(c_pageSize - 1u));
+		}
+
+		// Must be called with pageLock held
+		char *acquireRawPage()
+		{
+			if (s_state.freePages)
+			{
+				PageHeader *page   = s_state.freePages;
+				s_state.freePages = page->next;
+				return reinterpret_cast<char *>(page);
+			}
+
+			if (!s_state.nextPage)
+			{
+				if (s_state.reserveFailed)
+					return nullptr;
+
+				char *region = reserveAddressSpace(c_regionSize);
+				if (!region)
+				{
+					s_state.reserveFailed = true;
+					return nullptr;
+				}
+
+				s_state.nextPage     = region;
+				s_state.committedEnd = region;
+				s_state.regionBegin.store(reinterpret_cast<uintptr_t>(region), std::memory_order_relaxed);
+				s_state.regionEnd.store(reinterpret_cast<uintptr_t>(region + c_regionSize), std::memory_order_relaxed);
+			}
+
+			if (s_state.nextPage == s_state.committedEnd)
+			{
+				const auto   region_end  = reinterpret_cast<char *>(s_state.regionEnd.load(std::memory_order_relaxed));
+				const uint64 commit_size = std::min<uint64>(c_commitBatchPages * c_pageSize, region_end - s_state.committedEnd);
+				if (commit_size == 0u || !commitMemory(s_state.committedEnd, commit_size))
+					return nullptr;
+
+				s_state.committedEnd += commit_size;
+				s_state.committedBytes.fetch_add(commit_size, std::memory_order_relaxed);
+			}
+
+			char *page = s_state.nextPage;
+			s_state.nextPage += c_pageSize;
+			return page;
+		}
+
+		PageHeader *allocatePage(ThreadHeap *p_heap, uint32 p_size_class)
+		{
+			char *memory;
+			{
+				std::lock_guard lock(s_state.pageLock);
+				memory = acquireRawPage();
+			}
+
+			if (!memory)
+				return nullptr;
+
+			auto *page      = new(memory) PageHeader();
+			page->sizeClass = p_size_class;
+			page->blockSize = c_sizeClasses[p_size_class];
+			page->capacity  = static_cast<uint32>((c_pageSize - c_pageHeaderSize) / page->blockSize);
+			page->owner.store(p_heap, std::memory_order_relaxed);
+
+			s_state.pagesInUse.fetch_add(1u, std::memory_order_relaxed);
+			return page;
+		}
+
+		// Pages stay committed and are reused for any size class
+		void releasePage(PageHeader *p_page)
+		{
+			s_state.pagesInUse.fetch_sub(1u, std::memory_order_relaxed);
+
+			std::lock_guard lock(s_state.pageLock);
+			p_page->next      = s_state.freePages;
+			s_state.freePages = p_page;
+		}
+
+		// Moves up to c_refillBatch never used blocks onto the local free list
+		void carveBlocks(PageHeader *p_page)
+		{
+			const uint32 count = std::min(c_refillBatch, p_page->capacity - p_page->carved);
+			if (count == 0u)
+				return;
+
+			char *first = reinterpret_cast<char *>(p_page) + c_pageHeaderSize + static_cast<uint64>(p_page->carved) * p_page->blockSize;
+			for (uint32 i = 0u; i + 1u < count; i++)
+			{
+				reinterpret_cast<FreeBlock *>(first + static_cast<uint64>(i) * p_page->blockSize)->next =
+						reinterpret_cast<FreeBlock *>(first + static_cast<uint64>(i + 1u) * p_page->blockSize);
+			}
+			reinterpret_cast<FreeBlock *>(first + static_cast<uint64>(count - 1u) * p_page->blockSize)->next = p_page->localFree;
+
+			p_page->localFree = reinterpret_cast<FreeBlock *>(first);
+			p_page->carved += count;
+		}
+
+		// Takes every block other threads have freed in one go
+		void collectRemoteFrees(PageHeader *p_page)
+		{
+			if (!p_page->remoteFree.load(std::memory_order_relaxed))
+				return;
+
+			FreeBlock *list = p_page->remoteFree.exchange(nullptr, std::memory_order_acquire);
+			if (!list)
+				return;
+
+			uint32     count = 1u;
+			FreeBlock *tail  = list;
+			while (tail->next)
+			{
+				tail = tail->next;
+				count++;
+			}
+
+			tail->next        = p_page->localFree;
+			p_page->localFree = list;
+			p_page->used -= count;
+		}
+
+		void pushRemoteFree(PageHeader *p_page, FreeBlock *p_block)
+		{
+			// The owner only ever takes the whole list, so a plain CAS push has no ABA problem
+			FreeBlock *head = p_page->remoteFree.load(std::memory_order_relaxed);
+			do
+			{
+				p_block->next = head;
+			}
+			while (!p_page->remoteFree.compare_exchange_weak(head, p_block, std::memory_order_release, std::memory_order_relaxed));
+
+			s_state.remoteFrees.fetch_add(1u, std::memory_order_relaxed);
+		}
+
+		void *popBlock(ThreadHeap *p_heap, PageHeader *p_page)
+		{
+			FreeBlock *block  = p_page->localFree;
+			p_page->localFree = block->next;
+			p_page->used++;
+			p_heap->allocations++;
+			return block;
+		}
+
+		// ---- Thread heaps --------------------------------------------------------------------------------------
+
+		struct ThreadHeapReleaser
+		{
+			~ThreadHeapReleaser()
+			{
+				ThreadHeap *heap = tl_heap;
+				tl_heap          = &s_deadHeap;
+
+				if (heap == &s_initialHeap || heap == &s_deadHeap)
+					return;
+
+				heap->abandon();
+
+				std::lock_guard lock(s_state.heapLock);
+				heap->nextFree    = s_state.freeHeaps;
+				s_state.freeHeaps = heap;
+			}
+		};
+
+		thread_local ThreadHeapReleaser tl_heapReleaser;
+
+		ThreadHeap *createThreadHeap()
+		{
+			ThreadHeap *heap = nullptr;
+			{
+				std::lock_guard lock(s_state.heapLock);
+				if (s_state.freeHeaps)
+				{
+					heap              = s_state.freeHeaps;
+					s_state.freeHeaps = heap->nextFree;
+				}
+				else
+				{
+					if (s_state.heapStorageEnd - s_state.heapStorage < static_cast<std::ptrdiff_t>(sizeof(ThreadHeap)))
+					{
+						std::lock_guard page_lock(s_state.pageLock);
+						s_state.heapStorage    = acquireRawPage();
+						s_state.heapStorageEnd = s_state.heapStorage ? s_state.heapStorage + c_pageSize : nullptr;
+					}
+
+					if (s_state.heapStorage)
+					{
+						static_assert(alignof(ThreadHeap) <= c_smallAllocAlignment);
+						heap = reinterpret_cast<ThreadHeap *>(s_state.heapStorage);
+						s_state.heapStorage += (sizeof(ThreadHeap) + c_smallAllocAlignment - 1u) & ~(c_smallAllocAlignment - 1u);
+					}
+				}
+			}
+
+			if (!heap)
+				return nullptr;
+
+			new(heap) ThreadHeap();
+			s_state.liveThreadHeaps.fetch_add(1u, std::memory_order_relaxed);
+
+			// Registers the destructor that hands the heap back when this thread exits
+			(void) &tl_heapReleaser;
+			return heap;
+		}
+
+		void *ThreadHeap::allocateSlow(const uint32 p_size_class)
+		{
+			flushStats();
+
+			PageList &available_pages = available[p_size_class];
+			PageList &full_pages      = full[p_size_class];
+
+			while (PageHeader *page = available_pages.head)
+			{
+				if (page->carved < page->capacity)
+					carveBlocks(page);
+				else
+					collectRemoteFrees(page);
+
+				if (page->localFree)
+					return popBlock(this, page);
+
+				available_pages.remove(page);
+				page->inFullList = true;
+				full_pages.pushBack(page);
+			}
+
+			// Other threads may have freed blocks into pages we consider full. Scanned pages without any are
+			// rotated to the back, so repeated scans don't keep looking at the same ones. Pages every block of
+			// which came back remotely are returned to the shared pool once there is another page to allocate from,
+			// otherwise a thread that only allocates (a producer) would hold on to all of them forever
+			for (uint32 i = 0u; i < c_fullPageScanLimit && full_pages.head; i++)
+			{
+				PageHeader *page = full_pages.head;
+				full_pages.remove(page);
+				collectRemoteFrees(page);
+
+				if (!page->localFree)
+				{
+					full_pages.pushBack(page);
+					continue;
+				}
+
+				page->inFullList = false;
+				if (page->used == 0u && available_pages.head)
+					releasePage(page);
+				else
+					available_pages.pushBack(page);
+			}
+
+			if (PageHeader *page = available_pages.head)
+				return popBlock(this, page);
+
+			// Adopt a page left behind by an exited thread
+			for (;;)
+			{
+				PageHeader *page;
+				{
+					std::lock_guard lock(s_state.abandonedLock);
+					page = s_state.abandoned[p_size_class];
+					if (!page)
+						break;
+					s_state.abandoned[p_size_class] = page->next;
+				}
+				s_state.abandonedPages.fetch_sub(1u, std::memory_order_relaxed);
+
+				page->owner.store(this, std::memory_order_relaxed);
+				collectRemoteFrees(page);
+
+				if (page->localFree || page->carved < page->capacity)
+				{
+					page->inFullList = false;
+					available_pages.pushFront(page);
+					if (!page->localFree)
+						carveBlocks(page);
+					return popBlock(this, page);
+				}
+
+				page->inFullList = true;
+				full_pages.pushBack(page);
+			}
+
+			PageHeader *page = allocatePage(this, p_size_class);
+			if (!page)
+				return nullptr;
+
+			available_pages.pushFront(page);
+			carveBlocks(page);
+			return popBlock(this, page);
+		}
+
+		void ThreadHeap::freeLocal(PageHeader *p_page, FreeBlock *p_block)
+		{
+			p_block->next     = p_page->localFree;
+			p_page->localFree = p_block;
+			p_page->used--;
+			frees++;
+
+			if (p_page->inFullList)
+			{
+				full[p_page->sizeClass].remove(p_page);
+				available[p_page->sizeClass].pushBack(p_page);
+				p_page->inFullList = false;
+			}
+
+			// Empty pages go back to the shared pool, except the one currently allocated from (avoids thrashing
+			// when a single block is allocated and freed repeatedly at a page boundary)
+			if (p_page->used == 0u && p_page != available[p_page->sizeClass].head)
+			{
+				available[p_page->sizeClass].remove(p_page);
+				releasePage(p_page);
+			}
+		}
+
+		void ThreadHeap::trim()
+		{
+			flushStats();
+
+			for (uint32 size_class = 0u; size_class < c_sizeClassCount; size_class++)
+			{
+				PageList &available_pages = available[size_class];
+				PageList &full_pages      = full[size_class];
+
+				for (PageHeader *page = full_pages.head; page;)
+				{
+					PageHeader *next = page->next;
+					collectRemoteFrees(page);
+					if (page->localFree)
+					{
+						full_pages.remove(page);
+						page->inFullList = false;
+						available_pages.pushBack(page);
+					}
+					page = next;
+				}
+
+				// The head page is kept, see freeLocal()
+				for (PageHeader *page = available_pages.head; page;)
+				{
+					PageHeader *next = page->next;
+					collectRemoteFrees(page);
+					if (page->used == 0u && page != available_pages.head)
+					{
+						available_pages.remove(page);
+						releasePage(page);
+					}
+					page = next;
+				}
+			}
+		}
+
+		void ThreadHeap::flushStats()
+		{
+			if (allocations)
+				s_state.allocations.fetch_add(allocations, std::memory_order_relaxed);
+			if (frees)
+				s_state.frees.fetch_add(frees, std::memory_order_relaxed);
+
+			allocations = 0u;
+			frees       = 0u;
+		}
+
+		void ThreadHeap::abandon()
+		{
+			flushStats();
+
+			for (uint32 size_class = 0u; size_class < c_sizeClassCount; size_class++)
+			{
+				for (PageList *list: {&available[size_class], &full[size_class]})
+				{
+					while (PageHeader *page = list->head)
+					{
+						list->remove(page);
+
+						// From here on every free into the page is a remote free, the next owner collects them
+						page->owner.store(nullptr, std::memory_order_release);
+						collectRemoteFrees(page);
+
+						if (page->used == 0u)
+						{
+							releasePage(page);
+							continue;
+						}
+
+						{
+							std::lock_guard lock(s_state.abandonedLock);
+							page->next                    = s_state.abandoned[size_class];
+							s_state.abandoned[size_class] = page;
+						}
+						s_state.abandonedPages.fetch_add(1u, std::memory_order_relaxed);
+					}
+				}
+			}
+
+			s_state.liveThreadHeaps.fetch_sub(1u, std::memory_order_relaxed);
+		}
+
+		void *allocateSmallSlow(uint32 p_size_class)
+		{
+			ThreadHeap *heap = tl_heap;
+			if (heap == &s_deadHeap)
+				return nullptr;
+
+			if (heap == &s_initialHeap)
+			{
+				heap = createThreadHeap();
+				if (!heap)
+				{
+					// No address space, everything goes to the system allocator from now on
+					tl_heap = &s_deadHeap;
+					return nullptr;
+				}
+				tl_heap = heap;
+			}
+
+			return heap->allocateSlow(p_size_class);
+		}
+
+		void *allocateLarge(uint64 p_size)
+		{
+			s_state.largeAllocations.fetch_add(1u, std::memory_order_relaxed);
+			return std::malloc(p_size ? p_size : 1u);
+		}
+	}
+
+	void *smallAlloc(const uint64 p_size)
+	{
+		if (p_size <= c_smallAllocMaxSize)
+		{
+			const uint32 size_class = c_sizeClassLookup[(p_size + 15u) >> 4u];
+
+			ThreadHeap *heap = tl_heap;
+			if (PageHeader *page = heap->available[size_class].head; page && page->localFree)
+			{
+				return popBlock(heap, page);
+			}
+
+			if (void *ptr = allocateSmallSlow(size_class))
+				return ptr;
+		}
+
+		return allocateLarge(p_size);
+	}
+
+	void smallFree(void *p_ptr) noexcept
+	{
+		if (!p_ptr)
+			return;
+
+		if (!isInRegion(p_ptr))
+		{
+			std::free(p_ptr);
+			return;
+		}
+
+		PageHeader *page  = pageOf(p_ptr);
+		auto *      block = static_cast<FreeBlock *>(p_ptr);
+
+		// Only this thread can make the page ours or take it away from us, so a relaxed load is enough
+		if (ThreadHeap *heap = tl_heap; page->owner.load(std::memory_order_relaxed) == heap)
+		{
+			heap->freeLocal(page, block);
+		}
+		else
+		{
+			pushRemoteFree(page, block);
+		}
+	}
+
+	void smallAllocTrim()
+	{
+		ThreadHeap *heap = tl_heap;
+		if (heap != &s_initialHeap && heap != &s_deadHeap)
+			heap->trim();
+	}
+
+	uint64 smallAllocUsableSize(const void *p_ptr)
+	{
+		return isInRegion(p_ptr) ? pageOf(p_ptr)->blockSize : 0u;
+	}
+
+	bool isSmallAllocation(const void *p_ptr)
+	{
+		return isInRegion(p_ptr);
+	}
+
+	SmallAllocatorStats getSmallAllocatorStats()
+	{
+		SmallAllocatorStats stats{};
+		stats.reservedBytes    = s_state.regionEnd.load(std::memory_order_relaxed) - s_state.regionBegin.load(std::memory_order_relaxed);
+		stats.committedBytes   = s_state.committedBytes.load(std::memory_order_relaxed);
+		stats.pagesInUse       = s_state.pagesInUse.load(std::memory_order_relaxed);
+		stats.abandonedPages   = s_state.abandonedPages.load(std::memory_order_relaxed);
+		stats.liveThreadHeaps  = s_state.liveThreadHeaps.load(std::memory_order_relaxed);
+		stats.allocations      = s_state.allocations.load(std::memory_order_relaxed);
+		stats.remoteFrees      = s_state.remoteFrees.load(std::memory_order_relaxed);
+		stats.frees            = s_state.frees.load(std::memory_order_relaxed) + stats.remoteFrees;
+		stats.largeAllocations = s_state.largeAllocations.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void logSmallAllocatorStats()
+	{
+		const SmallAllocatorStats stats = getSmallAllocatorStats();
+
+		LOG_INFO("Small object allocator:");
+		LOG_INFO("\tCommitted {:.2f} MB of {:.2f} MB reserved, {} pages in use, {} abandoned",
+				 static_cast<float64>(stats.committedBytes) / (1024.0 * 1024.0), static_cast<float64>(stats.reservedBytes) / (1024.0 * 1024.0),
+				 stats.pagesInUse, stats.abandonedPages);
+		LOG_INFO("\t{} allocations, {} frees ({} remote), {} large, {} live thread heaps",
+				 stats.allocations, stats.frees, stats.remoteFrees, stats.largeAllocations, stats.liveThreadHeaps);
+	}
+}
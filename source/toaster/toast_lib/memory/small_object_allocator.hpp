@@ -0,0 +1,51 @@
+#pragma once
+
+#include "system_types.h"
+
+namespace toaster::memory
+{
+	// Size-class segregated allocator for small, short lived allocations.
+	// Memory comes from one reserved address range split into 64KB pages. Every page holds blocks of a single size
+	// class and is owned by one thread, so allocating and freeing on the owning thread is a thread local free list
+	// push/pop. Blocks freed by other threads go onto the page's lock free remote list and are picked up in a batch
+	// by the owner the next time it runs out of blocks. Pages of exited threads are handed to the next thread that
+	// needs a page of that size class.
+	// Built with WITH_TOAST_ALLOCATOR, global operator new / delete are routed through here (see global_new.cpp)
+
+	static constexpr uint64 c_smallAllocMaxSize{2048u};
+	static constexpr uint64 c_smallAllocAlignment{16u};
+
+	struct SmallAllocatorStats
+	{
+		uint64 reservedBytes{0u};
+		uint64 committedBytes{0u};
+		uint64 pagesInUse{0u};
+		uint64 abandonedPages{0u}; // Pages of exited threads that still hold live blocks
+		uint64 liveThreadHeaps{0u};
+
+		// Flushed from the thread heaps on their slow path, so these lag slightly behind
+		uint64 allocations{0u};
+		uint64 frees{0u};
+		uint64 remoteFrees{0u};
+		uint64 largeAllocations{0u}; // Requests that were too big (or too aligned) and went to the system allocator
+	};
+
+	// Sizes above c_smallAllocMaxSize are passed on to the system allocator. Never returns nullptr for p_size == 0.
+	// Returns nullptr if the system is out of memory
+	[[nodiscard]] void *smallAlloc(uint64 p_size);
+	// Accepts anything returned by smallAlloc() and nullptr
+	void smallFree(void *p_ptr) noexcept;
+
+	// Collects the blocks other threads freed into the calling thread's pages and returns the pages that became
+	// empty. Pages are otherwise only looked at when the thread runs out of blocks, call this before a thread goes
+	// idle for a while
+	void smallAllocTrim();
+
+	// Usable size of a block returned by smallAlloc(), 0 for memory that came from the system allocator
+	[[nodiscard]] uint64 smallAllocUsableSize(const void *p_ptr);
+
+	[[nodiscard]] bool isSmallAllocation(const void *p_ptr);
+
+	[[nodiscard]] SmallAllocatorStats getSmallAllocatorStats();
+	void                              logSmallAllocatorStats();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "memory_tracker.hpp"
+
+namespace toaster::memory
+{
+	// STL compatible allocator that attributes everything it allocates to a memory tag
+	// e.g. std::vector<Vertex, TrackedAllocator<Vertex, EMemoryTag::eMesh>>
+	template<typename T, EMemoryTag Tag>
+	class TrackedAllocator
+	{
+	public:
+		using value_type = T;
+
+		// Needed explicitly, allocator_traits can't rebind templates that have a non-type parameter
+		template<typename U>
+		struct rebind
+		{
+			using other = TrackedAllocator<U, Tag>;
+		};
+
+		static constexpr EMemoryTag c_tag{Tag};
+
+		TrackedAllocator() noexcept = default;
+
+		template<typename U>
+		TrackedAllocator(const TrackedAllocator<U, Tag> &) noexcept
+		{
+		}
+
+		[[nodiscard]] T *allocate(std::size_t p_count)
+		{
+			return static_cast<T *>(trackedAlloc(p_count * sizeof(T), alignof(T), Tag));
+		}
+
+		void deallocate(T *p_ptr, std::size_t p_count) noexcept
+		{
+			trackedFree(p_ptr, p_count * sizeof(T), alignof(T), Tag);
+		}
+
+		template<typename U>
+		bool operator==(const TrackedAllocator<U, Tag> &) const noexcept { return true; }
+	};
+
+	template<typename T, EMemoryTag Tag>
+	using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+}
+
+// Routes all heap allocations of a class through the memory tracker, declare inside the class body:
+//	class Texture
+//	{
+//	public:
+//		TST_DECLARE_TAGGED_NEW(::toaster::memory::EMemoryTag::eTexture)
+//		...
+#define TST_DECLARE_TAGGED_NEW(_tag)\
+	static void *operator new(std::size_t p_size)\
+	{\
+		return ::toaster::memory::trackedAlloc(p_size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, _tag);\
+	}\
+	static void operator delete(void *p_ptr, std::size_t p_size) noexcept\
+	{\
+		::toaster::memory::trackedFree(p_ptr, p_size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, _tag);\
+	}
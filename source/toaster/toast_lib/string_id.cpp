@@ -0,0 +1,136 @@
+#include "string_id.hpp"
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "logging.hpp"
+#include "toast_assert.h"
+#include "memory/linear_arena.hpp"
+
+namespace toaster
+{
+	namespace
+	{
+		// Ids are spread over shards by hash so threads interning different strings rarely touch the same lock.
+		// Lookups only take a shared lock. Interned strings are never freed, so the pointers handed out stay valid, and
+		// their storage is tracked as permanent
+		class StringInterner
+		{
+		public:
+			static StringInterner &get()
+			{
+				// Never destroyed, ids may still be printed from static destructors
+				static auto *s_interner = new StringInterner();
+				return *s_interner;
+			}
+
+			// False if a different string with the same hash is already stored
+			bool insert(const uint64 p_hash, const std::string_view p_str)
+			{
+				Shard &shard = _shardFor(p_hash);
+
+				{
+					std::shared_lock lock(shard.mutex);
+					if (const auto it = shard.strings.find(p_hash); it != shard.strings.end())
+						return it->second == p_str;
+				}
+
+				std::unique_lock lock(shard.mutex);
+
+				// Another thread may have inserted it in between the two locks
+				if (const auto it = shard.strings.find(p_hash); it != shard.strings.end())
+					return it->second == p_str;
+
+				auto *storage = shard.storage.allocateArray<char>(p_str.size() + 1u);
+				std::memcpy(storage, p_str.data(), p_str.size());
+				storage[p_str.size()] = '\0';
+
+				shard.strings.emplace(p_hash, std::string_view(storage, p_str.size()));
+				return true;
+			}
+
+			std::string_view find(const uint64 p_hash)
+			{
+				Shard &          shard = _shardFor(p_hash);
+				std::shared_lock lock(shard.mutex);
+
+				if (const auto it = shard.strings.find(p_hash); it != shard.strings.end())
+				{
+					return it->second;
+				}
+				return {};
+			}
+
+		private:
+			static constexpr uint64 c_shardCount{16u};
+
+			struct alignas(64) Shard
+			{
+				std::shared_mutex                            mutex;
+				std::unordered_map<uint64, std::string_view> strings;
+				memory::LinearArena                          storage{4096u, memory::EMemoryTag::ePermanent};
+			};
+
+			Shard &_shardFor(const uint64 p_hash)
+			{
+				// The top bits, the low bits already pick the unordered_map bucket
+				return m_shards[p_hash >> 60u];
+			}
+
+			static_assert(c_shardCount == 16u, "_shardFor() uses the top 4 bits of the hash");
+			std::array<Shard, c_shardCount> m_shards;
+		};
+
+		void insertOrAssert(const uint64 p_hash, const std::string_view p_str)
+		{
+			StringInterner &interner = StringInterner::get();
+			if (!interner.insert(p_hash, p_str))
+			{
+				LOG_ERROR("StringId hash collision: \"{}\" and \"{}\" both hash to {:016x}", interner.find(p_hash), p_str, p_hash);
+				TST_ASSERT_MSG(false, "StringId hash collision");
+			}
+		}
+	}
+
+	StringId StringId::intern(const std::string_view p_str)
+	{
+		StringId id;
+		id.m_hash = hashString64(p_str);
+
+		insertOrAssert(id.m_hash, p_str);
+		return id;
+	}
+
+	std::optional<StringId> StringId::tryIntern(const std::string_view p_str)
+	{
+		StringId id;
+		id.m_hash = hashString64(p_str);
+
+		if (!StringInterner::get().insert(id.m_hash, p_str))
+			return std::nullopt;
+		return id;
+	}
+
+	std::string_view StringId::getString() const
+	{
+		if (!isValid())
+			return {};
+
+		return StringInterner::get().find(m_hash);
+	}
+
+	const char *StringId::c_str() const
+	{
+		// Everything in the interner is stored null terminated
+		const std::string_view str = getString();
+		return str.empty() ? nullptr : str.data();
+	}
+
+	void StringId::_registerDebugString(const uint64 p_hash, const std::string_view p_str)
+	{
+		insertOrAssert(p_hash, p_str);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <compare>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "system_types.h"
+
+namespace toaster
+{
+	// 64-bit FNV-1a, usable at compile time
+	constexpr uint64 hashString64(std::string_view p_str)
+	{
+		uint64 hash = 0xcbf29ce484222325ull;
+		for (const char c: p_str)
+		{
+			hash ^= static_cast<uint8>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// A string reduced to its 64-bit hash, so comparing and hashing names is an integer operation.
+	// Literals are hashed at compile time:
+	//	constexpr StringId c_albedo{"albedoMap"};
+	//	using namespace toaster::literals; auto id = "albedoMap"_sid;
+	// The id alone can't be turned back into a string. Strings that need to be read back (e.g. names handed to Vulkan)
+	// must go through StringId::intern(). Debug builds additionally remember every string hashed at runtime, so ids
+	// can be printed while debugging and hash collisions are caught
+	class StringId
+	{
+	public:
+		constexpr StringId() = default;
+
+		constexpr explicit StringId(std::string_view p_str) : m_hash(hashString64(p_str))
+		{
+			#ifndef NDEBUG
+			if !consteval
+			{
+				_registerDebugString(m_hash, p_str);
+			}
+			#endif
+		}
+
+		// Hashes the string and stores a copy of it in the global interner, getString() and c_str() are then valid
+		// for the rest of the program. Thread safe. A different string with the same hash already interned is a
+		// programming error and asserts
+		static StringId intern(std::string_view p_str);
+		// Like intern(), but a collision is returned as nullopt and nothing is stored. For names from data files, where
+		// the data is to blame
+		[[nodiscard]] static std::optional<StringId> tryIntern(std::string_view p_str);
+
+		[[nodiscard]] constexpr uint64 getHash() const { return m_hash; }
+		[[nodiscard]] constexpr bool   isValid() const { return m_hash != 0u; }
+
+		// Reverse lookup, empty if the string was never interned (or, in debug builds, never hashed at runtime)
+		[[nodiscard]] std::string_view getString() const;
+		// Null terminated, nullptr if the string is unknown
+		[[nodiscard]] const char *c_str() const;
+
+		constexpr bool                 operator==(const StringId &) const  = default;
+		constexpr std::strong_ordering operator<=>(const StringId &) const = default;
+
+	private:
+		static void _registerDebugString(uint64 p_hash, std::string_view p_str);
+
+		uint64 m_hash{0u};
+	};
+
+	namespace literals
+	{
+		consteval StringId operator""_sid(const char *p_str, std::size_t p_length)
+		{
+			return StringId(std::string_view(p_str, p_length));
+		}
+	}
+}
+
+template<>
+struct std::hash<toaster::StringId>
+{
+	// Already a good hash, no need to hash it again
+	std::size_t operator()(const toaster::StringId &p_id) const noexcept
+	{
+		return static_cast<std::size_t>(p_id.getHash());
+	}
+};
+
+// Prints the string if it is known, the hash otherwise
+template<>
+struct fmt::formatter<toaster::StringId> : fmt::formatter<std::string_view>
+{
+	auto format(const toaster::StringId &p_id, fmt::format_context &p_ctx) const
+	{
+		if (const std::string_view str = p_id.getString(); !str.empty())
+		{
+			return fmt::formatter<std::string_view>::format(str, p_ctx);
+		}
+		return fmt::format_to(p_ctx.out(), "#{:016x}", p_id.getHash());
+	}
+};
@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "memory/frame_arena.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	constexpr uint32 c_frames{2'000u};
+	constexpr uint32 c_framesInFlight{3u};
+
+	struct DrawItem
+	{
+		const void *worldMatrix;
+		const void *mesh;
+		const void *draw;
+	};
+
+	// What Application::_cullScene() does per frame: a worst case sized index list with three out of four objects
+	// visible, then a draw array per visible object with one to four submeshes. Every array is written, so both
+	// sides pay for touching the memory. Returns the allocations made per frame
+	template<typename Allocate, typename EndFrame>
+	uint32 runFrames(const uint32 p_objects, Allocate &&p_allocate, EndFrame &&p_end_frame, double &p_out_ns)
+	{
+		std::vector<DrawItem *> draws(p_objects);
+
+		uint32 allocations = 0u;
+		p_out_ns           = test::measureNs([&]
+		{
+			for (uint32 frame = 0u; frame < c_frames; frame++)
+			{
+				auto * visible = static_cast<uint32 *>(p_allocate(sizeof(uint32) * p_objects, alignof(uint32)));
+				uint32 count   = 0u;
+				for (uint32 i = 0u; i < p_objects; i++)
+				{
+					if ((i & 3u) != 0u)
+						visible[count++] = i;
+				}
+
+				for (uint32 i = 0u; i < count; i++)
+				{
+					const uint32 sub_meshes = 1u + (visible[i] & 3u);
+					draws[i]                = static_cast<DrawItem *>(p_allocate(sizeof(DrawItem) * sub_meshes, alignof(DrawItem)));
+					for (uint32 sub_mesh = 0u; sub_mesh < sub_meshes; sub_mesh++)
+					{
+						draws[i][sub_mesh] = {&visible[i], nullptr, nullptr};
+					}
+				}
+				test::doNotOptimize(draws.data());
+
+				p_end_frame(visible, std::span<DrawItem *>(draws.data(), count));
+				allocations = count + 1u;
+			}
+		}, 3u);
+		return allocations;
+	}
+}
+
+// Building the per-frame cull and draw lists with malloc/free against the FrameArena, where a frame's allocations
+// are dropped by resetting the buffer
+TST_BENCHMARK(frameArenaVsMalloc)
+{
+	std::printf("%u frames, %u buffered:\n", c_frames, c_framesInFlight);
+	for (const uint32 objects: {64u, 1'024u, 16'384u})
+	{
+		double       malloc_ns   = 0.0;
+		const uint32 allocations = runFrames(objects, [](const uint64 p_size, uint64) { return std::malloc(p_size); },
+											 [](uint32 *p_visible, const std::span<DrawItem *> p_draws)
+											 {
+												 for (DrawItem *draw: p_draws)
+												 {
+													 std::free(draw);
+												 }
+												 std::free(p_visible);
+											 }, malloc_ns);
+
+		memory::FrameArena arena(c_framesInFlight);
+		double             arena_ns = 0.0;
+		runFrames(objects, [&arena](const uint64 p_size, const uint64 p_alignment) { return arena.allocate(p_size, p_alignment); },
+				  [&arena](uint32 *, std::span<DrawItem *>) { arena.beginFrame(); }, arena_ns);
+		arena.release();
+
+		const double total = static_cast<double>(c_frames) * allocations;
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "malloc, %u objects", objects);
+		test::report(name, malloc_ns, total);
+		std::snprintf(name, sizeof(name), "FrameArena, %u objects", objects);
+		test::report(name, arena_ns, total);
+	}
+}
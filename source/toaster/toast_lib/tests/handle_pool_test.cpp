@@ -0,0 +1,128 @@
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "memory/handle_pool.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	uint32 nextRandom(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return p_state;
+	}
+
+	// Counts live instances, so objects moved around by destroy() are destroyed exactly once
+	struct Tracked
+	{
+		static inline int64 s_live = 0;
+
+		explicit Tracked(const uint32 p_value) : value(p_value) { s_live++; }
+		Tracked(Tracked &&p_other) noexcept : value(p_other.value) { s_live++; }
+		Tracked &operator=(Tracked &&p_other) noexcept = default;
+		~Tracked() { s_live--; }
+
+		uint32 value;
+	};
+
+	using Pool = memory::HandlePool<Tracked>;
+}
+
+TST_TEST(handlePoolRejectsStaleHandles)
+{
+	Pool pool;
+	const Pool::HandleType a = pool.create(1u);
+	const Pool::HandleType b = pool.create(2u);
+	const Pool::HandleType c = pool.create(3u);
+
+	pool.destroy(b);
+	TST_CHECK(!pool.isAlive(b) && pool.get(b) == nullptr);
+	TST_CHECK(pool.get(a)->value == 1u && pool.get(c)->value == 3u);
+
+	// The slot is reused under a new generation, the old handle still doesn't reach the new object
+	const Pool::HandleType d = pool.create(4u);
+	TST_CHECK(d.index == b.index && d.generation != b.generation && d != b);
+	TST_CHECK(!pool.isAlive(b) && pool.get(b) == nullptr);
+	TST_CHECK(pool.get(d)->value == 4u);
+
+	// Destroying through a stale handle leaves the new object alone
+	pool.destroy(b);
+	TST_CHECK(pool.size() == 3u && pool.get(d)->value == 4u);
+
+	// Default and out of range handles never resolve
+	TST_CHECK(!Pool::HandleType{}.isValid() && pool.get(Pool::HandleType{}) == nullptr);
+	TST_CHECK(pool.get(Pool::HandleType{1'000u, 1u}) == nullptr);
+	pool.destroy(Pool::HandleType{});
+
+	// After clear() every handle is stale, also once the slots are reused
+	pool.clear();
+	TST_CHECK(pool.empty() && Tracked::s_live == 0);
+	for (const Pool::HandleType handle: {a, c, d})
+	{
+		TST_CHECK(pool.get(handle) == nullptr);
+	}
+	const Pool::HandleType e = pool.create(5u);
+	const Pool::HandleType f = pool.create(6u);
+	TST_CHECK(pool.get(a) == nullptr && pool.get(c) == nullptr && pool.get(d) == nullptr);
+	TST_CHECK(pool.get(e)->value == 5u && pool.get(f)->value == 6u);
+
+	// Moving the pool keeps the handles
+	Pool moved = std::move(pool);
+	TST_CHECK(moved.get(e)->value == 5u && moved.get(f)->value == 6u && moved.get(a) == nullptr);
+}
+
+// Random creates and destroys against a map of what should be alive: every live handle finds its object, every
+// destroyed one is stale, and the objects stay densely packed
+TST_TEST(handlePoolMatchesReference)
+{
+	{
+		Pool                                         pool;
+		std::unordered_map<Pool::HandleType, uint32> alive;
+		std::vector<Pool::HandleType>                destroyed;
+
+		uint32 state = 99u;
+		for (uint32 step = 0u; step < 20'000u; step++)
+		{
+			if (alive.empty() || nextRandom(state) % 100u < 55u)
+			{
+				const uint32           value  = nextRandom(state);
+				const Pool::HandleType handle = pool.create(value);
+				TST_CHECK(!alive.contains(handle));
+				alive.emplace(handle, value);
+			}
+			else
+			{
+				auto it = alive.begin();
+				std::advance(it, nextRandom(state) % alive.size());
+				pool.destroy(it->first);
+				destroyed.push_back(it->first);
+				alive.erase(it);
+			}
+
+			if (step % 1'000u != 0u)
+				continue;
+
+			TST_CHECK(pool.size() == alive.size() && Tracked::s_live == static_cast<int64>(alive.size()));
+			for (const auto &[handle, value]: alive)
+			{
+				const Tracked *object = pool.get(handle);
+				TST_CHECK(object != nullptr && object->value == value);
+			}
+			for (const Pool::HandleType handle: destroyed)
+			{
+				TST_CHECK(!pool.isAlive(handle));
+			}
+			for (uint32 i = 0u; i < pool.size(); i++)
+			{
+				TST_CHECK(&pool[pool.getHandle(i)] == &pool.getObjects()[i]);
+			}
+		}
+	}
+	TST_CHECK(Tracked::s_live == 0);
+}
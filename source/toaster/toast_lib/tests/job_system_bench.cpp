@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	// A few ns of arithmetic per element, small enough that scheduling overhead shows up
+	void lightWork(float *p_data, const uint64 p_begin, const uint64 p_end)
+	{
+		for (uint64 i = p_begin; i < p_end; i++)
+		{
+			p_data[i] = std::sqrt(p_data[i] * 1.0001f + 0.5f);
+		}
+	}
+}
+
+// Scaling from 1 thread (the main thread alone) up to every hardware thread: 100k empty jobs on one counter, a fine
+// grained parallelFor over 16M floats with a few ns of work each at a minimum grain of 256 and 4096, and the same
+// loop serial as the baseline
+TST_BENCHMARK(jobSystemScaling)
+{
+	constexpr uint64 c_jobCount{100'000u};
+	constexpr uint64 c_elementCount{16u << 20u};
+
+	std::vector<float> data(c_elementCount, 1.0f);
+	const double       elements = static_cast<double>(c_elementCount);
+
+	const uint32 hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::printf("%u hardware threads\n", hardware_threads);
+
+	test::report("serial loop", test::measureNs([&]
+	{
+		lightWork(data.data(), 0u, c_elementCount);
+		test::doNotOptimize(data);
+	}), elements);
+
+	for (uint32 threads = 1u; threads <= hardware_threads; threads = threads < hardware_threads ? std::min(threads * 2u, hardware_threads) : threads + 1u)
+	{
+		jobs::initialize({.workerThreads = threads - 1u});
+		std::printf("%u thread(s):\n", threads);
+
+		test::report("empty jobs", test::measureNs([&]
+		{
+			jobs::JobCounter counter;
+			for (uint64 i = 0u; i < c_jobCount; i++)
+			{
+				jobs::run([] {}, &counter);
+			}
+			jobs::waitFor(counter);
+		}), static_cast<double>(c_jobCount));
+
+		for (const uint64 grain: {256u, 4096u})
+		{
+			char name[64];
+			std::snprintf(name, sizeof(name), "parallelFor, grain %llu", static_cast<unsigned long long>(grain));
+			test::report(name, test::measureNs([&]
+			{
+				jobs::parallelFor(0u, c_elementCount, [&](const uint64 p_begin, const uint64 p_end)
+				{
+					lightWork(data.data(), p_begin, p_end);
+				}, grain);
+				test::doNotOptimize(data);
+			}), elements);
+		}
+
+		jobs::shutdown();
+	}
+}
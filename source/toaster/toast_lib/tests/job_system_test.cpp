@@ -0,0 +1,200 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "jobs/job_system.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	// Every test runs with the main thread alone and with worker threads, the first runs everything inline in waitFor()
+	constexpr uint32 c_workerThreadCounts[] = {0u, 3u};
+
+	struct JobSystemScope
+	{
+		explicit JobSystemScope(const uint32 p_worker_threads) { jobs::initialize({.workerThreads = p_worker_threads}); }
+		~JobSystemScope() { jobs::shutdown(); }
+	};
+}
+
+TST_TEST(jobCounterCountsEveryJob)
+{
+	for (const uint32 worker_threads: c_workerThreadCounts)
+	{
+		JobSystemScope job_system(worker_threads);
+
+		constexpr uint32 c_jobCount{10'000u};
+
+		// Jobs that spawn more jobs on the same counter keep it above zero until the last of them is done
+		std::atomic<uint32> ran{0u};
+		jobs::JobCounter    counter;
+		for (uint32 i = 0u; i < c_jobCount; i++)
+		{
+			jobs::run([&]
+			{
+				jobs::run([&] { ran.fetch_add(1u, std::memory_order_relaxed); }, &counter);
+				ran.fetch_add(1u, std::memory_order_relaxed);
+			}, &counter);
+		}
+		jobs::waitFor(counter);
+		TST_CHECK(counter.isDone() && counter.getPending() == 0u);
+		TST_CHECK(ran.load() == c_jobCount * 2u);
+
+		// Affinities are kept: main thread jobs only on the main thread, worker jobs only off it when there are workers
+		std::atomic<uint32> wrong_thread{0u};
+		for (uint32 i = 0u; i < 1'000u; i++)
+		{
+			jobs::run([&]
+			{
+				if (!jobs::isMainThread())
+					wrong_thread.fetch_add(1u, std::memory_order_relaxed);
+			}, &counter, jobs::EJobAffinity::eMainThread);
+			jobs::run([&, worker_threads]
+			{
+				if (worker_threads != 0u && jobs::isMainThread())
+					wrong_thread.fetch_add(1u, std::memory_order_relaxed);
+			}, &counter, jobs::EJobAffinity::eWorkerThread);
+		}
+		jobs::waitFor(counter);
+		TST_CHECK(wrong_thread.load() == 0u);
+	}
+}
+
+TST_TEST(jobRunAfterWaitsForDependency)
+{
+	for (const uint32 worker_threads: c_workerThreadCounts)
+	{
+		JobSystemScope job_system(worker_threads);
+
+		constexpr uint32 c_stageCount{8u};
+		constexpr uint32 c_jobsPerStage{500u};
+
+		// Every job of a stage checks that the whole previous stage finished before it started
+		std::vector<std::unique_ptr<jobs::JobCounter>> stages;
+		for (uint32 stage = 0u; stage < c_stageCount; stage++)
+		{
+			stages.push_back(std::make_unique<jobs::JobCounter>());
+		}
+		std::vector<std::atomic<uint32>> finished(c_stageCount);
+		std::atomic<uint32>              too_early{0u};
+
+		// A main thread job holds the gate until the wait below, so every stage is parked before any of them runs
+		jobs::JobCounter gate;
+		jobs::run([] {}, &gate, jobs::EJobAffinity::eMainThread);
+		for (uint32 stage = 0u; stage < c_stageCount; stage++)
+		{
+			jobs::JobCounter &dependency = stage == 0u ? gate : *stages[stage - 1u];
+			for (uint32 i = 0u; i < c_jobsPerStage; i++)
+			{
+				jobs::runAfter(dependency, [&, stage]
+				{
+					if (stage != 0u && finished[stage - 1u].load(std::memory_order_acquire) != c_jobsPerStage)
+						too_early.fetch_add(1u, std::memory_order_relaxed);
+					finished[stage].fetch_add(1u, std::memory_order_release);
+				}, stages[stage].get());
+			}
+		}
+		TST_CHECK(gate.getPending() == 1u && stages.back()->getPending() == c_jobsPerStage);
+
+		jobs::waitFor(*stages.back());
+		TST_CHECK(too_early.load() == 0u);
+		for (uint32 stage = 0u; stage < c_stageCount; stage++)
+		{
+			TST_CHECK(finished[stage].load() == c_jobsPerStage);
+		}
+
+		// A dependency that is already done queues the job right away
+		bool             ran = false;
+		jobs::JobCounter counter;
+		jobs::runAfter(gate, [&] { ran = true; }, &counter);
+		jobs::waitFor(counter);
+		TST_CHECK(ran);
+	}
+}
+
+// shutdown() runs what is still queued or parked, as long as something can still release it
+TST_TEST(jobShutdownRunsQueuedJobs)
+{
+	for (const uint32 worker_threads: c_workerThreadCounts)
+	{
+		std::atomic<uint32> ran{0u};
+		jobs::JobCounter    dependency;
+		{
+			JobSystemScope job_system(worker_threads);
+
+			jobs::run([&] { ran.fetch_add(1u, std::memory_order_relaxed); }, &dependency);
+			for (uint32 i = 0u; i < 100u; i++)
+			{
+				jobs::runAfter(dependency, [&] { ran.fetch_add(1u, std::memory_order_relaxed); });
+				jobs::run([&] { ran.fetch_add(1u, std::memory_order_relaxed); }, nullptr, jobs::EJobAffinity::eMainThread);
+			}
+		}
+		TST_CHECK(ran.load() == 201u);
+	}
+}
+
+TST_TEST(parallelForCoversRangeOnce)
+{
+	for (const uint32 worker_threads: c_workerThreadCounts)
+	{
+		JobSystemScope job_system(worker_threads);
+
+		struct Range
+		{
+			uint64 begin;
+			uint64 end;
+			uint64 minGrain;
+		};
+		constexpr Range c_ranges[] = {
+			{0u, 0u, 0u}, {5u, 5u, 0u}, {9u, 3u, 0u}, {0u, 1u, 0u}, {7u, 100'007u, 0u}, {0u, 100'000u, 1u}, {3u, 1'003u, 64u}, {0u, 17u, 1'000u},
+		};
+
+		for (const Range &range: c_ranges)
+		{
+			const uint64                    size = range.end > range.begin ? range.end : 0u;
+			std::vector<std::atomic<uint8>> hits(size);
+			std::atomic<uint32>             bad_ranges{0u};
+			jobs::parallelFor(range.begin, range.end, [&](const uint64 p_begin, const uint64 p_end)
+			{
+				if (p_begin >= p_end || p_begin < range.begin || p_end > range.end)
+				{
+					bad_ranges.fetch_add(1u, std::memory_order_relaxed);
+					return;
+				}
+				for (uint64 i = p_begin; i < p_end; i++)
+				{
+					hits[i].fetch_add(1u, std::memory_order_relaxed);
+				}
+			}, range.minGrain);
+
+			TST_CHECK(bad_ranges.load() == 0u);
+			for (uint64 i = 0u; i < size; i++)
+			{
+				TST_CHECK(hits[i].load() == (i >= range.begin ? 1u : 0u));
+			}
+		}
+
+		// Nested inside another parallelFor's ranges, the inner waits run the outer's jobs too
+		constexpr uint64    c_outerCount{64u};
+		constexpr uint64    c_innerCount{1'000u};
+		std::atomic<uint64> sum{0u};
+		jobs::parallelFor(0u, c_outerCount, [&](const uint64 p_begin, const uint64 p_end)
+		{
+			for (uint64 outer = p_begin; outer < p_end; outer++)
+			{
+				jobs::parallelFor(0u, c_innerCount, [&](const uint64 p_inner_begin, const uint64 p_inner_end)
+				{
+					uint64 local = 0u;
+					for (uint64 inner = p_inner_begin; inner < p_inner_end; inner++)
+					{
+						local += inner;
+					}
+					sum.fetch_add(local, std::memory_order_relaxed);
+				}, 16u);
+			}
+		}, 1u);
+		TST_CHECK(sum.load() == c_outerCount * (c_innerCount * (c_innerCount - 1u) / 2u));
+	}
+}
@@ -0,0 +1,213 @@
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_bench.hpp"
+#include "math/math_vector.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	constexpr uint32 c_count{1'000'000u};
+
+	std::vector<glm::mat4> makeModels()
+	{
+		std::vector<glm::mat4> models(c_count);
+		for (uint32 i = 0u; i < c_count; i++)
+		{
+			const float t = static_cast<float>(i);
+			models[i]     = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(t, -t, t * 0.5f)), t * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+		return models;
+	}
+
+	std::vector<glm::quat> makeQuats()
+	{
+		std::vector<glm::quat> quats(c_count);
+		for (uint32 i = 0u; i < c_count; i++)
+		{
+			quats[i] = glm::angleAxis(static_cast<float>(i) * 0.01f, glm::normalize(glm::vec3(1.0f, 2.0f, static_cast<float>(i % 5u))));
+		}
+		return quats;
+	}
+
+	void compare(const char *p_name, const double p_tsm_ns, const double p_glm_ns)
+	{
+		char name[64];
+		std::snprintf(name, sizeof(name), "%s, tsm", p_name);
+		test::report(name, p_tsm_ns, c_count);
+		std::snprintf(name, sizeof(name), "%s, glm", p_name);
+		test::report(name, p_glm_ns, c_count);
+	}
+}
+
+// 1M of each operation, the tsm types against the same math in glm. Both read and write glm types in memory, the way
+// the engine uses them
+TST_BENCHMARK(mathTypesVsGlm)
+{
+	const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 4.0f, -10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	const std::vector<glm::mat4> models = makeModels();
+	const std::vector<glm::quat> quats  = makeQuats();
+
+	std::vector<glm::mat4> out_matrices(c_count);
+	std::vector<glm::vec4> out_vectors(c_count);
+	std::vector<glm::quat> out_quats(c_count);
+
+	std::printf("%u operations:\n", c_count);
+
+	compare("proj * view * model",
+			test::measureNs([&]
+			{
+				const tsm::float4x4 view_proj = tsm::float4x4(proj) * tsm::float4x4(view);
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = (view_proj * tsm::float4x4(models[i])).toGlm();
+				}
+				test::doNotOptimize(out_matrices);
+			}),
+			test::measureNs([&]
+			{
+				const glm::mat4 view_proj = proj * view;
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = view_proj * models[i];
+				}
+				test::doNotOptimize(out_matrices);
+			}));
+
+	// Unhoisted, the chain as it is written in most call sites
+	compare("proj * view * model, per object",
+			test::measureNs([&]
+			{
+				const tsm::float4x4 tsm_proj(proj);
+				const tsm::float4x4 tsm_view(view);
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = (tsm_proj * tsm_view * tsm::float4x4(models[i])).toGlm();
+				}
+				test::doNotOptimize(out_matrices);
+			}),
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = proj * view * models[i];
+				}
+				test::doNotOptimize(out_matrices);
+			}));
+
+	compare("matrix * point",
+			test::measureNs([&]
+			{
+				const tsm::float4x4 view_proj = tsm::float4x4(proj) * tsm::float4x4(view);
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_vectors[i] = (view_proj * tsm::float4(models[i][3])).toGlm();
+				}
+				test::doNotOptimize(out_vectors);
+			}),
+			test::measureNs([&]
+			{
+				const glm::mat4 view_proj = proj * view;
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_vectors[i] = view_proj * models[i][3];
+				}
+				test::doNotOptimize(out_vectors);
+			}));
+
+	compare("inverse",
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = tsm::inverse(tsm::float4x4(models[i])).toGlm();
+				}
+				test::doNotOptimize(out_matrices);
+			}),
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = glm::inverse(models[i]);
+				}
+				test::doNotOptimize(out_matrices);
+			}));
+
+	compare("inverseAffine",
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = tsm::inverseAffine(tsm::float4x4(models[i])).toGlm();
+				}
+				test::doNotOptimize(out_matrices);
+			}),
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = glm::affineInverse(models[i]);
+				}
+				test::doNotOptimize(out_matrices);
+			}));
+
+	compare("quat * quat",
+			test::measureNs([&]
+			{
+				const tsm::quat rotation(quats[0]);
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_quats[i] = (rotation * tsm::quat(quats[i])).toGlm();
+				}
+				test::doNotOptimize(out_quats);
+			}),
+			test::measureNs([&]
+			{
+				const glm::quat rotation = quats[0];
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_quats[i] = rotation * quats[i];
+				}
+				test::doNotOptimize(out_quats);
+			}));
+
+	compare("quat rotate",
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_vectors[i] = tsm::quat(quats[i]).rotate(tsm::float4(models[i][3])).toGlm();
+				}
+				test::doNotOptimize(out_vectors);
+			}),
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_vectors[i] = glm::vec4(quats[i] * glm::vec3(models[i][3]), models[i][3].w);
+				}
+				test::doNotOptimize(out_vectors);
+			}));
+
+	compare("quat to matrix",
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = tsm::quat(quats[i]).toMatrix().toGlm();
+				}
+				test::doNotOptimize(out_matrices);
+			}),
+			test::measureNs([&]
+			{
+				for (uint32 i = 0u; i < c_count; i++)
+				{
+					out_matrices[i] = glm::mat4_cast(quats[i]);
+				}
+				test::doNotOptimize(out_matrices);
+			}));
+}
@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_bench.hpp"
+#include "jobs/job_system.hpp"
+#include "math/math_frustum.hpp"
+
+using namespace toaster;
+
+// AABB and sphere culling of 10k, 100k and 1M objects scattered around the camera: the per object test in a loop,
+// the batch kernel and the batch kernel split over the job system (every hardware thread)
+TST_BENCHMARK(frustumCulling)
+{
+	jobs::initialize({});
+
+	const glm::mat4    proj    = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+	const glm::mat4    view    = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(1.0f, 9.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const tsm::Frustum frustum = tsm::Frustum::fromMatrix(proj * view);
+
+	std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+	for (const uint64 count: {10'000u, 100'000u, 1'000'000u})
+	{
+		tsm::Float3Stream  centers(count);
+		tsm::Float3Stream  extents(count);
+		std::vector<float> radii(count);
+
+		uint32 state = 2463534242u;
+		const auto next = [&state]
+		{
+			state ^= state << 13u;
+			state ^= state >> 17u;
+			state ^= state << 5u;
+			return static_cast<float>(state >> 8u) / static_cast<float>(1u << 24u);
+		};
+		for (uint64 i = 0u; i < count; i++)
+		{
+			centers.set(i, glm::vec3(next() * 800.0f - 400.0f, next() * 100.0f - 50.0f, next() * 800.0f - 400.0f));
+			extents.set(i, glm::vec3(next() * 4.0f, next() * 4.0f, next() * 4.0f));
+			radii[i] = next() * 4.0f;
+		}
+
+		std::vector<uint32> visible;
+		visible.reserve(count);
+
+		const double items = static_cast<double>(count);
+		std::printf("%llu objects:\n", static_cast<unsigned long long>(count));
+
+		test::report("AABB, per object", test::measureNs([&]
+		{
+			visible.clear();
+			for (uint32 i = 0u; i < count; i++)
+			{
+				if (frustum.isAabbVisible(centers.get(i), extents.get(i)))
+					visible.push_back(i);
+			}
+			test::doNotOptimize(visible);
+		}), items);
+		test::report("AABB, cullAabbs", test::measureNs([&] { tsm::cullAabbs(frustum, centers, extents, visible); }), items);
+		test::report("AABB, cullAabbsParallel", test::measureNs([&] { tsm::cullAabbsParallel(frustum, centers, extents, visible); }), items);
+
+		test::report("Sphere, per object", test::measureNs([&]
+		{
+			visible.clear();
+			for (uint32 i = 0u; i < count; i++)
+			{
+				if (frustum.isSphereVisible(centers.get(i), radii[i]))
+					visible.push_back(i);
+			}
+			test::doNotOptimize(visible);
+		}), items);
+		test::report("Sphere, cullSpheres", test::measureNs([&] { tsm::cullSpheres(frustum, centers, radii, visible); }), items);
+		test::report("Sphere, cullSpheresParallel", test::measureNs([&] { tsm::cullSpheresParallel(frustum, centers, radii, visible); }), items);
+	}
+
+	jobs::shutdown();
+}
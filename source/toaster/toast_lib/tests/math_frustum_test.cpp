@@ -0,0 +1,89 @@
+#include <cmath>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_test.hpp"
+#include "jobs/job_system.hpp"
+#include "math/math_frustum.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	// Objects scattered around the camera, roughly a third of them visible
+	struct Scene
+	{
+		tsm::Frustum       frustum;
+		tsm::Float3Stream  centers;
+		tsm::Float3Stream  extents;
+		std::vector<float> radii;
+	};
+
+	Scene makeScene(const uint64 p_count)
+	{
+		const glm::mat4 proj = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+		const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(1.0f, 9.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		Scene scene{tsm::Frustum::fromMatrix(proj * view), tsm::Float3Stream(p_count), tsm::Float3Stream(p_count), std::vector<float>(p_count)};
+
+		uint32 state = 2463534242u;
+		const auto next = [&state]
+		{
+			state ^= state << 13u;
+			state ^= state >> 17u;
+			state ^= state << 5u;
+			return static_cast<float>(state >> 8u) / static_cast<float>(1u << 24u);
+		};
+
+		for (uint64 i = 0u; i < p_count; i++)
+		{
+			scene.centers.set(i, glm::vec3(next() * 800.0f - 400.0f, next() * 100.0f - 50.0f, next() * 800.0f - 400.0f));
+			scene.extents.set(i, glm::vec3(next() * 4.0f, next() * 4.0f, next() * 4.0f));
+			scene.radii[i] = next() * 4.0f;
+		}
+		return scene;
+	}
+
+	struct JobSystemScope
+	{
+		explicit JobSystemScope(const uint32 p_workers) { jobs::initialize({p_workers}); }
+		~JobSystemScope() { jobs::shutdown(); }
+	};
+}
+
+// The batch culling must agree exactly with the per object tests, on both sides of the parallel threshold
+TST_TEST(frustumCullMatchesPerObjectTests)
+{
+	for (const uint64 count: {1'001u, 200'003u})
+	{
+		const Scene scene = makeScene(count);
+
+		std::vector<uint32> expected_aabbs;
+		std::vector<uint32> expected_spheres;
+		for (uint32 i = 0u; i < count; i++)
+		{
+			if (scene.frustum.isAabbVisible(scene.centers.get(i), scene.extents.get(i)))
+				expected_aabbs.push_back(i);
+			if (scene.frustum.isSphereVisible(scene.centers.get(i), scene.radii[i]))
+				expected_spheres.push_back(i);
+		}
+		TST_CHECK(!expected_aabbs.empty() && expected_aabbs.size() < count);
+
+		std::vector<uint32> visible;
+		TST_CHECK(tsm::cullAabbs(scene.frustum, scene.centers, scene.extents, visible) == expected_aabbs.size());
+		TST_CHECK(visible == expected_aabbs);
+		TST_CHECK(tsm::cullSpheres(scene.frustum, scene.centers, scene.radii, visible) == expected_spheres.size());
+		TST_CHECK(visible == expected_spheres);
+
+		// Without a job system the parallel variants run inline
+		TST_CHECK(tsm::cullAabbsParallel(scene.frustum, scene.centers, scene.extents, visible) == expected_aabbs.size());
+		TST_CHECK(visible == expected_aabbs);
+
+		JobSystemScope job_system(3u);
+		TST_CHECK(tsm::cullAabbsParallel(scene.frustum, scene.centers, scene.extents, visible) == expected_aabbs.size());
+		TST_CHECK(visible == expected_aabbs);
+		TST_CHECK(tsm::cullSpheresParallel(scene.frustum, scene.centers, scene.radii, visible) == expected_spheres.size());
+		TST_CHECK(visible == expected_spheres);
+	}
+}
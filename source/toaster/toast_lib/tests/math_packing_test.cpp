@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "math/math_packing.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	// Not a multiple of any SIMD width, so the batch encoders' scalar remainder runs too
+	constexpr uint64 c_count{100'003u};
+
+	uint32 nextRandom(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return p_state;
+	}
+
+	float randomFloat(uint32 &p_state, const float p_min, const float p_max)
+	{
+		return p_min + (p_max - p_min) * static_cast<float>(nextRandom(p_state) >> 8u) / static_cast<float>(1u << 24u);
+	}
+
+	tsm::Float3Stream makeDirections(uint32 p_seed)
+	{
+		tsm::Float3Stream directions(c_count);
+		for (uint64 i = 0u; i < c_count; i++)
+		{
+			glm::vec3 direction;
+			do
+			{
+				direction = glm::vec3(randomFloat(p_seed, -1.0f, 1.0f), randomFloat(p_seed, -1.0f, 1.0f), randomFloat(p_seed, -1.0f, 1.0f));
+			}
+			while (glm::dot(direction, direction) < 1e-4f || glm::dot(direction, direction) > 1.0f);
+			directions.set(i, glm::normalize(direction));
+		}
+		// The folds and poles, where the octahedral mapping has its edges
+		const glm::vec3 edges[] = {{1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+								   {0.0f, 0.0f, -1.0f}, glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)), glm::normalize(glm::vec3(-1.0f, 1.0f, -1.0f))};
+		for (uint64 i = 0u; i < std::size(edges); i++)
+		{
+			directions.set(i, edges[i]);
+		}
+		return directions;
+	}
+
+	// atan2 stays accurate for the tiny angles, acos of the dot product doesn't
+	float angleDegrees(const glm::vec3 &p_a, const glm::vec3 &p_b)
+	{
+		return glm::degrees(std::atan2(glm::length(glm::cross(p_a, p_b)), glm::dot(p_a, p_b)));
+	}
+}
+
+// Every bound below is the one documented at the top of math_packing.hpp
+
+TST_TEST(packHalfError)
+{
+	// Every half converts back to itself, NaNs aside
+	for (uint32 half = 0u; half < 0x10000u; half++)
+	{
+		const float value = tsm::unpackHalf(static_cast<uint16>(half));
+		if (std::isnan(value))
+			TST_CHECK((half & 0x7c00u) == 0x7c00u && (half & 0x3ffu) != 0u && std::isnan(tsm::unpackHalf(tsm::packHalf(value))));
+		else
+			TST_CHECK(tsm::packHalf(value) == half);
+	}
+
+	uint32             state     = 31u;
+	float              max_error = 0.0f;
+	std::vector<float> values(c_count);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		// Spread over the whole half range, subnormals included
+		const float value = std::ldexp(randomFloat(state, -1.0f, 1.0f), static_cast<int>(nextRandom(state) % 42u) - 25);
+		values[i]         = value;
+
+		const float error = std::abs(tsm::unpackHalf(tsm::packHalf(value)) - value);
+		if (std::abs(value) >= 0x1p-14f)
+			max_error = std::max(max_error, error / std::abs(value));
+		else
+			TST_CHECK(error <= 0x1p-25f); // Half a subnormal step
+	}
+	std::printf("  half: max %.3g relative\n", max_error);
+	TST_CHECK(max_error <= 0x1p-11f);
+
+	TST_CHECK(tsm::packHalf(65504.0f) == 0x7bffu && tsm::packHalf(65520.0f) == 0x7c00u && tsm::packHalf(-1e10f) == 0xfc00u);
+	TST_CHECK(tsm::packHalf(std::numeric_limits<float>::infinity()) == 0x7c00u);
+	TST_CHECK(std::isnan(tsm::unpackHalf(tsm::packHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+	// The batch conversion matches the scalar one bit for bit
+	std::vector<uint16> packed(c_count);
+	std::vector<float>  unpacked(c_count);
+	tsm::packHalf(values.data(), c_count, packed.data());
+	tsm::unpackHalf(packed.data(), c_count, unpacked.data());
+	bool same = true;
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		same &= packed[i] == tsm::packHalf(values[i]) && std::bit_cast<uint32>(unpacked[i]) == std::bit_cast<uint32>(tsm::unpackHalf(packed[i]));
+	}
+	TST_CHECK(same);
+}
+
+TST_TEST(packNormalizedError)
+{
+	float max_snorm8 = 0.0f, max_snorm16 = 0.0f, max_unorm8 = 0.0f, max_unorm16 = 0.0f;
+	for (uint32 i = 0u; i <= 200'000u; i++)
+	{
+		const float snorm = -1.0f + 2.0f * static_cast<float>(i) / 200'000.0f;
+		const float unorm = static_cast<float>(i) / 200'000.0f;
+		max_snorm8        = std::max(max_snorm8, std::abs(tsm::unpackSnorm8(tsm::packSnorm8(snorm)) - snorm));
+		max_snorm16       = std::max(max_snorm16, std::abs(tsm::unpackSnorm16(tsm::packSnorm16(snorm)) - snorm));
+		max_unorm8        = std::max(max_unorm8, std::abs(tsm::unpackUnorm8(tsm::packUnorm8(unorm)) - unorm));
+		max_unorm16       = std::max(max_unorm16, std::abs(tsm::unpackUnorm16(tsm::packUnorm16(unorm)) - unorm));
+	}
+	// A float ulp of slack for the division in the decode
+	constexpr float c_slack{1e-7f};
+	TST_CHECK(max_snorm8 <= 0.5f / 127.0f + c_slack);
+	TST_CHECK(max_snorm16 <= 0.5f / 32767.0f + c_slack);
+	TST_CHECK(max_unorm8 <= 0.5f / 255.0f + c_slack);
+	TST_CHECK(max_unorm16 <= 0.5f / 65535.0f + c_slack);
+
+	// Clamped on the way in, the most negative value decodes to -1
+	TST_CHECK(tsm::packSnorm8(-3.0f) == -127 && tsm::packUnorm16(2.0f) == 65535u && tsm::packUnorm8(-1.0f) == 0u);
+	TST_CHECK(tsm::unpackSnorm8(-128) == -1.0f && tsm::unpackSnorm16(-32768) == -1.0f);
+}
+
+TST_TEST(pack1010102Error)
+{
+	uint32    state = 5u;
+	glm::vec4 max_unorm(0.0f), max_snorm(0.0f);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		const glm::vec4 unorm(randomFloat(state, 0.0f, 1.0f), randomFloat(state, 0.0f, 1.0f), randomFloat(state, 0.0f, 1.0f), randomFloat(state, 0.0f, 1.0f));
+		const glm::vec4 snorm = unorm * 2.0f - 1.0f;
+		max_unorm             = glm::max(max_unorm, glm::abs(tsm::unpackUnorm1010102(tsm::packUnorm1010102(unorm)) - unorm));
+
+		// The 2 bit snorm w only holds -1, 0 and 1
+		const glm::vec4 decoded = tsm::unpackSnorm1010102(tsm::packSnorm1010102(snorm));
+		max_snorm               = glm::max(max_snorm, glm::abs(glm::vec4(glm::vec3(decoded - snorm), 0.0f)));
+		TST_CHECK(decoded.w == std::nearbyint(snorm.w));
+	}
+	constexpr float c_slack{1e-6f};
+	TST_CHECK(max_unorm.x <= 0.5f / 1023.0f + c_slack && max_unorm.y <= 0.5f / 1023.0f + c_slack && max_unorm.z <= 0.5f / 1023.0f + c_slack);
+	TST_CHECK(max_unorm.w <= 0.5f / 3.0f + c_slack);
+	TST_CHECK(max_snorm.x <= 0.5f / 511.0f + c_slack && max_snorm.y <= 0.5f / 511.0f + c_slack && max_snorm.z <= 0.5f / 511.0f + c_slack);
+}
+
+TST_TEST(packOctahedralError)
+{
+	const tsm::Float3Stream directions = makeDirections(1234u);
+
+	float max16 = 0.0f, max8 = 0.0f, max_tangent = 0.0f;
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		const glm::vec3 direction = directions.get(i);
+		max16                     = std::max(max16, angleDegrees(direction, tsm::unpackOctahedral16(tsm::packOctahedral16(direction))));
+		max8                      = std::max(max8, angleDegrees(direction, tsm::unpackOctahedral8(tsm::packOctahedral8(direction))));
+
+		const float     sign    = (i & 1u) != 0u ? -1.0f : 1.0f;
+		const glm::vec4 tangent = tsm::unpackOctahedralTangent(tsm::packOctahedralTangent(direction, sign));
+		max_tangent             = std::max(max_tangent, angleDegrees(direction, glm::vec3(tangent)));
+		TST_CHECK(tangent.w == sign);
+	}
+	std::printf("  octahedral: 16 bit max %.4f, 8 bit max %.3f, tangent max %.4f degrees\n", max16, max8, max_tangent);
+	// The documented maxima were sampled the same way and are rounded to two digits, allow the next one up
+	TST_CHECK(max16 <= 0.0038f);
+	TST_CHECK(max8 <= 0.95f);
+	TST_CHECK(max_tangent <= 0.0057f);
+
+	// The measured error is the same one, in radians
+	TST_CHECK(std::abs(glm::degrees(tsm::measureOctahedral16Error(directions).max) - max16) <= 1e-4f);
+	TST_CHECK(std::abs(glm::degrees(tsm::measureOctahedral8Error(directions).max) - max8) <= 1e-3f);
+
+	// The batch encoders write the scalar encodings, p_stride bytes apart
+	constexpr uint64   c_stride{12u};
+	std::vector<uint8> normals(c_count * c_stride), tangents(c_count * c_stride);
+	std::vector<float> signs(c_count);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		signs[i] = (i % 3u) == 0u ? -1.0f : 1.0f;
+	}
+	tsm::encodeOctahedral16(directions, normals.data(), c_stride);
+	tsm::encodeOctahedralTangents(directions, signs.data(), tangents.data(), c_stride);
+
+	bool same = true;
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		uint32 normal, tangent;
+		std::memcpy(&normal, normals.data() + i * c_stride, sizeof(uint32));
+		std::memcpy(&tangent, tangents.data() + i * c_stride, sizeof(uint32));
+		same &= normal == tsm::packOctahedral16(directions.get(i)) && tangent == tsm::packOctahedralTangent(directions.get(i), signs[i]);
+	}
+	TST_CHECK(same);
+}
+
+TST_TEST(quantizationGridError)
+{
+	const glm::vec3             bounds_min(-120.5f, 3.25f, 1000.0f);
+	const glm::vec3             bounds_max(80.0f, 3.5f, 1650.0f);
+	const tsm::QuantizationGrid grid = tsm::QuantizationGrid::fromBounds(bounds_min, bounds_max);
+
+	uint32            state = 99u;
+	tsm::Float3Stream positions(c_count);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		positions.set(i, glm::vec3(randomFloat(state, bounds_min.x, bounds_max.x), randomFloat(state, bounds_min.y, bounds_max.y),
+								   randomFloat(state, bounds_min.z, bounds_max.z)));
+	}
+	positions.set(0u, bounds_min);
+	positions.set(1u, bounds_max);
+
+	// Half a step, plus the float rounding of origin + unorm * extent at the grid's magnitude
+	const glm::vec3 magnitude = glm::max(glm::abs(bounds_min), glm::abs(bounds_max));
+	const glm::vec3 bound     = grid.getMaxError() + magnitude * 2.0f * std::numeric_limits<float>::epsilon();
+
+	glm::vec3 max_error(0.0f);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		max_error = glm::max(max_error, glm::abs(grid.dequantize(grid.quantize(positions.get(i))) - positions.get(i)));
+	}
+	std::printf("  grid: max %.3g %.3g %.3g, bound %.3g %.3g %.3g\n", max_error.x, max_error.y, max_error.z, bound.x, bound.y, bound.z);
+	TST_CHECK(max_error.x <= bound.x && max_error.y <= bound.y && max_error.z <= bound.z);
+
+	// Outside the bounds clamps to the edge
+	TST_CHECK(grid.quantize(bounds_min - 10.0f) == glm::u16vec3(0u) && grid.quantize(bounds_max + 10.0f) == glm::u16vec3(65535u));
+
+	constexpr uint64   c_stride{8u};
+	std::vector<uint8> quantized(c_count * c_stride);
+	tsm::quantizePositions(positions, grid, quantized.data(), c_stride);
+	bool same = true;
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		glm::u16vec3 value;
+		std::memcpy(&value, quantized.data() + i * c_stride, sizeof(value));
+		same &= value == grid.quantize(positions.get(i));
+	}
+	TST_CHECK(same);
+	TST_CHECK(tsm::measureQuantizationError(positions, grid).max <= glm::length(bound));
+}
@@ -0,0 +1,91 @@
+#include <cfloat>
+#include <vector>
+
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_bench.hpp"
+#include "math/math_stream.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	constexpr uint64 c_vertexCount{10'000'000u};
+
+	// The engine's vertex layout at the time of writing, positions and normals interleaved with the rest
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texCoord;
+		glm::vec4 tangent;
+	};
+}
+
+// Transforming a 10M vertex mesh: positions and normals through a model matrix, then the new bounds. The streams
+// against a scalar glm loop over the interleaved vertices, with and without the gather from the vertex array
+TST_BENCHMARK(float3Stream10MVertices)
+{
+	std::vector<Vertex> vertices(c_vertexCount);
+	for (uint64 i = 0u; i < c_vertexCount; i++)
+	{
+		const float t        = static_cast<float>(i);
+		vertices[i].position = glm::vec3(std::sin(t) * 100.0f, t * 1e-4f, std::cos(t) * 100.0f);
+		vertices[i].normal   = glm::normalize(glm::vec3(std::sin(t), 0.25f, std::cos(t)));
+	}
+
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, -5.0f));
+	model           = glm::scale(glm::rotate(model, 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(1.0f, 2.0f, 1.0f));
+	const glm::mat4 normal_matrix = glm::inverseTranspose(model);
+
+	std::printf("%llu vertices:\n", static_cast<unsigned long long>(c_vertexCount));
+
+	std::vector<glm::vec3> out_positions(c_vertexCount);
+	std::vector<glm::vec3> out_normals(c_vertexCount);
+	const double glm_ns = test::measureNs([&]
+	{
+		const glm::mat3 normal3(normal_matrix);
+		glm::vec3       bounds_min(FLT_MAX), bounds_max(-FLT_MAX);
+		for (uint64 i = 0u; i < c_vertexCount; i++)
+		{
+			out_positions[i] = glm::vec3(model * glm::vec4(vertices[i].position, 1.0f));
+			out_normals[i]   = glm::normalize(normal3 * vertices[i].normal);
+			bounds_min       = glm::min(bounds_min, out_positions[i]);
+			bounds_max       = glm::max(bounds_max, out_positions[i]);
+		}
+		test::doNotOptimize(bounds_min);
+		test::doNotOptimize(bounds_max);
+		test::doNotOptimize(out_positions);
+		test::doNotOptimize(out_normals);
+	}, 3u);
+
+	tsm::Float3Stream positions(c_vertexCount);
+	tsm::Float3Stream normals(c_vertexCount);
+	tsm::Float3Stream transformed_positions(c_vertexCount);
+	tsm::Float3Stream transformed_normals(c_vertexCount);
+
+	const double gather_ns = test::measureNs([&]
+	{
+		tsm::gatherFromAoS(&vertices[0].position, sizeof(Vertex), c_vertexCount, positions);
+		tsm::gatherFromAoS(&vertices[0].normal, sizeof(Vertex), c_vertexCount, normals);
+	}, 3u);
+
+	const tsm::float4x4 tsm_model(model);
+	const tsm::float4x4 tsm_normal_matrix(normal_matrix);
+	const double        stream_ns = test::measureNs([&]
+	{
+		tsm::transformPoints(tsm_model, positions, transformed_positions);
+		tsm::transformNormals(tsm_normal_matrix, normals, transformed_normals);
+
+		glm::vec3 bounds_min, bounds_max;
+		tsm::computeBounds(transformed_positions, bounds_min, bounds_max);
+		test::doNotOptimize(bounds_min);
+		test::doNotOptimize(bounds_max);
+	}, 3u);
+
+	const double items = static_cast<double>(c_vertexCount);
+	test::report("glm, interleaved", glm_ns, items);
+	test::report("Float3Stream, kernels only", stream_ns, items);
+	test::report("Float3Stream, gather + kernels", gather_ns + stream_ns, items);
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_test.hpp"
+#include "math/math_stream.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	// Not a multiple of any SIMD width, so the scalar remainder runs too
+	constexpr uint64 c_count{100'003u};
+
+	uint32 nextRandom(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return p_state;
+	}
+
+	float randomFloat(uint32 &p_state, const float p_min, const float p_max)
+	{
+		return p_min + (p_max - p_min) * static_cast<float>(nextRandom(p_state) >> 8u) / static_cast<float>(1u << 24u);
+	}
+
+	tsm::Float3Stream makePositions()
+	{
+		uint32            state = 12345u;
+		tsm::Float3Stream stream(c_count);
+		for (uint64 i = 0u; i < c_count; i++)
+		{
+			stream.set(i, {randomFloat(state, -1000.0f, 1000.0f), randomFloat(state, -1000.0f, 1000.0f), randomFloat(state, -1000.0f, 1000.0f)});
+		}
+		return stream;
+	}
+
+	glm::mat4 makeModel()
+	{
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(12.5f, -3.25f, 700.0f));
+		model           = glm::rotate(model, 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+		return glm::scale(model, glm::vec3(2.0f, 0.5f, 1.25f));
+	}
+
+	// Size of one ulp at p_magnitude
+	float ulpAt(const float p_magnitude)
+	{
+		const float magnitude = std::max(std::abs(p_magnitude), std::numeric_limits<float>::min());
+		return std::nextafter(magnitude, std::numeric_limits<float>::infinity()) - magnitude;
+	}
+
+	// Error in ulps of the largest magnitude that went into the result. A sum of products can cancel down to
+	// anything, so ulps of the result itself say nothing about the kernel's precision
+	float ulpError(const float p_value, const float p_expected, const float p_magnitude)
+	{
+		return std::abs(p_value - p_expected) / ulpAt(p_magnitude);
+	}
+}
+
+// The kernels against the same math in scalar glm. The bounds are the documented ones in math_stream.hpp
+TST_TEST(float3StreamTransformPointsUlp)
+{
+	const glm::mat4         model = makeModel();
+	const tsm::Float3Stream in    = makePositions();
+	tsm::Float3Stream       out;
+	tsm::transformPoints(tsm::float4x4(model), in, out);
+
+	TST_CHECK(out.size() == c_count);
+
+	float max_error = 0.0f;
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		const glm::vec3 p        = in.get(i);
+		const glm::vec3 expected = glm::vec3(model * glm::vec4(p, 1.0f));
+		const glm::vec3 value    = out.get(i);
+
+		for (int row = 0; row < 3; row++)
+		{
+			const float magnitude = std::abs(model[0][row] * p.x) + std::abs(model[1][row] * p.y) + std::abs(model[2][row] * p.z) + std::abs(model[3][row]);
+			max_error             = std::max(max_error, ulpError(value[row], expected[row], magnitude));
+		}
+	}
+
+	std::printf("  transformPoints: max %.2f ulps\n", max_error);
+	TST_CHECK(max_error <= 4.0f);
+}
+
+TST_TEST(float3StreamTransformNormalsUlp)
+{
+	const glm::mat4 normal_matrix = glm::inverseTranspose(makeModel());
+
+	uint32            state = 777u;
+	tsm::Float3Stream in(c_count);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		in.set(i, glm::normalize(glm::vec3(randomFloat(state, -1.0f, 1.0f), randomFloat(state, -1.0f, 1.0f), randomFloat(state, -1.0f, 1.0f) + 1e-3f)));
+	}
+	// Zero length normals stay zero
+	in.set(5u, glm::vec3(0.0f));
+
+	tsm::Float3Stream out;
+	tsm::transformNormals(tsm::float4x4(normal_matrix), in, out);
+
+	float max_error = 0.0f;
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		if (i == 5u)
+			continue;
+
+		const glm::vec3 expected = glm::normalize(glm::mat3(normal_matrix) * in.get(i));
+		const glm::vec3 value    = out.get(i);
+
+		// Unit length results, measured in ulps of 1
+		for (int axis = 0; axis < 3; axis++)
+		{
+			max_error = std::max(max_error, ulpError(value[axis], expected[axis], 1.0f));
+		}
+	}
+
+	std::printf("  transformNormals: max %.2f ulps\n", max_error);
+	TST_CHECK(max_error <= 8.0f);
+	TST_CHECK(out.get(5u) == glm::vec3(0.0f));
+}
+
+TST_TEST(float3StreamDotAndBounds)
+{
+	const tsm::Float3Stream a = makePositions();
+	tsm::Float3Stream       b(c_count);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		b.set(i, a.get(c_count - 1u - i) * 0.001f);
+	}
+
+	const glm::vec3    direction = glm::normalize(glm::vec3(0.3f, -0.8f, 0.5f));
+	std::vector<float> dots(c_count);
+	std::vector<float> direction_dots(c_count);
+	tsm::dot(a, b, dots.data());
+	tsm::dot(a, direction, direction_dots.data());
+
+	float     max_error = 0.0f;
+	glm::vec3 expected_min(std::numeric_limits<float>::max());
+	glm::vec3 expected_max(-std::numeric_limits<float>::max());
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		const glm::vec3 pa = a.get(i);
+		const glm::vec3 pb = b.get(i);
+
+		const float magnitude = glm::dot(glm::abs(pa), glm::abs(pb));
+		max_error             = std::max(max_error, ulpError(dots[i], glm::dot(pa, pb), magnitude));
+
+		const float direction_magnitude = glm::dot(glm::abs(pa), glm::abs(direction));
+		max_error                       = std::max(max_error, ulpError(direction_dots[i], glm::dot(pa, direction), direction_magnitude));
+
+		expected_min = glm::min(expected_min, pa);
+		expected_max = glm::max(expected_max, pa);
+	}
+
+	std::printf("  dot: max %.2f ulps\n", max_error);
+	TST_CHECK(max_error <= 3.0f);
+
+	// Min and max are exact
+	glm::vec3 bounds_min, bounds_max;
+	tsm::computeBounds(a, bounds_min, bounds_max);
+	TST_CHECK(bounds_min == expected_min);
+	TST_CHECK(bounds_max == expected_max);
+}
+
+TST_TEST(float3StreamGatherScatterRoundTrip)
+{
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	const tsm::Float3Stream positions = makePositions();
+
+	std::vector<Vertex> vertices(c_count);
+	tsm::scatterToAoS(positions, &vertices[0].position, sizeof(Vertex));
+
+	tsm::Float3Stream gathered;
+	tsm::gatherFromAoS(&vertices[0].position, sizeof(Vertex), c_count, gathered);
+
+	bool equal = gathered.size() == c_count;
+	for (uint64 i = 0u; i < c_count && equal; i++)
+	{
+		equal = gathered.get(i) == positions.get(i) && vertices[i].position == positions.get(i);
+	}
+	TST_CHECK(equal);
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "toast_test.hpp"
+#include "math/math_vector.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	bool nearlyEqual(const glm::vec4 &p_a, const glm::vec4 &p_b, const float p_tolerance = 1e-5f)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (std::abs(p_a[i] - p_b[i]) > p_tolerance * std::max(1.0f, std::abs(p_b[i])))
+				return false;
+		}
+		return true;
+	}
+
+	bool nearlyEqual(const glm::mat4 &p_a, const glm::mat4 &p_b, const float p_tolerance = 1e-5f)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (!nearlyEqual(p_a[i], p_b[i], p_tolerance))
+				return false;
+		}
+		return true;
+	}
+
+	// Rotation, scale and translation, all different per index
+	glm::mat4 makeModel(const uint32 p_index)
+	{
+		const float     t     = static_cast<float>(p_index);
+		const glm::vec3 axis  = glm::normalize(glm::vec3(std::sin(t), std::cos(t * 0.7f), 0.5f));
+		glm::mat4       model = glm::translate(glm::mat4(1.0f), glm::vec3(t * 0.1f, -t * 0.2f, t * 0.05f));
+		model                 = glm::rotate(model, t * 0.37f, axis);
+		return glm::scale(model, glm::vec3(1.0f + 0.01f * (p_index % 7u), 0.5f + 0.02f * (p_index % 5u), 1.0f));
+	}
+}
+
+TST_TEST(float4x4MatchesGlm)
+{
+	const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 4.0f, -10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	for (uint32 i = 0u; i < 1'000u; i++)
+	{
+		const glm::mat4 model = makeModel(i);
+		const glm::vec4 point(static_cast<float>(i) * 0.3f, 1.0f, -2.0f, 1.0f);
+
+		const tsm::float4x4 mvp = tsm::float4x4(proj) * tsm::float4x4(view) * tsm::float4x4(model);
+		TST_CHECK(nearlyEqual(mvp.toGlm(), proj * view * model));
+		TST_CHECK(nearlyEqual((mvp * tsm::float4(point)).toGlm(), proj * view * model * point, 1e-4f));
+
+		TST_CHECK(nearlyEqual(tsm::inverse(tsm::float4x4(model)).toGlm(), glm::inverse(model), 1e-4f));
+		TST_CHECK(nearlyEqual(tsm::inverseAffine(tsm::float4x4(model)).toGlm(), glm::inverse(model), 1e-4f));
+		TST_CHECK(nearlyEqual(tsm::transpose(tsm::float4x4(model)).toGlm(), glm::transpose(model)));
+	}
+}
+
+TST_TEST(quatMatchesGlm)
+{
+	for (uint32 i = 0u; i < 1'000u; i++)
+	{
+		const float     t    = static_cast<float>(i);
+		const glm::vec3 axis = glm::normalize(glm::vec3(std::sin(t), 1.0f, std::cos(t)));
+		const glm::quat a    = glm::angleAxis(t * 0.1f, axis);
+		const glm::quat b    = glm::angleAxis(-t * 0.03f, glm::vec3(0.0f, 0.0f, 1.0f));
+		const glm::vec4 v(t, -1.0f, 2.0f, 1.0f);
+
+		const tsm::quat ta = tsm::quat::fromAxisAngle(axis, t * 0.1f);
+		const tsm::quat tb(b);
+
+		const glm::quat product = (ta * tb).toGlm();
+		const glm::quat expected = a * b;
+		TST_CHECK(nearlyEqual(glm::vec4(product.x, product.y, product.z, product.w), glm::vec4(expected.x, expected.y, expected.z, expected.w), 1e-5f));
+		TST_CHECK(nearlyEqual(ta.rotate(tsm::float4(v)).toGlm(), glm::vec4(a * glm::vec3(v), 1.0f), 1e-4f));
+		TST_CHECK(nearlyEqual(ta.toMatrix().toGlm(), glm::mat4_cast(a), 1e-5f));
+	}
+}
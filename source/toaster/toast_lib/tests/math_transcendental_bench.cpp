@@ -0,0 +1,86 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "math/math_transcendental.hpp"
+
+using namespace toaster;
+
+// 1M inputs per function: the batch functions, the scalar ones in a loop and std:: in a loop
+TST_BENCHMARK(transcendentalFunctions)
+{
+	constexpr uint64 c_count{1u << 20u};
+
+	uint32 state = 2463534242u;
+	const auto next = [&state](const float p_min, const float p_max)
+	{
+		state ^= state << 13u;
+		state ^= state >> 17u;
+		state ^= state << 5u;
+		return p_min + (p_max - p_min) * static_cast<float>(state >> 8u) / static_cast<float>(1u << 24u);
+	};
+
+	std::vector<float> angles(c_count), exponents(c_count), positives(c_count), signed_values(c_count);
+	for (uint64 i = 0u; i < c_count; i++)
+	{
+		angles[i]        = next(-100.0f, 100.0f);
+		exponents[i]     = next(-80.0f, 80.0f);
+		positives[i]     = next(1e-3f, 1e4f);
+		signed_values[i] = next(-1e3f, 1e3f);
+	}
+
+	std::vector<float> out(c_count), out_2(c_count);
+	const double       items = static_cast<double>(c_count);
+
+	const auto compare = [&](const char *p_name, auto p_batch, auto p_scalar, auto p_std)
+	{
+		std::printf("%s:\n", p_name);
+		test::report("tsm, batch", test::measureNs([&]
+		{
+			p_batch();
+			test::doNotOptimize(out);
+		}), items);
+		test::report("tsm, scalar", test::measureNs([&]
+		{
+			for (uint64 i = 0u; i < c_count; i++)
+			{
+				out[i] = p_scalar(i);
+			}
+			test::doNotOptimize(out);
+		}), items);
+		test::report("std", test::measureNs([&]
+		{
+			for (uint64 i = 0u; i < c_count; i++)
+			{
+				out[i] = p_std(i);
+			}
+			test::doNotOptimize(out);
+		}), items);
+	};
+
+	compare("sin", [&] { tsm::sin(angles.data(), c_count, out.data()); }, [&](const uint64 i) { return tsm::sin(angles[i]); },
+			[&](const uint64 i) { return std::sin(angles[i]); });
+	compare("sincos", [&] { tsm::sincos(angles.data(), c_count, out.data(), out_2.data()); },
+			[&](const uint64 i)
+			{
+				float c;
+				tsm::sincos(angles[i], out_2[i], c);
+				return c;
+			},
+			[&](const uint64 i)
+			{
+				out_2[i] = std::sin(angles[i]);
+				return std::cos(angles[i]);
+			});
+	compare("exp", [&] { tsm::exp(exponents.data(), c_count, out.data()); }, [&](const uint64 i) { return tsm::exp(exponents[i]); },
+			[&](const uint64 i) { return std::exp(exponents[i]); });
+	compare("log", [&] { tsm::log(positives.data(), c_count, out.data()); }, [&](const uint64 i) { return tsm::log(positives[i]); },
+			[&](const uint64 i) { return std::log(positives[i]); });
+	compare("pow", [&] { tsm::pow(positives.data(), angles.data(), c_count, out.data()); },
+			[&](const uint64 i) { return tsm::pow(positives[i], angles[i] * 0.1f); }, [&](const uint64 i) { return std::pow(positives[i], angles[i] * 0.1f); });
+	compare("atan2", [&] { tsm::atan2(signed_values.data(), angles.data(), c_count, out.data()); },
+			[&](const uint64 i) { return tsm::atan2(signed_values[i], angles[i]); }, [&](const uint64 i) { return std::atan2(signed_values[i], angles[i]); });
+	compare("rsqrt", [&] { tsm::rsqrt(positives.data(), c_count, out.data()); }, [&](const uint64 i) { return tsm::rsqrt(positives[i]); },
+			[&](const uint64 i) { return 1.0f / std::sqrt(positives[i]); });
+}
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "jobs/job_system.hpp"
+#include "math/math_transcendental.hpp"
+
+using namespace toaster;
+
+// Every finite float of each function's documented domain through the batch functions, against the same function in
+// double. The bounds are the ones documented in math_transcendental.hpp. One sweep is a few billion calls spread over
+// the job system, a minute per sweep on a single core, so these live in their own executable
+namespace
+{
+	constexpr uint64 c_chunkSize{1u << 16u};
+	constexpr uint64 c_chunkCount{(1ull << 32u) / c_chunkSize};
+
+	// Size of one ulp at the correctly rounded result
+	double ulpAt(const double p_expected)
+	{
+		const float magnitude = std::max(std::abs(static_cast<float>(p_expected)), std::numeric_limits<float>::denorm_min());
+		if (std::isinf(magnitude))
+			return static_cast<double>(std::numeric_limits<float>::max()) - std::nextafter(std::numeric_limits<float>::max(), 0.0f);
+		return static_cast<double>(std::nextafter(magnitude, std::numeric_limits<float>::infinity())) - magnitude;
+	}
+
+	struct SweepResult
+	{
+		double maxUlps{0.0};
+		float  worstInput{0.0f};
+		uint64 count{0u};
+		bool   specialsOk{true}; // Out of domain and special inputs gave the documented results
+	};
+
+	// p_batch(in, count, out) runs the function under test and p_reference(x) returns the double result for inputs
+	// p_in_domain(x) accepts. p_special(x, result) checks the other inputs. The error of each input is divided by
+	// p_scale(x), for bounds that grow with the input
+	template<typename Batch, typename Reference, typename InDomain, typename Special, typename Scale>
+	SweepResult sweepAllFloats(Batch p_batch, Reference p_reference, InDomain p_in_domain, Special p_special, Scale p_scale)
+	{
+		SweepResult result;
+		std::mutex  result_mutex;
+
+		jobs::parallelFor(0u, c_chunkCount, [&](const uint64 p_begin, const uint64 p_end)
+		{
+			std::vector<float> in(c_chunkSize);
+			std::vector<float> out(c_chunkSize);
+
+			SweepResult local;
+			for (uint64 chunk = p_begin; chunk < p_end; chunk++)
+			{
+				for (uint64 i = 0u; i < c_chunkSize; i++)
+				{
+					in[i] = std::bit_cast<float>(static_cast<uint32>(chunk * c_chunkSize + i));
+				}
+				p_batch(in.data(), c_chunkSize, out.data());
+
+				for (uint64 i = 0u; i < c_chunkSize; i++)
+				{
+					if (!p_in_domain(in[i]))
+					{
+						local.specialsOk &= p_special(in[i], out[i]);
+						continue;
+					}
+
+					// The exact match also covers results that correctly round to infinity. An overflow that comes early
+					// counts as 2^128, one ulp past FLT_MAX
+					const double expected = p_reference(static_cast<double>(in[i]));
+					const double actual   = std::isinf(out[i]) ? std::copysign(0x1p128, out[i]) : out[i];
+					const double error    = static_cast<float>(expected) == out[i] ? 0.0 : std::abs(actual - expected) / ulpAt(expected) / p_scale(in[i]);
+					if (!(error <= local.maxUlps))
+					{
+						local.maxUlps    = std::isnan(error) ? INFINITY : error;
+						local.worstInput = in[i];
+					}
+					local.count++;
+				}
+			}
+
+			std::lock_guard lock(result_mutex);
+			if (local.maxUlps > result.maxUlps)
+			{
+				result.maxUlps    = local.maxUlps;
+				result.worstInput = local.worstInput;
+			}
+			result.count += local.count;
+			result.specialsOk &= local.specialsOk;
+		}, 16u);
+		return result;
+	}
+
+	template<typename Batch, typename Reference, typename InDomain, typename Special>
+	SweepResult sweepAllFloats(Batch p_batch, Reference p_reference, InDomain p_in_domain, Special p_special)
+	{
+		return sweepAllFloats(p_batch, p_reference, p_in_domain, p_special, [](float) { return 1.0; });
+	}
+
+	void printResult(const char *p_name, const SweepResult &p_result)
+	{
+		std::printf("  %-24s max %.3f ulps at %.9g over %llu inputs\n", p_name, p_result.maxUlps, p_result.worstInput,
+					static_cast<unsigned long long>(p_result.count));
+	}
+
+	struct JobSystemScope
+	{
+		JobSystemScope() { jobs::initialize({}); }
+		~JobSystemScope() { jobs::shutdown(); }
+	};
+
+	bool isFinite(const float p_x) { return std::isfinite(p_x); }
+}
+
+TST_TEST(transcendentalSinCosUlp)
+{
+	JobSystemScope job_system;
+
+	const auto in_domain = [](const float p_x) { return std::abs(p_x) <= 8192.0f; };
+	// Beyond 8192 only the range is promised
+	const auto special = [](const float p_x, const float p_result)
+	{
+		return std::isfinite(p_x) ? p_result >= -1.0f && p_result <= 1.0f : std::isnan(p_result);
+	};
+	// The tighter 1.6 ulps within pi are scaled up to the 2.5 of the whole domain, one sweep checks both
+	const auto scale = [](const float p_x) { return std::abs(p_x) <= 3.14159265f ? 1.6 / 2.5 : 1.0; };
+
+	const SweepResult sin_result = sweepAllFloats([](const float *p_in, uint64 p_count, float *p_out) { tsm::sin(p_in, p_count, p_out); },
+												  [](const double p_x) { return std::sin(p_x); }, in_domain, special, scale);
+	printResult("sin", sin_result);
+	TST_CHECK(sin_result.maxUlps <= 2.5);
+	TST_CHECK(sin_result.specialsOk);
+
+	const SweepResult cos_result = sweepAllFloats([](const float *p_in, uint64 p_count, float *p_out) { tsm::cos(p_in, p_count, p_out); },
+												  [](const double p_x) { return std::cos(p_x); }, in_domain, special);
+	printResult("cos", cos_result);
+	TST_CHECK(cos_result.maxUlps <= 2.5);
+	TST_CHECK(cos_result.specialsOk);
+
+	// sincos is the same kernel, spot check that both outputs agree with the single ones
+	const std::vector<float> inputs{0.0f, -0.0f, 1.0f, -2.5f, 100.0f, 8191.9f, 1e-30f};
+	std::vector<float>       s(inputs.size()), c(inputs.size()), s_ref(inputs.size()), c_ref(inputs.size());
+	tsm::sincos(inputs.data(), inputs.size(), s.data(), c.data());
+	tsm::sin(inputs.data(), inputs.size(), s_ref.data());
+	tsm::cos(inputs.data(), inputs.size(), c_ref.data());
+	TST_CHECK(s == s_ref && c == c_ref);
+}
+
+TST_TEST(transcendentalExpLogUlp)
+{
+	JobSystemScope job_system;
+
+	const SweepResult exp_result = sweepAllFloats([](const float *p_in, uint64 p_count, float *p_out) { tsm::exp(p_in, p_count, p_out); },
+												  [](const double p_x) { return std::exp(p_x); },
+												  [](const float p_x) { return p_x >= -103.972084f && p_x <= 88.7228391f; },
+												  [](const float p_x, const float p_result)
+												  {
+													  if (std::isnan(p_x))
+														  return std::isnan(p_result);
+													  return p_x < 0.0f ? p_result == 0.0f : p_result == INFINITY;
+												  });
+	printResult("exp", exp_result);
+	TST_CHECK(exp_result.maxUlps <= 1.1);
+	TST_CHECK(exp_result.specialsOk);
+
+	const SweepResult log_result = sweepAllFloats([](const float *p_in, uint64 p_count, float *p_out) { tsm::log(p_in, p_count, p_out); },
+												  [](const double p_x) { return std::log(p_x); },
+												  [](const float p_x) { return p_x > 0.0f && std::isfinite(p_x); },
+												  [](const float p_x, const float p_result)
+												  {
+													  if (p_x == 0.0f)
+														  return p_result == -INFINITY;
+													  return p_x == INFINITY ? p_result == INFINITY : std::isnan(p_result);
+												  });
+	printResult("log", log_result);
+	TST_CHECK(log_result.maxUlps <= 1.0);
+	TST_CHECK(log_result.specialsOk);
+}
+
+TST_TEST(transcendentalRsqrtUlp)
+{
+	JobSystemScope job_system;
+
+	const SweepResult result = sweepAllFloats([](const float *p_in, uint64 p_count, float *p_out) { tsm::rsqrt(p_in, p_count, p_out); },
+											  [](const double p_x) { return 1.0 / std::sqrt(p_x); },
+											  [](const float p_x) { return p_x >= std::numeric_limits<float>::min() && std::isfinite(p_x); },
+											  [](const float p_x, const float p_result)
+											  {
+												  // Subnormal inputs count as +-0 and give +-infinity, AVX-512 computes them. The sign of 0 is
+												  // kept like 1 / std::sqrt(-0.0f)
+												  if (std::abs(p_x) < std::numeric_limits<float>::min())
+													  return std::signbit(p_x) ? p_result == -INFINITY || std::isnan(p_result) : p_result >= 0x1p63f;
+												  return p_x == INFINITY ? p_result == 0.0f : std::isnan(p_result);
+											  });
+	printResult("rsqrt", result);
+	TST_CHECK(result.maxUlps <= 4.0);
+	TST_CHECK(result.specialsOk);
+}
+
+// Two argument functions sweep every finite float in one argument against a handful of values for the other
+TST_TEST(transcendentalAtan2Ulp)
+{
+	JobSystemScope job_system;
+
+	for (const float other: {1.0f, -7.5e4f})
+	{
+		const SweepResult over_y = sweepAllFloats([other](const float *p_in, uint64 p_count, float *p_out)
+		{
+			const std::vector<float> x(p_count, other);
+			tsm::atan2(p_in, x.data(), p_count, p_out);
+		}, [other](const double p_y) { return std::atan2(p_y, static_cast<double>(other)); }, isFinite, [](float, float) { return true; });
+
+		const SweepResult over_x = sweepAllFloats([other](const float *p_in, uint64 p_count, float *p_out)
+		{
+			const std::vector<float> y(p_count, other);
+			tsm::atan2(y.data(), p_in, p_count, p_out);
+		}, [other](const double p_x) { return std::atan2(static_cast<double>(other), p_x); }, isFinite, [](float, float) { return true; });
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "atan2(y, %g)", other);
+		printResult(name, over_y);
+		std::snprintf(name, sizeof(name), "atan2(%g, x)", other);
+		printResult(name, over_x);
+
+		TST_CHECK(over_y.maxUlps <= 3.0);
+		TST_CHECK(over_x.maxUlps <= 3.0);
+	}
+
+	// Signed zeros and infinities like std::atan2
+	const float special_y[]{0.0f, -0.0f, 0.0f, -0.0f, INFINITY, -INFINITY, INFINITY, 1.0f, -1.0f};
+	const float special_x[]{0.0f, 0.0f, -0.0f, -0.0f, INFINITY, INFINITY, -INFINITY, -INFINITY, -INFINITY};
+	float       special_out[std::size(special_y)];
+	tsm::atan2(special_y, special_x, std::size(special_y), special_out);
+	for (uint64 i = 0u; i < std::size(special_y); i++)
+	{
+		const float expected = std::atan2(special_y[i], special_x[i]);
+		TST_CHECK(std::abs(special_out[i] - expected) <= 3.0f * std::abs(std::nextafter(expected, INFINITY) - expected)
+			&& std::signbit(special_out[i]) == std::signbit(expected));
+	}
+}
+
+TST_TEST(transcendentalPowUlp)
+{
+	JobSystemScope job_system;
+
+	for (const float exponent: {0.5f, -3.7f})
+	{
+		const auto batch = [exponent](const float *p_in, uint64 p_count, float *p_out)
+		{
+			const std::vector<float> y(p_count, exponent);
+			tsm::pow(p_in, y.data(), p_count, p_out);
+		};
+		const auto reference = [exponent](const double p_x) { return std::pow(p_x, static_cast<double>(exponent)); };
+
+		// The error of log(x) and of y * log(x) is scaled up by |y * log(x)|, so it is measured per unit of that, up
+		// to where the result leaves the normal range
+		const auto in_domain = [&](const float p_x)
+		{
+			const double result = reference(p_x);
+			return p_x > 0.0f && std::isfinite(p_x) && result >= std::numeric_limits<float>::min() && result <= std::numeric_limits<float>::max();
+		};
+		const auto scale = [exponent](const float p_x) { return std::max(std::abs(exponent * std::log(static_cast<double>(p_x))), 1.0); };
+
+		const SweepResult result = sweepAllFloats(batch, reference, in_domain, [](float, float) { return true; }, scale);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "pow(x, %g)", exponent);
+		printResult(name, result);
+		TST_CHECK(result.maxUlps <= 2.5);
+	}
+
+	const float base[]{0.0f, 0.0f, 1.0f, 2.0f, -2.0f, INFINITY};
+	const float exponent[]{0.0f, -1.0f, NAN, 0.0f, 2.0f, 0.0f};
+	float       out[std::size(base)];
+	tsm::pow(base, exponent, std::size(base), out);
+	TST_CHECK(out[0] == 1.0f && out[1] == INFINITY && out[2] == 1.0f && out[3] == 1.0f && std::isnan(out[4]) && out[5] == 1.0f);
+}
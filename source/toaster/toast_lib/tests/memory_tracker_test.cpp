@@ -0,0 +1,178 @@
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "memory/linear_arena.hpp"
+#include "memory/memory_tracker.hpp"
+#include "memory/tracked_allocator.hpp"
+
+using namespace toaster;
+
+// The counters are global and other tests allocate too, so everything is checked as a difference against the stats
+// from before. eShader and eTexture are not used by anything else in toast_lib
+namespace
+{
+	constexpr memory::EMemoryTag c_tag{memory::EMemoryTag::eShader};
+	constexpr memory::EMemoryTag c_otherTag{memory::EMemoryTag::eTexture};
+
+	struct TaggedObject
+	{
+		TST_DECLARE_TAGGED_NEW(c_otherTag)
+
+		uint64 values[5];
+	};
+}
+
+TST_TEST(trackedAllocCountsBytesAndAllocations)
+{
+	const memory::MemoryTagStats before       = memory::getStats(c_tag);
+	const memory::MemoryTagStats other_before = memory::getStats(c_otherTag);
+
+	struct Allocation
+	{
+		uint64 size;
+		uint64 alignment;
+		void * ptr;
+	};
+	Allocation allocations[] = {{1u, 1u, nullptr}, {100u, 8u, nullptr}, {4'096u, 16u, nullptr}, {24u, 64u, nullptr}, {10'000u, 4'096u, nullptr}};
+
+	uint64 total = 0u;
+	for (Allocation &allocation: allocations)
+	{
+		allocation.ptr = memory::trackedAlloc(allocation.size, allocation.alignment, c_tag);
+		TST_CHECK(allocation.ptr != nullptr && reinterpret_cast<uintptr_t>(allocation.ptr) % allocation.alignment == 0u);
+		std::memset(allocation.ptr, 0xAB, allocation.size);
+		total += allocation.size;
+	}
+
+	const memory::MemoryTagStats during = memory::getStats(c_tag);
+	TST_CHECK(during.currentBytes == before.currentBytes + total);
+	TST_CHECK(during.peakBytes >= before.currentBytes + total);
+	TST_CHECK(during.liveAllocations == before.liveAllocations + std::size(allocations));
+	TST_CHECK(during.allocationCount == before.allocationCount + std::size(allocations));
+
+	for (const Allocation &allocation: allocations)
+	{
+		memory::trackedFree(allocation.ptr, allocation.size, allocation.alignment, c_tag);
+	}
+	memory::trackedFree(nullptr, 123u, 8u, c_tag);
+
+	// Frees take back the bytes and the live count, the peak and the total count stay
+	const memory::MemoryTagStats after = memory::getStats(c_tag);
+	TST_CHECK(after.currentBytes == before.currentBytes);
+	TST_CHECK(after.liveAllocations == before.liveAllocations);
+	TST_CHECK(after.allocationCount == during.allocationCount);
+	TST_CHECK(after.peakBytes == during.peakBytes);
+
+	const memory::MemoryTagStats other_after = memory::getStats(c_otherTag);
+	TST_CHECK(other_after.allocationCount == other_before.allocationCount && other_after.currentBytes == other_before.currentBytes);
+}
+
+// Containers, classes, arenas and memory from elsewhere all end up under the tag they were given
+TST_TEST(trackedMemoryIsAttributedToItsTag)
+{
+	const memory::MemoryTagStats before = memory::getStats(c_otherTag);
+	{
+		memory::TrackedVector<uint32, c_otherTag> values;
+		values.reserve(1'000u);
+		TST_CHECK(memory::getStats(c_otherTag).currentBytes == before.currentBytes + 1'000u * sizeof(uint32));
+
+		TaggedObject *object = new TaggedObject{};
+		TST_CHECK(memory::getStats(c_otherTag).currentBytes == before.currentBytes + 1'000u * sizeof(uint32) + sizeof(TaggedObject));
+		delete object;
+	}
+	TST_CHECK(memory::getStats(c_otherTag).currentBytes == before.currentBytes);
+
+	std::vector<uint8> external(300u);
+	memory::recordAllocation(external.data(), external.size(), c_otherTag);
+	TST_CHECK(memory::getStats(c_otherTag).liveAllocations == before.liveAllocations + 1u);
+	memory::recordFree(external.data(), external.size(), c_otherTag);
+	memory::recordAllocation(nullptr, 300u, c_otherTag);
+	TST_CHECK(memory::getStats(c_otherTag).currentBytes == before.currentBytes);
+	TST_CHECK(memory::getStats(c_otherTag).liveAllocations == before.liveAllocations);
+
+	{
+		memory::LinearArena arena(4'096u, c_otherTag);
+		for (uint32 i = 0u; i < 100u; i++)
+		{
+			(void)arena.allocate(200u);
+		}
+		TST_CHECK(memory::getStats(c_otherTag).currentBytes >= before.currentBytes + 100u * 200u);
+	}
+	TST_CHECK(memory::getStats(c_otherTag).currentBytes == before.currentBytes);
+}
+
+// The warning is logged once per crossing: not again while usage stays above, again after it came back below
+TST_TEST(memoryBudgetWarnsOncePerCrossing)
+{
+	const uint64 base     = memory::getStats(c_tag).currentBytes;
+	const uint64 warnings = memory::getStats(c_tag).budgetWarnings;
+	memory::setBudget(c_tag, base + 1'000u);
+	TST_CHECK(memory::getStats(c_tag).budgetBytes == base + 1'000u);
+
+	void *first = memory::trackedAlloc(600u, 8u, c_tag);
+	TST_CHECK(memory::getStats(c_tag).budgetWarnings == warnings);
+
+	void *second = memory::trackedAlloc(600u, 8u, c_tag);
+	TST_CHECK(memory::getStats(c_tag).budgetWarnings == warnings + 1u);
+	void *third = memory::trackedAlloc(600u, 8u, c_tag);
+	TST_CHECK(memory::getStats(c_tag).budgetWarnings == warnings + 1u);
+
+	// Still above after the first free, back below after the second
+	memory::trackedFree(third, 600u, 8u, c_tag);
+	third = memory::trackedAlloc(600u, 8u, c_tag);
+	TST_CHECK(memory::getStats(c_tag).budgetWarnings == warnings + 1u);
+	memory::trackedFree(third, 600u, 8u, c_tag);
+	memory::trackedFree(second, 600u, 8u, c_tag);
+
+	second = memory::trackedAlloc(600u, 8u, c_tag);
+	TST_CHECK(memory::getStats(c_tag).budgetWarnings == warnings + 2u);
+	memory::trackedFree(second, 600u, 8u, c_tag);
+
+	// No budget, no warning
+	memory::setBudget(c_tag, 0u);
+	second = memory::trackedAlloc(100'000u, 8u, c_tag);
+	TST_CHECK(memory::getStats(c_tag).budgetWarnings == warnings + 2u);
+	memory::trackedFree(second, 100'000u, 8u, c_tag);
+	memory::trackedFree(first, 600u, 8u, c_tag);
+
+	TST_CHECK(memory::getStats(c_tag).currentBytes == base);
+}
+
+TST_TEST(memoryTrackerCountsAcrossThreads)
+{
+	constexpr uint32 c_threadCount{4u};
+	constexpr uint32 c_allocationsPerThread{20'000u};
+
+	const memory::MemoryTagStats before = memory::getStats(c_tag);
+	{
+		std::vector<std::jthread> threads;
+		for (uint32 thread = 0u; thread < c_threadCount; thread++)
+		{
+			threads.emplace_back([thread]
+			{
+				std::vector<void *> live;
+				for (uint32 i = 0u; i < c_allocationsPerThread; i++)
+				{
+					live.push_back(memory::trackedAlloc(16u + (i + thread) % 64u, 16u, c_tag));
+					if (live.size() == 32u)
+					{
+						for (uint32 j = 0u; j < live.size(); j++)
+						{
+							memory::trackedFree(live[j], 16u + (i - 31u + j + thread) % 64u, 16u, c_tag);
+						}
+						live.clear();
+					}
+				}
+			});
+		}
+	}
+
+	const memory::MemoryTagStats after = memory::getStats(c_tag);
+	TST_CHECK(after.currentBytes == before.currentBytes);
+	TST_CHECK(after.liveAllocations == before.liveAllocations);
+	TST_CHECK(after.allocationCount == before.allocationCount + c_threadCount * c_allocationsPerThread);
+	TST_CHECK(after.peakBytes >= before.currentBytes + 32u * 16u);
+}
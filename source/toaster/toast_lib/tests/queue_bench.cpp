@@ -0,0 +1,161 @@
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "jobs/mpmc_queue.hpp"
+#include "jobs/mpsc_queue.hpp"
+#include "jobs/spsc_queue.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	constexpr uint64 c_itemCount{1u << 21u};
+
+	// The mutex protected deque the queues replace
+	class LockedQueue
+	{
+	public:
+		bool tryPush(const uint64 p_value)
+		{
+			std::lock_guard lock(m_mutex);
+			m_items.push_back(p_value);
+			return true;
+		}
+
+		bool tryPop(uint64 &p_value)
+		{
+			std::lock_guard lock(m_mutex);
+			if (m_items.empty())
+				return false;
+			p_value = m_items.front();
+			m_items.pop_front();
+			return true;
+		}
+
+	private:
+		std::mutex         m_mutex;
+		std::deque<uint64> m_items;
+	};
+
+	// c_itemCount items split over p_producers, popped by p_consumers, all threads started together
+	template<typename Queue>
+	double measureTransfer(Queue &p_queue, const uint32 p_producers, const uint32 p_consumers)
+	{
+		return test::measureNs([&]
+		{
+			std::atomic<uint64> consumed{0u};
+			std::atomic<uint64> checksum{0u};
+
+			std::vector<std::jthread> threads;
+			for (uint32 producer = 0u; producer < p_producers; producer++)
+			{
+				threads.emplace_back([&p_queue, producer, p_producers]
+				{
+					for (uint64 i = producer; i < c_itemCount; i += p_producers)
+					{
+						while (!p_queue.tryPush(i))
+							std::this_thread::yield();
+					}
+				});
+			}
+			for (uint32 consumer = 0u; consumer < p_consumers; consumer++)
+			{
+				threads.emplace_back([&]
+				{
+					uint64 sum = 0u;
+					while (consumed.load(std::memory_order_relaxed) < c_itemCount)
+					{
+						uint64 value;
+						if (!p_queue.tryPop(value))
+						{
+							std::this_thread::yield();
+							continue;
+						}
+						sum += value;
+						consumed.fetch_add(1u, std::memory_order_relaxed);
+					}
+					checksum.fetch_add(sum, std::memory_order_relaxed);
+				});
+			}
+			threads.clear();
+			test::doNotOptimize(checksum);
+		}, 3);
+	}
+
+	struct Item : jobs::MpscNode
+	{
+		uint64 value{0u};
+	};
+}
+
+// Items per second through each queue with 1 to 4 producers and consumers, against std::mutex + std::deque. With
+// fewer hardware threads than queue threads the numbers mostly show how well each side copes with being preempted
+TST_BENCHMARK(queueThroughput)
+{
+	std::printf("%u hardware threads, %llu items\n", std::thread::hardware_concurrency(), static_cast<unsigned long long>(c_itemCount));
+	const double items = static_cast<double>(c_itemCount);
+
+	{
+		jobs::SpscQueue<uint64> spsc(4096u);
+		test::report("SPSC, 1 -> 1", measureTransfer(spsc, 1u, 1u), items);
+	}
+
+	for (const uint32 threads: {1u, 2u, 4u})
+	{
+		char name[64];
+
+		jobs::MpmcQueue<uint64> mpmc(4096u);
+		std::snprintf(name, sizeof(name), "MPMC, %u -> %u", threads, threads);
+		test::report(name, measureTransfer(mpmc, threads, threads), items);
+
+		LockedQueue locked;
+		std::snprintf(name, sizeof(name), "mutex + deque, %u -> %u", threads, threads);
+		test::report(name, measureTransfer(locked, threads, threads), items);
+	}
+
+	// Intrusive, the consumer is the measuring thread
+	for (const uint32 producers: {1u, 2u, 4u})
+	{
+		std::unique_ptr<Item[]> nodes = std::make_unique<Item[]>(c_itemCount);
+		jobs::MpscQueue<Item>   mpsc;
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "MPSC, %u -> 1", producers);
+		test::report(name, test::measureNs([&]
+		{
+			std::vector<std::jthread> threads;
+			for (uint32 producer = 0u; producer < producers; producer++)
+			{
+				threads.emplace_back([&nodes, &mpsc, producer, producers]
+				{
+					for (uint64 i = producer; i < c_itemCount; i += producers)
+					{
+						nodes[i].value = i;
+						mpsc.push(&nodes[i]);
+					}
+				});
+			}
+
+			uint64 sum = 0u;
+			for (uint64 consumed = 0u; consumed < c_itemCount;)
+			{
+				if (const Item *item = mpsc.tryPop())
+				{
+					sum += item->value;
+					consumed++;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+			test::doNotOptimize(sum);
+		}, 3), items);
+	}
+}
@@ -0,0 +1,300 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "jobs/command_channel.hpp"
+#include "jobs/mpmc_queue.hpp"
+#include "jobs/mpsc_queue.hpp"
+#include "jobs/spsc_queue.hpp"
+
+using namespace toaster;
+
+// Producers and consumers on plain threads, every item has to arrive exactly once and the items of one producer in
+// the order it pushed them. Also built with -fsanitize=thread as toast_lib_tsan_tests
+namespace
+{
+	constexpr uint32 c_producerCount{4u};
+	constexpr uint32 c_consumerCount{4u};
+	constexpr uint64 c_itemsPerProducer{100'000u};
+
+	uint64 makeItem(const uint32 p_producer, const uint64 p_sequence) { return static_cast<uint64>(p_producer) << 32u | p_sequence; }
+
+	// Counts how often every item arrived and whether a consumer ever saw a producer's items out of order
+	struct ArrivalLog
+	{
+		std::vector<std::atomic<uint8>> arrivals = std::vector<std::atomic<uint8>>(c_producerCount * c_itemsPerProducer);
+		std::atomic<bool>               outOfOrder{false};
+
+		// p_last_seen is the consumer's own, one entry per producer
+		void record(const uint64 p_item, std::vector<int64> &p_last_seen)
+		{
+			const uint32 producer = static_cast<uint32>(p_item >> 32u);
+			const int64  sequence = static_cast<int64>(p_item & 0xFFFFFFFFu);
+
+			if (sequence <= p_last_seen[producer])
+				outOfOrder.store(true, std::memory_order_relaxed);
+			p_last_seen[producer] = sequence;
+
+			arrivals[producer * c_itemsPerProducer + static_cast<uint64>(sequence)].fetch_add(1u, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] bool allArrivedOnce() const
+		{
+			for (const std::atomic<uint8> &arrival: arrivals)
+			{
+				if (arrival.load(std::memory_order_relaxed) != 1u)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	struct Item : jobs::MpscNode
+	{
+		uint64 value{0u};
+	};
+
+	// Counts live copies, for checking that queues and buffers destroy what they hold
+	struct Tracked
+	{
+		static inline std::atomic<int32> s_live{0};
+
+		Tracked() { s_live++; }
+		Tracked(const Tracked &) { s_live++; }
+		Tracked(Tracked &&) noexcept { s_live++; }
+		Tracked &operator=(const Tracked &) = default;
+		Tracked &operator=(Tracked &&)      = default;
+		~Tracked() { s_live--; }
+	};
+}
+
+TST_TEST(spscQueueKeepsOrder)
+{
+	jobs::SpscQueue<uint64> queue(1024u);
+	constexpr uint64        c_count{1'000'000u};
+
+	std::jthread producer([&queue]
+	{
+		for (uint64 i = 0u; i < c_count; i++)
+		{
+			while (!queue.tryPush(i))
+				std::this_thread::yield();
+		}
+	});
+
+	bool   in_order = true;
+	uint64 expected = 0u;
+	while (expected < c_count)
+	{
+		uint64 value;
+		if (!queue.tryPop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		in_order &= value == expected++;
+	}
+	TST_CHECK(in_order);
+}
+
+TST_TEST(mpmcQueueDeliversEveryItemOnce)
+{
+	jobs::MpmcQueue<uint64> queue(256u);
+	ArrivalLog              log;
+	std::atomic<uint64>     consumed{0u};
+
+	{
+		std::vector<std::jthread> threads;
+		for (uint32 producer = 0u; producer < c_producerCount; producer++)
+		{
+			threads.emplace_back([&queue, producer]
+			{
+				for (uint64 i = 0u; i < c_itemsPerProducer; i++)
+				{
+					while (!queue.tryPush(makeItem(producer, i)))
+						std::this_thread::yield();
+				}
+			});
+		}
+		for (uint32 consumer = 0u; consumer < c_consumerCount; consumer++)
+		{
+			threads.emplace_back([&]
+			{
+				std::vector<int64> last_seen(c_producerCount, -1);
+				while (consumed.load(std::memory_order_relaxed) < c_producerCount * c_itemsPerProducer)
+				{
+					uint64 item;
+					if (!queue.tryPop(item))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					log.record(item, last_seen);
+					consumed.fetch_add(1u, std::memory_order_relaxed);
+				}
+			});
+		}
+	}
+
+	TST_CHECK(log.allArrivedOnce());
+	TST_CHECK(!log.outOfOrder.load());
+
+	uint64 leftover;
+	TST_CHECK(!queue.tryPop(leftover));
+}
+
+TST_TEST(mpmcQueueDestroysWhatItHolds)
+{
+	{
+		jobs::MpmcQueue<Tracked> queue(8u);
+		for (uint32 i = 0u; i < 8u; i++)
+		{
+			TST_CHECK(queue.tryPush());
+		}
+		TST_CHECK(!queue.tryPush());
+
+		Tracked popped;
+		TST_CHECK(queue.tryPop(popped));
+		TST_CHECK(Tracked::s_live.load() == 8);
+	}
+	TST_CHECK(Tracked::s_live.load() == 0);
+}
+
+TST_TEST(mpscQueueDeliversEveryItemOnce)
+{
+	jobs::MpscQueue<Item> queue;
+	ArrivalLog            log;
+
+	std::vector<std::unique_ptr<Item[]>> items;
+	for (uint32 producer = 0u; producer < c_producerCount; producer++)
+	{
+		items.push_back(std::make_unique<Item[]>(c_itemsPerProducer));
+	}
+
+	{
+		std::vector<std::jthread> producers;
+		for (uint32 producer = 0u; producer < c_producerCount; producer++)
+		{
+			producers.emplace_back([&queue, &items, producer]
+			{
+				for (uint64 i = 0u; i < c_itemsPerProducer; i++)
+				{
+					items[producer][i].value = makeItem(producer, i);
+					queue.push(&items[producer][i]);
+				}
+			});
+		}
+
+		std::vector<int64> last_seen(c_producerCount, -1);
+		for (uint64 consumed = 0u; consumed < c_producerCount * c_itemsPerProducer;)
+		{
+			Item *item = queue.tryPop();
+			if (!item)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			log.record(item->value, last_seen);
+			consumed++;
+		}
+	}
+
+	TST_CHECK(log.allArrivedOnce());
+	TST_CHECK(!log.outOfOrder.load());
+	TST_CHECK(queue.tryPop() == nullptr);
+}
+
+TST_TEST(commandChannelRunsBatchesInOrder)
+{
+	struct Context
+	{
+		std::vector<int64> lastSeen = std::vector<int64>(c_producerCount, -1);
+		uint64             executed{0u};
+		bool               outOfOrder{false};
+	};
+
+	constexpr uint64 c_batchCount{2'000u};
+	constexpr uint64 c_commandsPerBatch{16u};
+
+	jobs::CommandChannel<Context> channel(8u);
+	Context                       context;
+	std::atomic<uint32>           producers_done{0u};
+
+	{
+		std::vector<std::jthread> producers;
+		for (uint32 producer = 0u; producer < c_producerCount; producer++)
+		{
+			producers.emplace_back([&channel, &producers_done, producer]
+			{
+				for (uint64 batch_index = 0u; batch_index < c_batchCount; batch_index++)
+				{
+					auto batch = channel.beginBatch();
+					for (uint64 i = 0u; i < c_commandsPerBatch; i++)
+					{
+						const int64 sequence = static_cast<int64>(batch_index * c_commandsPerBatch + i);
+						batch.record([producer, sequence](Context &p_context)
+						{
+							p_context.outOfOrder |= sequence <= p_context.lastSeen[producer];
+							p_context.lastSeen[producer] = sequence;
+							p_context.executed++;
+						});
+					}
+				}
+				producers_done.fetch_add(1u, std::memory_order_release);
+			});
+		}
+
+		// The last pass after every producer is done picks up whatever they submitted in the meantime
+		while (producers_done.load(std::memory_order_acquire) < c_producerCount)
+		{
+			if (channel.execute(context) == 0u)
+				std::this_thread::yield();
+		}
+	}
+	while (channel.execute(context) != 0u)
+	{
+	}
+
+	TST_CHECK(context.executed == c_producerCount * c_batchCount * c_commandsPerBatch);
+	TST_CHECK(!context.outOfOrder);
+}
+
+// A command whose constructor throws leaves nothing behind, the commands around it still run
+TST_TEST(commandBufferRecordRollsBackOnThrow)
+{
+	struct ThrowsOnCopy
+	{
+		ThrowsOnCopy() = default;
+		ThrowsOnCopy(const ThrowsOnCopy &) { throw std::runtime_error("copy"); }
+
+		void operator()(int32 &p_count) const { p_count += 100; }
+	};
+
+	jobs::CommandBuffer buffer;
+	buffer.record<int32>([](int32 &p_count) { p_count++; });
+
+	const ThrowsOnCopy throws;
+	bool               thrown = false;
+	try
+	{
+		buffer.record<int32>(throws);
+	}
+	catch (const std::runtime_error &)
+	{
+		thrown = true;
+	}
+	TST_CHECK(thrown);
+	TST_CHECK(buffer.getCommandCount() == 1u);
+
+	const Tracked tracked;
+	buffer.record<int32>([tracked](int32 &p_count) { p_count++; });
+
+	int32 count = 0;
+	buffer.execute(&count);
+	TST_CHECK(count == 2);
+	TST_CHECK(buffer.isEmpty());
+	TST_CHECK(Tracked::s_live.load() == 1);
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "toast_bench.hpp"
+#include "memory/small_object_allocator.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	constexpr uint32 c_operationsPerThread{2'000'000u};
+	constexpr uint32 c_liveBlocksPerThread{4'096u};
+
+	struct SmallAllocator
+	{
+		static void *allocate(const uint64 p_size) { return memory::smallAlloc(p_size); }
+		static void  free(void *p_ptr) { memory::smallFree(p_ptr); }
+	};
+
+	struct SystemAllocator
+	{
+		static void *allocate(const uint64 p_size) { return std::malloc(p_size); }
+		static void  free(void *p_ptr) { std::free(p_ptr); }
+	};
+
+	uint64 nextSize(uint32 &p_state)
+	{
+		p_state ^= p_state << 13u;
+		p_state ^= p_state >> 17u;
+		p_state ^= p_state << 5u;
+		return (p_state & 7u) != 0u ? 8u + p_state % 120u : 8u + p_state % 2040u;
+	}
+
+	// Every thread keeps a window of live blocks and replaces a random one per operation. With p_remote the
+	// replaced block is freed by the neighbouring thread instead, through a small hand off ring
+	template<typename Allocator>
+	double runThreads(const uint32 p_threads, const bool p_remote)
+	{
+		struct alignas(64) Handoff
+		{
+			std::atomic<void *> slot{nullptr};
+		};
+		std::vector<Handoff> handoffs(p_threads);
+
+		return test::measureNs([&]
+		{
+			std::vector<std::thread> threads;
+			for (uint32 thread = 0u; thread < p_threads; thread++)
+			{
+				threads.emplace_back([&, thread]
+				{
+					uint32              state = thread * 2654435761u + 1u;
+					std::vector<void *> live(c_liveBlocksPerThread);
+					for (void *&ptr: live)
+					{
+						ptr = Allocator::allocate(nextSize(state));
+					}
+
+					Handoff &outgoing = handoffs[(thread + 1u) % p_threads];
+					Handoff &incoming = handoffs[thread];
+					for (uint32 i = 0u; i < c_operationsPerThread; i++)
+					{
+						void *&victim = live[nextSize(state) % c_liveBlocksPerThread];
+						if (p_remote && p_threads > 1u)
+						{
+							// Handed to the next thread, whatever was waiting there is freed by us
+							if (void *previous = outgoing.slot.exchange(victim, std::memory_order_acq_rel))
+								Allocator::free(previous);
+							if (void *received = incoming.slot.exchange(nullptr, std::memory_order_acq_rel))
+								Allocator::free(received);
+						}
+						else
+						{
+							Allocator::free(victim);
+						}
+						victim = Allocator::allocate(nextSize(state));
+						test::doNotOptimize(victim);
+					}
+
+					for (void *ptr: live)
+					{
+						Allocator::free(ptr);
+					}
+				});
+			}
+
+			for (std::thread &thread: threads)
+			{
+				thread.join();
+			}
+			for (Handoff &handoff: handoffs)
+			{
+				if (void *ptr = handoff.slot.exchange(nullptr))
+					Allocator::free(ptr);
+			}
+		}, 3u);
+	}
+}
+
+// Alloc/free throughput of the small object allocator against the system malloc (glibc on Linux), thread local and
+// with every free done by another thread
+TST_BENCHMARK(smallAllocVsSystem)
+{
+	const uint32 max_threads = std::max(std::thread::hardware_concurrency(), 2u);
+
+	for (const bool remote: {false, true})
+	{
+		std::printf("%s frees, %u operations per thread:\n", remote ? "Remote" : "Local", c_operationsPerThread);
+		for (uint32 threads = 1u; threads <= max_threads; threads *= 2u)
+		{
+			const double operations = static_cast<double>(threads) * c_operationsPerThread;
+			const double small_ns   = runThreads<SmallAllocator>(threads, remote);
+			const double system_ns  = runThreads<SystemAllocator>(threads, remote);
+
+			char name[64];
+			std::snprintf(name, sizeof(name), "smallAlloc, %u threads", threads);
+			test::report(name, small_ns, operations);
+			std::snprintf(name, sizeof(name), "malloc, %u threads", threads);
+			test::report(name, system_ns, operations);
+		}
+	}
+}
@@ -0,0 +1,219 @@
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "memory/small_object_allocator.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	// Every block is filled with a byte derived from its size and owner, so a block handed out twice shows up
+	uint8 fillByte(const uint64 p_size, const uint32 p_thread)
+	{
+		return static_cast<uint8>(p_size * 31u + p_thread * 7u + 1u);
+	}
+
+	bool checkFill(const void *p_ptr, const uint64 p_size, const uint8 p_byte)
+	{
+		const auto *bytes = static_cast<const uint8 *>(p_ptr);
+		for (uint64 i = 0u; i < p_size; i++)
+		{
+			if (bytes[i] != p_byte)
+				return false;
+		}
+		return true;
+	}
+
+	struct Block
+	{
+		void * ptr;
+		uint64 size;
+		uint8  fill;
+	};
+
+	// Blocks handed from the producers to the consumers
+	struct Mailbox
+	{
+		std::mutex         mutex;
+		std::vector<Block> blocks;
+	};
+}
+
+TST_TEST(smallAllocEverySize)
+{
+	std::vector<void *> blocks;
+	for (uint64 size = 0u; size <= memory::c_smallAllocMaxSize; size++)
+	{
+		void *ptr = memory::smallAlloc(size);
+		TST_CHECK(ptr != nullptr);
+		TST_CHECK(reinterpret_cast<uintptr_t>(ptr) % memory::c_smallAllocAlignment == 0u);
+		TST_CHECK(memory::isSmallAllocation(ptr));
+		TST_CHECK(memory::smallAllocUsableSize(ptr) >= size);
+
+		std::memset(ptr, fillByte(size, 0u), size);
+		blocks.push_back(ptr);
+	}
+
+	for (uint64 size = 0u; size < blocks.size(); size++)
+	{
+		TST_CHECK(checkFill(blocks[size], size, fillByte(size, 0u)));
+		memory::smallFree(blocks[size]);
+	}
+}
+
+TST_TEST(smallAllocLargeGoesToSystem)
+{
+	void *ptr = memory::smallAlloc(memory::c_smallAllocMaxSize + 1u);
+	TST_CHECK(ptr != nullptr);
+	TST_CHECK(!memory::isSmallAllocation(ptr));
+	TST_CHECK(memory::smallAllocUsableSize(ptr) == 0u);
+	memory::smallFree(ptr);
+	memory::smallFree(nullptr);
+}
+
+// Producers allocate and fill, consumers check and free, so nearly every free is a remote one
+TST_TEST(smallAllocCrossThreadStress)
+{
+	constexpr uint32 c_producers{4u};
+	constexpr uint32 c_consumers{4u};
+	constexpr uint32 c_blocksPerProducer{200'000u};
+
+	Mailbox             mailbox;
+	std::atomic<uint32> producers_done{0u};
+	std::atomic<uint32> corrupted{0u};
+	std::atomic<uint64> consumed{0u};
+
+	std::vector<std::thread> threads;
+	for (uint32 producer = 0u; producer < c_producers; producer++)
+	{
+		threads.emplace_back([&, producer]
+		{
+			uint32             state = producer * 2654435761u + 1u;
+			std::vector<Block> batch;
+			for (uint32 i = 0u; i < c_blocksPerProducer; i++)
+			{
+				state ^= state << 13u;
+				state ^= state >> 17u;
+				state ^= state << 5u;
+
+				// Mostly small sizes, like the engine's allocations
+				const uint64 size = (state & 7u) != 0u ? state % 128u : state % memory::c_smallAllocMaxSize;
+				const uint8  fill = fillByte(size, producer);
+
+				void *ptr = memory::smallAlloc(size);
+				std::memset(ptr, fill, size);
+
+				// Some blocks are freed by the producer itself, mixing local and remote frees on the same pages
+				if ((state & 15u) == 0u)
+				{
+					if (!checkFill(ptr, size, fill))
+						corrupted.fetch_add(1u, std::memory_order_relaxed);
+					memory::smallFree(ptr);
+					consumed.fetch_add(1u, std::memory_order_relaxed);
+					continue;
+				}
+
+				batch.push_back({ptr, size, fill});
+				if (batch.size() == 64u)
+				{
+					std::lock_guard lock(mailbox.mutex);
+					mailbox.blocks.insert(mailbox.blocks.end(), batch.begin(), batch.end());
+					batch.clear();
+				}
+			}
+
+			std::lock_guard lock(mailbox.mutex);
+			mailbox.blocks.insert(mailbox.blocks.end(), batch.begin(), batch.end());
+			producers_done.fetch_add(1u, std::memory_order_release);
+		});
+	}
+
+	for (uint32 consumer = 0u; consumer < c_consumers; consumer++)
+	{
+		threads.emplace_back([&]
+		{
+			std::vector<Block> batch;
+			for (;;)
+			{
+				const bool done = producers_done.load(std::memory_order_acquire) == c_producers;
+				{
+					std::lock_guard lock(mailbox.mutex);
+					batch.swap(mailbox.blocks);
+				}
+
+				if (batch.empty())
+				{
+					if (done)
+						break;
+					std::this_thread::yield();
+					continue;
+				}
+
+				for (const Block &block: batch)
+				{
+					if (!checkFill(block.ptr, block.size, block.fill))
+						corrupted.fetch_add(1u, std::memory_order_relaxed);
+					memory::smallFree(block.ptr);
+				}
+				consumed.fetch_add(batch.size(), std::memory_order_relaxed);
+				batch.clear();
+			}
+		});
+	}
+
+	for (std::thread &thread: threads)
+	{
+		thread.join();
+	}
+
+	TST_CHECK(corrupted.load() == 0u);
+	TST_CHECK(consumed.load() == static_cast<uint64>(c_producers) * c_blocksPerProducer);
+}
+
+// A thread that only allocates while another frees everything must not keep the freed pages to itself
+TST_TEST(smallAllocRemoteFreedPagesAreReclaimed)
+{
+	constexpr uint64 c_blockSize{256u};
+	constexpr uint32 c_blocksPerRound{2'000u}; // About 8 pages worth
+	constexpr uint32 c_rounds{100u};
+
+	const uint64 pages_before = memory::getSmallAllocatorStats().pagesInUse;
+
+	uint64 peak_pages     = 0u;
+	uint64 trimmed_pages  = 0u;
+	uint64 producer_pages = 0u;
+
+	std::thread producer([&]
+	{
+		for (uint32 round = 0u; round < c_rounds; round++)
+		{
+			std::vector<void *> round_blocks;
+			for (uint32 i = 0u; i < c_blocksPerRound; i++)
+			{
+				round_blocks.push_back(memory::smallAlloc(c_blockSize));
+			}
+			peak_pages = std::max(peak_pages, memory::getSmallAllocatorStats().pagesInUse);
+
+			// Freed on another thread, all remote frees
+			std::thread([&] { for (void *ptr: round_blocks) memory::smallFree(ptr); }).join();
+		}
+
+		producer_pages = memory::getSmallAllocatorStats().pagesInUse;
+		memory::smallAllocTrim();
+		trimmed_pages = memory::getSmallAllocatorStats().pagesInUse;
+	});
+	producer.join();
+
+	// One round needs about 8 pages, reuse keeps it at that instead of 8 per round
+	TST_CHECK(peak_pages - pages_before <= 2u * c_blocksPerRound * c_blockSize / (64u * 1024u) + 2u);
+	// Trimming keeps at most the page allocations come from
+	TST_CHECK(trimmed_pages <= pages_before + 1u);
+	TST_CHECK(trimmed_pages <= producer_pages);
+	// The producer has exited, whatever it had left is back in the pool. With WITH_TOAST_ALLOCATOR the std::thread
+	// bookkeeping is allocated here too, which may keep a page of its own
+	TST_CHECK(memory::getSmallAllocatorStats().pagesInUse <= pages_before + 1u);
+}
@@ -0,0 +1,106 @@
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "toast_test.hpp"
+#include "string_id.hpp"
+
+using namespace toaster;
+using namespace toaster::literals;
+
+namespace
+{
+	// Two different strings with the same 64-bit FNV-1a hash, found with a Pollard rho search over 11 character
+	// suffixes. Only ever hashed at compile time or through tryIntern(), a runtime StringId of the second one would
+	// assert in debug builds
+	constexpr std::string_view c_collisionA{"collision_NCmBnDbeqLG"};
+	constexpr std::string_view c_collisionB{"collision_ygXSUaImFtF"};
+	static_assert(hashString64(c_collisionA) == hashString64(c_collisionB) && hashString64(c_collisionA) == 0x767f03e4c128d6f7ull);
+
+	// The reference FNV-1a values
+	static_assert(hashString64("") == 0xcbf29ce484222325ull);
+	static_assert(hashString64("a") == 0xaf63dc4c8601ec8cull);
+	static_assert(hashString64("foobar") == 0x85944171f73967e8ull);
+
+	constexpr StringId c_albedo{"albedoMap"};
+	static_assert(c_albedo == "albedoMap"_sid && c_albedo.isValid() && !StringId().isValid());
+}
+
+TST_TEST(stringIdMatchesAtCompileAndRunTime)
+{
+	const std::string name = std::string("albedo") + "Map";
+	TST_CHECK(StringId(name) == c_albedo);
+	TST_CHECK(StringId(name).getHash() == hashString64(name));
+	TST_CHECK(std::hash<StringId>{}(c_albedo) == static_cast<std::size_t>(c_albedo.getHash()));
+	TST_CHECK(StringId(std::string("normalMap")) != c_albedo);
+}
+
+TST_TEST(stringIdInternRoundTrips)
+{
+	StringId id;
+	{
+		// The interner keeps its own copy
+		const std::string name = fmt::format("interned_{}", 42);
+		id                     = StringId::intern(name);
+	}
+	TST_CHECK(id.getString() == "interned_42");
+	TST_CHECK(std::string_view(id.c_str()) == "interned_42");
+	TST_CHECK(StringId::intern("interned_42") == id && id.getString().data() == StringId::intern("interned_42").getString().data());
+	TST_CHECK(fmt::format("{}", id) == "interned_42");
+
+	// Never hashed at run time, so nothing to look up
+	constexpr StringId c_unknown = "neverHashedAtRunTime"_sid;
+	TST_CHECK(c_unknown.getString().empty() && c_unknown.c_str() == nullptr);
+	TST_CHECK(fmt::format("{}", c_unknown) == fmt::format("#{:016x}", c_unknown.getHash()));
+	TST_CHECK(StringId().getString().empty());
+}
+
+TST_TEST(stringInternerRejectsCollisions)
+{
+	const std::optional<StringId> first = StringId::tryIntern(c_collisionA);
+	TST_CHECK(first.has_value() && first->getString() == c_collisionA);
+
+	// Same hash, different string: refused, and the first one keeps the id
+	TST_CHECK(!StringId::tryIntern(c_collisionB).has_value());
+	TST_CHECK(first->getString() == c_collisionA);
+
+	// The same string again is not a collision
+	const std::optional<StringId> again = StringId::tryIntern(c_collisionA);
+	TST_CHECK(again == first);
+}
+
+TST_TEST(stringIdInternAcrossThreads)
+{
+	constexpr uint32 c_threadCount{4u};
+	constexpr uint32 c_nameCount{2'000u};
+
+	// Every thread interns the same names, in a different order, while the others look them up
+	std::vector<std::vector<StringId>> ids(c_threadCount, std::vector<StringId>(c_nameCount));
+	{
+		std::vector<std::jthread> threads;
+		for (uint32 thread = 0u; thread < c_threadCount; thread++)
+		{
+			threads.emplace_back([thread, &ids]
+			{
+				for (uint32 i = 0u; i < c_nameCount; i++)
+				{
+					const uint32 name = (i * 7u + thread * 500u) % c_nameCount;
+					ids[thread][name] = StringId::intern(fmt::format("threaded_name_{}", name));
+					(void)StringId(fmt::format("threaded_name_{}", (name + 1u) % c_nameCount)).getString();
+				}
+			});
+		}
+	}
+
+	for (uint32 name = 0u; name < c_nameCount; name++)
+	{
+		const std::string expected = fmt::format("threaded_name_{}", name);
+		for (uint32 thread = 0u; thread < c_threadCount; thread++)
+		{
+			TST_CHECK(ids[thread][name] == ids[0][name] && ids[thread][name].getString() == expected);
+		}
+	}
+}
@@ -0,0 +1,158 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "toast_test.hpp"
+#include "jobs/job_system.hpp"
+#include "jobs/task.hpp"
+
+using namespace toaster;
+
+namespace
+{
+	struct JobSystemScope
+	{
+		JobSystemScope() { jobs::initialize({.workerThreads = 3u}); }
+		~JobSystemScope() { jobs::shutdown(); }
+	};
+
+	jobs::Task<uint64> squareOnWorker(const uint64 p_value)
+	{
+		co_await jobs::switchToWorker();
+		co_return p_value * p_value;
+	}
+
+	jobs::Task<uint64> sumOfSquares(const uint64 p_count)
+	{
+		uint64 sum = 0u;
+		for (uint64 i = 0u; i < p_count; i++)
+		{
+			sum += co_await squareOnWorker(i);
+		}
+		co_return sum;
+	}
+
+	jobs::Task<int32> throwOnWorker()
+	{
+		co_await jobs::switchToWorker();
+		throw std::runtime_error("task");
+	}
+}
+
+TST_TEST(taskSyncWaitReturnsValueAndRethrows)
+{
+	JobSystemScope job_system;
+
+	TST_CHECK(jobs::syncWait(sumOfSquares(100u)) == 328'350u);
+
+	bool thrown = false;
+	try
+	{
+		jobs::syncWait(throwOnWorker());
+	}
+	catch (const std::runtime_error &)
+	{
+		thrown = true;
+	}
+	TST_CHECK(thrown);
+
+	// Move only results
+	auto make_unique = []() -> jobs::Task<std::unique_ptr<int32>>
+	{
+		co_await jobs::switchToWorker();
+		co_return std::make_unique<int32>(7);
+	};
+	const std::unique_ptr<int32> value = jobs::syncWait(make_unique());
+	TST_CHECK(value && *value == 7);
+}
+
+TST_TEST(taskWhenAllCollectsEveryResult)
+{
+	JobSystemScope job_system;
+
+	constexpr uint64 c_taskCount{256u};
+
+	std::vector<jobs::Task<uint64>> tasks;
+	for (uint64 i = 0u; i < c_taskCount; i++)
+	{
+		tasks.push_back(squareOnWorker(i));
+	}
+	const std::vector<uint64> squares = jobs::syncWait(jobs::whenAll(std::move(tasks)));
+
+	bool in_order = squares.size() == c_taskCount;
+	for (uint64 i = 0u; in_order && i < c_taskCount; i++)
+	{
+		in_order = squares[i] == i * i;
+	}
+	TST_CHECK(in_order);
+
+	// Void tasks, every one has run by the time whenAll is done
+	std::atomic<uint32>           ran{0u};
+	std::vector<jobs::Task<void>> void_tasks;
+	for (uint32 i = 0u; i < 64u; i++)
+	{
+		void_tasks.push_back([](std::atomic<uint32> &p_ran) -> jobs::Task<void>
+		{
+			co_await jobs::switchToWorker();
+			p_ran.fetch_add(1u, std::memory_order_relaxed);
+		}(ran));
+	}
+	jobs::syncWait(jobs::whenAll(std::move(void_tasks)));
+	TST_CHECK(ran.load() == 64u);
+
+	// Different types, void comes back as std::monostate
+	auto text = []() -> jobs::Task<std::string>
+	{
+		co_await jobs::switchToWorker();
+		co_return std::string("done");
+	};
+	auto nothing = []() -> jobs::Task<void> { co_await jobs::switchToMainThread(); };
+
+	const auto [square, monostate, string] = jobs::syncWait(jobs::whenAll(squareOnWorker(12u), nothing(), text()));
+	TST_CHECK(square == 144u);
+	TST_CHECK(string == "done");
+	TST_CHECK((std::is_same_v<std::decay_t<decltype(monostate)>, std::monostate>));
+}
+
+TST_TEST(taskWhenAllRethrows)
+{
+	JobSystemScope job_system;
+
+	std::vector<jobs::Task<int32>> tasks;
+	tasks.push_back([]() -> jobs::Task<int32> { co_return 1; }());
+	tasks.push_back(throwOnWorker());
+
+	bool thrown = false;
+	try
+	{
+		jobs::syncWait(jobs::whenAll(std::move(tasks)));
+	}
+	catch (const std::runtime_error &)
+	{
+		thrown = true;
+	}
+	TST_CHECK(thrown);
+}
+
+// Waiting on the GPU from a task: off a worker onto the main thread, polled there
+TST_TEST(taskPollUntilContinuesOnMainThread)
+{
+	JobSystemScope job_system;
+
+	uint32 polls = 0u;
+	auto   wait  = [](uint32 &p_polls) -> jobs::Task<bool>
+	{
+		co_await jobs::switchToWorker();
+		co_await jobs::switchToMainThread();
+		co_await jobs::pollUntil([&p_polls] { return ++p_polls == 3u; });
+		co_return jobs::isMainThread();
+	};
+
+	TST_CHECK(jobs::syncWait(wait(polls)));
+	TST_CHECK(polls == 3u);
+}
@@ -12,8 +12,6 @@ layout(push_constant) uniform PushConstants
     vec3  cameraPos;
 } pcs;
 
-layout(binding = 1) uniform sampler2D albedoMap;
-
 layout(location = 0) out vec4 o_FragColor;
 
 // Lighting parameters
@@ -32,11 +30,11 @@ void main()
     vec3 viewDir = normalize(pcs.cameraPos - v_WorldPos);
 
     // Ambient
-    vec3 ambient = ambientStrength * lightColor * texture(albedoMap, v_TexCoord).rgb;
+    vec3 ambient = ambientStrength * lightColor;
 
     // Diffuse (Lambertian)
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = diff  * lightColor * texture(albedoMap, v_TexCoord).rgb;
+    vec3 diffuse = diff  * lightColor;
 
     // Specular (Blinn-Phong)
     vec3 halfwayDir = normalize(lightDir + viewDir);
@@ -0,0 +1,23 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Depth and shadow passes over Mesh::getPositionBuffer(), EVertexFormat::ePosition. Transforms like
+// mesh_standard.vert.glsl and decodes the same bits, so the two agree on depth
+
+#define VERTEX_FORMAT_POSITION
+#include "mesh_vertex.glsl"
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+invariant gl_Position;
+
+void main()
+{
+    vec4 worldPos = ubo.model * vec4(loadMeshVertex().position, 1.0);
+    gl_Position = ubo.proj * ubo.view * worldPos;
+}
@@ -0,0 +1,36 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// mesh.vert.glsl over EVertexFormat::eStandard, the format meshes load in by default
+
+#define VERTEX_FORMAT_STANDARD
+#include "mesh_vertex.glsl"
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(location = 0) out vec3 v_WorldPos;
+layout(location = 1) out vec3 v_Normal;
+layout(location = 2) out vec2 v_TexCoord;
+
+// Depth passes over the position buffer compute the same gl_Position
+invariant gl_Position;
+
+void main()
+{
+    MeshVertex vertex = loadMeshVertex();
+
+    vec4 worldPos = ubo.model * vec4(vertex.position, 1.0);
+    v_WorldPos = worldPos.xyz;
+
+    mat3 normalMatrix = transpose(inverse(mat3(ubo.model)));
+    v_Normal = normalize(normalMatrix * vertex.normal);
+
+    v_TexCoord = vertex.texCoord;
+
+    gl_Position = ubo.proj * ubo.view * worldPos;
+}
@@ -0,0 +1,51 @@
+// Vertex inputs and their decoding for the packed formats in toast_kernel/vertex_format.hpp, keep the two in sync.
+// Define VERTEX_FORMAT_STANDARD or VERTEX_FORMAT_POSITION before including. The locations follow EVertexAttribute,
+// the order every format lists its attributes in. EVertexFormat::eFloat is read by mesh.vert.glsl as it is
+
+#ifndef MESH_VERTEX_GLSL
+#define MESH_VERTEX_GLSL
+
+#include "vertex_packing.glsl"
+
+struct MeshVertex
+{
+    vec3 position;
+    vec3 normal;
+    vec2 texCoord;
+    vec4 tangent; // w is the bitangent sign
+};
+
+// Mesh::getQuantizationGrids() entry of the submesh being drawn, after the pixel shaders' push constants
+layout(push_constant) uniform VertexPushConstants
+{
+    layout(offset = 48) vec4 gridOrigin;
+    vec4 gridExtent;
+} vertexPcs;
+
+layout(location = 0) in vec4 a_Position; // RGBA16_UNORM, w unused
+
+#if defined(VERTEX_FORMAT_STANDARD)
+layout(location = 1) in vec2 a_Normal;   // RG16_SNORM, octahedral
+layout(location = 2) in vec2 a_TexCoord; // RG16_FLOAT
+layout(location = 3) in uint a_Tangent;  // R32_UINT, packOctahedralTangent()
+#elif !defined(VERTEX_FORMAT_POSITION)
+#error "Define VERTEX_FORMAT_STANDARD or VERTEX_FORMAT_POSITION before including mesh_vertex.glsl"
+#endif
+
+MeshVertex loadMeshVertex()
+{
+    MeshVertex vertex;
+    vertex.position = decodeQuantizedPosition(a_Position.xyz, vertexPcs.gridOrigin.xyz, vertexPcs.gridExtent.xyz);
+#if defined(VERTEX_FORMAT_STANDARD)
+    vertex.normal   = decodeOctahedral(a_Normal);
+    vertex.texCoord = a_TexCoord;
+    vertex.tangent  = decodeOctahedralTangent(a_Tangent);
+#else
+    vertex.normal   = vec3(0.0, 0.0, 1.0);
+    vertex.texCoord = vec2(0.0);
+    vertex.tangent  = vec4(1.0, 0.0, 0.0, 1.0);
+#endif
+    return vertex;
+}
+
+#endif
@@ -0,0 +1,56 @@
+// Decoders for the packed vertex attributes written by tsm (toast_lib/math/math_packing.hpp), keep the two in sync.
+// Included with GL_GOOGLE_include_directive, not compiled on its own
+
+#ifndef VERTEX_PACKING_GLSL
+#define VERTEX_PACKING_GLSL
+
+// [-1, 1]^2 from an R16G16_SNORM / R8G8_SNORM attribute back to a unit vector
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+    float fold = max(-direction.z, 0.0);
+    direction.xy += mix(vec2(fold), vec2(-fold), greaterThanEqual(direction.xy, vec2(0.0)));
+    return normalize(direction);
+}
+
+// packOctahedralTangent(): xyz is the tangent, w the bitangent sign
+vec4 decodeOctahedralTangent(uint value)
+{
+    float x = max(float(bitfieldExtract(int(value), 0, 16)) / 32767.0, -1.0);
+    float y = max(float(bitfieldExtract(int(value), 16, 15)) / 16383.0, -1.0);
+    return vec4(decodeOctahedral(vec2(x, y)), (value & 0x80000000u) != 0u ? -1.0 : 1.0);
+}
+
+// R16G16B16A16_UNORM position on the submesh QuantizationGrid
+vec3 decodeQuantizedPosition(vec3 unorm, vec3 gridOrigin, vec3 gridExtent)
+{
+    return gridOrigin + unorm * gridExtent;
+}
+
+// Manual fetches, for packed data read from storage buffers instead of vertex attributes
+
+vec3 decodeOctahedral16(uint value)
+{
+    return decodeOctahedral(unpackSnorm2x16(value));
+}
+
+vec4 decodeUnorm1010102(uint value)
+{
+    uvec4 fields = uvec4(bitfieldExtract(value, 0, 10), bitfieldExtract(value, 10, 10), bitfieldExtract(value, 20, 10), bitfieldExtract(value, 30, 2));
+    return vec4(fields) / vec4(1023.0, 1023.0, 1023.0, 3.0);
+}
+
+vec4 decodeSnorm1010102(uint value)
+{
+    int bits = int(value);
+    ivec4 fields = ivec4(bitfieldExtract(bits, 0, 10), bitfieldExtract(bits, 10, 10), bitfieldExtract(bits, 20, 10), bitfieldExtract(bits, 30, 2));
+    return max(vec4(fields) / vec4(511.0, 511.0, 511.0, 1.0), vec4(-1.0));
+}
+
+vec3 decodeQuantizedPosition(uvec3 quantized, vec3 gridOrigin, vec3 gridExtent)
+{
+    return gridOrigin + vec3(quantized) / 65535.0 * gridExtent;
+}
+
+#endif
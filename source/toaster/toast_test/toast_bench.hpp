@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "toast_test.hpp"
+
+namespace toaster::test
+{
+	// Keeps the compiler from dropping the computation of p_value
+	template<typename T>
+	void doNotOptimize(const T &p_value)
+	{
+		#if defined(_MSC_VER)
+		static const volatile void *s_sink;
+		s_sink = &p_value;
+		_ReadWriteBarrier();
+		#else
+		asm volatile("" : : "g"(&p_value) : "memory");
+		#endif
+	}
+
+	// Runs p_function once to warm up, then p_runs times, and returns the fastest run in nanoseconds. The fastest
+	// run is the one least disturbed by the rest of the machine
+	template<typename F>
+	double measureNs(F &&p_function, const uint32_t p_runs = 5u)
+	{
+		p_function();
+
+		double best = 0.0;
+		for (uint32_t run = 0u; run < p_runs; run++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			p_function();
+			const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+			best                 = run == 0u || elapsed < best ? elapsed : best;
+		}
+		return best;
+	}
+
+	// One result line: the time per run, and per item when p_items is not 0
+	inline void report(const char *p_name, const double p_ns, const double p_items = 0.0)
+	{
+		if (p_items > 0.0)
+			std::printf("  %-48s %12.3f ms %10.3f ns/item\n", p_name, p_ns * 1e-6, p_ns / p_items);
+		else
+			std::printf("  %-48s %12.3f ms\n", p_name, p_ns * 1e-6);
+	}
+}
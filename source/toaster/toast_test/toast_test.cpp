@@ -0,0 +1,72 @@
+#include "toast_test.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace toaster::test
+{
+	namespace
+	{
+		struct Case
+		{
+			const char * name;
+			CaseFunction function;
+		};
+
+		// Function local, registrars in other translation units may run before this one is initialized
+		std::vector<Case> &getCases()
+		{
+			static std::vector<Case> s_cases;
+			return s_cases;
+		}
+
+		uint32_t s_failures{0u};
+	}
+
+	CaseRegistrar::CaseRegistrar(const char *p_name, const CaseFunction p_function)
+	{
+		getCases().push_back({p_name, p_function});
+	}
+
+	void reportFailure(const char *p_file, const int p_line, const char *p_expression)
+	{
+		std::printf("%s(%d): check failed: %s\n", p_file, p_line, p_expression);
+		std::fflush(stdout);
+		s_failures++;
+	}
+}
+
+int main(const int argc, char **argv)
+{
+	using namespace toaster::test;
+
+	const char *filter = argc > 1 ? argv[1] : nullptr;
+
+	uint32_t failed_cases = 0u;
+	uint32_t ran_cases    = 0u;
+	for (const Case &test_case: getCases())
+	{
+		if (filter && !std::strstr(test_case.name, filter))
+			continue;
+
+		std::printf("[ RUN  ] %s\n", test_case.name);
+		std::fflush(stdout);
+
+		const uint32_t failures_before = s_failures;
+		const auto     start           = std::chrono::steady_clock::now();
+		test_case.function();
+		const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		const bool passed = s_failures == failures_before;
+		std::printf("[ %s ] %s (%.1f ms)\n", passed ? " OK " : "FAIL", test_case.name, elapsed_ms);
+		std::fflush(stdout);
+
+		failed_cases += passed ? 0u : 1u;
+		ran_cases++;
+	}
+
+	std::printf("%u of %u passed\n", ran_cases - failed_cases, ran_cases);
+	return failed_cases == 0u && ran_cases > 0u ? 0 : 1;
+}
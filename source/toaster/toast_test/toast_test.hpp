@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// Minimal test and benchmark runner, no dependencies so it can be linked against instrumented copies of the
+// libraries too. Cases register themselves at static initialization and main() runs them in order:
+//	TST_TEST(handlesSurviveGrowth)
+//	{
+//		TST_CHECK(pool.isAlive(handle));
+//	}
+// A failed check reports and carries on, the executable then exits with 1. Benchmarks are registered the same way
+// with TST_BENCHMARK and built into their own executables, which ctest does not run. Pass a name to run only the
+// cases containing it
+namespace toaster::test
+{
+	using CaseFunction = void (*)();
+
+	struct CaseRegistrar
+	{
+		CaseRegistrar(const char *p_name, CaseFunction p_function);
+	};
+
+	void reportFailure(const char *p_file, int p_line, const char *p_expression);
+}
+
+#define TST_TEST_CASE_(name)                                                                          \
+	static void name();                                                                               \
+	static const ::toaster::test::CaseRegistrar name##_registrar{#name, name};                      \
+	static void name()
+
+#define TST_TEST(name) TST_TEST_CASE_(name)
+#define TST_BENCHMARK(name) TST_TEST_CASE_(name)
+
+#define TST_CHECK(expression)                                                                         \
+	do                                                                                                \
+	{                                                                                                 \
+		if (!(expression))                                                                            \
+			::toaster::test::reportFailure(__FILE__, __LINE__, #expression);                         \
+	}                                                                                                 \
+	while (false)